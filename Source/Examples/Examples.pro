@@ -5,5 +5,7 @@
 TEMPLATE		=		subdirs
 
 SUBDIRS			=															\
+						RTSPClientBenchmark									\
 						RTSPClientCLI										\
 						RTSPClientGUI										\
+						RTSPTestServer										\
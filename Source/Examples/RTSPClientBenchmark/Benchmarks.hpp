@@ -0,0 +1,80 @@
+/// \file Benchmarks.hpp
+/// \brief Contains declarations of the library benchmarks.
+/// \bug No known bugs.
+
+#ifndef BENCHMARKS_HPP
+#define BENCHMARKS_HPP
+
+#include <QStringList>
+
+/// Contains the library benchmarks.
+namespace Benchmarks {
+
+	/// Measures the number of RTSP sessions brought up per second.
+	/// \param[in]	arguments	Benchmark arguments.
+	/// \return Exit status.
+	int sessions(const QStringList& arguments);
+
+	/// Measures time to the first RTP packet with and without fast start.
+	/// \param[in]	arguments	Benchmark arguments.
+	/// \return Exit status.
+	int fastStart(const QStringList& arguments);
+
+	/// Measures RTSP response header parsing throughput.
+	/// \param[in]	arguments	Benchmark arguments.
+	/// \return Exit status.
+	int parser(const QStringList& arguments);
+
+	/// Measures per-request setup cost of the local context.
+	/// \param[in]	arguments	Benchmark arguments.
+	/// \return Exit status.
+	int setup(const QStringList& arguments);
+
+	/// Measures recovery of many sessions from a flapping server.
+	/// \param[in]	arguments	Benchmark arguments.
+	/// \return Exit status.
+	int reconnect(const QStringList& arguments);
+
+	/// Measures packet throughput of the client pool by number of shards.
+	/// \param[in]	arguments	Benchmark arguments.
+	/// \return Exit status.
+	int pool(const QStringList& arguments);
+
+	/// Measures RTP packet parsing throughput.
+	/// \param[in]	arguments	Benchmark arguments.
+	/// \return Exit status.
+	int packet(const QStringList& arguments);
+
+	/// Measures packet buffer allocation cost.
+	/// \param[in]	arguments	Benchmark arguments.
+	/// \return Exit status.
+	int buffers(const QStringList& arguments);
+
+	/// Measures RTP jitter buffer throughput and playout quality.
+	/// \param[in]	arguments	Benchmark arguments.
+	/// \return Exit status.
+	int sequence(const QStringList& arguments);
+
+	/// Measures shared socket demultiplexing against per-session sockets.
+	/// \param[in]	arguments	Benchmark arguments.
+	/// \return Exit status.
+	int demux(const QStringList& arguments);
+
+	/// Measures clock alignment of many cameras with audio and video.
+	/// \param[in]	arguments	Benchmark arguments.
+	/// \return Exit status.
+	int clock(const QStringList& arguments);
+
+	/// Measures decodable frames under loss with and without NACK.
+	/// \param[in]	arguments	Benchmark arguments.
+	/// \return Exit status.
+	int nack(const QStringList& arguments);
+
+	/// Measures recovery time after loss with and without key frame
+	/// requests.
+	/// \param[in]	arguments	Benchmark arguments.
+	/// \return Exit status.
+	int keyFrame(const QStringList& arguments);
+}
+
+#endif
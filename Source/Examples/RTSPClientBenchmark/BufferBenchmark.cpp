@@ -0,0 +1,125 @@
+/// \file BufferBenchmark.cpp
+/// \brief Contains definitions of the packet buffer allocation benchmark.
+/// \bug No known bugs.
+
+#include "Benchmarks.hpp"
+
+#include "RTSPClient/Utilities/PacketBufferPool.hpp"
+
+#include <QByteArray>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+#include <cstring>
+#include <vector>
+
+/// Contains the library benchmarks.
+namespace Benchmarks {
+
+	namespace {
+
+		using RTSPLib::RTSPClient::PacketBuffer;
+		using RTSPLib::RTSPClient::PacketBufferPool;
+
+		/// Allocates, fills and releases packets through a holding window.
+		/// \details Every packet is held until the window wraps, the way a
+		/// reorder buffer holds packets.
+		/// \param[in]	window		Held packets.
+		/// \param[in]	iterations	Number of packets.
+		/// \param[in]	size		Packet size.
+		/// \param[in]	allocate	Packet allocator.
+		/// \return Elapsed time in seconds.
+		template<typename T, typename F>
+		double run(std::vector<T>& window,
+				   int iterations,
+				   int size,
+				   F allocate) {
+
+			QElapsedTimer timer;
+			timer.start();
+
+			for (auto i = 0; i < iterations; ++i) {
+				auto packet = allocate(size);
+				std::memset(packet.data(), i, 16);
+				window[i % window.size()] = std::move(packet);
+			}
+
+			window.assign(window.size(), T());
+
+			return timer.nsecsElapsed() / 1e9;
+		}
+
+		/// Adapts a pooled buffer to the allocator interface.
+		struct Pooled final {
+
+			/// Pooled buffer.
+			PacketBuffer buffer_;
+
+			/// Returns buffer data.
+			/// \return Buffer data.
+			char* data() {
+				return buffer_.getData();
+			}
+		};
+	}
+
+	/// Measures packet buffer allocation cost.
+	/// \details Allocates packets as heap byte arrays and as pooled
+	/// buffers, and reports the pool hit rate and high-water mark.
+	/// \param[in]	arguments	Benchmark arguments.
+	/// \return Exit status.
+	int buffers(const QStringList& arguments) {
+		QCommandLineParser parser;
+		parser.setApplicationDescription(
+			"Measures packet buffer allocation cost.");
+		parser.addHelpOption();
+
+		QCommandLineOption iterationsOption(
+			"iterations", "Number of packets.", "count", "10000000");
+		QCommandLineOption sizeOption(
+			"size", "Packet size.", "bytes", "1400");
+		QCommandLineOption holdOption(
+			"hold", "Number of packets held at a time.", "count", "256");
+
+		parser.addOption(iterationsOption);
+		parser.addOption(sizeOption);
+		parser.addOption(holdOption);
+		parser.process(arguments);
+
+		auto iterations = parser.value(iterationsOption).toInt();
+		auto size = parser.value(sizeOption).toInt();
+		auto hold = parser.value(holdOption).toInt();
+
+		if (iterations <= 0 || size < 16 || hold <= 0) parser.showHelp(1);
+
+		std::vector<QByteArray> arrays(static_cast<std::size_t>(hold));
+		auto heap = run(arrays, iterations, size, [](int bytes) {
+			return QByteArray(bytes, Qt::Uninitialized);
+		});
+
+		auto& pool = PacketBufferPool::shared();
+
+		std::vector<Pooled> buffers(static_cast<std::size_t>(hold));
+		auto pooled = run(buffers, iterations, size, [&pool](int bytes) {
+			return Pooled { pool.allocate(bytes) };
+		});
+
+		auto statistics = pool.getStatistics();
+		auto count = static_cast<double>(iterations);
+
+		QTextStream output(stdout);
+		output << "packets:            " << count << "\n"
+			   << "heap, ns/packet:    " << heap * 1e9 / count << "\n"
+			   << "pool, ns/packet:    " << pooled * 1e9 / count << "\n"
+			   << "speedup:            " << (pooled > 0 ? heap / pooled : 0)
+			   << "\n"
+			   << "pool hit rate %:    " << statistics.hitRate_ * 100 << "\n"
+			   << "pool misses:        "
+			   << statistics.allocations_ - statistics.hits_ << "\n"
+			   << "pool high-water:    " << statistics.highWater_ << "\n"
+			   << "pool capacity:      " << statistics.capacity_ << "\n";
+
+		return 0;
+	}
+}
@@ -0,0 +1,315 @@
+/// \file ClockBenchmark.cpp
+/// \brief Contains definitions of the clock alignment benchmark.
+/// \bug No known bugs.
+
+#include "Benchmarks.hpp"
+
+#include "RTSPClient/Protocols/RTCP/RTCPSenderClock.hpp"
+#include "RTSPClient/Protocols/RTP/RTPTimestampUnwrapper.hpp"
+
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+/// Contains the library benchmarks.
+namespace Benchmarks {
+
+	namespace {
+
+		using RTSPLib::RTSPClient::RTCPSenderClock;
+		using RTSPLib::RTSPClient::RTPTimestampUnwrapper;
+
+		/// Nanoseconds per second.
+		/// \details Times of the simulation are kept in nanoseconds.
+		constexpr qint64 NANOSECONDS { 1000000000 };
+
+		/// Interval between sender reports.
+		/// \details Five seconds, as RFC 3550 suggests for a sender.
+		constexpr qint64 REPORT_INTERVAL { 5 * NANOSECONDS };
+
+		/// Shortest transit time of the network.
+		/// \details Twenty milliseconds.
+		constexpr qint64 TRANSIT_TIME { 20000000 };
+
+		/// Seconds from the NTP epoch to the Unix epoch.
+		/// \details From 1900 to 1970, seventeen leap years included.
+		constexpr qint64 NTP_UNIX_OFFSET { 2208988800ll };
+
+		/// Structure that describes a synthetic media track.
+		struct Track final {
+
+			/// RTP clock rate.
+			int clockRate_;
+
+			/// Frame interval in nanoseconds.
+			qint64 interval_;
+
+			/// Drift of the RTP clock against the sender wall clock.
+			double drift_;
+
+			/// First RTP timestamp.
+			quint32 origin_;
+
+			/// Sender clock of the track.
+			std::unique_ptr<RTCPSenderClock> clock_;
+
+			/// Timeline of the track.
+			std::unique_ptr<RTPTimestampUnwrapper> timeline_;
+		};
+
+		/// Structure that describes a synthetic camera.
+		struct Camera final {
+
+			/// Wall clock time of the camera at the start in nanoseconds.
+			qint64 origin_;
+
+			/// Drift of the wall clock against the receiver clock.
+			double skew_;
+
+			/// Video and audio tracks.
+			std::vector<Track> tracks_;
+		};
+
+		/// Converts wall clock time to NTP timestamp.
+		/// \details The inverse of RTCPSenderClock::toUnixTime().
+		/// \param[in]	time	Time since the Unix epoch in nanoseconds.
+		/// \return NTP timestamp.
+		quint64 toNTP(qint64 time) {
+			auto seconds = static_cast<quint64>(
+				time / NANOSECONDS + NTP_UNIX_OFFSET);
+			auto fraction = (static_cast<quint64>(time % NANOSECONDS) << 32) /
+							NANOSECONDS;
+
+			return seconds << 32 | fraction;
+		}
+
+		/// Returns wall clock time of a camera.
+		/// \param[in]	camera	Camera.
+		/// \param[in]	time	Receiver clock time in nanoseconds.
+		/// \return Time since the Unix epoch in nanoseconds.
+		qint64 wallClock(const Camera& camera, qint64 time) {
+			return camera.origin_ + static_cast<qint64>(
+				std::llround(time * (1 + camera.skew_)));
+		}
+
+		/// Returns RTP timestamp of a track.
+		/// \param[in]	camera	Camera.
+		/// \param[in]	track	Track.
+		/// \param[in]	time	Receiver clock time in nanoseconds.
+		/// \return RTP timestamp.
+		quint32 timestamp(const Camera& camera,
+						  const Track& track,
+						  qint64 time) {
+			auto elapsed = (wallClock(camera, time) - camera.origin_) /
+						   static_cast<double>(NANOSECONDS);
+
+			return track.origin_ + static_cast<quint32>(std::llround(
+				elapsed * track.clockRate_ * (1 + track.drift_)));
+		}
+
+		/// Returns offset of the receiver clock of a camera.
+		/// \details The smallest offset of its tracks, as RTSPClockService
+		/// takes it.
+		/// \param[in]	camera	Camera.
+		/// \param[out]	offset	Offset in nanoseconds.
+		/// \retval true on success.
+		/// \retval false if no sender report was received.
+		bool cameraOffset(const Camera& camera, qint64& offset) {
+			auto valid = false;
+
+			for (const auto& track : camera.tracks_) {
+				auto mapping = track.clock_->getMapping();
+
+				if (mapping.arrival_ < 0) continue;
+
+				offset = valid
+						 ? std::min(offset, mapping.offset_)
+						 : mapping.offset_;
+				valid = true;
+			}
+
+			return valid;
+		}
+
+		/// Structure that collects alignment errors.
+		struct Errors final {
+
+			/// Number of errors.
+			quint64 count_ { 0 };
+
+			/// Smallest error in nanoseconds.
+			qint64 minimum_ { std::numeric_limits<qint64>::max() };
+
+			/// Largest error in nanoseconds.
+			qint64 maximum_ { std::numeric_limits<qint64>::min() };
+
+			/// Adds an error.
+			/// \param[in]	error	Error in nanoseconds.
+			void add(qint64 error) {
+				++count_;
+				minimum_ = std::min(minimum_, error);
+				maximum_ = std::max(maximum_, error);
+			}
+
+			/// Returns spread of errors.
+			/// \return Spread in milliseconds.
+			double spread() const {
+				return count_ > 0 ? (maximum_ - minimum_) / 1e6 : 0;
+			}
+		};
+	}
+
+	/// Measures clock alignment of many cameras with audio and video.
+	/// \details Simulates cameras whose wall clocks drift against the
+	/// receiver clock and whose RTP clocks drift against their wall
+	/// clocks, sending reports and frames over a network with jitter.
+	/// Frames are placed on the receiver clock by sender reports and by
+	/// arrival time, and the spread of their errors over all cameras is
+	/// reported together with audio to video skew and the conversion cost.
+	/// \param[in]	arguments	Benchmark arguments.
+	/// \return Exit status.
+	int clock(const QStringList& arguments) {
+		QCommandLineParser parser;
+		parser.setApplicationDescription(
+			"Measures clock alignment of many cameras with audio and video.");
+		parser.addHelpOption();
+
+		QCommandLineOption camerasOption(
+			"cameras", "Number of cameras.", "count", "16");
+		QCommandLineOption durationOption(
+			"duration", "Simulated time.", "s", "600");
+		QCommandLineOption jitterOption(
+			"jitter", "Mean network jitter.", "ms", "5");
+		QCommandLineOption skewOption(
+			"skew", "Largest wall clock drift of a camera.", "ppm", "100");
+		QCommandLineOption driftOption(
+			"drift", "Largest RTP clock drift of a track.", "ppm", "50");
+
+		parser.addOption(camerasOption);
+		parser.addOption(durationOption);
+		parser.addOption(jitterOption);
+		parser.addOption(skewOption);
+		parser.addOption(driftOption);
+		parser.process(arguments);
+
+		auto count = parser.value(camerasOption).toInt();
+		auto duration = parser.value(durationOption).toLongLong() * NANOSECONDS;
+		auto jitter = parser.value(jitterOption).toDouble() * 1e6;
+		auto skew = parser.value(skewOption).toDouble() / 1e6;
+		auto drift = parser.value(driftOption).toDouble() / 1e6;
+
+		if (count <= 0 || duration <= 0 || jitter <= 0) parser.showHelp(1);
+
+		std::mt19937 random(1);
+		std::uniform_real_distribution<double> spread(-1, 1);
+		std::exponential_distribution<double> delay(1 / jitter);
+		std::uniform_int_distribution<qint64> start(0, 1000 * NANOSECONDS);
+
+		std::vector<Camera> cameras(static_cast<std::size_t>(count));
+
+		for (auto& camera : cameras) {
+			camera.origin_ = 1600000000 * NANOSECONDS + start(random);
+			camera.skew_ = spread(random) * skew;
+
+			for (auto clockRate : { 90000, 48000 }) {
+				Track track;
+				track.clockRate_ = clockRate;
+				track.interval_ = clockRate == 90000 ? 40000000 : 20000000;
+				track.drift_ = spread(random) * drift;
+				track.origin_ = static_cast<quint32>(random());
+				track.clock_.reset(new RTCPSenderClock);
+				track.timeline_.reset(new RTPTimestampUnwrapper);
+
+				camera.tracks_.push_back(std::move(track));
+			}
+		}
+
+		Errors aligned, arrival;
+		qint64 skewSum = 0, skewMaximum = 0;
+		quint64 skewCount = 0;
+
+		for (qint64 time = 0; time < duration; time += 20000000) {
+			for (auto& camera : cameras) {
+				qint64 errors[2] = { 0, 0 };
+				auto valid = 0;
+
+				if (time % REPORT_INTERVAL == 0)
+					for (auto& track : camera.tracks_)
+						track.clock_->update(
+							0, track.clockRate_,
+							toNTP(wallClock(camera, time)),
+							timestamp(camera, track, time),
+							time + TRANSIT_TIME +
+							static_cast<qint64>(delay(random)));
+
+				for (std::size_t i = 0; i < camera.tracks_.size(); ++i) {
+					auto& track = camera.tracks_[i];
+					auto rtp = timestamp(camera, track, time);
+
+					if (time % track.interval_ != 0) continue;
+
+					track.timeline_->unwrap(rtp);
+					arrival.add(static_cast<qint64>(delay(random)));
+
+					qint64 offset;
+					if (!cameraOffset(camera, offset)) continue;
+
+					auto wall = RTCPSenderClock::toWallClock(
+						track.clock_->getMapping(), rtp);
+					auto error = wall + offset - TRANSIT_TIME - time;
+
+					aligned.add(error);
+					errors[i] = error;
+					++valid;
+				}
+
+				if (valid == 2) {
+					auto avSkew = std::abs(errors[0] - errors[1]);
+
+					skewSum += avSkew;
+					skewMaximum = std::max(skewMaximum, avSkew);
+					++skewCount;
+				}
+			}
+		}
+
+		const auto& track = cameras.front().tracks_.front();
+		auto mapping = track.clock_->getMapping();
+		auto conversions = 10000000;
+		volatile qint64 sink = 0;
+
+		QElapsedTimer timer;
+		timer.start();
+
+		for (auto i = 0; i < conversions; ++i) {
+			auto rtp = mapping.rtpTimestamp_ + static_cast<quint32>(i) * 3000;
+			qint64 ticks = 0;
+
+			track.timeline_->extend(rtp, ticks);
+			sink = ticks + RTCPSenderClock::toReceiverClock(mapping, rtp);
+		}
+
+		auto elapsed = timer.nsecsElapsed();
+		Q_UNUSED(sink);
+
+		QTextStream output(stdout);
+		output << "frames:               " << aligned.count_ << "\n"
+			   << "aligned spread, ms:   " << aligned.spread() << "\n"
+			   << "arrival spread, ms:   " << arrival.spread() << "\n"
+			   << "mean a/v skew, us:    "
+			   << (skewCount > 0 ? skewSum / 1e3 / skewCount : 0) << "\n"
+			   << "max a/v skew, us:     " << skewMaximum / 1e3 << "\n"
+			   << "measured rate, Hz:    " << mapping.rate_ << "\n"
+			   << "ns/conversion:        "
+			   << static_cast<double>(elapsed) / conversions << "\n";
+
+		return 0;
+	}
+}
@@ -0,0 +1,516 @@
+/// \file DemuxBenchmark.cpp
+/// \brief Contains definitions of the shared socket demultiplexing
+/// benchmark.
+/// \bug No known bugs.
+
+#include "Benchmarks.hpp"
+
+#include "RTSPClient/Protocols/RTP/RTPSourceTable.hpp"
+#include "RTSPClient/Utilities/DatagramReceiver.hpp"
+
+#include <QAbstractEventDispatcher>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QHash>
+#include <QSocketNotifier>
+#include <QTextStream>
+#include <QThread>
+#include <QTimer>
+#include <QUdpSocket>
+#include <QtEndian>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+#ifdef Q_OS_LINUX
+#include <time.h>
+#endif
+
+/// Contains the library benchmarks.
+namespace Benchmarks {
+
+	namespace {
+
+		using RTSPLib::RTSPClient::DatagramReceiver;
+		using RTSPLib::RTSPClient::RTPSourceTable;
+
+		/// Time to receive datagrams in flight after sending stops.
+		/// \details Milliseconds, long enough for the loopback interface.
+		constexpr int DRAIN_TIME { 200 };
+
+		/// Structure that describes a synthetic RTP source.
+		struct Source final {
+
+			/// IPv4 address of the server.
+			quint32 address_;
+
+			/// Synchronization source ID (SSRC).
+			quint32 ssrc_;
+		};
+
+		/// Generates sources of a few servers.
+		/// \details Addresses come from a private network, SSRCs are random
+		/// and distinct, as RFC 3550 asks of a sender.
+		/// \param[in]	count	Number of sources.
+		/// \param[in]	servers	Number of servers.
+		/// \return Sources.
+		std::vector<Source> sources(int count, int servers) {
+			std::mt19937 random(1);
+			QHash<quint32, bool> used;
+
+			std::vector<Source> result;
+			result.reserve(static_cast<std::size_t>(count));
+
+			while (static_cast<int>(result.size()) < count) {
+				auto ssrc = static_cast<quint32>(random());
+				if (used.contains(ssrc)) continue;
+
+				auto server = static_cast<quint32>(random()) %
+							  static_cast<quint32>(servers);
+
+				used.insert(ssrc, true);
+				result.push_back({ 0x0A000001u + server, ssrc });
+			}
+
+			return result;
+		}
+
+		/// Returns CPU time of the calling thread.
+		/// \return CPU time in nanoseconds or -1 if it is unknown.
+		qint64 threadTime() {
+#ifdef Q_OS_LINUX
+			timespec time;
+			if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) != 0) return -1;
+
+			return static_cast<qint64>(time.tv_sec) * 1000000000 +
+				   time.tv_nsec;
+#else
+			return -1;
+#endif
+		}
+
+		/// Class that provides paced RTP sender thread.
+		/// \details Sends every stream the same packet rate, spreading the
+		/// packets of a millisecond over all streams in turn, as many
+		/// independent cameras would.
+		class Sender final : public QThread {
+		public:
+
+			/// Constructor.
+			/// \param[in]	streams	Destination ports and SSRCs.
+			/// \param[in]	rate	Packets per second of a stream.
+			/// \param[in]	size	Packet size.
+			explicit Sender(const QVector<QPair<quint16, quint32>>& streams,
+							int rate,
+							int size)
+				: streams_(streams),
+				  rate_(rate),
+				  size_(size) {
+			}
+
+		public:
+
+			/// Stops sending.
+			void stop() {
+				running_ = false;
+				wait();
+			}
+
+			/// Returns number of sent packets.
+			/// \return Number of sent packets.
+			quint64 getSentCount() const {
+				return sent_.load(std::memory_order_relaxed);
+			}
+
+		protected:
+
+			/// Sends packets until stopped.
+			/// \details Catches up with the schedule every millisecond.
+			void run() override {
+				QUdpSocket socket;
+				QByteArray packet(size_, '\0');
+
+				packet[0] = static_cast<char>(0x80);
+				packet[1] = static_cast<char>(96);
+
+				auto data = reinterpret_cast<uchar*>(packet.data());
+				auto total = static_cast<qint64>(rate_) * streams_.size();
+
+				quint64 sent = 0;
+				quint16 sequence = 0;
+				auto next = 0;
+
+				QElapsedTimer clock;
+				clock.start();
+
+				while (running_) {
+					auto due = static_cast<quint64>(
+						clock.nsecsElapsed() / 1000000 * total / 1000);
+
+					for (; sent < due; ++sent) {
+						const auto& stream = streams_[next];
+						next = (next + 1) % streams_.size();
+
+						qToBigEndian<quint16>(sequence++, data + 2);
+						qToBigEndian<quint32>(stream.second, data + 8);
+
+						if (socket.writeDatagram(packet,
+												 QHostAddress::LocalHost,
+												 stream.first) > 0)
+							sent_.fetch_add(1, std::memory_order_relaxed);
+					}
+
+					QThread::usleep(1000);
+				}
+			}
+
+		private:
+
+			/// Destination ports and SSRCs.
+			const QVector<QPair<quint16, quint32>> streams_;
+
+			/// Packets per second of a stream.
+			const int rate_;
+
+			/// Packet size.
+			const int size_;
+
+			/// Whether the sender runs.
+			std::atomic<bool> running_ { true };
+
+			/// Number of sent packets.
+			std::atomic<quint64> sent_ { 0 };
+		};
+
+		/// Structure that describes a receive run.
+		struct Result final {
+
+			/// Number of open sockets.
+			int sockets_ { 0 };
+
+			/// Number of sent packets.
+			quint64 sent_ { 0 };
+
+			/// Number of received packets.
+			quint64 received_ { 0 };
+
+			/// Number of received packets passed to a session.
+			quint64 matched_ { 0 };
+
+			/// Number of event loop wakeups.
+			quint64 wakeups_ { 0 };
+
+			/// Number of socket notifications.
+			quint64 notifications_ { 0 };
+
+			/// Number of receive system calls.
+			quint64 receives_ { 0 };
+
+			/// CPU time of the receiving thread in nanoseconds.
+			qint64 cpu_ { -1 };
+		};
+
+		/// Receives streams on the calling thread.
+		/// \details Every socket gets a notifier that drains it in batches.
+		/// Wakeups are counted the way the client pool measures
+		/// utilization, from the event dispatcher leaving its wait.
+		/// \param[in]	receivers	Open receivers.
+		/// \param[in]	streams		Destination ports and SSRCs.
+		/// \param[in]	rate		Packets per second of a stream.
+		/// \param[in]	size		Packet size.
+		/// \param[in]	duration	Send time in milliseconds.
+		/// \param[in]	dispatch	Datagram handler, returns whether the
+		///							datagram matched a session.
+		/// \return Receive run result.
+		Result run(std::vector<std::unique_ptr<DatagramReceiver>>& receivers,
+				   const QVector<QPair<quint16, quint32>>& streams,
+				   int rate,
+				   int size,
+				   int duration,
+				   const std::function<bool(const DatagramReceiver&,
+											int)>& dispatch) {
+			Result result;
+			result.sockets_ = static_cast<int>(receivers.size());
+
+			std::vector<std::unique_ptr<QSocketNotifier>> notifiers;
+
+			for (auto& receiver : receivers) {
+				auto notifier = new QSocketNotifier(
+					receiver->getDescriptor(), QSocketNotifier::Read);
+				auto source = receiver.get();
+
+				QObject::connect(notifier, &QSocketNotifier::activated,
+								 [&result, source, &dispatch]() {
+					++result.notifications_;
+
+					for (;;) {
+						auto count = source->receive();
+						++result.receives_;
+
+						for (auto i = 0; i < count; ++i) {
+							++result.received_;
+							if (dispatch(*source, i)) ++result.matched_;
+						}
+
+						if (count < DatagramReceiver::getBatchSize()) break;
+					}
+				});
+
+				notifiers.emplace_back(notifier);
+			}
+
+			auto dispatcher = QAbstractEventDispatcher::instance();
+			auto waiting = false;
+
+			auto blocked = QObject::connect(
+				dispatcher,
+				&QAbstractEventDispatcher::aboutToBlock,
+				[&waiting]() { waiting = true; });
+
+			auto woken = QObject::connect(
+				dispatcher,
+				&QAbstractEventDispatcher::awake,
+				[&result, &waiting]() {
+					if (!waiting) return;
+
+					waiting = false;
+					++result.wakeups_;
+				});
+
+			Sender sender(streams, rate, size);
+			QEventLoop loop;
+
+			auto cpu = threadTime();
+
+			sender.start();
+			QTimer::singleShot(duration, &loop, &QEventLoop::quit);
+			loop.exec();
+
+			sender.stop();
+			QTimer::singleShot(DRAIN_TIME, &loop, &QEventLoop::quit);
+			loop.exec();
+
+			if (cpu >= 0) result.cpu_ = threadTime() - cpu;
+
+			QObject::disconnect(blocked);
+			QObject::disconnect(woken);
+
+			result.sent_ = sender.getSentCount();
+
+			return result;
+		}
+
+		/// Opens receivers on ports picked by the system.
+		/// \param[in]	count		Number of receivers.
+		/// \param[out]	receivers	Open receivers.
+		/// \retval true on success.
+		/// \retval false if a socket could not be opened.
+		bool openReceivers(
+			int count,
+			std::vector<std::unique_ptr<DatagramReceiver>>& receivers) {
+
+			for (auto i = 0; i < count; ++i) {
+				std::unique_ptr<DatagramReceiver> receiver(
+					new DatagramReceiver);
+
+				if (!receiver->open(0)) return false;
+
+				receivers.push_back(std::move(receiver));
+			}
+
+			return true;
+		}
+
+		/// Prints a receive run result.
+		/// \param[in]	output	Output stream.
+		/// \param[in]	name	Socket model name.
+		/// \param[in]	result	Receive run result.
+		void print(QTextStream& output,
+				   const char* name,
+				   const Result& result) {
+
+			auto received = qMax<quint64>(result.received_, 1);
+			auto wakeups = qMax<quint64>(result.wakeups_, 1);
+
+			output << name << "\n"
+				   << "  sockets:            " << result.sockets_ << "\n"
+				   << "  sent:               " << result.sent_ << "\n"
+				   << "  received:           " << result.received_ << "\n"
+				   << "  matched:            " << result.matched_ << "\n"
+				   << "  wakeups:            " << result.wakeups_ << "\n"
+				   << "  notifications:      " << result.notifications_
+				   << "\n"
+				   << "  packets/wakeup:     "
+				   << static_cast<double>(result.received_) / wakeups << "\n"
+				   << "  syscalls/packet:    "
+				   << static_cast<double>(result.receives_ +
+										  result.wakeups_) / received
+				   << "\n"
+				   << "  cpu ns/packet:      ";
+
+			if (result.cpu_ < 0) output << "n/a\n";
+			else output << static_cast<double>(result.cpu_) / received << "\n";
+		}
+	}
+
+	/// Measures shared socket demultiplexing against per-session sockets.
+	/// \details First looks sources up by address and SSRC in the source
+	/// table and in a QHash in random order. Then sends paced RTP streams
+	/// over the loopback interface, once to a socket per session and once
+	/// to a single shared socket demultiplexed through the source table,
+	/// and reports event loop wakeups, socket notifications, system calls
+	/// and receive CPU time per packet of both models.
+	/// \param[in]	arguments	Benchmark arguments.
+	/// \return Exit status.
+	int demux(const QStringList& arguments) {
+		QCommandLineParser parser;
+		parser.setApplicationDescription(
+			"Measures shared socket demultiplexing against per-session "
+			"sockets.");
+		parser.addHelpOption();
+
+		QCommandLineOption sessionsOption(
+			"sessions", "Number of sources looked up.", "count", "10000");
+		QCommandLineOption serversOption(
+			"servers", "Number of source addresses.", "count", "16");
+		QCommandLineOption lookupsOption(
+			"lookups", "Number of lookups.", "count", "20000000");
+		QCommandLineOption streamsOption(
+			"streams", "Number of received streams.", "count", "1000");
+		QCommandLineOption rateOption(
+			"rate", "Packet rate of a stream.", "packets/s", "100");
+		QCommandLineOption sizeOption(
+			"size", "Packet size.", "bytes", "200");
+		QCommandLineOption durationOption(
+			"duration", "Send time of a socket model.", "seconds", "3");
+
+		parser.addOption(sessionsOption);
+		parser.addOption(serversOption);
+		parser.addOption(lookupsOption);
+		parser.addOption(streamsOption);
+		parser.addOption(rateOption);
+		parser.addOption(sizeOption);
+		parser.addOption(durationOption);
+		parser.process(arguments);
+
+		auto sessions = parser.value(sessionsOption).toInt();
+		auto servers = parser.value(serversOption).toInt();
+		auto lookups = parser.value(lookupsOption).toInt();
+		auto streams = parser.value(streamsOption).toInt();
+		auto rate = parser.value(rateOption).toInt();
+		auto size = parser.value(sizeOption).toInt();
+		auto duration = qRound(parser.value(durationOption).toDouble() * 1000);
+
+		if (sessions <= 0 || servers <= 0 || lookups <= 0 || streams <= 0 ||
+			rate <= 0 || size < 12 || duration <= 0)
+			parser.showHelp(1);
+
+		auto known = sources(sessions, servers);
+
+		std::mt19937 random(2);
+		std::uniform_int_distribution<std::size_t> pick(0, known.size() - 1);
+		std::vector<Source> order;
+		order.reserve(1 << 16);
+
+		for (auto i = 0; i < 1 << 16; ++i) order.push_back(known[pick(random)]);
+
+		RTPSourceTable table;
+		QHash<quint64, void*> hash;
+
+		for (auto i = 0u; i < known.size(); ++i) {
+			auto value = reinterpret_cast<void*>(quintptr { i + 1 });
+			table.insert(known[i].address_, known[i].ssrc_, value);
+			hash.insert(static_cast<quint64>(known[i].address_) << 32 |
+						known[i].ssrc_, value);
+		}
+
+		quintptr checksum = 0;
+		QElapsedTimer timer;
+
+		timer.start();
+		for (auto i = 0; i < lookups; ++i) {
+			const auto& source = order[i & 0xFFFF];
+			checksum += reinterpret_cast<quintptr>(
+				table.find(source.address_, source.ssrc_));
+		}
+		auto tableTime = timer.nsecsElapsed();
+
+		timer.start();
+		for (auto i = 0; i < lookups; ++i) {
+			const auto& source = order[i & 0xFFFF];
+			checksum -= reinterpret_cast<quintptr>(
+				hash.value(static_cast<quint64>(source.address_) << 32 |
+						   source.ssrc_));
+		}
+		auto hashTime = timer.nsecsElapsed();
+
+		QTextStream output(stdout);
+		output << "lookup\n"
+			   << "  sources:            " << sessions << "\n"
+			   << "  table slots:        " << table.getCapacity() << "\n"
+			   << "  ns/lookup table:    "
+			   << static_cast<double>(tableTime) / lookups << "\n"
+			   << "  ns/lookup QHash:    "
+			   << static_cast<double>(hashTime) / lookups << "\n";
+		output.flush();
+
+		if (checksum != 0) return 1;
+
+		if (!DatagramReceiver::isSupported()) {
+			output << "socket models: batched receive is not supported\n";
+			return 0;
+		}
+
+		auto streamSources = sources(streams, 1);
+
+		std::vector<std::unique_ptr<DatagramReceiver>> receivers;
+
+		if (!openReceivers(streams, receivers)) {
+			QTextStream(stderr) << "Failed to open " << streams
+								<< " sockets, raise the descriptor limit\n";
+			return 1;
+		}
+
+		QVector<QPair<quint16, quint32>> destinations;
+
+		for (auto i = 0; i < streams; ++i)
+			destinations.append({ receivers[i]->getPort(),
+								  streamSources[i].ssrc_ });
+
+		auto perSession = run(receivers, destinations, rate, size, duration,
+							  [](const DatagramReceiver&, int) {
+			return true;
+		});
+
+		receivers.clear();
+
+		if (!openReceivers(1, receivers)) return 1;
+
+		RTPSourceTable sessionsTable;
+
+		for (auto i = 0; i < streams; ++i) {
+			destinations[i].first = receivers[0]->getPort();
+			sessionsTable.insert(0x7F000001u, streamSources[i].ssrc_,
+								 &destinations[i]);
+		}
+
+		auto shared = run(receivers, destinations, rate, size, duration,
+						  [&sessionsTable](const DatagramReceiver& receiver,
+										   int index) {
+			auto data = reinterpret_cast<const uchar*>(receiver.getData(index));
+
+			return receiver.getSize(index) >= 12 &&
+				   sessionsTable.find(receiver.getAddress(index),
+									  qFromBigEndian<quint32>(data + 8));
+		});
+
+		print(output, "per-session sockets", perSession);
+		print(output, "shared socket", shared);
+
+		return 0;
+	}
+}
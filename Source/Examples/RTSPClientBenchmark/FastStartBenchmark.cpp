@@ -0,0 +1,161 @@
+/// \file FastStartBenchmark.cpp
+/// \brief Contains definitions of the time-to-first-packet benchmark.
+/// \bug No known bugs.
+
+#include "Benchmarks.hpp"
+
+#include "RTSPClient/Client/RTSPClient.hpp"
+
+#include <QCommandLineParser>
+#include <QEventLoop>
+#include <QTextStream>
+#include <QTimer>
+
+/// Contains the library benchmarks.
+namespace Benchmarks {
+
+	namespace {
+
+		using RTSPLib::RTSPClient::RTSPClient;
+		using RTSPLib::RTSPClient::RTSPSessionStatistics;
+		using RTSPLib::RTSPClient::RTSPTransport;
+
+		/// Returns milliseconds for a statistics time.
+		/// \param[in]	time	Time in nanoseconds.
+		/// \return Time in milliseconds or -1 if the stage is not reached.
+		double milliseconds(qint64 time) {
+			return time < 0 ? -1 : time / 1e6;
+		}
+
+		/// Brings up one session and waits for its first RTP packet.
+		/// \param[in]	client		RTSP client.
+		/// \param[in]	url			RTSP connection URL.
+		/// \param[in]	track		Media track path.
+		/// \param[in]	ports		Client ports or interleaved channels.
+		/// \param[in]	timeout		First packet timeout in milliseconds.
+		/// \return Session bring-up statistics.
+		RTSPSessionStatistics bringUp(RTSPClient& client,
+									  const QUrl& url,
+									  const QUrl& track,
+									  const QPair<quint16, quint16>& ports,
+									  int timeout) {
+
+			if (!client.open(url)				||
+				!client.setup(track, ports)		||
+				!client.play()) {
+				auto statistics = client.getStatistics();
+				client.close();
+				return statistics;
+			}
+
+			QEventLoop loop;
+			QObject::connect(
+				&client,
+				SIGNAL(onFirstPacket(qint64)),
+				&loop,
+				SLOT(quit())
+			);
+
+			QTimer::singleShot(timeout, &loop, SLOT(quit()));
+
+			if (client.getStatistics().firstPacket_ < 0) loop.exec();
+
+			auto statistics = client.getStatistics();
+			client.close();
+
+			return statistics;
+		}
+	}
+
+	/// Measures time to the first RTP packet with and without fast start.
+	/// \details Brings up sessions one after another through RTSPClient and
+	/// prints bring-up stage times of every session.
+	/// \param[in]	arguments	Benchmark arguments.
+	/// \return Exit status.
+	int fastStart(const QStringList& arguments) {
+		QCommandLineParser parser;
+		parser.setApplicationDescription(
+			"Measures time to the first RTP packet of RTSP sessions.");
+		parser.addHelpOption();
+		parser.addPositionalArgument("url", "RTSP connection URL.");
+
+		QCommandLineOption sessionsOption(
+			"sessions", "Number of sessions per mode.", "count", "10");
+		QCommandLineOption trackOption(
+			"track", "Media track path.", "path", "track1");
+		QCommandLineOption portOption(
+			"port", "Client port or interleaved channel.", "port", "50000");
+		QCommandLineOption tcpOption(
+			"tcp", "Receive RTP interleaved on the RTSP connection.");
+		QCommandLineOption timeoutOption(
+			"timeout", "First packet timeout.", "ms", "5000");
+
+		parser.addOption(sessionsOption);
+		parser.addOption(trackOption);
+		parser.addOption(portOption);
+		parser.addOption(tcpOption);
+		parser.addOption(timeoutOption);
+		parser.process(arguments);
+
+		if (parser.positionalArguments().isEmpty()) parser.showHelp(1);
+
+		auto sessions = parser.value(sessionsOption).toInt();
+		auto timeout = parser.value(timeoutOption).toInt();
+
+		if (sessions <= 0 || timeout <= 0) parser.showHelp(1);
+
+		QUrl url(parser.positionalArguments().first());
+		QUrl track(parser.value(trackOption));
+
+		auto port = static_cast<quint16>(
+			parser.isSet(tcpOption) ? 0 : parser.value(portOption).toUInt());
+
+		RTSPClient client;
+		client.setTransport(parser.isSet(tcpOption)
+							? RTSPTransport::TCP
+							: RTSPTransport::UDP);
+
+		QTextStream output(stdout);
+		output << "mode\tsession\tdescribe, ms\tsetup, ms\t"
+				  "play, ms\tfirst packet, ms\n";
+
+		auto failed = 0;
+
+		for (auto fastStart : { false, true }) {
+			auto mode = fastStart ? "fast" : "normal";
+			auto received = 0;
+			auto total = 0.0;
+
+			client.setFastStart(fastStart);
+
+			for (auto i = 0; i < sessions; ++i) {
+				auto statistics = bringUp(
+					client,
+					url,
+					track,
+					{ port, static_cast<quint16>(port + 1) },
+					timeout);
+
+				output << mode << "\t" << i << "\t"
+					   << milliseconds(statistics.described_) << "\t"
+					   << milliseconds(statistics.setUp_) << "\t"
+					   << milliseconds(statistics.played_) << "\t"
+					   << milliseconds(statistics.firstPacket_) << "\n";
+
+				if (statistics.firstPacket_ < 0) {
+					++failed;
+					continue;
+				}
+
+				++received;
+				total += statistics.firstPacket_ / 1e6;
+			}
+
+			output << mode << "\tavg time to first packet, ms: "
+				   << (received > 0 ? total / received : -1) << "\n";
+			output.flush();
+		}
+
+		return failed == 0 ? 0 : 1;
+	}
+}
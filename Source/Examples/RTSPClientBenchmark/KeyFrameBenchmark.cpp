@@ -0,0 +1,226 @@
+/// \file KeyFrameBenchmark.cpp
+/// \brief Contains definitions of the key frame request benchmark.
+/// \bug No known bugs.
+
+#include "Benchmarks.hpp"
+
+#include "RTSPClient/Protocols/RTCP/RTCPPictureLoss.hpp"
+
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+#include <deque>
+#include <random>
+
+/// Contains the library benchmarks.
+namespace Benchmarks {
+
+	namespace {
+
+		using RTSPLib::RTSPClient::RTCPPictureLoss;
+		using RTSPLib::RTSPClient::RTCPPictureLossStatistics;
+
+		/// Nanoseconds per millisecond.
+		/// \details Times of the simulation are kept in nanoseconds.
+		constexpr qint64 MILLISECONDS { 1000000 };
+
+		/// Frame interval.
+		/// \details Forty milliseconds, twenty-five frames per second.
+		constexpr qint64 FRAME_INTERVAL { 40 * MILLISECONDS };
+
+		/// Interval between packets of a frame.
+		/// \details A tenth of a millisecond, the pacing of a camera.
+		constexpr qint64 PACKET_INTERVAL { MILLISECONDS / 10 };
+
+		/// Structure that describes a synthetic stream.
+		struct Stream final {
+
+			/// Number of frames.
+			int frames_;
+
+			/// Frames per group of pictures.
+			int group_;
+
+			/// Packets of a key frame.
+			int keyPackets_;
+
+			/// Packets of a predicted frame.
+			int packets_;
+
+			/// Probability of a lost packet.
+			double loss_;
+
+			/// Round-trip time in nanoseconds.
+			qint64 roundTrip_;
+		};
+
+		/// Structure that describes results of a simulation.
+		struct Result final {
+
+			/// Number of decodable frames.
+			int decodable_ { 0 };
+
+			/// Number of key frames.
+			int keyFrames_ { 0 };
+
+			/// Key frame request statistics.
+			RTCPPictureLossStatistics statistics_;
+		};
+
+		/// Simulates a stream over a lossy path.
+		/// \details Frames are sent as bursts of packets over a path of
+		/// constant delay. The receiver reports lost packets to the
+		/// scheduler and key frames it receives, and sends requests the
+		/// scheduler lets through. Requests are lost like packets, the
+		/// sender answers one with a key frame at the next frame time. A
+		/// frame is decodable if it is complete and its reference frames
+		/// since the last key frame are decodable.
+		/// \param[in]	stream		Stream.
+		/// \param[in]	requests	Whether key frames are requested.
+		/// \return Results.
+		Result simulate(const Stream& stream, bool requests) {
+			std::mt19937 random(1);
+			std::uniform_real_distribution<double> chance(0, 1);
+
+			RTCPPictureLoss pictureLoss;
+			pictureLoss.setRepeat(true);
+			pictureLoss.setRoundTrip(stream.roundTrip_);
+
+			std::deque<qint64> pending;
+			Result result;
+			qint64 lost = 0;
+			auto reference = false;
+
+			for (auto frame = 0; frame < stream.frames_; ++frame) {
+				auto time = frame * FRAME_INTERVAL;
+				auto key = frame % stream.group_ == 0;
+
+				if (!pending.empty() && pending.front() <= time) {
+					key = true;
+
+					while (!pending.empty() && pending.front() <= time)
+						pending.pop_front();
+				}
+
+				auto count = key ? stream.keyPackets_ : stream.packets_;
+				auto complete = true;
+
+				if (key) ++result.keyFrames_;
+
+				for (auto i = 0; i < count; ++i) {
+					auto arrival = time + i * PACKET_INTERVAL +
+								   stream.roundTrip_ / 2;
+
+					if (chance(random) < stream.loss_) {
+						++lost;
+						complete = false;
+						continue;
+					}
+
+					if (key && complete && i == 0) pictureLoss.recover(arrival);
+
+					pictureLoss.update(lost, arrival);
+
+					if (requests && pictureLoss.collect(arrival) &&
+						chance(random) >= stream.loss_)
+						pending.push_back(arrival + stream.roundTrip_ / 2);
+				}
+
+				reference = complete && (key || reference);
+
+				if (reference) ++result.decodable_;
+			}
+
+			result.statistics_ = pictureLoss.getStatistics();
+			return result;
+		}
+	}
+
+	/// Measures recovery time after loss with and without key frame
+	/// requests.
+	/// \details Simulates a video stream over a path with loss from one
+	/// percent up to the given rate, once waiting for the next key frame
+	/// of the group of pictures and once requesting one by RTCPPictureLoss,
+	/// and reports decodable frames, the time from a loss to its key frame
+	/// and the key frame rate the requests cost.
+	/// \param[in]	arguments	Benchmark arguments.
+	/// \return Exit status.
+	int keyFrame(const QStringList& arguments) {
+		QCommandLineParser parser;
+		parser.setApplicationDescription(
+			"Measures recovery time after loss with and without key frame "
+			"requests.");
+		parser.addHelpOption();
+
+		QCommandLineOption durationOption(
+			"duration", "Simulated time.", "s", "600");
+		QCommandLineOption lossOption(
+			"loss", "Largest lost packets.", "percent", "5");
+		QCommandLineOption roundTripOption(
+			"rtt", "Round-trip time.", "ms", "50");
+		QCommandLineOption groupOption(
+			"gop", "Frames per group of pictures.", "count", "50");
+
+		parser.addOption(durationOption);
+		parser.addOption(lossOption);
+		parser.addOption(roundTripOption);
+		parser.addOption(groupOption);
+		parser.process(arguments);
+
+		Stream stream;
+		stream.frames_ = static_cast<int>(
+			parser.value(durationOption).toLongLong() * 1000 *
+			MILLISECONDS / FRAME_INTERVAL);
+		stream.group_ = parser.value(groupOption).toInt();
+		stream.keyPackets_ = 60;
+		stream.packets_ = 8;
+		stream.roundTrip_ = parser.value(roundTripOption).toLongLong() *
+							MILLISECONDS;
+
+		auto loss = parser.value(lossOption).toInt();
+
+		if (stream.frames_ <= 0 || stream.group_ <= 0 || loss <= 0 ||
+			stream.roundTrip_ <= 0)
+			parser.showHelp(1);
+
+		auto seconds = stream.frames_ * FRAME_INTERVAL / 1e9;
+
+		QTextStream output(stdout);
+		output << "loss %\tplain %\tpli %\tplain recovery ms avg/max\t"
+				  "pli recovery ms avg/max\trequests\tkey frames/s\n";
+
+		QElapsedTimer timer;
+		timer.start();
+
+		for (auto percent = 1; percent <= loss; ++percent) {
+			stream.loss_ = percent / 100.0;
+
+			auto plain = simulate(stream, false);
+			auto requested = simulate(stream, true);
+
+			auto mean = [](const RTCPPictureLossStatistics& statistics) {
+				return statistics.recoveries_ > 0
+					   ? statistics.totalRecoveryTime_ / 1e6 /
+						 statistics.recoveries_
+					   : 0.0;
+			};
+
+			output << percent << "\t"
+				   << 100.0 * plain.decodable_ / stream.frames_ << "\t"
+				   << 100.0 * requested.decodable_ / stream.frames_ << "\t"
+				   << mean(plain.statistics_) << "/"
+				   << plain.statistics_.maxRecoveryTime_ / 1e6 << "\t"
+				   << mean(requested.statistics_) << "/"
+				   << requested.statistics_.maxRecoveryTime_ / 1e6 << "\t"
+				   << requested.statistics_.requested_ << "\t"
+				   << plain.keyFrames_ / seconds << " -> "
+				   << requested.keyFrames_ / seconds << "\n";
+		}
+
+		output << "simulation, ms:       " << timer.nsecsElapsed() / 1e6
+			   << "\n";
+
+		return 0;
+	}
+}
@@ -0,0 +1,370 @@
+/// \file NackBenchmark.cpp
+/// \brief Contains definitions of the retransmission request benchmark.
+/// \bug No known bugs.
+
+#include "Benchmarks.hpp"
+
+#include "RTSPClient/Protocols/RTCP/RTCPNackList.hpp"
+
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+#include <algorithm>
+#include <queue>
+#include <random>
+#include <vector>
+
+/// Contains the library benchmarks.
+namespace Benchmarks {
+
+	namespace {
+
+		using RTSPLib::RTSPClient::RTCPNackList;
+		using RTSPLib::RTSPClient::RTCPNackStatistics;
+
+		/// Nanoseconds per millisecond.
+		/// \details Times of the simulation are kept in nanoseconds.
+		constexpr qint64 MILLISECONDS { 1000000 };
+
+		/// Frame interval.
+		/// \details Forty milliseconds, twenty-five frames per second.
+		constexpr qint64 FRAME_INTERVAL { 40 * MILLISECONDS };
+
+		/// Interval between packets of a frame.
+		/// \details A tenth of a millisecond, the pacing of a camera.
+		constexpr qint64 PACKET_INTERVAL { MILLISECONDS / 10 };
+
+		/// Resolution of the fallback timer.
+		/// \details A hundred milliseconds, as RTSPKeepAliveScheduler
+		/// fires.
+		constexpr qint64 TIMER_RESOLUTION { 100 * MILLISECONDS };
+
+		/// Shortest interval between feedback packets.
+		/// \details Ten milliseconds, as the client sends them.
+		constexpr qint64 FEEDBACK_INTERVAL { 10 * MILLISECONDS };
+
+		/// Maximum number of packets requested by a feedback packet.
+		/// \details As the client requests them.
+		constexpr int MAX_NACKS { 64 };
+
+		/// Enumeration that defines events of the simulation.
+		enum class EventType {
+
+			/// Original packet arrives at the receiver.
+			Original,
+
+			/// Retransmission arrives at the receiver.
+			Retransmission,
+
+			/// Request of a packet arrives at the sender.
+			Request,
+
+			/// Fallback timer of the receiver fires.
+			Timer
+		};
+
+		/// Structure that describes an event of the simulation.
+		struct Event final {
+
+			/// Time in nanoseconds.
+			qint64 time_;
+
+			/// Event type.
+			EventType type_;
+
+			/// Packet index.
+			int packet_;
+
+			/// Orders events by time, earliest first.
+			/// \param[in]	other	Event to compare with.
+			/// \retval true if this event is later.
+			/// \retval false otherwise.
+			bool operator<(const Event& other) const {
+				return time_ > other.time_;
+			}
+		};
+
+		/// Structure that describes a synthetic stream.
+		struct Stream final {
+
+			/// Number of frames.
+			int frames_;
+
+			/// Frames per group of pictures.
+			int group_;
+
+			/// Packets of a key frame.
+			int keyPackets_;
+
+			/// Packets of a predicted frame.
+			int packets_;
+
+			/// Probability of a lost packet.
+			double loss_;
+
+			/// Round-trip time in nanoseconds.
+			qint64 roundTrip_;
+
+			/// Mean network jitter in nanoseconds.
+			double jitter_;
+
+			/// Playout delay in nanoseconds.
+			qint64 delay_;
+		};
+
+		/// Structure that describes results of a simulation.
+		struct Result final {
+
+			/// Number of decodable frames.
+			int decodable_ { 0 };
+
+			/// Number of lost original packets.
+			quint64 lost_ { 0 };
+
+			/// Number of feedback packets.
+			quint64 feedback_ { 0 };
+
+			/// Retransmission statistics.
+			RTCPNackStatistics statistics_;
+		};
+
+		/// Simulates a stream over a lossy path.
+		/// \details Frames are sent as bursts of packets. Lost packets are
+		/// requested as the client requests them: when packets arrive and,
+		/// while the stream stalls, when the coarse fallback timer fires.
+		/// Requests and retransmissions are lost like originals. A frame is
+		/// decodable if it is complete by its playout time and its
+		/// reference frames since the last key frame are decodable.
+		/// \param[in]	stream	Stream.
+		/// \param[in]	nack	Whether lost packets are requested.
+		/// \return Results.
+		Result simulate(const Stream& stream, bool nack) {
+			std::mt19937 random(1);
+			std::uniform_real_distribution<double> chance(0, 1);
+			std::exponential_distribution<double> jitter(1 / stream.jitter_);
+
+			auto transit = [&]() {
+				return stream.roundTrip_ / 2 +
+					   static_cast<qint64>(jitter(random));
+			};
+
+			std::vector<int> frames;
+			std::vector<qint64> sent, arrived;
+			std::priority_queue<Event> events;
+			Result result;
+
+			for (auto frame = 0; frame < stream.frames_; ++frame) {
+				auto count = frame % stream.group_ == 0
+							 ? stream.keyPackets_
+							 : stream.packets_;
+
+				for (auto i = 0; i < count; ++i) {
+					auto index = static_cast<int>(sent.size());
+					auto time = frame * FRAME_INTERVAL + i * PACKET_INTERVAL;
+
+					frames.push_back(frame);
+					sent.push_back(time);
+					arrived.push_back(-1);
+
+					if (chance(random) < stream.loss_) ++result.lost_;
+					else events.push({ time + transit(),
+									   EventType::Original, index });
+				}
+			}
+
+			RTCPNackList nacks;
+			nacks.setRoundTrip(stream.roundTrip_);
+			nacks.setMaxDelay(stream.delay_);
+
+			auto first = static_cast<quint16>(random());
+			auto feedbackTime = -FEEDBACK_INTERVAL;
+			auto timer = false;
+			auto highest = 0;
+
+			auto request = [&](qint64 now) {
+				auto deadline = nacks.getDeadline();
+
+				if (deadline >= 0 && deadline <= now &&
+					now - feedbackTime >= FEEDBACK_INTERVAL) {
+
+					quint16 sequences[MAX_NACKS];
+					auto count = nacks.collect(now, sequences, MAX_NACKS);
+
+					if (count > 0) {
+						++result.feedback_;
+						feedbackTime = now;
+
+						if (chance(random) >= stream.loss_) {
+							auto time = now + transit();
+
+							for (auto i = 0; i < count; ++i)
+								events.push({ time, EventType::Request,
+											  highest + static_cast<qint16>(
+												  sequences[i] - first -
+												  highest) });
+						}
+					}
+				}
+
+				deadline = nacks.getDeadline();
+
+				if (timer || deadline < 0) return;
+
+				timer = true;
+				events.push({ (std::max(deadline, now) / TIMER_RESOLUTION + 1) *
+							  TIMER_RESOLUTION, EventType::Timer, 0 });
+			};
+
+			while (!events.empty()) {
+				auto event = events.top();
+				events.pop();
+
+				auto sequence = static_cast<quint16>(first + event.packet_);
+				auto& arrival = arrived[static_cast<std::size_t>(
+					event.packet_)];
+
+				switch (event.type_) {
+				case EventType::Original:
+					if (arrival < 0) arrival = event.time_;
+					if (!nack) break;
+
+					highest = std::max(highest, event.packet_);
+
+					nacks.update(sequence, event.time_);
+					request(event.time_);
+					break;
+
+				case EventType::Retransmission:
+					if (arrival < 0) arrival = event.time_;
+
+					nacks.recover(sequence, event.time_);
+					break;
+
+				case EventType::Request:
+					if (chance(random) >= stream.loss_)
+						events.push({ event.time_ + transit(),
+									  EventType::Retransmission,
+									  event.packet_ });
+					break;
+
+				case EventType::Timer:
+					timer = false;
+					request(event.time_);
+					break;
+				}
+			}
+
+			std::vector<qint64> complete(
+				static_cast<std::size_t>(stream.frames_), 0);
+
+			for (std::size_t i = 0; i < sent.size(); ++i) {
+				auto& time = complete[static_cast<std::size_t>(frames[i])];
+
+				if (time < 0) continue;
+
+				time = arrived[i] < 0 ? -1 : std::max(time, arrived[i]);
+			}
+
+			auto reference = false;
+
+			for (auto frame = 0; frame < stream.frames_; ++frame) {
+				auto time = complete[static_cast<std::size_t>(frame)];
+				auto intact = time >= 0 &&
+							  time <= frame * FRAME_INTERVAL + stream.delay_;
+
+				reference = intact &&
+							(frame % stream.group_ == 0 || reference);
+
+				if (reference) ++result.decodable_;
+			}
+
+			result.statistics_ = nacks.getStatistics();
+			return result;
+		}
+	}
+
+	/// Measures decodable frames under loss with and without NACK.
+	/// \details Simulates a video stream over a path with loss from one
+	/// percent up to the given rate, once without and once with generic
+	/// negative acknowledgements scheduled by RTCPNackList, and reports
+	/// the share of decodable frames together with the requests, the
+	/// recovered and the given up packets and the feedback rate.
+	/// \param[in]	arguments	Benchmark arguments.
+	/// \return Exit status.
+	int nack(const QStringList& arguments) {
+		QCommandLineParser parser;
+		parser.setApplicationDescription(
+			"Measures decodable frames under loss with and without NACK.");
+		parser.addHelpOption();
+
+		QCommandLineOption durationOption(
+			"duration", "Simulated time.", "s", "600");
+		QCommandLineOption lossOption(
+			"loss", "Largest lost packets.", "percent", "5");
+		QCommandLineOption roundTripOption(
+			"rtt", "Round-trip time.", "ms", "50");
+		QCommandLineOption jitterOption(
+			"jitter", "Mean network jitter.", "ms", "1");
+		QCommandLineOption delayOption(
+			"delay", "Playout delay.", "ms", "500");
+		QCommandLineOption groupOption(
+			"gop", "Frames per group of pictures.", "count", "50");
+
+		parser.addOption(durationOption);
+		parser.addOption(lossOption);
+		parser.addOption(roundTripOption);
+		parser.addOption(jitterOption);
+		parser.addOption(delayOption);
+		parser.addOption(groupOption);
+		parser.process(arguments);
+
+		Stream stream;
+		stream.frames_ = static_cast<int>(
+			parser.value(durationOption).toLongLong() * 1000 *
+			MILLISECONDS / FRAME_INTERVAL);
+		stream.group_ = parser.value(groupOption).toInt();
+		stream.keyPackets_ = 60;
+		stream.packets_ = 8;
+		stream.roundTrip_ = parser.value(roundTripOption).toLongLong() *
+							MILLISECONDS;
+		stream.jitter_ = parser.value(jitterOption).toDouble() * 1e6;
+		stream.delay_ = parser.value(delayOption).toLongLong() * MILLISECONDS;
+
+		auto loss = parser.value(lossOption).toInt();
+
+		if (stream.frames_ <= 0 || stream.group_ <= 0 || loss <= 0 ||
+			stream.roundTrip_ <= 0 || stream.jitter_ <= 0 ||
+			stream.delay_ <= 0)
+			parser.showHelp(1);
+
+		QTextStream output(stdout);
+		output << "loss %\tplain %\tnack %\tlost\trequests\trecovered\t"
+				  "unrecovered\tfeedback/s\n";
+
+		QElapsedTimer timer;
+		timer.start();
+
+		for (auto percent = 1; percent <= loss; ++percent) {
+			stream.loss_ = percent / 100.0;
+
+			auto plain = simulate(stream, false);
+			auto requested = simulate(stream, true);
+			auto seconds = stream.frames_ * FRAME_INTERVAL / 1e9;
+
+			output << percent << "\t"
+				   << 100.0 * plain.decodable_ / stream.frames_ << "\t"
+				   << 100.0 * requested.decodable_ / stream.frames_ << "\t"
+				   << requested.lost_ << "\t"
+				   << requested.statistics_.requested_ << "\t"
+				   << requested.statistics_.recovered_ << "\t"
+				   << requested.statistics_.unrecovered_ << "\t"
+				   << requested.feedback_ / seconds << "\n";
+		}
+
+		output << "simulation, ms:       " << timer.nsecsElapsed() / 1e6
+			   << "\n";
+
+		return 0;
+	}
+}
@@ -0,0 +1,149 @@
+/// \file PacketBenchmark.cpp
+/// \brief Contains definitions of the RTP packet parsing benchmark.
+/// \bug No known bugs.
+
+#include "Benchmarks.hpp"
+
+#include "RTSPClient/Protocols/RTP/RTPPacket.hpp"
+#include "RTSPClient/Protocols/RTP/RTPPacketView.hpp"
+
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QVector>
+
+/// Contains the library benchmarks.
+namespace Benchmarks {
+
+	namespace {
+
+		using RTSPLib::RTSPClient::RTPPacket;
+		using RTSPLib::RTSPClient::RTPPacketView;
+
+		/// Builds a sample RTP packet.
+		/// \param[in]	size		Payload size.
+		/// \param[in]	sources		Number of contributing sources.
+		/// \param[in]	extension	Header extension size in 32-bit words.
+		/// \param[in]	padding		Padding size.
+		/// \return Packet data.
+		QByteArray samplePacket(int size,
+								int sources,
+								int extension,
+								int padding) {
+			QByteArray packet;
+
+			packet.append(static_cast<char>(0x80 |
+											(padding > 0 ? 0x20 : 0) |
+											(extension > 0 ? 0x10 : 0) |
+											sources));
+			packet.append(static_cast<char>(0x80 | 96));
+			packet.append("\x12\x34", 2);
+			packet.append("\x00\x01\x5F\x90", 4);
+			packet.append("\x5A\x3B\x2C\x1D", 4);
+
+			for (auto i = 0; i < sources; ++i)
+				packet.append("\x00\x00\x00", 3).append(static_cast<char>(i));
+
+			if (extension > 0) {
+				packet.append("\xBE\xDE", 2);
+				packet.append(static_cast<char>(extension >> 8));
+				packet.append(static_cast<char>(extension));
+				packet.append(QByteArray(extension * 4, '\x01'));
+			}
+
+			packet.append(QByteArray(size, '\x7C'));
+
+			if (padding > 0) {
+				packet.append(QByteArray(padding - 1, '\0'));
+				packet.append(static_cast<char>(padding));
+			}
+
+			return packet;
+		}
+	}
+
+	/// Measures RTP packet parsing throughput.
+	/// \details Parses sample packets with the copying RTPPacket parser and
+	/// with RTPPacketView, reading the header, CSRC, extension and payload
+	/// of every packet.
+	/// \param[in]	arguments	Benchmark arguments.
+	/// \return Exit status.
+	int packet(const QStringList& arguments) {
+		QCommandLineParser parser;
+		parser.setApplicationDescription(
+			"Measures RTP packet parsing throughput.");
+		parser.addHelpOption();
+
+		QCommandLineOption iterationsOption(
+			"iterations", "Number of packet sets.", "count", "1000000");
+		QCommandLineOption sizeOption(
+			"size", "Payload size.", "bytes", "1400");
+
+		parser.addOption(iterationsOption);
+		parser.addOption(sizeOption);
+		parser.process(arguments);
+
+		auto iterations = parser.value(iterationsOption).toInt();
+		auto size = parser.value(sizeOption).toInt();
+
+		if (iterations <= 0 || size <= 0) parser.showHelp(1);
+
+		const QVector<QByteArray> packets {
+			samplePacket(size, 0, 0, 0),
+			samplePacket(size, 2, 2, 0),
+			samplePacket(size, 0, 0, 4)
+		};
+
+		auto count = static_cast<double>(iterations) * packets.size();
+
+		QElapsedTimer timer;
+		qint64 copyChecksum = 0, viewChecksum = 0;
+
+		timer.start();
+
+		for (auto i = 0; i < iterations; ++i) {
+			for (const auto& data : packets) {
+				auto packet = RTPPacket::parse(data);
+
+				copyChecksum += packet.getSequenceNumber();
+				copyChecksum += packet.getCSRC().size();
+				copyChecksum += packet.getHeaderExtension().size();
+				copyChecksum += packet.getPayloadData().size();
+				copyChecksum += packet.getPayloadData().at(0);
+			}
+		}
+
+		auto copy = timer.nsecsElapsed() / 1e9;
+
+		timer.restart();
+
+		for (auto i = 0; i < iterations; ++i) {
+			for (const auto& data : packets) {
+				auto packet = RTPPacketView::parse(data);
+
+				viewChecksum += packet.getSequenceNumber();
+				viewChecksum += packet.getCSRCCount();
+				viewChecksum += packet.getHeaderExtension().size_;
+				viewChecksum += packet.getPayloadData().size_;
+				viewChecksum += packet.getPayloadData().data_[0];
+			}
+		}
+
+		auto view = timer.nsecsElapsed() / 1e9;
+
+		QTextStream output(stdout);
+		output << "packets:           " << count << "\n"
+			   << "copy, packets/s:   " << (copy > 0 ? count / copy : 0)
+			   << "\n"
+			   << "copy, ns/packet:   " << copy * 1e9 / count << "\n"
+			   << "view, packets/s:   " << (view > 0 ? count / view : 0)
+			   << "\n"
+			   << "view, ns/packet:   " << view * 1e9 / count << "\n"
+			   << "speedup:           " << (view > 0 ? copy / view : 0)
+			   << "\n"
+			   << "checksums match:   "
+			   << (copyChecksum == viewChecksum ? "yes" : "no") << "\n";
+
+		return copyChecksum == viewChecksum ? 0 : 1;
+	}
+}
@@ -0,0 +1,203 @@
+/// \file ParserBenchmark.cpp
+/// \brief Contains definitions of the response parsing benchmark.
+/// \bug No known bugs.
+
+#include "Benchmarks.hpp"
+
+#include "RTSPClient/Protocols/RTSP/RTSPResponseParser.hpp"
+
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QMap>
+#include <QTextStream>
+
+#include <algorithm>
+
+/// Contains the library benchmarks.
+namespace Benchmarks {
+
+	namespace {
+
+		using RTSPLib::RTSPClient::RTSPResponseParser;
+
+		/// Sample RTSP response headers.
+		/// \details Typical OPTIONS, SETUP and PLAY responses of a camera.
+		const char* const RESPONSES[] {
+			"RTSP/1.0 200 OK\r\n"
+			"CSeq: 1\r\n"
+			"Date: Thu, Jan 01 1970 00:00:00 GMT\r\n"
+			"Public: OPTIONS, DESCRIBE, SETUP, TEARDOWN, PLAY, PAUSE, "
+			"GET_PARAMETER, SET_PARAMETER\r\n"
+			"\r\n",
+
+			"RTSP/1.0 200 OK\r\n"
+			"CSeq: 3\r\n"
+			"Date: Thu, Jan 01 1970 00:00:00 GMT\r\n"
+			"Transport: RTP/AVP/TCP;unicast;interleaved=0-1;ssrc=5A3B2C1D;"
+			"mode=\"play\"\r\n"
+			"Session: 1234567890ABCDEF;timeout=60\r\n"
+			"\r\n",
+
+			"RTSP/1.0 200 OK\r\n"
+			"CSeq: 4\r\n"
+			"Date: Thu, Jan 01 1970 00:00:00 GMT\r\n"
+			"Range: npt=0.000-\r\n"
+			"Session: 1234567890ABCDEF\r\n"
+			"RTP-Info: url=rtsp://127.0.0.1:554/stream/track1;seq=4567;"
+			"rtptime=123456789\r\n"
+			"\r\n"
+		};
+
+		/// Splits responses into header lines.
+		/// \details libcurl delivers headers to the callback line by line.
+		/// \return Header lines.
+		QList<QByteArray> headerLines() {
+			QList<QByteArray> lines;
+
+			for (auto response : RESPONSES) {
+				auto data = QByteArray(response);
+				auto begin = 0;
+
+				for (auto end = data.indexOf('\n');
+					 end >= 0;
+					 end = data.indexOf('\n', begin)) {
+					lines.append(data.mid(begin, end - begin + 1));
+					begin = end + 1;
+				}
+			}
+
+			return lines;
+		}
+
+		/// Parses a header line the way the client used to.
+		/// \details Splits the line into QByteArray lists and looks method
+		/// names up in a QMap.
+		/// \param[in]	data	Line data.
+		/// \param[in]	size	Line size.
+		/// \param[out]	methods	Number of supported methods.
+		/// \return Status code or 0.
+		int parseSplit(const char* data, int size, int* methods) {
+			auto header = QByteArray::fromRawData(data, size);
+			auto lines = header.split('\n');
+			auto status = 0;
+
+			auto line = std::find_if(lines.cbegin(),
+									 lines.cend(),
+									 [&](const QByteArray& a) {
+				return a.startsWith("RTSP/");
+			});
+
+			if (line != lines.cend()) {
+				auto tokens = line->split(' ');
+				status = tokens.size() >= 3 ? tokens[1].toInt() : 0;
+			}
+
+			auto token = QByteArray("Public:");
+
+			line = std::find_if(lines.cbegin(),
+								lines.cend(),
+								[&](const QByteArray& a) {
+				return a.startsWith(token);
+			});
+
+			if (line != lines.cend()) {
+				static const QMap<QString, qint64> map {
+					{ "OPTIONS",		1	},
+					{ "DESCRIBE",		2	},
+					{ "ANNOUNCE",		3	},
+					{ "SETUP",			4	},
+					{ "PLAY",			5	},
+					{ "PAUSE",			6	},
+					{ "TEARDOWN",		7	},
+					{ "GET_PARAMETER",	8	},
+					{ "SET_PARAMETER",	9	},
+					{ "RECORD",			10	}
+				};
+
+				for (const auto& option : line->mid(token.size()).split(','))
+					if (map.contains(option.trimmed())) ++*methods;
+			}
+
+			return status;
+		}
+	}
+
+	/// Measures RTSP response header parsing throughput.
+	/// \details Feeds sample responses line by line, as the curl header
+	/// callback does, to the old split-based parsing and to
+	/// RTSPResponseParser.
+	/// \param[in]	arguments	Benchmark arguments.
+	/// \return Exit status.
+	int parser(const QStringList& arguments) {
+		QCommandLineParser parser;
+		parser.setApplicationDescription(
+			"Measures RTSP response header parsing throughput.");
+		parser.addHelpOption();
+
+		QCommandLineOption iterationsOption(
+			"iterations", "Number of response sets.", "count", "200000");
+
+		parser.addOption(iterationsOption);
+		parser.process(arguments);
+
+		auto iterations = parser.value(iterationsOption).toInt();
+		if (iterations <= 0) parser.showHelp(1);
+
+		auto lines = headerLines();
+		auto bytes = 0;
+		for (const auto& line : lines) bytes += line.size();
+
+		auto responses = static_cast<double>(iterations) *
+						 (sizeof(RESPONSES) / sizeof(RESPONSES[0]));
+		auto volume = static_cast<double>(iterations) * bytes;
+
+		QElapsedTimer timer;
+		qint64 checksum = 0;
+
+		timer.start();
+
+		for (auto i = 0; i < iterations; ++i) {
+			auto methods = 0;
+
+			for (const auto& line : lines)
+				checksum += parseSplit(line.constData(), line.size(), &methods);
+
+			checksum += methods;
+		}
+
+		auto split = timer.nsecsElapsed() / 1e9;
+
+		RTSPResponseParser responseParser;
+
+		timer.restart();
+
+		for (auto i = 0; i < iterations; ++i) {
+			for (const auto& line : lines) {
+				responseParser.feed(line.constData(),
+									static_cast<size_t>(line.size()));
+
+				if (responseParser.isComplete()) {
+					checksum += static_cast<int>(
+						responseParser.getStatusCode());
+					checksum += responseParser.getMethods();
+				}
+			}
+		}
+
+		auto streaming = timer.nsecsElapsed() / 1e9;
+
+		QTextStream output(stdout);
+		output << "responses:              " << responses << "\n"
+			   << "split, responses/s:     "
+			   << (split > 0 ? responses / split : 0) << "\n"
+			   << "split, MB/s:            "
+			   << (split > 0 ? volume / split / 1e6 : 0) << "\n"
+			   << "streaming, responses/s: "
+			   << (streaming > 0 ? responses / streaming : 0) << "\n"
+			   << "streaming, MB/s:        "
+			   << (streaming > 0 ? volume / streaming / 1e6 : 0) << "\n"
+			   << "checksum:               " << checksum << "\n";
+
+		return 0;
+	}
+}
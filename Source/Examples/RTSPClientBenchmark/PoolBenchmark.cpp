@@ -0,0 +1,526 @@
+/// \file PoolBenchmark.cpp
+/// \brief Contains definitions of the client pool benchmark.
+/// \bug No known bugs.
+
+#include "Benchmarks.hpp"
+
+#include "RTSPClient/Client/RTSPClientPool.hpp"
+
+#include <QCommandLineParser>
+#include <QEventLoop>
+#include <QHash>
+#include <QSemaphore>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTextStream>
+#include <QThread>
+#include <QTimer>
+#include <QUdpSocket>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/// Contains the library benchmarks.
+namespace Benchmarks {
+
+	namespace {
+
+		using RTSPLib::RTSPClient::RTSPBackend;
+		using RTSPLib::RTSPClient::RTSPClient;
+		using RTSPLib::RTSPClient::RTSPClientPool;
+		using RTSPLib::RTSPClient::RTSPTransport;
+
+		/// Session description served by the loopback server.
+		/// \details One video track, media is sent by sender threads.
+		constexpr char SDP[] {
+			"v=0\r\n"
+			"o=- 0 0 IN IP4 127.0.0.1\r\n"
+			"s=Pool\r\n"
+			"t=0 0\r\n"
+			"m=video 0 RTP/AVP 96\r\n"
+			"a=rtpmap:96 H264/90000\r\n"
+			"a=control:track1\r\n"
+		};
+
+		/// Time before packets are counted in milliseconds.
+		/// \details Lets the balancer measure the load and move sessions.
+		constexpr int WARMUP { 3000 };
+
+		/// Balance interval of the pool in milliseconds.
+		/// \details Shorter than the default, so that the warmup covers
+		/// several balance rounds.
+		constexpr int BALANCE_INTERVAL { 500 };
+
+		/// Returns header value of an RTSP request.
+		/// \param[in]	request	RTSP request.
+		/// \param[in]	name	Lower case header name with colon.
+		/// \return Header value or empty array if it is missing.
+		QByteArray headerValue(const QByteArray& request,
+							   const QByteArray& name) {
+
+			auto lower = request.toLower();
+			auto begin = lower.indexOf("\r\n" + name);
+			if (begin < 0) return { };
+
+			begin += name.size() + 2;
+			auto end = request.indexOf("\r\n", begin);
+
+			return request.mid(begin, end - begin).trimmed();
+		}
+
+		/// Class that provides minimal RTSP server on the loopback interface.
+		/// \details Runs on its own thread and answers every request with
+		/// success, echoing the transport of SETUP. Media is not sent by the
+		/// server.
+		class LoopbackServer final : public QThread {
+		public:
+
+			/// Starts the server thread and waits until it listens.
+			/// \return Server port or zero on error.
+			quint16 listen() {
+				start();
+				ready_.acquire();
+
+				return port_;
+			}
+
+		protected:
+
+			/// Runs the server event loop.
+			/// \details Server objects live on the server thread.
+			void run() override {
+				QHash<QTcpSocket*, QByteArray> buffers;
+				QTcpServer server;
+
+				if (server.listen(QHostAddress::LocalHost))
+					port_ = server.serverPort();
+
+				ready_.release();
+
+				if (!port_) return;
+
+				QObject::connect(&server, &QTcpServer::newConnection, [&]() {
+					while (server.hasPendingConnections()) {
+						auto socket = server.nextPendingConnection();
+
+						QObject::connect(socket, &QTcpSocket::readyRead,
+										 [&, socket]() {
+							auto& buffer = buffers[socket];
+							buffer += socket->readAll();
+							respond(*socket, buffer);
+						});
+
+						QObject::connect(socket, &QTcpSocket::disconnected,
+										 [&, socket]() {
+							buffers.remove(socket);
+							socket->deleteLater();
+						});
+					}
+				});
+
+				exec();
+			}
+
+		private:
+
+			/// Answers complete requests of a connection.
+			/// \param[in]	socket	Connection.
+			/// \param[in]	buffer	Received data.
+			void respond(QTcpSocket& socket, QByteArray& buffer) {
+				for (auto end = buffer.indexOf("\r\n\r\n");
+					 end >= 0;
+					 end = buffer.indexOf("\r\n\r\n")) {
+
+					auto request = buffer.left(end + 2);
+					buffer.remove(0, end + 4);
+
+					socket.write(answer(request));
+				}
+			}
+
+			/// Builds the response to a request.
+			/// \param[in]	request	RTSP request.
+			/// \return RTSP response.
+			QByteArray answer(const QByteArray& request) {
+				auto method = request.left(request.indexOf(' '));
+				auto session = headerValue(request, "session:");
+
+				QByteArray headers, body;
+
+				if (method == "OPTIONS")
+					headers = "Public: OPTIONS, DESCRIBE, SETUP, PLAY, "
+							  "PAUSE, GET_PARAMETER, TEARDOWN\r\n";
+				else if (method == "DESCRIBE") {
+					body = SDP;
+					headers = "Content-Type: application/sdp\r\n";
+				}
+				else if (method == "SETUP") {
+					if (session.isEmpty())
+						session = QByteArray::number(++sessions_);
+
+					headers = "Transport: " +
+							  headerValue(request, "transport:") + "\r\n" +
+							  "Session: " + session + "\r\n";
+				}
+				else if (!session.isEmpty())
+					headers = "Session: " + session + "\r\n";
+
+				return "RTSP/1.0 200 OK\r\n"
+					   "CSeq: " + headerValue(request, "cseq:") + "\r\n" +
+					   headers +
+					   "Content-Length: " +
+					   QByteArray::number(body.size()) + "\r\n\r\n" +
+					   body;
+			}
+
+		private:
+
+			/// Server port.
+			quint16 port_ { 0 };
+
+			/// Signals the listening server.
+			QSemaphore ready_;
+
+			/// Number of sessions created.
+			quint64 sessions_ { 0 };
+		};
+
+		/// Class that provides RTP sender thread.
+		/// \details Sends packets to its streams round after round as fast
+		/// as the loopback interface takes them. Hot streams get several
+		/// packets per round.
+		class Sender final : public QThread {
+		public:
+
+			/// Constructor.
+			/// \param[in]	ports	RTP ports and packets per round.
+			/// \param[in]	size	Packet size.
+			explicit Sender(const QVector<QPair<quint16, int>>& ports,
+							int size)
+				: ports_(ports),
+				  size_(size) {
+			}
+
+		public:
+
+			/// Stops sending.
+			void stop() {
+				running_ = false;
+				wait();
+			}
+
+			/// Returns number of sent packets.
+			/// \return Number of sent packets.
+			quint64 getSentCount() const {
+				return sent_.load(std::memory_order_relaxed);
+			}
+
+		protected:
+
+			/// Sends packets until stopped.
+			/// \details Packets carry an RTP header with a growing sequence
+			/// number.
+			void run() override {
+				QUdpSocket socket;
+				QByteArray packet(size_, '\0');
+
+				packet[0] = static_cast<char>(0x80);
+				packet[1] = static_cast<char>(96);
+
+				quint16 sequence = 0;
+
+				while (running_) {
+					for (const auto& port : ports_) {
+						for (auto i = 0; i < port.second; ++i) {
+							packet[2] = static_cast<char>(sequence >> 8);
+							packet[3] = static_cast<char>(sequence);
+							++sequence;
+
+							if (socket.writeDatagram(packet,
+													 QHostAddress::LocalHost,
+													 port.first) > 0)
+								sent_.fetch_add(1, std::memory_order_relaxed);
+						}
+					}
+				}
+			}
+
+		private:
+
+			/// RTP ports and packets per round.
+			const QVector<QPair<quint16, int>> ports_;
+
+			/// Packet size.
+			const int size_;
+
+			/// Whether the sender runs.
+			std::atomic<bool> running_ { true };
+
+			/// Number of sent packets.
+			std::atomic<quint64> sent_ { 0 };
+		};
+
+		/// Structure that describes a benchmark run.
+		struct Result final {
+
+			/// Number of set up streams.
+			int streams_ { 0 };
+
+			/// Packets sent per second.
+			double sent_ { 0 };
+
+			/// Packets received per second.
+			double received_ { 0 };
+
+			/// Lowest shard utilization.
+			double minimumUtilization_ { 0 };
+
+			/// Highest shard utilization.
+			double maximumUtilization_ { 0 };
+
+			/// Number of moved sessions.
+			quint64 migrations_ { 0 };
+		};
+
+		/// Runs streams on a pool with the given number of shards.
+		/// \param[in]	url			RTSP connection URL.
+		/// \param[in]	shards		Number of shards.
+		/// \param[in]	streams		Number of streams.
+		/// \param[in]	senders		Number of sender threads.
+		/// \param[in]	size		Packet size.
+		/// \param[in]	skew		Packets per round of hot streams.
+		/// \param[in]	port		First client port.
+		/// \param[in]	duration	Measurement time in milliseconds.
+		/// \param[in]	backend		RTSP protocol backend.
+		/// \return Benchmark run result.
+		Result run(const QUrl& url,
+				   int shards,
+				   int streams,
+				   int senders,
+				   int size,
+				   int skew,
+				   quint16 port,
+				   int duration,
+				   RTSPBackend backend) {
+
+			Result result;
+			RTSPClientPool pool(shards);
+			pool.setBalanceInterval(BALANCE_INTERVAL);
+
+			QVector<RTSPClient*> clients;
+			QVector<QVector<QPair<quint16, int>>> ports(senders);
+
+			for (auto i = 0; i < streams; ++i) {
+				auto client = pool.create();
+				auto rtp = static_cast<quint16>(port + 2 * i);
+				auto ok = false;
+
+				auto rtcp = static_cast<quint16>(rtp + 1);
+
+				QMetaObject::invokeMethod(client, [&]() {
+					client->setTransport(RTSPTransport::UDP);
+					client->setBackend(backend);
+
+					ok = client->open(url)							&&
+						 client->setup(QUrl("track1"), { rtp, rtcp })	&&
+						 client->play();
+				}, Qt::BlockingQueuedConnection);
+
+				if (!ok) {
+					QTextStream(stderr) << "Session " << i << " failed\n";
+					pool.destroy(client);
+					continue;
+				}
+
+				clients.append(client);
+
+				ports[i % senders].append(
+					{ rtp, i % pool.getShardCount() == 0 ? skew : 1 });
+			}
+
+			result.streams_ = clients.size();
+
+			std::vector<std::unique_ptr<Sender>> threads;
+
+			for (const auto& list : ports) {
+				threads.emplace_back(new Sender(list, size));
+				threads.back()->start();
+			}
+
+			auto count = [&clients, &threads](quint64& sent) {
+				quint64 received = 0;
+
+				for (auto client : clients)
+					received += client->getPacketCount();
+
+				sent = 0;
+
+				for (const auto& thread : threads)
+					sent += thread->getSentCount();
+
+				return received;
+			};
+
+			QEventLoop loop;
+			QTimer::singleShot(WARMUP, &loop, SLOT(quit()));
+			loop.exec();
+
+			quint64 sentBefore = 0, sentAfter = 0;
+
+			QElapsedTimer clock;
+			clock.start();
+
+			auto receivedBefore = count(sentBefore);
+
+			QTimer::singleShot(duration, &loop, SLOT(quit()));
+			loop.exec();
+
+			auto receivedAfter = count(sentAfter);
+			auto seconds = clock.nsecsElapsed() / 1e9;
+
+			for (const auto& thread : threads) thread->stop();
+
+			result.sent_ = (sentAfter - sentBefore) / seconds;
+			result.received_ = (receivedAfter - receivedBefore) / seconds;
+
+			auto statistics = pool.getStatistics();
+			result.minimumUtilization_ = 1;
+
+			for (const auto& shard : statistics) {
+				result.minimumUtilization_ =
+					qMin(result.minimumUtilization_, shard.utilization_);
+				result.maximumUtilization_ =
+					qMax(result.maximumUtilization_, shard.utilization_);
+				result.migrations_ += shard.migratedIn_;
+			}
+
+			return result;
+		}
+	}
+
+	/// Measures packet throughput of the client pool by number of shards.
+	/// \details Streams RTP over UDP from sender threads to sessions of a
+	/// pool, once for every shard count, and prints aggregate packet rates,
+	/// shard utilization and the number of sessions moved by the balancer.
+	/// \param[in]	arguments	Benchmark arguments.
+	/// \return Exit status.
+	int pool(const QStringList& arguments) {
+		QCommandLineParser parser;
+		parser.setApplicationDescription(
+			"Measures RTP throughput of the client pool by shard count.");
+		parser.addHelpOption();
+
+		QCommandLineOption shardsOption(
+			"shards", "Comma separated shard counts, default up to the "
+			"number of cores.", "list");
+		QCommandLineOption streamsOption(
+			"streams", "Number of streams.", "count", "64");
+		QCommandLineOption sendersOption(
+			"senders", "Number of sender threads.", "count", "2");
+		QCommandLineOption sizeOption(
+			"size", "RTP packet size.", "bytes", "1200");
+		QCommandLineOption skewOption(
+			"skew", "Packets per round of hot streams.", "count", "4");
+		QCommandLineOption portOption(
+			"port", "First client port.", "port", "20000");
+		QCommandLineOption durationOption(
+			"duration", "Measurement time.", "ms", "3000");
+		QCommandLineOption backendOption(
+			"backend", "RTSP protocol backend, curl or native.", "name",
+			"curl");
+
+		parser.addOption(shardsOption);
+		parser.addOption(streamsOption);
+		parser.addOption(sendersOption);
+		parser.addOption(sizeOption);
+		parser.addOption(skewOption);
+		parser.addOption(portOption);
+		parser.addOption(durationOption);
+		parser.addOption(backendOption);
+		parser.process(arguments);
+
+		QVector<int> shards;
+
+		if (parser.isSet(shardsOption)) {
+			for (const auto& value : parser.value(shardsOption).split(','))
+				shards.append(value.toInt());
+		}
+		else {
+			auto cores = QThread::idealThreadCount();
+
+			for (auto count = 1; count < cores; count *= 2)
+				shards.append(count);
+
+			shards.append(qMax(cores, 1));
+		}
+
+		auto streams = parser.value(streamsOption).toInt();
+		auto senders = parser.value(sendersOption).toInt();
+		auto size = parser.value(sizeOption).toInt();
+		auto skew = parser.value(skewOption).toInt();
+		auto port = parser.value(portOption).toInt();
+		auto duration = parser.value(durationOption).toInt();
+		auto backend = parser.value(backendOption);
+
+		if (streams <= 0 || senders <= 0 || size < 12 || skew <= 0		||
+			port <= 0 || port + 2 * streams > 0xFFFF || duration <= 0	||
+			(backend != "curl" && backend != "native")					||
+			std::any_of(shards.cbegin(), shards.cend(),
+						[](int count) { return count <= 0; }))
+			parser.showHelp(1);
+
+		LoopbackServer server;
+
+		auto serverPort = server.listen();
+
+		if (!serverPort) {
+			server.wait();
+			QTextStream(stderr) << "Server failed to listen\n";
+			return 1;
+		}
+
+		QUrl url("rtsp://127.0.0.1:" + QString::number(serverPort) +
+				 "/stream");
+
+		QTextStream output(stdout);
+		output << "shards\tstreams\tsent/s\treceived/s\tspeedup\t"
+				  "utilization min\tutilization max\tmigrations\n";
+
+		auto baseline = 0.0;
+
+		for (auto count : shards) {
+			auto result = run(url,
+							  count,
+							  streams,
+							  senders,
+							  size,
+							  skew,
+							  static_cast<quint16>(port),
+							  duration,
+							  backend == "native"
+							  ? RTSPBackend::Native
+							  : RTSPBackend::Curl);
+
+			if (baseline <= 0) baseline = result.received_;
+
+			output << count << "\t"
+				   << result.streams_ << "\t"
+				   << qRound64(result.sent_) << "\t"
+				   << qRound64(result.received_) << "\t"
+				   << (baseline > 0 ? result.received_ / baseline : 0.0)
+				   << "\t"
+				   << result.minimumUtilization_ << "\t"
+				   << result.maximumUtilization_ << "\t"
+				   << result.migrations_ << "\n";
+
+			output.flush();
+		}
+
+		server.quit();
+		server.wait();
+
+		return 0;
+	}
+}
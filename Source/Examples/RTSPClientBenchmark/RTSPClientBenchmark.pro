@@ -0,0 +1,79 @@
+#------------------------------------------------------------------------------#
+#                                Base settings                                 #
+#------------------------------------------------------------------------------#
+
+QT				-=		gui
+QT				+=		network
+TEMPLATE		=		app
+TARGET			=		rtspclientbenchmark
+CONFIG			+=		c11 c++11 strict_c strict_c++ console
+
+
+#------------------------------------------------------------------------------#
+#                              Project definitions                             #
+#------------------------------------------------------------------------------#
+
+DEFINES			+=															\
+						QT_DEPRECATED_WARNINGS								\
+
+
+#------------------------------------------------------------------------------#
+#                             Project files settings                           #
+#------------------------------------------------------------------------------#
+
+HEADERS			+=															\
+						$$PWD/Benchmarks.hpp								\
+
+SOURCES			+=															\
+						$$PWD/main.cpp										\
+						$$PWD/SessionsBenchmark.cpp							\
+						$$PWD/FastStartBenchmark.cpp						\
+						$$PWD/ParserBenchmark.cpp							\
+						$$PWD/SetupBenchmark.cpp							\
+						$$PWD/ReconnectBenchmark.cpp						\
+						$$PWD/PoolBenchmark.cpp								\
+						$$PWD/PacketBenchmark.cpp							\
+						$$PWD/BufferBenchmark.cpp							\
+						$$PWD/SequenceBenchmark.cpp							\
+						$$PWD/DemuxBenchmark.cpp							\
+						$$PWD/ClockBenchmark.cpp							\
+						$$PWD/NackBenchmark.cpp								\
+						$$PWD/KeyFrameBenchmark.cpp							\
+
+
+#------------------------------------------------------------------------------#
+#                            External dependencies                             #
+#------------------------------------------------------------------------------#
+
+CURL_TARGET		=		curl
+CURL_INCLUDE_PATH	=	$$find_include_path($$EXTERNAL_PATH, $$CURL_TARGET)
+CURL_LIBRARY_PATH	=	$$find_library_path($$EXTERNAL_PATH, $$CURL_TARGET)
+
+
+#------------------------------------------------------------------------------#
+#                          Include directories settings                        #
+#------------------------------------------------------------------------------#
+
+INCLUDEPATH		+=															\
+						$$PWD/../../										\
+						$$PWD/../../RTSPClient								\
+						$$CURL_INCLUDE_PATH									\
+
+DEPENDPATH		+=															\
+						$$PWD/../../										\
+						$$PWD/../../RTSPClient								\
+						$$CURL_INCLUDE_PATH									\
+
+
+#------------------------------------------------------------------------------#
+#                           External libraries settings                        #
+#------------------------------------------------------------------------------#
+
+LIBS			+=															\
+						-L$$OUT_PWD/../../RTSPClient/ -lrtspclient			\
+
+LIBS			+=															\
+						-L$$CURL_LIBRARY_PATH								\
+
+LIBS			+=															\
+						-l$$CURL_TARGET										\
@@ -0,0 +1,482 @@
+/// \file ReconnectBenchmark.cpp
+/// \brief Contains definitions of the reconnect benchmark.
+/// \bug No known bugs.
+
+#include "Benchmarks.hpp"
+
+#include "RTSPClient/Client/RTSPClient.hpp"
+#include "RTSPClient/Client/RTSPReconnectPolicy.hpp"
+
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QHash>
+#include <QSemaphore>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTextStream>
+#include <QThread>
+#include <QTimer>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+/// Contains the library benchmarks.
+namespace Benchmarks {
+
+	namespace {
+
+		using RTSPLib::RTSPClient::RTSPBackend;
+		using RTSPLib::RTSPClient::RTSPClient;
+		using RTSPLib::RTSPClient::RTSPReconnectPolicy;
+		using RTSPLib::RTSPClient::RTSPTransport;
+
+		/// Length of a connection rate window in milliseconds.
+		/// \details Peak connection rate is counted per window.
+		constexpr qint64 RATE_WINDOW { 100 };
+
+		/// Session description served by the flapping server.
+		/// \details One video track without media data.
+		constexpr char SDP[] {
+			"v=0\r\n"
+			"o=- 0 0 IN IP4 127.0.0.1\r\n"
+			"s=Flapping\r\n"
+			"t=0 0\r\n"
+			"m=video 0 RTP/AVP 96\r\n"
+			"a=rtpmap:96 H264/90000\r\n"
+			"a=control:track1\r\n"
+		};
+
+		/// Returns header value of an RTSP request.
+		/// \param[in]	request	RTSP request.
+		/// \param[in]	name	Lower case header name with colon.
+		/// \return Header value or empty array if it is missing.
+		QByteArray headerValue(const QByteArray& request,
+							   const QByteArray& name) {
+
+			auto lower = request.toLower();
+			auto begin = lower.indexOf("\r\n" + name);
+			if (begin < 0) return { };
+
+			begin += name.size() + 2;
+			auto end = request.indexOf("\r\n", begin);
+
+			return request.mid(begin, end - begin).trimmed();
+		}
+
+		/// Class that provides minimal RTSP server that goes down on schedule.
+		/// \details Runs on its own thread and answers OPTIONS, DESCRIBE,
+		/// SETUP, PLAY, PAUSE, GET_PARAMETER and TEARDOWN without sending
+		/// media. Every flap drops all connections and refuses new ones for
+		/// the downtime, like a rebooting camera. Accepted connections are
+		/// counted per rate window.
+		class FlappingServer final : public QThread {
+		public:
+
+			/// Constructor.
+			/// \param[in]	clock		Benchmark clock.
+			/// \param[in]	flaps		Number of flaps.
+			/// \param[in]	uptime		Time between flaps in milliseconds.
+			/// \param[in]	downtime	Time the server stays down in
+			///							milliseconds.
+			/// \param[in]	timeout		Session timeout in seconds.
+			explicit FlappingServer(const QElapsedTimer& clock,
+									int flaps,
+									int uptime,
+									int downtime,
+									int timeout)
+				: clock_(clock),
+				  flaps_(flaps),
+				  uptime_(uptime),
+				  downtime_(downtime),
+				  timeout_(timeout) {
+			}
+
+		public:
+
+			/// Starts the server thread and waits until it listens.
+			/// \return Server port or zero on error.
+			quint16 listen() {
+				start();
+				ready_.acquire();
+
+				return port_;
+			}
+
+			/// Starts flapping.
+			/// \details Flaps repeat every uptime plus downtime.
+			void startFlapping() {
+				QMetaObject::invokeMethod(timer_, "start",
+										  Qt::QueuedConnection);
+			}
+
+			/// Returns times when the server went down.
+			/// \details Must be called after the thread is finished.
+			/// \return Times in nanoseconds of the benchmark clock.
+			const QVector<qint64>& getDownTimes() const {
+				return downs_;
+			}
+
+			/// Returns times when the server came back.
+			/// \details Must be called after the thread is finished.
+			/// \return Times in nanoseconds of the benchmark clock.
+			const QVector<qint64>& getUpTimes() const {
+				return ups_;
+			}
+
+			/// Returns number of connections accepted per rate window.
+			/// \details Must be called after the thread is finished.
+			/// \return Connection counters.
+			const QVector<int>& getWindows() const {
+				return windows_;
+			}
+
+		protected:
+
+			/// Runs the server event loop.
+			/// \details Server objects live on the server thread.
+			void run() override {
+				QList<QTcpSocket*> connections;
+				QHash<QTcpSocket*, QByteArray> buffers;
+				QTcpServer server;
+				QTimer timer;
+				auto flaps = 0;
+
+				timer.setInterval(uptime_ + downtime_);
+				timer_ = &timer;
+
+				if (server.listen(QHostAddress::LocalHost))
+					port_ = server.serverPort();
+
+				ready_.release();
+
+				if (!port_) return;
+
+				QObject::connect(&server, &QTcpServer::newConnection, [&]() {
+					while (server.hasPendingConnections()) {
+						auto socket = server.nextPendingConnection();
+						connections.append(socket);
+						record();
+
+						QObject::connect(socket, &QTcpSocket::readyRead,
+										 [&, socket]() {
+							auto& buffer = buffers[socket];
+							buffer += socket->readAll();
+							respond(*socket, buffer);
+						});
+
+						QObject::connect(socket, &QTcpSocket::disconnected,
+										 [&, socket]() {
+							connections.removeOne(socket);
+							buffers.remove(socket);
+							socket->deleteLater();
+						});
+					}
+				});
+
+				QObject::connect(&timer, &QTimer::timeout, [&]() {
+					if (flaps++ == flaps_) {
+						timer.stop();
+						return;
+					}
+
+					server.close();
+					downs_.append(clock_.nsecsElapsed());
+
+					for (auto socket : QList<QTcpSocket*>(connections))
+						socket->abort();
+
+					QTimer::singleShot(downtime_, &server, [&]() {
+						server.listen(QHostAddress::LocalHost, port_);
+						ups_.append(clock_.nsecsElapsed());
+					});
+				});
+
+				exec();
+			}
+
+		private:
+
+			/// Counts an accepted connection in its rate window.
+			void record() {
+				auto window = static_cast<int>(
+					clock_.elapsed() / RATE_WINDOW);
+
+				if (windows_.size() <= window) windows_.resize(window + 1);
+
+				++windows_[window];
+			}
+
+			/// Answers complete requests of a connection.
+			/// \param[in]	socket	Connection.
+			/// \param[in]	buffer	Received data.
+			void respond(QTcpSocket& socket, QByteArray& buffer) {
+				for (auto end = buffer.indexOf("\r\n\r\n");
+					 end >= 0;
+					 end = buffer.indexOf("\r\n\r\n")) {
+
+					auto request = buffer.left(end + 2);
+					buffer.remove(0, end + 4);
+
+					socket.write(answer(request));
+				}
+			}
+
+			/// Builds the response to a request.
+			/// \param[in]	request	RTSP request.
+			/// \return RTSP response.
+			QByteArray answer(const QByteArray& request) {
+				auto method = request.left(request.indexOf(' '));
+				auto session = headerValue(request, "session:");
+
+				QByteArray headers, body;
+
+				if (method == "OPTIONS")
+					headers = "Public: OPTIONS, DESCRIBE, SETUP, PLAY, "
+							  "PAUSE, GET_PARAMETER, TEARDOWN\r\n";
+				else if (method == "DESCRIBE") {
+					body = SDP;
+					headers = "Content-Type: application/sdp\r\n";
+				}
+				else if (method == "SETUP") {
+					if (session.isEmpty())
+						session = QByteArray::number(++sessions_);
+
+					headers = "Transport: " +
+							  headerValue(request, "transport:") + "\r\n" +
+							  "Session: " + session + ";timeout=" +
+							  QByteArray::number(timeout_) + "\r\n";
+				}
+				else if (!session.isEmpty())
+					headers = "Session: " + session + "\r\n";
+
+				return "RTSP/1.0 200 OK\r\n"
+					   "CSeq: " + headerValue(request, "cseq:") + "\r\n" +
+					   headers +
+					   "Content-Length: " +
+					   QByteArray::number(body.size()) + "\r\n\r\n" +
+					   body;
+			}
+
+		private:
+
+			/// Benchmark clock.
+			const QElapsedTimer& clock_;
+
+			/// Number of flaps.
+			const int flaps_;
+
+			/// Time between flaps in milliseconds.
+			const int uptime_;
+
+			/// Time the server stays down in milliseconds.
+			const int downtime_;
+
+			/// Session timeout in seconds.
+			const int timeout_;
+
+			/// Server port.
+			quint16 port_ { 0 };
+
+			/// Signals the listening server.
+			QSemaphore ready_;
+
+			/// Flap timer of the server thread.
+			QTimer* timer_ { nullptr };
+
+			/// Number of sessions created.
+			quint64 sessions_ { 0 };
+
+			/// Times when the server went down.
+			QVector<qint64> downs_;
+
+			/// Times when the server came back.
+			QVector<qint64> ups_;
+
+			/// Connections accepted per rate window.
+			QVector<int> windows_;
+		};
+
+		/// Structure that describes a restored session.
+		struct Recovery final {
+
+			/// Time of the restoration in nanoseconds of the benchmark clock.
+			qint64 time_;
+
+			/// Time since the connection loss in nanoseconds.
+			qint64 elapsed_;
+		};
+
+		/// Returns milliseconds for a time.
+		/// \param[in]	time	Time in nanoseconds.
+		/// \return Time in milliseconds.
+		double milliseconds(qint64 time) {
+			return time / 1e6;
+		}
+	}
+
+	/// Measures recovery of many sessions from a flapping server.
+	/// \details Brings up interleaved sessions against a local server that
+	/// drops all connections on schedule, and prints per flap recovery
+	/// times and the peak connection rate seen by the server.
+	/// \param[in]	arguments	Benchmark arguments.
+	/// \return Exit status.
+	int reconnect(const QStringList& arguments) {
+		QCommandLineParser parser;
+		parser.setApplicationDescription(
+			"Measures session recovery from a flapping local RTSP server.");
+		parser.addHelpOption();
+
+		QCommandLineOption clientsOption(
+			"clients", "Number of sessions.", "count", "64");
+		QCommandLineOption flapsOption(
+			"flaps", "Number of server flaps.", "count", "5");
+		QCommandLineOption uptimeOption(
+			"uptime", "Time between flaps.", "ms", "3000");
+		QCommandLineOption downtimeOption(
+			"downtime", "Time the server stays down.", "ms", "1000");
+		QCommandLineOption timeoutOption(
+			"timeout", "Session timeout announced by the server.", "s", "4");
+		QCommandLineOption limitOption(
+			"limit", "Maximum number of concurrent reconnects.", "count",
+			"32");
+		QCommandLineOption backendOption(
+			"backend", "RTSP protocol backend, curl or native.", "name",
+			"curl");
+
+		parser.addOption(clientsOption);
+		parser.addOption(flapsOption);
+		parser.addOption(uptimeOption);
+		parser.addOption(downtimeOption);
+		parser.addOption(timeoutOption);
+		parser.addOption(limitOption);
+		parser.addOption(backendOption);
+		parser.process(arguments);
+
+		auto clients = parser.value(clientsOption).toInt();
+		auto flaps = parser.value(flapsOption).toInt();
+		auto uptime = parser.value(uptimeOption).toInt();
+		auto downtime = parser.value(downtimeOption).toInt();
+		auto timeout = parser.value(timeoutOption).toInt();
+		auto limit = parser.value(limitOption).toInt();
+		auto backend = parser.value(backendOption);
+
+		if (clients <= 0 || flaps <= 0 || uptime <= 0 || downtime <= 0	||
+			timeout <= 0 || limit <= 0									||
+			(backend != "curl" && backend != "native"))
+			parser.showHelp(1);
+
+		QElapsedTimer clock;
+		clock.start();
+
+		FlappingServer server(clock, flaps, uptime, downtime, timeout);
+
+		auto port = server.listen();
+
+		if (!port) {
+			server.wait();
+			QTextStream(stderr) << "Server failed to listen\n";
+			return 1;
+		}
+
+		RTSPReconnectPolicy::instance().setLimit(limit);
+
+		QUrl url("rtsp://127.0.0.1:" + QString::number(port) + "/stream");
+		QVector<Recovery> recoveries;
+		std::vector<std::unique_ptr<RTSPClient>> sessions;
+		auto lost = 0;
+
+		for (auto i = 0; i < clients; ++i) {
+			std::unique_ptr<RTSPClient> client(new RTSPClient);
+
+			client->setTransport(RTSPTransport::TCP);
+			client->setBackend(backend == "native"
+							   ? RTSPBackend::Native
+							   : RTSPBackend::Curl);
+			client->setAutoReconnect(true);
+
+			QObject::connect(client.get(), &RTSPClient::onDisconnected,
+							 [&]() { ++lost; });
+
+			QObject::connect(client.get(), &RTSPClient::onReconnected,
+							 [&](qint64 elapsed) {
+				recoveries.append({ clock.nsecsElapsed(), elapsed });
+			});
+
+			if (!client->open(url)						||
+				!client->setup(QUrl("track1"), { 0, 1 })	||
+				!client->play()) {
+				QTextStream(stderr) << "Session " << i << " failed\n";
+				continue;
+			}
+
+			sessions.push_back(std::move(client));
+		}
+
+		auto established = sessions.size();
+
+		server.startFlapping();
+
+		QEventLoop loop;
+		QTimer::singleShot((uptime + downtime) * (flaps + 1),
+						   &loop,
+						   SLOT(quit()));
+		loop.exec();
+
+		sessions.clear();
+
+		server.quit();
+		server.wait();
+
+		QTextStream output(stdout);
+		output << "flap\trestored\trecovery p50, ms\trecovery max, ms\t"
+				  "all restored after up, ms\n";
+
+		const auto& downs = server.getDownTimes();
+		const auto& ups = server.getUpTimes();
+
+		for (auto flap = 0; flap < ups.size(); ++flap) {
+			auto next = flap + 1 < downs.size()
+						? downs[flap + 1]
+						: clock.nsecsElapsed();
+
+			std::vector<qint64> elapsed;
+			qint64 last = ups[flap];
+
+			for (const auto& recovery : recoveries) {
+				if (recovery.time_ < downs[flap] || recovery.time_ >= next)
+					continue;
+
+				elapsed.push_back(recovery.elapsed_);
+				last = qMax(last, recovery.time_);
+			}
+
+			std::sort(elapsed.begin(), elapsed.end());
+
+			output << flap + 1 << "\t"
+				   << elapsed.size() << "\t"
+				   << (elapsed.empty()
+					   ? 0.0
+					   : milliseconds(elapsed[elapsed.size() / 2])) << "\t"
+				   << (elapsed.empty()
+					   ? 0.0
+					   : milliseconds(elapsed.back())) << "\t"
+				   << milliseconds(last - ups[flap]) << "\n";
+		}
+
+		const auto& windows = server.getWindows();
+		auto peak = windows.isEmpty()
+					? 0
+					: *std::max_element(windows.cbegin(), windows.cend());
+
+		output << "sessions: " << established << "\n"
+			   << "connection losses: " << lost << "\n"
+			   << "sessions restored: " << recoveries.size() << "\n"
+			   << "reconnect limit: " << limit << "\n"
+			   << "peak connection rate: " << peak << " per "
+			   << RATE_WINDOW << " ms\n";
+
+		return 0;
+	}
+}
@@ -0,0 +1,208 @@
+/// \file SequenceBenchmark.cpp
+/// \brief Contains definitions of the RTP jitter buffer benchmark.
+/// \bug No known bugs.
+
+#include "Benchmarks.hpp"
+
+#include "RTSPClient/Protocols/RTP/RTPSequence.hpp"
+
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+
+/// Contains the library benchmarks.
+namespace Benchmarks {
+
+	namespace {
+
+		using RTSPLib::RTSPClient::PacketBufferPool;
+		using RTSPLib::RTSPClient::RTPSequence;
+		using RTSPLib::RTSPClient::RTPSequencePacket;
+
+		/// Structure that describes a synthetic packet arrival.
+		struct Arrival final {
+
+			/// RTP sequence number.
+			quint16 sequence_;
+
+			/// Arrival time in nanoseconds.
+			qint64 time_;
+		};
+
+		/// Structure that describes a synthetic network path.
+		struct Path final {
+
+			/// Packet interval in nanoseconds.
+			qint64 interval_;
+
+			/// Probability of a lost packet.
+			double loss_;
+
+			/// Probability of a delayed packet.
+			double reorder_;
+
+			/// Largest delay of a delayed packet in packet intervals.
+			int displacement_;
+
+			/// Probability of a duplicated packet.
+			double duplicate_;
+		};
+
+		/// Generates packet arrivals of a synthetic path.
+		/// \details Packets are sent at a constant rate from a random
+		/// sequence number, so the sequence number wraps around. A delayed
+		/// packet arrives up to the displacement later and is overtaken by
+		/// the packets sent meanwhile.
+		/// \param[in]	count	Number of sent packets.
+		/// \param[in]	path	Network path.
+		/// \return Packet arrivals in time order.
+		std::vector<Arrival> arrivals(int count, const Path& path) {
+			std::mt19937 random(1);
+			std::uniform_real_distribution<double> chance(0, 1);
+			std::uniform_int_distribution<int> delay(1, path.displacement_);
+
+			auto first = static_cast<quint16>(random());
+
+			std::vector<Arrival> result;
+			result.reserve(static_cast<std::size_t>(count) * 2);
+
+			for (auto i = 0; i < count; ++i) {
+				if (chance(random) < path.loss_) continue;
+
+				auto sequence = static_cast<quint16>(first + i);
+				auto time = i * path.interval_;
+
+				if (chance(random) < path.reorder_)
+					time += delay(random) * path.interval_ + 1;
+
+				result.push_back({ sequence, time });
+
+				if (chance(random) < path.duplicate_)
+					result.push_back({ sequence, time + path.interval_ / 2 });
+			}
+
+			std::stable_sort(result.begin(), result.end(),
+							 [](const Arrival& left, const Arrival& right) {
+				return left.time_ < right.time_;
+			});
+
+			return result;
+		}
+	}
+
+	/// Measures RTP jitter buffer throughput and playout quality.
+	/// \details Feeds synthetic arrivals with loss, reordering and
+	/// duplicates through the buffer, playing due packets after every
+	/// arrival, and reports the cost per packet together with lost, late
+	/// and duplicate packets and the final playout delay.
+	/// \param[in]	arguments	Benchmark arguments.
+	/// \return Exit status.
+	int sequence(const QStringList& arguments) {
+		QCommandLineParser parser;
+		parser.setApplicationDescription(
+			"Measures RTP jitter buffer throughput and playout quality.");
+		parser.addHelpOption();
+
+		QCommandLineOption packetsOption(
+			"packets", "Number of sent packets.", "count", "5000000");
+		QCommandLineOption rateOption(
+			"rate", "Packet rate.", "packets/s", "1000");
+		QCommandLineOption lossOption(
+			"loss", "Lost packets.", "percent", "1");
+		QCommandLineOption reorderOption(
+			"reorder", "Delayed packets.", "percent", "5");
+		QCommandLineOption displacementOption(
+			"displacement", "Largest delay of a delayed packet.", "packets",
+			"20");
+		QCommandLineOption duplicateOption(
+			"duplicate", "Duplicated packets.", "percent", "1");
+		QCommandLineOption capacityOption(
+			"capacity", "Buffer capacity.", "packets", "1024");
+		QCommandLineOption delayOption(
+			"delay", "Playout delay, initial if adaptive.", "ms", "10");
+		QCommandLineOption adaptiveOption(
+			"adaptive", "Adapt playout delay to the path.");
+
+		parser.addOption(packetsOption);
+		parser.addOption(rateOption);
+		parser.addOption(lossOption);
+		parser.addOption(reorderOption);
+		parser.addOption(displacementOption);
+		parser.addOption(duplicateOption);
+		parser.addOption(capacityOption);
+		parser.addOption(delayOption);
+		parser.addOption(adaptiveOption);
+		parser.process(arguments);
+
+		auto count = parser.value(packetsOption).toInt();
+		auto rate = parser.value(rateOption).toInt();
+
+		Path path;
+		path.interval_ = rate > 0 ? 1000000000 / rate : 0;
+		path.loss_ = parser.value(lossOption).toDouble() / 100;
+		path.reorder_ = parser.value(reorderOption).toDouble() / 100;
+		path.displacement_ = parser.value(displacementOption).toInt();
+		path.duplicate_ = parser.value(duplicateOption).toDouble() / 100;
+
+		if (count <= 0 || path.interval_ <= 0 || path.displacement_ <= 0)
+			parser.showHelp(1);
+
+		auto packets = arrivals(count, path);
+
+		RTPSequence buffer(parser.value(capacityOption).toInt());
+		buffer.setDelay(parser.value(delayOption).toLongLong() * 1000000);
+		buffer.setAdaptive(parser.isSet(adaptiveOption));
+
+		auto& pool = PacketBufferPool::shared();
+
+		RTPSequencePacket packet;
+		quint64 played = 0, misordered = 0;
+		qint64 previous = -1, latency = 0;
+
+		QElapsedTimer timer;
+		timer.start();
+
+		for (const auto& arrival : packets) {
+			buffer.insert(arrival.sequence_, 0, pool.allocate(1),
+						  arrival.time_);
+
+			while (buffer.pop(packet, arrival.time_)) {
+				++played;
+				latency += arrival.time_ - packet.arrival_;
+				if (packet.sequence_ <= previous) ++misordered;
+				previous = packet.sequence_;
+			}
+		}
+
+		while (buffer.pop(packet, std::numeric_limits<qint64>::max())) {
+			++played;
+			if (packet.sequence_ <= previous) ++misordered;
+			previous = packet.sequence_;
+		}
+
+		auto elapsed = timer.nsecsElapsed() / 1e9;
+		const auto& statistics = buffer.getStatistics();
+
+		QTextStream output(stdout);
+		output << "arrivals:           " << packets.size() << "\n"
+			   << "ns/packet:          "
+			   << elapsed * 1e9 / packets.size() << "\n"
+			   << "played:             " << played << "\n"
+			   << "lost:               " << statistics.lost_ << "\n"
+			   << "late:               " << statistics.late_ << "\n"
+			   << "duplicates:         " << statistics.duplicates_ << "\n"
+			   << "resets:             " << statistics.resets_ << "\n"
+			   << "added latency, ms:  "
+			   << (played > 0 ? latency / 1e6 / played : 0) << "\n"
+			   << "final delay, ms:    " << buffer.getDelay() / 1e6 << "\n"
+			   << "in order:           "
+			   << (misordered == 0 ? "yes" : "no") << "\n";
+
+		return misordered == 0 ? 0 : 1;
+	}
+}
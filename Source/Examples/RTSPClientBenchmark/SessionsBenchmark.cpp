@@ -0,0 +1,469 @@
+/// \file SessionsBenchmark.cpp
+/// \brief Contains definitions of the session bring-up benchmark.
+/// \bug No known bugs.
+
+#include "Benchmarks.hpp"
+
+#include "RTSPClient/Protocols/RTSP/AbstractRTSPClientBase.hpp"
+#include "RTSPClient/Protocols/RTSP/RTSPClientEngine.hpp"
+#include "RTSPClient/Protocols/RTSP/RTSPLatencyMonitor.hpp"
+#include "RTSPClient/Protocols/RTSP/RTSPSessionCache.hpp"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QTimer>
+
+#include <ctime>
+#include <memory>
+#include <vector>
+
+/// Contains the library benchmarks.
+namespace Benchmarks {
+
+	namespace {
+
+		using RTSPLib::RTSPClient::RTSPBackend;
+		using RTSPLib::RTSPClient::RTSPClientBase;
+		using RTSPLib::RTSPClient::RTSPClientEngine;
+		using RTSPLib::RTSPClient::RTSPLatencyMonitor;
+		using RTSPLib::RTSPClient::RTSPLatencyPhase;
+		using RTSPLib::RTSPClient::RTSPMethod;
+		using RTSPLib::RTSPClient::RTSPSessionCache;
+		using RTSPLib::RTSPClient::RTSPStatusCode;
+
+		/// Class that brings up many RTSP sessions on a single thread.
+		/// \details Every session runs OPTIONS, DESCRIBE, SETUP for every
+		/// track and PLAY through one non-blocking engine, keeping a bounded
+		/// number of sessions in flight. Fast start skips OPTIONS. With the
+		/// native backend DESCRIBE, SETUP and PLAY may be pipelined.
+		class SessionsBenchmark final {
+		public:
+
+			/// Constructor.
+			/// \param[in]	url			RTSP connection URL.
+			/// \param[in]	tracks		Media track paths.
+			/// \param[in]	sessions	Number of sessions.
+			/// \param[in]	concurrency	Number of sessions in flight.
+			/// \param[in]	port		First client port.
+			/// \param[in]	fastStart	Whether sessions skip OPTIONS.
+			/// \param[in]	backend		RTSP protocol backend.
+			/// \param[in]	pipeline	Whether requests are pipelined.
+			explicit SessionsBenchmark(const QByteArray& url,
+									   const QList<QByteArray>& tracks,
+									   int sessions,
+									   int concurrency,
+									   quint16 port,
+									   bool fastStart,
+									   RTSPBackend backend,
+									   bool pipeline)
+				: url_(url),
+				  tracks_(tracks),
+				  sessions_(sessions),
+				  concurrency_(concurrency),
+				  port_(port),
+				  fastStart_(fastStart),
+				  backend_(backend),
+				  pipeline_(pipeline) {
+
+				clients_.resize(static_cast<size_t>(sessions_));
+				started_.resize(static_cast<size_t>(sessions_));
+			}
+
+		public:
+
+			/// Starts the benchmark.
+			void start() {
+				timer_.start();
+				cpu_ = std::clock();
+
+				RTSPSessionCache::instance().resetStatistics();
+
+				while (launch());
+			}
+
+		private:
+
+			/// Starts the next session if the concurrency limit allows it.
+			/// \retval true if a session was started.
+			/// \retval false otherwise.
+			bool launch() {
+				if (next_ >= sessions_ || inFlight_ >= concurrency_)
+					return false;
+
+				auto index = next_++;
+				++inFlight_;
+
+				auto& client = clients_[static_cast<size_t>(index)];
+				client.reset(new RTSPClientBase);
+				client->setBackend(backend_);
+				client->setEngine(&engine_);
+				started_[static_cast<size_t>(index)] = timer_.nsecsElapsed();
+
+				if (!client->open(url_)) {
+					finish(index, false);
+					return true;
+				}
+
+				client->setFastStart(fastStart_);
+
+				if (fastStart_) stepDESCRIBE(index);
+				else stepOPTIONS(index);
+
+				return true;
+			}
+
+			/// Sends OPTIONS request.
+			/// \param[in]	index	Session index.
+			void stepOPTIONS(int index) {
+				auto started = client(index)->OPTIONS(
+					[this, index](RTSPStatusCode status) {
+
+					if (status == RTSPStatusCode::Ok) stepDESCRIBE(index);
+					else finish(index, false);
+				});
+
+				if (!started) finish(index, false);
+			}
+
+			/// Sends DESCRIBE request.
+			/// \param[in]	index	Session index.
+			void stepDESCRIBE(int index) {
+				if (pipeline_) {
+					stepPipeline(index);
+					return;
+				}
+
+				auto started = client(index)->DESCRIBE(
+					[this, index](RTSPStatusCode status) {
+
+					if (status == RTSPStatusCode::Ok) stepSETUP(index, 0);
+					else finish(index, false);
+				});
+
+				if (!started) finish(index, false);
+			}
+
+			/// Sends SETUP request.
+			/// \details Tracks are set up back-to-back, PLAY follows the last
+			/// one.
+			/// \param[in]	index	Session index.
+			/// \param[in]	track	Track index.
+			void stepSETUP(int index, int track) {
+				auto port = static_cast<quint16>(
+					port_ + (index * tracks_.size() + track) * 2);
+
+				auto started = client(index)->SETUP(
+					tracks_[track],
+					{ port, static_cast<quint16>(port + 1) },
+					[this, index, track](RTSPStatusCode status) {
+
+					if (status != RTSPStatusCode::Ok) finish(index, false);
+					else if (track + 1 < tracks_.size())
+						stepSETUP(index, track + 1);
+					else stepPLAY(index);
+				});
+
+				if (!started) finish(index, false);
+			}
+
+			/// Sends PLAY request.
+			/// \param[in]	index	Session index.
+			void stepPLAY(int index) {
+				auto started = client(index)->PLAY(
+					[this, index](RTSPStatusCode status) {
+
+					finish(index, status == RTSPStatusCode::Ok);
+				});
+
+				if (!started) finish(index, false);
+			}
+
+			/// Sends DESCRIBE, SETUP for every track and PLAY at once.
+			/// \details The native backend writes them without waiting for
+			/// responses, requests that need the session follow the first
+			/// SETUP response.
+			/// \param[in]	index	Session index.
+			void stepPipeline(int index) {
+				auto remaining = std::make_shared<int>(tracks_.size() + 2);
+				auto failed = std::make_shared<bool>(false);
+
+				auto completion =
+					[this, index, remaining, failed](RTSPStatusCode status) {
+
+					if (*failed) return;
+
+					if (status != RTSPStatusCode::Ok) {
+						*failed = true;
+						finish(index, false);
+					}
+					else if (--*remaining == 0) finish(index, true);
+				};
+
+				auto started = client(index)->DESCRIBE(completion);
+
+				for (auto track = 0;
+					 started && track < tracks_.size();
+					 ++track) {
+					auto port = static_cast<quint16>(
+						port_ + (index * tracks_.size() + track) * 2);
+
+					started = client(index)->SETUP(
+						tracks_[track],
+						{ port, static_cast<quint16>(port + 1) },
+						completion);
+				}
+
+				started = started && client(index)->PLAY(completion);
+
+				if (!started && !*failed) {
+					*failed = true;
+					finish(index, false);
+				}
+			}
+
+			/// Finishes a session bring-up.
+			/// \param[in]	index	Session index.
+			/// \param[in]	success	Bring-up result.
+			void finish(int index, bool success) {
+				auto latency =
+					timer_.nsecsElapsed() -
+					started_[static_cast<size_t>(index)];
+
+				if (success) {
+					++succeeded_;
+					latencyTotal_ += latency;
+					latencyMaximum_ = qMax(latencyMaximum_, latency);
+				}
+				else {
+					++failed_;
+					client(index)->close();
+				}
+
+				--inFlight_;
+
+				if (succeeded_ + failed_ == sessions_) report();
+				else while (launch());
+			}
+
+			/// Prints results and stops the event loop.
+			void report() {
+				auto elapsed = timer_.nsecsElapsed();
+				auto seconds = elapsed / 1e9;
+				auto cpu = static_cast<double>(std::clock() - cpu_) /
+						   CLOCKS_PER_SEC;
+
+				auto cache = RTSPSessionCache::instance().getStatistics();
+
+				quint64 pipelined = 0;
+				for (auto& client : clients_)
+					if (client) pipelined += client->getPipelinedCount();
+
+				QTextStream output(stdout);
+				output << "sessions:      " << sessions_ << "\n"
+					   << "concurrency:   " << concurrency_ << "\n"
+					   << "tracks:        " << tracks_.size() << "\n"
+					   << "fast start:    " << (fastStart_ ? "yes" : "no")
+					   << "\n"
+					   << "backend:       "
+					   << (backend_ == RTSPBackend::Native ? "native" : "curl")
+					   << "\n"
+					   << "pipelined:     " << pipelined << "\n"
+					   << "succeeded:     " << succeeded_ << "\n"
+					   << "failed:        " << failed_ << "\n"
+					   << "elapsed, s:    " << seconds << "\n"
+					   << "sessions/s:    "
+					   << (seconds > 0 ? succeeded_ / seconds : 0) << "\n"
+					   << "avg bring-up, ms: "
+					   << (succeeded_ > 0
+						   ? latencyTotal_ / 1e6 / succeeded_
+						   : 0) << "\n"
+					   << "max bring-up, ms: "
+					   << latencyMaximum_ / 1e6 << "\n"
+					   << "cpu, s:        " << cpu << "\n"
+					   << "cpu per session, us: "
+					   << cpu * 1e6 / sessions_ << "\n"
+					   << "dns hits/misses: "
+					   << cache.dnsHits_ << "/" << cache.dnsMisses_ << "\n"
+					   << "connection hits/misses: "
+					   << cache.connectionHits_ << "/"
+					   << cache.connectionMisses_ << "\n";
+
+				const QPair<RTSPMethod, const char*> methods[] {
+					{ RTSPMethod::Options, "OPTIONS" },
+					{ RTSPMethod::Describe, "DESCRIBE" },
+					{ RTSPMethod::Setup, "SETUP" },
+					{ RTSPMethod::Play, "PLAY" }
+				};
+
+				auto& monitor = RTSPLatencyMonitor::instance();
+
+				for (const auto& method : methods) {
+					auto summary = monitor.getSummary(
+						method.first, RTSPLatencyPhase::Total);
+
+					if (summary.count_ == 0) continue;
+
+					output << method.second
+						   << " p50/p99/p99.9/max, us: "
+						   << summary.p50_ << "/" << summary.p99_ << "/"
+						   << summary.p999_ << "/" << summary.maximum_
+						   << "\n";
+				}
+
+				for (auto& client : clients_)
+					if (client) client->close();
+
+				QCoreApplication::exit(failed_ == 0 ? 0 : 1);
+			}
+
+			/// Returns session client.
+			/// \param[in]	index	Session index.
+			/// \return Session client.
+			RTSPClientBase* client(int index) {
+				return clients_[static_cast<size_t>(index)].get();
+			}
+
+		private:
+
+			/// Non-blocking engine shared by all sessions.
+			RTSPClientEngine engine_;
+
+			/// Session clients.
+			std::vector<std::unique_ptr<RTSPClientBase>> clients_;
+
+			/// Bring-up start times in nanoseconds.
+			std::vector<qint64> started_;
+
+			/// Benchmark timer.
+			QElapsedTimer timer_;
+
+			/// RTSP connection URL.
+			const QByteArray url_;
+
+			/// Media track paths.
+			const QList<QByteArray> tracks_;
+
+			/// Number of sessions.
+			const int sessions_;
+
+			/// Number of sessions in flight.
+			const int concurrency_;
+
+			/// First client port.
+			const quint16 port_;
+
+			/// Whether sessions skip OPTIONS.
+			const bool fastStart_;
+
+			/// RTSP protocol backend.
+			const RTSPBackend backend_;
+
+			/// Whether requests are pipelined.
+			const bool pipeline_;
+
+			/// Processor time at the start.
+			std::clock_t cpu_ { 0 };
+
+			/// Next session index.
+			int next_ { 0 };
+
+			/// Current number of sessions in flight.
+			int inFlight_ { 0 };
+
+			/// Number of sessions brought up.
+			int succeeded_ { 0 };
+
+			/// Number of failed sessions.
+			int failed_ { 0 };
+
+			/// Sum of bring-up latencies in nanoseconds.
+			qint64 latencyTotal_ { 0 };
+
+			/// Maximum bring-up latency in nanoseconds.
+			qint64 latencyMaximum_ { 0 };
+		};
+	}
+
+	/// Measures the number of RTSP sessions brought up per second.
+	/// \details Runs OPTIONS, DESCRIBE, SETUP for every track and PLAY for
+	/// every session on the calling thread through one non-blocking engine
+	/// or the native backend, and reports processor time per session.
+	/// \param[in]	arguments	Benchmark arguments.
+	/// \return Exit status.
+	int sessions(const QStringList& arguments) {
+		QCommandLineParser parser;
+		parser.setApplicationDescription(
+			"Measures RTSP sessions brought up per second.");
+		parser.addHelpOption();
+		parser.addPositionalArgument("url", "RTSP connection URL.");
+
+		QCommandLineOption sessionsOption(
+			"sessions", "Number of sessions.", "count", "1000");
+		QCommandLineOption concurrencyOption(
+			"concurrency", "Number of sessions in flight.", "count", "256");
+		QCommandLineOption trackOption(
+			"track", "Media track path, may be repeated.", "path");
+		QCommandLineOption portOption(
+			"port", "First client port.", "port", "50000");
+		QCommandLineOption fastStartOption(
+			"fast-start", "Skip OPTIONS during bring-up.");
+		QCommandLineOption backendOption(
+			"backend", "RTSP backend, curl or native.", "name", "curl");
+		QCommandLineOption noCacheOption(
+			"no-cache", "Do not share addresses and connections.");
+		QCommandLineOption pipelineOption(
+			"pipeline", "Pipeline DESCRIBE, SETUP and PLAY (native only).");
+
+		parser.addOption(sessionsOption);
+		parser.addOption(concurrencyOption);
+		parser.addOption(trackOption);
+		parser.addOption(portOption);
+		parser.addOption(fastStartOption);
+		parser.addOption(backendOption);
+		parser.addOption(pipelineOption);
+		parser.addOption(noCacheOption);
+		parser.process(arguments);
+
+		if (parser.positionalArguments().isEmpty()) parser.showHelp(1);
+
+		auto sessions = parser.value(sessionsOption).toInt();
+		auto concurrency = parser.value(concurrencyOption).toInt();
+
+		if (sessions <= 0 || concurrency <= 0) parser.showHelp(1);
+
+		auto backendName = parser.value(backendOption);
+		auto backend = backendName == "native"
+					   ? RTSPBackend::Native
+					   : RTSPBackend::Curl;
+
+		if (backendName != "native" && backendName != "curl")
+			parser.showHelp(1);
+
+		if (parser.isSet(pipelineOption) && backend != RTSPBackend::Native)
+			parser.showHelp(1);
+
+		QList<QByteArray> tracks;
+		for (const auto& track : parser.values(trackOption))
+			tracks.append(track.toUtf8());
+
+		if (tracks.isEmpty()) tracks.append("track1");
+
+		RTSPSessionCache::instance().setEnabled(!parser.isSet(noCacheOption));
+
+		SessionsBenchmark benchmark(
+			parser.positionalArguments().first().toUtf8(),
+			tracks,
+			sessions,
+			concurrency,
+			static_cast<quint16>(parser.value(portOption).toUInt()),
+			parser.isSet(fastStartOption),
+			backend,
+			parser.isSet(pipelineOption));
+
+		QTimer::singleShot(0, [&benchmark] { benchmark.start(); });
+
+		return QCoreApplication::exec();
+	}
+}
@@ -0,0 +1,139 @@
+/// \file SetupBenchmark.cpp
+/// \brief Contains definitions of the per-request setup cost benchmark.
+/// \bug No known bugs.
+
+#include "Benchmarks.hpp"
+
+#include <curl/curl.h>
+
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+/// Contains the library benchmarks.
+namespace Benchmarks {
+
+	namespace {
+
+		/// Discards header data.
+		/// \param[in]	data	Data pointer.
+		/// \param[in]	n		Number of buffers.
+		/// \param[in]	size	Data size.
+		/// \param[in]	user	User-defined data.
+		/// \return Actual read size.
+		size_t discard(char* data, size_t n, size_t size, void* user) {
+			Q_UNUSED(data)
+			Q_UNUSED(user)
+
+			return n * size;
+		}
+
+		/// Applies options the way every request used to before this change.
+		/// \details Resets the handle and sets every option again.
+		/// \param[in]	context	Local context.
+		/// \param[in]	url		RTSP connection URL.
+		/// \param[in]	track	Media track URL.
+		void setupReset(CURL* context,
+						const QByteArray& url,
+						const QByteArray& track) {
+
+			curl_easy_reset(context);
+			curl_easy_setopt(context, CURLOPT_URL, url.constData());
+			curl_easy_setopt(context, CURLOPT_RTSP_STREAM_URI,
+							 track.constData());
+			curl_easy_setopt(context, CURLOPT_USERAGENT, "RTSPLib");
+			curl_easy_setopt(context, CURLOPT_RTSP_SESSION_ID, "12345678");
+			curl_easy_setopt(context, CURLOPT_CONNECTTIMEOUT_MS, 5000L);
+			curl_easy_setopt(context, CURLOPT_TIMEOUT_MS, 5000L);
+			curl_easy_setopt(context, CURLOPT_HTTPAUTH, CURLAUTH_ANY);
+			curl_easy_setopt(context, CURLOPT_USERNAME, "user");
+			curl_easy_setopt(context, CURLOPT_PASSWORD, "password");
+			curl_easy_setopt(context, CURLOPT_NOSIGNAL, 1L);
+			curl_easy_setopt(context, CURLOPT_HEADERFUNCTION, discard);
+			curl_easy_setopt(context, CURLOPT_HEADERDATA, nullptr);
+			curl_easy_setopt(context, CURLOPT_RTSP_REQUEST,
+							 CURL_RTSPREQ_GET_PARAMETER);
+		}
+
+		/// Applies only the per-request delta.
+		/// \details Session-wide options are kept on the handle, so only the
+		/// stream URI and request type change.
+		/// \param[in]	context	Local context.
+		/// \param[in]	track	Media track URL.
+		void setupDelta(CURL* context, const QByteArray& track) {
+			curl_easy_setopt(context, CURLOPT_RTSP_STREAM_URI,
+							 track.constData());
+			curl_easy_setopt(context, CURLOPT_RTSP_REQUEST,
+							 CURL_RTSPREQ_GET_PARAMETER);
+		}
+
+		/// Returns average time of a setup function.
+		/// \param[in]	iterations	Number of iterations.
+		/// \param[in]	setup		Setup function.
+		/// \return Average time in nanoseconds.
+		template<typename Setup>
+		double measure(int iterations, Setup setup) {
+			QElapsedTimer timer;
+			timer.start();
+
+			for (auto i = 0; i < iterations; ++i) setup();
+
+			return static_cast<double>(timer.nsecsElapsed()) / iterations;
+		}
+	}
+
+	/// Measures per-request setup cost of the local context.
+	/// \details Compares resetting the handle and applying all options before
+	/// every request with applying only the per-request delta. No network
+	/// traffic is involved.
+	/// \param[in]	arguments	Benchmark arguments.
+	/// \return Exit status.
+	int setup(const QStringList& arguments) {
+		QCommandLineParser parser;
+		parser.setApplicationDescription(
+			"Measures per-request setup cost of the curl handle.");
+		parser.addHelpOption();
+
+		QCommandLineOption iterationsOption(
+			"iterations", "Number of requests.", "count", "1000000");
+
+		parser.addOption(iterationsOption);
+		parser.process(arguments);
+
+		auto iterations = parser.value(iterationsOption).toInt();
+		if (iterations <= 0) parser.showHelp(1);
+
+		if (curl_global_init(CURL_GLOBAL_ALL) != CURLE_OK) return 1;
+
+		auto context = curl_easy_init();
+		if (!context) {
+			curl_global_cleanup();
+			return 1;
+		}
+
+		const QByteArray url("rtsp://127.0.0.1:554/stream");
+		const QByteArray track("rtsp://127.0.0.1:554/stream/track1");
+
+		auto reset = measure(iterations, [&] {
+			setupReset(context, url, track);
+		});
+
+		setupReset(context, url, track);
+
+		auto delta = measure(iterations, [&] {
+			setupDelta(context, track);
+		});
+
+		curl_easy_cleanup(context);
+		curl_global_cleanup();
+
+		QTextStream output(stdout);
+		output << "iterations:        " << iterations << "\n"
+			   << "reset, ns/request: " << reset << "\n"
+			   << "delta, ns/request: " << delta << "\n"
+			   << "speedup:           "
+			   << (delta > 0 ? reset / delta : 0) << "\n";
+
+		return 0;
+	}
+}
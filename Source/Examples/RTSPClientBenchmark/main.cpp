@@ -0,0 +1,123 @@
+/// \file main.cpp
+/// \brief Contains entry point to the application.
+/// \bug No known bugs.
+
+#include <QCoreApplication>
+#include <QTextStream>
+
+#include "Benchmarks.hpp"
+
+/// Contains benchmark registry.
+namespace {
+
+	/// Structure that describes a benchmark.
+	struct Benchmark final {
+
+		/// Benchmark name.
+		const char* name_;
+
+		/// Benchmark description.
+		const char* description_;
+
+		/// Benchmark entry point.
+		int (*run_)(const QStringList&);
+	};
+
+	/// Registered benchmarks.
+	const Benchmark benchmarks[] {
+		{
+			"sessions",
+			"RTSP sessions brought up per second through the engine",
+			Benchmarks::sessions
+		},
+		{
+			"faststart",
+			"Time to the first RTP packet with and without fast start",
+			Benchmarks::fastStart
+		},
+		{
+			"parser",
+			"RTSP response header parsing throughput",
+			Benchmarks::parser
+		},
+		{
+			"setup",
+			"Per-request curl handle setup cost, reset versus delta",
+			Benchmarks::setup
+		},
+		{
+			"reconnect",
+			"Session recovery and connection rate with a flapping server",
+			Benchmarks::reconnect
+		},
+		{
+			"pool",
+			"RTP throughput of the sharded client pool by shard count",
+			Benchmarks::pool
+		},
+		{
+			"packet",
+			"RTP packet parsing throughput, copying versus in place",
+			Benchmarks::packet
+		},
+		{
+			"buffers",
+			"Packet buffer allocation cost, heap versus pool",
+			Benchmarks::buffers
+		},
+		{
+			"sequence",
+			"RTP jitter buffer with synthetic reorder and loss",
+			Benchmarks::sequence
+		},
+		{
+			"demux",
+			"Shared socket demultiplexing versus per-session sockets",
+			Benchmarks::demux
+		},
+		{
+			"clock",
+			"Wall clock alignment of many cameras with audio and video",
+			Benchmarks::clock
+		},
+		{
+			"nack",
+			"Decodable frames under synthetic loss with and without NACK",
+			Benchmarks::nack
+		},
+		{
+			"keyframe",
+			"Recovery time after loss with and without key frame requests",
+			Benchmarks::keyFrame
+		},
+	};
+}
+
+/// Runs the main application thread.
+/// \details Runs the benchmark named by the first argument.
+/// \param[in]	argc	Number of arguments passed to the program.
+/// \param[in]	argv	Array of pointers that contain arguments passed
+///						to the program.
+/// \return Exit status.
+int main(int argc, char *argv[]) {
+	QCoreApplication a(argc, argv);
+
+	auto arguments = a.arguments();
+	auto name = arguments.size() > 1 ? arguments[1] : QString();
+
+	for (const auto& benchmark : benchmarks) {
+		if (name == benchmark.name_) {
+			arguments.removeAt(1);
+			return benchmark.run_(arguments);
+		}
+	}
+
+	QTextStream output(stdout);
+	output << "Usage: " << arguments.first() << " <benchmark> [options]\n";
+
+	for (const auto& benchmark : benchmarks)
+		output << "  " << benchmark.name_ << "\t"
+			   << benchmark.description_ << "\n";
+
+	return 1;
+}
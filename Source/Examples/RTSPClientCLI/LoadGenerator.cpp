@@ -0,0 +1,489 @@
+/// \file LoadGenerator.cpp
+/// \brief Contains classes and functions definitions that provide RTSP load
+/// generator.
+/// \bug No known bugs.
+
+#include "LoadGenerator.hpp"
+
+#include "RTSPClient/Client/RTSPClientPool.hpp"
+#include "RTSPClient/Client/RTSPSharedReceiver.hpp"
+#include "RTSPClient/Utilities/PacketBufferPool.hpp"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+#include <QTimer>
+
+#include <atomic>
+#include <ctime>
+#include <memory>
+#include <vector>
+
+/// Contains the RTSP client command line tool.
+namespace ClientCLI {
+
+	namespace {
+
+		using RTSPLib::RTSPClient::PacketBufferPool;
+		using RTSPLib::RTSPClient::RTSPClient;
+		using RTSPLib::RTSPClient::RTSPClientPool;
+		using RTSPLib::RTSPClient::RTSPSharedReceiver;
+		using RTSPLib::RTSPClient::RTSPSharedReceiverStatistics;
+		using RTSPLib::RTSPClient::RTSPStreamStatistics;
+		using RTSPLib::RTSPClient::RTSPTransport;
+
+		/// Ramp-up timer interval in milliseconds.
+		/// \details Sessions due within an interval are opened together.
+		constexpr int LAUNCH_INTERVAL { 10 };
+
+		/// Placeholder of the session number in URL templates.
+		/// \details Session numbers start from one.
+		constexpr char SESSION_PLACEHOLDER[] { "{n}" };
+
+		/// Names of session states.
+		/// \details Indexed by session state.
+		const char* const STATE_NAMES[] {
+			"pending", "connecting", "playing", "reconnecting", "failed"
+		};
+
+		/// Returns resident memory of the process.
+		/// \details Read from the proc file system, where it is available.
+		/// \return Resident memory in bytes or -1 if it is unknown.
+		qint64 residentMemory() {
+			QFile file("/proc/self/status");
+
+			if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return -1;
+
+			for (auto line = file.readLine(); !line.isEmpty();
+				 line = file.readLine()) {
+				if (!line.startsWith("VmRSS:")) continue;
+
+				auto fields = line.mid(6).simplified().split(' ');
+				auto ok = false;
+				auto kilobytes = fields.first().toLongLong(&ok);
+
+				return ok ? kilobytes * 1024 : -1;
+			}
+
+			return -1;
+		}
+
+		/// Returns share of lost packets.
+		/// \param[in]	received	Number of received packets.
+		/// \param[in]	lost		Number of lost packets.
+		/// \return Share of lost packets in percent.
+		double lossPercent(qint64 received, qint64 lost) {
+			lost = qMax<qint64>(lost, 0);
+
+			return received + lost > 0
+				   ? lost * 100.0 / (received + lost)
+				   : 0.0;
+		}
+	}
+
+	/// Structure that describes a session.
+	/// \details The state is written by the client thread, everything else
+	/// by the thread of the generator.
+	struct LoadGenerator::Session final {
+
+		/// Session states.
+		enum State {
+
+			/// Not opened yet.
+			Pending,
+
+			/// Being brought up.
+			Connecting,
+
+			/// Receiving media.
+			Playing,
+
+			/// Connection lost, being restored.
+			Reconnecting,
+
+			/// Bring-up failed.
+			Failed
+		};
+
+		/// RTSP connection URL.
+		QUrl url_;
+
+		/// Client, owned by the pool.
+		RTSPClient* client_ { nullptr };
+
+		/// Session state.
+		std::atomic<int> state_ { Pending };
+
+		/// Number of restored sessions.
+		quint64 reconnects_ { 0 };
+
+		/// Number of restored sessions at the last report.
+		quint64 lastReconnects_ { 0 };
+
+		/// Reception statistics at the last report.
+		RTSPStreamStatistics last_;
+	};
+
+	/// Structure that provides private storage.
+	/// \details Maintains private data.
+	struct LoadGenerator::LoadGeneratorPrivate final {
+
+		/// Constructor.
+		/// \param[in]	settings	Load settings.
+		explicit LoadGeneratorPrivate(const LoadSettings& settings)
+			: settings_(settings),
+			  pool_(settings.shards_) { }
+
+		/// Load settings.
+		const LoadSettings settings_;
+
+		/// Sessions.
+		/// \details Declared before the pool, so that they outlive
+		/// callbacks of clients that the pool closes.
+		std::vector<std::unique_ptr<Session>> sessions_;
+
+		/// Client pool.
+		RTSPClientPool pool_;
+
+		/// Ramp-up timer.
+		QTimer launchTimer_;
+
+		/// Report timer.
+		QTimer reportTimer_;
+
+		/// Time since the start.
+		QElapsedTimer clock_;
+
+		/// Time since the last report.
+		QElapsedTimer interval_;
+
+		/// Processor time at the last report.
+		std::clock_t cpu_ { 0 };
+
+		/// Shared receiver statistics at the last report.
+		RTSPSharedReceiverStatistics shared_;
+
+		/// Index of the next session to open.
+		int next_ { 0 };
+	};
+
+	/// Constructor.
+	/// \details Expands URL templates, sessions take URLs in turn.
+	/// \param[in]	settings	Load settings.
+	/// \param[in]	parent		Parent object.
+	LoadGenerator::LoadGenerator(const LoadSettings& settings,
+								 QObject* parent)
+		: QObject(parent),
+		  private_(new LoadGeneratorPrivate(settings)) {
+
+		auto& p = *private_;
+
+		for (auto i = 0; i < settings.sessions_; ++i) {
+			auto url = settings.urls_[i % settings.urls_.size()];
+			url.replace(SESSION_PLACEHOLDER, QString::number(i + 1));
+
+			p.sessions_.emplace_back(new Session);
+			p.sessions_.back()->url_ = QUrl(url);
+		}
+
+		connect(
+			&p.launchTimer_,
+			SIGNAL(timeout()),
+			SLOT(onLaunch())
+		);
+
+		connect(
+			&p.reportTimer_,
+			SIGNAL(timeout()),
+			SLOT(onReport())
+		);
+	}
+
+	/// Destructor.
+	/// \details Sessions are closed by the pool on their threads.
+	LoadGenerator::~LoadGenerator() = default;
+
+	/// Starts opening sessions.
+	/// \details Sessions are opened evenly over the ramp-up time.
+	void LoadGenerator::start() {
+		auto& p = *private_;
+
+		p.clock_.start();
+		p.interval_.start();
+		p.cpu_ = std::clock();
+
+		QTextStream(stdout) << "Opening " << p.sessions_.size()
+							<< " sessions on " << p.pool_.getShardCount()
+							<< " threads\n";
+
+		p.launchTimer_.start(LAUNCH_INTERVAL);
+		p.reportTimer_.start(p.settings_.interval_);
+
+		if (p.settings_.duration_ > 0)
+			QTimer::singleShot(p.settings_.duration_, this, [this]() {
+				stop();
+			});
+
+		onLaunch();
+	}
+
+	/// Opens sessions that are due.
+	/// \details The number of open sessions grows linearly with time until
+	/// the ramp-up time passes.
+	void LoadGenerator::onLaunch() {
+		auto& p = *private_;
+		auto count = static_cast<qint64>(p.sessions_.size());
+		auto rampUp = p.settings_.rampUp_;
+
+		auto target = rampUp > 0
+					  ? qMin(count, p.clock_.elapsed() * count / rampUp + 1)
+					  : count;
+
+		while (p.next_ < target) launch(p.next_++);
+
+		if (p.next_ == count) p.launchTimer_.stop();
+	}
+
+	/// Prints statistics of the last interval.
+	/// \details Rates are measured over the interval, loss and jitter of
+	/// every session follow RFC 3550. Processor time is that of the whole
+	/// process, shared evenly by playing sessions. Packet buffer pools of
+	/// all threads are summed.
+	void LoadGenerator::onReport() {
+		auto& p = *private_;
+
+		auto seconds = p.interval_.nsecsElapsed() / 1e9;
+		p.interval_.start();
+
+		auto cpu = std::clock();
+		auto cpuSeconds =
+			static_cast<double>(cpu - p.cpu_) / CLOCKS_PER_SEC;
+		p.cpu_ = cpu;
+
+		if (seconds <= 0) return;
+
+		int states[Session::Failed + 1] { };
+		qint64 packets = 0, bytes = 0, lost = 0, jitterTotal = 0;
+		qint64 jitterMaximum = 0;
+		quint64 reconnects = 0, syscalls = 0;
+		quint64 senderReports = 0, receiverReports = 0;
+		quint64 requested = 0, retransmitted = 0, unrecovered = 0;
+		quint64 keyFrames = 0, recoveries = 0;
+		qint64 recoveryTotal = 0, recoveryMaximum = 0;
+		auto measured = 0;
+
+		QTextStream output(stdout);
+
+		for (auto i = 0u; i < p.sessions_.size(); ++i) {
+			auto& session = *p.sessions_[i];
+			auto state = session.state_.load(std::memory_order_relaxed);
+			++states[state];
+
+			if (!session.client_) continue;
+
+			auto statistics = session.client_->getStreamStatistics();
+
+			auto sessionPackets = static_cast<qint64>(
+				statistics.packets_ - session.last_.packets_);
+			auto sessionBytes = static_cast<qint64>(
+				statistics.bytes_ - session.last_.bytes_);
+			auto sessionLost = statistics.lost_ - session.last_.lost_;
+			auto sessionSyscalls =
+				statistics.syscalls_ - session.last_.syscalls_;
+			auto sessionReconnects =
+				session.reconnects_ - session.lastReconnects_;
+
+			packets += sessionPackets;
+			bytes += sessionBytes;
+			lost += sessionLost;
+			reconnects += sessionReconnects;
+			syscalls += sessionSyscalls;
+			senderReports +=
+				statistics.senderReports_ - session.last_.senderReports_;
+			receiverReports +=
+				statistics.receiverReports_ - session.last_.receiverReports_;
+			requested += statistics.retransmitRequests_ -
+						 session.last_.retransmitRequests_;
+			retransmitted +=
+				statistics.retransmitted_ - session.last_.retransmitted_;
+			unrecovered +=
+				statistics.unrecovered_ - session.last_.unrecovered_;
+			keyFrames += statistics.keyFrameRequests_ -
+						 session.last_.keyFrameRequests_;
+			recoveries += statistics.recoveries_ - session.last_.recoveries_;
+			recoveryTotal +=
+				statistics.meanRecoveryTime_ *
+				static_cast<qint64>(statistics.recoveries_) -
+				session.last_.meanRecoveryTime_ *
+				static_cast<qint64>(session.last_.recoveries_);
+			recoveryMaximum =
+				qMax(recoveryMaximum, statistics.maxRecoveryTime_);
+
+			if (state == Session::Playing && statistics.packets_ > 0) {
+				++measured;
+				jitterTotal += statistics.jitter_;
+				jitterMaximum = qMax(jitterMaximum, statistics.jitter_);
+			}
+
+			if (p.settings_.perSession_) {
+				output << "  session " << i + 1
+					   << "\t" << STATE_NAMES[state]
+					   << "\tpackets/s " << qRound64(sessionPackets / seconds)
+					   << "\tkbit/s " << sessionBytes * 8 / seconds / 1e3
+					   << "\tloss % " << lossPercent(sessionPackets,
+													 sessionLost)
+					   << "\tjitter ms " << statistics.jitter_ / 1e3
+					   << "\treconnects " << session.reconnects_
+					   << "\t" << session.url_.toString() << "\n";
+			}
+
+			session.last_ = statistics;
+			session.lastReconnects_ = session.reconnects_;
+		}
+
+		auto playing = states[Session::Playing];
+		auto cpuPercent = cpuSeconds * 100 / seconds;
+		auto memory = residentMemory();
+		auto buffers = PacketBufferPool::getTotalStatistics();
+		auto shared = RTSPSharedReceiver::getTotalStatistics();
+
+		syscalls += shared.syscalls_ - p.shared_.syscalls_;
+		p.shared_ = shared;
+
+		output << "time s " << qRound64(p.clock_.elapsed() / 1e3)
+			   << "\tplaying " << playing << "/" << p.sessions_.size()
+			   << "\tconnecting " << states[Session::Connecting]
+			   << "\treconnecting " << states[Session::Reconnecting]
+			   << "\tfailed " << states[Session::Failed]
+			   << "\tpackets/s " << qRound64(packets / seconds)
+			   << "\tMbit/s " << bytes * 8 / seconds / 1e6
+			   << "\tloss % " << lossPercent(packets, lost)
+			   << "\tjitter ms avg/max "
+			   << (measured > 0 ? jitterTotal / 1e3 / measured : 0.0)
+			   << "/" << jitterMaximum / 1e3
+			   << "\treconnects " << reconnects
+			   << "\trtcp sr/rr " << senderReports << "/" << receiverReports
+			   << "\tnack req/rtx/unrec " << requested << "/" << retransmitted
+			   << "/" << unrecovered
+			   << "\tkey frame req " << keyFrames
+			   << "\trecovery ms avg/max "
+			   << (recoveries > 0 ? recoveryTotal / 1e3 / recoveries : 0.0)
+			   << "/" << recoveryMaximum / 1e3
+			   << "\tpool hit % " << buffers.hitRate_ * 100
+			   << "\tpool high-water " << buffers.highWater_
+			   << "\tsyscalls/packet "
+			   << (packets > 0 ? static_cast<double>(syscalls) / packets : 0.0)
+			   << "\tcpu % " << cpuPercent
+			   << "\tcpu/stream % "
+			   << (playing > 0 ? cpuPercent / playing : 0.0)
+			   << "\trss MB ";
+
+		if (memory < 0) output << "n/a";
+		else output << memory / 1048576.0;
+
+		output << "\n";
+		output.flush();
+	}
+
+	/// Opens a session.
+	/// \details Runs open, setup and play on the client thread one after
+	/// another without blocking it. UDP sessions take consecutive port
+	/// pairs, interleaved sessions use channels 0 and 1.
+	/// \param[in]	index	Session index.
+	void LoadGenerator::launch(int index) {
+		auto& p = *private_;
+		auto session = p.sessions_[static_cast<size_t>(index)].get();
+		auto client = p.pool_.create();
+		const auto& settings = p.settings_;
+
+		session->client_ = client;
+		session->state_.store(Session::Connecting);
+
+		connect(client, &RTSPClient::onDisconnected, this, [session]() {
+			session->state_.store(Session::Reconnecting);
+		});
+
+		connect(client, &RTSPClient::onReconnected, this,
+				[session](qint64) {
+			++session->reconnects_;
+			session->state_.store(Session::Playing);
+		});
+
+		auto rtp = settings.transport_ == RTSPTransport::TCP
+				   ? 0
+				   : settings.port_ + 2 * index;
+
+		QPair<quint16, quint16> ports {
+			static_cast<quint16>(rtp),
+			static_cast<quint16>(rtp + 1)
+		};
+
+		auto url = session->url_;
+		auto track = settings.track_;
+		auto transport = settings.transport_;
+		auto backend = settings.backend_;
+		auto fastStart = settings.fastStart_;
+		auto batchReceive = settings.batchReceive_;
+		auto sharedReceive = settings.sharedReceive_;
+		auto reportKeepAlive = settings.reportKeepAlive_;
+		auto retransmission = settings.retransmission_;
+		auto keyFrameRequest = settings.keyFrameRequest_;
+		auto autoReconnect = settings.autoReconnect_;
+
+		QMetaObject::invokeMethod(client, [=]() {
+			auto failed = [session]() {
+				session->state_.store(Session::Failed);
+			};
+
+			client->setTransport(transport);
+			client->setBackend(backend);
+			client->setFastStart(fastStart);
+			client->setBatchReceive(batchReceive);
+			client->setSharedReceive(sharedReceive);
+			client->setReportKeepAlive(reportKeepAlive);
+			client->setRetransmission(retransmission);
+			client->setKeyFrameRequest(keyFrameRequest);
+			client->setAutoReconnect(autoReconnect);
+
+			client->openAsync(url, [=](bool opened) {
+				if (!opened) {
+					failed();
+					return;
+				}
+
+				client->setupAsync(track, ports, [=](bool setUp) {
+					if (!setUp) {
+						failed();
+						return;
+					}
+
+					client->playAsync([session](bool played) {
+						session->state_.store(played
+											  ? Session::Playing
+											  : Session::Failed);
+					});
+				});
+			});
+		}, Qt::QueuedConnection);
+	}
+
+	/// Stops the run.
+	/// \details Reports the last interval and leaves the event loop. The
+	/// exit status tells whether any session failed to come up.
+	void LoadGenerator::stop() {
+		auto& p = *private_;
+
+		p.launchTimer_.stop();
+		p.reportTimer_.stop();
+
+		onReport();
+
+		auto failed = false;
+
+		for (const auto& session : p.sessions_)
+			failed = failed || session->state_.load() == Session::Failed;
+
+		QCoreApplication::exit(failed ? 1 : 0);
+	}
+}
@@ -0,0 +1,138 @@
+/// \file LoadGenerator.hpp
+/// \brief Contains classes and functions declarations that provide RTSP load
+/// generator.
+/// \bug No known bugs.
+
+#ifndef LOADGENERATOR_HPP
+#define LOADGENERATOR_HPP
+
+#include "RTSPClient/Client/RTSPClient.hpp"
+
+#include <QObject>
+#include <QScopedPointer>
+#include <QStringList>
+
+/// Contains the RTSP client command line tool.
+namespace ClientCLI {
+
+	/// Structure that describes a load run.
+	struct LoadSettings final {
+
+		/// RTSP connection URLs, used in turn by sessions.
+		/// \details The {n} placeholder is replaced by the session number.
+		QStringList urls_;
+
+		/// Number of sessions.
+		int sessions_ { 1 };
+
+		/// Time over which sessions are opened in milliseconds.
+		int rampUp_ { 0 };
+
+		/// Media stream path.
+		QUrl track_ { "track1" };
+
+		/// RTP transport protocol.
+		RTSPLib::RTSPClient::RTSPTransport transport_ {
+			RTSPLib::RTSPClient::RTSPTransport::UDP
+		};
+
+		/// RTSP protocol backend.
+		RTSPLib::RTSPClient::RTSPBackend backend_ {
+			RTSPLib::RTSPClient::RTSPBackend::Curl
+		};
+
+		/// Whether session bring-up skips OPTIONS.
+		bool fastStart_ { false };
+
+		/// Whether UDP datagrams are received in batches.
+		bool batchReceive_ { true };
+
+		/// Whether UDP datagrams are received by shared sockets.
+		bool sharedReceive_ { false };
+
+		/// Whether RTCP exchange replaces keep-alive requests.
+		bool reportKeepAlive_ { false };
+
+		/// Whether lost packets are requested again.
+		bool retransmission_ { false };
+
+		/// Key frame request of broken video.
+		RTSPLib::RTSPClient::RTSPKeyFrameRequest keyFrameRequest_ {
+			RTSPLib::RTSPClient::RTSPKeyFrameRequest::None
+		};
+
+		/// Whether lost sessions are restored.
+		bool autoReconnect_ { true };
+
+		/// Number of client threads, zero for the number of cores.
+		int shards_ { 0 };
+
+		/// First client port of UDP transport.
+		quint16 port_ { 50000 };
+
+		/// Report interval in milliseconds.
+		int interval_ { 5000 };
+
+		/// Run time in milliseconds, zero runs until interrupted.
+		int duration_ { 0 };
+
+		/// Whether every session is reported.
+		bool perSession_ { false };
+	};
+
+	/// Class that provides RTSP load generator.
+	/// \details Opens sessions on a client pool at an even pace over the
+	/// ramp-up time and reports aggregate and per-session reception
+	/// statistics, reconnects, processor time and resident memory of the
+	/// process at every interval.
+	class LoadGenerator final : public QObject {
+
+		Q_OBJECT
+
+	public:
+
+		/// Constructor.
+		/// \param[in]	settings	Load settings.
+		/// \param[in]	parent		Parent object.
+		explicit LoadGenerator(const LoadSettings& settings,
+							   QObject* parent = nullptr);
+
+		/// Destructor.
+		~LoadGenerator() override;
+
+	public slots:
+
+		/// Starts opening sessions.
+		void start();
+
+	private slots:
+
+		/// Opens sessions that are due.
+		void onLaunch();
+
+		/// Prints statistics of the last interval.
+		void onReport();
+
+	private:
+
+		/// Structure that describes a session.
+		struct Session;
+
+		/// Opens a session.
+		/// \param[in]	index	Session index.
+		void launch(int index);
+
+		/// Stops the run.
+		void stop();
+
+	private:
+
+		/// Opaque type for private data.
+		struct LoadGeneratorPrivate;
+
+		/// Private data.
+		const QScopedPointer<LoadGeneratorPrivate> private_;
+	};
+}
+
+#endif
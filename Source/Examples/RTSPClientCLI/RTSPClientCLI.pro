@@ -3,9 +3,10 @@
 #------------------------------------------------------------------------------#
 
 QT				-=		gui
+QT				+=		network
 TEMPLATE		=		app
 TARGET			=		rtspclientcli
-CONFIG			+=		c11 c++11 strict_c strict_c++
+CONFIG			+=		c11 c++11 strict_c strict_c++ console
 
 
 #------------------------------------------------------------------------------#
@@ -21,9 +22,11 @@ DEFINES			+=															\
 #------------------------------------------------------------------------------#
 
 HEADERS			+=															\
+						$$PWD/LoadGenerator.hpp								\
 
 SOURCES			+=															\
 						$$PWD/main.cpp										\
+						$$PWD/LoadGenerator.cpp								\
 
 
 #------------------------------------------------------------------------------#
@@ -2,12 +2,43 @@
 /// \brief Contains entry point to the application.
 /// \bug No known bugs.
 
+#include <QCommandLineParser>
 #include <QCoreApplication>
+#include <QFile>
+#include <QTextStream>
+#include <QTimer>
 
-#include "RTSPClient/Client/RTSPClient.hpp"
+#include "LoadGenerator.hpp"
+
+/// Contains URL list helpers.
+namespace {
+
+	/// Reads RTSP connection URLs from a file.
+	/// \details One URL per line, empty lines and lines starting with # are
+	/// skipped.
+	/// \param[in]	path	File path.
+	/// \param[out]	urls	RTSP connection URLs.
+	/// \retval true on success.
+	/// \retval false if the file could not be read.
+	bool readUrls(const QString& path, QStringList& urls) {
+		QFile file(path);
+
+		if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return false;
+
+		while (!file.atEnd()) {
+			auto line = QString::fromUtf8(file.readLine()).trimmed();
+
+			if (!line.isEmpty() && !line.startsWith('#')) urls.append(line);
+		}
+
+		return true;
+	}
+}
 
 /// Runs the main application thread.
-/// \details Starts the message transfer pipeline between different subsystems.
+/// \details Opens the requested number of RTSP sessions and reports their
+/// reception statistics until the run time passes or the process is
+/// interrupted.
 /// \param[in]	argc	Number of arguments passed to the program.
 /// \param[in]	argv	Array of pointers that contain arguments passed
 ///						to the program.
@@ -15,14 +46,137 @@
 int main(int argc, char *argv[]) {
 	QCoreApplication a(argc, argv);
 
-	RTSPLib::RTSPClient::RTSPClient client;
-	QPair<quint16, quint16> ports { 50000, 50001 };
-	QUrl stream { "track1" };
-	QUrl url {"rtsp://192.168.11.20:554/udpstream_ch1_stream1_h264"};
+	QCommandLineParser parser;
+	parser.setApplicationDescription(
+		"Opens many RTSP sessions and reports packets, bytes, loss, jitter "
+		"and reconnects per second together with processor time and "
+		"resident memory. Sessions take URLs in turn, {n} in a URL is "
+		"replaced by the session number, for example "
+		"rtsp://127.0.0.1:8554/camera{n}.");
+	parser.addHelpOption();
+	parser.addPositionalArgument("urls", "RTSP connection URLs.", "[urls...]");
+
+	QCommandLineOption listOption(
+		"list", "File with RTSP connection URLs, one per line.", "file");
+	QCommandLineOption sessionsOption(
+		"sessions", "Number of sessions, default the number of URLs.",
+		"count");
+	QCommandLineOption rampUpOption(
+		"ramp-up", "Time over which sessions are opened.", "seconds", "0");
+	QCommandLineOption trackOption(
+		"track", "Media track path.", "path", "track1");
+	QCommandLineOption transportOption(
+		"transport", "RTP transport, udp or tcp.", "name", "udp");
+	QCommandLineOption backendOption(
+		"backend", "RTSP backend, curl or native.", "name", "curl");
+	QCommandLineOption fastStartOption(
+		"fast-start", "Skip OPTIONS during bring-up.");
+	QCommandLineOption noBatchOption(
+		"no-batch", "Receive UDP datagrams one by one.");
+	QCommandLineOption sharedOption(
+		"shared", "Receive UDP datagrams of a thread by shared sockets.");
+	QCommandLineOption rtcpKeepAliveOption(
+		"rtcp-keepalive", "Skip keep-alive requests while RTCP is exchanged.");
+	QCommandLineOption nackOption(
+		"nack", "Request retransmission of lost UDP packets.");
+	QCommandLineOption keyFrameOption(
+		"keyframe", "Key frame request of broken video, none, pli or fir.",
+		"name", "none");
+	QCommandLineOption noReconnectOption(
+		"no-reconnect", "Do not restore lost sessions.");
+	QCommandLineOption threadsOption(
+		"threads", "Number of client threads, default the number of cores.",
+		"count", "0");
+	QCommandLineOption portOption(
+		"port", "First client port of UDP transport.", "port", "50000");
+	QCommandLineOption intervalOption(
+		"interval", "Report interval.", "seconds", "5");
+	QCommandLineOption durationOption(
+		"duration", "Run time, zero runs until interrupted.", "seconds", "0");
+	QCommandLineOption perSessionOption(
+		"per-session", "Report every session.");
+
+	parser.addOption(listOption);
+	parser.addOption(sessionsOption);
+	parser.addOption(rampUpOption);
+	parser.addOption(trackOption);
+	parser.addOption(transportOption);
+	parser.addOption(backendOption);
+	parser.addOption(fastStartOption);
+	parser.addOption(noBatchOption);
+	parser.addOption(sharedOption);
+	parser.addOption(rtcpKeepAliveOption);
+	parser.addOption(nackOption);
+	parser.addOption(keyFrameOption);
+	parser.addOption(noReconnectOption);
+	parser.addOption(threadsOption);
+	parser.addOption(portOption);
+	parser.addOption(intervalOption);
+	parser.addOption(durationOption);
+	parser.addOption(perSessionOption);
+	parser.process(a);
+
+	ClientCLI::LoadSettings settings;
+	settings.urls_ = parser.positionalArguments();
+
+	if (parser.isSet(listOption) &&
+		!readUrls(parser.value(listOption), settings.urls_)) {
+		QTextStream(stderr) << "Failed to read "
+							<< parser.value(listOption) << "\n";
+		return 1;
+	}
+
+	if (settings.urls_.isEmpty()) parser.showHelp(1);
+
+	settings.sessions_ = parser.isSet(sessionsOption)
+						 ? parser.value(sessionsOption).toInt()
+						 : settings.urls_.size();
+
+	auto transport = parser.value(transportOption);
+	auto backend = parser.value(backendOption);
+	auto keyFrame = parser.value(keyFrameOption);
+	auto port = parser.value(portOption).toInt();
+
+	settings.rampUp_ = qRound(parser.value(rampUpOption).toDouble() * 1000);
+	settings.track_ = QUrl(parser.value(trackOption));
+	settings.transport_ = transport == "tcp"
+						  ? RTSPLib::RTSPClient::RTSPTransport::TCP
+						  : RTSPLib::RTSPClient::RTSPTransport::UDP;
+	settings.backend_ = backend == "native"
+						? RTSPLib::RTSPClient::RTSPBackend::Native
+						: RTSPLib::RTSPClient::RTSPBackend::Curl;
+	settings.fastStart_ = parser.isSet(fastStartOption);
+	settings.batchReceive_ = !parser.isSet(noBatchOption);
+	settings.sharedReceive_ = parser.isSet(sharedOption);
+	settings.reportKeepAlive_ = parser.isSet(rtcpKeepAliveOption);
+	settings.retransmission_ = parser.isSet(nackOption);
+	settings.keyFrameRequest_ =
+		keyFrame == "pli"
+		? RTSPLib::RTSPClient::RTSPKeyFrameRequest::PictureLoss
+		: keyFrame == "fir"
+		? RTSPLib::RTSPClient::RTSPKeyFrameRequest::FullIntraRequest
+		: RTSPLib::RTSPClient::RTSPKeyFrameRequest::None;
+	settings.autoReconnect_ = !parser.isSet(noReconnectOption);
+	settings.shards_ = parser.value(threadsOption).toInt();
+	settings.port_ = static_cast<quint16>(port);
+	settings.interval_ =
+		qRound(parser.value(intervalOption).toDouble() * 1000);
+	settings.duration_ =
+		qRound(parser.value(durationOption).toDouble() * 1000);
+	settings.perSession_ = parser.isSet(perSessionOption);
+
+	if (settings.sessions_ <= 0 || settings.rampUp_ < 0					||
+		settings.shards_ < 0 || settings.interval_ <= 0					||
+		settings.duration_ < 0											||
+		(transport != "udp" && transport != "tcp")						||
+		(backend != "curl" && backend != "native")						||
+		(settings.transport_ == RTSPLib::RTSPClient::RTSPTransport::UDP &&
+		 (port <= 0 || port + 2 * settings.sessions_ > 0xFFFF)))
+		parser.showHelp(1);
+
+	ClientCLI::LoadGenerator generator(settings);
 
-	client.open(url);
-	client.setup(stream, ports);
-	client.play();
+	QTimer::singleShot(0, &generator, SLOT(start()));
 
 	return a.exec();
 }
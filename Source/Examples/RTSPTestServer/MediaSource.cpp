@@ -0,0 +1,330 @@
+/// \file MediaSource.cpp
+/// \brief Contains classes and functions definitions that provide synthetic
+/// media source.
+/// \bug No known bugs.
+
+#include "MediaSource.hpp"
+
+#include <cstring>
+#include <random>
+
+/// Contains the RTSP test server.
+namespace TestServer {
+
+	namespace {
+
+		/// Size of the filler pattern.
+		/// \details Larger than any payload.
+		constexpr int PATTERN_SIZE { 65536 };
+
+		/// Smallest payload size of video packets.
+		/// \details Same as the limit of the packet size setting.
+		constexpr int MIN_PACKET_SIZE { 16 };
+
+		/// Largest payload size of video packets.
+		/// \details Same as the limit of the packet size setting.
+		constexpr int MAX_PACKET_SIZE { 65000 };
+
+		/// Size ratio of IDR frames to other frames.
+		/// \details Typical for surveillance streams with a long GOP.
+		constexpr int KEY_FRAME_RATIO { 4 };
+
+		/// RTP payload type of H.264 retransmissions.
+		/// \details Dynamic payload type next to the ones of the codecs.
+		constexpr int RTX_PAYLOAD_TYPE { 98 };
+
+		/// FU-A NAL unit type.
+		/// \details Defined by RFC 6184, section 5.8.
+		constexpr int FU_A { 28 };
+
+		/// Largest AAC access unit size.
+		/// \details Limited by the 13-bit size field of the AU header.
+		constexpr int MAX_AAC_SIZE { 8191 };
+
+		/// AAC sampling rate.
+		/// \details Matches the AudioSpecificConfig in the SDP.
+		constexpr int AAC_CLOCK_RATE { 48000 };
+
+		/// Number of samples per AAC frame.
+		/// \details Fixed for AAC-LC.
+		constexpr int AAC_FRAME_TICKS { 1024 };
+
+		/// Number of samples per G.711 packet.
+		/// \details 20 ms at 8 kHz.
+		constexpr int G711_FRAME_TICKS { 160 };
+
+		/// H.264 sequence parameter set.
+		/// \details Constrained baseline profile, level 3.0.
+		const char SPS[] {
+			'\x67', '\x42', '\xC0', '\x1E', '\xD9', '\x00', '\xA0', '\x47',
+			'\xFE', '\xC8'
+		};
+
+		/// H.264 picture parameter set.
+		/// \details Matches the sequence parameter set.
+		const char PPS[] { '\x68', '\xCE', '\x3C', '\x80' };
+
+		/// Returns filler pattern.
+		/// \details Pseudo-random bytes, created once for all sources.
+		/// \return Filler pattern.
+		const QByteArray& fillPattern() {
+			static const QByteArray pattern = []() {
+				std::mt19937 random;
+				QByteArray data(PATTERN_SIZE, Qt::Uninitialized);
+
+				for (auto& byte : data)
+					byte = static_cast<char>(random() & 0xFF);
+
+				return data;
+			}();
+
+			return pattern;
+		}
+
+		/// Copies filler bytes.
+		/// \param[out]	destination	Destination buffer.
+		/// \param[in]	offset		Offset within the frame.
+		/// \param[in]	size		Number of bytes.
+		void fill(char* destination, int offset, int size) {
+			auto start = offset % (PATTERN_SIZE - size + 1);
+			std::memcpy(destination, fillPattern().constData() + start,
+						static_cast<size_t>(size));
+		}
+	}
+
+	/// Constructor.
+	/// \details Derives frame and packet sizes from the settings.
+	/// \param[in]	codec		Codec.
+	/// \param[in]	settings	Stream settings.
+	MediaSource::MediaSource(Codec codec, const StreamSettings& settings)
+		: codec_(codec) {
+
+		switch (codec) {
+		case Codec::H264: {
+			auto bytes = static_cast<qint64>(settings.videoBitrate_) * 125;
+
+			frameTicks_ = qMax(1, getClockRate() / settings.frameRate_);
+			gop_ = settings.gop_;
+			packetSize_ = settings.packetSize_;
+
+			if (settings.packetRate_ > 0)
+				packetSize_ = static_cast<int>(qBound<qint64>(
+					MIN_PACKET_SIZE,
+					(bytes + settings.packetRate_ - 1) / settings.packetRate_,
+					MAX_PACKET_SIZE));
+
+			auto average = bytes * frameTicks_ / getClockRate();
+
+			frameSize_ = static_cast<int>(qMax<qint64>(
+				1,
+				average * gop_ / (gop_ - 1 + KEY_FRAME_RATIO)));
+
+			keySize_ = gop_ > 1
+					   ? frameSize_ * KEY_FRAME_RATIO
+					   : frameSize_;
+
+			retransmission_ = settings.retransmission_;
+			break;
+		}
+		case Codec::AAC:
+			frameTicks_ = AAC_FRAME_TICKS;
+			frameSize_ = qBound(
+				1,
+				settings.audioBitrate_ * 125 * AAC_FRAME_TICKS /
+				AAC_CLOCK_RATE,
+				MAX_AAC_SIZE);
+			break;
+		case Codec::PCMU:
+		case Codec::PCMA:
+			frameTicks_ = G711_FRAME_TICKS;
+			frameSize_ = G711_FRAME_TICKS;
+			break;
+		}
+	}
+
+	/// Returns codec.
+	/// \details Returns codec.
+	/// \return Codec.
+	MediaSource::Codec MediaSource::getCodec() const {
+		return codec_;
+	}
+
+	/// Returns RTP payload type.
+	/// \details G.711 uses static payload types, others dynamic ones.
+	/// \return Payload type.
+	int MediaSource::getPayloadType() const {
+		switch (codec_) {
+		case Codec::H264:	return 96;
+		case Codec::AAC:	return 97;
+		case Codec::PCMU:	return 0;
+		case Codec::PCMA:	return 8;
+		}
+
+		return 0;
+	}
+
+	/// Returns RTP clock rate.
+	/// \details Defined by the payload formats.
+	/// \return Clock rate in Hz.
+	int MediaSource::getClockRate() const {
+		switch (codec_) {
+		case Codec::H264:	return 90000;
+		case Codec::AAC:	return AAC_CLOCK_RATE;
+		case Codec::PCMU:
+		case Codec::PCMA:	return 8000;
+		}
+
+		return 0;
+	}
+
+	/// Returns RTP payload type of retransmissions.
+	/// \details Video is retransmitted in the RFC 4588 payload format if the
+	/// settings keep its packets.
+	/// \return Payload type or -1 if retransmission is disabled.
+	int MediaSource::getRetransmissionType() const {
+		return retransmission_ > 0 ? RTX_PAYLOAD_TYPE : -1;
+	}
+
+	/// Returns SDP media description.
+	/// \details Includes payload format parameters and the control URL.
+	/// Video announces key frame requests it answers and its
+	/// retransmission payload format if it has one.
+	/// \param[in]	control	Track control URL.
+	/// \return Media description.
+	QByteArray MediaSource::getDescription(const QByteArray& control) const {
+		QByteArray description;
+
+		switch (codec_) {
+		case Codec::H264:
+			description =
+				"m=video 0 RTP/AVP 96" +
+				(retransmission_ > 0 ? QByteArray(" 98") : QByteArray()) +
+				"\r\n"
+				"a=rtpmap:96 H264/90000\r\n"
+				"a=fmtp:96 packetization-mode=1;profile-level-id=42C01E;"
+				"sprop-parameter-sets=" +
+				QByteArray::fromRawData(SPS, sizeof(SPS)).toBase64() + ',' +
+				QByteArray::fromRawData(PPS, sizeof(PPS)).toBase64() +
+				"\r\n"
+				"a=rtcp-fb:96 nack pli\r\n"
+				"a=rtcp-fb:96 ccm fir\r\n";
+
+			if (retransmission_ > 0)
+				description +=
+					"a=rtpmap:98 rtx/90000\r\n"
+					"a=fmtp:98 apt=96;rtx-time=" +
+					QByteArray::number(retransmission_) + "\r\n";
+			break;
+		case Codec::AAC:
+			description =
+				"m=audio 0 RTP/AVP 97\r\n"
+				"a=rtpmap:97 MPEG4-GENERIC/48000/2\r\n"
+				"a=fmtp:97 streamtype=5;profile-level-id=15;mode=AAC-hbr;"
+				"config=1190;sizelength=13;indexlength=3;"
+				"indexdeltalength=3\r\n";
+			break;
+		case Codec::PCMU:
+			description =
+				"m=audio 0 RTP/AVP 0\r\n"
+				"a=rtpmap:0 PCMU/8000\r\n";
+			break;
+		case Codec::PCMA:
+			description =
+				"m=audio 0 RTP/AVP 8\r\n"
+				"a=rtpmap:8 PCMA/8000\r\n";
+			break;
+		}
+
+		return description + "a=control:" + control + "\r\n";
+	}
+
+	/// Returns time of a frame.
+	/// \details Derived from the timestamp, so that timestamps and send
+	/// times never drift apart.
+	/// \param[in]	frame	Frame index.
+	/// \return Time in microseconds from the first frame.
+	qint64 MediaSource::getFrameTime(quint64 frame) const {
+		return static_cast<qint64>(frame) * frameTicks_ * 1000000 /
+			   getClockRate();
+	}
+
+	/// Returns RTP timestamp of a frame.
+	/// \details Wraps around like RTP timestamps do.
+	/// \param[in]	frame	Frame index.
+	/// \return Timestamp relative to the first frame.
+	quint32 MediaSource::getFrameTimestamp(quint64 frame) const {
+		return static_cast<quint32>(frame * static_cast<quint64>(frameTicks_));
+	}
+
+	/// Produces RTP payloads of a frame.
+	/// \details Payloads are built in a reused buffer and are valid only
+	/// within the sink call.
+	/// \param[in]	frame	Frame index.
+	/// \param[in]	sink	Payload sink.
+	void MediaSource::produce(quint64 frame, const sink_t& sink) {
+		if (codec_ == Codec::PCMU || codec_ == Codec::PCMA) {
+			payload_.fill(codec_ == Codec::PCMU ? '\xFF' : '\xD5',
+						  frameSize_);
+			sink(payload_.constData(), frameSize_, frame == 0);
+			return;
+		}
+
+		if (codec_ == Codec::AAC) {
+			payload_.resize(frameSize_ + 4);
+
+			auto data = payload_.data();
+			data[0] = 0;
+			data[1] = 16;
+			data[2] = static_cast<char>(frameSize_ >> 5);
+			data[3] = static_cast<char>((frameSize_ & 0x1F) << 3);
+
+			fill(data + 4, 0, frameSize_);
+			sink(payload_.constData(), payload_.size(), true);
+			return;
+		}
+
+		auto key = keyFrame_ || frame % static_cast<quint64>(gop_) == 0;
+		keyFrame_ = false;
+
+		if (key) {
+			sink(SPS, sizeof(SPS), false);
+			sink(PPS, sizeof(PPS), false);
+		}
+
+		auto size = key ? keySize_ : frameSize_;
+		auto header = key ? 0x65 : 0x41;
+
+		if (size < packetSize_) {
+			payload_.resize(size + 1);
+			payload_[0] = static_cast<char>(header);
+
+			fill(payload_.data() + 1, 0, size);
+			sink(payload_.constData(), payload_.size(), true);
+			return;
+		}
+
+		for (auto offset = 0; offset < size;) {
+			auto chunk = qMin(packetSize_ - 2, size - offset);
+			auto last = offset + chunk == size;
+
+			payload_.resize(chunk + 2);
+
+			auto data = payload_.data();
+			data[0] = static_cast<char>((header & 0xE0) | FU_A);
+			data[1] = static_cast<char>((header & 0x1F) |
+										(offset == 0 ? 0x80 : 0) |
+										(last ? 0x40 : 0));
+
+			fill(data + 2, offset, chunk);
+			sink(payload_.constData(), payload_.size(), last);
+
+			offset += chunk;
+		}
+	}
+	/// Makes the next video frame an IDR frame.
+	/// \details Answers key frame requests of clients. The group of
+	/// pictures keeps its schedule. Audio ignores it.
+	void MediaSource::requestKeyFrame() {
+		keyFrame_ = true;
+	}
+}
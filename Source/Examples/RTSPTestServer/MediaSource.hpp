@@ -0,0 +1,117 @@
+/// \file MediaSource.hpp
+/// \brief Contains classes and functions declarations that provide synthetic
+/// media source.
+/// \bug No known bugs.
+
+#ifndef MEDIASOURCE_HPP
+#define MEDIASOURCE_HPP
+
+#include "StreamSettings.hpp"
+
+#include <functional>
+
+/// Contains the RTSP test server.
+namespace TestServer {
+
+	/// Class that provides synthetic media source.
+	/// \details Produces RTP payloads with valid packetization and sizes
+	/// that follow the configured bitrate, but without decodable content.
+	/// H.264 is packetized per RFC 6184 in non-interleaved mode, with
+	/// parameter sets before every IDR frame and FU-A fragments for large
+	/// NAL units. AAC uses RFC 3640 high bitrate mode with one access unit
+	/// per packet. G.711 sends 20 ms of silence per packet.
+	class MediaSource final {
+	public:
+
+		/// Payload sink type.
+		/// \details Receives payload data, payload size and marker bit.
+		using sink_t = std::function<void(const char*, int, bool)>;
+
+		/// Enumeration that defines codecs.
+		enum class Codec {
+			H264,
+			AAC,
+			PCMU,
+			PCMA
+		};
+
+	public:
+
+		/// Constructor.
+		/// \param[in]	codec		Codec.
+		/// \param[in]	settings	Stream settings.
+		explicit MediaSource(Codec codec, const StreamSettings& settings);
+
+	public:
+
+		/// Returns codec.
+		/// \return Codec.
+		Codec getCodec() const;
+
+		/// Returns RTP payload type.
+		/// \return Payload type.
+		int getPayloadType() const;
+
+		/// Returns RTP clock rate.
+		/// \return Clock rate in Hz.
+		int getClockRate() const;
+
+		/// Returns RTP payload type of retransmissions.
+		/// \return Payload type or -1 if retransmission is disabled.
+		int getRetransmissionType() const;
+
+		/// Returns SDP media description.
+		/// \param[in]	control	Track control URL.
+		/// \return Media description.
+		QByteArray getDescription(const QByteArray& control) const;
+
+		/// Returns time of a frame.
+		/// \param[in]	frame	Frame index.
+		/// \return Time in microseconds from the first frame.
+		qint64 getFrameTime(quint64 frame) const;
+
+		/// Returns RTP timestamp of a frame.
+		/// \param[in]	frame	Frame index.
+		/// \return Timestamp relative to the first frame.
+		quint32 getFrameTimestamp(quint64 frame) const;
+
+		/// Produces RTP payloads of a frame.
+		/// \param[in]	frame	Frame index.
+		/// \param[in]	sink	Payload sink.
+		void produce(quint64 frame, const sink_t& sink);
+
+		/// Makes the next video frame an IDR frame.
+		void requestKeyFrame();
+
+	private:
+
+		/// Codec.
+		const Codec codec_;
+
+		/// Frame duration in RTP clock ticks.
+		int frameTicks_ { 0 };
+
+		/// Number of frames between IDR frames.
+		int gop_ { 1 };
+
+		/// Largest payload size.
+		int packetSize_ { 0 };
+
+		/// Size of IDR frames.
+		int keySize_ { 0 };
+
+		/// Size of other frames.
+		int frameSize_ { 0 };
+
+		/// Time packets are kept for retransmission in milliseconds.
+		int retransmission_ { 0 };
+
+		/// Whether the next video frame is an IDR frame.
+		bool keyFrame_ { false };
+
+		/// Payload buffer.
+		QByteArray payload_;
+	};
+}
+
+#endif
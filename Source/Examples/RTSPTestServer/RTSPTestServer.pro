@@ -0,0 +1,35 @@
+#------------------------------------------------------------------------------#
+#                                Base settings                                 #
+#------------------------------------------------------------------------------#
+
+QT				-=		gui
+QT				+=		network
+TEMPLATE		=		app
+TARGET			=		rtsptestserver
+CONFIG			+=		c11 c++11 strict_c strict_c++ console
+
+
+#------------------------------------------------------------------------------#
+#                              Project definitions                             #
+#------------------------------------------------------------------------------#
+
+DEFINES			+=															\
+						QT_DEPRECATED_WARNINGS								\
+
+
+#------------------------------------------------------------------------------#
+#                             Project files settings                           #
+#------------------------------------------------------------------------------#
+
+HEADERS			+=															\
+						$$PWD/MediaSource.hpp								\
+						$$PWD/Server.hpp									\
+						$$PWD/StreamSettings.hpp							\
+						$$PWD/Worker.hpp									\
+
+SOURCES			+=															\
+						$$PWD/main.cpp										\
+						$$PWD/MediaSource.cpp								\
+						$$PWD/Server.cpp									\
+						$$PWD/StreamSettings.cpp							\
+						$$PWD/Worker.cpp									\
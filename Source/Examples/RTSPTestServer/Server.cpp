@@ -0,0 +1,152 @@
+/// \file Server.cpp
+/// \brief Contains classes and functions definitions that provide RTSP test
+/// server.
+/// \bug No known bugs.
+
+#include "Server.hpp"
+
+#include <QThread>
+
+#include <memory>
+#include <vector>
+
+/// Contains the RTSP test server.
+namespace TestServer {
+
+	/// Structure that provides private storage.
+	/// \details Maintains private data.
+	struct Server::ServerPrivate final {
+
+		/// Constructor.
+		/// \param[in]	settings	Default stream settings.
+		/// \param[in]	threads		Number of worker threads.
+		/// \param[in]	timeout		Session timeout in seconds.
+		ServerPrivate(const StreamSettings& settings,
+					  int threads,
+					  int timeout)
+			: settings_(settings),
+			  threads_(threads > 0 ? threads : QThread::idealThreadCount()),
+			  timeout_(timeout) { }
+
+		/// Default stream settings.
+		const StreamSettings settings_;
+
+		/// Number of worker threads.
+		const int threads_;
+
+		/// Session timeout in seconds.
+		const int timeout_;
+
+		/// Worker threads.
+		std::vector<std::unique_ptr<QThread>> threadList_;
+
+		/// Workers, owned by their threads.
+		std::vector<Worker*> workers_;
+
+		/// Index of the worker of the next connection.
+		size_t next_ { 0 };
+	};
+
+	/// Constructor.
+	/// \details Worker threads are started by start().
+	/// \param[in]	settings	Default stream settings.
+	/// \param[in]	threads		Number of worker threads, or zero for the
+	///							number of processor cores.
+	/// \param[in]	timeout		Session timeout in seconds.
+	/// \param[in]	parent		Parent object.
+	Server::Server(const StreamSettings& settings,
+				   int threads,
+				   int timeout,
+				   QObject* parent)
+		: QTcpServer(parent),
+		  private_(new ServerPrivate(settings, threads, timeout)) {
+
+	}
+
+	/// Destructor.
+	/// \details Stops worker threads, workers are deleted when their thread
+	/// finishes.
+	Server::~Server() {
+		close();
+
+		for (const auto& thread : private_->threadList_) thread->quit();
+		for (const auto& thread : private_->threadList_) thread->wait();
+	}
+
+	/// Starts worker threads and listens for connections.
+	/// \details Workers send UDP packets from the listen address.
+	/// \param[in]	address	Listen address.
+	/// \param[in]	port	Listen port.
+	/// \retval true on success.
+	/// \retval false on error.
+	bool Server::start(const QHostAddress& address, quint16 port) {
+		auto& p = *private_;
+
+		if (!p.workers_.empty() || !listen(address, port)) return false;
+
+		for (auto i = 0; i < p.threads_; ++i) {
+			std::unique_ptr<QThread> thread(new QThread);
+			auto worker = new Worker(p.settings_, address, p.timeout_);
+
+			worker->moveToThread(thread.get());
+
+			connect(thread.get(), &QThread::started,
+					worker, &Worker::start);
+
+			connect(thread.get(), &QThread::finished,
+					worker, &QObject::deleteLater);
+
+			thread->start();
+
+			p.workers_.push_back(worker);
+			p.threadList_.push_back(std::move(thread));
+		}
+
+		return true;
+	}
+
+	/// Returns number of worker threads.
+	/// \details Zero until the server is started.
+	/// \return Number of worker threads.
+	int Server::getWorkerCount() const {
+		return static_cast<int>(private_->workers_.size());
+	}
+
+	/// Returns statistics of all workers.
+	/// \details Sums counters of every worker.
+	/// \return Worker statistics.
+	WorkerStatistics Server::getStatistics() const {
+		WorkerStatistics total;
+
+		for (auto worker : private_->workers_) {
+			auto statistics = worker->getStatistics();
+
+			total.connections_		+= statistics.connections_;
+			total.sessions_			+= statistics.sessions_;
+			total.playing_			+= statistics.playing_;
+			total.packets_			+= statistics.packets_;
+			total.bytes_			+= statistics.bytes_;
+			total.lost_				+= statistics.lost_;
+			total.dropped_			+= statistics.dropped_;
+			total.retransmitted_	+= statistics.retransmitted_;
+			total.keyFrames_		+= statistics.keyFrames_;
+		}
+
+		return total;
+	}
+
+	/// Hands an accepted connection to the next worker.
+	/// \details The socket is created on the worker thread.
+	/// \param[in]	descriptor	Socket descriptor.
+	void Server::incomingConnection(qintptr descriptor) {
+		auto& p = *private_;
+
+		auto worker = p.workers_[p.next_];
+		p.next_ = (p.next_ + 1) % p.workers_.size();
+
+		QMetaObject::invokeMethod(
+			worker,
+			[worker, descriptor]() { worker->accept(descriptor); },
+			Qt::QueuedConnection);
+	}
+}
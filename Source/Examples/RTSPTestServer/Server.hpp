@@ -0,0 +1,73 @@
+/// \file Server.hpp
+/// \brief Contains classes and functions declarations that provide RTSP test
+/// server.
+/// \bug No known bugs.
+
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+#include "Worker.hpp"
+
+#include <QTcpServer>
+
+/// Contains the RTSP test server.
+namespace TestServer {
+
+	/// Class that provides RTSP test server.
+	/// \details Accepts connections on the calling thread and hands them
+	/// to worker threads in turn. A session lives on the worker of the
+	/// connection that set it up.
+	class Server final : public QTcpServer {
+
+		Q_OBJECT
+
+	public:
+
+		/// Constructor.
+		/// \param[in]	settings	Default stream settings.
+		/// \param[in]	threads		Number of worker threads, or zero for the
+		///							number of processor cores.
+		/// \param[in]	timeout		Session timeout in seconds.
+		/// \param[in]	parent		Parent object.
+		explicit Server(const StreamSettings& settings,
+						int threads,
+						int timeout,
+						QObject* parent = nullptr);
+
+		/// Destructor.
+		~Server() override;
+
+	public:
+
+		/// Starts worker threads and listens for connections.
+		/// \param[in]	address	Listen address.
+		/// \param[in]	port	Listen port.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool start(const QHostAddress& address, quint16 port);
+
+		/// Returns number of worker threads.
+		/// \return Number of worker threads.
+		int getWorkerCount() const;
+
+		/// Returns statistics of all workers.
+		/// \return Worker statistics.
+		WorkerStatistics getStatistics() const;
+
+	protected:
+
+		/// Hands an accepted connection to the next worker.
+		/// \param[in]	descriptor	Socket descriptor.
+		void incomingConnection(qintptr descriptor) override;
+
+	private:
+
+		/// Opaque type for private data.
+		struct ServerPrivate;
+
+		/// Private data.
+		const QScopedPointer<ServerPrivate> private_;
+	};
+}
+
+#endif
@@ -0,0 +1,145 @@
+/// \file StreamSettings.cpp
+/// \brief Contains classes and functions definitions that provide synthetic
+/// stream settings.
+/// \bug No known bugs.
+
+#include "StreamSettings.hpp"
+
+#include <QUrlQuery>
+
+/// Contains the RTSP test server.
+namespace TestServer {
+
+	namespace {
+
+		/// Largest RTP payload size.
+		/// \details Keeps packets within a UDP datagram and an interleaved
+		/// frame.
+		constexpr int MAX_PACKET_SIZE { 65000 };
+
+		/// Smallest RTP payload size of video packets.
+		/// \details Leaves room for the FU-A headers.
+		constexpr int MIN_PACKET_SIZE { 16 };
+
+		/// Parses an integer setting.
+		/// \param[in]	value	Setting value.
+		/// \param[in]	minimum	Lowest valid value.
+		/// \param[in]	maximum	Highest valid value.
+		/// \param[out]	result	Parsed value.
+		/// \retval true on success.
+		/// \retval false if the value is invalid.
+		bool parseInteger(const QString& value,
+						  int minimum,
+						  int maximum,
+						  int& result) {
+
+			auto ok = false;
+			auto parsed = value.toInt(&ok);
+
+			if (!ok || parsed < minimum || parsed > maximum) return false;
+
+			result = parsed;
+			return true;
+		}
+
+		/// Parses a percentage setting.
+		/// \param[in]	value	Setting value.
+		/// \param[out]	result	Parsed value.
+		/// \retval true on success.
+		/// \retval false if the value is invalid.
+		bool parsePercent(const QString& value, double& result) {
+			auto ok = false;
+			auto parsed = value.toDouble(&ok);
+
+			if (!ok || parsed < 0 || parsed > 100) return false;
+
+			result = parsed;
+			return true;
+		}
+	}
+
+	/// Names of settings.
+	/// \details Used as command line options and URL query parameters.
+	/// \return Setting names.
+	QStringList StreamSettings::getNames() {
+		return {
+			"video",
+			"fps",
+			"gop",
+			"audio",
+			"audio-bitrate",
+			"packet-size",
+			"packet-rate",
+			"loss",
+			"reorder",
+			"rtx"
+		};
+	}
+
+	/// Sets a setting by name.
+	/// \details Rejects values the packetizers cannot produce.
+	/// \param[in]	name	Setting name.
+	/// \param[in]	value	Setting value.
+	/// \retval true on success.
+	/// \retval false if the name or the value is invalid.
+	bool StreamSettings::set(const QString& name, const QString& value) {
+		if (name == "video")
+			return parseInteger(value, 0, 1000000, videoBitrate_);
+
+		if (name == "fps")
+			return parseInteger(value, 1, 1000, frameRate_);
+
+		if (name == "gop")
+			return parseInteger(value, 1, 100000, gop_);
+
+		if (name == "audio") {
+			auto codec = value.toLower().toLatin1();
+
+			if (codec != "aac"	&&
+				codec != "pcmu"	&&
+				codec != "pcma"	&&
+				codec != "none")
+				return false;
+
+			audio_ = codec;
+			return true;
+		}
+
+		if (name == "audio-bitrate")
+			return parseInteger(value, 8, 512, audioBitrate_);
+
+		if (name == "packet-size")
+			return parseInteger(value,
+								MIN_PACKET_SIZE,
+								MAX_PACKET_SIZE,
+								packetSize_);
+
+		if (name == "packet-rate")
+			return parseInteger(value, 0, 1000000, packetRate_);
+
+		if (name == "loss")
+			return parsePercent(value, loss_);
+
+		if (name == "reorder")
+			return parsePercent(value, reorder_);
+
+		if (name == "rtx")
+			return parseInteger(value, 0, 10000, retransmission_);
+
+		return false;
+	}
+
+	/// Applies query parameters of a URL.
+	/// \details Settings not mentioned in the query are kept.
+	/// \param[in]	query	Encoded URL query.
+	/// \retval true on success.
+	/// \retval false if any parameter is invalid.
+	bool StreamSettings::apply(const QByteArray& query) {
+		QUrlQuery items(QString::fromUtf8(query));
+
+		for (const auto& item : items.queryItems(QUrl::FullyDecoded))
+			if (!set(item.first, item.second)) return false;
+
+		return true;
+	}
+}
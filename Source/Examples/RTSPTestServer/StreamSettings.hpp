@@ -0,0 +1,72 @@
+/// \file StreamSettings.hpp
+/// \brief Contains classes and functions declarations that provide synthetic
+/// stream settings.
+/// \bug No known bugs.
+
+#ifndef STREAMSETTINGS_HPP
+#define STREAMSETTINGS_HPP
+
+#include <QByteArray>
+#include <QStringList>
+
+/// Contains the RTSP test server.
+namespace TestServer {
+
+	/// Structure that describes a synthetic stream.
+	/// \details Server defaults come from the command line, every session may
+	/// override them with query parameters of the URL, for example
+	/// rtsp://127.0.0.1:8554/stream?video=4000&audio=pcmu&loss=0.5. Names of
+	/// parameters are the same in both places.
+	struct StreamSettings final {
+
+		/// Names of settings.
+		/// \return Setting names.
+		static QStringList getNames();
+
+		/// Sets a setting by name.
+		/// \param[in]	name	Setting name.
+		/// \param[in]	value	Setting value.
+		/// \retval true on success.
+		/// \retval false if the name or the value is invalid.
+		bool set(const QString& name, const QString& value);
+
+		/// Applies query parameters of a URL.
+		/// \param[in]	query	Encoded URL query.
+		/// \retval true on success.
+		/// \retval false if any parameter is invalid.
+		bool apply(const QByteArray& query);
+
+		/// H.264 bitrate in kbit/s, zero disables video.
+		int videoBitrate_ { 2000 };
+
+		/// Video frame rate.
+		int frameRate_ { 25 };
+
+		/// Number of frames between IDR frames.
+		int gop_ { 50 };
+
+		/// Audio codec: aac, pcmu, pcma or none.
+		QByteArray audio_ { "aac" };
+
+		/// AAC bitrate in kbit/s.
+		int audioBitrate_ { 64 };
+
+		/// Largest RTP payload size of video packets.
+		int packetSize_ { 1400 };
+
+		/// Video packets per second, overrides the payload size if non-zero.
+		int packetRate_ { 0 };
+
+		/// Share of dropped packets in percent.
+		double loss_ { 0 };
+
+		/// Share of packets sent after their successor in percent.
+		double reorder_ { 0 };
+
+		/// Time video packets are kept for retransmission in milliseconds,
+		/// zero disables retransmission.
+		int retransmission_ { 0 };
+	};
+}
+
+#endif
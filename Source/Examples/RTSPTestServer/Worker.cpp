@@ -0,0 +1,1351 @@
+/// \file Worker.cpp
+/// \brief Contains classes and functions definitions that provide RTSP test
+/// server worker.
+/// \bug No known bugs.
+
+#include "Worker.hpp"
+#include "MediaSource.hpp"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QSharedPointer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUdpSocket>
+#include <QVector>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+/// Contains the RTSP test server.
+namespace TestServer {
+
+	namespace {
+
+		/// Pacing timer interval in milliseconds.
+		/// \details Frames are sent at most this late.
+		constexpr int TICK_INTERVAL { 1 };
+
+		/// Session expiration check interval in milliseconds.
+		/// \details Timeouts are measured in seconds.
+		constexpr int EXPIRE_INTERVAL { 1000 };
+
+		/// Sender report interval in microseconds.
+		/// \details Fixed instead of the RFC 3550 randomized interval, so
+		/// that clients see reports at a predictable rate.
+		constexpr qint64 REPORT_INTERVAL { 1000000 };
+
+		/// Largest pacing lag in microseconds.
+		/// \details A track that fell further behind, for example because
+		/// the worker was not scheduled, restarts its clock instead of
+		/// sending a burst.
+		constexpr qint64 MAX_LAG { 200000 };
+
+		/// RTP fixed header size.
+		/// \details Defined by RFC 3550, section 5.1.
+		constexpr int RTP_HEADER_SIZE { 12 };
+
+		/// RTCP common header size.
+		/// \details Version, padding, count, packet type and length.
+		constexpr int RTCP_HEADER_SIZE { 4 };
+
+		/// RTCP transport layer feedback packet type.
+		/// \details Defined by RFC 4585, section 6.1.
+		constexpr int RTCP_TRANSPORT_FEEDBACK { 205 };
+
+		/// Feedback format of generic negative acknowledgements.
+		/// \details Defined by RFC 4585, section 6.2.1.
+		constexpr int GENERIC_NACK { 1 };
+
+		/// RTCP payload-specific feedback packet type.
+		/// \details Defined by RFC 4585, section 6.1.
+		constexpr int RTCP_PAYLOAD_FEEDBACK { 206 };
+
+		/// Feedback format of picture loss indications.
+		/// \details Defined by RFC 4585, section 6.3.1.
+		constexpr int PICTURE_LOSS { 1 };
+
+		/// Feedback format of full intra requests.
+		/// \details Defined by RFC 5104, section 4.3.1.
+		constexpr int FULL_INTRA_REQUEST { 4 };
+
+		/// Size of a full intra request entry.
+		/// \details Source and command sequence number.
+		constexpr int INTRA_REQUEST_SIZE { 8 };
+
+		/// Size of the fixed part of a feedback packet.
+		/// \details Common header and sources of the sender and the media.
+		constexpr int FEEDBACK_HEADER_SIZE { 12 };
+
+		/// Number of packets kept for retransmission per track.
+		/// \details A power of two that divides the sequence space, so
+		/// packets keep their slots across wrap around.
+		constexpr int HISTORY_SIZE { 4096 };
+
+		/// Interleaved frame header size.
+		/// \details Magic byte, channel and 16-bit length.
+		constexpr int INTERLEAVED_HEADER_SIZE { 4 };
+
+		/// Largest amount of unsent interleaved data per connection.
+		/// \details Packets are dropped beyond it rather than buffered.
+		constexpr qint64 WRITE_LIMIT { 4 * 1024 * 1024 };
+
+		/// Largest incomplete request size.
+		/// \details Connections that exceed it are closed.
+		constexpr int REQUEST_LIMIT { 64 * 1024 };
+
+		/// UDP socket send buffer size.
+		/// \details Absorbs frame bursts of many sessions.
+		constexpr int SEND_BUFFER_SIZE { 4 * 1024 * 1024 };
+
+		/// Number of attempts to bind an even and odd UDP port pair.
+		/// \details Ports are taken from the ephemeral range.
+		constexpr int BIND_ATTEMPTS { 16 };
+
+		/// Offset of the NTP epoch from the Unix epoch in seconds.
+		/// \details Defined by RFC 868.
+		constexpr quint64 NTP_OFFSET { 2208988800ULL };
+
+		/// Canonical name of the server in source descriptions.
+		/// \details The same for all streams.
+		constexpr char CNAME[] { "rtsptestserver" };
+
+		/// Methods announced by OPTIONS response.
+		/// \details Matches methods answered by the worker.
+		constexpr char PUBLIC[] {
+			"OPTIONS, DESCRIBE, SETUP, PLAY, PAUSE, TEARDOWN, "
+			"GET_PARAMETER, SET_PARAMETER"
+		};
+
+		/// Returns header value of an RTSP request.
+		/// \param[in]	request	RTSP request.
+		/// \param[in]	name	Lower case header name with colon.
+		/// \return Header value or empty array if it is missing.
+		QByteArray headerValue(const QByteArray& request,
+							   const QByteArray& name) {
+
+			auto lower = request.toLower();
+			auto begin = lower.indexOf("\r\n" + name);
+			if (begin < 0) return { };
+
+			begin += name.size() + 2;
+			auto end = request.indexOf("\r\n", begin);
+
+			return request.mid(begin, end - begin).trimmed();
+		}
+
+		/// Returns reason phrase of a status code.
+		/// \param[in]	code	RTSP status code.
+		/// \return Reason phrase.
+		const char* reason(int code) {
+			switch (code) {
+			case 200:	return "OK";
+			case 400:	return "Bad Request";
+			case 404:	return "Not Found";
+			case 454:	return "Session Not Found";
+			case 455:	return "Method Not Valid in This State";
+			case 461:	return "Unsupported Transport";
+			default:	return "Not Implemented";
+			}
+		}
+
+		/// Returns track number of a request URI.
+		/// \param[in]	uri	Request URI.
+		/// \return Track number from one or zero for the presentation.
+		int trackNumber(const QByteArray& uri) {
+			auto segment = uri.mid(uri.lastIndexOf('/') + 1);
+			if (!segment.startsWith("track")) return 0;
+
+			auto ok = false;
+			auto number = segment.mid(5).toInt(&ok);
+
+			return ok && number > 0 ? number : 0;
+		}
+
+		/// Returns presentation URI of a request URI.
+		/// \param[in]	uri	Request URI.
+		/// \return URI without the track and trailing slashes.
+		QByteArray presentation(const QByteArray& uri) {
+			auto base = trackNumber(uri) > 0
+						? uri.left(uri.lastIndexOf('/'))
+						: uri;
+
+			while (base.endsWith('/')) base.chop(1);
+
+			return base;
+		}
+
+		/// Returns stream settings of a request URI.
+		/// \param[in]	defaults	Default stream settings.
+		/// \param[in]	uri			Request URI.
+		/// \param[out]	settings	Stream settings.
+		/// \retval true on success.
+		/// \retval false if the query is invalid.
+		bool streamSettings(const StreamSettings& defaults,
+							const QByteArray& uri,
+							StreamSettings& settings) {
+
+			auto base = presentation(uri);
+			auto mark = base.indexOf('?');
+
+			settings = defaults;
+
+			return mark < 0 || settings.apply(base.mid(mark + 1));
+		}
+
+		/// Returns codecs of stream tracks.
+		/// \param[in]	settings	Stream settings.
+		/// \return Codec of every track.
+		QVector<MediaSource::Codec> trackCodecs(
+			const StreamSettings& settings) {
+
+			QVector<MediaSource::Codec> codecs;
+
+			if (settings.videoBitrate_ > 0)
+				codecs.append(MediaSource::Codec::H264);
+
+			if (settings.audio_ == "aac")
+				codecs.append(MediaSource::Codec::AAC);
+			else if (settings.audio_ == "pcmu")
+				codecs.append(MediaSource::Codec::PCMU);
+			else if (settings.audio_ == "pcma")
+				codecs.append(MediaSource::Codec::PCMA);
+
+			return codecs;
+		}
+
+		/// Parses a port or channel pair of a transport parameter.
+		/// \param[in]	transport	Transport header value.
+		/// \param[in]	name		Parameter name with equal sign.
+		/// \param[out]	pair		Parsed pair.
+		/// \retval true on success.
+		/// \retval false if the parameter is missing or invalid.
+		bool transportPair(const QByteArray& transport,
+						   const QByteArray& name,
+						   QPair<quint16, quint16>& pair) {
+
+			auto begin = transport.toLower().indexOf(name);
+			if (begin < 0) return false;
+
+			begin += name.size();
+			auto end = transport.indexOf(';', begin);
+			auto values = transport.mid(begin, end < 0 ? -1 : end - begin)
+						  .split('-');
+
+			auto ok = false;
+			pair.first = values[0].toUShort(&ok);
+			if (!ok) return false;
+
+			pair.second = values.size() > 1
+						  ? values[1].toUShort(&ok)
+						  : static_cast<quint16>(pair.first + 1);
+
+			return ok;
+		}
+
+		/// Stores a 16-bit value in network byte order.
+		/// \param[out]	data	Destination.
+		/// \param[in]	value	Value.
+		void putShort(char* data, quint16 value) {
+			data[0] = static_cast<char>(value >> 8);
+			data[1] = static_cast<char>(value);
+		}
+
+		/// Loads a 16-bit value in network byte order.
+		/// \param[in]	data	Source.
+		/// \return Value.
+		quint16 getShort(const char* data) {
+			return static_cast<quint16>(static_cast<quint8>(data[0]) << 8 |
+										static_cast<quint8>(data[1]));
+		}
+
+		/// Loads a 32-bit value in network byte order.
+		/// \param[in]	data	Source.
+		/// \return Value.
+		quint32 getWord(const char* data) {
+			return static_cast<quint32>(getShort(data)) << 16 |
+				   getShort(data + 2);
+		}
+
+		/// Stores a 32-bit value in network byte order.
+		/// \param[out]	data	Destination.
+		/// \param[in]	value	Value.
+		void putWord(char* data, quint32 value) {
+			data[0] = static_cast<char>(value >> 24);
+			data[1] = static_cast<char>(value >> 16);
+			data[2] = static_cast<char>(value >> 8);
+			data[3] = static_cast<char>(value);
+		}
+
+		/// Binds an RTP and RTCP socket pair.
+		/// \param[in]	rtp		RTP socket.
+		/// \param[in]	rtcp	RTCP socket.
+		/// \param[in]	address	Local address.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool bindPair(QUdpSocket& rtp,
+					  QUdpSocket& rtcp,
+					  const QHostAddress& address) {
+
+			for (auto attempt = 0; attempt < BIND_ATTEMPTS; ++attempt) {
+				if (!rtp.bind(address, 0)) return false;
+
+				auto port = rtp.localPort();
+
+				if (port % 2 == 0 &&
+					port < 65535 &&
+					rtcp.bind(address, static_cast<quint16>(port + 1)))
+					return true;
+
+				rtp.close();
+			}
+
+			return rtp.bind(address, 0) && rtcp.bind(address, 0);
+		}
+	}
+
+	/// Structure that describes a media track.
+	/// \details Keeps the RTP timeline. Frames are sent at the time of
+	/// their timestamp relative to the start of playback.
+	struct Worker::Track final {
+
+		/// Constructor.
+		/// \param[in]	session		Session of the track.
+		/// \param[in]	codec		Codec.
+		/// \param[in]	settings	Stream settings.
+		explicit Track(Session& session,
+					   MediaSource::Codec codec,
+					   const StreamSettings& settings)
+			: session_(session),
+			  source_(codec, settings) { }
+
+		/// Session of the track.
+		Session& session_;
+
+		/// Media source.
+		MediaSource source_;
+
+		/// Track number.
+		int number_ { 0 };
+
+		/// Whether packets are interleaved on the connection.
+		bool interleaved_ { false };
+
+		/// Client RTP and RTCP ports or interleaved channels.
+		QPair<quint16, quint16> ports_ { 0, 0 };
+
+		/// Synchronization source identifier.
+		quint32 ssrc_ { 0 };
+
+		/// Next sequence number.
+		quint16 sequence_ { 0 };
+
+		/// Timestamp of the first frame.
+		quint32 timestamp_ { 0 };
+
+		/// Index of the next frame.
+		quint64 frame_ { 0 };
+
+		/// Time of the first frame in microseconds of the worker clock.
+		qint64 start_ { 0 };
+
+		/// Time of the next frame in microseconds of the worker clock.
+		qint64 next_ { 0 };
+
+		/// Time of the next sender report in microseconds of the worker
+		/// clock.
+		qint64 nextReport_ { 0 };
+
+		/// Number of packets sent, including dropped ones.
+		quint32 packets_ { 0 };
+
+		/// Number of payload bytes sent, including dropped packets.
+		quint32 octets_ { 0 };
+
+		/// Packet held back to be sent after its successor.
+		QByteArray held_;
+
+		/// Structure that describes a packet kept for retransmission.
+		struct Sent final {
+
+			/// Time the packet was sent in microseconds of the worker
+			/// clock.
+			qint64 time_ { 0 };
+
+			/// Packet data.
+			QByteArray packet_;
+		};
+
+		/// Packets kept for retransmission, indexed by sequence number.
+		/// \details Empty if retransmission is disabled.
+		std::vector<Sent> history_;
+
+		/// Synchronization source identifier of retransmissions.
+		quint32 rtxSsrc_ { 0 };
+
+		/// Next sequence number of retransmissions.
+		quint16 rtxSequence_ { 0 };
+
+		/// Command sequence number of the last full intra request, -1 if
+		/// none arrived.
+		int intraSequence_ { -1 };
+	};
+
+	/// Structure that describes a session.
+	/// \details Settings are taken from the URI of the first SETUP.
+	struct Worker::Session final {
+
+		/// Session identifier.
+		QByteArray id_;
+
+		/// Stream settings.
+		StreamSettings settings_;
+
+		/// RTSP connection, nullptr once it is closed.
+		QTcpSocket* connection_ { nullptr };
+
+		/// Client address.
+		QHostAddress address_;
+
+		/// Tracks set up.
+		std::vector<std::unique_ptr<Track>> tracks_;
+
+		/// Whether the session is playing.
+		bool playing_ { false };
+
+		/// Time of the last request in milliseconds of the worker clock.
+		qint64 activity_ { 0 };
+	};
+
+	/// Structure that provides private storage.
+	/// \details Maintains private data.
+	struct Worker::WorkerPrivate final {
+
+		/// Constructor.
+		/// \param[in]	settings	Default stream settings.
+		/// \param[in]	address		Address of UDP sockets.
+		/// \param[in]	timeout		Session timeout in seconds.
+		WorkerPrivate(const StreamSettings& settings,
+					  const QHostAddress& address,
+					  int timeout)
+			: settings_(settings),
+			  address_(address),
+			  timeout_(timeout) { }
+
+		/// Returns whether a random event with a probability happens.
+		/// \param[in]	percent	Probability in percent.
+		/// \retval true if the event happens.
+		/// \retval false otherwise.
+		bool chance(double percent) {
+			return percent > 0 &&
+				   static_cast<double>(random_() % 1000000) <
+				   percent * 10000;
+		}
+
+		/// Default stream settings.
+		const StreamSettings settings_;
+
+		/// Address of UDP sockets.
+		const QHostAddress address_;
+
+		/// Session timeout in seconds.
+		const int timeout_;
+
+		/// RTP socket.
+		QUdpSocket* rtp_ { nullptr };
+
+		/// RTCP socket.
+		QUdpSocket* rtcp_ { nullptr };
+
+		/// Pacing timer.
+		QTimer* tick_ { nullptr };
+
+		/// Worker clock.
+		QElapsedTimer clock_;
+
+		/// Input buffers of connections.
+		QHash<QTcpSocket*, QByteArray> connections_;
+
+		/// Sessions by identifier.
+		QHash<QByteArray, QSharedPointer<Session>> sessions_;
+
+		/// Playing sessions.
+		QVector<Session*> playing_;
+
+		/// Tracks by synchronization source identifier.
+		/// \details Finds the track of a negative acknowledgement.
+		QHash<quint32, Track*> sources_;
+
+		/// Packet buffer.
+		QByteArray packet_;
+
+		/// Random number generator.
+		std::mt19937_64 random_ { std::random_device()() };
+
+		/// Number of open connections.
+		std::atomic<quint64> connectionCount_ { 0 };
+
+		/// Number of sessions.
+		std::atomic<quint64> sessionCount_ { 0 };
+
+		/// Number of playing sessions.
+		std::atomic<quint64> playingCount_ { 0 };
+
+		/// Number of sent RTP packets.
+		std::atomic<quint64> packetCount_ { 0 };
+
+		/// Number of sent RTP bytes.
+		std::atomic<quint64> byteCount_ { 0 };
+
+		/// Number of packets dropped on purpose.
+		std::atomic<quint64> lostCount_ { 0 };
+
+		/// Number of packets dropped because clients did not keep up.
+		std::atomic<quint64> droppedCount_ { 0 };
+
+		/// Number of retransmitted packets.
+		std::atomic<quint64> retransmittedCount_ { 0 };
+
+		/// Number of requested key frames.
+		std::atomic<quint64> keyFrameCount_ { 0 };
+	};
+
+	/// Constructor.
+	/// \details Sockets and timers are created by start() on the worker
+	/// thread.
+	/// \param[in]	settings	Default stream settings.
+	/// \param[in]	address		Address of UDP sockets.
+	/// \param[in]	timeout		Session timeout in seconds.
+	/// \param[in]	parent		Parent object.
+	Worker::Worker(const StreamSettings& settings,
+				   const QHostAddress& address,
+				   int timeout,
+				   QObject* parent)
+		: QObject(parent),
+		  private_(new WorkerPrivate(settings, address, timeout)) {
+
+	}
+
+	/// Destructor.
+	/// \details Connections and sockets are children of the worker.
+	Worker::~Worker() = default;
+
+	/// Takes over an accepted connection.
+	/// \details Must be called on the worker thread.
+	/// \param[in]	descriptor	Socket descriptor.
+	void Worker::accept(qintptr descriptor) {
+		auto socket = new QTcpSocket(this);
+
+		if (!socket->setSocketDescriptor(descriptor)) {
+			delete socket;
+			return;
+		}
+
+		socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+
+		connect(
+			socket,
+			SIGNAL(readyRead()),
+			SLOT(onReadyRead())
+		);
+
+		connect(
+			socket,
+			SIGNAL(disconnected()),
+			SLOT(onDisconnected())
+		);
+
+		private_->connections_.insert(socket, { });
+		++private_->connectionCount_;
+	}
+
+	/// Returns worker statistics.
+	/// \details Safe to call from any thread.
+	/// \return Worker statistics.
+	WorkerStatistics Worker::getStatistics() const {
+		auto& p = *private_;
+
+		WorkerStatistics statistics;
+		statistics.connections_		= p.connectionCount_;
+		statistics.sessions_		= p.sessionCount_;
+		statistics.playing_			= p.playingCount_;
+		statistics.packets_			= p.packetCount_;
+		statistics.bytes_			= p.byteCount_;
+		statistics.lost_			= p.lostCount_;
+		statistics.dropped_			= p.droppedCount_;
+		statistics.retransmitted_	= p.retransmittedCount_;
+		statistics.keyFrames_		= p.keyFrameCount_;
+
+		return statistics;
+	}
+
+	/// Creates sockets and timers on the worker thread.
+	/// \details Called when the worker thread starts.
+	void Worker::start() {
+		auto& p = *private_;
+
+		p.clock_.start();
+
+		p.rtp_ = new QUdpSocket(this);
+		p.rtcp_ = new QUdpSocket(this);
+
+		if (bindPair(*p.rtp_, *p.rtcp_, p.address_))
+			p.rtp_->setSocketOption(
+				QAbstractSocket::SendBufferSizeSocketOption,
+				SEND_BUFFER_SIZE);
+
+		connect(
+			p.rtp_,
+			SIGNAL(readyRead()),
+			SLOT(onDatagram())
+		);
+
+		connect(
+			p.rtcp_,
+			SIGNAL(readyRead()),
+			SLOT(onDatagram())
+		);
+
+		p.tick_ = new QTimer(this);
+		p.tick_->setTimerType(Qt::PreciseTimer);
+		p.tick_->setInterval(TICK_INTERVAL);
+
+		connect(
+			p.tick_,
+			SIGNAL(timeout()),
+			SLOT(onTick())
+		);
+
+		auto expire = new QTimer(this);
+		expire->start(EXPIRE_INTERVAL);
+
+		connect(
+			expire,
+			SIGNAL(timeout()),
+			SLOT(onExpire())
+		);
+	}
+
+	/// Performs an action when a connection has data.
+	/// \details Answers complete requests.
+	void Worker::onReadyRead() {
+		auto socket = qobject_cast<QTcpSocket*>(sender());
+		if (socket) process(socket);
+	}
+
+	/// Performs an action when a connection is closed.
+	/// \details Interleaved sessions end with their connection, UDP
+	/// sessions keep streaming until they time out.
+	void Worker::onDisconnected() {
+		auto& p = *private_;
+		auto socket = qobject_cast<QTcpSocket*>(sender());
+
+		if (!socket || !p.connections_.remove(socket)) return;
+
+		QVector<QByteArray> closed;
+
+		for (const auto& session : p.sessions_) {
+			if (session->connection_ != socket) continue;
+
+			session->connection_ = nullptr;
+
+			for (const auto& track : session->tracks_)
+				if (track->interleaved_) {
+					closed.append(session->id_);
+					break;
+				}
+		}
+
+		for (const auto& id : closed) remove(id);
+
+		--p.connectionCount_;
+		socket->deleteLater();
+	}
+
+	/// Performs an action when a UDP socket has data.
+	/// \details Negative acknowledgements are answered, receiver reports
+	/// and hole punching packets are discarded.
+	void Worker::onDatagram() {
+		auto socket = qobject_cast<QUdpSocket*>(sender());
+		if (!socket) return;
+
+		char buffer[2048];
+
+		while (socket->hasPendingDatagrams()) {
+			auto size = socket->readDatagram(buffer, sizeof(buffer));
+
+			if (socket == private_->rtcp_ && size > 0)
+				feedback(buffer, static_cast<int>(size));
+		}
+	}
+
+	/// Sends frames that are due.
+	/// \details Visits playing sessions only, sessions that are set up or
+	/// paused cost nothing.
+	void Worker::onTick() {
+		auto& p = *private_;
+		auto now = p.clock_.nsecsElapsed() / 1000;
+
+		for (auto session : p.playing_)
+			for (const auto& track : session->tracks_)
+				send(*track, now);
+	}
+
+	/// Removes sessions that timed out.
+	/// \details A session times out when its connection is closed and no
+	/// request refreshed it for the session timeout.
+	void Worker::onExpire() {
+		auto& p = *private_;
+		auto deadline = p.clock_.elapsed() - p.timeout_ * 1000LL;
+
+		QVector<QByteArray> expired;
+
+		for (const auto& session : p.sessions_)
+			if (!session->connection_ && session->activity_ < deadline)
+				expired.append(session->id_);
+
+		for (const auto& id : expired) remove(id);
+	}
+
+	/// Answers complete requests of a connection.
+	/// \details Interleaved frames sent by the client are skipped.
+	/// \param[in]	socket	Connection.
+	void Worker::process(QTcpSocket* socket) {
+		auto it = private_->connections_.find(socket);
+		if (it == private_->connections_.end()) return;
+
+		auto& input = it.value();
+		input += socket->readAll();
+
+		for (;;) {
+			if (input.startsWith('$')) {
+				if (input.size() < INTERLEAVED_HEADER_SIZE) break;
+
+				auto size = INTERLEAVED_HEADER_SIZE +
+							(static_cast<quint8>(input[2]) << 8 |
+							 static_cast<quint8>(input[3]));
+
+				if (input.size() < size) break;
+
+				input.remove(0, size);
+				continue;
+			}
+
+			auto end = input.indexOf("\r\n\r\n");
+
+			if (end < 0) {
+				if (input.size() > REQUEST_LIMIT) socket->abort();
+				break;
+			}
+
+			auto request = input.left(end + 2);
+			auto total = end + 4 +
+						 headerValue(request, "content-length:").toInt();
+
+			if (input.size() < total) break;
+
+			input.remove(0, total);
+			socket->write(respond(socket, request));
+		}
+	}
+
+	/// Builds the response to a request.
+	/// \details Requests that name a session refresh it.
+	/// \param[in]	socket	Connection.
+	/// \param[in]	request	Request headers.
+	/// \return Response.
+	QByteArray Worker::respond(QTcpSocket* socket, const QByteArray& request) {
+		auto& p = *private_;
+
+		auto line = request.left(request.indexOf("\r\n")).split(' ');
+		auto method = line.value(0);
+		auto uri = line.value(1);
+		auto id = headerValue(request, "session:");
+		id = id.left(id.indexOf(';'));
+
+		QSharedPointer<Session> session;
+
+		if (!id.isEmpty()) {
+			session = p.sessions_.value(id);
+			if (session) {
+				session->activity_ = p.clock_.elapsed();
+				session->connection_ = socket;
+			}
+		}
+
+		auto code = 200;
+		QByteArray headers, body;
+
+		if (method == "OPTIONS")
+			headers = QByteArray("Public: ") + PUBLIC + "\r\n";
+		else if (method == "DESCRIBE") {
+			StreamSettings settings;
+
+			if (!streamSettings(p.settings_, uri, settings)) code = 400;
+			else {
+				auto base = presentation(uri);
+				auto codecs = trackCodecs(settings);
+
+				body = "v=0\r\n"
+					   "o=- 0 0 IN IP4 " +
+					   socket->localAddress().toString().toUtf8() + "\r\n"
+					   "s=RTSPLib test stream\r\n"
+					   "t=0 0\r\n"
+					   "a=control:*\r\n"
+					   "a=range:npt=0-\r\n";
+
+				for (auto i = 0; i < codecs.size(); ++i)
+					body += MediaSource(codecs[i], settings).getDescription(
+						"track" + QByteArray::number(i + 1));
+
+				headers = "Content-Base: " + base + "/\r\n"
+						  "Content-Type: application/sdp\r\n";
+			}
+		}
+		else if (method == "SETUP")
+			code = setup(socket,
+						 uri,
+						 headerValue(request, "transport:"),
+						 id,
+						 headers);
+		else if (method == "PLAY"			||
+				 method == "PAUSE"			||
+				 method == "TEARDOWN"		||
+				 method == "GET_PARAMETER"	||
+				 method == "SET_PARAMETER") {
+
+			if (!session) code = 454;
+			else if (method == "PLAY") {
+				if (session->tracks_.empty()) code = 455;
+				else {
+					play(*session);
+
+					auto base = presentation(uri);
+					QByteArray info;
+
+					for (const auto& track : session->tracks_) {
+						if (!info.isEmpty()) info += ',';
+
+						info += "url=" + base + "/track" +
+								QByteArray::number(track->number_) +
+								";seq=" +
+								QByteArray::number(track->sequence_) +
+								";rtptime=" +
+								QByteArray::number(
+									track->timestamp_ +
+									track->source_.getFrameTimestamp(
+										track->frame_));
+					}
+
+					headers = "Range: npt=0.000-\r\n"
+							  "RTP-Info: " + info + "\r\n";
+				}
+			}
+			else if (method == "PAUSE") pause(*session);
+			else if (method == "TEARDOWN") {
+				remove(id);
+				id.clear();
+			}
+		}
+		else code = 501;
+
+		if (code == 200 && !id.isEmpty())
+			headers += "Session: " + id + ";timeout=" +
+					   QByteArray::number(p.timeout_) + "\r\n";
+
+		return "RTSP/1.0 " + QByteArray::number(code) + ' ' +
+			   reason(code) + "\r\n"
+			   "CSeq: " + headerValue(request, "cseq:") + "\r\n"
+			   "Server: RTSPLib test server\r\n" +
+			   headers +
+			   "Content-Length: " + QByteArray::number(body.size()) +
+			   "\r\n\r\n" +
+			   body;
+	}
+
+	/// Sets up a track.
+	/// \details Creates the session on the first SETUP. A track that is
+	/// set up again gets the new transport.
+	/// \param[in]	socket		Connection.
+	/// \param[in]	uri			Request URI.
+	/// \param[in]	transport	Transport header value.
+	/// \param[in]	id			Session identifier, may be empty.
+	/// \param[out]	headers		Response headers.
+	/// \return RTSP status code.
+	int Worker::setup(QTcpSocket* socket,
+					  const QByteArray& uri,
+					  const QByteArray& transport,
+					  QByteArray& id,
+					  QByteArray& headers) {
+
+		auto& p = *private_;
+
+		QSharedPointer<Session> session;
+
+		if (!id.isEmpty()) {
+			session = p.sessions_.value(id);
+			if (!session) return 454;
+		}
+
+		StreamSettings settings;
+
+		if (session) settings = session->settings_;
+		else if (!streamSettings(p.settings_, uri, settings)) return 400;
+
+		auto codecs = trackCodecs(settings);
+		auto number = trackNumber(uri);
+
+		if (number < 1 || number > codecs.size()) return 404;
+
+		QPair<quint16, quint16> ports;
+		auto interleaved = transport.toUpper().contains("RTP/AVP/TCP");
+
+		if (!transportPair(transport,
+						   interleaved ? "interleaved=" : "client_port=",
+						   ports))
+			return 461;
+
+		if (!session) {
+			session.reset(new Session);
+			session->id_ = QByteArray::number(p.random_(), 16);
+			session->settings_ = settings;
+			session->address_ = socket->peerAddress();
+			session->activity_ = p.clock_.elapsed();
+			session->connection_ = socket;
+
+			p.sessions_.insert(session->id_, session);
+			++p.sessionCount_;
+
+			id = session->id_;
+		}
+
+		auto& tracks = session->tracks_;
+
+		for (const auto& track : tracks)
+			if (track->number_ == number) p.sources_.remove(track->ssrc_);
+
+		tracks.erase(
+			std::remove_if(tracks.begin(), tracks.end(),
+						   [number](const std::unique_ptr<Track>& track) {
+							   return track->number_ == number;
+						   }),
+			tracks.end());
+
+		std::unique_ptr<Track> track(
+			new Track(*session, codecs[number - 1], settings));
+
+		track->number_ = number;
+		track->interleaved_ = interleaved;
+		track->ports_ = ports;
+		track->ssrc_ = static_cast<quint32>(p.random_());
+		track->sequence_ = static_cast<quint16>(p.random_());
+		track->timestamp_ = static_cast<quint32>(p.random_());
+
+		if (!interleaved && track->source_.getRetransmissionType() >= 0) {
+			track->history_.resize(HISTORY_SIZE);
+			track->rtxSsrc_ = static_cast<quint32>(p.random_());
+			track->rtxSequence_ = static_cast<quint16>(p.random_());
+		}
+
+		auto ssrc = QByteArray::number(track->ssrc_, 16)
+					.rightJustified(8, '0').toUpper();
+
+		if (interleaved)
+			headers = "Transport: RTP/AVP/TCP;unicast;interleaved=" +
+					  QByteArray::number(ports.first) + '-' +
+					  QByteArray::number(ports.second) +
+					  ";ssrc=" + ssrc + "\r\n";
+		else
+			headers = "Transport: RTP/AVP;unicast;client_port=" +
+					  QByteArray::number(ports.first) + '-' +
+					  QByteArray::number(ports.second) +
+					  ";server_port=" +
+					  QByteArray::number(p.rtp_->localPort()) + '-' +
+					  QByteArray::number(p.rtcp_->localPort()) +
+					  ";ssrc=" + ssrc + "\r\n";
+
+		if (session->playing_) {
+			auto now = p.clock_.nsecsElapsed() / 1000;
+			track->start_ = now;
+			track->next_ = now;
+			track->nextReport_ = now;
+		}
+
+		p.sources_.insert(track->ssrc_, track.get());
+		tracks.push_back(std::move(track));
+
+		return 200;
+	}
+
+	/// Starts sending a session.
+	/// \details Tracks continue their timelines where they were paused.
+	/// \param[in]	session	Session.
+	void Worker::play(Session& session) {
+		auto& p = *private_;
+		auto now = p.clock_.nsecsElapsed() / 1000;
+
+		for (const auto& track : session.tracks_) {
+			track->start_ = now - track->source_.getFrameTime(track->frame_);
+			track->next_ = now;
+			track->nextReport_ = now;
+		}
+
+		if (session.playing_) return;
+
+		session.playing_ = true;
+		p.playing_.append(&session);
+		++p.playingCount_;
+
+		if (!p.tick_->isActive()) p.tick_->start();
+	}
+
+	/// Stops sending a session.
+	/// \details The pacing timer stops with the last playing session.
+	/// \param[in]	session	Session.
+	void Worker::pause(Session& session) {
+		auto& p = *private_;
+
+		if (!session.playing_) return;
+
+		session.playing_ = false;
+		p.playing_.removeOne(&session);
+		--p.playingCount_;
+
+		if (p.playing_.isEmpty()) p.tick_->stop();
+	}
+
+	/// Removes a session.
+	/// \details Does nothing for unknown sessions.
+	/// \param[in]	id	Session identifier.
+	void Worker::remove(const QByteArray& id) {
+		auto& p = *private_;
+		auto session = p.sessions_.take(id);
+
+		if (!session) return;
+
+		for (const auto& track : session->tracks_)
+			p.sources_.remove(track->ssrc_);
+
+		pause(*session);
+		--p.sessionCount_;
+	}
+
+	/// Sends frames of a track that are due.
+	/// \details Sends a sender report once a second after the frames.
+	/// \param[in]	track	Track.
+	/// \param[in]	now		Current time in microseconds.
+	void Worker::send(Track& track, qint64 now) {
+		if (now - track.next_ > MAX_LAG) {
+			track.start_ += now - track.next_;
+			track.next_ = now;
+		}
+
+		while (track.next_ <= now) {
+			track.source_.produce(
+				track.frame_,
+				[this, &track](const char* payload, int size, bool marker) {
+					packet(track, payload, size, marker);
+				});
+
+			++track.frame_;
+			track.next_ = track.start_ +
+						  track.source_.getFrameTime(track.frame_);
+		}
+
+		if (now >= track.nextReport_) {
+			report(track, now);
+			track.nextReport_ = now + REPORT_INTERVAL;
+		}
+	}
+
+	/// Sends an RTP packet.
+	/// \details Applies simulated loss and reordering. A reordered packet
+	/// is held back and sent right after the next one.
+	/// \param[in]	track	Track.
+	/// \param[in]	payload	Payload data.
+	/// \param[in]	size	Payload size.
+	/// \param[in]	marker	Marker bit.
+	void Worker::packet(Track& track,
+						const char* payload,
+						int size,
+						bool marker) {
+
+		auto& p = *private_;
+		auto& settings = track.session_.settings_;
+		auto& packet = p.packet_;
+
+		packet.resize(RTP_HEADER_SIZE + size);
+
+		auto data = packet.data();
+		data[0] = '\x80';
+		data[1] = static_cast<char>((marker ? 0x80 : 0) |
+									track.source_.getPayloadType());
+
+		putShort(data + 2, track.sequence_++);
+		putWord(data + 4,
+				track.timestamp_ +
+				track.source_.getFrameTimestamp(track.frame_));
+		putWord(data + 8, track.ssrc_);
+
+		std::memcpy(data + RTP_HEADER_SIZE, payload,
+					static_cast<size_t>(size));
+
+		++track.packets_;
+		track.octets_ += static_cast<quint32>(size);
+
+		if (!track.history_.empty()) {
+			auto& sent = track.history_[
+				static_cast<quint16>(track.sequence_ - 1) % HISTORY_SIZE];
+
+			sent.time_ = p.clock_.nsecsElapsed() / 1000;
+			sent.packet_ = packet;
+		}
+
+		if (p.chance(settings.loss_)) {
+			++p.lostCount_;
+			return;
+		}
+
+		if (track.held_.isEmpty() && p.chance(settings.reorder_)) {
+			track.held_ = packet;
+			return;
+		}
+
+		transmit(track, packet, false);
+
+		if (!track.held_.isEmpty()) {
+			transmit(track, track.held_, false);
+			track.held_.clear();
+		}
+	}
+
+	/// Sends a sender report.
+	/// \details Sends a compound packet of a sender report and a source
+	/// description with the canonical name. The RTP timestamp matches the
+	/// wall clock time of the report, as RFC 3550 requires.
+	/// \param[in]	track	Track.
+	/// \param[in]	now		Current time in microseconds.
+	void Worker::report(Track& track, qint64 now) {
+		auto& packet = private_->packet_;
+
+		auto wall = std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::system_clock::now().time_since_epoch()).count();
+
+		auto seconds = static_cast<quint64>(wall / 1000000) + NTP_OFFSET;
+		auto fraction = (static_cast<quint64>(wall % 1000000) << 32) /
+						1000000;
+
+		auto elapsed = static_cast<quint64>(qMax<qint64>(
+			now - track.start_, 0));
+
+		auto timestamp = track.timestamp_ + static_cast<quint32>(
+			elapsed * static_cast<quint64>(track.source_.getClockRate()) /
+			1000000);
+
+		auto name = static_cast<int>(sizeof(CNAME) - 1);
+		auto description = (8 + 2 + name + 1 + 3) / 4 * 4;
+
+		packet.fill(0, 28 + description);
+
+		auto data = packet.data();
+		data[0] = '\x80';
+		data[1] = '\xC8';
+		putShort(data + 2, 6);
+		putWord(data + 4, track.ssrc_);
+		putWord(data + 8, static_cast<quint32>(seconds));
+		putWord(data + 12, static_cast<quint32>(fraction));
+		putWord(data + 16, timestamp);
+		putWord(data + 20, track.packets_);
+		putWord(data + 24, track.octets_);
+
+		data += 28;
+		data[0] = '\x81';
+		data[1] = '\xCA';
+		putShort(data + 2, static_cast<quint16>(description / 4 - 1));
+		putWord(data + 4, track.ssrc_);
+		data[8] = 1;
+		data[9] = static_cast<char>(name);
+		std::memcpy(data + 10, CNAME, static_cast<size_t>(name));
+
+		transmit(track, packet, true);
+	}
+
+	/// Answers feedback of a client.
+	/// \details Walks the compound packet and retransmits the packets that
+	/// generic negative acknowledgements of RFC 4585 request. Each item
+	/// requests a packet and the sixteen after it by a bitmask. Picture
+	/// loss indications and full intra requests of RFC 5104 make the next
+	/// frame a key frame, a full intra request repeated with the same
+	/// sequence number is answered once.
+	/// \param[in]	data	RTCP compound packet data.
+	/// \param[in]	size	RTCP compound packet size.
+	void Worker::feedback(const char* data, int size) {
+		auto& p = *private_;
+
+		while (size >= RTCP_HEADER_SIZE) {
+			auto length = (getShort(data + 2) + 1) * 4;
+			if (length > size) return;
+
+			auto track = p.sources_.value(
+				length >= FEEDBACK_HEADER_SIZE ? getWord(data + 8) : 0);
+
+			auto type = static_cast<quint8>(data[1]);
+			auto format = data[0] & 0x1F;
+
+			if (type == RTCP_TRANSPORT_FEEDBACK && format == GENERIC_NACK &&
+				track && !track->history_.empty()) {
+
+				for (auto item = FEEDBACK_HEADER_SIZE; item + 4 <= length;
+					 item += 4) {
+
+					auto first = getShort(data + item);
+					auto mask = getShort(data + item + 2);
+
+					retransmit(*track, first);
+
+					for (auto bit = 0; bit < 16; ++bit)
+						if (mask >> bit & 1)
+							retransmit(*track,
+									   static_cast<quint16>(first + bit + 1));
+				}
+			}
+			else if (type == RTCP_PAYLOAD_FEEDBACK &&
+					 format == PICTURE_LOSS && track)
+				requestKeyFrame(*track);
+			else if (type == RTCP_PAYLOAD_FEEDBACK &&
+					 format == FULL_INTRA_REQUEST) {
+
+				for (auto item = FEEDBACK_HEADER_SIZE;
+					 item + INTRA_REQUEST_SIZE <= length;
+					 item += INTRA_REQUEST_SIZE) {
+
+					auto target = p.sources_.value(getWord(data + item));
+					auto sequence = static_cast<quint8>(data[item + 4]);
+
+					if (!target || target->intraSequence_ == sequence)
+						continue;
+
+					target->intraSequence_ = sequence;
+					requestKeyFrame(*target);
+				}
+			}
+
+			data += length;
+			size -= length;
+		}
+	}
+
+	/// Retransmits a packet.
+	/// \details Sends the kept packet in the RFC 4588 payload format: the
+	/// retransmission source numbers it in its own sequence and prepends
+	/// the original sequence number to the payload. Packets older than the
+	/// retransmission time are not sent. Simulated loss applies again.
+	/// \param[in]	track		Track.
+	/// \param[in]	sequence	Sequence number of the packet.
+	void Worker::retransmit(Track& track, quint16 sequence) {
+		auto& p = *private_;
+		auto& settings = track.session_.settings_;
+		auto& sent = track.history_[static_cast<size_t>(sequence) %
+									HISTORY_SIZE];
+		auto now = p.clock_.nsecsElapsed() / 1000;
+
+		if (sent.packet_.isEmpty() ||
+			getShort(sent.packet_.constData() + 2) != sequence ||
+			now - sent.time_ > settings.retransmission_ * 1000LL)
+			return;
+
+		auto& packet = p.packet_;
+		auto size = sent.packet_.size() - RTP_HEADER_SIZE;
+
+		packet.resize(RTP_HEADER_SIZE + 2 + size);
+
+		auto data = packet.data();
+		std::memcpy(data, sent.packet_.constData(), RTP_HEADER_SIZE);
+		data[1] = static_cast<char>((data[1] & 0x80) |
+									track.source_.getRetransmissionType());
+
+		putShort(data + 2, track.rtxSequence_++);
+		putWord(data + 8, track.rtxSsrc_);
+		putShort(data + RTP_HEADER_SIZE, sequence);
+
+		std::memcpy(data + RTP_HEADER_SIZE + 2,
+					sent.packet_.constData() + RTP_HEADER_SIZE,
+					static_cast<size_t>(size));
+
+		++p.retransmittedCount_;
+
+		if (p.chance(settings.loss_)) {
+			++p.lostCount_;
+			return;
+		}
+
+		transmit(track, packet, false);
+	}
+
+	/// Makes the next frame of a track a key frame.
+	/// \details Frames already sent are not repeated, the IDR frame
+	/// follows at the next frame time.
+	/// \param[in]	track	Track.
+	void Worker::requestKeyFrame(Track& track) {
+		track.source_.requestKeyFrame();
+
+		++private_->keyFrameCount_;
+	}
+
+	/// Writes a packet to the transport of a track.
+	/// \details Interleaved packets are dropped while the connection has
+	/// too much unsent data, UDP packets while the send buffer is full.
+	/// \param[in]	track	Track.
+	/// \param[in]	data	Packet data.
+	/// \param[in]	control	Whether the packet is RTCP.
+	/// \retval true if the packet was written.
+	/// \retval false if the client did not keep up.
+	bool Worker::transmit(Track& track,
+						  const QByteArray& data,
+						  bool control) {
+
+		auto& p = *private_;
+		auto& session = track.session_;
+		auto written = false;
+
+		if (track.interleaved_) {
+			auto socket = session.connection_;
+
+			if (socket && socket->bytesToWrite() < WRITE_LIMIT) {
+				char header[INTERLEAVED_HEADER_SIZE];
+				header[0] = '$';
+				header[1] = static_cast<char>(
+					control ? track.ports_.second : track.ports_.first);
+				putShort(header + 2, static_cast<quint16>(data.size()));
+
+				socket->write(header, INTERLEAVED_HEADER_SIZE);
+				socket->write(data);
+				written = true;
+			}
+		}
+		else {
+			auto socket = control ? p.rtcp_ : p.rtp_;
+			auto port = control ? track.ports_.second : track.ports_.first;
+
+			written = socket->writeDatagram(data.constData(),
+											data.size(),
+											session.address_,
+											port) >= 0;
+		}
+
+		if (control) return written;
+
+		if (written) {
+			++p.packetCount_;
+			p.byteCount_ += static_cast<quint64>(data.size());
+		}
+		else ++p.droppedCount_;
+
+		return written;
+	}
+}
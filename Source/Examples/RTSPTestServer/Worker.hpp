@@ -0,0 +1,206 @@
+/// \file Worker.hpp
+/// \brief Contains classes and functions declarations that provide RTSP test
+/// server worker.
+/// \bug No known bugs.
+
+#ifndef WORKER_HPP
+#define WORKER_HPP
+
+#include "StreamSettings.hpp"
+
+#include <QHostAddress>
+#include <QObject>
+#include <QScopedPointer>
+
+class QTcpSocket;
+
+/// Contains the RTSP test server.
+namespace TestServer {
+
+	/// Structure that describes worker statistics.
+	/// \details Counters cover the whole lifetime of the worker.
+	struct WorkerStatistics final {
+
+		/// Number of open connections.
+		quint64 connections_ { 0 };
+
+		/// Number of sessions.
+		quint64 sessions_ { 0 };
+
+		/// Number of playing sessions.
+		quint64 playing_ { 0 };
+
+		/// Number of sent RTP packets.
+		quint64 packets_ { 0 };
+
+		/// Number of sent RTP bytes, headers included.
+		quint64 bytes_ { 0 };
+
+		/// Number of packets dropped on purpose.
+		quint64 lost_ { 0 };
+
+		/// Number of packets dropped because the client did not keep up.
+		quint64 dropped_ { 0 };
+
+		/// Number of packets retransmitted on request.
+		/// \details Retransmissions lost on purpose are included.
+		quint64 retransmitted_ { 0 };
+
+		/// Number of key frames requested by clients.
+		/// \details Repeated full intra requests are not counted.
+		quint64 keyFrames_ { 0 };
+	};
+
+	/// Class that provides RTSP test server worker.
+	/// \details Lives on its own thread and serves the connections handed
+	/// over by the server. Sessions are paced by a single timer, every
+	/// track sends its frames when they are due, so one worker drives
+	/// thousands of sessions. RTP goes out from one UDP socket pair shared
+	/// by all sessions of the worker, or interleaved on the RTSP connection.
+	/// Sender reports are sent every second. Negative acknowledgements of
+	/// UDP clients are answered by retransmissions if the stream keeps its
+	/// packets, key frame requests by an IDR frame.
+	class Worker final : public QObject {
+
+		Q_OBJECT
+
+	public:
+
+		/// Constructor.
+		/// \param[in]	settings	Default stream settings.
+		/// \param[in]	address		Address of UDP sockets.
+		/// \param[in]	timeout		Session timeout in seconds.
+		/// \param[in]	parent		Parent object.
+		explicit Worker(const StreamSettings& settings,
+						const QHostAddress& address,
+						int timeout,
+						QObject* parent = nullptr);
+
+		/// Destructor.
+		~Worker() override;
+
+	public:
+
+		/// Takes over an accepted connection.
+		/// \param[in]	descriptor	Socket descriptor.
+		void accept(qintptr descriptor);
+
+		/// Returns worker statistics.
+		/// \return Worker statistics.
+		WorkerStatistics getStatistics() const;
+
+	public slots:
+
+		/// Creates sockets and timers on the worker thread.
+		void start();
+
+	private slots:
+
+		/// Performs an action when a connection has data.
+		void onReadyRead();
+
+		/// Performs an action when a connection is closed.
+		void onDisconnected();
+
+		/// Performs an action when a UDP socket has data.
+		void onDatagram();
+
+		/// Sends frames that are due.
+		void onTick();
+
+		/// Removes sessions that timed out.
+		void onExpire();
+
+	private:
+
+		/// Structure that describes a media track.
+		struct Track;
+
+		/// Structure that describes a session.
+		struct Session;
+
+		/// Answers complete requests of a connection.
+		/// \param[in]	socket	Connection.
+		void process(QTcpSocket* socket);
+
+		/// Builds the response to a request.
+		/// \param[in]	socket	Connection.
+		/// \param[in]	request	Request headers.
+		/// \return Response.
+		QByteArray respond(QTcpSocket* socket, const QByteArray& request);
+
+		/// Sets up a track.
+		/// \param[in]	socket		Connection.
+		/// \param[in]	uri			Request URI.
+		/// \param[in]	transport	Transport header value.
+		/// \param[in]	id			Session identifier, may be empty.
+		/// \param[out]	headers		Response headers.
+		/// \return RTSP status code.
+		int setup(QTcpSocket* socket,
+				  const QByteArray& uri,
+				  const QByteArray& transport,
+				  QByteArray& id,
+				  QByteArray& headers);
+
+		/// Starts sending a session.
+		/// \param[in]	session	Session.
+		void play(Session& session);
+
+		/// Stops sending a session.
+		/// \param[in]	session	Session.
+		void pause(Session& session);
+
+		/// Removes a session.
+		/// \param[in]	id	Session identifier.
+		void remove(const QByteArray& id);
+
+		/// Sends frames of a track that are due.
+		/// \param[in]	track	Track.
+		/// \param[in]	now		Current time in microseconds.
+		void send(Track& track, qint64 now);
+
+		/// Sends an RTP packet.
+		/// \param[in]	track	Track.
+		/// \param[in]	payload	Payload data.
+		/// \param[in]	size	Payload size.
+		/// \param[in]	marker	Marker bit.
+		void packet(Track& track, const char* payload, int size, bool marker);
+
+		/// Sends a sender report.
+		/// \param[in]	track	Track.
+		/// \param[in]	now		Current time in microseconds.
+		void report(Track& track, qint64 now);
+
+		/// Answers feedback of a client.
+		/// \param[in]	data	RTCP compound packet data.
+		/// \param[in]	size	RTCP compound packet size.
+		void feedback(const char* data, int size);
+
+		/// Retransmits a packet.
+		/// \param[in]	track		Track.
+		/// \param[in]	sequence	Sequence number of the packet.
+		void retransmit(Track& track, quint16 sequence);
+
+		/// Makes the next frame of a track a key frame.
+		/// \param[in]	track	Track.
+		void requestKeyFrame(Track& track);
+
+		/// Writes a packet to the transport of a track.
+		/// \param[in]	track	Track.
+		/// \param[in]	data	Packet data.
+		/// \param[in]	control	Whether the packet is RTCP.
+		/// \retval true if the packet was written.
+		/// \retval false if the client did not keep up.
+		bool transmit(Track& track, const QByteArray& data, bool control);
+
+	private:
+
+		/// Opaque type for private data.
+		struct WorkerPrivate;
+
+		/// Private data.
+		const QScopedPointer<WorkerPrivate> private_;
+	};
+}
+
+#endif
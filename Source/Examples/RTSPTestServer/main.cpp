@@ -0,0 +1,199 @@
+/// \file main.cpp
+/// \brief Contains entry point to the application.
+/// \bug No known bugs.
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QTimer>
+
+#include "Server.hpp"
+
+/// Contains stream setting options.
+namespace {
+
+	/// Structure that describes a stream setting option.
+	struct SettingOption final {
+
+		/// Setting name.
+		const char* name_;
+
+		/// Option description.
+		const char* description_;
+
+		/// Value name.
+		const char* value_;
+	};
+
+	/// Stream setting options.
+	/// \details Every session may override them with URL query parameters
+	/// of the same name.
+	const SettingOption settingOptions[] {
+		{
+			"video",
+			"H.264 bitrate, zero disables video, default 2000.",
+			"kbit/s"
+		},
+		{
+			"fps",
+			"Video frame rate, default 25.",
+			"rate"
+		},
+		{
+			"gop",
+			"Frames between IDR frames, default 50.",
+			"count"
+		},
+		{
+			"audio",
+			"Audio codec: aac, pcmu, pcma or none, default aac.",
+			"codec"
+		},
+		{
+			"audio-bitrate",
+			"AAC bitrate, default 64.",
+			"kbit/s"
+		},
+		{
+			"packet-size",
+			"Largest video RTP payload, default 1400.",
+			"bytes"
+		},
+		{
+			"packet-rate",
+			"Video packets per second, overrides packet size.",
+			"rate"
+		},
+		{
+			"loss",
+			"Share of dropped packets, default 0.",
+			"percent"
+		},
+		{
+			"reorder",
+			"Share of packets sent after their successor, default 0.",
+			"percent"
+		},
+		{
+			"rtx",
+			"Time video packets are kept for retransmission, default 0.",
+			"ms"
+		},
+	};
+}
+
+/// Runs the main application thread.
+/// \details Serves synthetic RTSP streams until interrupted and prints
+/// aggregate statistics periodically.
+/// \param[in]	argc	Number of arguments passed to the program.
+/// \param[in]	argv	Array of pointers that contain arguments passed
+///						to the program.
+/// \return Exit status.
+int main(int argc, char *argv[]) {
+	QCoreApplication a(argc, argv);
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription(
+		"Serves synthetic H.264, AAC and G.711 streams over RTSP for tests "
+		"and benchmarks. Stream settings may be overridden per session with "
+		"URL query parameters, for example "
+		"rtsp://127.0.0.1:8554/stream?video=4000&audio=pcmu&loss=1.");
+	parser.addHelpOption();
+
+	QCommandLineOption addressOption(
+		"address", "Listen address.", "address", "127.0.0.1");
+	QCommandLineOption portOption(
+		"port", "Listen port.", "port", "8554");
+	QCommandLineOption threadsOption(
+		"threads", "Number of worker threads, default the number of cores.",
+		"count", "0");
+	QCommandLineOption timeoutOption(
+		"timeout", "Session timeout.", "seconds", "60");
+	QCommandLineOption reportOption(
+		"report", "Statistics interval, zero disables statistics.",
+		"seconds", "5");
+
+	parser.addOption(addressOption);
+	parser.addOption(portOption);
+	parser.addOption(threadsOption);
+	parser.addOption(timeoutOption);
+	parser.addOption(reportOption);
+
+	for (const auto& option : settingOptions)
+		parser.addOption({ option.name_, option.description_, option.value_ });
+
+	parser.process(a);
+
+	TestServer::StreamSettings settings;
+
+	for (const auto& option : settingOptions) {
+		if (parser.isSet(option.name_) &&
+			!settings.set(option.name_, parser.value(option.name_))) {
+			QTextStream(stderr) << "Invalid " << option.name_ << "\n";
+			return 1;
+		}
+	}
+
+	QHostAddress address(parser.value(addressOption));
+	auto port = parser.value(portOption).toInt();
+	auto threads = parser.value(threadsOption).toInt();
+	auto timeout = parser.value(timeoutOption).toInt();
+	auto report = parser.value(reportOption).toInt();
+
+	if (address.isNull() || port <= 0 || port > 0xFFFF || threads < 0 ||
+		timeout <= 0 || report < 0)
+		parser.showHelp(1);
+
+	TestServer::Server server(settings, threads, timeout);
+
+	if (!server.start(address, static_cast<quint16>(port))) {
+		QTextStream(stderr) << "Server failed to listen: "
+							<< server.errorString() << "\n";
+		return 1;
+	}
+
+	QTextStream output(stdout);
+	output << "Serving rtsp://" << address.toString() << ":" << port
+		   << "/stream on " << server.getWorkerCount() << " threads\n";
+	output.flush();
+
+	QTimer timer;
+	QElapsedTimer clock;
+	TestServer::WorkerStatistics last;
+
+	QObject::connect(&timer, &QTimer::timeout, [&]() {
+		auto statistics = server.getStatistics();
+		auto seconds = clock.restart() / 1000.0;
+
+		if (seconds <= 0) return;
+
+		output << "connections " << statistics.connections_
+			   << "\tsessions " << statistics.sessions_
+			   << "\tplaying " << statistics.playing_
+			   << "\tpackets/s "
+			   << qRound64((statistics.packets_ - last.packets_) / seconds)
+			   << "\tMbit/s "
+			   << (statistics.bytes_ - last.bytes_) * 8 / seconds / 1e6
+			   << "\tlost/s "
+			   << qRound64((statistics.lost_ - last.lost_) / seconds)
+			   << "\tdropped/s "
+			   << qRound64((statistics.dropped_ - last.dropped_) / seconds)
+			   << "\trtx/s "
+			   << qRound64((statistics.retransmitted_ - last.retransmitted_) /
+						   seconds)
+			   << "\tkey frames/s "
+			   << (statistics.keyFrames_ - last.keyFrames_) / seconds
+			   << "\n";
+
+		output.flush();
+		last = statistics;
+	});
+
+	if (report > 0) {
+		clock.start();
+		timer.start(report * 1000);
+	}
+
+	return a.exec();
+}
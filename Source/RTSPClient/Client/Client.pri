@@ -4,8 +4,20 @@
 
 HEADERS			+=															\
 						$$PWD/RTSPClient.hpp								\
+						$$PWD/RTSPClientPool.hpp							\
+						$$PWD/RTSPClockService.hpp							\
 						$$PWD/RTSPConnectionParameters.hpp					\
+						$$PWD/RTSPReconnectPolicy.hpp						\
+						$$PWD/RTSPSessionStatistics.hpp						\
+						$$PWD/RTSPShardStatistics.hpp						\
+						$$PWD/RTSPSharedReceiver.hpp						\
+						$$PWD/RTSPSharedReceiverStatistics.hpp				\
+						$$PWD/RTSPStreamStatistics.hpp						\
 
 SOURCES			+=															\
 						$$PWD/RTSPClient.cpp								\
+						$$PWD/RTSPClientPool.cpp							\
+						$$PWD/RTSPClockService.cpp							\
 						$$PWD/RTSPConnectionParameters.cpp					\
+						$$PWD/RTSPReconnectPolicy.cpp						\
+						$$PWD/RTSPSharedReceiver.cpp						\
@@ -5,8 +5,31 @@
 
 #include "RTSPClient.hpp"
 #include "Protocols/RTSP/AbstractRTSPClientBase.hpp"
+#include "Protocols/RTSP/RTSPClientEngine.hpp"
+#include "Protocols/RTSP/RTSPKeepAliveScheduler.hpp"
+#include "Protocols/RTCP/RTCPCompoundWriter.hpp"
+#include "Protocols/RTCP/RTCPInterval.hpp"
+#include "Protocols/RTCP/RTCPNackList.hpp"
+#include "Protocols/RTCP/RTCPPictureLoss.hpp"
+#include "Protocols/RTP/RTPPacketView.hpp"
+#include "Protocols/RTP/RTPTimestampUnwrapper.hpp"
+#include "RTSPReconnectPolicy.hpp"
+#include "RTSPSharedReceiver.hpp"
+#include "Utilities/AtomicCounter.hpp"
+#include "Utilities/DatagramReceiver.hpp"
+#include "Utilities/PacketBufferPool.hpp"
 
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFutureInterface>
+#include <QQueue>
+#include <QSocketNotifier>
 #include <QUdpSocket>
+#include <QtEndian>
+
+#include <algorithm>
+#include <atomic>
+#include <random>
 
 /// Contains classes and functions that implement Real Time Streaming Protocol
 /// (RTSP) library.
@@ -16,18 +39,82 @@ namespace RTSPLib {
 	/// Protocol (RTSP) client library.
 	namespace RTSPClient {
 
+		namespace {
+
+			/// Default interleaved RTP buffer size.
+			/// \details Packets are processed as soon as a read stores them,
+			/// so the buffer holds a few reads of a high bitrate stream.
+			constexpr int INTERLEAVED_BUFFER_SIZE { 256 * 1024 };
+
+			/// Interleaved RTCP buffer size.
+			/// \details The smallest buffer that holds an interleaved packet,
+			/// enough for the few reports a session receives.
+			constexpr int INTERLEAVED_CONTROL_BUFFER_SIZE { 0x10000 };
+
+			/// Default connect timeout.
+			/// \details Five seconds in milliseconds.
+			constexpr qint64 CONNECT_TIMEOUT { 5000 };
+
+			/// Default operation timeout.
+			/// \details Ten seconds in milliseconds, so a server that stops
+			/// answering fails its request instead of stalling the session.
+			constexpr qint64 OPERATION_TIMEOUT { 10000 };
+		}
+
 		/// Structure that provides private storage.
 		/// \details Maintains private data.
 		struct RTSPClient::RTSPClientPrivate final {
 
-			/// Timer to send RTSP heartbeat requests.
-			/// \details Timer to send heartbeat requests to resume RTP session.
-			QBasicTimer timer_;
+			/// Reconnect states.
+			enum class Reconnect {
+
+				/// No reconnect in progress.
+				Idle,
+
+				/// Waiting for the backoff delay.
+				Backoff,
+
+				/// Waiting for a reconnect slot.
+				Waiting,
+
+				/// Restoring the session.
+				Restoring
+			};
+
+			/// Keep-alive deadline.
+			/// \details Handle of the shared scheduler deadline that keeps
+			/// RTP session alive.
+			RTSPKeepAliveScheduler::handle_t keepAlive_ { 0 };
 
 			/// Socket for receiving RTP data.
 			/// \details Socket for receiving RTP data packets.
 			QUdpSocket rtp_;
 
+			/// Batched receiver of RTP data.
+			/// \details Replaces the RTP socket when batched receive is
+			/// enabled and supported.
+			DatagramReceiver receiver_;
+
+			/// Notifier for batched RTP data.
+			/// \details Watches the socket of the batched receiver.
+			QScopedPointer<QSocketNotifier> rtpNotifier_;
+
+			/// Whether RTP datagrams are received in batches.
+			/// \details Batched receive mode used by the next setup.
+			bool batchReceive_ { true };
+
+			/// Whether UDP data is received by the shared receiver.
+			/// \details Shared receive mode used by the next setup.
+			bool sharedReceive_ { false };
+
+			/// Whether the stream is registered with the shared receiver.
+			/// \details Set by a successful setup in shared receive mode.
+			bool shared_ { false };
+
+			/// Interleaved RTP buffer size.
+			/// \details Size in bytes used by the next setup over TCP.
+			int interleavedBufferSize_ { INTERLEAVED_BUFFER_SIZE };
+
 			/// Socket for receiving RTCP data.
 			/// \details Socket for receiving RTCP service messages.
 			QUdpSocket rtcp_;
@@ -35,15 +122,504 @@ namespace RTSPLib {
 			/// RTSP context.
 			/// \details RTSP context for RTP session management.
 			RTSPClientBase context_;
+
+			/// Notifier for interleaved data.
+			/// \details Watches RTSP connection when RTP is carried over TCP.
+			QScopedPointer<QSocketNotifier> notifier_;
+
+			/// RTP transport protocol.
+			/// \details Transport protocol requested by the next setup.
+			RTSPTransport transport_ { RTSPTransport::UDP };
+
+			/// Whether RTP is received from interleaved channels.
+			/// \details Set by a successful setup over TCP.
+			bool interleaved_ { false };
+
+			/// Interleaved channels.
+			/// \details Channels for RTP and RTCP data over TCP.
+			QPair<quint16, quint16> channels_ { 0, 0 };
+
+			/// Whether session bring-up skips OPTIONS.
+			/// \details Fast start mode used by the next open.
+			bool fastStart_ { false };
+
+			/// RTSP protocol backend.
+			/// \details Backend used by the next open.
+			RTSPBackend backend_ { RTSPBackend::Curl };
+
+			/// Connect and operation timeouts.
+			/// \details Timeouts used by the next open.
+			QPair<qint64, qint64> timeouts_ {
+				CONNECT_TIMEOUT,
+				OPERATION_TIMEOUT
+			};
+
+			/// Session clock.
+			/// \details Measures time since the session opening.
+			QElapsedTimer clock_;
+
+			/// Session bring-up statistics.
+			/// \details Times of the session bring-up stages.
+			RTSPSessionStatistics statistics_;
+
+			/// Media stream path.
+			/// \details Path of the last successful setup.
+			QUrl path_;
+
+			/// Media stream ports.
+			/// \details Ports of the last successful setup.
+			QPair<quint16, quint16> ports_ { 0, 0 };
+
+			/// Whether the media stream is set up.
+			/// \details Only a set up session is restored.
+			bool setUp_ { false };
+
+			/// Whether the media stream is playing.
+			/// \details Playback is started again after reconnect.
+			bool playing_ { false };
+
+			/// Whether a lost session is restored.
+			/// \details Automatic reconnect flag.
+			bool autoReconnect_ { false };
+
+			/// Reconnect state.
+			/// \details Stage of the reconnect in progress.
+			Reconnect reconnect_ { Reconnect::Idle };
+
+			/// Number of failed reconnect attempts.
+			/// \details Grows the backoff delay.
+			int attempt_ { 0 };
+
+			/// Reconnect deadline.
+			/// \details Handle of the shared scheduler deadline that ends
+			/// the backoff delay.
+			RTSPKeepAliveScheduler::handle_t backoff_ { 0 };
+
+			/// Reconnect clock.
+			/// \details Measures time since the connection loss.
+			QElapsedTimer lost_;
+
+			/// Structure that describes a queued request.
+			struct Request final {
+
+				/// Request starter.
+				request_t start_;
+
+				/// Completion callback.
+				completion_t completion_;
+			};
+
+			/// Queued non-blocking requests.
+			/// \details Requests of asynchronous operations and keep-alive
+			/// run one after another.
+			QQueue<Request> requests_;
+
+			/// Completion callback of the request in progress.
+			/// \details Empty if no request is in progress.
+			completion_t current_;
+
+			/// Whether a request is in progress.
+			/// \details Set while the RTSP context runs a queued request.
+			bool busy_ { false };
+
+			/// Request generation.
+			/// \details Tells completions of cancelled requests apart.
+			quint64 generation_ { 0 };
+
+			/// Whether requests are being cancelled.
+			/// \details Lets completion callbacks tell cancellation from
+			/// failure.
+			bool cancelling_ { false };
+
+			/// Number of received RTP packets.
+			/// \details Written by the owning thread only and read by the
+			/// client pool from its own thread.
+			std::atomic<quint64> packets_ { 0 };
+
+			/// Number of received RTP bytes.
+			/// \details Written by the owning thread only.
+			std::atomic<quint64> bytes_ { 0 };
+
+			/// Lost RTP packets of previous sources.
+			/// \details Written by the owning thread only.
+			std::atomic<qint64> lostSources_ { 0 };
+
+			/// Number of receive system calls for UDP RTP data.
+			/// \details Written by the owning thread only.
+			std::atomic<quint64> syscalls_ { 0 };
+
+			/// Receive state of the current RTP source.
+			/// \details Updated by the owning thread, statistics are read
+			/// from any thread.
+			RTPStream stream_;
+
+			/// Sender clock of the current RTP source.
+			/// \details Updated by sender reports, read from any thread.
+			RTCPSenderClock senderClock_;
+
+			/// Presentation timeline of the current RTP source.
+			/// \details Updated by the owning thread, read from any thread.
+			RTPTimestampUnwrapper timeline_;
+
+			/// Receiver report interval.
+			/// \details Scaled by session bandwidth and report size.
+			RTCPInterval interval_;
+
+			/// Whether receiver reports are sent.
+			/// \details Set while a stream over UDP is received.
+			bool reporting_ { false };
+
+			/// Receiver report deadline.
+			/// \details Handle of the shared scheduler deadline of the next
+			/// report.
+			RTSPKeepAliveScheduler::handle_t report_ { 0 };
+
+			/// Synchronization source ID (SSRC) of the receiver.
+			/// \details Random, as RFC 3550 requires.
+			quint32 localSource_ { 0 };
+
+			/// Canonical name of the receiver.
+			/// \details Random per client, as RFC 7022 suggests.
+			QByteArray localName_;
+
+			/// Destination address of RTCP data.
+			/// \details Address of the RTSP server.
+			QHostAddress controlAddress_;
+
+			/// Destination port of RTCP data.
+			/// \details Announced by SETUP response, or learned from the
+			/// first RTCP packet if it was not.
+			quint16 controlPort_ { 0 };
+
+			/// Session bandwidth announced by the session description.
+			/// \details Bits per second, zero if it is not announced.
+			qint64 bandwidth_ { 0 };
+
+			/// Number of received RTP bytes at the last report.
+			/// \details Measures session bandwidth if it is not announced.
+			quint64 reportBytes_ { 0 };
+
+			/// Time of the last report in nanoseconds.
+			/// \details Measures session bandwidth if it is not announced.
+			qint64 reportTime_ { 0 };
+
+			/// Whether RTCP liveness replaces keep-alive requests.
+			/// \details RTCP keep-alive mode.
+			bool reportKeepAlive_ { false };
+
+			/// Whether RTCP data was received since the last keep-alive.
+			/// \details Shows that the server takes part in RTCP.
+			bool controlReceived_ { false };
+
+			/// Whether a report was sent since the last keep-alive.
+			/// \details Shows that the server gets RTCP data.
+			bool reportSent_ { false };
+
+			/// Number of received sender reports of the stream source.
+			/// \details Written by the owning thread only.
+			std::atomic<quint64> senderReports_ { 0 };
+
+			/// Number of sent receiver reports.
+			/// \details Written by the owning thread only.
+			std::atomic<quint64> receiverReports_ { 0 };
+
+			/// Whether lost packets are requested again.
+			/// \details Retransmission mode used by the next setup.
+			bool retransmission_ { false };
+
+			/// Whether negative acknowledgements are sent.
+			/// \details Set while a stream over UDP is received by the
+			/// sockets of the session in retransmission mode.
+			bool nacking_ { false };
+
+			/// RTP payload type of retransmissions.
+			/// \details Announced by the session description, -1 if it is
+			/// not.
+			int retransmitType_ { -1 };
+
+			/// Missing packets of the current RTP source.
+			/// \details Updated by the owning thread, statistics are read
+			/// from any thread.
+			RTCPNackList nacks_;
+
+			/// Retransmission request deadline.
+			/// \details Handle of the shared scheduler deadline that sends
+			/// requests when no packets arrive.
+			RTSPKeepAliveScheduler::handle_t retransmit_ { 0 };
+
+			/// Time of the last feedback packet in nanoseconds.
+			/// \details Limits the rate of feedback packets.
+			qint64 feedbackTime_ { 0 };
+
+			/// Key frame request of broken video.
+			/// \details Key frame request used by the next setup.
+			RTSPKeyFrameRequest keyFrameRequest_ {
+				RTSPKeyFrameRequest::None
+			};
+
+			/// Key frame request of the current stream.
+			/// \details Set while a stream over UDP is received.
+			RTSPKeyFrameRequest requesting_ { RTSPKeyFrameRequest::None };
+
+			/// RTP payload type of H.264 or H.265 video.
+			/// \details Announced by the session description, -1 if it is
+			/// not. Key frames of other payload types are not recognized.
+			int videoType_ { -1 };
+
+			/// Whether the video is H.265.
+			bool hevc_ { false };
+
+			/// Losses and key frames of the current RTP source.
+			/// \details Updated by the owning thread, statistics are read
+			/// from any thread.
+			RTCPPictureLoss pictureLoss_;
+
+			/// Key frame request deadline.
+			/// \details Handle of the shared scheduler deadline that sends
+			/// a request held back by the rate limit when no packets arrive.
+			RTSPKeepAliveScheduler::handle_t keyFrame_ { 0 };
 		};
 
+		namespace {
+
+			/// Maximum number of batches received per notification.
+			/// \details Bounds the time one stream holds the event loop, the
+			/// rest is received on the next notification.
+			constexpr int MAX_BATCHES { 8 };
+
+			/// Maximum number of packets requested by a feedback packet.
+			/// \details Bounds the feedback packet to a few hundred bytes,
+			/// the rest is requested by the next one.
+			constexpr int MAX_NACKS { 64 };
+
+			/// Shortest interval between feedback packets.
+			/// \details Ten milliseconds, so a burst of losses is requested
+			/// by a few packets.
+			constexpr qint64 FEEDBACK_INTERVAL { 10000000 };
+
+			/// Number of random bytes of a canonical name.
+			/// \details Ninety-six bits, as RFC 7022 recommends.
+			constexpr int NAME_SIZE { 12 };
+
+			/// Event that resumes a client moved to another thread.
+			/// \details Posted with high priority, so that it precedes calls
+			/// queued to the client before the move.
+			const QEvent::Type ATTACH_EVENT {
+				static_cast<QEvent::Type>(QEvent::registerEventType())
+			};
+
+			/// Returns RTP clock rate of a payload type.
+			/// \details Looks for the rtpmap attribute of the payload type in
+			/// the session description, then falls back to static payload
+			/// types of RFC 3551.
+			/// \param[in]	sdp			Session description.
+			/// \param[in]	payloadType	RTP payload type.
+			/// \return Clock rate or zero if it is unknown.
+			int clockRate(const QByteArray& sdp, int payloadType) {
+				auto prefix = "a=rtpmap:" + QByteArray::number(payloadType) +
+							  " ";
+
+				for (const auto& line : sdp.split('\n')) {
+					if (!line.startsWith(prefix)) continue;
+
+					auto fields = line.mid(prefix.size()).trimmed().split('/');
+					auto rate = fields.size() > 1 ? fields[1].toInt() : 0;
+
+					if (rate > 0) return rate;
+				}
+
+				switch (payloadType) {
+					case 6:
+						return 16000;
+
+					case 10:
+					case 11:
+						return 44100;
+
+					case 16:
+						return 11025;
+
+					case 17:
+						return 22050;
+
+					case 14:
+					case 25:
+					case 26:
+					case 28:
+					case 31:
+					case 32:
+					case 33:
+					case 34:
+						return 90000;
+
+					default:
+						return payloadType < 19 ? 8000 : 0;
+				}
+			}
+
+			/// Returns session bandwidth.
+			/// \details Takes the largest application-specific bandwidth
+			/// of the session description, which covers every media
+			/// description.
+			/// \param[in]	sdp	Session description.
+			/// \return Bandwidth in bits per second or zero if it is not
+			/// announced.
+			qint64 sessionBandwidth(const QByteArray& sdp) {
+				const QByteArray prefix("b=AS:");
+				qint64 bandwidth = 0;
+
+				for (const auto& line : sdp.split('\n'))
+					if (line.startsWith(prefix))
+						bandwidth = std::max(
+							bandwidth,
+							line.mid(prefix.size()).trimmed().toLongLong());
+
+				return bandwidth * 1000;
+			}
+
+			/// Returns RTP payload type of retransmissions.
+			/// \details Looks for the rtpmap attribute of an RFC 4588
+			/// retransmission payload format in the session description.
+			/// \param[in]	sdp	Session description.
+			/// \return Payload type or -1 if retransmissions are not
+			/// announced.
+			int retransmissionType(const QByteArray& sdp) {
+				const QByteArray prefix("a=rtpmap:");
+
+				for (const auto& line : sdp.split('\n')) {
+					if (!line.startsWith(prefix)) continue;
+
+					auto fields = line.mid(prefix.size()).trimmed().split(' ');
+
+					if (fields.size() > 1 &&
+						fields[1].toLower().startsWith("rtx/"))
+						return fields[0].toInt();
+				}
+
+				return -1;
+			}
+
+			/// Returns RTP payload type of H.264 or H.265 video.
+			/// \details Looks for the rtpmap attribute of RFC 6184 or RFC 7798
+			/// payload formats in the session description.
+			/// \param[in]	sdp		Session description.
+			/// \param[out]	hevc	Whether the video is H.265.
+			/// \return Payload type or -1 if neither format is announced.
+			int videoType(const QByteArray& sdp, bool& hevc) {
+				const QByteArray prefix("a=rtpmap:");
+
+				for (const auto& line : sdp.split('\n')) {
+					if (!line.startsWith(prefix)) continue;
+
+					auto fields = line.mid(prefix.size()).trimmed().split(' ');
+
+					if (fields.size() < 2) continue;
+
+					auto name = fields[1].toUpper();
+
+					if (name.startsWith("H264/") || name.startsWith("H265/")) {
+						hevc = name.startsWith("H265/");
+						return fields[0].toInt();
+					}
+				}
+
+				return -1;
+			}
+
+			/// Indicates whether an H.264 or H.265 NAL unit type starts a
+			/// key frame.
+			/// \details Instantaneous decoding refresh pictures of H.264 and
+			/// intra random access point pictures of H.265.
+			/// \param[in]	type	NAL unit type.
+			/// \param[in]	hevc	Whether the video is H.265.
+			/// \retval true if the type starts a key frame.
+			/// \retval false otherwise.
+			bool isKeyUnit(int type, bool hevc) {
+				return hevc ? type >= 16 && type <= 21 : type == 5;
+			}
+
+			/// Indicates whether an RTP payload starts a key frame.
+			/// \details Recognizes single NAL units, the first fragment of a
+			/// fragmented unit and aggregation packets that contain a key
+			/// unit, in the payload formats of RFC 6184 and RFC 7798.
+			/// Aggregation packets with decoding order numbers are not
+			/// supported.
+			/// \param[in]	data	Payload data.
+			/// \param[in]	size	Payload size.
+			/// \param[in]	hevc	Whether the video is H.265.
+			/// \retval true if the payload starts a key frame.
+			/// \retval false otherwise.
+			bool isKeyFrame(const char* data, int size, bool hevc) {
+				auto bytes = reinterpret_cast<const quint8*>(data);
+				auto header = hevc ? 2 : 1;
+
+				if (size <= header) return false;
+
+				auto type = hevc ? bytes[0] >> 1 & 0x3F : bytes[0] & 0x1F;
+				auto unit = [&](int offset) {
+					return hevc ? bytes[offset] >> 1 & 0x3F
+								: bytes[offset] & 0x1F;
+				};
+
+				if (type == (hevc ? 48 : 24)) {
+					for (auto i = header; i + 2 < size; ) {
+						if (isKeyUnit(unit(i + 2), hevc)) return true;
+
+						i += 2 + (bytes[i] << 8 | bytes[i + 1]);
+					}
+
+					return false;
+				}
+
+				if (type == (hevc ? 49 : 28))
+					return (bytes[header] & 0x80) != 0 &&
+						   isKeyUnit(bytes[header] & (hevc ? 0x3F : 0x1F),
+									 hevc);
+
+				return isKeyUnit(type, hevc);
+			}
+
+			/// Creates a future and the callback that finishes it.
+			/// \param[out]	future		Future of the operation result.
+			/// \param[in]	callback	User completion callback.
+			/// \return Callback that reports the result.
+			RTSPClient::callback_t makePromise(
+				QFuture<bool>& future,
+				const RTSPClient::callback_t& callback) {
+
+				QFutureInterface<bool> promise;
+				promise.reportStarted();
+				future = promise.future();
+
+				return [promise, callback](bool result) mutable {
+					promise.reportResult(result);
+					promise.reportFinished();
+
+					if (callback) callback(result);
+				};
+			}
+		}
+
 		/// Default constructor.
-		/// \details Initializes object fields.
+		/// \details Initializes object fields. Sockets are children of the
+		/// client, so they follow it to another thread.
 		/// \param[in]	parent	Parent object.
 		RTSPClient::RTSPClient(QObject* parent)
 			: QObject(parent),
 			  private_(new RTSPClientPrivate) {
 
+			private_->rtp_.setParent(this);
+			private_->rtcp_.setParent(this);
+
+			std::random_device random;
+			std::uniform_int_distribution<int> byte(0, 0xFF);
+			QByteArray name(NAME_SIZE, '\0');
+
+			for (auto& character : name)
+				character = static_cast<char>(byte(random));
+
+			private_->localSource_ = static_cast<quint32>(random());
+			private_->localName_ = name.toBase64();
 		}
 
 		/// Destructor.
@@ -54,24 +630,29 @@ namespace RTSPLib {
 
 		///
 		/// \details Initializes the RTSP context and sends OPTIONS and
-		/// DESCRIBE requests.
+		/// DESCRIBE requests. In fast start mode OPTIONS is skipped and
+		/// supported methods are learned from the first keep-alive request.
 		/// \param[in]	url	RTSP connection URL.
 		/// \retval true on success.
 		/// \retval false on error.
 		bool RTSPClient::open(const QUrl& url) {
 			close();
 
-			//private_->context_.setUserAgent("RTSPClient");
-			//private_->context_.setCredentials({"admin", "741852369"});
+			if (!openContext(url)) {
+				close();
+				return false;
+			}
 
-			if (!url.isValid()										||
-				!private_->context_.open(url.toEncoded())			||
-				private_->context_.OPTIONS() != RTSPStatusCode::Ok	||
+			if ((!private_->fastStart_ &&
+				 private_->context_.OPTIONS() != RTSPStatusCode::Ok)	||
 				private_->context_.DESCRIBE() != RTSPStatusCode::Ok) {
 				close();
 				return false;
 			}
 
+			private_->statistics_.described_ =
+				private_->clock_.nsecsElapsed();
+
 			return true;
 		}
 
@@ -84,7 +665,8 @@ namespace RTSPLib {
 		}
 
 		/// Sets up the media stream.
-		/// \details Sends SETUP request and set up RTP and RTCP sockets.
+		/// \details Sends SETUP request and binds RTP and RTCP sockets. With
+		/// TCP transport the ports are used as interleaved channels.
 		/// \param[in]	path	Media stream path.
 		/// \param[in]	ports	Ports for receiving RTP and RTCP data.
 		/// \retval true on success.
@@ -94,26 +676,15 @@ namespace RTSPLib {
 
 			reset();
 
-			if (!path.isValid()												||
-				private_->context_.SETUP(path.toEncoded(), ports) !=
-					RTSPStatusCode::Ok										) {
+			if (startStream(path, ports) != RTSPStatusCode::Ok) {
 				reset();
 				return false;
 			}
 
-			connect(
-				&private_->rtp_,
-				SIGNAL(readyRead()),
-				SLOT(onRTPDatagram())
-			);
-
-			connect(
-				&private_->rtcp_,
-				SIGNAL(readyRead()),
-				SLOT(onRTCPDatagram())
-			);
-
-			private_->timer_.start(30000, this);
+			private_->path_ = path;
+			private_->ports_ = ports;
+			private_->setUp_ = true;
+			private_->statistics_.setUp_ = private_->clock_.nsecsElapsed();
 
 			return true;
 		}
@@ -123,13 +694,12 @@ namespace RTSPLib {
 		/// \retval true on success.
 		/// \retval false on error.
 		bool RTSPClient::reset() {
-			private_->timer_.stop();
-
-			private_->rtp_.disconnect();
-			private_->rtp_.close();
+			cancelReconnect();
+			cancelPending();
+			stopStream();
 
-			private_->rtcp_.disconnect();
-			private_->rtcp_.close();
+			private_->setUp_ = false;
+			private_->playing_ = false;
 
 			return private_->context_.TEARDOWN() == RTSPStatusCode::Ok;
 		}
@@ -139,7 +709,12 @@ namespace RTSPLib {
 		/// \retval true on success.
 		/// \retval false on error.
 		bool RTSPClient::play() {
-			private_->context_.PLAY();
+			cancelPending();
+
+			if (private_->context_.PLAY() != RTSPStatusCode::Ok) return false;
+
+			private_->playing_ = true;
+			private_->statistics_.played_ = private_->clock_.nsecsElapsed();
 
 			return true;
 		}
@@ -149,7 +724,232 @@ namespace RTSPLib {
 		/// \retval true on success.
 		/// \retval false on error.
 		bool RTSPClient::pause() {
-			return private_->context_.PAUSE() == RTSPStatusCode::Ok;
+			cancelPending();
+
+			if (private_->context_.PAUSE() != RTSPStatusCode::Ok) return false;
+
+			private_->playing_ = false;
+
+			return true;
+		}
+
+		/// Opens the session without blocking.
+		/// \details Tears down the previous session, then sends OPTIONS and
+		/// DESCRIBE requests through the engine of the calling thread. The
+		/// callback and the future are finished from the event loop.
+		/// \param[in]	url			RTSP connection URL.
+		/// \param[in]	callback	Completion callback.
+		/// \return Future of the operation result.
+		QFuture<bool> RTSPClient::openAsync(const QUrl& url,
+											const callback_t& callback) {
+			QFuture<bool> future;
+			auto done = makePromise(future, callback);
+
+			resetAsync([this, url, done](bool) {
+				auto& context = private_->context_;
+
+				if (private_->cancelling_) {
+					done(false);
+					return;
+				}
+
+				context.close();
+
+				if (!openContext(url)) {
+					context.close();
+					done(false);
+					return;
+				}
+
+				auto described = [this, done](RTSPStatusCode status) {
+					if (private_->cancelling_) {
+						done(false);
+						return;
+					}
+
+					if (status != RTSPStatusCode::Ok) {
+						close();
+						done(false);
+						return;
+					}
+
+					private_->statistics_.described_ =
+						private_->clock_.nsecsElapsed();
+
+					done(true);
+				};
+
+				auto describe = [this, described]() {
+					submit([this](const completion_t& completion) {
+						return private_->context_.DESCRIBE(completion);
+					}, described);
+				};
+
+				if (private_->fastStart_) {
+					describe();
+					return;
+				}
+
+				submit([this](const completion_t& completion) {
+					return private_->context_.OPTIONS(completion);
+				}, [this, done, describe](RTSPStatusCode status) {
+					if (private_->cancelling_) {
+						done(false);
+						return;
+					}
+
+					if (status != RTSPStatusCode::Ok) {
+						close();
+						done(false);
+						return;
+					}
+
+					describe();
+				});
+			});
+
+			return future;
+		}
+
+		/// Closes the session without blocking.
+		/// \details Tears down the session, then closes the RTSP context once
+		/// TEARDOWN request finishes. The context stays open if a blocking
+		/// operation supersedes the close.
+		/// \param[in]	callback	Completion callback.
+		/// \return Future of the operation result.
+		QFuture<bool> RTSPClient::closeAsync(const callback_t& callback) {
+			QFuture<bool> future;
+			auto done = makePromise(future, callback);
+
+			resetAsync([this, done](bool torn) {
+				if (private_->cancelling_) {
+					done(false);
+					return;
+				}
+
+				private_->context_.close();
+				done(torn);
+			});
+
+			return future;
+		}
+
+		/// Sets up the media stream without blocking.
+		/// \details Tears down the previous stream, then sends SETUP request
+		/// and binds RTP and RTCP sockets once it succeeds.
+		/// \param[in]	path		Media stream path.
+		/// \param[in]	ports		Ports for receiving RTP and RTCP data.
+		/// \param[in]	callback	Completion callback.
+		/// \return Future of the operation result.
+		QFuture<bool> RTSPClient::setupAsync(
+			const QUrl& path,
+			const QPair<quint16, quint16>& ports,
+			const callback_t& callback) {
+
+			QFuture<bool> future;
+			auto done = makePromise(future, callback);
+
+			resetAsync([this, path, ports, done](bool) {
+				if (private_->cancelling_ || !path.isValid()) {
+					done(false);
+					return;
+				}
+
+				startStream(
+					path,
+					ports,
+					[this, path, ports, done](RTSPStatusCode status) {
+						if (private_->cancelling_) {
+							done(false);
+							return;
+						}
+
+						if (status != RTSPStatusCode::Ok) {
+							resetAsync();
+							done(false);
+							return;
+						}
+
+						private_->path_ = path;
+						private_->ports_ = ports;
+						private_->setUp_ = true;
+						private_->statistics_.setUp_ =
+							private_->clock_.nsecsElapsed();
+
+						done(true);
+					});
+			});
+
+			return future;
+		}
+
+		/// Tears down the media stream without blocking.
+		/// \details Closes sockets at once and queues TEARDOWN request, which
+		/// fails without a round-trip if there is no session.
+		/// \param[in]	callback	Completion callback.
+		/// \return Future of the operation result.
+		QFuture<bool> RTSPClient::resetAsync(const callback_t& callback) {
+			QFuture<bool> future;
+			auto done = makePromise(future, callback);
+
+			cancelReconnect();
+			stopStream();
+
+			private_->setUp_ = false;
+			private_->playing_ = false;
+
+			submit([this](const completion_t& completion) {
+				return private_->context_.TEARDOWN(completion);
+			}, [done](RTSPStatusCode status) {
+				done(status == RTSPStatusCode::Ok);
+			});
+
+			return future;
+		}
+
+		/// Starts playback of the media stream without blocking.
+		/// \details Queues PLAY request.
+		/// \param[in]	callback	Completion callback.
+		/// \return Future of the operation result.
+		QFuture<bool> RTSPClient::playAsync(const callback_t& callback) {
+			QFuture<bool> future;
+			auto done = makePromise(future, callback);
+
+			submit([this](const completion_t& completion) {
+				return private_->context_.PLAY(completion);
+			}, [this, done](RTSPStatusCode status) {
+				if (status != RTSPStatusCode::Ok) {
+					done(false);
+					return;
+				}
+
+				private_->playing_ = true;
+				private_->statistics_.played_ =
+					private_->clock_.nsecsElapsed();
+
+				done(true);
+			});
+
+			return future;
+		}
+
+		/// Pauses playback of the media stream without blocking.
+		/// \details Queues PAUSE request.
+		/// \param[in]	callback	Completion callback.
+		/// \return Future of the operation result.
+		QFuture<bool> RTSPClient::pauseAsync(const callback_t& callback) {
+			QFuture<bool> future;
+			auto done = makePromise(future, callback);
+
+			submit([this](const completion_t& completion) {
+				return private_->context_.PAUSE(completion);
+			}, [this, done](RTSPStatusCode status) {
+				if (status == RTSPStatusCode::Ok) private_->playing_ = false;
+
+				done(status == RTSPStatusCode::Ok);
+			});
+
+			return future;
 		}
 
 		///
@@ -160,36 +960,1623 @@ namespace RTSPLib {
 			return private_->context_.isOpen();
 		}
 
-		/// Handles timer events.
-		/// \details Performs OPTIONS heartbeat request.
-		/// \param[in]	event	Timer event.
-		void RTSPClient::timerEvent(QTimerEvent* event) {
-			if (event && event->timerId() == private_->timer_.timerId()) {
-				private_->context_.OPTIONS();
-			}
-			else QObject::timerEvent(event);
+		/// Returns RTP transport protocol.
+		/// \details Returns transport protocol requested by the next setup.
+		/// \return RTP transport protocol.
+		RTSPTransport RTSPClient::getTransport() const {
+			return private_->transport_;
 		}
 
-		/// Performs an action when receiving RTP data.
-		/// \details Performs RTP packet processing and frame assembly.
-		void RTSPClient::onRTPDatagram() {
-			while (private_->rtp_.hasPendingDatagrams()) {
-				QByteArray data(
-					private_->rtp_.pendingDatagramSize(),
-					Qt::Uninitialized
-				);
+		/// Sets RTP transport protocol used by the next setup.
+		/// \details TCP transport carries RTP and RTCP interleaved on the RTSP
+		/// connection, which works behind NAT.
+		/// \param[in]	transport	RTP transport protocol.
+		void RTSPClient::setTransport(RTSPTransport transport) {
+			private_->transport_ = transport;
+		}
 
-				if (private_->rtp_.readDatagram(data.data(), data.size()) !=
-					data.size()) continue;
+		/// Indicates whether fast start is enabled.
+		/// \details Returns fast start flag used by the next open.
+		/// \retval true if fast start is enabled.
+		/// \retval false if fast start is disabled.
+		bool RTSPClient::isFastStart() const {
+			return private_->fastStart_;
+		}
 
-				qDebug() << data.size();
-			}
+		/// Enables or disables fast start used by the next open.
+		/// \details Fast start skips OPTIONS round-trip before DESCRIBE, so
+		/// the first RTP packet arrives one round-trip earlier.
+		/// \param[in]	fastStart	Whether session bring-up skips OPTIONS.
+		void RTSPClient::setFastStart(bool fastStart) {
+			private_->fastStart_ = fastStart;
 		}
 
-		/// Performs an action when receiving RTCP data.
-		/// \details Performs processing of RTCP packets.
-		void RTSPClient::onRTCPDatagram() {
+		/// Indicates whether batched receive is enabled.
+		/// \details Returns batched receive mode used by the next setup.
+		/// \retval true if batched receive is enabled.
+		/// \retval false if batched receive is disabled.
+		bool RTSPClient::isBatchReceive() const {
+			return private_->batchReceive_;
+		}
+
+		/// Enables or disables batched receive used by the next setup.
+		/// \details Batched receive reads many RTP datagrams per system call
+		/// where recvmmsg() is available, elsewhere the setting has no
+		/// effect. Applies to UDP transport only.
+		/// \param[in]	batchReceive	Whether RTP datagrams are received
+		/// in batches.
+		void RTSPClient::setBatchReceive(bool batchReceive) {
+			private_->batchReceive_ = batchReceive;
+		}
+
+		/// Indicates whether shared receive is enabled.
+		/// \details Returns shared receive mode used by the next setup.
+		/// \retval true if shared receive is enabled.
+		/// \retval false if shared receive is disabled.
+		bool RTSPClient::isSharedReceive() const {
+			return private_->sharedReceive_;
+		}
+
+		/// Enables or disables shared receive used by the next setup.
+		/// \details In shared receive mode the session requests the ports of
+		/// the shared receiver of the owning thread, which receives media of
+		/// all such sessions of the thread through one socket pair. Where it
+		/// is not supported the setting has no effect. Applies to UDP
+		/// transport only. A session set up in this mode stays on its
+		/// thread, since the server sends to the ports of the thread.
+		/// \param[in]	sharedReceive	Whether UDP data is received by the
+		/// shared receiver of the thread.
+		void RTSPClient::setSharedReceive(bool sharedReceive) {
+			private_->sharedReceive_ = sharedReceive;
+		}
+
+		/// Returns interleaved RTP buffer size.
+		/// \details Returns buffer size used by the next setup.
+		/// \return Buffer size in bytes.
+		int RTSPClient::getInterleavedBufferSize() const {
+			return private_->interleavedBufferSize_;
+		}
+
+		/// Sets interleaved RTP buffer size used by the next setup.
+		/// \details Packets are processed right after the socket is read,
+		/// so the buffer only holds the packets of one read. The size is
+		/// rounded up to a power of two that holds the largest interleaved
+		/// packet. Applies to TCP transport only.
+		/// \param[in]	size	Buffer size in bytes.
+		void RTSPClient::setInterleavedBufferSize(int size) {
+			private_->interleavedBufferSize_ = size;
+		}
+
+		/// Indicates whether RTCP keep-alive is enabled.
+		/// \details Returns RTCP keep-alive mode.
+		/// \retval true if RTCP keep-alive is enabled.
+		/// \retval false if RTCP keep-alive is disabled.
+		bool RTSPClient::isReportKeepAlive() const {
+			return private_->reportKeepAlive_;
+		}
+
+		/// Enables or disables RTCP keep-alive.
+		/// \details RFC 2326 lets RTCP reports keep a session alive. When
+		/// enabled, a keep-alive request is skipped if receiver reports were
+		/// sent and the server sent RTCP data since the previous one, which
+		/// shows it takes part in RTCP. Only streams over UDP send reports.
+		/// \param[in]	reportKeepAlive	Whether RTCP exchange with the
+		/// server replaces keep-alive requests.
+		void RTSPClient::setReportKeepAlive(bool reportKeepAlive) {
+			private_->reportKeepAlive_ = reportKeepAlive;
+		}
+
+		/// Indicates whether retransmission is enabled.
+		/// \details Returns retransmission mode used by the next setup.
+		/// \retval true if retransmission is enabled.
+		/// \retval false if retransmission is disabled.
+		bool RTSPClient::isRetransmission() const {
+			return private_->retransmission_;
+		}
+
+		/// Enables or disables retransmission used by the next setup.
+		/// \details Lost packets are requested again by RFC 4585 generic
+		/// negative acknowledgements, and retransmissions are accepted in
+		/// the RFC 4588 payload format the session description announces,
+		/// or as the original packets. Applies to UDP transport received by
+		/// the sockets of the session only, since the shared receiver can
+		/// not tell the retransmission source from a new session.
+		/// \param[in]	retransmission	Whether lost packets are requested
+		/// again.
+		void RTSPClient::setRetransmission(bool retransmission) {
+			private_->retransmission_ = retransmission;
+		}
+
+		/// Returns key frame request of broken video.
+		/// \details Returns key frame request used by the next setup.
+		/// \return Key frame request.
+		RTSPKeyFrameRequest RTSPClient::getKeyFrameRequest() const {
+			return private_->keyFrameRequest_;
+		}
+
+		/// Sets key frame request of broken video used by the next setup.
+		/// \details Packets lost for good, or given up by retransmission,
+		/// break the video until the next key frame, so the sender is asked
+		/// for one at once. Requests go through the RTCP socket of the
+		/// session or the shared receiver and apply to UDP transport only.
+		/// \param[in]	request	Key frame request.
+		void RTSPClient::setKeyFrameRequest(RTSPKeyFrameRequest request) {
+			private_->keyFrameRequest_ = request;
+		}
+
+		/// Reports a video frame that can not be decoded.
+		/// \details A depacketizer or decoder of the application calls it
+		/// for a frame whose references are broken, such as a frame with a
+		/// lost fragment. The sender is asked for a key frame unless a
+		/// request is already waiting or on its way. Requests are rate
+		/// limited per stream. Does nothing unless the stream was set up
+		/// with key frame requests. Must be called on the thread of the
+		/// client.
+		void RTSPClient::requestKeyFrame() {
+			auto& p = *private_;
+
+			if (p.requesting_ == RTSPKeyFrameRequest::None ||
+				!p.stream_.isActive())
+				return;
+
+			auto now = p.clock_.nsecsElapsed();
+
+			p.pictureLoss_.lose(now);
+			sendKeyFrameRequest(now);
+		}
+
+		/// Returns RTSP protocol backend.
+		/// \details Returns backend used by the next open.
+		/// \return RTSP protocol backend.
+		RTSPBackend RTSPClient::getBackend() const {
+			return private_->backend_;
+		}
+
+		/// Sets RTSP protocol backend used by the next open.
+		/// \details The native backend pipelines requests and reads
+		/// interleaved data from the event loop without libcurl.
+		/// \param[in]	backend	RTSP protocol backend.
+		void RTSPClient::setBackend(RTSPBackend backend) {
+			private_->backend_ = backend;
+		}
+
+		/// Returns connect and operation timeouts.
+		/// \details Returns timeouts used by the next open.
+		/// \return Connect and operation timeouts in milliseconds.
+		QPair<qint64, qint64> RTSPClient::getTimeouts() const {
+			return private_->timeouts_;
+		}
+
+		/// Sets connect and operation timeouts used by the next open.
+		/// \details The operation timeout limits every request, blocking or
+		/// not, keep-alive and reconnect included. Zero disables a limit.
+		/// \param[in]	timeouts	Connect and operation timeouts in
+		///							milliseconds.
+		void RTSPClient::setTimeouts(const QPair<qint64, qint64>& timeouts) {
+			private_->timeouts_ = timeouts;
+		}
+
+		/// Indicates whether automatic reconnect is enabled.
+		/// \details Returns automatic reconnect flag.
+		/// \retval true if automatic reconnect is enabled.
+		/// \retval false if automatic reconnect is disabled.
+		bool RTSPClient::isAutoReconnect() const {
+			return private_->autoReconnect_;
+		}
+
+		/// Enables or disables automatic reconnect.
+		/// \details A set up session whose connection is lost is restored
+		/// after a jittered exponential backoff. Disabling it cancels a
+		/// reconnect in progress.
+		/// \param[in]	autoReconnect	Whether a lost session is restored.
+		void RTSPClient::setAutoReconnect(bool autoReconnect) {
+			private_->autoReconnect_ = autoReconnect;
+
+			if (!autoReconnect) cancelReconnect();
+		}
+
+		/// Returns session bring-up statistics.
+		/// \details Times are measured from the start of the last open,
+		/// except the recovery time. Authentication counters are taken from
+		/// the RTSP context.
+		/// \return Session bring-up statistics.
+		RTSPSessionStatistics RTSPClient::getStatistics() const {
+			auto statistics = private_->statistics_;
+
+			statistics.authChallenges_ =
+				private_->context_.getAuthChallengeCount();
+
+			statistics.savedRoundTrips_ =
+				private_->context_.getSavedRoundTrips();
+
+			return statistics;
+		}
+
+		/// Returns number of received RTP packets.
+		/// \details Safe to call from any thread.
+		/// \return Number of received RTP packets.
+		quint64 RTSPClient::getPacketCount() const {
+			return private_->packets_.load(std::memory_order_relaxed);
+		}
+
+		/// Returns media stream reception statistics.
+		/// \details Safe to call from any thread. Counters are read one by
+		/// one, so they may belong to adjacent packets.
+		/// \return Media stream reception statistics.
+		RTSPStreamStatistics RTSPClient::getStreamStatistics() const {
+			RTSPStreamStatistics statistics;
+
+			statistics.packets_ =
+				private_->packets_.load(std::memory_order_relaxed);
+			statistics.bytes_ =
+				private_->bytes_.load(std::memory_order_relaxed);
+			auto receiver = private_->stream_.getStatistics();
+
+			statistics.lost_ =
+				private_->lostSources_.load(std::memory_order_relaxed) +
+				receiver.totalLost_;
+			statistics.jitter_ = receiver.jitterTime_;
+			statistics.syscalls_ =
+				private_->syscalls_.load(std::memory_order_relaxed);
+			statistics.senderReports_ =
+				private_->senderReports_.load(std::memory_order_relaxed);
+			statistics.receiverReports_ =
+				private_->receiverReports_.load(std::memory_order_relaxed);
+			auto nacks = private_->nacks_.getStatistics();
+
+			statistics.retransmitRequests_ = nacks.requested_;
+			statistics.retransmitted_ = nacks.recovered_;
+			statistics.unrecovered_ = nacks.unrecovered_;
+			statistics.roundTrip_ = nacks.roundTrip_ / 1000;
+			auto pictures = private_->pictureLoss_.getStatistics();
+
+			statistics.keyFrameRequests_ = pictures.requested_;
+			statistics.recoveries_ = pictures.recoveries_;
+			statistics.recoveryTime_ = pictures.recoveryTime_ / 1000;
+			statistics.maxRecoveryTime_ = pictures.maxRecoveryTime_ / 1000;
+			statistics.meanRecoveryTime_ =
+				pictures.recoveries_ > 0
+				? pictures.totalRecoveryTime_ / 1000 /
+				  static_cast<qint64>(pictures.recoveries_)
+				: 0;
+
+			return statistics;
+		}
+
+		/// Returns RFC 3550 receiver statistics of the current RTP source.
+		/// \details Safe to call from any thread without locks, the snapshot
+		/// is consistent.
+		/// \return Receiver statistics.
+		RTPStreamStatistics RTSPClient::getReceiverStatistics() const {
+			return private_->stream_.getStatistics();
+		}
+
+		/// Returns mapping of RTP timestamps of the current source to
+		/// wall clock.
+		/// \details Safe to call from any thread. The mapping is invalid
+		/// until the first sender report of the source.
+		/// \return Clock mapping of the last sender report.
+		RTCPClockMapping RTSPClient::getClockMapping() const {
+			return private_->senderClock_.getMapping();
+		}
+
+		/// Converts RTP timestamp of the current source to wall clock
+		/// time.
+		/// \details Safe to call from any thread. Uses the wall clock of the
+		/// sender, which is as accurate as the clock of the camera.
+		/// \param[in]	timestamp	RTP timestamp.
+		/// \return Time since the Unix epoch in nanoseconds, or -1 if no
+		/// sender report was received.
+		qint64 RTSPClient::getWallClock(quint32 timestamp) const {
+			return private_->senderClock_.toWallClock(timestamp);
+		}
+
+		/// Converts RTP timestamp of the current source to presentation
+		/// time.
+		/// \details Safe to call from any thread. Presentation time is
+		/// counted from the first timestamp of the source with the nominal
+		/// clock rate and never wraps around, sender restarts continue it.
+		/// \param[in]	timestamp	RTP timestamp.
+		/// \param[out]	time		Presentation time in nanoseconds.
+		/// \retval true on success.
+		/// \retval false if no packet was received or the clock rate is
+		/// unknown.
+		bool RTSPClient::getPresentationTime(quint32 timestamp,
+											 qint64& time) const {
+			auto clockRate = private_->stream_.getStatistics().clockRate_;
+			qint64 ticks;
+
+			if (clockRate <= 0 || !private_->timeline_.extend(timestamp, ticks))
+				return false;
+
+			time = ticks * 1000000000 / clockRate;
+			return true;
+		}
+
+		/// Converts RTP timestamp of the current source to receiver clock
+		/// time.
+		/// \details Safe to call from any thread. Shifts the wall clock time
+		/// of the sender by the offset of the monotonic clock measured with
+		/// sender reports, so times of sources whose clocks are not
+		/// synchronized compare directly.
+		/// \param[in]	timestamp	RTP timestamp.
+		/// \return Time of the monotonic clock in nanoseconds, or -1 if no
+		/// sender report was received.
+		qint64 RTSPClient::getReceiverClock(quint32 timestamp) const {
+			return private_->senderClock_.toReceiverClock(timestamp);
+		}
+
+		/// Returns timing of the last request of an RTSP method.
+		/// \details Taken from the RTSP context. Latency distributions of
+		/// all clients are kept by RTSPLatencyMonitor.
+		/// \param[in]	method	RTSP method.
+		/// \return Request timing.
+		RTSPRequestTiming RTSPClient::getRequestTiming(
+			RTSPMethod method) const {
+
+			return private_->context_.getRequestTiming(method);
+		}
+
+		/// Handles an event.
+		/// \details Resumes the client after a move to another thread.
+		/// \param[in]	event	Event.
+		/// \retval true if the event was handled.
+		/// \retval false if the event was not handled.
+		bool RTSPClient::event(QEvent* event) {
+			if (event->type() != ATTACH_EVENT) return QObject::event(event);
+
+			attach();
+
+			return true;
+		}
+
+		/// Performs an action when receiving RTP data.
+		/// \details Performs RTP packet processing and frame assembly. Qt
+		/// checks for, sizes and reads every datagram with a system call of
+		/// its own, so each datagram costs three of them. Datagrams are
+		/// read into pooled buffers, which takes no heap allocation once the
+		/// pool of the thread has grown.
+		void RTSPClient::onRTPDatagram() {
+			auto& pool = PacketBufferPool::shared();
+			auto& syscalls = private_->syscalls_;
+
+			while (private_->rtp_.hasPendingDatagrams()) {
+				auto buffer = pool.allocate(
+					static_cast<int>(private_->rtp_.pendingDatagramSize()));
+
+				auto size = private_->rtp_.readDatagram(buffer.getData(),
+														buffer.getSize());
+
+				increment(syscalls, quint64 { 3 });
+
+				if (size != buffer.getSize()) continue;
+
+				processRTPPacket(buffer.getData(), buffer.getSize());
+			}
+		}
+
+		/// Performs an action when receiving a batch of RTP data.
+		/// \details Receives up to a batch of datagrams per system call and
+		/// processes them in place. Stops when the socket is drained or after
+		/// a few batches, so other streams of the thread are not starved.
+		void RTSPClient::onRTPBatch() {
+			auto& receiver = private_->receiver_;
+			auto& syscalls = private_->syscalls_;
+
+			for (auto batch = 0; batch < MAX_BATCHES; ++batch) {
+				auto count = receiver.receive();
+
+				increment(syscalls);
+
+				for (auto i = 0; i < count; ++i)
+					processRTPPacket(receiver.getData(i), receiver.getSize(i));
+
+				if (count < DatagramReceiver::getBatchSize()) break;
+			}
+		}
+
+		/// Performs an action when receiving RTCP data.
+		/// \details Reads datagrams into pooled buffers and processes them.
+		/// If SETUP response did not announce the server RTCP port, reports
+		/// are sent to the sender of the first datagram.
+		void RTSPClient::onRTCPDatagram() {
+			auto& pool = PacketBufferPool::shared();
+			auto& p = *private_;
+
+			QHostAddress address;
+			quint16 port = 0;
+
+			while (p.rtcp_.hasPendingDatagrams()) {
+				auto buffer = pool.allocate(
+					static_cast<int>(p.rtcp_.pendingDatagramSize()));
+
+				auto size = p.rtcp_.readDatagram(buffer.getData(),
+												 buffer.getSize(),
+												 &address,
+												 &port);
+
+				if (size != buffer.getSize()) continue;
+
+				if (p.controlPort_ == 0) {
+					p.controlAddress_ = address;
+					p.controlPort_ = port;
+				}
+
+				processRTCPPacket(buffer.getData(), buffer.getSize());
+			}
+		}
+
+		/// Performs an action when receiving interleaved data.
+		/// \details Reads a chunk of the RTSP connection and processes the
+		/// interleaved packets it carried. While a request is in progress
+		/// the engine reads the connection. A failed read loses the
+		/// connection, which is signaled whether or not it is restored.
+		void RTSPClient::onInterleavedData() {
+			if (private_->context_.isPending()) return;
+
+			if (private_->context_.RECEIVE() != RTSPStatusCode::Ok) {
+				private_->notifier_->setEnabled(false);
+				connectionLost();
+				return;
+			}
+
+			processInterleaved();
+		}
+
+		/// Performs an action when a reconnect slot is granted.
+		/// \details Restores the session without blocking the thread and
+		/// returns the slot once the restore finishes. A failed attempt
+		/// doubles the backoff delay, a cancelled one ends the reconnect.
+		void RTSPClient::onReconnectGranted() {
+			auto& p = *private_;
+
+			RTSPReconnectPolicy::instance().confirm(this);
+
+			if (p.reconnect_ != RTSPClientPrivate::Reconnect::Waiting) return;
+
+			p.reconnect_ = RTSPClientPrivate::Reconnect::Restoring;
+
+			restoreSession([this](bool restored) {
+				auto& p = *private_;
+
+				RTSPReconnectPolicy::instance().release();
+
+				if (p.reconnect_ != RTSPClientPrivate::Reconnect::Restoring)
+					return;
+
+				p.reconnect_ = RTSPClientPrivate::Reconnect::Idle;
+
+				if (!restored) {
+					++p.attempt_;
+					scheduleReconnect();
+					return;
+				}
+
+				p.attempt_ = 0;
+				p.statistics_.recovery_ = p.lost_.nsecsElapsed();
+				++p.statistics_.reconnects_;
+
+				emit onReconnected(p.statistics_.recovery_);
+			});
+		}
+
+		/// Processes RTP packet.
+		/// \details Performs RTP packet processing and frame assembly. Only
+		/// a packet that parses as RTP counts as the first packet.
+		/// \param[in]	data	Packet data.
+		/// \param[in]	size	Packet size.
+		void RTSPClient::processRTPPacket(const char* data, int size) {
+			increment(private_->packets_);
+			increment(private_->bytes_, static_cast<quint64>(size));
+
+			auto arrival = private_->clock_.nsecsElapsed();
+			auto packet = RTPPacketView::parse(data, size);
+
+			if (!packet.isValid()) return;
+
+			updateReception(packet, arrival);
+
+			if (private_->statistics_.firstPacket_ < 0) {
+				private_->statistics_.firstPacket_ = arrival;
+
+				emit onFirstPacket(private_->statistics_.firstPacket_);
+			}
+		}
+
+		/// Updates reception statistics with an RTP packet.
+		/// \details A new synchronization source starts a new stream and
+		/// timeline and keeps the loss counted so far. Sender restarts are
+		/// handled by the stream and continue the timeline. Packets ignored
+		/// by the stream leave the timeline as it is. Retransmissions carry
+		/// the original sequence number in the first two bytes of their
+		/// payload and only fill gaps of the stream.
+		/// \param[in]	packet	RTP packet.
+		/// \param[in]	arrival	Arrival time in nanoseconds.
+		void RTSPClient::updateReception(const RTPPacketView& packet,
+										 qint64 arrival) {
+			auto& p = *private_;
+			auto& stream = p.stream_;
+
+			if (packet.getPayloadType() == p.retransmitType_) {
+				auto payload = packet.getPayloadData();
+
+				if (p.nacking_ && stream.isActive() && payload.size_ >= 2 &&
+					p.nacks_.recover(qFromBigEndian<quint16>(payload.data_),
+									 arrival) &&
+					p.videoType_ >= 0 &&
+					isKeyFrame(payload.data_ + 2, payload.size_ - 2, p.hevc_))
+					p.pictureLoss_.recover(arrival);
+				return;
+			}
+
+			auto source = packet.getSSRC();
+
+			if (!stream.isActive() || stream.getSSRC() != source) {
+				if (stream.isActive())
+					p.lostSources_.store(
+						p.lostSources_.load(std::memory_order_relaxed) +
+						stream.getStatistics().totalLost_,
+						std::memory_order_relaxed);
+
+				stream.reset(source, clockRate(p.context_.getSDP(),
+											   packet.getPayloadType()));
+				p.senderClock_.reset();
+				p.timeline_.reset();
+				p.nacks_.reset();
+				p.pictureLoss_.reset();
+			}
+
+			auto status = stream.update(packet.getSequenceNumber(),
+										packet.getTimestamp(),
+										arrival);
+
+			if (status == RTPStreamStatus::Valid)
+				p.timeline_.unwrap(packet.getTimestamp());
+			else if (status == RTPStreamStatus::Restarted) {
+				p.timeline_.restart(packet.getTimestamp());
+				p.nacks_.reset();
+				p.pictureLoss_.reset();
+			}
+			else return;
+
+			if (p.nacking_) {
+				p.nacks_.update(packet.getSequenceNumber(), arrival);
+				requestRetransmission(arrival);
+			}
+
+			updatePictureLoss(packet, arrival);
+		}
+
+		/// Processes RTCP packet.
+		/// \details Walks the compound packet. Sender reports of the current
+		/// source update its clock mapping, a goodbye of the source drops it.
+		/// Reports of sources that sent no RTP data yet are ignored, since
+		/// their clock rate is not known.
+		/// \param[in]	data	Packet data.
+		/// \param[in]	size	Packet size.
+		void RTSPClient::processRTCPPacket(const char* data, int size) {
+			auto& p = *private_;
+			auto& stream = p.stream_;
+
+			auto arrival = RTCPSenderClock::now();
+			auto packet = RTCPPacketView::parse(data, size);
+
+			if (!packet.isValid()) return;
+
+			p.controlReceived_ = true;
+			p.interval_.update(size);
+
+			if (!stream.isActive()) return;
+
+			for (; packet.isValid(); packet = packet.next()) {
+				switch (packet.getPacketType()) {
+					case RTCPPacketType::SenderReport: {
+						if (packet.getSSRC() != stream.getSSRC()) break;
+
+						auto sender = packet.getSenderInfo();
+
+						p.senderClock_.update(stream.getSSRC(),
+											  stream.getClockRate(),
+											  sender.ntpTimestamp_,
+											  sender.rtpTimestamp_,
+											  arrival);
+
+						increment(p.senderReports_);
+						break;
+					}
+
+					case RTCPPacketType::Goodbye:
+						for (auto i = 0; i < packet.getSourceCount(); ++i)
+							if (packet.getSource(i) == stream.getSSRC())
+								p.senderClock_.reset();
+						break;
+
+					default:
+						break;
+				}
+			}
+		}
+
+		/// Sends an RTCP compound packet to the server.
+		/// \details Sends through the shared receiver in shared receive mode,
+		/// otherwise from the RTCP socket of the session, so the server sees
+		/// the port it was given by SETUP request.
+		/// \param[in]	data	RTCP compound packet.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool RTSPClient::sendControl(const QByteArray& data) {
+			auto& p = *private_;
+
+			if (p.shared_)
+				return RTSPSharedReceiver::shared().send(
+					this, p.controlPort_, data);
+
+			if (p.controlPort_ == 0 || p.controlAddress_.isNull() ||
+				p.rtcp_.state() != QAbstractSocket::BoundState)
+				return false;
+
+			return p.rtcp_.writeDatagram(data,
+										 p.controlAddress_,
+										 p.controlPort_) == data.size();
+		}
+
+		/// Starts sending receiver reports.
+		/// \details Reports go to the server RTCP port announced by SETUP
+		/// response. The first one is sent after half the usual interval.
+		/// In retransmission mode the response time of SETUP request stands
+		/// in for the round-trip time until retransmissions measure it.
+		void RTSPClient::startReports() {
+			auto& p = *private_;
+			auto& context = p.context_;
+
+			p.controlAddress_ = context.getServerAddress();
+			p.controlPort_ = context.getServerPorts().second;
+			p.bandwidth_ = sessionBandwidth(context.getSDP());
+			p.reportBytes_ = p.bytes_.load(std::memory_order_relaxed);
+			p.reportTime_ = p.clock_.nsecsElapsed();
+			p.controlReceived_ = false;
+			p.reportSent_ = false;
+			p.reporting_ = true;
+			p.retransmitType_ = retransmissionType(context.getSDP());
+			p.nacking_ = p.retransmission_ && !p.shared_;
+			p.feedbackTime_ = 0;
+			p.requesting_ = p.keyFrameRequest_;
+			p.videoType_ = videoType(context.getSDP(), p.hevc_);
+			p.pictureLoss_.reset();
+			p.pictureLoss_.setRepeat(p.videoType_ >= 0);
+
+			auto timing = context.getRequestTiming(RTSPMethod::Setup);
+			auto response = timing.firstByte_ -
+							std::max<qint64>(timing.connect_, 0);
+
+			if (timing.firstByte_ > 0) p.nacks_.setRoundTrip(response * 1000);
+
+			p.interval_.reset();
+			p.interval_.setBandwidth(p.bandwidth_);
+
+			scheduleReport();
+		}
+
+		/// Schedules the next receiver report.
+		/// \details The interval follows the rules of RFC 3550, so reports
+		/// take a small share of the session bandwidth.
+		void RTSPClient::scheduleReport() {
+			auto& scheduler = RTSPKeepAliveScheduler::shared();
+
+			scheduler.cancel(private_->report_);
+
+			private_->report_ = scheduler.schedule(
+				private_->interval_.next(),
+				[this]() {
+					private_->report_ = 0;
+
+					sendReport(false);
+					scheduleReport();
+				});
+		}
+
+		/// Sends receiver report.
+		/// \details Sends a receiver report with a block for the current
+		/// source once it sent RTP data, and a source description. Closes the
+		/// loss interval of the source. Without announced bandwidth the
+		/// interval is scaled by the bitrate received since the previous
+		/// report.
+		/// \param[in]	goodbye	Whether the receiver leaves the session.
+		void RTSPClient::sendReport(bool goodbye) {
+			auto& p = *private_;
+			auto& stream = p.stream_;
+
+			auto now = p.clock_.nsecsElapsed();
+			auto bytes = p.bytes_.load(std::memory_order_relaxed);
+
+			RTCPReportBlock report;
+			auto count = 0;
+
+			if (stream.isActive()) {
+				stream.updateFractionLost();
+
+				auto statistics = stream.getStatistics();
+
+				report.source_ = statistics.source_;
+				report.fractionLost_ = statistics.fractionLost_;
+				report.totalLost_ = static_cast<qint32>(
+					qBound<qint64>(-0x800000, statistics.lost_, 0x7FFFFF));
+				report.extendedMaximum_ = statistics.extendedMaximum_;
+				report.jitter_ = statistics.jitter_;
+				report.lastReport_ = p.senderClock_.getLastReport();
+				report.delay_ =
+					p.senderClock_.getDelay(RTCPSenderClock::now());
+
+				count = 1;
+			}
+
+			RTCPCompoundWriter writer;
+			writer.appendReceiverReport(p.localSource_, &report, count);
+			writer.appendSourceDescription(p.localSource_, p.localName_);
+
+			if (goodbye) writer.appendGoodbye(p.localSource_);
+
+			if (p.bandwidth_ == 0 && now > p.reportTime_) {
+				auto bits = static_cast<double>(bytes - p.reportBytes_) * 8;
+
+				p.interval_.setBandwidth(static_cast<qint64>(
+					bits * 1e9 / (now - p.reportTime_)));
+			}
+
+			p.interval_.setMembers(2, count);
+			p.reportBytes_ = bytes;
+			p.reportTime_ = now;
+
+			if (!sendControl(writer.getData())) return;
+
+			p.interval_.update(writer.getData().size());
+			p.reportSent_ = true;
+
+			increment(p.receiverReports_);
+		}
+
+		/// Requests retransmission of lost packets that are due.
+		/// \details Sends a compound packet with an empty receiver report, a
+		/// source description and a generic negative acknowledgement, as
+		/// RFC 4585 allows. Feedback packets are at least ten milliseconds
+		/// apart and request a bounded number of packets, the rest wait for
+		/// the next one.
+		/// \param[in]	now	Current time in nanoseconds.
+		void RTSPClient::requestRetransmission(qint64 now) {
+			auto& p = *private_;
+			auto deadline = p.nacks_.getDeadline();
+
+			if (deadline >= 0 && deadline <= now &&
+				now - p.feedbackTime_ >= FEEDBACK_INTERVAL) {
+
+				quint16 sequences[MAX_NACKS];
+				auto count = p.nacks_.collect(now, sequences, MAX_NACKS);
+
+				if (count > 0) {
+					RTCPCompoundWriter writer;
+					writer.appendReceiverReport(p.localSource_, nullptr, 0);
+					writer.appendSourceDescription(p.localSource_,
+												   p.localName_);
+					writer.appendGenericNack(p.localSource_,
+											 p.stream_.getSSRC(),
+											 sequences, count);
+
+					if (sendControl(writer.getData()))
+						p.interval_.update(writer.getData().size());
+
+					p.feedbackTime_ = now;
+				}
+			}
+
+			scheduleRetransmission();
+		}
+
+		/// Schedules retransmission requests while no packets arrive.
+		/// \details Arriving packets send requests that are due, so the
+		/// coarse deadline of the shared scheduler only matters when the
+		/// stream stalls.
+		void RTSPClient::scheduleRetransmission() {
+			auto& p = *private_;
+			auto deadline = p.nacks_.getDeadline();
+
+			if (p.retransmit_ != 0 || deadline < 0) return;
+
+			auto delay = (deadline - p.clock_.nsecsElapsed()) / 1000000;
+
+			p.retransmit_ = RTSPKeepAliveScheduler::shared().schedule(
+				std::max<qint64>(delay, 0),
+				[this]() {
+					private_->retransmit_ = 0;
+
+					requestRetransmission(private_->clock_.nsecsElapsed());
+				});
+		}
+
+		/// Updates key frame request state with an RTP packet.
+		/// \details A key frame of the video ends a loss. Packets lost for
+		/// good break the video: the ones given up by retransmission, or
+		/// without retransmission the ones still missing once reordering
+		/// had its time. Does nothing unless key frames are requested, and
+		/// reads the counters of the receiving thread directly.
+		/// \param[in]	packet	RTP packet.
+		/// \param[in]	arrival	Arrival time in nanoseconds.
+		void RTSPClient::updatePictureLoss(const RTPPacketView& packet,
+										   qint64 arrival) {
+			auto& p = *private_;
+
+			if (p.requesting_ == RTSPKeyFrameRequest::None) return;
+
+			if (packet.getPayloadType() == p.videoType_) {
+				auto payload = packet.getPayloadData();
+
+				if (isKeyFrame(payload.data_, payload.size_, p.hevc_))
+					p.pictureLoss_.recover(arrival);
+			}
+
+			p.pictureLoss_.update(
+				p.nacking_
+				? static_cast<qint64>(p.nacks_.getUnrecovered())
+				: p.stream_.getLost(),
+				arrival);
+
+			sendKeyFrameRequest(arrival);
+		}
+
+		/// Sends key frame request if it is due.
+		/// \details Sends a compound packet with an empty receiver report, a
+		/// source description and a picture loss indication or a full intra
+		/// request for the current source. Requests of a stream are spaced
+		/// by twice the round-trip time and half a second at least, and are
+		/// repeated while H.264 or H.265 key frames do not answer them.
+		/// \param[in]	now	Current time in nanoseconds.
+		void RTSPClient::sendKeyFrameRequest(qint64 now) {
+			auto& p = *private_;
+			auto deadline = p.pictureLoss_.getDeadline();
+
+			if (p.requesting_ != RTSPKeyFrameRequest::None &&
+				deadline >= 0 && deadline <= now && p.stream_.isActive()) {
+
+				p.pictureLoss_.setRoundTrip(p.nacks_.getRoundTrip());
+
+				if (p.pictureLoss_.collect(now)) {
+					RTCPCompoundWriter writer;
+					writer.appendReceiverReport(p.localSource_, nullptr, 0);
+					writer.appendSourceDescription(p.localSource_,
+												   p.localName_);
+
+					if (p.requesting_ ==
+						RTSPKeyFrameRequest::FullIntraRequest)
+						writer.appendFullIntraRequest(
+							p.localSource_, p.stream_.getSSRC(),
+							p.pictureLoss_.getSequence());
+					else
+						writer.appendPictureLoss(p.localSource_,
+												 p.stream_.getSSRC());
+
+					if (sendControl(writer.getData()))
+						p.interval_.update(writer.getData().size());
+				}
+			}
+
+			scheduleKeyFrameRequest();
+		}
+
+		/// Schedules key frame request while no packets arrive.
+		/// \details Arriving packets send requests that are due, the coarse
+		/// deadline of the shared scheduler covers a stalled stream.
+		void RTSPClient::scheduleKeyFrameRequest() {
+			auto& p = *private_;
+			auto deadline = p.pictureLoss_.getDeadline();
+
+			if (p.requesting_ == RTSPKeyFrameRequest::None ||
+				p.keyFrame_ != 0 || deadline < 0)
+				return;
+
+			auto delay = (deadline - p.clock_.nsecsElapsed()) / 1000000;
+
+			p.keyFrame_ = RTSPKeepAliveScheduler::shared().schedule(
+				std::max<qint64>(delay, 0),
+				[this]() {
+					private_->keyFrame_ = 0;
+
+					sendKeyFrameRequest(private_->clock_.nsecsElapsed());
+				});
+		}
+
+		/// Processes packets stored in interleaved channel buffers.
+		/// \details Packets are processed in place and released afterwards.
+		void RTSPClient::processInterleaved() {
+			if (private_->transport_ != RTSPTransport::TCP ||
+				!private_->interleaved_)
+				return;
+
+			auto& demuxer = private_->context_.getDemuxer();
+
+			auto rtp = demuxer.getChannelBuffer(
+				static_cast<quint8>(private_->channels_.first));
+
+			auto rtcp = demuxer.getChannelBuffer(
+				static_cast<quint8>(private_->channels_.second));
+
+			const char* data = nullptr;
+			auto size = 0;
+
+			while (rtp && rtp->peek(&data, &size)) {
+				processRTPPacket(data, size);
+				rtp->release();
+			}
+
+			while (rtcp && rtcp->peek(&data, &size)) {
+				processRTCPPacket(data, size);
+				rtcp->release();
+			}
+		}
+
+		/// Sends SETUP request and starts receiving the media stream.
+		/// \details Sends blocking SETUP request and attaches the stream. In
+		/// shared receive mode the ports of the shared receiver are requested
+		/// instead of the given ones.
+		/// \param[in]	path	Media stream path.
+		/// \param[in]	ports	Ports for receiving RTP and RTCP data.
+		/// \return RTSP status code of SETUP request, or error if the stream
+		/// could not be received.
+		RTSPStatusCode RTSPClient::startStream(
+			const QUrl& path,
+			const QPair<quint16, quint16>& ports) {
+
+			if (!path.isValid()) return RTSPStatusCode::Error;
+
+			private_->context_.setTransport(private_->transport_);
+
+			auto local = streamPorts(ports);
+
+			auto status = private_->context_.SETUP(path.toEncoded(), local);
+			if (status != RTSPStatusCode::Ok) return status;
+
+			return attachStream(local)
+				   ? RTSPStatusCode::Ok
+				   : RTSPStatusCode::Error;
+		}
+
+		/// Sends SETUP request and starts receiving the media stream
+		/// without blocking.
+		/// \details Queues SETUP request and attaches the stream once it
+		/// succeeds. In shared receive mode the ports of the shared receiver
+		/// are requested instead of the given ones.
+		/// \param[in]	path		Media stream path.
+		/// \param[in]	ports		Ports for receiving RTP and RTCP data.
+		/// \param[in]	completion	Completion callback, called with RTSP
+		///							status code of SETUP request, or error if
+		///							the stream could not be received.
+		void RTSPClient::startStream(const QUrl& path,
+									 const QPair<quint16, quint16>& ports,
+									 const completion_t& completion) {
+
+			if (!path.isValid()) {
+				completion(RTSPStatusCode::Error);
+				return;
+			}
+
+			private_->context_.setTransport(private_->transport_);
+
+			auto local = streamPorts(ports);
+
+			submit([this, path, local](const completion_t& completion) {
+				return private_->context_.SETUP(path.toEncoded(),
+												local,
+												completion);
+			}, [this, local, completion](RTSPStatusCode status) {
+				if (status == RTSPStatusCode::Ok && !attachStream(local))
+					status = RTSPStatusCode::Error;
+
+				completion(status);
+			});
+		}
+
+		/// Returns ports requested by the next setup.
+		/// \details Opens the shared receiver of the thread on first use. If
+		/// it fails to open, the session falls back to its own sockets.
+		/// \param[in]	ports	Ports for receiving RTP and RTCP data.
+		/// \return Ports of the shared receiver in shared receive mode,
+		/// otherwise the given ports.
+		QPair<quint16, quint16> RTSPClient::streamPorts(
+			const QPair<quint16, quint16>& ports) {
+
+			if (private_->transport_ != RTSPTransport::UDP ||
+				!private_->sharedReceive_ || !RTSPSharedReceiver::isSupported())
+				return ports;
+
+			auto& receiver = RTSPSharedReceiver::shared();
+
+			return receiver.open() ? receiver.getPorts() : ports;
+		}
+
+		/// Starts receiving the media stream that is set up.
+		/// \details Binds RTP and RTCP sockets, or installs interleaved
+		/// channel buffers with TCP transport, and schedules keep-alive. In
+		/// shared receive mode the session is registered with the shared
+		/// receiver by the RTSP server address and the SSRC announced by
+		/// SETUP response.
+		/// \param[in]	ports	Ports for receiving RTP and RTCP data.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool RTSPClient::attachStream(const QPair<quint16, quint16>& ports) {
+			if (private_->transport_ == RTSPTransport::TCP) {
+				auto socket = private_->context_.getSocket();
+
+				if (socket < 0 || ports.first > 0xFF || ports.second > 0xFF)
+					return false;
+
+				auto& demuxer = private_->context_.getDemuxer();
+
+				demuxer.setChannelBuffer(
+					static_cast<quint8>(ports.first),
+					private_->interleavedBufferSize_);
+
+				demuxer.setChannelBuffer(
+					static_cast<quint8>(ports.second),
+					INTERLEAVED_CONTROL_BUFFER_SIZE);
+
+				private_->channels_ = ports;
+				private_->interleaved_ = true;
+
+				if (private_->backend_ == RTSPBackend::Native)
+					private_->context_.setReceiveHandler(
+						[this]() { processInterleaved(); });
+				else watchConnection(socket);
+
+				scheduleKeepAlive();
+
+				return true;
+			}
+
+			if (private_->sharedReceive_ && RTSPSharedReceiver::isSupported()) {
+				auto& receiver = RTSPSharedReceiver::shared();
+
+				if (receiver.isOpen() && ports == receiver.getPorts()) {
+					auto& context = private_->context_;
+
+					if (!receiver.add(this, context.getSocket(),
+									  context.getSSRC()))
+						return false;
+
+					private_->shared_ = true;
+
+					scheduleKeepAlive();
+					startReports();
+
+					return true;
+				}
+			}
+
+			QHostAddress address(QHostAddress::AnyIPv4);
+
+			if (private_->batchReceive_ && DatagramReceiver::isSupported()) {
+				if (!private_->receiver_.open(ports.first) ||
+					!private_->rtcp_.bind(address, ports.second))
+					return false;
+
+				watchReceiver();
+			}
+			else {
+				if (!private_->rtp_.bind(address, ports.first) ||
+					!private_->rtcp_.bind(address, ports.second))
+					return false;
+
+				connect(
+					&private_->rtp_,
+					SIGNAL(readyRead()),
+					SLOT(onRTPDatagram())
+				);
+			}
+
+			connect(
+				&private_->rtcp_,
+				SIGNAL(readyRead()),
+				SLOT(onRTCPDatagram())
+			);
+
+			scheduleKeepAlive();
+			startReports();
+
+			return true;
+		}
+
+		/// Stops receiving the media stream without TEARDOWN request.
+		/// \details Cancels keep-alive, sends the last receiver report with a
+		/// goodbye, closes sockets, leaves the shared receiver and releases
+		/// interleaved channel buffers. The notifier is deleted later, since
+		/// the stream may be stopped from its own signal.
+		void RTSPClient::stopStream() {
+			RTSPKeepAliveScheduler::shared().cancel(private_->keepAlive_);
+			private_->keepAlive_ = 0;
+
+			if (private_->reporting_) {
+				RTSPKeepAliveScheduler::shared().cancel(private_->report_);
+				private_->report_ = 0;
+				private_->reporting_ = false;
+
+				sendReport(true);
+			}
+
+			RTSPKeepAliveScheduler::shared().cancel(private_->retransmit_);
+			private_->retransmit_ = 0;
+			private_->nacking_ = false;
+			private_->nacks_.reset();
+
+			RTSPKeepAliveScheduler::shared().cancel(private_->keyFrame_);
+			private_->keyFrame_ = 0;
+			private_->requesting_ = RTSPKeyFrameRequest::None;
+			private_->pictureLoss_.reset();
+
+			if (private_->shared_) {
+				RTSPSharedReceiver::shared().remove(this);
+				private_->shared_ = false;
+			}
+
+			if (private_->notifier_)
+				private_->notifier_.take()->deleteLater();
+
+			if (private_->rtpNotifier_)
+				private_->rtpNotifier_.take()->deleteLater();
+
+			private_->receiver_.close();
+
+			private_->interleaved_ = false;
+			private_->context_.setReceiveHandler(nullptr);
+
+			auto& demuxer = private_->context_.getDemuxer();
+			demuxer.setChannelBuffer(
+				static_cast<quint8>(private_->channels_.first), 0);
+			demuxer.setChannelBuffer(
+				static_cast<quint8>(private_->channels_.second), 0);
+			demuxer.reset();
+
+			private_->rtp_.disconnect();
+			private_->rtp_.close();
+
+			private_->rtcp_.disconnect();
+			private_->rtcp_.close();
+		}
+
+		/// Watches RTSP connection for interleaved data.
+		/// \details The libcurl backend does not read the connection between
+		/// requests, so a notifier triggers reading.
+		/// \param[in]	socket	Socket descriptor.
+		void RTSPClient::watchConnection(qintptr socket) {
+			private_->notifier_.reset(
+				new QSocketNotifier(socket, QSocketNotifier::Read));
+
+			connect(
+				private_->notifier_.data(),
+				SIGNAL(activated(int)),
+				SLOT(onInterleavedData())
+			);
+		}
+
+		/// Watches the batched receiver for RTP data.
+		/// \details Qt sockets are bypassed, since reading their descriptor
+		/// directly would stall their own notifiers.
+		void RTSPClient::watchReceiver() {
+			private_->rtpNotifier_.reset(new QSocketNotifier(
+				private_->receiver_.getDescriptor(), QSocketNotifier::Read));
+
+			connect(
+				private_->rtpNotifier_.data(),
+				SIGNAL(activated(int)),
+				SLOT(onRTPBatch())
+			);
+		}
+
+		/// Moves the client to another thread.
+		/// \details Must be called from the owning thread between requests
+		/// and outside of reconnect. Sessions of the shared receiver stay,
+		/// since the server sends to the ports of the thread. Deadlines of
+		/// the shared scheduler and the notifier belong to the thread, they
+		/// are dropped here and restored by attach() on the target thread.
+		/// \param[in]	thread	Target thread.
+		/// \retval true on success.
+		/// \retval false if the client is busy or bound to its thread.
+		bool RTSPClient::detach(QThread* thread) {
+			auto& p = *private_;
+
+			if (p.busy_ || p.shared_ || !p.requests_.isEmpty()			||
+				p.reconnect_ != RTSPClientPrivate::Reconnect::Idle		||
+				!p.context_.detach(thread))
+				return false;
+
+			RTSPKeepAliveScheduler::shared().cancel(p.keepAlive_);
+			p.keepAlive_ = 0;
+			RTSPKeepAliveScheduler::shared().cancel(p.report_);
+			p.report_ = 0;
+			RTSPKeepAliveScheduler::shared().cancel(p.retransmit_);
+			p.retransmit_ = 0;
+			RTSPKeepAliveScheduler::shared().cancel(p.keyFrame_);
+			p.keyFrame_ = 0;
+			p.notifier_.reset();
+			p.rtpNotifier_.reset();
+
+			moveToThread(thread);
+
+			QCoreApplication::postEvent(this, new QEvent(ATTACH_EVENT),
+										Qt::HighEventPriority);
+
+			return true;
+		}
+
+		/// Resumes the client on the thread it was moved to.
+		/// \details Switches the RTSP context to the engine of the thread,
+		/// watches the connection again and schedules keep-alive of a set
+		/// up session on the timing wheel of the thread.
+		void RTSPClient::attach() {
+			auto& p = *private_;
+			auto& context = p.context_;
+
+			context.attach(&RTSPClientEngine::shared());
+
+			if (p.interleaved_ && context.getBackend() == RTSPBackend::Curl &&
+				context.getSocket() >= 0)
+				watchConnection(context.getSocket());
+
+			if (p.receiver_.isOpen()) watchReceiver();
+
+			if (p.setUp_) scheduleKeepAlive();
+
+			if (p.reporting_) scheduleReport();
+
+			if (p.nacking_) scheduleRetransmission();
+
+			scheduleKeyFrameRequest();
+		}
+
+		/// Schedules the next keep-alive request.
+		/// \details Keep-alive deadlines of all clients of the thread share
+		/// one timing wheel and follow the session timeout of the server.
+		void RTSPClient::scheduleKeepAlive() {
+			auto& scheduler = RTSPKeepAliveScheduler::shared();
+
+			scheduler.cancel(private_->keepAlive_);
+
+			private_->keepAlive_ = scheduler.scheduleKeepAlive(
+				private_->context_.getSessionTimeout(),
+				[this]() { keepAlive(); });
+		}
+
+		/// Sends keep-alive request.
+		/// \details Queues GET_PARAMETER if the server advertised it, OPTIONS
+		/// otherwise, so keep-alive never blocks the thread. A failed request
+		/// or an expired session means the connection is lost. In RTCP
+		/// keep-alive mode the request is skipped while reports are
+		/// exchanged with the server.
+		void RTSPClient::keepAlive() {
+			auto& p = *private_;
+			auto exchanged = p.controlReceived_ && p.reportSent_;
+
+			p.keepAlive_ = 0;
+			p.controlReceived_ = false;
+			p.reportSent_ = false;
+
+			if (p.reportKeepAlive_ && exchanged) {
+				scheduleKeepAlive();
+				return;
+			}
+
+			auto parameter =
+				private_->context_.isSupported(RTSPMethod::GetParameter);
+
+			submit([this, parameter](const completion_t& completion) {
+				return parameter
+					   ? private_->context_.GET_PARAMETER(completion)
+					   : private_->context_.OPTIONS(completion);
+			}, [this](RTSPStatusCode status) {
+				if (!private_->cancelling_					&&
+					(status == RTSPStatusCode::Error ||
+					 status == RTSPStatusCode::SessionNotFound)) {
+					connectionLost();
+					return;
+				}
+
+				processInterleaved();
+				scheduleKeepAlive();
+			});
+		}
+
+		/// Handles a lost connection.
+		/// \details Stops the media stream without TEARDOWN request and
+		/// signals the loss. With automatic reconnect enabled, keeps the
+		/// session state for the restore and schedules the first attempt,
+		/// otherwise the session ends.
+		void RTSPClient::connectionLost() {
+			auto& p = *private_;
+
+			if (!p.setUp_ || p.reconnect_ != RTSPClientPrivate::Reconnect::Idle)
+				return;
+
+			auto restore = p.autoReconnect_;
+
+			stopStream();
+
+			if (!restore) {
+				p.setUp_ = false;
+				p.playing_ = false;
+			}
+
+			emit onDisconnected();
+
+			if (!restore) return;
+
+			p.attempt_ = 0;
+			p.lost_.start();
+
+			scheduleReconnect();
+		}
+
+		/// Schedules the next reconnect attempt.
+		/// \details Waits for the backoff delay and then for a reconnect slot
+		/// of the process-wide policy, which bounds the connection rate seen
+		/// by a recovering server.
+		void RTSPClient::scheduleReconnect() {
+			auto& p = *private_;
+
+			p.reconnect_ = RTSPClientPrivate::Reconnect::Backoff;
+
+			p.backoff_ = RTSPKeepAliveScheduler::shared().schedule(
+				RTSPReconnectPolicy::instance().getDelay(p.attempt_),
+				[this]() {
+					private_->backoff_ = 0;
+					private_->reconnect_ =
+						RTSPClientPrivate::Reconnect::Waiting;
+
+					RTSPReconnectPolicy::instance().acquire(
+						this, "onReconnectGranted");
+				});
+		}
+
+		/// Cancels reconnect in progress.
+		/// \details Cancels the backoff deadline, withdraws the request for
+		/// a reconnect slot or fails the requests of the restore, which
+		/// returns the slot.
+		void RTSPClient::cancelReconnect() {
+			auto& p = *private_;
+
+			switch (p.reconnect_) {
+				case RTSPClientPrivate::Reconnect::Backoff:
+					RTSPKeepAliveScheduler::shared().cancel(p.backoff_);
+					p.backoff_ = 0;
+					break;
+
+				case RTSPClientPrivate::Reconnect::Waiting:
+					RTSPReconnectPolicy::instance().cancel(this);
+					break;
+
+				case RTSPClientPrivate::Reconnect::Restoring:
+					p.reconnect_ = RTSPClientPrivate::Reconnect::Idle;
+					cancelPending();
+					break;
+
+				case RTSPClientPrivate::Reconnect::Idle:
+					break;
+			}
+
+			p.reconnect_ = RTSPClientPrivate::Reconnect::Idle;
+		}
+
+		/// Restores the session on a new connection without blocking.
+		/// \details Reuses the cached session description and supported
+		/// methods, so only SETUP and PLAY requests are sent. If the server
+		/// answers SETUP with an error, the cached state is dropped and the
+		/// session is brought up from OPTIONS again. An unreachable server
+		/// keeps the cache for the next attempt. Requests are queued like
+		/// the ones of asynchronous operations, so other sessions of the
+		/// thread are served while the server answers. A failed or
+		/// cancelled restore stops the stream.
+		/// \param[in]	callback	Completion callback.
+		void RTSPClient::restoreSession(const callback_t& callback) {
+			auto& p = *private_;
+
+			cancelPending();
+
+			if (!p.context_.reconnect()) {
+				callback(false);
+				return;
+			}
+
+			auto done = [this, callback](bool restored) {
+				if (!restored) stopStream();
+
+				callback(restored);
+			};
+
+			auto play = [this, done]() {
+				if (!private_->playing_) {
+					done(true);
+					return;
+				}
+
+				submit([this](const completion_t& completion) {
+					return private_->context_.PLAY(completion);
+				}, [this, done](RTSPStatusCode status) {
+					done(!private_->cancelling_ &&
+						 status == RTSPStatusCode::Ok);
+				});
+			};
+
+			auto restart = [this, done, play]() {
+				stopStream();
+
+				if (!private_->context_.reconnect(false)) {
+					done(false);
+					return;
+				}
+
+				auto setUp = [this, done, play]() {
+					startStream(
+						private_->path_,
+						private_->ports_,
+						[this, done, play](RTSPStatusCode status) {
+							if (private_->cancelling_ ||
+								status != RTSPStatusCode::Ok)
+								done(false);
+							else play();
+						});
+				};
+
+				auto describe = [this, done, setUp]() {
+					submit([this](const completion_t& completion) {
+						return private_->context_.DESCRIBE(completion);
+					}, [this, done, setUp](RTSPStatusCode status) {
+						if (private_->cancelling_ ||
+							status != RTSPStatusCode::Ok)
+							done(false);
+						else setUp();
+					});
+				};
+
+				if (private_->fastStart_) {
+					describe();
+					return;
+				}
+
+				submit([this](const completion_t& completion) {
+					return private_->context_.OPTIONS(completion);
+				}, [this, done, describe](RTSPStatusCode status) {
+					if (private_->cancelling_ ||
+						status != RTSPStatusCode::Ok)
+						done(false);
+					else describe();
+				});
+			};
+
+			if (p.context_.getSDP().isEmpty()) {
+				restart();
+				return;
+			}
+
+			startStream(
+				p.path_,
+				p.ports_,
+				[this, done, play, restart](RTSPStatusCode status) {
+					if (private_->cancelling_ ||
+						status == RTSPStatusCode::Error)
+						done(false);
+					else if (status != RTSPStatusCode::Ok) restart();
+					else play();
+				});
+		}
+
+		/// Opens the RTSP context for a new session.
+		/// \details Resets statistics and applies client settings. Requests
+		/// of the libcurl backend run through the engine of the calling
+		/// thread.
+		/// \param[in]	url	RTSP connection URL.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool RTSPClient::openContext(const QUrl& url) {
+			auto& context = private_->context_;
+
+			private_->statistics_ = { };
+			private_->clock_.start();
+
+			context.setBackend(private_->backend_);
+			context.setEngine(&RTSPClientEngine::shared());
+
+			//private_->context_.setUserAgent("RTSPClient");
+			//private_->context_.setCredentials({"admin", "741852369"});
+
+			if (!url.isValid() || !context.open(url.toEncoded()))
+				return false;
+
+			context.setFastStart(private_->fastStart_);
+			context.setTimeouts(private_->timeouts_);
+
+			return true;
+		}
+
+		/// Queues a non-blocking request.
+		/// \details Requests run one after another, since the libcurl
+		/// backend keeps a single request in flight. Requests of both
+		/// backends are limited by the operation timeout, so a server that
+		/// stops answering fails the request instead of stalling the
+		/// queue.
+		/// \param[in]	request		Request starter.
+		/// \param[in]	completion	Completion callback.
+		void RTSPClient::submit(const request_t& request,
+								const completion_t& completion) {
+
+			private_->requests_.enqueue({ request, completion });
+			next();
+		}
+
+		/// Starts the next queued request.
+		/// \details A request that fails to start is finished with error
+		/// status at once.
+		void RTSPClient::next() {
+			auto& p = *private_;
+
+			if (p.busy_ || p.requests_.isEmpty()) return;
+
+			auto request = p.requests_.dequeue();
+			auto generation = p.generation_;
+
+			p.busy_ = true;
+			p.current_ = request.completion_;
+
+			auto started = request.start_(
+				[this, generation](RTSPStatusCode status) {
+					if (private_->generation_ == generation) finish(status);
+				});
+
+			if (!started && p.busy_ && p.generation_ == generation)
+				finish(RTSPStatusCode::Error);
+		}
+
+		/// Finishes the request in progress.
+		/// \details Calls its completion callback and starts the next one.
+		/// \param[in]	status	RTSP status code.
+		void RTSPClient::finish(RTSPStatusCode status) {
+			auto& p = *private_;
+
+			auto completion = std::move(p.current_);
+			p.current_ = nullptr;
+			p.busy_ = false;
+			++p.generation_;
+
+			if (completion) completion(status);
+
+			next();
+		}
+
+		/// Fails queued requests and the request in progress.
+		/// \details Lets blocking operations use the RTSP context. Cancelled
+		/// operations report failure without touching the session. A
+		/// request of the native backend stays on the connection, its
+		/// response is ignored.
+		void RTSPClient::cancelPending() {
+			auto& p = *private_;
+
+			if (!p.busy_ && p.requests_.isEmpty()) return;
+
+			p.context_.cancel();
+
+			auto current = std::move(p.current_);
+			auto requests = std::move(p.requests_);
+
+			p.current_ = nullptr;
+			p.requests_.clear();
+			p.busy_ = false;
+			++p.generation_;
+
+			p.cancelling_ = true;
+
+			if (current) current(RTSPStatusCode::Error);
+
+			for (const auto& request : requests)
+				if (request.completion_)
+					request.completion_(RTSPStatusCode::Error);
+
+			p.cancelling_ = false;
 
+			next();
 		}
 	}
 }
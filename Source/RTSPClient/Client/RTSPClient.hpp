@@ -7,6 +7,16 @@
 #define RTSPCLIENT_HPP
 
 #include "RTSPConnectionParameters.hpp"
+#include "RTSPSessionStatistics.hpp"
+#include "RTSPStreamStatistics.hpp"
+#include "Protocols/RTCP/RTCPSenderClock.hpp"
+#include "Protocols/RTP/RTPStream.hpp"
+#include "Protocols/RTSP/AbstractRTSPClient.hpp"
+#include "Protocols/RTSP/RTSPRequestTiming.hpp"
+
+#include <QFuture>
+
+#include <functional>
 
 /// Contains classes and functions that implement Real Time Streaming Protocol
 /// (RTSP) library.
@@ -16,11 +26,44 @@ namespace RTSPLib {
 	/// Protocol (RTSP) client library.
 	namespace RTSPClient {
 
+		class RTPPacketView;
+
+		/// Enumeration that defines key frame requests of broken video.
+		enum class RTSPKeyFrameRequest {
+
+			/// Key frames are not requested.
+			None,
+
+			/// Picture loss indication of RFC 4585.
+			/// \details Asks the sender for a key frame, most cameras
+			/// support it.
+			PictureLoss,
+
+			/// Full intra request of RFC 5104.
+			/// \details Orders the sender to send a key frame.
+			FullIntraRequest
+		};
+
 		/// Class that provides RTP camera implementation.
+		/// \details Every operation has a blocking form and an asynchronous
+		/// form. Asynchronous operations run on the event loop of the owning
+		/// thread and return at once, so one thread can drive many clients.
+		/// Keep-alive and automatic reconnect use the same requests, and
+		/// every request is limited by the operation timeout. Blocking
+		/// operations supersede asynchronous ones in progress.
 		class RTSPCLIENT_EXPORT RTSPClient : public QObject {
 
 			Q_OBJECT
 
+			friend class RTSPClientPool;
+
+			friend class RTSPSharedReceiver;
+
+		public:
+
+			/// Completion callback type of asynchronous operations.
+			using callback_t = std::function<void(bool)>;
+
 		public:
 
 			/// Default constructor.
@@ -63,31 +106,395 @@ namespace RTSPLib {
 			/// \retval false on error.
 			bool pause();
 
+			/// Opens the session without blocking.
+			/// \param[in]	url			RTSP connection URL.
+			/// \param[in]	callback	Completion callback.
+			/// \return Future of the operation result.
+			QFuture<bool> openAsync(const QUrl& url,
+									const callback_t& callback = nullptr);
+
+			/// Closes the session without blocking.
+			/// \param[in]	callback	Completion callback.
+			/// \return Future of the operation result.
+			QFuture<bool> closeAsync(const callback_t& callback = nullptr);
+
+			/// Sets up the media stream without blocking.
+			/// \param[in]	path		Media stream path.
+			/// \param[in]	ports		Ports for receiving RTP and RTCP data.
+			/// \param[in]	callback	Completion callback.
+			/// \return Future of the operation result.
+			QFuture<bool> setupAsync(const QUrl& path,
+									 const QPair<quint16, quint16>& ports,
+									 const callback_t& callback = nullptr);
+
+			/// Tears down the media stream without blocking.
+			/// \param[in]	callback	Completion callback.
+			/// \return Future of the operation result.
+			QFuture<bool> resetAsync(const callback_t& callback = nullptr);
+
+			/// Starts playback of the media stream without blocking.
+			/// \param[in]	callback	Completion callback.
+			/// \return Future of the operation result.
+			QFuture<bool> playAsync(const callback_t& callback = nullptr);
+
+			/// Pauses playback of the media stream without blocking.
+			/// \param[in]	callback	Completion callback.
+			/// \return Future of the operation result.
+			QFuture<bool> pauseAsync(const callback_t& callback = nullptr);
+
 			///
 			/// \retval
 			/// \retval
 			bool isOpen() const;
 
+			/// Returns RTP transport protocol.
+			/// \return RTP transport protocol.
+			RTSPTransport getTransport() const;
+
+			/// Sets RTP transport protocol used by the next setup.
+			/// \param[in]	transport	RTP transport protocol.
+			void setTransport(RTSPTransport transport);
+
+			/// Indicates whether fast start is enabled.
+			/// \retval true if fast start is enabled.
+			/// \retval false if fast start is disabled.
+			bool isFastStart() const;
+
+			/// Enables or disables fast start used by the next open.
+			/// \param[in]	fastStart	Whether session bring-up skips OPTIONS.
+			void setFastStart(bool fastStart);
+
+			/// Indicates whether batched receive is enabled.
+			/// \retval true if batched receive is enabled.
+			/// \retval false if batched receive is disabled.
+			bool isBatchReceive() const;
+
+			/// Enables or disables batched receive used by the next setup.
+			/// \param[in]	batchReceive	Whether RTP datagrams are received
+			/// in batches.
+			void setBatchReceive(bool batchReceive);
+
+			/// Indicates whether shared receive is enabled.
+			/// \retval true if shared receive is enabled.
+			/// \retval false if shared receive is disabled.
+			bool isSharedReceive() const;
+
+			/// Enables or disables shared receive used by the next setup.
+			/// \param[in]	sharedReceive	Whether UDP data is received by the
+			/// shared receiver of the thread.
+			void setSharedReceive(bool sharedReceive);
+
+			/// Returns interleaved RTP buffer size.
+			/// \return Buffer size in bytes.
+			int getInterleavedBufferSize() const;
+
+			/// Sets interleaved RTP buffer size used by the next setup.
+			/// \param[in]	size	Buffer size in bytes.
+			void setInterleavedBufferSize(int size);
+
+			/// Indicates whether RTCP keep-alive is enabled.
+			/// \retval true if RTCP keep-alive is enabled.
+			/// \retval false if RTCP keep-alive is disabled.
+			bool isReportKeepAlive() const;
+
+			/// Enables or disables RTCP keep-alive.
+			/// \param[in]	reportKeepAlive	Whether RTCP exchange with the
+			/// server replaces keep-alive requests.
+			void setReportKeepAlive(bool reportKeepAlive);
+
+			/// Indicates whether retransmission is enabled.
+			/// \retval true if retransmission is enabled.
+			/// \retval false if retransmission is disabled.
+			bool isRetransmission() const;
+
+			/// Enables or disables retransmission used by the next setup.
+			/// \param[in]	retransmission	Whether lost packets are requested
+			/// again.
+			void setRetransmission(bool retransmission);
+
+			/// Returns key frame request of broken video.
+			/// \return Key frame request.
+			RTSPKeyFrameRequest getKeyFrameRequest() const;
+
+			/// Sets key frame request of broken video used by the next setup.
+			/// \param[in]	request	Key frame request.
+			void setKeyFrameRequest(RTSPKeyFrameRequest request);
+
+			/// Reports a video frame that can not be decoded.
+			void requestKeyFrame();
+
+			/// Returns RTSP protocol backend.
+			/// \return RTSP protocol backend.
+			RTSPBackend getBackend() const;
+
+			/// Sets RTSP protocol backend used by the next open.
+			/// \param[in]	backend	RTSP protocol backend.
+			void setBackend(RTSPBackend backend);
+
+			/// Returns connect and operation timeouts.
+			/// \return Connect and operation timeouts in milliseconds.
+			QPair<qint64, qint64> getTimeouts() const;
+
+			/// Sets connect and operation timeouts used by the next open.
+			/// \param[in]	timeouts	Connect and operation timeouts in
+			///							milliseconds.
+			void setTimeouts(const QPair<qint64, qint64>& timeouts);
+
+			/// Indicates whether automatic reconnect is enabled.
+			/// \retval true if automatic reconnect is enabled.
+			/// \retval false if automatic reconnect is disabled.
+			bool isAutoReconnect() const;
+
+			/// Enables or disables automatic reconnect.
+			/// \param[in]	autoReconnect	Whether a lost session is restored.
+			void setAutoReconnect(bool autoReconnect);
+
+			/// Returns session bring-up statistics.
+			/// \return Session bring-up statistics.
+			RTSPSessionStatistics getStatistics() const;
+
+			/// Returns number of received RTP packets.
+			/// \return Number of received RTP packets.
+			quint64 getPacketCount() const;
+
+			/// Returns media stream reception statistics.
+			/// \return Media stream reception statistics.
+			RTSPStreamStatistics getStreamStatistics() const;
+
+			/// Returns RFC 3550 receiver statistics of the current RTP source.
+			/// \return Receiver statistics.
+			RTPStreamStatistics getReceiverStatistics() const;
+
+			/// Returns mapping of RTP timestamps of the current source to
+			/// wall clock.
+			/// \return Clock mapping of the last sender report.
+			RTCPClockMapping getClockMapping() const;
+
+			/// Converts RTP timestamp of the current source to wall clock
+			/// time.
+			/// \param[in]	timestamp	RTP timestamp.
+			/// \return Time since the Unix epoch in nanoseconds, or -1 if no
+			/// sender report was received.
+			qint64 getWallClock(quint32 timestamp) const;
+
+			/// Converts RTP timestamp of the current source to presentation
+			/// time.
+			/// \param[in]	timestamp	RTP timestamp.
+			/// \param[out]	time		Presentation time in nanoseconds.
+			/// \retval true on success.
+			/// \retval false if no packet was received or the clock rate is
+			/// unknown.
+			bool getPresentationTime(quint32 timestamp, qint64& time) const;
+
+			/// Converts RTP timestamp of the current source to receiver clock
+			/// time.
+			/// \param[in]	timestamp	RTP timestamp.
+			/// \return Time of the monotonic clock in nanoseconds, or -1 if no
+			/// sender report was received.
+			qint64 getReceiverClock(quint32 timestamp) const;
+
+			/// Returns timing of the last request of an RTSP method.
+			/// \param[in]	method	RTSP method.
+			/// \return Request timing.
+			RTSPRequestTiming getRequestTiming(RTSPMethod method) const;
+
 		protected:
 
-			/// Handles timer events.
-			/// \param[in]	event	Timer event.
-			void timerEvent(QTimerEvent* event) override;
+			/// Handles an event.
+			/// \param[in]	event	Event.
+			/// \retval true if the event was handled.
+			/// \retval false if the event was not handled.
+			bool event(QEvent* event) override;
 
 		private slots:
 
 			/// Performs an action when receiving RTP data.
 			void onRTPDatagram();
 
+			/// Performs an action when receiving a batch of RTP data.
+			void onRTPBatch();
+
 			/// Performs an action when receiving RTCP data.
 			void onRTCPDatagram();
 
+			/// Performs an action when receiving interleaved data.
+			void onInterleavedData();
+
+			/// Performs an action when a reconnect slot is granted.
+			void onReconnectGranted();
+
+		private:
+
+			/// Request completion callback type.
+			using completion_t = std::function<void(RTSPStatusCode)>;
+
+			/// Request starter type.
+			using request_t = std::function<bool(const completion_t&)>;
+
+		private:
+
+			/// Opens the RTSP context for a new session.
+			/// \param[in]	url	RTSP connection URL.
+			/// \retval true on success.
+			/// \retval false on error.
+			bool openContext(const QUrl& url);
+
+			/// Processes RTP packet.
+			/// \param[in]	data	Packet data.
+			/// \param[in]	size	Packet size.
+			void processRTPPacket(const char* data, int size);
+
+			/// Updates reception statistics with an RTP packet.
+			/// \param[in]	packet	RTP packet.
+			/// \param[in]	arrival	Arrival time in nanoseconds.
+			void updateReception(const RTPPacketView& packet, qint64 arrival);
+
+			/// Processes RTCP packet.
+			/// \param[in]	data	Packet data.
+			/// \param[in]	size	Packet size.
+			void processRTCPPacket(const char* data, int size);
+
+			/// Sends an RTCP compound packet to the server.
+			/// \param[in]	data	RTCP compound packet.
+			/// \retval true on success.
+			/// \retval false on error.
+			bool sendControl(const QByteArray& data);
+
+			/// Starts sending receiver reports.
+			void startReports();
+
+			/// Schedules the next receiver report.
+			void scheduleReport();
+
+			/// Sends receiver report.
+			/// \param[in]	goodbye	Whether the receiver leaves the session.
+			void sendReport(bool goodbye);
+
+			/// Requests retransmission of lost packets that are due.
+			/// \param[in]	now	Current time in nanoseconds.
+			void requestRetransmission(qint64 now);
+
+			/// Schedules retransmission requests while no packets arrive.
+			void scheduleRetransmission();
+
+			/// Updates key frame request state with an RTP packet.
+			/// \param[in]	packet	RTP packet.
+			/// \param[in]	arrival	Arrival time in nanoseconds.
+			void updatePictureLoss(const RTPPacketView& packet,
+								   qint64 arrival);
+
+			/// Sends key frame request if it is due.
+			/// \param[in]	now	Current time in nanoseconds.
+			void sendKeyFrameRequest(qint64 now);
+
+			/// Schedules key frame request while no packets arrive.
+			void scheduleKeyFrameRequest();
+
+			/// Processes packets stored in interleaved channel buffers.
+			void processInterleaved();
+
+			/// Sends SETUP request and starts receiving the media stream.
+			/// \param[in]	path	Media stream path.
+			/// \param[in]	ports	Ports for receiving RTP and RTCP data.
+			/// \return RTSP status code.
+			RTSPStatusCode startStream(const QUrl& path,
+									   const QPair<quint16, quint16>& ports);
+
+			/// Sends SETUP request and starts receiving the media stream
+			/// without blocking.
+			/// \param[in]	path		Media stream path.
+			/// \param[in]	ports		Ports for receiving RTP and RTCP data.
+			/// \param[in]	completion	Completion callback.
+			void startStream(const QUrl& path,
+							 const QPair<quint16, quint16>& ports,
+							 const completion_t& completion);
+
+			/// Returns ports requested by the next setup.
+			/// \param[in]	ports	Ports for receiving RTP and RTCP data.
+			/// \return Ports of the shared receiver in shared receive mode,
+			/// otherwise the given ports.
+			QPair<quint16, quint16> streamPorts(
+				const QPair<quint16, quint16>& ports);
+
+			/// Starts receiving the media stream that is set up.
+			/// \param[in]	ports	Ports for receiving RTP and RTCP data.
+			/// \retval true on success.
+			/// \retval false on error.
+			bool attachStream(const QPair<quint16, quint16>& ports);
+
+			/// Stops receiving the media stream without TEARDOWN request.
+			void stopStream();
+
+			/// Watches RTSP connection for interleaved data.
+			/// \param[in]	socket	Socket descriptor.
+			void watchConnection(qintptr socket);
+
+			/// Watches the batched receiver for RTP data.
+			void watchReceiver();
+
+			/// Moves the client to another thread.
+			/// \param[in]	thread	Target thread.
+			/// \retval true on success.
+			/// \retval false if the client is busy or bound to its thread.
+			bool detach(QThread* thread);
+
+			/// Resumes the client on the thread it was moved to.
+			void attach();
+
+			/// Handles a lost connection.
+			void connectionLost();
+
+			/// Schedules the next reconnect attempt.
+			void scheduleReconnect();
+
+			/// Cancels reconnect in progress.
+			void cancelReconnect();
+
+			/// Restores the session on a new connection without blocking.
+			/// \param[in]	callback	Completion callback.
+			void restoreSession(const callback_t& callback);
+
+			/// Queues a non-blocking request.
+			/// \param[in]	request		Request starter.
+			/// \param[in]	completion	Completion callback.
+			void submit(const request_t& request,
+						const completion_t& completion);
+
+			/// Starts the next queued request.
+			void next();
+
+			/// Finishes the request in progress.
+			/// \param[in]	status	RTSP status code.
+			void finish(RTSPStatusCode status);
+
+			/// Fails queued requests and the request in progress.
+			void cancelPending();
+
+			/// Schedules the next keep-alive request.
+			void scheduleKeepAlive();
+
+			/// Sends keep-alive request.
+			void keepAlive();
+
 		signals:
 
 			/// Signals the readiness of media stream data.
 			/// \param[in]	data	Media stream data.
 			void onData(const QByteArray& data);
 
+			/// Signals the arrival of the first RTP packet of the session.
+			/// \param[in]	elapsed	Time since the session opening in
+			///						nanoseconds.
+			void onFirstPacket(qint64 elapsed);
+
+			/// Signals the loss of the connection of a set up session.
+			void onDisconnected();
+
+			/// Signals the restoration of a lost session.
+			/// \param[in]	elapsed	Time since the connection loss in
+			///						nanoseconds.
+			void onReconnected(qint64 elapsed);
+
 		private:
 
 			/// Opaque type for private data.
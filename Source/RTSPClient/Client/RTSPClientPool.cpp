@@ -0,0 +1,545 @@
+/// \file RTSPClientPool.cpp
+/// \brief Contains classes and functions definitions that provide Real Time
+/// Streaming Protocol (RTSP) sharded client pool.
+/// \bug No known bugs.
+
+#include "RTSPClientPool.hpp"
+
+#include <QAbstractEventDispatcher>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QThread>
+#include <QTimer>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		namespace {
+
+			/// Default balance interval in milliseconds.
+			/// \details Long enough to average bursts of video frames.
+			constexpr int DEFAULT_BALANCE_INTERVAL { 1000 };
+
+			/// Default load imbalance that triggers migration.
+			/// \details The busiest shard may carry a quarter more than the
+			/// mean load.
+			constexpr double DEFAULT_IMBALANCE { 1.25 };
+
+			/// Packet rate smoothing factor.
+			/// \details Weight of the last measurement in the moving average.
+			constexpr double RATE_SMOOTHING { 0.5 };
+
+			/// Number of balance rounds a moved client stays on its shard.
+			/// \details Keeps clients from bouncing between shards.
+			constexpr quint64 MIGRATION_COOLDOWN { 3 };
+
+			/// Class that provides a shard worker thread.
+			/// \details Runs an event loop and measures the time it spends
+			/// outside of waiting for events.
+			class Worker final : public QThread {
+			public:
+
+				/// Returns time spent processing events.
+				/// \details Safe to call from any thread.
+				/// \return Busy time in nanoseconds.
+				qint64 getBusyTime() const {
+					return busy_.load(std::memory_order_relaxed);
+				}
+
+			protected:
+
+				/// Runs the event loop.
+				/// \details Busy time is accumulated from the wake-up of the
+				/// event dispatcher to its next wait.
+				void run() override {
+					auto dispatcher = QAbstractEventDispatcher::instance();
+
+					QElapsedTimer clock;
+					clock.start();
+
+					auto awake = clock.nsecsElapsed();
+					auto waiting = false;
+
+					auto blocked = connect(
+						dispatcher,
+						&QAbstractEventDispatcher::aboutToBlock,
+						[this, &clock, &awake, &waiting]() {
+							if (waiting) return;
+
+							waiting = true;
+							busy_.fetch_add(clock.nsecsElapsed() - awake,
+											std::memory_order_relaxed);
+						});
+
+					auto woken = connect(
+						dispatcher,
+						&QAbstractEventDispatcher::awake,
+						[&clock, &awake, &waiting]() {
+							if (!waiting) return;
+
+							waiting = false;
+							awake = clock.nsecsElapsed();
+						});
+
+					exec();
+
+					disconnect(blocked);
+					disconnect(woken);
+				}
+
+			private:
+
+				/// Time spent processing events in nanoseconds.
+				std::atomic<qint64> busy_ { 0 };
+			};
+		}
+
+		/// Structure that provides private storage.
+		/// \details Maintains private data.
+		struct RTSPClientPool::RTSPClientPoolPrivate final {
+
+			/// Structure that describes a shard.
+			struct Shard final {
+
+				/// Worker thread.
+				std::unique_ptr<Worker> thread_;
+
+				/// Number of sessions.
+				int sessions_ { 0 };
+
+				/// Sum of smoothed packet rates of the sessions.
+				double load_ { 0 };
+
+				/// Measured packet rate.
+				double packetRate_ { 0 };
+
+				/// Measured utilization.
+				double utilization_ { 0 };
+
+				/// Busy time of the worker at the last measurement.
+				qint64 busy_ { 0 };
+
+				/// Number of sessions moved to the shard.
+				quint64 migratedIn_ { 0 };
+
+				/// Number of sessions moved from the shard.
+				quint64 migratedOut_ { 0 };
+			};
+
+			/// Structure that describes a session.
+			struct Session final {
+
+				/// Shard index.
+				int shard_ { 0 };
+
+				/// Packet counter at the last measurement.
+				quint64 packets_ { 0 };
+
+				/// Smoothed packet rate, or an estimate until the first
+				/// packet arrives.
+				double rate_ { 0 };
+
+				/// Whether the packet rate has been measured.
+				bool measured_ { false };
+
+				/// Balance round of the last placement.
+				quint64 placed_ { 0 };
+			};
+
+			/// Shards.
+			std::vector<Shard> shards_;
+
+			/// Sessions by client.
+			QHash<RTSPClient*, Session> sessions_;
+
+			/// Balance timer.
+			QTimer timer_;
+
+			/// Measurement clock.
+			QElapsedTimer clock_;
+
+			/// Load imbalance that triggers migration.
+			double imbalance_ { DEFAULT_IMBALANCE };
+
+			/// Balance round.
+			quint64 round_ { 0 };
+		};
+
+		/// Constructor.
+		/// \details Starts worker threads and the balance timer.
+		/// \param[in]	shards	Number of worker threads, or zero for the
+		///						number of processor cores.
+		/// \param[in]	parent	Parent object.
+		RTSPClientPool::RTSPClientPool(int shards, QObject* parent)
+			: QObject(parent),
+			  private_(new RTSPClientPoolPrivate) {
+
+			auto& p = *private_;
+
+			auto count = shards > 0
+						 ? shards
+						 : qMax(QThread::idealThreadCount(), 1);
+
+			p.shards_.resize(static_cast<size_t>(count));
+
+			for (auto i = 0; i < count; ++i) {
+				auto& thread = p.shards_[static_cast<size_t>(i)].thread_;
+
+				thread.reset(new Worker);
+				thread->setObjectName(QString("RTSPClientPool %1").arg(i));
+				thread->start();
+			}
+
+			connect(
+				&p.timer_,
+				SIGNAL(timeout()),
+				SLOT(onBalance())
+			);
+
+			p.clock_.start();
+			p.timer_.start(DEFAULT_BALANCE_INTERVAL);
+		}
+
+		/// Destructor.
+		/// \details Destroys clients on their threads and stops the threads.
+		RTSPClientPool::~RTSPClientPool() {
+			auto& p = *private_;
+
+			p.timer_.stop();
+
+			for (auto i = p.sessions_.cbegin(); i != p.sessions_.cend(); ++i)
+				i.key()->deleteLater();
+
+			p.sessions_.clear();
+
+			for (auto& shard : p.shards_) shard.thread_->quit();
+			for (auto& shard : p.shards_) shard.thread_->wait();
+		}
+
+		/// Creates a client on the least loaded shard.
+		/// \details Until its first packet arrives, the client is assumed to
+		/// carry the mean load of measured clients, so that clients created
+		/// together are spread over shards.
+		/// \return Client that lives on the shard thread.
+		RTSPClient* RTSPClientPool::create() {
+			auto& p = *private_;
+
+			auto measured = 0;
+			auto total = 0.0;
+
+			for (const auto& session : p.sessions_) {
+				if (!session.measured_) continue;
+
+				++measured;
+				total += session.rate_;
+			}
+
+			auto estimate = measured > 0 ? total / measured : 0.0;
+			auto target = 0;
+
+			for (auto i = 1; i < getShardCount(); ++i) {
+				const auto& shard = p.shards_[static_cast<size_t>(i)];
+				const auto& best = p.shards_[static_cast<size_t>(target)];
+
+				if (shard.load_ < best.load_ ||
+					(shard.load_ == best.load_ &&
+					 shard.sessions_ < best.sessions_))
+					target = i;
+			}
+
+			auto& shard = p.shards_[static_cast<size_t>(target)];
+
+			auto client = new RTSPClient;
+			client->moveToThread(shard.thread_.get());
+
+			RTSPClientPoolPrivate::Session session;
+			session.shard_ = target;
+			session.rate_ = estimate;
+			session.placed_ = p.round_;
+
+			p.sessions_.insert(client, session);
+
+			++shard.sessions_;
+			shard.load_ += estimate;
+
+			return client;
+		}
+
+		/// Destroys a client of the pool.
+		/// \details The client tears down its session without blocking and
+		/// is deleted afterwards on its own thread, so a server that does
+		/// not answer holds no other client of the shard. Clients that are
+		/// not in the pool are ignored.
+		/// \param[in]	client	Client.
+		void RTSPClientPool::destroy(RTSPClient* client) {
+			auto& p = *private_;
+
+			auto session = p.sessions_.find(client);
+			if (session == p.sessions_.end()) return;
+
+			auto& shard = p.shards_[static_cast<size_t>(session->shard_)];
+			--shard.sessions_;
+			shard.load_ -= session->rate_;
+
+			p.sessions_.erase(session);
+
+			QMetaObject::invokeMethod(client, [client]() {
+				client->closeAsync([client](bool) { client->deleteLater(); });
+			}, Qt::QueuedConnection);
+		}
+
+		/// Returns number of shards.
+		/// \details Returns number of worker threads.
+		/// \return Number of shards.
+		int RTSPClientPool::getShardCount() const {
+			return static_cast<int>(private_->shards_.size());
+		}
+
+		/// Returns shard of a client.
+		/// \details Looks the client up.
+		/// \param[in]	client	Client.
+		/// \return Shard index or -1 if the client is not in the pool.
+		int RTSPClientPool::getShard(RTSPClient* client) const {
+			auto session = private_->sessions_.constFind(client);
+
+			return session != private_->sessions_.cend()
+				   ? session->shard_
+				   : -1;
+		}
+
+		/// Returns shard statistics.
+		/// \details Rates and utilization are measured over the last balance
+		/// interval.
+		/// \return Statistics of every shard.
+		QVector<RTSPShardStatistics> RTSPClientPool::getStatistics() const {
+			QVector<RTSPShardStatistics> statistics;
+			statistics.reserve(getShardCount());
+
+			for (const auto& shard : private_->shards_) {
+				RTSPShardStatistics item;
+				item.sessions_ = shard.sessions_;
+				item.packetRate_ = shard.packetRate_;
+				item.utilization_ = shard.utilization_;
+				item.migratedIn_ = shard.migratedIn_;
+				item.migratedOut_ = shard.migratedOut_;
+
+				statistics.append(item);
+			}
+
+			return statistics;
+		}
+
+		/// Returns load imbalance that triggers migration.
+		/// \details Returns imbalance threshold.
+		/// \return Ratio of the highest shard load to the mean load.
+		double RTSPClientPool::getImbalance() const {
+			return private_->imbalance_;
+		}
+
+		/// Sets load imbalance that triggers migration.
+		/// \details Values below one are raised to one.
+		/// \param[in]	imbalance	Ratio of the highest shard load to the
+		///							mean load.
+		void RTSPClientPool::setImbalance(double imbalance) {
+			private_->imbalance_ = qMax(imbalance, 1.0);
+		}
+
+		/// Returns balance interval.
+		/// \details Returns balance timer interval.
+		/// \return Balance interval in milliseconds.
+		int RTSPClientPool::getBalanceInterval() const {
+			return private_->timer_.interval();
+		}
+
+		/// Sets balance interval.
+		/// \details Restarts the balance timer.
+		/// \param[in]	interval	Balance interval in milliseconds.
+		void RTSPClientPool::setBalanceInterval(int interval) {
+			private_->timer_.start(qMax(interval, 1));
+		}
+
+		/// Performs an action when the balance interval elapses.
+		/// \details Measures the load and moves clients.
+		void RTSPClientPool::onBalance() {
+			++private_->round_;
+
+			sample();
+			balance();
+		}
+
+		/// Measures client and shard load.
+		/// \details Packet counters of clients are read without locking.
+		/// Clients that have not received packets yet carry the mean load
+		/// of measured clients.
+		void RTSPClientPool::sample() {
+			auto& p = *private_;
+
+			auto elapsed = p.clock_.nsecsElapsed();
+			p.clock_.start();
+
+			if (elapsed <= 0) return;
+
+			auto seconds = elapsed / 1e9;
+
+			for (auto& shard : p.shards_) {
+				auto busy = shard.thread_->getBusyTime();
+
+				auto utilization =
+					static_cast<double>(busy - shard.busy_) / elapsed;
+
+				shard.utilization_ = qBound(0.0, utilization, 1.0);
+
+				shard.busy_ = busy;
+				shard.packetRate_ = 0;
+				shard.load_ = 0;
+			}
+
+			auto measured = 0;
+			auto total = 0.0;
+
+			for (auto i = p.sessions_.begin(); i != p.sessions_.end(); ++i) {
+				auto packets = i.key()->getPacketCount();
+				auto rate = (packets - i->packets_) / seconds;
+
+				i->packets_ = packets;
+
+				if (packets == 0) continue;
+
+				i->rate_ = i->measured_
+						   ? i->rate_ + RATE_SMOOTHING * (rate - i->rate_)
+						   : rate;
+
+				i->measured_ = true;
+
+				p.shards_[static_cast<size_t>(i->shard_)].packetRate_ += rate;
+
+				++measured;
+				total += i->rate_;
+			}
+
+			auto estimate = measured > 0 ? total / measured : 0.0;
+
+			for (auto i = p.sessions_.begin(); i != p.sessions_.end(); ++i) {
+				if (!i->measured_) i->rate_ = estimate;
+
+				p.shards_[static_cast<size_t>(i->shard_)].load_ += i->rate_;
+			}
+		}
+
+		/// Moves clients from overloaded shards.
+		/// \details While the busiest shard carries more than the allowed
+		/// share of the mean load, moves the client of that shard that best
+		/// halves the gap to the least loaded shard. Clients moved recently
+		/// and clients that are busy with a request stay in place.
+		void RTSPClientPool::balance() {
+			auto& p = *private_;
+			auto count = getShardCount();
+
+			if (count < 2) return;
+
+			auto total = 0.0;
+			for (const auto& shard : p.shards_) total += shard.load_;
+
+			auto mean = total / count;
+			if (mean <= 0) return;
+
+			for (auto moves = 0; moves < count; ++moves) {
+				auto high = 0;
+				auto low = 0;
+
+				for (auto i = 1; i < count; ++i) {
+					auto load = p.shards_[static_cast<size_t>(i)].load_;
+
+					if (load > p.shards_[static_cast<size_t>(high)].load_)
+						high = i;
+
+					if (load < p.shards_[static_cast<size_t>(low)].load_)
+						low = i;
+				}
+
+				auto& from = p.shards_[static_cast<size_t>(high)];
+				auto& to = p.shards_[static_cast<size_t>(low)];
+
+				if (from.load_ <= mean * p.imbalance_) return;
+
+				auto gap = from.load_ - to.load_;
+				auto best = 0.0;
+
+				RTSPClient* candidate = nullptr;
+
+				for (auto i = p.sessions_.cbegin();
+					 i != p.sessions_.cend(); ++i) {
+
+					if (i->shard_ != high							||
+						p.round_ - i->placed_ < MIGRATION_COOLDOWN	||
+						i->rate_ <= 0 || i->rate_ >= gap)
+						continue;
+
+					auto gain = qMin(i->rate_, gap - i->rate_);
+
+					if (gain > best) {
+						best = gain;
+						candidate = i.key();
+					}
+				}
+
+				if (!candidate) return;
+
+				auto& session = p.sessions_[candidate];
+				session.placed_ = p.round_;
+
+				if (!migrate(candidate, low)) continue;
+
+				from.load_ -= session.rate_;
+				to.load_ += session.rate_;
+			}
+		}
+
+		/// Moves a client to another shard.
+		/// \details Blocks until the source thread hands the client over.
+		/// The client resumes keep-alive and request processing on the
+		/// target thread before any other queued call.
+		/// \param[in]	client	Client.
+		/// \param[in]	shard	Target shard index.
+		/// \retval true on success.
+		/// \retval false if the client is busy.
+		bool RTSPClientPool::migrate(RTSPClient* client, int shard) {
+			auto& p = *private_;
+			auto& session = p.sessions_[client];
+
+			auto source = session.shard_;
+			auto thread = p.shards_[static_cast<size_t>(shard)].thread_.get();
+			auto moved = false;
+
+			QMetaObject::invokeMethod(client, [client, thread, &moved]() {
+				moved = client->detach(thread);
+			}, Qt::BlockingQueuedConnection);
+
+			if (!moved) return false;
+
+			auto& from = p.shards_[static_cast<size_t>(source)];
+			auto& to = p.shards_[static_cast<size_t>(shard)];
+
+			--from.sessions_;
+			++from.migratedOut_;
+
+			++to.sessions_;
+			++to.migratedIn_;
+
+			session.shard_ = shard;
+
+			emit onMigrated(client, source, shard);
+
+			return true;
+		}
+	}
+}
@@ -0,0 +1,127 @@
+/// \file RTSPClientPool.hpp
+/// \brief Contains classes and functions declarations that provide Real Time
+/// Streaming Protocol (RTSP) sharded client pool.
+/// \bug No known bugs.
+
+#ifndef RTSPCLIENTPOOL_HPP
+#define RTSPCLIENTPOOL_HPP
+
+#include "RTSPClient.hpp"
+#include "RTSPShardStatistics.hpp"
+
+#include <QVector>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		/// Class that provides sharded RTSP client pool.
+		/// \details Owns worker threads, each running its own event loop
+		/// with its own client engine and keep-alive scheduler. Clients are
+		/// placed on the least loaded shard, the load being the number of
+		/// RTP packets received per second, and are moved between shards
+		/// when the load becomes imbalanced. Clients live on their shard
+		/// thread, so their operations must be invoked there, for example
+		/// with QMetaObject::invokeMethod(). The pool itself is used from
+		/// the thread that created it.
+		class RTSPCLIENT_EXPORT RTSPClientPool : public QObject {
+
+			Q_OBJECT
+
+		public:
+
+			/// Constructor.
+			/// \param[in]	shards	Number of worker threads, or zero for the
+			///						number of processor cores.
+			/// \param[in]	parent	Parent object.
+			explicit RTSPClientPool(int shards = 0, QObject* parent = nullptr);
+
+			/// Destructor.
+			~RTSPClientPool() override;
+
+		public:
+
+			/// Creates a client on the least loaded shard.
+			/// \return Client that lives on the shard thread.
+			RTSPClient* create();
+
+			/// Destroys a client of the pool.
+			/// \param[in]	client	Client.
+			void destroy(RTSPClient* client);
+
+			/// Returns number of shards.
+			/// \return Number of shards.
+			int getShardCount() const;
+
+			/// Returns shard of a client.
+			/// \param[in]	client	Client.
+			/// \return Shard index or -1 if the client is not in the pool.
+			int getShard(RTSPClient* client) const;
+
+			/// Returns shard statistics.
+			/// \return Statistics of every shard.
+			QVector<RTSPShardStatistics> getStatistics() const;
+
+			/// Returns load imbalance that triggers migration.
+			/// \return Ratio of the highest shard load to the mean load.
+			double getImbalance() const;
+
+			/// Sets load imbalance that triggers migration.
+			/// \param[in]	imbalance	Ratio of the highest shard load to the
+			///							mean load.
+			void setImbalance(double imbalance);
+
+			/// Returns balance interval.
+			/// \return Balance interval in milliseconds.
+			int getBalanceInterval() const;
+
+			/// Sets balance interval.
+			/// \param[in]	interval	Balance interval in milliseconds.
+			void setBalanceInterval(int interval);
+
+		private slots:
+
+			/// Performs an action when the balance interval elapses.
+			void onBalance();
+
+		private:
+
+			/// Measures client and shard load.
+			void sample();
+
+			/// Moves clients from overloaded shards.
+			void balance();
+
+			/// Moves a client to another shard.
+			/// \param[in]	client	Client.
+			/// \param[in]	shard	Target shard index.
+			/// \retval true on success.
+			/// \retval false if the client is busy.
+			bool migrate(RTSPClient* client, int shard);
+
+		signals:
+
+			/// Signals the move of a client to another shard.
+			/// \param[in]	client	Client.
+			/// \param[in]	from	Source shard index.
+			/// \param[in]	to		Target shard index.
+			void onMigrated(RTSPLib::RTSPClient::RTSPClient* client,
+							int from,
+							int to);
+
+		private:
+
+			/// Opaque type for private data.
+			struct RTSPClientPoolPrivate;
+
+			/// Private data.
+			const QScopedPointer<RTSPClientPoolPrivate> private_;
+		};
+	}
+}
+
+#endif
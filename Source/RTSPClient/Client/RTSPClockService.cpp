@@ -0,0 +1,243 @@
+/// \file RTSPClockService.cpp
+/// \brief Contains classes and functions definitions that provide Real Time
+/// Streaming Protocol (RTSP) clock alignment of media streams.
+/// \bug No known bugs.
+
+#include "RTSPClockService.hpp"
+
+#include <QHash>
+#include <QReadWriteLock>
+#include <QVector>
+
+#include <algorithm>
+#include <chrono>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		/// Structure that provides private storage.
+		/// \details Maintains private data.
+		struct RTSPClockService::RTSPClockServicePrivate final {
+
+			/// Registry lock.
+			/// \details Conversions share it, changes of the registry take
+			/// it exclusively.
+			mutable QReadWriteLock lock_;
+
+			/// Common time base.
+			/// \details Guarded by the registry lock.
+			RTSPClockReference reference_ { RTSPClockReference::Receiver };
+
+			/// Groups of the clients.
+			/// \details Guarded by the registry lock. Keyed by the object
+			/// of the client, which is all that is left of a destroyed one.
+			QHash<QObject*, QString> groups_;
+
+			/// Clients of the groups.
+			/// \details Guarded by the registry lock.
+			QHash<QString, QVector<RTSPClient*>> members_;
+
+			/// Removes a client.
+			/// \details Must be called with the registry lock taken
+			/// exclusively.
+			/// \param[in]	client	Client.
+			/// \retval true if the client was removed.
+			/// \retval false if the client was not added.
+			bool remove(QObject* client) {
+				auto group = groups_.find(client);
+
+				if (group == groups_.end()) return false;
+
+				auto& members = members_[group.value()];
+				members.erase(std::remove_if(members.begin(), members.end(),
+											 [client](RTSPClient* member) {
+					return member == client;
+				}), members.end());
+
+				if (members.isEmpty()) members_.remove(group.value());
+
+				groups_.erase(group);
+				return true;
+			}
+
+			/// Returns offset of the receiver clock of a group.
+			/// \details The smallest offset of the streams of the group, so
+			/// every stream of a sender is shifted alike and their
+			/// synchronization is kept. Must be called with the registry lock
+			/// taken.
+			/// \param[in]	group	Group.
+			/// \param[out]	offset	Offset in nanoseconds.
+			/// \retval true on success.
+			/// \retval false if no sender report of the group was received.
+			bool getOffset(const QString& group, qint64& offset) const {
+				auto valid = false;
+
+				for (auto client : members_.value(group)) {
+					auto mapping = client->getClockMapping();
+
+					if (mapping.arrival_ < 0) continue;
+
+					offset = valid
+							 ? std::min(offset, mapping.offset_)
+							 : mapping.offset_;
+					valid = true;
+				}
+
+				return valid;
+			}
+		};
+
+		/// Constructor.
+		/// \details Starts without clients.
+		/// \param[in]	reference	Common time base.
+		/// \param[in]	parent		Parent object.
+		RTSPClockService::RTSPClockService(RTSPClockReference reference,
+										   QObject* parent)
+			: QObject(parent),
+			  private_(new RTSPClockServicePrivate) {
+
+			private_->reference_ = reference;
+		}
+
+		/// Destructor.
+		/// \details Stops watching destruction of the clients.
+		RTSPClockService::~RTSPClockService() {
+			QWriteLocker locker(&private_->lock_);
+
+			for (auto i = private_->groups_.cbegin();
+				 i != private_->groups_.cend(); ++i)
+				disconnect(i.key(), SIGNAL(destroyed(QObject*)),
+						   this, SLOT(onDestroyed(QObject*)));
+		}
+
+		/// Adds a client.
+		/// \details A client added again moves to the new group. Streams of
+		/// one camera share a group, for example one named by the host of
+		/// the camera. The client is removed when it is destroyed.
+		/// \param[in]	client	Client.
+		/// \param[in]	group	Group of streams that share a sender.
+		void RTSPClockService::add(RTSPClient* client, const QString& group) {
+			if (!client) return;
+
+			QWriteLocker locker(&private_->lock_);
+
+			if (!private_->remove(client))
+				connect(client, SIGNAL(destroyed(QObject*)),
+						this, SLOT(onDestroyed(QObject*)),
+						Qt::DirectConnection);
+
+			private_->groups_.insert(client, group);
+			private_->members_[group].append(client);
+		}
+
+		/// Removes a client.
+		/// \details Timestamps of the client are not aligned anymore.
+		/// \param[in]	client	Client.
+		void RTSPClockService::remove(RTSPClient* client) {
+			QWriteLocker locker(&private_->lock_);
+
+			if (private_->remove(client))
+				disconnect(client, SIGNAL(destroyed(QObject*)),
+						   this, SLOT(onDestroyed(QObject*)));
+		}
+
+		/// Returns common time base.
+		/// \details Returns the time base of converted timestamps.
+		/// \return Common time base.
+		RTSPClockReference RTSPClockService::getReference() const {
+			QReadLocker locker(&private_->lock_);
+
+			return private_->reference_;
+		}
+
+		/// Sets common time base.
+		/// \details Times converted before are not comparable to the ones
+		/// converted afterwards.
+		/// \param[in]	reference	Common time base.
+		void RTSPClockService::setReference(RTSPClockReference reference) {
+			QWriteLocker locker(&private_->lock_);
+
+			private_->reference_ = reference;
+		}
+
+		/// Indicates whether timestamps of a client can be aligned.
+		/// \details Timestamps are aligned once the first sender report of
+		/// the stream arrives.
+		/// \param[in]	client	Client.
+		/// \retval true if timestamps of the client can be aligned.
+		/// \retval false if the client was not added or no sender report
+		/// of its stream was received.
+		bool RTSPClockService::isAligned(RTSPClient* client) const {
+			QReadLocker locker(&private_->lock_);
+
+			return private_->groups_.contains(client) &&
+				   client->getClockMapping().arrival_ >= 0;
+		}
+
+		/// Converts RTP timestamp of a client to common time.
+		/// \details Maps the timestamp to the wall clock of the sender with
+		/// its last sender report and the measured drift of its RTP clock.
+		/// On the receiver clock, the wall clock time is shifted by the
+		/// offset of the group.
+		/// \param[in]	client		Client.
+		/// \param[in]	timestamp	RTP timestamp.
+		/// \param[out]	time		Common time in nanoseconds.
+		/// \retval true on success.
+		/// \retval false if timestamps of the client can not be aligned.
+		bool RTSPClockService::toCommonTime(RTSPClient* client,
+											quint32 timestamp,
+											qint64& time) const {
+			const auto& p = *private_;
+
+			QReadLocker locker(&p.lock_);
+
+			auto group = p.groups_.constFind(client);
+
+			if (group == p.groups_.cend()) return false;
+
+			auto wallClock = RTCPSenderClock::toWallClock(
+				client->getClockMapping(), timestamp);
+
+			if (wallClock < 0) return false;
+
+			if (p.reference_ == RTSPClockReference::Sender) {
+				time = wallClock;
+				return true;
+			}
+
+			qint64 offset;
+
+			if (!p.getOffset(group.value(), offset)) return false;
+
+			time = wallClock + offset;
+			return true;
+		}
+
+		/// Returns current common time.
+		/// \details The wall clock of the receiver stands in for the wall
+		/// clocks of the senders, as close as they are synchronized.
+		/// \return Common time in nanoseconds.
+		qint64 RTSPClockService::getCommonTime() const {
+			if (getReference() == RTSPClockReference::Receiver)
+				return RTCPSenderClock::now();
+
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::system_clock::now().time_since_epoch()).count();
+		}
+
+		/// Performs an action when a client is destroyed.
+		/// \details Called on the thread of the client, before its
+		/// destruction completes.
+		/// \param[in]	object	Client.
+		void RTSPClockService::onDestroyed(QObject* object) {
+			QWriteLocker locker(&private_->lock_);
+
+			private_->remove(object);
+		}
+	}
+}
@@ -0,0 +1,111 @@
+/// \file RTSPClockService.hpp
+/// \brief Contains classes and functions declarations that provide Real Time
+/// Streaming Protocol (RTSP) clock alignment of media streams.
+/// \bug No known bugs.
+
+#ifndef RTSPCLOCKSERVICE_HPP
+#define RTSPCLOCKSERVICE_HPP
+
+#include "RTSPClient.hpp"
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		/// Enumeration that defines common time bases of media streams.
+		enum class RTSPClockReference {
+
+			/// Wall clocks of the senders.
+			/// \details Suits cameras synchronized by NTP or PTP.
+			Sender,
+
+			/// Monotonic clock of the receiver.
+			/// \details Suits cameras with unrelated wall clocks.
+			Receiver
+		};
+
+		/// Class that provides clock alignment of media streams.
+		/// \details Maps RTP timestamps of many streams to a common time base
+		/// using sender reports. Streams of one group, such as audio and
+		/// video tracks of one camera, share the wall clock of their sender,
+		/// so they keep the synchronization of the sender on the receiver
+		/// clock as well. Clients are removed when they are destroyed. All
+		/// methods are safe to call from any thread.
+		class RTSPCLIENT_EXPORT RTSPClockService : public QObject {
+
+			Q_OBJECT
+
+		public:
+
+			/// Constructor.
+			/// \param[in]	reference	Common time base.
+			/// \param[in]	parent		Parent object.
+			explicit RTSPClockService(
+				RTSPClockReference reference = RTSPClockReference::Receiver,
+				QObject* parent = nullptr);
+
+			/// Destructor.
+			~RTSPClockService() override;
+
+		public:
+
+			/// Adds a client.
+			/// \param[in]	client	Client.
+			/// \param[in]	group	Group of streams that share a sender.
+			void add(RTSPClient* client, const QString& group);
+
+			/// Removes a client.
+			/// \param[in]	client	Client.
+			void remove(RTSPClient* client);
+
+			/// Returns common time base.
+			/// \return Common time base.
+			RTSPClockReference getReference() const;
+
+			/// Sets common time base.
+			/// \param[in]	reference	Common time base.
+			void setReference(RTSPClockReference reference);
+
+			/// Indicates whether timestamps of a client can be aligned.
+			/// \param[in]	client	Client.
+			/// \retval true if timestamps of the client can be aligned.
+			/// \retval false if the client was not added or no sender report
+			/// of its stream was received.
+			bool isAligned(RTSPClient* client) const;
+
+			/// Converts RTP timestamp of a client to common time.
+			/// \param[in]	client		Client.
+			/// \param[in]	timestamp	RTP timestamp.
+			/// \param[out]	time		Common time in nanoseconds.
+			/// \retval true on success.
+			/// \retval false if timestamps of the client can not be aligned.
+			bool toCommonTime(RTSPClient* client,
+							  quint32 timestamp,
+							  qint64& time) const;
+
+			/// Returns current common time.
+			/// \return Common time in nanoseconds.
+			qint64 getCommonTime() const;
+
+		private slots:
+
+			/// Performs an action when a client is destroyed.
+			/// \param[in]	object	Client.
+			void onDestroyed(QObject* object);
+
+		private:
+
+			/// Opaque type for private data.
+			struct RTSPClockServicePrivate;
+
+			/// Private data.
+			const QScopedPointer<RTSPClockServicePrivate> private_;
+		};
+	}
+}
+
+#endif
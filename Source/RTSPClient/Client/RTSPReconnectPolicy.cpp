@@ -0,0 +1,247 @@
+/// \file RTSPReconnectPolicy.cpp
+/// \brief Contains classes and functions definitions that provide Real Time
+/// Streaming Protocol (RTSP) process-wide reconnect policy.
+/// \bug No known bugs.
+
+#include "RTSPReconnectPolicy.hpp"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPointer>
+#include <QQueue>
+
+#include <random>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		namespace {
+
+			/// Default maximum number of concurrent reconnects.
+			/// \details Bounds the connection rate seen by a recovering server.
+			constexpr int DEFAULT_LIMIT { 32 };
+
+			/// Default delay of the first reconnect attempt in milliseconds.
+			/// \details Doubled on every failed attempt.
+			constexpr qint64 DEFAULT_FIRST_DELAY { 250 };
+
+			/// Default maximum reconnect delay in milliseconds.
+			/// \details Backoff stops growing at this delay.
+			constexpr qint64 DEFAULT_MAXIMUM_DELAY { 30000 };
+
+			/// Maximum backoff exponent.
+			/// \details Keeps the shifted delay within range.
+			constexpr int MAXIMUM_EXPONENT { 20 };
+		}
+
+		/// Structure that provides private storage.
+		/// \details Maintains private data.
+		struct RTSPReconnectPolicy::RTSPReconnectPolicyPrivate final {
+
+			/// Structure that describes a waiting client.
+			struct Waiter final {
+
+				/// Client to notify.
+				QPointer<QObject> client_;
+
+				/// Name of the slot invoked when the slot is granted.
+				QByteArray member_;
+			};
+
+			/// Lock of the policy state.
+			mutable QMutex mutex_;
+
+			/// Maximum number of concurrent reconnects.
+			int limit_ { DEFAULT_LIMIT };
+
+			/// Delay of the first attempt in milliseconds.
+			qint64 firstDelay_ { DEFAULT_FIRST_DELAY };
+
+			/// Maximum delay in milliseconds.
+			qint64 maximumDelay_ { DEFAULT_MAXIMUM_DELAY };
+
+			/// Number of granted slots.
+			int active_ { 0 };
+
+			/// Clients waiting for a slot.
+			QQueue<Waiter> waiting_;
+
+			/// Clients granted a slot that have not been notified yet.
+			QList<QObject*> granted_;
+
+			/// Jitter generator.
+			std::mt19937 random_ { std::random_device()() };
+		};
+
+		/// Returns process-wide reconnect policy.
+		/// \details Created on first use.
+		/// \return Reconnect policy.
+		RTSPReconnectPolicy& RTSPReconnectPolicy::instance() {
+			static RTSPReconnectPolicy policy;
+			return policy;
+		}
+
+		/// Default constructor.
+		/// \details Initializes default limits.
+		RTSPReconnectPolicy::RTSPReconnectPolicy()
+			: private_(new RTSPReconnectPolicyPrivate) {
+		}
+
+		/// Destructor.
+		/// \details Drops waiting clients without notifying them.
+		RTSPReconnectPolicy::~RTSPReconnectPolicy() = default;
+
+		/// Returns maximum number of concurrent reconnects.
+		/// \details Returns reconnect limit.
+		/// \return Maximum number of concurrent reconnects.
+		int RTSPReconnectPolicy::getLimit() const {
+			QMutexLocker locker(&private_->mutex_);
+			return private_->limit_;
+		}
+
+		/// Sets maximum number of concurrent reconnects.
+		/// \details Raising the limit grants slots to waiting clients at once.
+		/// \param[in]	limit	Maximum number of concurrent reconnects.
+		void RTSPReconnectPolicy::setLimit(int limit) {
+			QMutexLocker locker(&private_->mutex_);
+			private_->limit_ = qMax(limit, 1);
+			grant();
+		}
+
+		/// Returns backoff delay bounds.
+		/// \details Returns first and maximum delays.
+		/// \return First and maximum delays in milliseconds.
+		QPair<qint64, qint64> RTSPReconnectPolicy::getDelays() const {
+			QMutexLocker locker(&private_->mutex_);
+			return qMakePair(private_->firstDelay_, private_->maximumDelay_);
+		}
+
+		/// Sets backoff delay bounds.
+		/// \details Maximum delay is never less than the first delay.
+		/// \param[in]	delays	First and maximum delays in milliseconds.
+		void RTSPReconnectPolicy::setDelays(
+			const QPair<qint64, qint64>& delays) {
+
+			QMutexLocker locker(&private_->mutex_);
+			private_->firstDelay_ = qMax<qint64>(delays.first, 1);
+			private_->maximumDelay_ =
+				qMax<qint64>(delays.second, private_->firstDelay_);
+		}
+
+		/// Returns backoff delay of a reconnect attempt.
+		/// \details The delay doubles with every attempt up to the maximum,
+		/// the second half of it is random so that clients dropped together
+		/// spread their attempts.
+		/// \param[in]	attempt	Zero-based attempt number.
+		/// \return Delay in milliseconds.
+		qint64 RTSPReconnectPolicy::getDelay(int attempt) {
+			QMutexLocker locker(&private_->mutex_);
+
+			auto exponent = qBound(0, attempt, MAXIMUM_EXPONENT);
+			auto delay = qMin(private_->firstDelay_ << exponent,
+							  private_->maximumDelay_);
+
+			std::uniform_int_distribution<qint64> jitter(0, delay / 2);
+
+			return delay - delay / 2 + jitter(private_->random_);
+		}
+
+		/// Requests a reconnect slot.
+		/// \details The slot is granted through a queued invocation of the
+		/// member, immediately if the limit allows it or when another client
+		/// releases its slot. The client must call release() after its
+		/// attempt.
+		/// \param[in]	client	Client to notify.
+		/// \param[in]	member	Name of the slot invoked when the slot is
+		///						granted.
+		void RTSPReconnectPolicy::acquire(QObject* client, const char* member) {
+			if (!client || !member) return;
+
+			QMutexLocker locker(&private_->mutex_);
+
+			RTSPReconnectPolicyPrivate::Waiter waiter;
+			waiter.client_ = client;
+			waiter.member_ = member;
+
+			private_->waiting_.enqueue(waiter);
+			grant();
+		}
+
+		/// Releases a granted reconnect slot.
+		/// \details Grants the slot to the next waiting client.
+		void RTSPReconnectPolicy::release() {
+			QMutexLocker locker(&private_->mutex_);
+
+			if (private_->active_ > 0) --private_->active_;
+			grant();
+		}
+
+		/// Withdraws a request that has not been served by the client.
+		/// \details Removes a waiting client from the queue, or returns the
+		/// slot of a client that was granted one but has not been notified.
+		/// \param[in]	client	Client.
+		void RTSPReconnectPolicy::cancel(QObject* client) {
+			QMutexLocker locker(&private_->mutex_);
+
+			auto& waiting = private_->waiting_;
+
+			for (auto i = waiting.begin(); i != waiting.end();) {
+				if (i->client_ == client) i = waiting.erase(i);
+				else ++i;
+			}
+
+			if (private_->granted_.removeOne(client)) {
+				if (private_->active_ > 0) --private_->active_;
+				grant();
+			}
+		}
+
+		/// Marks a granted client as notified.
+		/// \details Called by the client from the granted slot.
+		/// \param[in]	client	Client.
+		void RTSPReconnectPolicy::confirm(QObject* client) {
+			QMutexLocker locker(&private_->mutex_);
+			private_->granted_.removeOne(client);
+		}
+
+		/// Returns number of granted reconnect slots.
+		/// \details Returns active counter.
+		/// \return Number of granted slots.
+		int RTSPReconnectPolicy::getActiveCount() const {
+			QMutexLocker locker(&private_->mutex_);
+			return private_->active_;
+		}
+
+		/// Returns number of waiting clients.
+		/// \details Returns queue length.
+		/// \return Number of waiting clients.
+		int RTSPReconnectPolicy::getWaitingCount() const {
+			QMutexLocker locker(&private_->mutex_);
+			return private_->waiting_.size();
+		}
+
+		/// Grants slots to waiting clients while the limit allows it.
+		/// \details Destroyed clients are skipped. Must be called with the
+		/// lock held.
+		void RTSPReconnectPolicy::grant() {
+			auto& p = *private_;
+
+			while (p.active_ < p.limit_ && !p.waiting_.isEmpty()) {
+				auto waiter = p.waiting_.dequeue();
+				if (!waiter.client_) continue;
+
+				++p.active_;
+				p.granted_.append(waiter.client_.data());
+
+				QMetaObject::invokeMethod(waiter.client_.data(),
+										  waiter.member_.constData(),
+										  Qt::QueuedConnection);
+			}
+		}
+	}
+}
@@ -0,0 +1,117 @@
+/// \file RTSPReconnectPolicy.hpp
+/// \brief Contains classes and functions declarations that provide Real Time
+/// Streaming Protocol (RTSP) process-wide reconnect policy.
+/// \bug No known bugs.
+
+#ifndef RTSPRECONNECTPOLICY_HPP
+#define RTSPRECONNECTPOLICY_HPP
+
+#include "Base/Export.hpp"
+
+#include <QtCore>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		/// Class that provides process-wide RTSP reconnect policy.
+		/// \details Computes jittered exponential backoff delays and limits
+		/// the number of clients that reconnect at the same time, so that
+		/// cameras behind a rebooted switch do not reconnect at once.
+		/// Waiting clients are granted a slot in order through a queued slot
+		/// invocation on their own thread.
+		class RTSPCLIENT_EXPORT RTSPReconnectPolicy final {
+		public:
+
+			/// Returns process-wide reconnect policy.
+			/// \return Reconnect policy.
+			static RTSPReconnectPolicy& instance();
+
+		public:
+
+			/// Destructor.
+			~RTSPReconnectPolicy();
+
+			/// Copy constructor.
+			/// \param[in]	object	Object to copy.
+			RTSPReconnectPolicy(const RTSPReconnectPolicy& object) = delete;
+
+			/// Copy assignment operator.
+			/// \param[in]	object	Object to copy.
+			/// \return This object.
+			RTSPReconnectPolicy& operator=(
+				const RTSPReconnectPolicy& object) = delete;
+
+		public:
+
+			/// Returns maximum number of concurrent reconnects.
+			/// \return Maximum number of concurrent reconnects.
+			int getLimit() const;
+
+			/// Sets maximum number of concurrent reconnects.
+			/// \param[in]	limit	Maximum number of concurrent reconnects.
+			void setLimit(int limit);
+
+			/// Returns backoff delay bounds.
+			/// \return First and maximum delays in milliseconds.
+			QPair<qint64, qint64> getDelays() const;
+
+			/// Sets backoff delay bounds.
+			/// \param[in]	delays	First and maximum delays in milliseconds.
+			void setDelays(const QPair<qint64, qint64>& delays);
+
+			/// Returns backoff delay of a reconnect attempt.
+			/// \param[in]	attempt	Zero-based attempt number.
+			/// \return Delay in milliseconds.
+			qint64 getDelay(int attempt);
+
+			/// Requests a reconnect slot.
+			/// \param[in]	client	Client to notify.
+			/// \param[in]	member	Name of the slot invoked when the slot is
+			///						granted.
+			void acquire(QObject* client, const char* member);
+
+			/// Marks a granted client as notified.
+			/// \param[in]	client	Client.
+			void confirm(QObject* client);
+
+			/// Releases a granted reconnect slot.
+			void release();
+
+			/// Withdraws a request that has not been served by the client.
+			/// \param[in]	client	Client.
+			void cancel(QObject* client);
+
+			/// Returns number of granted reconnect slots.
+			/// \return Number of granted slots.
+			int getActiveCount() const;
+
+			/// Returns number of waiting clients.
+			/// \return Number of waiting clients.
+			int getWaitingCount() const;
+
+		private:
+
+			/// Default constructor.
+			explicit RTSPReconnectPolicy();
+
+			/// Grants slots to waiting clients while the limit allows it.
+			/// \details Must be called with the lock held.
+			void grant();
+
+		private:
+
+			/// Opaque type for private data.
+			struct RTSPReconnectPolicyPrivate;
+
+			/// Private data.
+			const QScopedPointer<RTSPReconnectPolicyPrivate> private_;
+		};
+	}
+}
+
+#endif
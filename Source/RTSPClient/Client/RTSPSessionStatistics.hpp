@@ -0,0 +1,52 @@
+/// \file RTSPSessionStatistics.hpp
+/// \brief Contains classes and functions declarations that provide Real Time
+/// Streaming Protocol (RTSP) session statistics.
+/// \bug No known bugs.
+
+#ifndef RTSPSESSIONSTATISTICS_HPP
+#define RTSPSESSIONSTATISTICS_HPP
+
+#include <QtGlobal>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		/// Structure that provides RTSP session bring-up statistics.
+		/// \details Times are measured in nanoseconds from the start of the
+		/// session opening. A negative value means the stage is not reached.
+		/// Authentication and reconnect counters cover the whole session.
+		struct RTSPSessionStatistics final {
+
+			/// Time when the session description is received.
+			qint64 described_ { -1 };
+
+			/// Time when the media stream is set up.
+			qint64 setUp_ { -1 };
+
+			/// Time when the playback is started.
+			qint64 played_ { -1 };
+
+			/// Time when the first RTP packet is received.
+			qint64 firstPacket_ { -1 };
+
+			/// Number of authentication challenges received.
+			quint64 authChallenges_ { 0 };
+
+			/// Number of round-trips saved by cached authentication.
+			quint64 savedRoundTrips_ { 0 };
+
+			/// Number of sessions restored after a lost connection.
+			quint64 reconnects_ { 0 };
+
+			/// Time from the last lost connection to the restored session.
+			qint64 recovery_ { -1 };
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,42 @@
+/// \file RTSPShardStatistics.hpp
+/// \brief Contains classes and functions declarations that provide Real Time
+/// Streaming Protocol (RTSP) client pool shard statistics.
+/// \bug No known bugs.
+
+#ifndef RTSPSHARDSTATISTICS_HPP
+#define RTSPSHARDSTATISTICS_HPP
+
+#include <QtGlobal>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		/// Structure that provides RTSP client pool shard statistics.
+		/// \details Rates and utilization are measured over the last balance
+		/// interval. Migration counters cover the whole pool lifetime.
+		struct RTSPShardStatistics final {
+
+			/// Number of sessions on the shard.
+			int sessions_ { 0 };
+
+			/// Number of RTP packets received per second.
+			double packetRate_ { 0 };
+
+			/// Share of time the worker thread spent processing events.
+			double utilization_ { 0 };
+
+			/// Number of sessions moved to the shard.
+			quint64 migratedIn_ { 0 };
+
+			/// Number of sessions moved from the shard.
+			quint64 migratedOut_ { 0 };
+		};
+	}
+}
+
+#endif
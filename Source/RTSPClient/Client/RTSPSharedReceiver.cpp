@@ -0,0 +1,503 @@
+/// \file RTSPSharedReceiver.cpp
+/// \brief Contains classes and functions definitions that provide Real Time
+/// Streaming Protocol (RTSP) shared media receiver.
+/// \bug No known bugs.
+
+#include "RTSPSharedReceiver.hpp"
+#include "RTSPClient.hpp"
+#include "Protocols/RTP/RTPSourceTable.hpp"
+#include "Utilities/AtomicCounter.hpp"
+#include "Utilities/DatagramReceiver.hpp"
+
+#include <QHash>
+#include <QMutex>
+#include <QSocketNotifier>
+#include <QThreadStorage>
+#include <QVector>
+#include <QtEndian>
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#ifdef Q_OS_LINUX
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		namespace {
+
+			/// Number of attempts to bind an even and odd port pair.
+			/// \details Ports picked by the system are random, about half of
+			/// the attempts get an even port.
+			constexpr int BIND_ATTEMPTS { 32 };
+
+			/// Maximum number of batches received per notification.
+			/// \details More than a session socket gets, since the sockets
+			/// carry many streams, yet bounded so that other events of the
+			/// thread are not starved.
+			constexpr int MAX_BATCHES { 32 };
+
+			/// Minimum RTP packet size.
+			/// \details Fixed header of RFC 3550.
+			constexpr int RTP_HEADER_SIZE { 12 };
+
+			/// Minimum RTCP packet size.
+			/// \details Common header and sender SSRC of RFC 3550.
+			constexpr int RTCP_HEADER_SIZE { 8 };
+
+			/// RTP protocol version.
+			/// \details Upper two bits of the first octet.
+			constexpr int RTP_VERSION { 2 };
+
+			/// Structure that describes the registry of all receivers.
+			struct Registry final {
+
+				/// Registry lock.
+				QMutex mutex_;
+
+				/// Receivers of the process.
+				std::vector<const RTSPSharedReceiver*> receivers_;
+			};
+
+			/// Returns registry of all receivers.
+			/// \details Never destroyed, so receivers of threads that finish
+			/// after the process exit starts can still leave it.
+			/// \return Receiver registry.
+			Registry& registry() {
+				static auto instance = new Registry;
+
+				return *instance;
+			}
+
+			/// Returns peer address of a connection.
+			/// \param[in]	connection	Socket descriptor.
+			/// \param[out]	address		IPv4 address in host byte order.
+			/// \retval true on success.
+			/// \retval false if the peer is not an IPv4 host.
+			bool peerAddress(qintptr connection, quint32* address) {
+#ifdef Q_OS_LINUX
+				sockaddr_in peer;
+				socklen_t size = sizeof(peer);
+
+				if (connection < 0 ||
+					::getpeername(static_cast<int>(connection),
+								  reinterpret_cast<sockaddr*>(&peer),
+								  &size) != 0 ||
+					peer.sin_family != AF_INET)
+					return false;
+
+				*address = ntohl(peer.sin_addr.s_addr);
+
+				return true;
+#else
+				Q_UNUSED(connection)
+				Q_UNUSED(address)
+
+				return false;
+#endif
+			}
+		}
+
+		/// Structure that provides private storage.
+		/// \details Maintains private data.
+		struct RTSPSharedReceiver::RTSPSharedReceiverPrivate final {
+
+			/// Structure that describes a registered session.
+			struct Session final {
+
+				/// IPv4 address of the server.
+				quint32 address_ { 0 };
+
+				/// Synchronization source ID (SSRC) or -1 until it is
+				/// learned.
+				qint64 source_ { -1 };
+			};
+
+			/// Batched receiver of RTP data.
+			/// \details Socket shared by all sessions of the thread.
+			DatagramReceiver rtp_;
+
+			/// Batched receiver of RTCP data.
+			/// \details Bound to the port after the RTP one.
+			DatagramReceiver rtcp_;
+
+			/// Notifier for RTP data.
+			/// \details Watches the RTP socket.
+			QScopedPointer<QSocketNotifier> rtpNotifier_;
+
+			/// Notifier for RTCP data.
+			/// \details Watches the RTCP socket.
+			QScopedPointer<QSocketNotifier> rtcpNotifier_;
+
+			/// Sessions by source address and SSRC.
+			/// \details Looked up for every datagram.
+			RTPSourceTable table_;
+
+			/// Registered sessions.
+			/// \details Touched on registration and SSRC learning only.
+			QHash<RTSPClient*, Session> sessions_;
+
+			/// Sessions with unknown SSRC in registration order.
+			/// \details The first RTP packet of an unknown SSRC from the
+			/// server of such a session binds it.
+			QVector<RTSPClient*> pending_;
+
+			/// Number of registered sessions.
+			/// \details Written by the owning thread only.
+			std::atomic<int> count_ { 0 };
+
+			/// Number of socket notifications.
+			/// \details Written by the owning thread only.
+			std::atomic<quint64> wakeups_ { 0 };
+
+			/// Number of receive system calls.
+			/// \details Written by the owning thread only.
+			std::atomic<quint64> syscalls_ { 0 };
+
+			/// Number of received datagrams.
+			/// \details Written by the owning thread only.
+			std::atomic<quint64> datagrams_ { 0 };
+
+			/// Number of datagrams that matched no session.
+			/// \details Written by the owning thread only.
+			std::atomic<quint64> unmatched_ { 0 };
+		};
+
+		/// Constructor.
+		/// \details Registers the receiver, sockets are opened by open().
+		/// \param[in]	parent	Parent object.
+		RTSPSharedReceiver::RTSPSharedReceiver(QObject* parent)
+			: QObject(parent),
+			  private_(new RTSPSharedReceiverPrivate) {
+
+			auto& instance = registry();
+			QMutexLocker locker(&instance.mutex_);
+			instance.receivers_.push_back(this);
+		}
+
+		/// Destructor.
+		/// \details Unregisters the receiver and closes the sockets.
+		RTSPSharedReceiver::~RTSPSharedReceiver() {
+			auto& instance = registry();
+			auto& receivers = instance.receivers_;
+
+			QMutexLocker locker(&instance.mutex_);
+			receivers.erase(std::remove(receivers.begin(),
+										receivers.end(),
+										this),
+							receivers.end());
+		}
+
+		/// Returns receiver shared by the calling thread.
+		/// \details The receiver is created on first use and deleted when
+		/// the thread finishes.
+		/// \return Shared receiver.
+		RTSPSharedReceiver& RTSPSharedReceiver::shared() {
+			static QThreadStorage<RTSPSharedReceiver*> storage;
+
+			if (!storage.hasLocalData())
+				storage.setLocalData(new RTSPSharedReceiver);
+
+			return *storage.localData();
+		}
+
+		/// Indicates whether shared receive is supported.
+		/// \details Supported where batched receive is.
+		/// \retval true if shared receive is supported.
+		/// \retval false if shared receive is not supported.
+		bool RTSPSharedReceiver::isSupported() noexcept {
+			return DatagramReceiver::isSupported();
+		}
+
+		/// Returns statistics of all receivers.
+		/// \details Safe to call from any thread. Receivers of finished
+		/// threads are not counted.
+		/// \return Statistics summed over all receivers.
+		RTSPSharedReceiverStatistics
+		RTSPSharedReceiver::getTotalStatistics() {
+			RTSPSharedReceiverStatistics total;
+
+			auto& instance = registry();
+			QMutexLocker locker(&instance.mutex_);
+
+			for (auto receiver : instance.receivers_) {
+				auto statistics = receiver->getStatistics();
+
+				total.sessions_ += statistics.sessions_;
+				total.wakeups_ += statistics.wakeups_;
+				total.syscalls_ += statistics.syscalls_;
+				total.datagrams_ += statistics.datagrams_;
+				total.unmatched_ += statistics.unmatched_;
+			}
+
+			return total;
+		}
+
+		/// Opens the sockets.
+		/// \details Binds RTP socket to an even port picked by the system and
+		/// RTCP socket to the next one, as RFC 3550 recommends. Does nothing
+		/// if the sockets are open.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool RTSPSharedReceiver::open() {
+			auto& p = *private_;
+
+			if (p.rtp_.isOpen()) return true;
+
+			for (auto attempt = 0; attempt < BIND_ATTEMPTS; ++attempt) {
+				if (!p.rtp_.open(0)) return false;
+
+				auto port = p.rtp_.getPort();
+
+				if (port % 2 == 0 && port < 0xFFFF &&
+					p.rtcp_.open(static_cast<quint16>(port + 1)))
+					break;
+
+				p.rtp_.close();
+			}
+
+			if (!p.rtp_.isOpen()) return false;
+
+			p.rtpNotifier_.reset(new QSocketNotifier(
+				p.rtp_.getDescriptor(), QSocketNotifier::Read));
+
+			p.rtcpNotifier_.reset(new QSocketNotifier(
+				p.rtcp_.getDescriptor(), QSocketNotifier::Read));
+
+			connect(
+				p.rtpNotifier_.data(),
+				SIGNAL(activated(int)),
+				SLOT(onRTPBatch())
+			);
+
+			connect(
+				p.rtcpNotifier_.data(),
+				SIGNAL(activated(int)),
+				SLOT(onRTCPBatch())
+			);
+
+			return true;
+		}
+
+		/// Indicates whether the sockets are open.
+		/// \details Checks the RTP socket.
+		/// \retval true if the sockets are open.
+		/// \retval false if the sockets are closed.
+		bool RTSPSharedReceiver::isOpen() const {
+			return private_->rtp_.isOpen();
+		}
+
+		/// Returns local RTP and RTCP ports.
+		/// \details Sessions request these ports in SETUP.
+		/// \return Local ports or zeros if the sockets are closed.
+		QPair<quint16, quint16> RTSPSharedReceiver::getPorts() const {
+			return { private_->rtp_.getPort(), private_->rtcp_.getPort() };
+		}
+
+		/// Registers a session.
+		/// \details Datagrams are matched by the address of the RTSP server
+		/// and the SSRC announced by SETUP response. If the server did not
+		/// announce it, the first RTP packet of an unknown SSRC from the
+		/// server binds the oldest such session of the server, so sessions
+		/// of one server with unknown SSRC should start playing one by one.
+		/// A registered session is registered again.
+		/// \param[in]	client		Client of the session.
+		/// \param[in]	connection	RTSP connection socket descriptor.
+		/// \param[in]	source		Synchronization source ID (SSRC), or
+		///							-1 if it is unknown.
+		/// \retval true on success.
+		/// \retval false if the sockets are closed or the server is not an
+		/// IPv4 host.
+		bool RTSPSharedReceiver::add(RTSPClient* client,
+									 qintptr connection,
+									 qint64 source) {
+			auto& p = *private_;
+
+			RTSPSharedReceiverPrivate::Session session;
+
+			if (!client || !isOpen() ||
+				!peerAddress(connection, &session.address_))
+				return false;
+
+			remove(client);
+
+			session.source_ = source;
+
+			if (source < 0) p.pending_.append(client);
+			else p.table_.insert(session.address_,
+								 static_cast<quint32>(source),
+								 client);
+
+			p.sessions_.insert(client, session);
+			p.count_.store(p.sessions_.size(), std::memory_order_relaxed);
+
+			return true;
+		}
+
+		/// Unregisters a session.
+		/// \details Does nothing if the session is not registered. An entry
+		/// taken over by another session with the same source is kept.
+		/// \param[in]	client	Client of the session.
+		void RTSPSharedReceiver::remove(RTSPClient* client) {
+			auto& p = *private_;
+			auto session = p.sessions_.find(client);
+
+			if (session == p.sessions_.end()) return;
+
+			auto address = session->address_;
+			auto source = static_cast<quint32>(session->source_);
+
+			if (session->source_ < 0) p.pending_.removeOne(client);
+			else if (p.table_.find(address, source) == client)
+				p.table_.remove(address, source);
+
+			p.sessions_.erase(session);
+			p.count_.store(p.sessions_.size(), std::memory_order_relaxed);
+		}
+
+		/// Sends RTCP data of a session.
+		/// \details Sends from the shared RTCP socket to the server address
+		/// of the session, so the server sees the port it was given by
+		/// SETUP request.
+		/// \param[in]	client	Client of the session.
+		/// \param[in]	port	Server RTCP port.
+		/// \param[in]	data	RTCP compound packet.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool RTSPSharedReceiver::send(RTSPClient* client,
+									  quint16 port,
+									  const QByteArray& data) {
+			auto& p = *private_;
+			auto session = p.sessions_.constFind(client);
+
+			if (session == p.sessions_.constEnd() || port == 0) return false;
+
+			return p.rtcp_.send(session->address_, port,
+								data.constData(), data.size());
+		}
+
+		/// Returns receiver statistics.
+		/// \details Safe to call from any thread.
+		/// \return Receiver statistics.
+		RTSPSharedReceiverStatistics
+		RTSPSharedReceiver::getStatistics() const {
+			const auto& p = *private_;
+			RTSPSharedReceiverStatistics statistics;
+
+			statistics.sessions_ = p.count_.load(std::memory_order_relaxed);
+			statistics.wakeups_ = p.wakeups_.load(std::memory_order_relaxed);
+			statistics.syscalls_ =
+				p.syscalls_.load(std::memory_order_relaxed);
+			statistics.datagrams_ =
+				p.datagrams_.load(std::memory_order_relaxed);
+			statistics.unmatched_ =
+				p.unmatched_.load(std::memory_order_relaxed);
+
+			return statistics;
+		}
+
+		/// Performs an action when receiving RTP data.
+		/// \details Receives pending RTP datagrams.
+		void RTSPSharedReceiver::onRTPBatch() {
+			receive(false);
+		}
+
+		/// Performs an action when receiving RTCP data.
+		/// \details Receives pending RTCP datagrams.
+		void RTSPSharedReceiver::onRTCPBatch() {
+			receive(true);
+		}
+
+		/// Receives and dispatches pending datagrams of a socket.
+		/// \details Receives up to a batch per system call and passes every
+		/// datagram to its session in place. The SSRC is taken from the
+		/// fixed RTP header or from the sender SSRC of the first RTCP
+		/// packet. Datagrams that match no session are dropped.
+		/// \param[in]	control	Whether the socket receives RTCP data.
+		void RTSPSharedReceiver::receive(bool control) {
+			auto& p = *private_;
+			auto& receiver = control ? p.rtcp_ : p.rtp_;
+			auto offset = control ? RTCP_HEADER_SIZE - 4 : RTP_HEADER_SIZE - 4;
+			auto minimum = control ? RTCP_HEADER_SIZE : RTP_HEADER_SIZE;
+
+			increment(p.wakeups_);
+
+			for (auto batch = 0; batch < MAX_BATCHES; ++batch) {
+				auto count = receiver.receive();
+
+				increment(p.syscalls_);
+
+				if (count <= 0) break;
+
+				increment(p.datagrams_, static_cast<quint64>(count));
+
+				for (auto i = 0; i < count; ++i) {
+					auto data = receiver.getData(i);
+					auto size = receiver.getSize(i);
+
+					RTSPClient* client = nullptr;
+
+					if (size >= minimum &&
+						(static_cast<quint8>(data[0]) >> 6) == RTP_VERSION)
+						client = match(
+							receiver.getAddress(i),
+							qFromBigEndian<quint32>(
+								reinterpret_cast<const uchar*>(data) + offset),
+							control);
+
+					if (!client) {
+						increment(p.unmatched_);
+						continue;
+					}
+
+					if (control) client->processRTCPPacket(data, size);
+					else client->processRTPPacket(data, size);
+				}
+
+				if (count < DatagramReceiver::getBatchSize()) break;
+			}
+		}
+
+		/// Finds the client of a datagram.
+		/// \details Looks the source up in the table. An RTP packet of an
+		/// unknown SSRC binds the oldest session of its server waiting for
+		/// one.
+		/// \param[in]	address	IPv4 source address.
+		/// \param[in]	source	Synchronization source ID (SSRC).
+		/// \param[in]	control	Whether the datagram is RTCP.
+		/// \return Client or nullptr if no session matches.
+		RTSPClient* RTSPSharedReceiver::match(quint32 address,
+											  quint32 source,
+											  bool control) {
+			auto& p = *private_;
+			auto client = static_cast<RTSPClient*>(
+				p.table_.find(address, source));
+
+			if (client || control || p.pending_.isEmpty()) return client;
+
+			for (auto i = 0; i < p.pending_.size(); ++i) {
+				auto& session = p.sessions_[p.pending_[i]];
+
+				if (session.address_ != address) continue;
+
+				client = p.pending_[i];
+				session.source_ = source;
+				p.pending_.remove(i);
+				p.table_.insert(address, source, client);
+
+				return client;
+			}
+
+			return nullptr;
+		}
+	}
+}
@@ -0,0 +1,134 @@
+/// \file RTSPSharedReceiver.hpp
+/// \brief Contains classes and functions declarations that provide Real Time
+/// Streaming Protocol (RTSP) shared media receiver.
+/// \bug No known bugs.
+
+#ifndef RTSPSHAREDRECEIVER_HPP
+#define RTSPSHAREDRECEIVER_HPP
+
+#include "Base/Export.hpp"
+#include "RTSPSharedReceiverStatistics.hpp"
+
+#include <QObject>
+#include <QPair>
+#include <QScopedPointer>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		class RTSPClient;
+
+		/// Class that provides shared RTP and RTCP receiver.
+		/// \details One pair of UDP sockets per thread receives media of all
+		/// sessions of the thread that enable shared receive. Datagrams are
+		/// received in batches and passed to sessions by source address and
+		/// synchronization source ID (SSRC), so the thread keeps two
+		/// descriptors and two notifiers whatever the number of sessions.
+		/// Only Linux is supported, where batched receive is available.
+		class RTSPCLIENT_EXPORT RTSPSharedReceiver final : public QObject {
+
+			Q_OBJECT
+
+		public:
+
+			/// Constructor.
+			/// \param[in]	parent	Parent object.
+			explicit RTSPSharedReceiver(QObject* parent = nullptr);
+
+			/// Destructor.
+			~RTSPSharedReceiver() override;
+
+		public:
+
+			/// Returns receiver shared by the calling thread.
+			/// \return Shared receiver.
+			static RTSPSharedReceiver& shared();
+
+			/// Indicates whether shared receive is supported.
+			/// \retval true if shared receive is supported.
+			/// \retval false if shared receive is not supported.
+			static bool isSupported() noexcept;
+
+			/// Returns statistics of all receivers.
+			/// \return Statistics summed over all receivers.
+			static RTSPSharedReceiverStatistics getTotalStatistics();
+
+			/// Opens the sockets.
+			/// \retval true on success.
+			/// \retval false on error.
+			bool open();
+
+			/// Indicates whether the sockets are open.
+			/// \retval true if the sockets are open.
+			/// \retval false if the sockets are closed.
+			bool isOpen() const;
+
+			/// Returns local RTP and RTCP ports.
+			/// \return Local ports or zeros if the sockets are closed.
+			QPair<quint16, quint16> getPorts() const;
+
+			/// Registers a session.
+			/// \param[in]	client		Client of the session.
+			/// \param[in]	connection	RTSP connection socket descriptor.
+			/// \param[in]	source		Synchronization source ID (SSRC), or
+			///							-1 if it is unknown.
+			/// \retval true on success.
+			/// \retval false on error.
+			bool add(RTSPClient* client, qintptr connection, qint64 source);
+
+			/// Unregisters a session.
+			/// \param[in]	client	Client of the session.
+			void remove(RTSPClient* client);
+
+			/// Sends RTCP data of a session.
+			/// \param[in]	client	Client of the session.
+			/// \param[in]	port	Server RTCP port.
+			/// \param[in]	data	RTCP compound packet.
+			/// \retval true on success.
+			/// \retval false on error.
+			bool send(RTSPClient* client,
+					  quint16 port,
+					  const QByteArray& data);
+
+			/// Returns receiver statistics.
+			/// \return Receiver statistics.
+			RTSPSharedReceiverStatistics getStatistics() const;
+
+		private slots:
+
+			/// Performs an action when receiving RTP data.
+			void onRTPBatch();
+
+			/// Performs an action when receiving RTCP data.
+			void onRTCPBatch();
+
+		private:
+
+			/// Receives and dispatches pending datagrams of a socket.
+			/// \param[in]	control	Whether the socket receives RTCP data.
+			void receive(bool control);
+
+			/// Finds the client of a datagram.
+			/// \param[in]	address	IPv4 source address.
+			/// \param[in]	source	Synchronization source ID (SSRC).
+			/// \param[in]	control	Whether the datagram is RTCP.
+			/// \return Client or nullptr if no session matches.
+			RTSPClient* match(quint32 address, quint32 source, bool control);
+
+		private:
+
+			/// Opaque type for private data.
+			struct RTSPSharedReceiverPrivate;
+
+			/// Private data.
+			const QScopedPointer<RTSPSharedReceiverPrivate> private_;
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,43 @@
+/// \file RTSPSharedReceiverStatistics.hpp
+/// \brief Contains classes and functions declarations that provide Real Time
+/// Streaming Protocol (RTSP) shared receiver statistics.
+/// \bug No known bugs.
+
+#ifndef RTSPSHAREDRECEIVERSTATISTICS_HPP
+#define RTSPSHAREDRECEIVERSTATISTICS_HPP
+
+#include <QtGlobal>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		/// Structure that provides RTSP shared receiver statistics.
+		/// \details Counters cover the whole receiver lifetime and both RTP
+		/// and RTCP sockets.
+		struct RTSPSharedReceiverStatistics final {
+
+			/// Number of sessions registered with the receiver.
+			int sessions_ { 0 };
+
+			/// Number of socket notifications.
+			/// \details Every notification is an event loop wakeup.
+			quint64 wakeups_ { 0 };
+
+			/// Number of receive system calls.
+			quint64 syscalls_ { 0 };
+
+			/// Number of received datagrams.
+			quint64 datagrams_ { 0 };
+
+			/// Number of datagrams that matched no session.
+			quint64 unmatched_ { 0 };
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,84 @@
+/// \file RTSPStreamStatistics.hpp
+/// \brief Contains classes and functions declarations that provide Real Time
+/// Streaming Protocol (RTSP) media stream statistics.
+/// \bug No known bugs.
+
+#ifndef RTSPSTREAMSTATISTICS_HPP
+#define RTSPSTREAMSTATISTICS_HPP
+
+#include <QtGlobal>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		/// Structure that provides RTSP media stream reception statistics.
+		/// \details Counters cover the whole life of the client, including
+		/// restored sessions. Loss and jitter follow RFC 3550, a new
+		/// synchronization source starts a new sequence number space.
+		struct RTSPStreamStatistics final {
+
+			/// Number of received RTP packets.
+			quint64 packets_ { 0 };
+
+			/// Number of received RTP bytes, headers included.
+			quint64 bytes_ { 0 };
+
+			/// Cumulative number of lost RTP packets.
+			/// \details Negative if duplicates outnumber lost packets.
+			qint64 lost_ { 0 };
+
+			/// Interarrival jitter in microseconds.
+			/// \details Zero if the clock rate of the stream is unknown.
+			qint64 jitter_ { 0 };
+
+			/// Number of receive system calls for UDP RTP data.
+			/// \details Batched receive reads many datagrams per call.
+			quint64 syscalls_ { 0 };
+
+			/// Number of received RTCP sender reports of the stream source.
+			quint64 senderReports_ { 0 };
+
+			/// Number of sent RTCP receiver reports.
+			quint64 receiverReports_ { 0 };
+
+			/// Number of lost RTP packets requested again.
+			/// \details A packet requested again is counted again.
+			quint64 retransmitRequests_ { 0 };
+
+			/// Number of lost RTP packets recovered by retransmission.
+			quint64 retransmitted_ { 0 };
+
+			/// Number of lost RTP packets given up without retransmission.
+			quint64 unrecovered_ { 0 };
+
+			/// Round-trip time to the sender in microseconds.
+			/// \details Measured by retransmissions of requested packets.
+			qint64 roundTrip_ { 0 };
+
+			/// Number of sent key frame requests.
+			quint64 keyFrameRequests_ { 0 };
+
+			/// Number of losses ended by a key frame.
+			/// \details Counted for H.264 and H.265 video only, whose key
+			/// frames are recognized.
+			quint64 recoveries_ { 0 };
+
+			/// Time from the last loss to the key frame that ended it in
+			/// microseconds.
+			qint64 recoveryTime_ { 0 };
+
+			/// Longest time from a loss to its key frame in microseconds.
+			qint64 maxRecoveryTime_ { 0 };
+
+			/// Mean time from a loss to its key frame in microseconds.
+			qint64 meanRecoveryTime_ { 0 };
+		};
+	}
+}
+
+#endif
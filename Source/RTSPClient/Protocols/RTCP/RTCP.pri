@@ -3,5 +3,17 @@
 #------------------------------------------------------------------------------#
 
 HEADERS			+=															\
+						$$PWD/RTCPCompoundWriter.hpp						\
+						$$PWD/RTCPInterval.hpp								\
+						$$PWD/RTCPNackList.hpp								\
+						$$PWD/RTCPPacketView.hpp							\
+						$$PWD/RTCPPictureLoss.hpp							\
+						$$PWD/RTCPSenderClock.hpp							\
 
 SOURCES			+=															\
+						$$PWD/RTCPCompoundWriter.cpp						\
+						$$PWD/RTCPInterval.cpp								\
+						$$PWD/RTCPNackList.cpp								\
+						$$PWD/RTCPPacketView.cpp							\
+						$$PWD/RTCPPictureLoss.cpp							\
+						$$PWD/RTCPSenderClock.cpp							\
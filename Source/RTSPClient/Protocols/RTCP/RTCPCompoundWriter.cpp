@@ -0,0 +1,264 @@
+/// \file RTCPCompoundWriter.cpp
+/// \brief Contains classes and functions definitions that provide Real-time
+/// Transport Control Protocol (RTCP) compound packet writer.
+/// \bug No known bugs.
+
+#include "RTCPCompoundWriter.hpp"
+
+#include <QtEndian>
+
+#include <algorithm>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		namespace {
+
+			/// Initial buffer capacity.
+			/// \details Fits a receiver report with a few blocks and a source
+			/// description.
+			constexpr int INITIAL_CAPACITY { 256 };
+
+			/// Maximum value of the count field.
+			/// \details The field is five bits wide.
+			constexpr int MAX_COUNT { 31 };
+
+			/// Maximum length of a source description item.
+			/// \details The length field is eight bits wide.
+			constexpr int MAX_ITEM_SIZE { 255 };
+
+			/// Number of words of a reception report block.
+			/// \details Report blocks are 24 bytes long.
+			constexpr int REPORT_BLOCK_WORDS { 6 };
+
+			/// Largest cumulative number of lost packets of a report block.
+			/// \details The field is a signed 24-bit value.
+			constexpr qint32 MAX_TOTAL_LOST { 0x7FFFFF };
+
+			/// Smallest cumulative number of lost packets of a report block.
+			/// \details The field is a signed 24-bit value.
+			constexpr qint32 MIN_TOTAL_LOST { -0x800000 };
+
+			/// Number of packets a generic negative acknowledgement item
+			/// follows after its first one.
+			/// \details The bitmask of lost packets is 16 bits wide.
+			constexpr int NACK_MASK_SIZE { 16 };
+
+			/// Returns the distance between sequence numbers.
+			/// \param[in]	from	First sequence number.
+			/// \param[in]	to		Second sequence number.
+			/// \return Distance in packets, modulo the sequence space.
+			inline int distance(quint16 from, quint16 to) noexcept {
+				return static_cast<quint16>(to - from);
+			}
+		}
+
+		/// Default constructor.
+		/// \details Reserves room for a typical receiver report.
+		RTCPCompoundWriter::RTCPCompoundWriter() {
+			data_.reserve(INITIAL_CAPACITY);
+		}
+
+		/// Destructor.
+		/// \details Default destructor.
+		RTCPCompoundWriter::~RTCPCompoundWriter() = default;
+
+		/// Appends a receiver report.
+		/// \details Blocks beyond the 31 a single report holds are dropped.
+		/// Cumulative loss is clamped to the signed 24-bit range as RFC 3550
+		/// section 6.4.1 requires.
+		/// \param[in]	source	Synchronization source ID (SSRC) of the
+		///						receiver.
+		/// \param[in]	reports	Report blocks.
+		/// \param[in]	count	Number of report blocks.
+		void RTCPCompoundWriter::appendReceiverReport(
+			quint32 source,
+			const RTCPReportBlock* reports,
+			int count) {
+
+			count = reports ? std::min(std::max(count, 0), MAX_COUNT) : 0;
+
+			appendHeader(count, RTCPPacketType::ReceiverReport,
+						 1 + count * REPORT_BLOCK_WORDS);
+			appendWord(source);
+
+			for (auto i = 0; i < count; ++i) {
+				const auto& report = reports[i];
+				auto lost = std::min(std::max(report.totalLost_,
+											  MIN_TOTAL_LOST),
+									 MAX_TOTAL_LOST);
+
+				appendWord(report.source_);
+				appendWord(static_cast<quint32>(report.fractionLost_) << 24 |
+						   (static_cast<quint32>(lost) & 0xFFFFFFu));
+				appendWord(report.extendedMaximum_);
+				appendWord(report.jitter_);
+				appendWord(report.lastReport_);
+				appendWord(report.delay_);
+			}
+		}
+
+		/// Appends a source description with a canonical name.
+		/// \details The chunk ends with a null item and is padded to a word
+		/// boundary. Names longer than an item holds are truncated.
+		/// \param[in]	source	Synchronization source ID (SSRC).
+		/// \param[in]	name	Canonical name.
+		void RTCPCompoundWriter::appendSourceDescription(
+			quint32 source,
+			const QByteArray& name) {
+
+			auto size = std::min(name.size(), MAX_ITEM_SIZE);
+			auto words = (2 + size + 1 + 3) / 4;
+
+			appendHeader(1, RTCPPacketType::SourceDescription, 1 + words);
+			appendWord(source);
+
+			data_.append(static_cast<char>(RTCPSourceItem::CanonicalName));
+			data_.append(static_cast<char>(size));
+			data_.append(name.constData(), size);
+
+			for (auto i = 2 + size; i < words * 4; ++i) data_.append('\0');
+		}
+
+		/// Appends a goodbye.
+		/// \details Announces that the source leaves the session, without a
+		/// reason.
+		/// \param[in]	source	Synchronization source ID (SSRC).
+		void RTCPCompoundWriter::appendGoodbye(quint32 source) {
+			appendHeader(1, RTCPPacketType::Goodbye, 1);
+			appendWord(source);
+		}
+
+		/// Appends a generic negative acknowledgement.
+		/// \details Packs the sequence numbers into RFC 4585 items, each of
+		/// which holds a lost packet and a bitmask of the sixteen packets
+		/// that follow it. Sequence numbers must be in increasing order,
+		/// modulo the sequence space. Nothing is appended without sequence
+		/// numbers.
+		/// \param[in]	source		Synchronization source ID (SSRC) of the
+		///							receiver.
+		/// \param[in]	media		Synchronization source ID (SSRC) of the
+		///							media source.
+		/// \param[in]	sequences	Sequence numbers of lost packets.
+		/// \param[in]	count		Number of sequence numbers.
+		void RTCPCompoundWriter::appendGenericNack(quint32 source,
+												   quint32 media,
+												   const quint16* sequences,
+												   int count) {
+
+			if (!sequences || count <= 0) return;
+
+			auto items = 0;
+
+			for (auto i = 0; i < count; ++items) {
+				auto first = sequences[i++];
+
+				while (i < count &&
+					   distance(first, sequences[i]) <= NACK_MASK_SIZE &&
+					   distance(first, sequences[i]) > 0)
+					++i;
+			}
+
+			appendHeader(static_cast<int>(RTCPTransportFeedback::GenericNack),
+						 RTCPPacketType::TransportFeedback, 2 + items);
+			appendWord(source);
+			appendWord(media);
+
+			for (auto i = 0; i < count; ) {
+				auto first = sequences[i++];
+				quint32 mask = 0;
+
+				while (i < count &&
+					   distance(first, sequences[i]) <= NACK_MASK_SIZE &&
+					   distance(first, sequences[i]) > 0)
+					mask |= 1u << (distance(first, sequences[i++]) - 1);
+
+				appendWord(static_cast<quint32>(first) << 16 | mask);
+			}
+		}
+
+		/// Appends a picture loss indication.
+		/// \details Asks the sender of the media source for a key frame, as
+		/// RFC 4585 section 6.3.1 defines. The indication carries no
+		/// parameters.
+		/// \param[in]	source	Synchronization source ID (SSRC) of the
+		///						receiver.
+		/// \param[in]	media	Synchronization source ID (SSRC) of the
+		///						media source.
+		void RTCPCompoundWriter::appendPictureLoss(quint32 source,
+												   quint32 media) {
+			appendHeader(static_cast<int>(RTCPPayloadFeedback::PictureLoss),
+						 RTCPPacketType::PayloadFeedback, 2);
+			appendWord(source);
+			appendWord(media);
+		}
+
+		/// Appends a full intra request.
+		/// \details Orders the sender of the media source to send a key
+		/// frame, as RFC 5104 section 4.3.1 defines. The media source field
+		/// of the header is zero and the source is named by the request
+		/// entry instead. Repetitions of a request keep its sequence number,
+		/// a new request increments it.
+		/// \param[in]	source		Synchronization source ID (SSRC) of the
+		///							receiver.
+		/// \param[in]	media		Synchronization source ID (SSRC) of the
+		///							media source.
+		/// \param[in]	sequence	Command sequence number.
+		void RTCPCompoundWriter::appendFullIntraRequest(quint32 source,
+														quint32 media,
+														quint8 sequence) {
+			appendHeader(
+				static_cast<int>(RTCPPayloadFeedback::FullIntraRequest),
+				RTCPPacketType::PayloadFeedback, 4);
+			appendWord(source);
+			appendWord(0);
+			appendWord(media);
+			appendWord(static_cast<quint32>(sequence) << 24);
+		}
+
+		/// Removes all packets.
+		/// \details Keeps the buffer allocated.
+		void RTCPCompoundWriter::clear() {
+			data_.resize(0);
+		}
+
+		/// Returns compound packet data.
+		/// \details Packets appear in the order they were appended. RFC 3550
+		/// requires a report first and a source description in every
+		/// compound packet.
+		/// \return Compound packet data.
+		const QByteArray& RTCPCompoundWriter::getData() const noexcept {
+			return data_;
+		}
+
+		/// Appends a common header.
+		/// \details Writes version 2 without padding.
+		/// \param[in]	count	Count field.
+		/// \param[in]	type	Packet type.
+		/// \param[in]	words	Number of 32-bit words after the header.
+		void RTCPCompoundWriter::appendHeader(int count,
+											  RTCPPacketType type,
+											  int words) {
+
+			appendWord(quint32 { 2 } << 30 |
+					   static_cast<quint32>(count & MAX_COUNT) << 24 |
+					   static_cast<quint32>(type) << 16 |
+					   static_cast<quint32>(words));
+		}
+
+		/// Appends a 32-bit word.
+		/// \details Stores the word in network byte order.
+		/// \param[in]	word	Word in host byte order.
+		void RTCPCompoundWriter::appendWord(quint32 word) {
+			char bytes[4];
+			qToBigEndian(word, bytes);
+
+			data_.append(bytes, sizeof(bytes));
+		}
+	}
+}
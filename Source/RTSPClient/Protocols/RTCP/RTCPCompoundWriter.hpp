@@ -0,0 +1,108 @@
+/// \file RTCPCompoundWriter.hpp
+/// \brief Contains classes and functions declarations that provide Real-time
+/// Transport Control Protocol (RTCP) compound packet writer.
+/// \bug No known bugs.
+
+#ifndef RTCPCOMPOUNDWRITER_HPP
+#define RTCPCOMPOUNDWRITER_HPP
+
+#include "RTCPPacketView.hpp"
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		/// Class that provides RTCP compound packet writer.
+		/// \details Appends packets one after another into a single buffer
+		/// that is sent as one datagram.
+		class RTSPCLIENT_EXPORT RTCPCompoundWriter final {
+		public:
+
+			/// Default constructor.
+			explicit RTCPCompoundWriter();
+
+			/// Destructor.
+			~RTCPCompoundWriter();
+
+		public:
+
+			/// Appends a receiver report.
+			/// \param[in]	source	Synchronization source ID (SSRC) of the
+			///						receiver.
+			/// \param[in]	reports	Report blocks.
+			/// \param[in]	count	Number of report blocks.
+			void appendReceiverReport(quint32 source,
+									  const RTCPReportBlock* reports,
+									  int count);
+
+			/// Appends a source description with a canonical name.
+			/// \param[in]	source	Synchronization source ID (SSRC).
+			/// \param[in]	name	Canonical name.
+			void appendSourceDescription(quint32 source,
+										 const QByteArray& name);
+
+			/// Appends a goodbye.
+			/// \param[in]	source	Synchronization source ID (SSRC).
+			void appendGoodbye(quint32 source);
+
+			/// Appends a generic negative acknowledgement.
+			/// \param[in]	source		Synchronization source ID (SSRC) of the
+			///							receiver.
+			/// \param[in]	media		Synchronization source ID (SSRC) of the
+			///							media source.
+			/// \param[in]	sequences	Sequence numbers of lost packets.
+			/// \param[in]	count		Number of sequence numbers.
+			void appendGenericNack(quint32 source,
+								   quint32 media,
+								   const quint16* sequences,
+								   int count);
+
+			/// Appends a picture loss indication.
+			/// \param[in]	source	Synchronization source ID (SSRC) of the
+			///						receiver.
+			/// \param[in]	media	Synchronization source ID (SSRC) of the
+			///						media source.
+			void appendPictureLoss(quint32 source, quint32 media);
+
+			/// Appends a full intra request.
+			/// \param[in]	source		Synchronization source ID (SSRC) of the
+			///							receiver.
+			/// \param[in]	media		Synchronization source ID (SSRC) of the
+			///							media source.
+			/// \param[in]	sequence	Command sequence number.
+			void appendFullIntraRequest(quint32 source,
+										quint32 media,
+										quint8 sequence);
+
+			/// Removes all packets.
+			void clear();
+
+			/// Returns compound packet data.
+			/// \return Compound packet data.
+			const QByteArray& getData() const noexcept;
+
+		private:
+
+			/// Appends a common header.
+			/// \param[in]	count	Count field.
+			/// \param[in]	type	Packet type.
+			/// \param[in]	words	Number of 32-bit words after the header.
+			void appendHeader(int count, RTCPPacketType type, int words);
+
+			/// Appends a 32-bit word.
+			/// \param[in]	word	Word in host byte order.
+			void appendWord(quint32 word);
+
+		private:
+
+			/// Compound packet data.
+			QByteArray data_;
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,139 @@
+/// \file RTCPInterval.cpp
+/// \brief Contains classes and functions definitions that provide Real-time
+/// Transport Control Protocol (RTCP) report interval calculation.
+/// \bug No known bugs.
+
+#include "RTCPInterval.hpp"
+
+#include <algorithm>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		namespace {
+
+			/// Minimum interval between reports.
+			/// \details Five seconds as RFC 3550 section 6.2 recommends, half
+			/// of it before the first report.
+			constexpr double MINIMUM_INTERVAL { 5.0 };
+
+			/// Fraction of session bandwidth taken by RTCP.
+			/// \details Five percent of the session bandwidth.
+			constexpr double RTCP_FRACTION { 0.05 };
+
+			/// Fraction of RTCP bandwidth shared by senders.
+			/// \details Receivers share the remaining three quarters.
+			constexpr double SENDER_FRACTION { 0.25 };
+
+			/// Size of lower layer headers of a report.
+			/// \details UDP and IPv4 headers count towards the report size.
+			constexpr int HEADERS_SIZE { 28 };
+
+			/// Probable size of the first report.
+			/// \details A receiver report with one block and a source
+			/// description with a short canonical name.
+			constexpr double INITIAL_SIZE { 64 + HEADERS_SIZE };
+		}
+
+		/// Default constructor.
+		/// \details Seeds randomization from the system, so that receivers
+		/// started together do not report in step.
+		RTCPInterval::RTCPInterval()
+			: averageSize_(INITIAL_SIZE),
+			  random_(std::random_device()()) {
+
+		}
+
+		/// Destructor.
+		/// \details Default destructor.
+		RTCPInterval::~RTCPInterval() = default;
+
+		/// Starts over as a new session participant.
+		/// \details The next interval is an initial one again. Session
+		/// bandwidth is kept.
+		void RTCPInterval::reset() noexcept {
+			members_ = 2;
+			senders_ = 1;
+			averageSize_ = INITIAL_SIZE;
+			initial_ = true;
+		}
+
+		/// Returns session bandwidth.
+		/// \details Returns the bandwidth the interval is scaled by.
+		/// \return Session bandwidth in bits per second, zero if it is
+		/// unknown.
+		qint64 RTCPInterval::getBandwidth() const noexcept {
+			return bandwidth_;
+		}
+
+		/// Sets session bandwidth.
+		/// \details Unknown bandwidth leaves the minimum interval.
+		/// \param[in]	bandwidth	Session bandwidth in bits per second,
+		///							zero if it is unknown.
+		void RTCPInterval::setBandwidth(qint64 bandwidth) noexcept {
+			bandwidth_ = std::max<qint64>(bandwidth, 0);
+		}
+
+		/// Sets number of session members.
+		/// \details There are at least two members, the sender and this
+		/// receiver.
+		/// \param[in]	members	Number of members, the receiver included.
+		/// \param[in]	senders	Number of members that send RTP data.
+		void RTCPInterval::setMembers(int members, int senders) noexcept {
+			members_ = std::max(members, 2);
+			senders_ = std::min(std::max(senders, 0), members_ - 1);
+		}
+
+		/// Updates the average report size with a sent or received
+		/// report.
+		/// \details Follows RFC 3550 section 6.3.3, a report weighs one
+		/// sixteenth.
+		/// \param[in]	size	Compound packet size.
+		void RTCPInterval::update(int size) noexcept {
+			averageSize_ += ((size + HEADERS_SIZE) - averageSize_) / 16;
+		}
+
+		/// Returns average report size.
+		/// \details Includes UDP and IPv4 headers.
+		/// \return Average report size in bytes, lower layer headers
+		/// included.
+		double RTCPInterval::getAverageSize() const noexcept {
+			return averageSize_;
+		}
+
+		/// Returns the delay until the next report.
+		/// \details Calculates the interval of a receiver as RFC 3550
+		/// appendix A.7 describes. Receivers share three quarters of the RTCP
+		/// bandwidth unless senders are a quarter of the members or more. The
+		/// interval is randomized between half and one and a half of the
+		/// calculated one. Timer reconsideration is not done, so the interval
+		/// is not divided by its compensation.
+		/// \return Delay in milliseconds.
+		qint64 RTCPInterval::next() {
+			auto minimum = initial_ ? MINIMUM_INTERVAL / 2 : MINIMUM_INTERVAL;
+			auto bandwidth = bandwidth_ / 8.0 * RTCP_FRACTION;
+			auto members = static_cast<double>(members_);
+
+			if (senders_ <= members_ * SENDER_FRACTION) {
+				bandwidth *= 1 - SENDER_FRACTION;
+				members -= senders_;
+			}
+
+			auto interval =
+				bandwidth > 0
+				? std::max(averageSize_ * members / bandwidth, minimum)
+				: minimum;
+
+			std::uniform_real_distribution<double> spread(0.5, 1.5);
+
+			initial_ = false;
+
+			return static_cast<qint64>(interval * spread(random_) * 1000);
+		}
+	}
+}
@@ -0,0 +1,93 @@
+/// \file RTCPInterval.hpp
+/// \brief Contains classes and functions declarations that provide Real-time
+/// Transport Control Protocol (RTCP) report interval calculation.
+/// \bug No known bugs.
+
+#ifndef RTCPINTERVAL_HPP
+#define RTCPINTERVAL_HPP
+
+#include "Base/Export.hpp"
+
+#include <QtGlobal>
+
+#include <random>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		/// Class that provides RTCP report interval calculation.
+		/// \details Scales the interval between reports with the number of
+		/// session members and the average report size, so RTCP traffic of
+		/// the session stays within five percent of its bandwidth.
+		class RTSPCLIENT_EXPORT RTCPInterval final {
+		public:
+
+			/// Default constructor.
+			explicit RTCPInterval();
+
+			/// Destructor.
+			~RTCPInterval();
+
+		public:
+
+			/// Starts over as a new session participant.
+			void reset() noexcept;
+
+			/// Returns session bandwidth.
+			/// \return Session bandwidth in bits per second, zero if it is
+			/// unknown.
+			qint64 getBandwidth() const noexcept;
+
+			/// Sets session bandwidth.
+			/// \param[in]	bandwidth	Session bandwidth in bits per second,
+			///							zero if it is unknown.
+			void setBandwidth(qint64 bandwidth) noexcept;
+
+			/// Sets number of session members.
+			/// \param[in]	members	Number of members, the receiver included.
+			/// \param[in]	senders	Number of members that send RTP data.
+			void setMembers(int members, int senders) noexcept;
+
+			/// Updates the average report size with a sent or received
+			/// report.
+			/// \param[in]	size	Compound packet size.
+			void update(int size) noexcept;
+
+			/// Returns average report size.
+			/// \return Average report size in bytes, lower layer headers
+			/// included.
+			double getAverageSize() const noexcept;
+
+			/// Returns the delay until the next report.
+			/// \return Delay in milliseconds.
+			qint64 next();
+
+		private:
+
+			/// Session bandwidth in bits per second.
+			qint64 bandwidth_ { 0 };
+
+			/// Number of members.
+			int members_ { 2 };
+
+			/// Number of senders.
+			int senders_ { 1 };
+
+			/// Average report size in bytes.
+			double averageSize_ { 0 };
+
+			/// Whether no report was sent yet.
+			bool initial_ { true };
+
+			/// Randomization source.
+			std::minstd_rand random_;
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,348 @@
+/// \file RTCPNackList.cpp
+/// \brief Contains classes and functions definitions that provide Real-time
+/// Transport Control Protocol (RTCP) negative acknowledgement scheduling.
+/// \bug No known bugs.
+
+#include "RTCPNackList.hpp"
+#include "Utilities/AtomicCounter.hpp"
+
+#include <algorithm>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		namespace {
+
+			/// Delay before a gap is requested.
+			/// \details Five milliseconds, enough for packets reordered by the
+			/// network to fill most gaps first.
+			constexpr qint64 REORDER_DELAY { 5000000 };
+
+			/// Shortest delay before a packet is requested again.
+			/// \details Ten milliseconds, which keeps requests on a short
+			/// path from flooding the sender.
+			constexpr qint64 MIN_RETRY_DELAY { 10000000 };
+
+			/// Maximum number of requests of a packet.
+			/// \details A packet whose retransmissions were lost this many
+			/// times is given up.
+			constexpr int MAX_REQUESTS { 4 };
+
+			/// Round-trip time before the first measurement.
+			/// \details A hundred milliseconds.
+			constexpr qint64 DEFAULT_ROUND_TRIP { 100000000 };
+
+			/// Age after which a missing packet is given up.
+			/// \details Half a second, about the delay of a live player.
+			constexpr qint64 DEFAULT_MAX_DELAY { 500000000 };
+
+			/// Weight of the previous round-trip time in the smoothed one.
+			/// \details Seven eighths, as TCP smooths it.
+			constexpr qint64 ROUND_TRIP_WEIGHT { 8 };
+		}
+
+		/// Default constructor.
+		/// \details Starts without packets and with the default round-trip
+		/// time.
+		RTCPNackList::RTCPNackList() noexcept
+			: roundTrip_(DEFAULT_ROUND_TRIP),
+			  maxDelay_(DEFAULT_MAX_DELAY),
+			  sharedRoundTrip_(DEFAULT_ROUND_TRIP) {
+
+		}
+
+		/// Destructor.
+		/// \details Default destructor.
+		RTCPNackList::~RTCPNackList() = default;
+
+		/// Drops missing packets and the sequence.
+		/// \details Called when the source changes or restarts. Dropped
+		/// packets are not counted as given up, round-trip time and
+		/// statistics are kept.
+		void RTCPNackList::reset() noexcept {
+			active_ = false;
+			begin_ = highest_ = 0;
+			missing_ = 0;
+			deadline_ = -1;
+		}
+
+		/// Updates the list with a received original packet.
+		/// \details A packet beyond the highest one marks the packets in
+		/// between as missing, a gap wider than the list gives up every
+		/// missing packet. The oldest packets leave the list as new ones
+		/// come. A missing packet that arrives late counts as recovered if it
+		/// was requested, since senders may retransmit without RFC 4588.
+		/// Must be called for packets the stream accepted only.
+		/// \param[in]	sequence	RTP sequence number.
+		/// \param[in]	now			Arrival time in nanoseconds.
+		void RTCPNackList::update(quint16 sequence, qint64 now) noexcept {
+			if (!active_) {
+				active_ = true;
+				begin_ = highest_ = sequence;
+				entry(highest_).missing_ = false;
+				return;
+			}
+
+			auto extended = extend(sequence);
+
+			if (extended <= highest_) {
+				if (extended < begin_) return;
+
+				auto& item = entry(extended);
+
+				if (!item.missing_) return;
+
+				item.missing_ = false;
+				--missing_;
+
+				increment(item.requests_ > 0 ? recovered_ : reordered_);
+				return;
+			}
+
+			if (extended - highest_ > CAPACITY) {
+				for (; begin_ < highest_; ++begin_)
+					if (entry(begin_).missing_) drop(entry(begin_));
+
+				begin_ = highest_ = extended;
+				entry(highest_).missing_ = false;
+				return;
+			}
+
+			for (; extended - begin_ >= CAPACITY; ++begin_)
+				if (entry(begin_).missing_) drop(entry(begin_));
+
+			if (extended - highest_ > 1 &&
+				(deadline_ < 0 || deadline_ > now + REORDER_DELAY))
+				deadline_ = now + REORDER_DELAY;
+
+			for (auto i = highest_ + 1; i < extended; ++i) {
+				auto& item = entry(i);
+				item.missing_ = true;
+				item.requests_ = 0;
+				item.detected_ = now;
+				item.sent_ = 0;
+
+				++missing_;
+			}
+
+			highest_ = extended;
+			entry(highest_).missing_ = false;
+		}
+
+		/// Updates the list with a received retransmission.
+		/// \details A retransmission of a packet requested once measures the
+		/// round-trip time. Retransmissions of packets requested again are
+		/// ambiguous and are not measured, as Karn's algorithm prescribes.
+		/// \param[in]	sequence	Original RTP sequence number.
+		/// \param[in]	now			Arrival time in nanoseconds.
+		/// \retval true if the packet was missing.
+		/// \retval false if the packet is a duplicate or too old.
+		bool RTCPNackList::recover(quint16 sequence, qint64 now) noexcept {
+			if (!active_) return false;
+
+			auto extended = extend(sequence);
+
+			if (extended < begin_ || extended >= highest_) return false;
+
+			auto& item = entry(extended);
+
+			if (!item.missing_) return false;
+
+			item.missing_ = false;
+			--missing_;
+
+			increment(recovered_);
+
+			if (item.requests_ == 1 && now > item.sent_) {
+				roundTrip_ += (now - item.sent_ - roundTrip_) /
+							  ROUND_TRIP_WEIGHT;
+
+				sharedRoundTrip_.store(roundTrip_, std::memory_order_relaxed);
+			}
+
+			return true;
+		}
+
+		/// Collects missing packets to request.
+		/// \details Requests a gap once the reorder delay passed and again
+		/// after one and a half round-trip times. A packet is given up when
+		/// a retransmission requested now would arrive after the maximum
+		/// delay, or when its last request went unanswered. Packets beyond
+		/// the capacity are requested by the next call. Updates the time of
+		/// the next request.
+		/// \param[in]	now			Current time in nanoseconds.
+		/// \param[out]	sequences	Sequence numbers in increasing order.
+		/// \param[in]	capacity	Room for sequence numbers.
+		/// \return Number of sequence numbers.
+		int RTCPNackList::collect(qint64 now,
+								  quint16* sequences,
+								  int capacity) noexcept {
+			auto count = 0;
+			auto retry = retryDelay();
+
+			deadline_ = -1;
+
+			while (begin_ < highest_ && !entry(begin_).missing_) ++begin_;
+
+			auto left = missing_;
+
+			for (auto i = begin_; i < highest_ && left > 0; ++i) {
+				auto& item = entry(i);
+
+				if (!item.missing_) continue;
+
+				--left;
+
+				auto expiry = item.detected_ + maxDelay_ - roundTrip_;
+
+				if (now >= expiry ||
+					(item.requests_ >= MAX_REQUESTS &&
+					 now >= item.sent_ + retry)) {
+					drop(item);
+					continue;
+				}
+
+				auto due = item.requests_ == 0
+						   ? item.detected_ + REORDER_DELAY
+						   : item.sent_ + retry;
+
+				if (due <= now && item.requests_ < MAX_REQUESTS) {
+					if (count < capacity) {
+						sequences[count++] = static_cast<quint16>(i);
+						item.sent_ = now;
+						++item.requests_;
+
+						increment(requested_);
+						due = now + retry;
+					}
+					else due = now;
+				}
+
+				due = std::min(due, expiry);
+				deadline_ = deadline_ < 0 ? due : std::min(deadline_, due);
+			}
+
+			return count;
+		}
+
+		/// Returns the time of the next request.
+		/// \details Calling collect() earlier returns nothing, calling it
+		/// later delays requests.
+		/// \return Time in nanoseconds, or -1 if no packet is missing.
+		qint64 RTCPNackList::getDeadline() const noexcept {
+			return missing_ > 0 ? deadline_ : -1;
+		}
+
+		/// Indicates whether a packet is missing.
+		/// \details Missing packets are the ones neither received, recovered
+		/// nor given up.
+		/// \retval true if no packet is missing.
+		/// \retval false if a packet is missing.
+		bool RTCPNackList::isEmpty() const noexcept {
+			return missing_ == 0;
+		}
+
+		/// Returns smoothed round-trip time.
+		/// \details Safe to call from any thread.
+		/// \return Round-trip time in nanoseconds.
+		qint64 RTCPNackList::getRoundTrip() const noexcept {
+			return sharedRoundTrip_.load(std::memory_order_relaxed);
+		}
+
+		/// Sets round-trip time before the first measurement.
+		/// \details Retransmissions refine it later. Non-positive values are
+		/// ignored.
+		/// \param[in]	roundTrip	Round-trip time in nanoseconds.
+		void RTCPNackList::setRoundTrip(qint64 roundTrip) noexcept {
+			if (roundTrip <= 0) return;
+
+			roundTrip_ = roundTrip;
+			sharedRoundTrip_.store(roundTrip_, std::memory_order_relaxed);
+		}
+
+		/// Returns the age after which a missing packet is given up.
+		/// \details Returns the playout delay the list works for.
+		/// \return Age in nanoseconds.
+		qint64 RTCPNackList::getMaxDelay() const noexcept {
+			return maxDelay_;
+		}
+
+		/// Sets the age after which a missing packet is given up.
+		/// \details A retransmission that arrives later than the player
+		/// needs the packet is useless, so requests stop before that.
+		/// \param[in]	maxDelay	Age in nanoseconds.
+		void RTCPNackList::setMaxDelay(qint64 maxDelay) noexcept {
+			maxDelay_ = maxDelay;
+		}
+
+		/// Returns number of packets given up.
+		/// \details Must be called from the receiving thread, which is the
+		/// only writer of the counter, so it is read without the other
+		/// statistics.
+		/// \return Number of packets given up.
+		quint64 RTCPNackList::getUnrecovered() const noexcept {
+			return unrecovered_.load(std::memory_order_relaxed);
+		}
+
+		/// Returns retransmission statistics.
+		/// \details Safe to call from any thread. Counters are read one by
+		/// one, so they may belong to adjacent packets.
+		/// \return Retransmission statistics.
+		RTCPNackStatistics RTCPNackList::getStatistics() const noexcept {
+			RTCPNackStatistics statistics;
+			statistics.requested_ =
+				requested_.load(std::memory_order_relaxed);
+			statistics.recovered_ =
+				recovered_.load(std::memory_order_relaxed);
+			statistics.reordered_ =
+				reordered_.load(std::memory_order_relaxed);
+			statistics.unrecovered_ =
+				unrecovered_.load(std::memory_order_relaxed);
+			statistics.roundTrip_ = getRoundTrip();
+
+			return statistics;
+		}
+
+		/// Returns the entry of an extended sequence number.
+		/// \details The ring holds the last packets of the list.
+		/// \param[in]	sequence	Extended sequence number.
+		/// \return Entry.
+		RTCPNackList::Entry& RTCPNackList::entry(qint64 sequence) noexcept {
+			return entries_[static_cast<std::size_t>(sequence) &
+							(CAPACITY - 1)];
+		}
+
+		/// Returns the extended sequence number of a received packet.
+		/// \details Sequence numbers less than half the sequence space from
+		/// the highest one are taken as the nearest ones.
+		/// \param[in]	sequence	RTP sequence number.
+		/// \return Extended sequence number nearest to the highest one.
+		qint64 RTCPNackList::extend(quint16 sequence) const noexcept {
+			return highest_ + static_cast<qint16>(
+				sequence - static_cast<quint16>(highest_));
+		}
+
+		/// Gives up a missing packet.
+		/// \details Counts the packet as unrecovered.
+		/// \param[in]	item	Entry of the packet.
+		void RTCPNackList::drop(Entry& item) noexcept {
+			item.missing_ = false;
+			--missing_;
+
+			increment(unrecovered_);
+		}
+
+		/// Returns the delay before a packet is requested again.
+		/// \details One and a half round-trip times leave room for jitter of
+		/// the retransmission.
+		/// \return Delay in nanoseconds.
+		qint64 RTCPNackList::retryDelay() const noexcept {
+			return std::max(roundTrip_ + roundTrip_ / 2, MIN_RETRY_DELAY);
+		}
+	}
+}
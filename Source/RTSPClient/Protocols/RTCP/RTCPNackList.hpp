@@ -0,0 +1,217 @@
+/// \file RTCPNackList.hpp
+/// \brief Contains classes and functions declarations that provide Real-time
+/// Transport Control Protocol (RTCP) negative acknowledgement scheduling.
+/// \bug No known bugs.
+
+#ifndef RTCPNACKLIST_HPP
+#define RTCPNACKLIST_HPP
+
+#include "Base/Export.hpp"
+
+#include <QtGlobal>
+
+#include <array>
+#include <atomic>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		/// Structure that provides retransmission statistics.
+		/// \details Counters cover the whole life of the list, resets
+		/// included.
+		struct RTCPNackStatistics final {
+
+			/// Number of requested retransmissions.
+			/// \details A packet requested again is counted again.
+			quint64 requested_ { 0 };
+
+			/// Number of lost packets recovered by retransmission.
+			quint64 recovered_ { 0 };
+
+			/// Number of missing packets that arrived late before they were
+			/// requested.
+			quint64 reordered_ { 0 };
+
+			/// Number of lost packets given up.
+			quint64 unrecovered_ { 0 };
+
+			/// Smoothed round-trip time in nanoseconds.
+			qint64 roundTrip_ { 0 };
+		};
+
+		/// Class that provides RTCP negative acknowledgement scheduling.
+		/// \details Tracks sequence number gaps of a source as RFC 4585
+		/// generic negative acknowledgements need them. A gap is requested
+		/// once reordering had a moment to fill it, then again after a
+		/// round-trip time, until it is recovered, retries are exhausted or
+		/// a retransmission could not arrive in time anymore. The receiving
+		/// thread updates the list, any thread reads statistics without
+		/// locks.
+		class RTSPCLIENT_EXPORT RTCPNackList final {
+		public:
+
+			/// Default constructor.
+			explicit RTCPNackList() noexcept;
+
+			/// Destructor.
+			~RTCPNackList();
+
+			/// Copy constructor.
+			/// \param[in]	object	Object to copy.
+			RTCPNackList(const RTCPNackList& object) = delete;
+
+			/// Copy assignment operator.
+			/// \param[in]	object	Object to copy.
+			/// \return This object.
+			RTCPNackList& operator=(const RTCPNackList& object) = delete;
+
+		public:
+
+			/// Drops missing packets and the sequence.
+			void reset() noexcept;
+
+			/// Updates the list with a received original packet.
+			/// \param[in]	sequence	RTP sequence number.
+			/// \param[in]	now			Arrival time in nanoseconds.
+			void update(quint16 sequence, qint64 now) noexcept;
+
+			/// Updates the list with a received retransmission.
+			/// \param[in]	sequence	Original RTP sequence number.
+			/// \param[in]	now			Arrival time in nanoseconds.
+			/// \retval true if the packet was missing.
+			/// \retval false if the packet is a duplicate or too old.
+			bool recover(quint16 sequence, qint64 now) noexcept;
+
+			/// Collects missing packets to request.
+			/// \param[in]	now			Current time in nanoseconds.
+			/// \param[out]	sequences	Sequence numbers in increasing order.
+			/// \param[in]	capacity	Room for sequence numbers.
+			/// \return Number of sequence numbers.
+			int collect(qint64 now, quint16* sequences, int capacity) noexcept;
+
+			/// Returns the time of the next request.
+			/// \return Time in nanoseconds, or -1 if no packet is missing.
+			qint64 getDeadline() const noexcept;
+
+			/// Indicates whether a packet is missing.
+			/// \retval true if no packet is missing.
+			/// \retval false if a packet is missing.
+			bool isEmpty() const noexcept;
+
+			/// Returns smoothed round-trip time.
+			/// \return Round-trip time in nanoseconds.
+			qint64 getRoundTrip() const noexcept;
+
+			/// Sets round-trip time before the first measurement.
+			/// \param[in]	roundTrip	Round-trip time in nanoseconds.
+			void setRoundTrip(qint64 roundTrip) noexcept;
+
+			/// Returns the age after which a missing packet is given up.
+			/// \return Age in nanoseconds.
+			qint64 getMaxDelay() const noexcept;
+
+			/// Sets the age after which a missing packet is given up.
+			/// \param[in]	maxDelay	Age in nanoseconds.
+			void setMaxDelay(qint64 maxDelay) noexcept;
+
+			/// Returns number of packets given up.
+			/// \return Number of packets given up.
+			quint64 getUnrecovered() const noexcept;
+
+			/// Returns retransmission statistics.
+			/// \return Retransmission statistics.
+			RTCPNackStatistics getStatistics() const noexcept;
+
+		private:
+
+			/// Structure that describes a missing packet.
+			struct Entry final {
+
+				/// Whether the packet is missing.
+				bool missing_ { false };
+
+				/// Number of requests.
+				int requests_ { 0 };
+
+				/// Time the gap was detected in nanoseconds.
+				qint64 detected_ { 0 };
+
+				/// Time of the last request in nanoseconds.
+				qint64 sent_ { 0 };
+			};
+
+			/// Number of tracked packets.
+			/// \details A power of two, so the extended sequence number
+			/// indexes the ring.
+			static constexpr int CAPACITY { 1024 };
+
+		private:
+
+			/// Returns the entry of an extended sequence number.
+			/// \param[in]	sequence	Extended sequence number.
+			/// \return Entry.
+			Entry& entry(qint64 sequence) noexcept;
+
+			/// Returns the extended sequence number of a received packet.
+			/// \param[in]	sequence	RTP sequence number.
+			/// \return Extended sequence number nearest to the highest one.
+			qint64 extend(quint16 sequence) const noexcept;
+
+			/// Gives up a missing packet.
+			/// \param[in]	item	Entry of the packet.
+			void drop(Entry& item) noexcept;
+
+			/// Returns the delay before a packet is requested again.
+			/// \return Delay in nanoseconds.
+			qint64 retryDelay() const noexcept;
+
+		private:
+
+			/// Tracked packets.
+			std::array<Entry, CAPACITY> entries_;
+
+			/// Whether a packet was received.
+			bool active_ { false };
+
+			/// Extended sequence number of the oldest tracked packet.
+			qint64 begin_ { 0 };
+
+			/// Highest extended sequence number received.
+			qint64 highest_ { 0 };
+
+			/// Number of missing packets.
+			int missing_ { 0 };
+
+			/// Time of the next request in nanoseconds.
+			qint64 deadline_ { -1 };
+
+			/// Smoothed round-trip time in nanoseconds.
+			qint64 roundTrip_;
+
+			/// Age after which a missing packet is given up in nanoseconds.
+			qint64 maxDelay_;
+
+			/// Number of requested retransmissions.
+			std::atomic<quint64> requested_ { 0 };
+
+			/// Number of recovered packets.
+			std::atomic<quint64> recovered_ { 0 };
+
+			/// Number of missing packets that arrived late.
+			std::atomic<quint64> reordered_ { 0 };
+
+			/// Number of given up packets.
+			std::atomic<quint64> unrecovered_ { 0 };
+
+			/// Published round-trip time in nanoseconds.
+			std::atomic<qint64> sharedRoundTrip_;
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,401 @@
+/// \file RTCPPacketView.cpp
+/// \brief Contains classes and functions definitions that provide Real-time
+/// Transport Control Protocol (RTCP) packet view implementation.
+/// \bug No known bugs.
+
+#include "RTCPPacketView.hpp"
+
+#include <QtEndian>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		namespace {
+
+			/// RTCP common header size.
+			/// \details Version, padding, count, packet type and length.
+			constexpr int HEADER_SIZE { 4 };
+
+			/// RTCP protocol version.
+			/// \details Same as the version of RTP.
+			constexpr quint8 RTCP_PROTOCOL_VERSION { 2 };
+
+			/// Size of a Synchronization source ID (SSRC).
+			/// \details SSRC identifiers are 32 bits wide.
+			constexpr int SSRC_SIZE { 4 };
+
+			/// Size of sender information.
+			/// \details NTP and RTP timestamps and sender counters.
+			constexpr int SENDER_INFO_SIZE { 20 };
+
+			/// Size of the fixed part of a feedback packet.
+			/// \details Sources of the packet sender and the media.
+			constexpr int FEEDBACK_SIZE { 8 };
+
+			/// Size of a reception report block.
+			/// \details Six 32-bit words.
+			constexpr int REPORT_BLOCK_SIZE { 24 };
+
+			/// Makes a range of bytes.
+			/// \param[in]	data	First byte of the range.
+			/// \param[in]	size	Number of bytes in the range.
+			/// \return Range of bytes.
+			RTPSpan makeSpan(const char* data, int size) noexcept {
+				RTPSpan span;
+				span.data_ = data;
+				span.size_ = size;
+
+				return span;
+			}
+
+			/// Returns type of a source description item.
+			/// \param[in]	item	Item data.
+			/// \return Item type.
+			inline RTCPSourceItem itemType(const char* item) noexcept {
+				return static_cast<RTCPSourceItem>(static_cast<quint8>(*item));
+			}
+		}
+
+		/// Parses the first packet of raw RTCP data.
+		/// \details Parses the common header based on RFC 3550 and checks
+		/// that the fixed part of sender and receiver reports, the sources of
+		/// a goodbye and every chunk of a source description fit the packet
+		/// length, so getters never read past the packet.
+		/// \param[in]	data	Compound packet data.
+		/// \param[in]	size	Compound packet size.
+		/// \return RTCP packet view, invalid on error.
+		RTCPPacketView RTCPPacketView::parse(const char* data,
+											 int size) noexcept {
+
+			if (!data || size < HEADER_SIZE) return { };
+
+			auto byte0 = static_cast<quint8>(data[0]);
+
+			if ((byte0 >> 6 & 0x03) != RTCP_PROTOCOL_VERSION) return { };
+
+			auto paddingBit	= byte0 >> 5 & 0x01;
+			auto count		= byte0 >> 0 & 0x1F;
+			auto length		= (qFromBigEndian<quint16>(data + 2) + 1) * 4;
+
+			if (length > size) return { };
+
+			auto paddingSize =
+				paddingBit == 0 ? 0 : static_cast<quint8>(data[length - 1]);
+
+			if (paddingBit != 0 &&
+				(paddingSize == 0 || paddingSize > length - HEADER_SIZE))
+				return { };
+
+			auto content = length - HEADER_SIZE - paddingSize;
+
+			auto type = static_cast<RTCPPacketType>(
+				static_cast<quint8>(data[1]));
+
+			switch (type) {
+				case RTCPPacketType::SenderReport:
+					if (content < SSRC_SIZE + SENDER_INFO_SIZE +
+								  count * REPORT_BLOCK_SIZE)
+						return { };
+					break;
+
+				case RTCPPacketType::ReceiverReport:
+					if (content < SSRC_SIZE + count * REPORT_BLOCK_SIZE)
+						return { };
+					break;
+
+				case RTCPPacketType::Goodbye:
+					if (content < count * SSRC_SIZE) return { };
+					break;
+
+				case RTCPPacketType::TransportFeedback:
+				case RTCPPacketType::PayloadFeedback:
+					if (content < FEEDBACK_SIZE) return { };
+					break;
+
+				default:
+					break;
+			}
+
+			RTCPPacketView packet;
+			packet.data_		= data;
+			packet.size_		= length;
+			packet.remaining_	= size;
+			packet.paddingSize_	= static_cast<quint8>(paddingSize);
+
+			if (type == RTCPPacketType::SourceDescription && count > 0 &&
+				!packet.chunk(count - 1).data_)
+				return { };
+
+			return packet;
+		}
+
+		/// Parses the first packet of raw RTCP data.
+		/// \details The view refers to the data of the array, which must
+		/// not be modified or released while the view is used.
+		/// \param[in]	data	Compound packet data.
+		/// \return RTCP packet view, invalid on error.
+		RTCPPacketView RTCPPacketView::parse(const QByteArray& data) noexcept {
+			return parse(data.constData(), data.size());
+		}
+
+		/// Returns the next packet of the compound packet.
+		/// \details A malformed packet ends the walk, since the length of the
+		/// packets that follow it is not trustworthy.
+		/// \return RTCP packet view, invalid after the last packet.
+		RTCPPacketView RTCPPacketView::next() const noexcept {
+			if (!data_) return { };
+
+			return parse(data_ + size_, remaining_ - size_);
+		}
+
+		/// Indicates whether the packet is valid.
+		/// \details A view is valid if parsing succeeded.
+		/// \retval true if the packet is valid.
+		/// \retval false if the packet is not valid.
+		bool RTCPPacketView::isValid() const noexcept {
+			return data_ != nullptr;
+		}
+
+		/// Returns packet type.
+		/// \details Types other than the enumerated ones are returned as
+		/// they are.
+		/// \return Packet type.
+		RTCPPacketType RTCPPacketView::getPacketType() const noexcept {
+			return static_cast<RTCPPacketType>(
+				data_ ? static_cast<quint8>(data_[1]) : 0);
+		}
+
+		/// Returns the count field of the header.
+		/// \details Its meaning depends on the packet type.
+		/// \return Number of report blocks, sources or feedback format.
+		int RTCPPacketView::getCount() const noexcept {
+			return data_ ? static_cast<quint8>(data_[0]) & 0x1F : 0;
+		}
+
+		/// Returns Synchronization source ID (SSRC) of the packet sender.
+		/// \details Returns the first word after the common header, which is
+		/// also the first source of a source description or goodbye.
+		/// \return Synchronization source ID (SSRC) or zero if the packet
+		/// has none.
+		quint32 RTCPPacketView::getSSRC() const noexcept {
+			if (!data_ || size_ - paddingSize_ < HEADER_SIZE + SSRC_SIZE)
+				return 0;
+
+			return qFromBigEndian<quint32>(data_ + HEADER_SIZE);
+		}
+
+		/// Returns sender information of a sender report.
+		/// \details Loads the fields that follow the sender SSRC.
+		/// \return Sender information, zeros if the packet is not a sender
+		/// report.
+		RTCPSenderInfo RTCPPacketView::getSenderInfo() const noexcept {
+			if (getPacketType() != RTCPPacketType::SenderReport) return { };
+
+			auto info = data_ + HEADER_SIZE + SSRC_SIZE;
+
+			RTCPSenderInfo sender;
+			sender.ntpTimestamp_	= qFromBigEndian<quint64>(info);
+			sender.rtpTimestamp_	= qFromBigEndian<quint32>(info + 8);
+			sender.packetCount_		= qFromBigEndian<quint32>(info + 12);
+			sender.octetCount_		= qFromBigEndian<quint32>(info + 16);
+
+			return sender;
+		}
+
+		/// Returns number of reception report blocks.
+		/// \details Sender and receiver reports carry report blocks.
+		/// \return Number of report blocks.
+		int RTCPPacketView::getReportCount() const noexcept {
+			switch (getPacketType()) {
+				case RTCPPacketType::SenderReport:
+				case RTCPPacketType::ReceiverReport:
+					return getCount();
+
+				default:
+					return 0;
+			}
+		}
+
+		/// Returns a reception report block.
+		/// \details The cumulative number of lost packets is sign extended
+		/// from 24 bits.
+		/// \param[in]	index	Report block index.
+		/// \return Report block, zeros if the index is out of range.
+		RTCPReportBlock RTCPPacketView::getReport(int index) const noexcept {
+			if (index < 0 || index >= getReportCount()) return { };
+
+			auto block = data_ + HEADER_SIZE + SSRC_SIZE +
+						 index * REPORT_BLOCK_SIZE;
+
+			if (getPacketType() == RTCPPacketType::SenderReport)
+				block += SENDER_INFO_SIZE;
+
+			auto lost = qFromBigEndian<quint32>(block + 4);
+
+			RTCPReportBlock report;
+			report.source_			= qFromBigEndian<quint32>(block);
+			report.fractionLost_	= static_cast<quint8>(lost >> 24);
+			report.totalLost_		= static_cast<qint32>(lost << 8) >> 8;
+			report.extendedMaximum_	= qFromBigEndian<quint32>(block + 8);
+			report.jitter_			= qFromBigEndian<quint32>(block + 12);
+			report.lastReport_		= qFromBigEndian<quint32>(block + 16);
+			report.delay_			= qFromBigEndian<quint32>(block + 20);
+
+			return report;
+		}
+
+		/// Returns number of sources of a source description or goodbye.
+		/// \details Source descriptions have a chunk per source.
+		/// \return Number of sources.
+		int RTCPPacketView::getSourceCount() const noexcept {
+			switch (getPacketType()) {
+				case RTCPPacketType::SourceDescription:
+				case RTCPPacketType::Goodbye:
+					return getCount();
+
+				default:
+					return 0;
+			}
+		}
+
+		/// Returns a source of a source description or goodbye.
+		/// \details Chunks of a source description are walked up to the
+		/// source.
+		/// \param[in]	index	Source index.
+		/// \return Synchronization source ID (SSRC) or zero if the index is
+		/// out of range.
+		quint32 RTCPPacketView::getSource(int index) const noexcept {
+			if (index < 0 || index >= getSourceCount()) return 0;
+
+			if (getPacketType() == RTCPPacketType::Goodbye)
+				return qFromBigEndian<quint32>(
+					data_ + HEADER_SIZE + index * SSRC_SIZE);
+
+			return qFromBigEndian<quint32>(chunk(index).data_);
+		}
+
+		/// Returns a source description item.
+		/// \details Returns the first item of the type in the chunk of the
+		/// source. The text is not null-terminated.
+		/// \param[in]	index	Source index.
+		/// \param[in]	item	Item type.
+		/// \return Item text or empty span if there is no such item.
+		RTPSpan RTCPPacketView::getSourceItem(
+			int index,
+			RTCPSourceItem item) const noexcept {
+
+			if (getPacketType() != RTCPPacketType::SourceDescription ||
+				index < 0 || index >= getCount())
+				return { };
+
+			auto span = chunk(index);
+			auto current = span.data_ + SSRC_SIZE;
+
+			while (itemType(current) != RTCPSourceItem::End) {
+				auto size = static_cast<quint8>(current[1]);
+
+				if (itemType(current) == item)
+					return makeSpan(current + 2, size);
+
+				current += 2 + size;
+			}
+
+			return { };
+		}
+
+		/// Returns Synchronization source ID (SSRC) of the media source
+		/// of a feedback packet.
+		/// \details RFC 4585 places it after the source of the packet
+		/// sender.
+		/// \return Synchronization source ID (SSRC) or zero if the packet is
+		/// not a feedback packet.
+		quint32 RTCPPacketView::getMediaSource() const noexcept {
+			switch (getPacketType()) {
+				case RTCPPacketType::TransportFeedback:
+				case RTCPPacketType::PayloadFeedback:
+					return qFromBigEndian<quint32>(
+						data_ + HEADER_SIZE + SSRC_SIZE);
+
+				default:
+					return 0;
+			}
+		}
+
+		/// Returns feedback control information of a feedback packet.
+		/// \details The layout of the information depends on the feedback
+		/// format in the count field. Padding is excluded.
+		/// \return Feedback control information or empty span if the packet
+		/// is not a feedback packet.
+		RTPSpan RTCPPacketView::getFeedbackData() const noexcept {
+			switch (getPacketType()) {
+				case RTCPPacketType::TransportFeedback:
+				case RTCPPacketType::PayloadFeedback:
+					return makeSpan(data_ + HEADER_SIZE + FEEDBACK_SIZE,
+									size_ - HEADER_SIZE - FEEDBACK_SIZE -
+									paddingSize_);
+
+				default:
+					return { };
+			}
+		}
+
+		/// Returns packet data after the common header.
+		/// \details Padding is excluded.
+		/// \return Payload data.
+		RTPSpan RTCPPacketView::getPayloadData() const noexcept {
+			if (!data_) return { };
+
+			return makeSpan(data_ + HEADER_SIZE,
+							size_ - HEADER_SIZE - paddingSize_);
+		}
+
+		/// Returns the whole packet.
+		/// \details Returns the packet without the packets that follow it in
+		/// the compound packet.
+		/// \return Packet data.
+		RTPSpan RTCPPacketView::getPacketData() const noexcept {
+			return makeSpan(data_, size_);
+		}
+
+		/// Returns a source description chunk.
+		/// \details Walks the chunks from the first one. A chunk is a source
+		/// followed by items up to a null item and padded to a word
+		/// boundary. Padding missing at the end of the packet is tolerated.
+		/// \param[in]	index	Chunk index.
+		/// \return Chunk data or empty span if there is no such chunk.
+		RTPSpan RTCPPacketView::chunk(int index) const noexcept {
+			if (!data_) return { };
+
+			auto end = data_ + size_ - paddingSize_;
+			auto current = data_ + HEADER_SIZE;
+
+			for (auto i = 0; ; ++i) {
+				if (end - current < SSRC_SIZE + 1) return { };
+
+				auto start = current;
+				current += SSRC_SIZE;
+
+				while (itemType(current) != RTCPSourceItem::End) {
+					if (end - current < 2 ||
+						end - current < 2 + static_cast<quint8>(current[1]))
+						return { };
+
+					current += 2 + static_cast<quint8>(current[1]);
+
+					if (current == end) return { };
+				}
+
+				auto offset = (current + 1 - data_ + 3) & ~3;
+				current = offset < end - data_ ? data_ + offset : end;
+
+				if (i == index)
+					return makeSpan(start, static_cast<int>(current - start));
+			}
+		}
+	}
+}
@@ -0,0 +1,252 @@
+/// \file RTCPPacketView.hpp
+/// \brief Contains classes and functions declarations that provide Real-time
+/// Transport Control Protocol (RTCP) packet view implementation.
+/// \bug No known bugs.
+
+#ifndef RTCPPACKETVIEW_HPP
+#define RTCPPACKETVIEW_HPP
+
+#include "Base/Export.hpp"
+#include "Protocols/RTP/RTPPacketView.hpp"
+
+#include <QByteArray>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		/// Enumeration that defines RTCP packet types.
+		enum class RTCPPacketType : quint8 {
+
+			/// Sender report.
+			SenderReport = 200,
+
+			/// Receiver report.
+			ReceiverReport = 201,
+
+			/// Source description.
+			SourceDescription = 202,
+
+			/// Goodbye.
+			Goodbye = 203,
+
+			/// Application-defined packet.
+			ApplicationDefined = 204,
+
+			/// Transport layer feedback.
+			TransportFeedback = 205,
+
+			/// Payload-specific feedback.
+			PayloadFeedback = 206
+		};
+
+		/// Enumeration that defines transport layer feedback formats.
+		enum class RTCPTransportFeedback : quint8 {
+
+			/// Generic negative acknowledgement.
+			GenericNack = 1
+		};
+
+		/// Enumeration that defines payload-specific feedback formats.
+		enum class RTCPPayloadFeedback : quint8 {
+
+			/// Picture loss indication.
+			PictureLoss = 1,
+
+			/// Full intra request.
+			FullIntraRequest = 4
+		};
+
+		/// Enumeration that defines RTCP source description item types.
+		enum class RTCPSourceItem : quint8 {
+
+			/// End of the item list.
+			End = 0,
+
+			/// Canonical end-point identifier.
+			CanonicalName = 1,
+
+			/// User name.
+			Name = 2,
+
+			/// Electronic mail address.
+			Email = 3,
+
+			/// Phone number.
+			Phone = 4,
+
+			/// Geographic user location.
+			Location = 5,
+
+			/// Application or tool name.
+			Tool = 6,
+
+			/// Notice or status.
+			Note = 7,
+
+			/// Private extension.
+			Private = 8
+		};
+
+		/// Structure that describes sender information of a sender report.
+		struct RTCPSenderInfo final {
+
+			/// NTP timestamp.
+			/// \details Seconds since 1900 in the upper 32 bits and the
+			/// fraction of a second in the lower 32 bits.
+			quint64 ntpTimestamp_ { 0 };
+
+			/// RTP timestamp of the same instant.
+			quint32 rtpTimestamp_ { 0 };
+
+			/// Number of sent RTP packets.
+			quint32 packetCount_ { 0 };
+
+			/// Number of sent RTP payload bytes.
+			quint32 octetCount_ { 0 };
+		};
+
+		/// Structure that describes a reception report block.
+		struct RTCPReportBlock final {
+
+			/// Synchronization source ID (SSRC) of the reported source.
+			quint32 source_ { 0 };
+
+			/// Fraction of packets lost since the previous report.
+			/// \details Fixed point number with eight fractional bits.
+			quint8 fractionLost_ { 0 };
+
+			/// Cumulative number of lost packets.
+			/// \details Signed 24-bit value.
+			qint32 totalLost_ { 0 };
+
+			/// Extended highest sequence number received.
+			quint32 extendedMaximum_ { 0 };
+
+			/// Interarrival jitter in timestamp units.
+			quint32 jitter_ { 0 };
+
+			/// Middle 32 bits of NTP timestamp of the last sender report.
+			quint32 lastReport_ { 0 };
+
+			/// Delay since the last sender report in 1/65536 seconds.
+			quint32 delay_ { 0 };
+		};
+
+		/// Class that provides a non-owning RTCP packet view.
+		/// \details Parses one packet of a compound RTCP packet in place and
+		/// steps to the next one, so a compound packet is walked without
+		/// allocations or copies. The view is valid as long as the buffer
+		/// is.
+		class RTSPCLIENT_EXPORT RTCPPacketView final {
+		public:
+
+			/// Parses the first packet of raw RTCP data.
+			/// \param[in]	data	Compound packet data.
+			/// \param[in]	size	Compound packet size.
+			/// \return RTCP packet view, invalid on error.
+			static RTCPPacketView parse(const char* data, int size) noexcept;
+
+			/// Parses the first packet of raw RTCP data.
+			/// \param[in]	data	Compound packet data.
+			/// \return RTCP packet view, invalid on error.
+			static RTCPPacketView parse(const QByteArray& data) noexcept;
+
+		public:
+
+			/// Returns the next packet of the compound packet.
+			/// \return RTCP packet view, invalid after the last packet.
+			RTCPPacketView next() const noexcept;
+
+			/// Indicates whether the packet is valid.
+			/// \retval true if the packet is valid.
+			/// \retval false if the packet is not valid.
+			bool isValid() const noexcept;
+
+			/// Returns packet type.
+			/// \return Packet type.
+			RTCPPacketType getPacketType() const noexcept;
+
+			/// Returns the count field of the header.
+			/// \return Number of report blocks, sources or feedback format.
+			int getCount() const noexcept;
+
+			/// Returns Synchronization source ID (SSRC) of the packet sender.
+			/// \return Synchronization source ID (SSRC).
+			quint32 getSSRC() const noexcept;
+
+			/// Returns sender information of a sender report.
+			/// \return Sender information.
+			RTCPSenderInfo getSenderInfo() const noexcept;
+
+			/// Returns number of reception report blocks.
+			/// \return Number of report blocks.
+			int getReportCount() const noexcept;
+
+			/// Returns a reception report block.
+			/// \param[in]	index	Report block index.
+			/// \return Report block.
+			RTCPReportBlock getReport(int index) const noexcept;
+
+			/// Returns number of sources of a source description or goodbye.
+			/// \return Number of sources.
+			int getSourceCount() const noexcept;
+
+			/// Returns a source of a source description or goodbye.
+			/// \param[in]	index	Source index.
+			/// \return Synchronization source ID (SSRC).
+			quint32 getSource(int index) const noexcept;
+
+			/// Returns a source description item.
+			/// \param[in]	index	Source index.
+			/// \param[in]	item	Item type.
+			/// \return Item text.
+			RTPSpan getSourceItem(int index,
+								  RTCPSourceItem item) const noexcept;
+
+			/// Returns Synchronization source ID (SSRC) of the media source
+			/// of a feedback packet.
+			/// \return Synchronization source ID (SSRC).
+			quint32 getMediaSource() const noexcept;
+
+			/// Returns feedback control information of a feedback packet.
+			/// \return Feedback control information.
+			RTPSpan getFeedbackData() const noexcept;
+
+			/// Returns packet data after the common header.
+			/// \return Payload data.
+			RTPSpan getPayloadData() const noexcept;
+
+			/// Returns the whole packet.
+			/// \return Packet data.
+			RTPSpan getPacketData() const noexcept;
+
+		private:
+
+			/// Returns a source description chunk.
+			/// \param[in]	index	Chunk index.
+			/// \return Chunk data or empty span if there is no such chunk.
+			RTPSpan chunk(int index) const noexcept;
+
+		private:
+
+			/// Packet data.
+			const char* data_ { nullptr };
+
+			/// Packet size.
+			int size_ { 0 };
+
+			/// Size of the compound packet from the packet on.
+			int remaining_ { 0 };
+
+			/// Padding size.
+			quint8 paddingSize_ { 0 };
+		};
+	}
+}
+
+#endif
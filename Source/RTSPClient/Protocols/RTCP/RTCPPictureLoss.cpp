@@ -0,0 +1,223 @@
+/// \file RTCPPictureLoss.cpp
+/// \brief Contains classes and functions definitions that provide Real-time
+/// Transport Control Protocol (RTCP) key frame request scheduling.
+/// \bug No known bugs.
+
+#include "RTCPPictureLoss.hpp"
+#include "Utilities/AtomicCounter.hpp"
+
+#include <algorithm>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		namespace {
+
+			/// Time lost packets may take to arrive out of order.
+			/// \details Five milliseconds, as retransmission requests wait.
+			constexpr qint64 REORDER_DELAY { 5000000 };
+
+			/// Shortest interval between key frame requests.
+			/// \details Half a second, which bounds the key frames a lossy
+			/// link makes the sender produce.
+			constexpr qint64 MIN_REQUEST_INTERVAL { 500000000 };
+		}
+
+		/// Default constructor.
+		/// \details Starts without a loss.
+		RTCPPictureLoss::RTCPPictureLoss() noexcept = default;
+
+		/// Destructor.
+		/// \details Default destructor.
+		RTCPPictureLoss::~RTCPPictureLoss() = default;
+
+		/// Drops the pending loss.
+		/// \details Called when the source changes or restarts. The next
+		/// update sets the number of lost packets handled, statistics and
+		/// the command sequence number are kept.
+		void RTCPPictureLoss::reset() noexcept {
+			lost_ = -1;
+			gap_ = -1;
+			loss_ = -1;
+			pending_ = outstanding_ = repeated_ = false;
+			sent_ = -1;
+		}
+
+		/// Updates the scheduler with the number of lost packets.
+		/// \details Packets lost for longer than reordering takes break the
+		/// frame they belong to and the frames that refer to it. The loss
+		/// dates from the time the packets were first missed. A number that
+		/// drops, as late packets and duplicates make it, is taken as it is.
+		/// \param[in]	lost	Cumulative number of lost packets.
+		/// \param[in]	now		Current time in nanoseconds.
+		void RTCPPictureLoss::update(qint64 lost, qint64 now) noexcept {
+			if (lost_ < 0 || lost <= lost_) {
+				lost_ = lost;
+				gap_ = -1;
+				return;
+			}
+
+			if (gap_ < 0) gap_ = now;
+
+			if (now - gap_ < REORDER_DELAY) return;
+
+			auto time = gap_;
+
+			lost_ = lost;
+			gap_ = -1;
+
+			lose(time);
+		}
+
+		/// Reports a broken reference frame.
+		/// \details A depacketizer that finds a frame it can not decode
+		/// reports it here. A request is made unless one is already waiting
+		/// or on its way, since the same key frame serves both.
+		/// \param[in]	now	Current time in nanoseconds.
+		void RTCPPictureLoss::lose(qint64 now) noexcept {
+			increment(losses_);
+
+			if (loss_ < 0) loss_ = now;
+
+			if (pending_ || outstanding_) {
+				increment(deduplicated_);
+				return;
+			}
+
+			pending_ = true;
+			repeated_ = false;
+		}
+
+		/// Reports a received key frame.
+		/// \details Ends the loss, measures its recovery time and drops the
+		/// waiting request.
+		/// \param[in]	now	Current time in nanoseconds.
+		void RTCPPictureLoss::recover(qint64 now) noexcept {
+			pending_ = outstanding_ = repeated_ = false;
+
+			if (loss_ < 0) return;
+
+			auto time = std::max<qint64>(now - loss_, 0);
+			loss_ = -1;
+
+			increment(recoveries_);
+
+			recoveryTime_.store(time, std::memory_order_relaxed);
+			maxRecoveryTime_.store(
+				std::max(time,
+						 maxRecoveryTime_.load(std::memory_order_relaxed)),
+				std::memory_order_relaxed);
+			totalRecoveryTime_.store(
+				totalRecoveryTime_.load(std::memory_order_relaxed) + time,
+				std::memory_order_relaxed);
+		}
+
+		/// Indicates whether a key frame request is due and takes it.
+		/// \details A waiting request is due once the interval since the
+		/// previous one passed. In repeat mode a request still unanswered
+		/// after the interval is sent again with the same command sequence
+		/// number, a new request increments it.
+		/// \param[in]	now	Current time in nanoseconds.
+		/// \retval true if a request must be sent.
+		/// \retval false if no request is due.
+		bool RTCPPictureLoss::collect(qint64 now) noexcept {
+			if (outstanding_ && now - sent_ >= interval()) {
+				outstanding_ = false;
+				pending_ = repeated_ = true;
+			}
+
+			if (!pending_ || (sent_ >= 0 && now - sent_ < interval()))
+				return false;
+
+			if (!repeated_) ++sequence_;
+
+			pending_ = repeated_ = false;
+			outstanding_ = repeat_;
+			sent_ = now;
+
+			increment(requested_);
+			return true;
+		}
+
+		/// Returns the time of the next request.
+		/// \details Calling collect() earlier returns false.
+		/// \return Time in nanoseconds, or -1 if no request is waiting.
+		qint64 RTCPPictureLoss::getDeadline() const noexcept {
+			if (!pending_ && !outstanding_) return -1;
+
+			return sent_ < 0 ? 0 : sent_ + interval();
+		}
+
+		/// Returns command sequence number of the last request.
+		/// \details Full intra requests carry it, so the sender tells
+		/// repetitions from new requests.
+		/// \return Command sequence number.
+		quint8 RTCPPictureLoss::getSequence() const noexcept {
+			return sequence_;
+		}
+
+		/// Indicates whether unanswered requests are repeated.
+		/// \details Disabled by default.
+		/// \retval true if unanswered requests are repeated.
+		/// \retval false if unanswered requests are not repeated.
+		bool RTCPPictureLoss::isRepeat() const noexcept {
+			return repeat_;
+		}
+
+		/// Enables or disables repetition of unanswered requests.
+		/// \details Requires key frames to be reported, since a request is
+		/// answered by the next key frame. Without repetition every loss
+		/// after a request makes a new one.
+		/// \param[in]	repeat	Whether unanswered requests are repeated.
+		void RTCPPictureLoss::setRepeat(bool repeat) noexcept {
+			repeat_ = repeat;
+
+			if (!repeat_) outstanding_ = false;
+		}
+
+		/// Sets round-trip time.
+		/// \details A key frame answers a request no sooner than a round
+		/// trip later. Non-positive values are ignored.
+		/// \param[in]	roundTrip	Round-trip time in nanoseconds.
+		void RTCPPictureLoss::setRoundTrip(qint64 roundTrip) noexcept {
+			if (roundTrip > 0) roundTrip_ = roundTrip;
+		}
+
+		/// Returns key frame request statistics.
+		/// \details Safe to call from any thread. Counters are read one by
+		/// one, so they may belong to adjacent losses.
+		/// \return Key frame request statistics.
+		RTCPPictureLossStatistics
+		RTCPPictureLoss::getStatistics() const noexcept {
+			RTCPPictureLossStatistics statistics;
+			statistics.losses_ = losses_.load(std::memory_order_relaxed);
+			statistics.requested_ =
+				requested_.load(std::memory_order_relaxed);
+			statistics.deduplicated_ =
+				deduplicated_.load(std::memory_order_relaxed);
+			statistics.recoveries_ =
+				recoveries_.load(std::memory_order_relaxed);
+			statistics.recoveryTime_ =
+				recoveryTime_.load(std::memory_order_relaxed);
+			statistics.maxRecoveryTime_ =
+				maxRecoveryTime_.load(std::memory_order_relaxed);
+			statistics.totalRecoveryTime_ =
+				totalRecoveryTime_.load(std::memory_order_relaxed);
+
+			return statistics;
+		}
+
+		/// Returns the shortest interval between requests.
+		/// \details Twice the round-trip time, so the key frame of a request
+		/// has time to arrive, and no less than half a second.
+		/// \return Interval in nanoseconds.
+		qint64 RTCPPictureLoss::interval() const noexcept {
+			return std::max(2 * roundTrip_, MIN_REQUEST_INTERVAL);
+		}
+	}
+}
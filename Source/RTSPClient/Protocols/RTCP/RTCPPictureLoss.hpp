@@ -0,0 +1,192 @@
+/// \file RTCPPictureLoss.hpp
+/// \brief Contains classes and functions declarations that provide Real-time
+/// Transport Control Protocol (RTCP) key frame request scheduling.
+/// \bug No known bugs.
+
+#ifndef RTCPPICTURELOSS_HPP
+#define RTCPPICTURELOSS_HPP
+
+#include "Base/Export.hpp"
+
+#include <QtGlobal>
+
+#include <atomic>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		/// Structure that provides key frame request statistics.
+		/// \details Counters cover the whole life of the scheduler, resets
+		/// included.
+		struct RTCPPictureLossStatistics final {
+
+			/// Number of losses that broke a reference frame.
+			quint64 losses_ { 0 };
+
+			/// Number of sent key frame requests.
+			/// \details Repetitions of an unanswered request are included.
+			quint64 requested_ { 0 };
+
+			/// Number of losses covered by a request already made.
+			quint64 deduplicated_ { 0 };
+
+			/// Number of key frames that ended a loss.
+			quint64 recoveries_ { 0 };
+
+			/// Time from the last loss to its key frame in nanoseconds.
+			qint64 recoveryTime_ { 0 };
+
+			/// Longest time from a loss to its key frame in nanoseconds.
+			qint64 maxRecoveryTime_ { 0 };
+
+			/// Total time from losses to their key frames in nanoseconds.
+			qint64 totalRecoveryTime_ { 0 };
+		};
+
+		/// Class that provides RTCP key frame request scheduling.
+		/// \details Decides when a receiver asks the sender for a key frame
+		/// by a picture loss indication or a full intra request. Losses that
+		/// happen while a request is pending or unanswered are served by the
+		/// same key frame and are not requested again. Requests are spaced
+		/// by twice the round-trip time at least, so a key frame on its way
+		/// is not requested twice. The time from a loss to the next key
+		/// frame is measured whether requests are sent or not. The receiving
+		/// thread updates the scheduler, any thread reads statistics without
+		/// locks.
+		class RTSPCLIENT_EXPORT RTCPPictureLoss final {
+		public:
+
+			/// Default constructor.
+			explicit RTCPPictureLoss() noexcept;
+
+			/// Destructor.
+			~RTCPPictureLoss();
+
+			/// Copy constructor.
+			/// \param[in]	object	Object to copy.
+			RTCPPictureLoss(const RTCPPictureLoss& object) = delete;
+
+			/// Copy assignment operator.
+			/// \param[in]	object	Object to copy.
+			/// \return This object.
+			RTCPPictureLoss& operator=(const RTCPPictureLoss& object) = delete;
+
+		public:
+
+			/// Drops the pending loss.
+			void reset() noexcept;
+
+			/// Updates the scheduler with the number of lost packets.
+			/// \param[in]	lost	Cumulative number of lost packets.
+			/// \param[in]	now		Current time in nanoseconds.
+			void update(qint64 lost, qint64 now) noexcept;
+
+			/// Reports a broken reference frame.
+			/// \param[in]	now	Current time in nanoseconds.
+			void lose(qint64 now) noexcept;
+
+			/// Reports a received key frame.
+			/// \param[in]	now	Current time in nanoseconds.
+			void recover(qint64 now) noexcept;
+
+			/// Indicates whether a key frame request is due and takes it.
+			/// \param[in]	now	Current time in nanoseconds.
+			/// \retval true if a request must be sent.
+			/// \retval false if no request is due.
+			bool collect(qint64 now) noexcept;
+
+			/// Returns the time of the next request.
+			/// \return Time in nanoseconds, or -1 if no request is waiting.
+			qint64 getDeadline() const noexcept;
+
+			/// Returns command sequence number of the last request.
+			/// \return Command sequence number.
+			quint8 getSequence() const noexcept;
+
+			/// Indicates whether unanswered requests are repeated.
+			/// \retval true if unanswered requests are repeated.
+			/// \retval false if unanswered requests are not repeated.
+			bool isRepeat() const noexcept;
+
+			/// Enables or disables repetition of unanswered requests.
+			/// \param[in]	repeat	Whether unanswered requests are repeated.
+			void setRepeat(bool repeat) noexcept;
+
+			/// Sets round-trip time.
+			/// \param[in]	roundTrip	Round-trip time in nanoseconds.
+			void setRoundTrip(qint64 roundTrip) noexcept;
+
+			/// Returns key frame request statistics.
+			/// \return Key frame request statistics.
+			RTCPPictureLossStatistics getStatistics() const noexcept;
+
+		private:
+
+			/// Returns the shortest interval between requests.
+			/// \return Interval in nanoseconds.
+			qint64 interval() const noexcept;
+
+		private:
+
+			/// Cumulative number of lost packets already handled.
+			qint64 lost_ { 0 };
+
+			/// Time lost packets beyond the handled ones were first seen in
+			/// nanoseconds, or -1.
+			qint64 gap_ { -1 };
+
+			/// Time of the first loss since the last key frame in
+			/// nanoseconds, or -1.
+			qint64 loss_ { -1 };
+
+			/// Whether a request waits to be sent.
+			bool pending_ { false };
+
+			/// Whether a sent request waits for its key frame.
+			bool outstanding_ { false };
+
+			/// Whether the waiting request repeats an unanswered one.
+			bool repeated_ { false };
+
+			/// Whether unanswered requests are repeated.
+			bool repeat_ { false };
+
+			/// Time of the last request in nanoseconds, or -1.
+			qint64 sent_ { -1 };
+
+			/// Command sequence number of the last request.
+			quint8 sequence_ { 0 };
+
+			/// Round-trip time in nanoseconds.
+			qint64 roundTrip_ { 0 };
+
+			/// Number of losses.
+			std::atomic<quint64> losses_ { 0 };
+
+			/// Number of sent requests.
+			std::atomic<quint64> requested_ { 0 };
+
+			/// Number of deduplicated losses.
+			std::atomic<quint64> deduplicated_ { 0 };
+
+			/// Number of recoveries.
+			std::atomic<quint64> recoveries_ { 0 };
+
+			/// Last recovery time in nanoseconds.
+			std::atomic<qint64> recoveryTime_ { 0 };
+
+			/// Longest recovery time in nanoseconds.
+			std::atomic<qint64> maxRecoveryTime_ { 0 };
+
+			/// Total recovery time in nanoseconds.
+			std::atomic<qint64> totalRecoveryTime_ { 0 };
+		};
+	}
+}
+
+#endif
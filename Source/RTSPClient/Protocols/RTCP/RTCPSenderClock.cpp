@@ -0,0 +1,292 @@
+/// \file RTCPSenderClock.cpp
+/// \brief Contains classes and functions definitions that provide Real-time
+/// Transport Control Protocol (RTCP) sender clock mapping.
+/// \bug No known bugs.
+
+#include "RTCPSenderClock.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		namespace {
+
+			/// Seconds from the NTP epoch to the Unix epoch.
+			/// \details From 1900 to 1970, seventeen leap years included.
+			constexpr qint64 NTP_UNIX_OFFSET { 2208988800ll };
+
+			/// Seconds of an NTP era.
+			/// \details NTP seconds are 32 bits wide.
+			constexpr qint64 NTP_ERA { qint64 { 1 } << 32 };
+
+			/// Nanoseconds per second.
+			/// \details Wall clock time is kept in nanoseconds.
+			constexpr qint64 NANOSECONDS { 1000000000 };
+
+			/// Shortest span of reports that measures the clock rate.
+			/// \details Ten seconds keep the error of whole timestamp units
+			/// within tens of parts per million even at 8 kHz.
+			constexpr qint64 MIN_RATE_SPAN { 10 * NANOSECONDS };
+
+			/// Largest deviation of the clock rate between reports.
+			/// \details One percent, larger ones mean the sender timestamps
+			/// jumped, which starts the measurement over.
+			constexpr double MAX_RATE_DEVIATION { 0.01 };
+		}
+
+		/// Returns receiver clock time.
+		/// \details The monotonic clock is shared by all clients of the
+		/// process, so times of different sources compare directly.
+		/// \return Time of the monotonic clock in nanoseconds.
+		qint64 RTCPSenderClock::now() noexcept {
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+
+		/// Default constructor.
+		/// \details The mapping becomes valid with the first sender report.
+		RTCPSenderClock::RTCPSenderClock() noexcept = default;
+
+		/// Destructor.
+		/// \details Default destructor.
+		RTCPSenderClock::~RTCPSenderClock() = default;
+
+		/// Converts NTP timestamp to wall clock time.
+		/// \details Seconds without the most significant bit belong to the
+		/// era that starts in 2036, as RFC 4330 section 3 suggests.
+		/// \param[in]	ntpTimestamp	NTP timestamp.
+		/// \return Time since the Unix epoch in nanoseconds.
+		qint64 RTCPSenderClock::toUnixTime(quint64 ntpTimestamp) noexcept {
+			auto seconds = static_cast<qint64>(ntpTimestamp >> 32);
+			auto fraction = ntpTimestamp & 0xFFFFFFFFull;
+
+			if (seconds < NTP_ERA / 2) seconds += NTP_ERA;
+
+			return (seconds - NTP_UNIX_OFFSET) * NANOSECONDS +
+				   static_cast<qint64>((fraction * NANOSECONDS) >> 32);
+		}
+
+		/// Converts RTP timestamp to wall clock time by a mapping.
+		/// \details The timestamp is taken as the nearest one to the
+		/// timestamp of the report, which covers half the timestamp space in
+		/// either direction, more than six hours at 90 kHz. The measured
+		/// clock rate replaces the nominal one once it is known.
+		/// \param[in]	mapping		Clock mapping.
+		/// \param[in]	timestamp	RTP timestamp.
+		/// \return Time since the Unix epoch in nanoseconds, or -1 if the
+		/// mapping is not valid.
+		qint64 RTCPSenderClock::toWallClock(const RTCPClockMapping& mapping,
+											quint32 timestamp) noexcept {
+
+			if (mapping.arrival_ < 0 || mapping.clockRate_ <= 0) return -1;
+
+			auto ticks = static_cast<qint64>(
+				static_cast<qint32>(timestamp - mapping.rtpTimestamp_));
+			auto time = toUnixTime(mapping.ntpTimestamp_);
+
+			if (mapping.rate_ > 0)
+				return time + static_cast<qint64>(
+					std::llround(ticks * NANOSECONDS / mapping.rate_));
+
+			return time + ticks * NANOSECONDS / mapping.clockRate_;
+		}
+
+		/// Converts RTP timestamp to receiver clock time by a mapping.
+		/// \details Shifts the sender wall clock time by the offset of the
+		/// receiver clock, so that times of sources with unrelated wall
+		/// clocks compare directly.
+		/// \param[in]	mapping		Clock mapping.
+		/// \param[in]	timestamp	RTP timestamp.
+		/// \return Time of the monotonic clock in nanoseconds, or -1 if the
+		/// mapping is not valid.
+		qint64 RTCPSenderClock::toReceiverClock(
+			const RTCPClockMapping& mapping,
+			quint32 timestamp) noexcept {
+
+			auto time = toWallClock(mapping, timestamp);
+
+			return time < 0 ? -1 : time + mapping.offset_;
+		}
+
+		/// Drops the mapping.
+		/// \details Called when the source changes.
+		void RTCPSenderClock::reset() noexcept {
+			mapping_ = { };
+			baseTime_ = ticks_ = 0;
+			offsetCount_ = 0;
+
+			publish();
+		}
+
+		/// Updates the mapping with a sender report.
+		/// \details Replaces the previous pairing of timestamps. The clock
+		/// rate is measured over all reports since the source started or its
+		/// timestamps jumped, which averages out rounding of the timestamps.
+		/// The offset of the receiver clock is the smallest one of the last
+		/// eight reports, the one least delayed by the network, and follows
+		/// a slow drift of the sender wall clock.
+		/// \param[in]	source			Synchronization source ID (SSRC).
+		/// \param[in]	clockRate		RTP clock rate, zero if unknown.
+		/// \param[in]	ntpTimestamp	NTP timestamp of the report.
+		/// \param[in]	rtpTimestamp	RTP timestamp of the report.
+		/// \param[in]	arrival			Arrival time on the receiver clock
+		///								in nanoseconds.
+		void RTCPSenderClock::update(quint32 source,
+									 int clockRate,
+									 quint64 ntpTimestamp,
+									 quint32 rtpTimestamp,
+									 qint64 arrival) noexcept {
+
+			auto time = toUnixTime(ntpTimestamp);
+			auto continued = isValid() && clockRate > 0 &&
+							 mapping_.source_ == source &&
+							 mapping_.clockRate_ == clockRate;
+
+			if (continued) {
+				auto span = time - toUnixTime(mapping_.ntpTimestamp_);
+				auto ticks = static_cast<qint64>(
+					static_cast<qint32>(rtpTimestamp - mapping_.rtpTimestamp_));
+
+				continued =
+					span > 0 &&
+					std::abs(static_cast<double>(ticks) * NANOSECONDS / span -
+							 clockRate) <= clockRate * MAX_RATE_DEVIATION;
+
+				if (continued) ticks_ += ticks;
+			}
+
+			if (!continued) {
+				baseTime_ = time;
+				ticks_ = 0;
+				offsetCount_ = 0;
+				mapping_.rate_ = 0;
+			}
+
+			auto size = static_cast<int>(offsets_.size());
+			offsets_[static_cast<std::size_t>(offsetCount_ % size)] =
+				arrival - time;
+			++offsetCount_;
+
+			auto end = offsets_.begin() + std::min(offsetCount_, size);
+			mapping_.offset_ = *std::min_element(offsets_.begin(), end);
+
+			if (time - baseTime_ >= MIN_RATE_SPAN)
+				mapping_.rate_ = static_cast<double>(ticks_) * NANOSECONDS /
+								 (time - baseTime_);
+
+			mapping_.source_		= source;
+			mapping_.clockRate_		= clockRate;
+			mapping_.ntpTimestamp_	= ntpTimestamp;
+			mapping_.rtpTimestamp_	= rtpTimestamp;
+			mapping_.arrival_		= arrival;
+
+			publish();
+		}
+
+		/// Indicates whether a sender report was received.
+		/// \details Must be called from the receiving thread.
+		/// \retval true if a sender report was received.
+		/// \retval false if no sender report was received.
+		bool RTCPSenderClock::isValid() const noexcept {
+			return mapping_.arrival_ >= 0;
+		}
+
+		/// Returns the last sender report field of a report block.
+		/// \details Must be called from the receiving thread.
+		/// \return Middle 32 bits of NTP timestamp of the last sender
+		/// report, zero if there is none.
+		quint32 RTCPSenderClock::getLastReport() const noexcept {
+			if (!isValid()) return 0;
+
+			return static_cast<quint32>(mapping_.ntpTimestamp_ >> 16);
+		}
+
+		/// Returns the delay field of a report block.
+		/// \details Must be called from the receiving thread. The sender
+		/// subtracts it from the round-trip of the report.
+		/// \param[in]	now	Receiver clock time in nanoseconds.
+		/// \return Delay since the last sender report in 1/65536 seconds,
+		/// zero if there is none.
+		quint32 RTCPSenderClock::getDelay(qint64 now) const noexcept {
+			if (!isValid() || now < mapping_.arrival_) return 0;
+
+			return static_cast<quint32>(
+				((now - mapping_.arrival_) << 16) / NANOSECONDS);
+		}
+
+		/// Returns the mapping.
+		/// \details Safe to call from any thread. Reads a consistent snapshot
+		/// without locks, retrying if the receiving thread published a new
+		/// mapping meanwhile.
+		/// \return Clock mapping.
+		RTCPClockMapping RTCPSenderClock::getMapping() const noexcept {
+			RTCPClockMapping mapping;
+
+			lock_.read([&]() {
+				mapping.source_ =
+					sharedSource_.load(std::memory_order_relaxed);
+				mapping.clockRate_ =
+					sharedClockRate_.load(std::memory_order_relaxed);
+				mapping.ntpTimestamp_ =
+					sharedNTPTimestamp_.load(std::memory_order_relaxed);
+				mapping.rtpTimestamp_ =
+					sharedRTPTimestamp_.load(std::memory_order_relaxed);
+				mapping.arrival_ =
+					sharedArrival_.load(std::memory_order_relaxed);
+				mapping.rate_ = sharedRate_.load(std::memory_order_relaxed);
+				mapping.offset_ =
+					sharedOffset_.load(std::memory_order_relaxed);
+			});
+
+			return mapping;
+		}
+
+		/// Converts RTP timestamp to wall clock time.
+		/// \details Safe to call from any thread.
+		/// \param[in]	timestamp	RTP timestamp.
+		/// \return Time since the Unix epoch in nanoseconds, or -1 if no
+		/// sender report was received.
+		qint64 RTCPSenderClock::toWallClock(quint32 timestamp) const noexcept {
+			return toWallClock(getMapping(), timestamp);
+		}
+
+		/// Converts RTP timestamp to receiver clock time.
+		/// \details Safe to call from any thread.
+		/// \param[in]	timestamp	RTP timestamp.
+		/// \return Time of the monotonic clock in nanoseconds, or -1 if no
+		/// sender report was received.
+		qint64 RTCPSenderClock::toReceiverClock(
+			quint32 timestamp) const noexcept {
+
+			return toReceiverClock(getMapping(), timestamp);
+		}
+
+		/// Publishes the mapping to readers.
+		/// \details Writes the shared copies under the sequence lock.
+		void RTCPSenderClock::publish() noexcept {
+			lock_.write([this]() {
+				sharedSource_.store(mapping_.source_,
+									std::memory_order_relaxed);
+				sharedClockRate_.store(mapping_.clockRate_,
+									   std::memory_order_relaxed);
+				sharedNTPTimestamp_.store(mapping_.ntpTimestamp_,
+										  std::memory_order_relaxed);
+				sharedRTPTimestamp_.store(mapping_.rtpTimestamp_,
+										  std::memory_order_relaxed);
+				sharedArrival_.store(mapping_.arrival_,
+									 std::memory_order_relaxed);
+				sharedRate_.store(mapping_.rate_, std::memory_order_relaxed);
+				sharedOffset_.store(mapping_.offset_,
+									std::memory_order_relaxed);
+			});
+		}
+	}
+}
@@ -0,0 +1,206 @@
+/// \file RTCPSenderClock.hpp
+/// \brief Contains classes and functions declarations that provide Real-time
+/// Transport Control Protocol (RTCP) sender clock mapping.
+/// \bug No known bugs.
+
+#ifndef RTCPSENDERCLOCK_HPP
+#define RTCPSENDERCLOCK_HPP
+
+#include "Base/Export.hpp"
+#include "Utilities/SequenceLock.hpp"
+
+#include <QtGlobal>
+
+#include <array>
+#include <atomic>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		/// Structure that describes mapping of RTP timestamps to wall clock.
+		/// \details Taken from the last sender report of a source.
+		struct RTCPClockMapping final {
+
+			/// Synchronization source ID (SSRC).
+			quint32 source_ { 0 };
+
+			/// RTP clock rate, zero if unknown.
+			int clockRate_ { 0 };
+
+			/// NTP timestamp of the sender report.
+			quint64 ntpTimestamp_ { 0 };
+
+			/// RTP timestamp of the same instant.
+			quint32 rtpTimestamp_ { 0 };
+
+			/// Arrival time of the sender report on the receiver clock in
+			/// nanoseconds.
+			/// \details Negative if no sender report was received.
+			qint64 arrival_ { -1 };
+
+			/// Measured RTP clock rate against the sender wall clock.
+			/// \details Zero until sender reports span long enough to
+			/// measure it.
+			double rate_ { 0 };
+
+			/// Offset of the receiver clock from the sender wall clock in
+			/// nanoseconds.
+			/// \details Includes the shortest recent transit time of sender
+			/// reports.
+			qint64 offset_ { 0 };
+		};
+
+		/// Class that provides sender clock mapping of an RTP source.
+		/// \details Keeps the pairing of NTP and RTP timestamps of the last
+		/// sender report, which maps RTP timestamps of the source to the wall
+		/// clock of the sender. Successive reports measure the drift of the
+		/// RTP clock and the offset of the receiver clock. The receiving
+		/// thread updates it, any thread reads the mapping without locks.
+		class RTSPCLIENT_EXPORT RTCPSenderClock final {
+		public:
+
+			/// Default constructor.
+			explicit RTCPSenderClock() noexcept;
+
+			/// Destructor.
+			~RTCPSenderClock();
+
+			/// Copy constructor.
+			/// \param[in]	object	Object to copy.
+			RTCPSenderClock(const RTCPSenderClock& object) = delete;
+
+			/// Copy assignment operator.
+			/// \param[in]	object	Object to copy.
+			/// \return This object.
+			RTCPSenderClock& operator=(const RTCPSenderClock& object) = delete;
+
+		public:
+
+			/// Returns receiver clock time.
+			/// \return Time of the monotonic clock in nanoseconds.
+			static qint64 now() noexcept;
+
+			/// Converts NTP timestamp to wall clock time.
+			/// \param[in]	ntpTimestamp	NTP timestamp.
+			/// \return Time since the Unix epoch in nanoseconds.
+			static qint64 toUnixTime(quint64 ntpTimestamp) noexcept;
+
+			/// Converts RTP timestamp to wall clock time by a mapping.
+			/// \param[in]	mapping		Clock mapping.
+			/// \param[in]	timestamp	RTP timestamp.
+			/// \return Time since the Unix epoch in nanoseconds, or -1 if the
+			/// mapping is not valid.
+			static qint64 toWallClock(const RTCPClockMapping& mapping,
+									  quint32 timestamp) noexcept;
+
+			/// Converts RTP timestamp to receiver clock time by a mapping.
+			/// \param[in]	mapping		Clock mapping.
+			/// \param[in]	timestamp	RTP timestamp.
+			/// \return Time of the monotonic clock in nanoseconds, or -1 if
+			/// the mapping is not valid.
+			static qint64 toReceiverClock(const RTCPClockMapping& mapping,
+										  quint32 timestamp) noexcept;
+
+			/// Drops the mapping.
+			void reset() noexcept;
+
+			/// Updates the mapping with a sender report.
+			/// \param[in]	source			Synchronization source ID (SSRC).
+			/// \param[in]	clockRate		RTP clock rate, zero if unknown.
+			/// \param[in]	ntpTimestamp	NTP timestamp of the report.
+			/// \param[in]	rtpTimestamp	RTP timestamp of the report.
+			/// \param[in]	arrival			Arrival time on the receiver clock
+			///								in nanoseconds.
+			void update(quint32 source,
+						int clockRate,
+						quint64 ntpTimestamp,
+						quint32 rtpTimestamp,
+						qint64 arrival) noexcept;
+
+			/// Indicates whether a sender report was received.
+			/// \retval true if a sender report was received.
+			/// \retval false if no sender report was received.
+			bool isValid() const noexcept;
+
+			/// Returns the last sender report field of a report block.
+			/// \return Middle 32 bits of NTP timestamp of the last sender
+			/// report, zero if there is none.
+			quint32 getLastReport() const noexcept;
+
+			/// Returns the delay field of a report block.
+			/// \param[in]	now	Receiver clock time in nanoseconds.
+			/// \return Delay since the last sender report in 1/65536 seconds,
+			/// zero if there is none.
+			quint32 getDelay(qint64 now) const noexcept;
+
+			/// Returns the mapping.
+			/// \return Clock mapping.
+			RTCPClockMapping getMapping() const noexcept;
+
+			/// Converts RTP timestamp to wall clock time.
+			/// \param[in]	timestamp	RTP timestamp.
+			/// \return Time since the Unix epoch in nanoseconds, or -1 if no
+			/// sender report was received.
+			qint64 toWallClock(quint32 timestamp) const noexcept;
+
+			/// Converts RTP timestamp to receiver clock time.
+			/// \param[in]	timestamp	RTP timestamp.
+			/// \return Time of the monotonic clock in nanoseconds, or -1 if no
+			/// sender report was received.
+			qint64 toReceiverClock(quint32 timestamp) const noexcept;
+
+		private:
+
+			/// Publishes the mapping to readers.
+			void publish() noexcept;
+
+		private:
+
+			/// Mapping of the receiving thread.
+			RTCPClockMapping mapping_;
+
+			/// Wall clock time of the first report of the measurement.
+			qint64 baseTime_ { 0 };
+
+			/// RTP clock ticks since the first report of the measurement.
+			qint64 ticks_ { 0 };
+
+			/// Offsets of the receiver clock of recent reports.
+			std::array<qint64, 8> offsets_ { };
+
+			/// Number of offsets of the measurement.
+			int offsetCount_ { 0 };
+
+			/// Lock of the published mapping.
+			SequenceLock lock_;
+
+			/// Published synchronization source ID (SSRC).
+			std::atomic<quint32> sharedSource_ { 0 };
+
+			/// Published clock rate.
+			std::atomic<int> sharedClockRate_ { 0 };
+
+			/// Published NTP timestamp.
+			std::atomic<quint64> sharedNTPTimestamp_ { 0 };
+
+			/// Published RTP timestamp.
+			std::atomic<quint32> sharedRTPTimestamp_ { 0 };
+
+			/// Published arrival time.
+			std::atomic<qint64> sharedArrival_ { -1 };
+
+			/// Published measured clock rate.
+			std::atomic<double> sharedRate_ { 0 };
+
+			/// Published receiver clock offset.
+			std::atomic<qint64> sharedOffset_ { 0 };
+		};
+	}
+}
+
+#endif
@@ -4,10 +4,16 @@
 
 HEADERS			+=															\
 						$$PWD/RTPPacket.hpp									\
+						$$PWD/RTPPacketView.hpp								\
 						$$PWD/RTPSequence.hpp								\
+						$$PWD/RTPSourceTable.hpp							\
 						$$PWD/RTPStream.hpp									\
+						$$PWD/RTPTimestampUnwrapper.hpp						\
 
 SOURCES			+=															\
 						$$PWD/RTPPacket.cpp									\
+						$$PWD/RTPPacketView.cpp								\
 						$$PWD/RTPSequence.cpp								\
+						$$PWD/RTPSourceTable.cpp							\
 						$$PWD/RTPStream.cpp									\
+						$$PWD/RTPTimestampUnwrapper.cpp						\
@@ -6,6 +6,8 @@
 #ifndef RTPPACKET_HPP
 #define RTPPACKET_HPP
 
+#include "Base/Export.hpp"
+
 #include <QtCore>
 
 /// Contains classes and functions that implement Real Time Streaming Protocol
@@ -17,7 +19,7 @@ namespace RTSPLib {
 	namespace RTSPClient {
 
 		/// Class that provides an RTP packet implementation.
-		class RTPPacket final {
+		class RTSPCLIENT_EXPORT RTPPacket final {
 		public:
 
 			/// Parses raw RTP data.
@@ -0,0 +1,226 @@
+/// \file RTPPacketView.cpp
+/// \brief Contains classes and functions definitions that provide Real-time
+/// Transport Protocol (RTP) packet view implementation.
+/// \bug No known bugs.
+
+#include "RTPPacketView.hpp"
+
+#include <QtEndian>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		namespace {
+
+			/// Minimum RTP header size.
+			/// \details RTP header size without any CSRC, header extension
+			/// and payload.
+			constexpr int MINIMUM_RTP_HEADER_SIZE { 12 };
+
+			/// RTP protocol version.
+			/// \details Current supported RTP protocol version.
+			constexpr quint8 RTP_PROTOCOL_VERSION { 2 };
+
+			/// Header extension header size.
+			/// \details Profile-defined field and extension length.
+			constexpr int EXTENSION_HEADER_SIZE { 4 };
+
+			/// Size of a Contributing source ID (CSRC).
+			/// \details CSRC identifiers are 32 bits wide.
+			constexpr int CSRC_SIZE { 4 };
+
+			/// Makes a range of bytes.
+			/// \param[in]	data	First byte of the range.
+			/// \param[in]	size	Number of bytes in the range.
+			/// \return Range of bytes.
+			RTPSpan makeSpan(const char* data, int size) noexcept {
+				RTPSpan span;
+				span.data_ = data;
+				span.size_ = size;
+
+				return span;
+			}
+		}
+
+		/// Parses raw RTP data.
+		/// \details Parses raw RTP data based on RFC 3550. The header is read
+		/// with big-endian loads and every variable part is checked against
+		/// the packet size, so a truncated or malformed packet gives an
+		/// invalid view.
+		/// \param[in]	data	Packet data.
+		/// \param[in]	size	Packet size.
+		/// \return RTP packet view, invalid on error.
+		RTPPacketView RTPPacketView::parse(const char* data,
+										   int size) noexcept {
+
+			if (!data || size < MINIMUM_RTP_HEADER_SIZE) return { };
+
+			auto byte0 = static_cast<quint8>(data[0]);
+
+			if ((byte0 >> 6 & 0x03) != RTP_PROTOCOL_VERSION) return { };
+
+			auto paddingBit		= byte0 >> 5 & 0x01;
+			auto extensionBit	= byte0 >> 4 & 0x01;
+			auto numberCSRC		= byte0 >> 0 & 0x0F;
+
+			auto offset = MINIMUM_RTP_HEADER_SIZE + numberCSRC * CSRC_SIZE;
+			auto extensionSize = 0;
+
+			if (extensionBit != 0) {
+				if (size - offset < EXTENSION_HEADER_SIZE) return { };
+
+				extensionSize =
+					qFromBigEndian<quint16>(data + offset + 2) * 4 +
+					EXTENSION_HEADER_SIZE;
+			}
+
+			auto paddingSize =
+				paddingBit == 0 ? 0 : static_cast<quint8>(data[size - 1]);
+
+			if (paddingBit != 0 && paddingSize == 0) return { };
+
+			auto payloadSize = size - offset - extensionSize - paddingSize;
+			if (payloadSize < 0) return { };
+
+			RTPPacketView packet;
+			packet.data_			= data;
+			packet.size_			= size;
+			packet.extensionSize_	= extensionSize;
+			packet.payloadSize_		= payloadSize;
+			packet.paddingSize_		= static_cast<quint8>(paddingSize);
+
+			return packet;
+		}
+
+		/// Parses raw RTP data.
+		/// \details The view refers to the data of the array, which must
+		/// not be modified or released while the view is used.
+		/// \param[in]	data	Packet data.
+		/// \return RTP packet view, invalid on error.
+		RTPPacketView RTPPacketView::parse(const QByteArray& data) noexcept {
+			return parse(data.constData(), data.size());
+		}
+
+		/// Indicates whether the packet is valid.
+		/// \details A view is valid if parsing succeeded.
+		/// \retval true if the packet is valid.
+		/// \retval false if the packet is not valid.
+		bool RTPPacketView::isValid() const noexcept {
+			return data_ != nullptr;
+		}
+
+		/// Returns protocol version.
+		/// \details Returns the value of the RTP protocol version.
+		/// \return Protocol version.
+		quint8 RTPPacketView::getProtocolVersion() const noexcept {
+			return data_ ? static_cast<quint8>(data_[0]) >> 6 & 0x03 : 0;
+		}
+
+		/// Returns padding size.
+		/// \details Returns the number of padding bytes of the RTP packet.
+		/// \return Padding size.
+		quint8 RTPPacketView::getPaddingSize() const noexcept {
+			return paddingSize_;
+		}
+
+		/// Returns profile-specific marker.
+		/// \details Returns the profile-specific marker of the RTP packet.
+		/// \return Profile-specific marker.
+		quint8 RTPPacketView::getProfileMarker() const noexcept {
+			return data_ ? static_cast<quint8>(data_[1]) >> 7 & 0x01 : 0;
+		}
+
+		/// Returns payload type.
+		/// \details Returns the value of the RTP payload type.
+		/// \return Payload type.
+		quint8 RTPPacketView::getPayloadType() const noexcept {
+			return data_ ? static_cast<quint8>(data_[1]) & 0x7F : 0;
+		}
+
+		/// Returns sequence number.
+		/// \details Returns the sequence number of the RTP packet.
+		/// \return Sequence number.
+		quint16 RTPPacketView::getSequenceNumber() const noexcept {
+			return data_ ? qFromBigEndian<quint16>(data_ + 2) : 0;
+		}
+
+		/// Returns timestamp.
+		/// \details Returns the timestamp of the RTP packet.
+		/// \return Timestamp.
+		quint32 RTPPacketView::getTimestamp() const noexcept {
+			return data_ ? qFromBigEndian<quint32>(data_ + 4) : 0;
+		}
+
+		/// Returns Synchronization source ID (SSRC).
+		/// \details Returns the SSRC value of the RTP stream.
+		/// \return Synchronization source ID (SSRC).
+		quint32 RTPPacketView::getSSRC() const noexcept {
+			return data_ ? qFromBigEndian<quint32>(data_ + 8) : 0;
+		}
+
+		/// Returns number of Contributing source IDs (CSRC).
+		/// \details Returns the CSRC count of the RTP header.
+		/// \return Number of Contributing source IDs (CSRC).
+		int RTPPacketView::getCSRCCount() const noexcept {
+			return data_ ? static_cast<quint8>(data_[0]) & 0x0F : 0;
+		}
+
+		/// Returns Contributing source ID (CSRC).
+		/// \details Loads the identifier from the buffer.
+		/// \param[in]	index	CSRC index.
+		/// \return Contributing source ID (CSRC) or zero if the index is out
+		/// of range.
+		quint32 RTPPacketView::getCSRC(int index) const noexcept {
+			if (index < 0 || index >= getCSRCCount()) return 0;
+
+			return qFromBigEndian<quint32>(
+				data_ + MINIMUM_RTP_HEADER_SIZE + index * CSRC_SIZE);
+		}
+
+		/// Returns Contributing source ID (CSRC) array.
+		/// \details Identifiers are stored in network byte order, getCSRC()
+		/// loads one of them.
+		/// \return Big-endian Contributing source ID (CSRC) array.
+		RTPSpan RTPPacketView::getCSRCData() const noexcept {
+			if (!data_) return { };
+
+			return makeSpan(data_ + MINIMUM_RTP_HEADER_SIZE,
+							getCSRCCount() * CSRC_SIZE);
+		}
+
+		/// Returns header extension.
+		/// \details Returns the header extension of the RTP packet, its
+		/// header included.
+		/// \return Header extension.
+		RTPSpan RTPPacketView::getHeaderExtension() const noexcept {
+			if (!data_ || extensionSize_ == 0) return { };
+
+			return makeSpan(data_ + MINIMUM_RTP_HEADER_SIZE +
+							getCSRCCount() * CSRC_SIZE,
+							extensionSize_);
+		}
+
+		/// Returns payload data.
+		/// \details Returns the payload data of the RTP packet without
+		/// padding.
+		/// \return Payload data.
+		RTPSpan RTPPacketView::getPayloadData() const noexcept {
+			if (!data_) return { };
+
+			return makeSpan(data_ + size_ - paddingSize_ - payloadSize_,
+							payloadSize_);
+		}
+
+		/// Returns the whole packet.
+		/// \details Returns the viewed buffer.
+		/// \return Packet data.
+		RTPSpan RTPPacketView::getPacketData() const noexcept {
+			return makeSpan(data_, size_);
+		}
+	}
+}
@@ -0,0 +1,131 @@
+/// \file RTPPacketView.hpp
+/// \brief Contains classes and functions declarations that provide Real-time
+/// Transport Protocol (RTP) packet view implementation.
+/// \bug No known bugs.
+
+#ifndef RTPPACKETVIEW_HPP
+#define RTPPACKETVIEW_HPP
+
+#include "Base/Export.hpp"
+
+#include <QByteArray>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		/// Structure that describes a range of bytes of a viewed buffer.
+		/// \details Does not own the bytes.
+		struct RTPSpan final {
+
+			/// First byte of the range.
+			const char* data_ { nullptr };
+
+			/// Number of bytes in the range.
+			int size_ { 0 };
+		};
+
+		/// Class that provides a non-owning RTP packet view.
+		/// \details Parses the fixed header in place and refers to the
+		/// contributing sources, the header extension and the payload in
+		/// the original buffer, so parsing neither allocates nor copies. The
+		/// view is valid as long as the buffer is.
+		class RTSPCLIENT_EXPORT RTPPacketView final {
+		public:
+
+			/// Parses raw RTP data.
+			/// \param[in]	data	Packet data.
+			/// \param[in]	size	Packet size.
+			/// \return RTP packet view, invalid on error.
+			static RTPPacketView parse(const char* data, int size) noexcept;
+
+			/// Parses raw RTP data.
+			/// \param[in]	data	Packet data.
+			/// \return RTP packet view, invalid on error.
+			static RTPPacketView parse(const QByteArray& data) noexcept;
+
+		public:
+
+			/// Indicates whether the packet is valid.
+			/// \retval true if the packet is valid.
+			/// \retval false if the packet is not valid.
+			bool isValid() const noexcept;
+
+			/// Returns protocol version.
+			/// \return Protocol version.
+			quint8 getProtocolVersion() const noexcept;
+
+			/// Returns padding size.
+			/// \return Padding size.
+			quint8 getPaddingSize() const noexcept;
+
+			/// Returns profile-specific marker.
+			/// \return Profile-specific marker.
+			quint8 getProfileMarker() const noexcept;
+
+			/// Returns payload type.
+			/// \return Payload type.
+			quint8 getPayloadType() const noexcept;
+
+			/// Returns sequence number.
+			/// \return Sequence number.
+			quint16 getSequenceNumber() const noexcept;
+
+			/// Returns timestamp.
+			/// \return Timestamp.
+			quint32 getTimestamp() const noexcept;
+
+			/// Returns Synchronization source ID (SSRC).
+			/// \return Synchronization source ID (SSRC).
+			quint32 getSSRC() const noexcept;
+
+			/// Returns number of Contributing source IDs (CSRC).
+			/// \return Number of Contributing source IDs (CSRC).
+			int getCSRCCount() const noexcept;
+
+			/// Returns Contributing source ID (CSRC).
+			/// \param[in]	index	CSRC index.
+			/// \return Contributing source ID (CSRC).
+			quint32 getCSRC(int index) const noexcept;
+
+			/// Returns Contributing source ID (CSRC) array.
+			/// \return Big-endian Contributing source ID (CSRC) array.
+			RTPSpan getCSRCData() const noexcept;
+
+			/// Returns header extension.
+			/// \return Header extension.
+			RTPSpan getHeaderExtension() const noexcept;
+
+			/// Returns payload data.
+			/// \return Payload data.
+			RTPSpan getPayloadData() const noexcept;
+
+			/// Returns the whole packet.
+			/// \return Packet data.
+			RTPSpan getPacketData() const noexcept;
+
+		private:
+
+			/// Packet data.
+			const char* data_ { nullptr };
+
+			/// Packet size.
+			int size_ { 0 };
+
+			/// Header extension size.
+			int extensionSize_ { 0 };
+
+			/// Payload data size.
+			int payloadSize_ { 0 };
+
+			/// Padding size.
+			quint8 paddingSize_ { 0 };
+		};
+	}
+}
+
+#endif
@@ -1,6 +1,372 @@
+/// \file RTPSequence.cpp
+/// \brief Contains classes and functions definitions that provide Real-time
+/// Transport Protocol (RTP) packet sequence implementation.
+/// \bug No known bugs.
+
 #include "RTPSequence.hpp"
 
-RTPSequence::RTPSequence()
-{
+#include <utility>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		namespace {
+
+			/// Size of the sequence number space.
+			/// \details The first packet is placed one space above zero, so
+			/// extended numbers of reordered packets stay positive.
+			constexpr qint64 SEQUENCE_MOD { 1 << 16 };
+
+			/// Minimum buffer capacity.
+			/// \details Smaller buffers reset on ordinary reordering.
+			constexpr int MINIMUM_CAPACITY { 16 };
+
+			/// Maximum buffer capacity.
+			/// \details Half of the sequence number space, so the order of
+			/// any two buffered packets is unambiguous.
+			constexpr int MAXIMUM_CAPACITY { 1 << 15 };
+
+			/// Default playout delay.
+			/// \details Covers reordering of a path with several links.
+			constexpr qint64 DEFAULT_DELAY { 50 * 1000 * 1000 };
+
+			/// Default minimum adaptive playout delay.
+			/// \details Absorbs reordering not seen so far.
+			constexpr qint64 DEFAULT_MINIMUM_DELAY { 2 * 1000 * 1000 };
+
+			/// Default maximum adaptive playout delay.
+			/// \details Bounds latency added on a very bad path.
+			constexpr qint64 DEFAULT_MAXIMUM_DELAY { 500 * 1000 * 1000 };
+
+			/// Smoothing of reorder delay samples below the estimate.
+			/// \details Weight of a sample is two to the minus this power.
+			constexpr int SMOOTHING_SHIFT { 4 };
+
+			/// Decay of the reorder delay estimate per packet in order.
+			/// \details The estimate halves after about 700 such packets.
+			constexpr int DECAY_SHIFT { 10 };
+
+			/// Rounds capacity up to a power of two.
+			/// \param[in]	capacity	Requested capacity.
+			/// \return Capacity within the supported range.
+			int ringCapacity(int capacity) noexcept {
+				auto result = MINIMUM_CAPACITY;
+				while (result < capacity && result < MAXIMUM_CAPACITY)
+					result <<= 1;
+
+				return result;
+			}
+		}
+
+		/// Structure that describes a ring slot.
+		/// \details Slots keep the state of the extended sequence number
+		/// they held last, so played and skipped packets are recognized
+		/// until the ring wraps.
+		struct RTPSequence::Slot final {
+
+			/// Slot states.
+			enum class State {
+
+				/// Never used.
+				Empty,
+
+				/// Waiting for the packet.
+				Missing,
+
+				/// Holding the packet.
+				Buffered,
+
+				/// The packet is played.
+				Played,
+
+				/// The packet is skipped as lost.
+				Skipped
+			};
+
+			/// Buffered packet.
+			RTPSequencePacket packet_;
+
+			/// Extended sequence number of the slot.
+			qint64 sequence_ { -1 };
+
+			/// Time the packet went missing.
+			/// \details Arrival time of the first packet after it.
+			qint64 missing_ { 0 };
+
+			/// Slot state.
+			State state_ { State::Empty };
+		};
+
+		/// Constructor.
+		/// \details Allocates all slots, the capacity is rounded up to a
+		/// power of two from 16 to 32768 packets.
+		/// \param[in]	capacity	Buffer capacity in packets.
+		RTPSequence::RTPSequence(int capacity)
+			: slots_(new Slot[ringCapacity(capacity)]),
+			  mask_(ringCapacity(capacity) - 1),
+			  bad_(SEQUENCE_MOD + 1),
+			  delay_(DEFAULT_DELAY),
+			  minimumDelay_(DEFAULT_MINIMUM_DELAY),
+			  maximumDelay_(DEFAULT_MAXIMUM_DELAY) {
+
+		}
+
+		/// Destructor.
+		/// \details Releases buffered packets.
+		RTPSequence::~RTPSequence() = default;
+
+		/// Inserts a packet.
+		/// \details Places the packet in its slot. Sequence numbers behind
+		/// the playout position are duplicates of played packets or late,
+		/// sequence numbers a capacity or more ahead of it restart the
+		/// buffer. A sequence number more than a capacity behind can not be
+		/// a late packet, since its slot was reused, so it restarts the
+		/// buffer once the next packet follows it, as RFC 3550 appendix A.1
+		/// validates a sender restart. A restart empties the slots between
+		/// the playout position and the end, so their buffers return to the
+		/// pool at once. Slots skipped by a jump ahead are marked missing,
+		/// each sequence number once, so insertion takes constant amortized
+		/// time.
+		/// \param[in]	sequence	RTP sequence number.
+		/// \param[in]	timestamp	RTP timestamp.
+		/// \param[in]	data		Packet data.
+		/// \param[in]	arrival		Arrival time in nanoseconds.
+		/// \return Insertion result.
+		RTPSequenceStatus RTPSequence::insert(quint16 sequence,
+											  quint32 timestamp,
+											  PacketBuffer data,
+											  qint64 arrival) {
+
+			if (!started_) {
+				started_ = true;
+				head_ = end_ = SEQUENCE_MOD + sequence;
+			}
+
+			auto extended = head_ + static_cast<qint16>(
+				sequence - static_cast<quint16>(head_));
+
+			if (extended < head_ && head_ - extended <= mask_) {
+				const auto& slot = slots_[extended & mask_];
+
+				if (slot.sequence_ == extended &&
+					slot.state_ == Slot::State::Played) {
+					++statistics_.duplicates_;
+					return RTPSequenceStatus::Duplicate;
+				}
+
+				++statistics_.late_;
+
+				if (adaptive_ && slot.sequence_ == extended &&
+					slot.state_ == Slot::State::Skipped)
+					adapt(arrival - slot.missing_);
+
+				return RTPSequenceStatus::Late;
+			}
+
+			if (extended < head_ && sequence != bad_) {
+				bad_ = (sequence + 1u) & 0xFFFFu;
+				++statistics_.late_;
+				return RTPSequenceStatus::Late;
+			}
+
+			auto status = RTPSequenceStatus::Inserted;
+
+			if (extended < head_ || extended - head_ > mask_) {
+				++statistics_.resets_;
+				statistics_.dropped_ += static_cast<quint64>(size_);
+
+				for (auto i = head_; i < end_; ++i) slots_[i & mask_] = Slot();
+
+				size_ = 0;
+				head_ = end_ = extended;
+				bad_ = SEQUENCE_MOD + 1;
+				status = RTPSequenceStatus::Reset;
+			}
+
+			auto& slot = slots_[extended & mask_];
+
+			if (slot.sequence_ == extended &&
+				slot.state_ == Slot::State::Buffered) {
+				++statistics_.duplicates_;
+				return RTPSequenceStatus::Duplicate;
+			}
+
+			auto sample = qint64 { 0 };
+
+			if (extended < end_) sample = arrival - slot.missing_;
+			else {
+				for (auto missing = end_; missing < extended; ++missing) {
+					auto& gap = slots_[missing & mask_];
+					gap.packet_.data_.clear();
+					gap.sequence_ = missing;
+					gap.missing_ = arrival;
+					gap.state_ = Slot::State::Missing;
+				}
+
+				end_ = extended + 1;
+			}
+
+			slot.packet_.data_ = std::move(data);
+			slot.packet_.sequence_ = extended;
+			slot.packet_.timestamp_ = timestamp;
+			slot.packet_.arrival_ = arrival;
+			slot.sequence_ = extended;
+			slot.state_ = Slot::State::Buffered;
+
+			++size_;
+			++statistics_.inserted_;
+
+			if (adaptive_) adapt(sample);
+
+			return status;
+		}
+
+		/// Takes the next packet due for playout.
+		/// \details Plays the packet at the playout position if it is
+		/// buffered. A missing packet is skipped as lost once the playout
+		/// delay has passed since it went missing.
+		/// \param[out]	packet	Played packet.
+		/// \param[in]	now		Current time in nanoseconds.
+		/// \retval true if a packet is played.
+		/// \retval false if no packet is due.
+		bool RTPSequence::pop(RTPSequencePacket& packet, qint64 now) {
+			while (head_ < end_) {
+				auto& slot = slots_[head_ & mask_];
+
+				if (slot.state_ == Slot::State::Buffered) {
+					packet = std::move(slot.packet_);
+					slot.state_ = Slot::State::Played;
+
+					++head_;
+					--size_;
+					++statistics_.played_;
+
+					return true;
+				}
+
+				if (now - slot.missing_ < delay_) return false;
+
+				slot.state_ = Slot::State::Skipped;
+
+				++head_;
+				++statistics_.lost_;
+			}
+
+			return false;
+		}
+
+		/// Returns time when the next packet is due for playout.
+		/// \details A buffered packet is due at its arrival, a missing one
+		/// is skipped when the playout delay has passed since it went
+		/// missing. Lets the caller arm a timer.
+		/// \return Time in nanoseconds, or -1 if the buffer is empty.
+		qint64 RTPSequence::getDeadline() const noexcept {
+			if (head_ == end_) return -1;
+
+			const auto& slot = slots_[head_ & mask_];
+
+			return slot.state_ == Slot::State::Buffered
+				   ? slot.packet_.arrival_
+				   : slot.missing_ + delay_;
+		}
+
+		/// Removes all packets and starts over.
+		/// \details Resets every slot, so it takes time proportional to the
+		/// capacity. Statistics and playout delay are kept.
+		void RTPSequence::clear() {
+			for (auto i = qint64 { 0 }; i <= mask_; ++i) slots_[i] = Slot();
+
+			started_ = false;
+			head_ = end_ = 0;
+			bad_ = SEQUENCE_MOD + 1;
+			size_ = 0;
+		}
+
+		/// Returns number of buffered packets.
+		/// \details Packets dropped by a reset are not counted.
+		/// \return Number of buffered packets.
+		int RTPSequence::getSize() const noexcept {
+			return size_;
+		}
+
+		/// Returns buffer capacity.
+		/// \details A power of two.
+		/// \return Buffer capacity in packets.
+		int RTPSequence::getCapacity() const noexcept {
+			return static_cast<int>(mask_ + 1);
+		}
+
+		/// Returns current playout delay.
+		/// \details With adaptive delay enabled the value changes with
+		/// every inserted packet.
+		/// \return Playout delay in nanoseconds.
+		qint64 RTPSequence::getDelay() const noexcept {
+			return delay_;
+		}
+
+		/// Sets playout delay.
+		/// \details Adaptive delay starts from this value.
+		/// \param[in]	delay	Playout delay in nanoseconds.
+		void RTPSequence::setDelay(qint64 delay) noexcept {
+			delay_ = qMax(delay, qint64 { 0 });
+		}
+
+		/// Indicates whether playout delay is adaptive.
+		/// \details Playout delay is fixed by default.
+		/// \retval true if playout delay is adaptive.
+		/// \retval false if playout delay is fixed.
+		bool RTPSequence::isAdaptive() const noexcept {
+			return adaptive_;
+		}
+
+		/// Enables or disables adaptive playout delay.
+		/// \details Adaptive delay follows the reorder delay observed on the
+		/// stream within the delay range.
+		/// \param[in]	adaptive	Whether playout delay is adaptive.
+		void RTPSequence::setAdaptive(bool adaptive) noexcept {
+			adaptive_ = adaptive;
+			estimate_ = 0;
+		}
+
+		/// Sets bounds of adaptive playout delay.
+		/// \details Bounds are swapped if given in reverse order.
+		/// \param[in]	minimum	Minimum delay in nanoseconds.
+		/// \param[in]	maximum	Maximum delay in nanoseconds.
+		void RTPSequence::setDelayRange(qint64 minimum,
+										qint64 maximum) noexcept {
+
+			minimumDelay_ = qMax(qMin(minimum, maximum), qint64 { 0 });
+			maximumDelay_ = qMax(qMax(minimum, maximum), qint64 { 0 });
+		}
+
+		/// Returns sequence statistics.
+		/// \details Must be called from the thread that uses the sequence.
+		/// \return Sequence statistics.
+		const RTPSequenceStatistics&
+		RTPSequence::getStatistics() const noexcept {
+			return statistics_;
+		}
+
+		/// Updates adaptive playout delay.
+		/// \details The reorder delay estimate jumps up to a larger sample,
+		/// moves slowly towards a smaller one and decays while packets come
+		/// in order. The delay keeps a quarter of the estimate as a margin.
+		/// \param[in]	sample	Reorder delay of a packet, zero for a
+		///						packet in order.
+		void RTPSequence::adapt(qint64 sample) noexcept {
+			if (sample > estimate_) estimate_ = sample;
+			else if (sample > 0)
+				estimate_ += (sample - estimate_) / (1 << SMOOTHING_SHIFT);
+			else estimate_ -= estimate_ >> DECAY_SHIFT;
 
+			delay_ = qBound(minimumDelay_,
+							estimate_ + estimate_ / 4,
+							maximumDelay_);
+		}
+	}
 }
@@ -1,11 +1,229 @@
+/// \file RTPSequence.hpp
+/// \brief Contains classes and functions declarations that provide Real-time
+/// Transport Protocol (RTP) packet sequence implementation.
+/// \bug No known bugs.
+
 #ifndef RTPSEQUENCE_HPP
 #define RTPSEQUENCE_HPP
 
+#include "Base/Export.hpp"
+#include "Utilities/PacketBufferPool.hpp"
+
+#include <QtGlobal>
+
+#include <memory>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		/// Enumeration that defines results of RTP packet insertion.
+		enum class RTPSequenceStatus {
+
+			/// The packet is buffered.
+			Inserted,
+
+			/// The packet is buffered or played already.
+			Duplicate,
+
+			/// The packet arrived after its turn was skipped.
+			Late,
+
+			/// The packet is too far ahead, or follows a packet too far
+			/// behind, the buffer starts over from it.
+			Reset
+		};
+
+		/// Structure that describes an RTP packet of a sequence.
+		struct RTPSequencePacket final {
+
+			/// Packet data.
+			PacketBuffer data_;
+
+			/// Extended sequence number.
+			/// \details Sequence number with wraparounds counted in the
+			/// upper bits.
+			qint64 sequence_ { 0 };
+
+			/// RTP timestamp.
+			quint32 timestamp_ { 0 };
+
+			/// Arrival time in nanoseconds.
+			qint64 arrival_ { 0 };
+		};
+
+		/// Structure that provides RTP packet sequence statistics.
+		/// \details Counters cover the whole life of the sequence.
+		struct RTPSequenceStatistics final {
+
+			/// Number of buffered packets.
+			quint64 inserted_ { 0 };
+
+			/// Number of played packets.
+			quint64 played_ { 0 };
+
+			/// Number of packets skipped as lost.
+			quint64 lost_ { 0 };
+
+			/// Number of packets arrived after their turn was skipped.
+			quint64 late_ { 0 };
+
+			/// Number of suppressed duplicates.
+			quint64 duplicates_ { 0 };
+
+			/// Number of resets.
+			/// \details A packet too far ahead of the playout position, as
+			/// after a sender restart or a long outage, starts over, and so
+			/// do two consecutive packets too far behind it.
+			quint64 resets_ { 0 };
+
+			/// Number of buffered packets dropped by resets.
+			quint64 dropped_ { 0 };
+		};
+
+		/// Class that provides RTP jitter and reorder buffer.
+		/// \details Buffers packets in a ring indexed by the sequence number
+		/// modulo the capacity and plays them in sequence order. A packet
+		/// that follows the played ones is played at once, a missing packet
+		/// is waited for up to the playout delay and then skipped as lost.
+		/// The delay is fixed or follows the reorder delay observed on the
+		/// stream. All operations take constant time and do not allocate.
+		class RTSPCLIENT_EXPORT RTPSequence final {
+		public:
+
+			/// Constructor.
+			/// \param[in]	capacity	Buffer capacity in packets.
+			explicit RTPSequence(int capacity = 1024);
+
+			/// Destructor.
+			~RTPSequence();
+
+			/// Copy constructor.
+			/// \param[in]	object	Object to copy.
+			RTPSequence(const RTPSequence& object) = delete;
+
+			/// Copy assignment operator.
+			/// \param[in]	object	Object to copy.
+			/// \return This object.
+			RTPSequence& operator=(const RTPSequence& object) = delete;
+
+		public:
+
+			/// Inserts a packet.
+			/// \param[in]	sequence	RTP sequence number.
+			/// \param[in]	timestamp	RTP timestamp.
+			/// \param[in]	data		Packet data.
+			/// \param[in]	arrival		Arrival time in nanoseconds.
+			/// \return Insertion result.
+			RTPSequenceStatus insert(quint16 sequence,
+									 quint32 timestamp,
+									 PacketBuffer data,
+									 qint64 arrival);
+
+			/// Takes the next packet due for playout.
+			/// \param[out]	packet	Played packet.
+			/// \param[in]	now		Current time in nanoseconds.
+			/// \retval true if a packet is played.
+			/// \retval false if no packet is due.
+			bool pop(RTPSequencePacket& packet, qint64 now);
+
+			/// Returns time when the next packet is due for playout.
+			/// \return Time in nanoseconds, or -1 if the buffer is empty.
+			qint64 getDeadline() const noexcept;
+
+			/// Removes all packets and starts over.
+			void clear();
+
+			/// Returns number of buffered packets.
+			/// \return Number of buffered packets.
+			int getSize() const noexcept;
+
+			/// Returns buffer capacity.
+			/// \return Buffer capacity in packets.
+			int getCapacity() const noexcept;
+
+			/// Returns current playout delay.
+			/// \return Playout delay in nanoseconds.
+			qint64 getDelay() const noexcept;
+
+			/// Sets playout delay.
+			/// \param[in]	delay	Playout delay in nanoseconds.
+			void setDelay(qint64 delay) noexcept;
+
+			/// Indicates whether playout delay is adaptive.
+			/// \retval true if playout delay is adaptive.
+			/// \retval false if playout delay is fixed.
+			bool isAdaptive() const noexcept;
+
+			/// Enables or disables adaptive playout delay.
+			/// \param[in]	adaptive	Whether playout delay is adaptive.
+			void setAdaptive(bool adaptive) noexcept;
+
+			/// Sets bounds of adaptive playout delay.
+			/// \param[in]	minimum	Minimum delay in nanoseconds.
+			/// \param[in]	maximum	Maximum delay in nanoseconds.
+			void setDelayRange(qint64 minimum, qint64 maximum) noexcept;
+
+			/// Returns sequence statistics.
+			/// \return Sequence statistics.
+			const RTPSequenceStatistics& getStatistics() const noexcept;
+
+		private:
+
+			/// Updates adaptive playout delay.
+			/// \param[in]	sample	Reorder delay of a packet, zero for a
+			///						packet in order.
+			void adapt(qint64 sample) noexcept;
+
+		private:
+
+			/// Opaque type for a ring slot.
+			struct Slot;
+
+			/// Ring slots.
+			std::unique_ptr<Slot[]> slots_;
+
+			/// Ring index mask.
+			const qint64 mask_;
+
+			/// Whether the first packet is inserted.
+			bool started_ { false };
+
+			/// Extended sequence number of the next packet to play.
+			qint64 head_ { 0 };
+
+			/// Extended sequence number after the highest inserted one.
+			qint64 end_ { 0 };
+
+			/// Sequence number expected after a packet too far behind.
+			quint32 bad_;
+
+			/// Number of buffered packets.
+			int size_ { 0 };
+
+			/// Playout delay.
+			qint64 delay_;
+
+			/// Whether playout delay is adaptive.
+			bool adaptive_ { false };
+
+			/// Minimum adaptive playout delay.
+			qint64 minimumDelay_;
+
+			/// Maximum adaptive playout delay.
+			qint64 maximumDelay_;
+
+			/// Reorder delay estimate.
+			qint64 estimate_ { 0 };
 
-class RTPSequence
-{
-public:
-	RTPSequence();
-};
+			/// Sequence statistics.
+			RTPSequenceStatistics statistics_;
+		};
+	}
+}
 
-#endif // RTPSEQUENCE_HPP
+#endif
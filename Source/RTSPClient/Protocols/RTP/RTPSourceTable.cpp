@@ -0,0 +1,221 @@
+/// \file RTPSourceTable.cpp
+/// \brief Contains classes and functions definitions that provide Real-time
+/// Transport Protocol (RTP) source table implementation.
+/// \bug No known bugs.
+
+#include "RTPSourceTable.hpp"
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		namespace {
+
+			/// Minimum number of slots.
+			/// \details Four cache lines of slots.
+			constexpr int MINIMUM_BITS { 4 };
+
+			/// Maximum number of slots.
+			/// \details Keeps the slot count within an int.
+			constexpr int MAXIMUM_BITS { 30 };
+
+			/// Multiplier of Fibonacci hashing.
+			/// \details Two to the 64th power divided by the golden ratio,
+			/// spreads addresses and SSRCs that differ in a few bits over
+			/// the upper bits of the product.
+			constexpr quint64 HASH_MULTIPLIER { 0x9E3779B97F4A7C15ull };
+
+			/// Returns number of index bits for a capacity.
+			/// \details The table is at most half full at that capacity.
+			/// \param[in]	capacity	Number of entries.
+			/// \return Number of index bits.
+			int indexBits(int capacity) noexcept {
+				auto bits = MINIMUM_BITS;
+				while (bits < MAXIMUM_BITS &&
+					   (qint64 { 1 } << bits) < qint64 { 2 } * capacity)
+					++bits;
+
+				return bits;
+			}
+
+			/// Returns entry key.
+			/// \param[in]	address	IPv4 source address.
+			/// \param[in]	source	Synchronization source ID (SSRC).
+			/// \return Entry key.
+			inline quint64 makeKey(quint32 address, quint32 source) noexcept {
+				return static_cast<quint64>(address) << 32 | source;
+			}
+		}
+
+		/// Structure that describes a table slot.
+		/// \details Sixteen bytes, so four slots share a cache line. A slot
+		/// without a receiver is empty.
+		struct RTPSourceTable::Slot final {
+
+			/// Source address in the upper and SSRC in the lower half.
+			quint64 key_ { 0 };
+
+			/// Receiver.
+			void* value_ { nullptr };
+		};
+
+		/// Constructor.
+		/// \details Allocates twice as many slots as entries, rounded up to a
+		/// power of two. The table grows when it gets half full.
+		/// \param[in]	capacity	Initial number of entries.
+		RTPSourceTable::RTPSourceTable(int capacity)
+			: slots_(new Slot[std::size_t { 1 } << indexBits(capacity)]),
+			  mask_((quint64 { 1 } << indexBits(capacity)) - 1),
+			  shift_(64 - indexBits(capacity)) {
+
+		}
+
+		/// Destructor.
+		/// \details Receivers are not owned.
+		RTPSourceTable::~RTPSourceTable() = default;
+
+		/// Inserts or replaces an entry.
+		/// \details Takes constant amortized time, the table doubles once it
+		/// would get more than half full.
+		/// \param[in]	address	IPv4 source address.
+		/// \param[in]	source	Synchronization source ID (SSRC).
+		/// \param[in]	value	Receiver, must not be null.
+		/// \retval true if the entry is inserted or replaced.
+		/// \retval false if the receiver is null.
+		bool RTPSourceTable::insert(quint32 address,
+									quint32 source,
+									void* value) {
+
+			if (!value) return false;
+
+			if (quint64 { 2 } * (size_ + 1) > mask_ + 1 &&
+				shift_ > 64 - MAXIMUM_BITS)
+				grow();
+
+			auto key = makeKey(address, source);
+
+			for (auto index = home(key); ; index = (index + 1) & mask_) {
+				auto& slot = slots_[index];
+
+				if (!slot.value_) {
+					slot.key_ = key;
+					slot.value_ = value;
+					++size_;
+
+					return true;
+				}
+
+				if (slot.key_ == key) {
+					slot.value_ = value;
+					return true;
+				}
+			}
+		}
+
+		/// Removes an entry.
+		/// \details Shifts the entries that follow in the probe sequence
+		/// back into the gap, so no deleted markers accumulate and lookups
+		/// stay short.
+		/// \param[in]	address	IPv4 source address.
+		/// \param[in]	source	Synchronization source ID (SSRC).
+		/// \retval true if the entry is removed.
+		/// \retval false if there is no such entry.
+		bool RTPSourceTable::remove(quint32 address, quint32 source) noexcept {
+			auto key = makeKey(address, source);
+			auto gap = home(key);
+
+			while (slots_[gap].value_ && slots_[gap].key_ != key)
+				gap = (gap + 1) & mask_;
+
+			if (!slots_[gap].value_) return false;
+
+			for (auto index = (gap + 1) & mask_;
+				 slots_[index].value_;
+				 index = (index + 1) & mask_) {
+
+				auto distance = (index - home(slots_[index].key_)) & mask_;
+
+				if (distance >= ((index - gap) & mask_)) {
+					slots_[gap] = slots_[index];
+					gap = index;
+				}
+			}
+
+			slots_[gap] = Slot();
+			--size_;
+
+			return true;
+		}
+
+		/// Finds a receiver.
+		/// \details Probes from the home slot of the key up to the first
+		/// empty slot.
+		/// \param[in]	address	IPv4 source address.
+		/// \param[in]	source	Synchronization source ID (SSRC).
+		/// \return Receiver or nullptr if there is no such entry.
+		void* RTPSourceTable::find(quint32 address,
+								   quint32 source) const noexcept {
+
+			auto key = makeKey(address, source);
+
+			for (auto index = home(key); ; index = (index + 1) & mask_) {
+				const auto& slot = slots_[index];
+
+				if (!slot.value_ || slot.key_ == key) return slot.value_;
+			}
+		}
+
+		/// Removes all entries.
+		/// \details Keeps the slots allocated.
+		void RTPSourceTable::clear() noexcept {
+			for (quint64 i = 0; i <= mask_; ++i) slots_[i] = Slot();
+
+			size_ = 0;
+		}
+
+		/// Returns number of entries.
+		/// \details Counts inserted receivers.
+		/// \return Number of entries.
+		int RTPSourceTable::getSize() const noexcept {
+			return size_;
+		}
+
+		/// Returns number of slots.
+		/// \details A power of two, at least twice the number of entries.
+		/// \return Number of slots.
+		int RTPSourceTable::getCapacity() const noexcept {
+			return static_cast<int>(mask_ + 1);
+		}
+
+		/// Returns home slot of a key.
+		/// \details Fibonacci hashing takes the upper bits of the product,
+		/// which depend on all bits of the key.
+		/// \param[in]	key	Entry key.
+		/// \return Slot index.
+		quint64 RTPSourceTable::home(quint64 key) const noexcept {
+			return (key * HASH_MULTIPLIER) >> shift_;
+		}
+
+		/// Doubles the number of slots.
+		/// \details Inserts all entries into the new slots again.
+		void RTPSourceTable::grow() {
+			auto capacity = mask_ + 1;
+			std::unique_ptr<Slot[]> previous(new Slot[capacity * 2]);
+
+			previous.swap(slots_);
+			mask_ = capacity * 2 - 1;
+			--shift_;
+			size_ = 0;
+
+			for (quint64 i = 0; i < capacity; ++i)
+				if (previous[i].value_)
+					insert(static_cast<quint32>(previous[i].key_ >> 32),
+						   static_cast<quint32>(previous[i].key_),
+						   previous[i].value_);
+		}
+	}
+}
@@ -0,0 +1,111 @@
+/// \file RTPSourceTable.hpp
+/// \brief Contains classes and functions declarations that provide Real-time
+/// Transport Protocol (RTP) source table implementation.
+/// \bug No known bugs.
+
+#ifndef RTPSOURCETABLE_HPP
+#define RTPSOURCETABLE_HPP
+
+#include "Base/Export.hpp"
+
+#include <QtGlobal>
+
+#include <memory>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		/// Class that provides RTP source table.
+		/// \details Maps a source address and a synchronization source ID
+		/// (SSRC) to a receiver. Entries are kept in one flat array with
+		/// open addressing and linear probing, so a lookup usually reads a
+		/// single cache line and never allocates.
+		class RTSPCLIENT_EXPORT RTPSourceTable final {
+		public:
+
+			/// Constructor.
+			/// \param[in]	capacity	Initial number of entries.
+			explicit RTPSourceTable(int capacity = 64);
+
+			/// Destructor.
+			~RTPSourceTable();
+
+			/// Copy constructor.
+			/// \param[in]	object	Object to copy.
+			RTPSourceTable(const RTPSourceTable& object) = delete;
+
+			/// Copy assignment operator.
+			/// \param[in]	object	Object to copy.
+			/// \return This object.
+			RTPSourceTable& operator=(const RTPSourceTable& object) = delete;
+
+		public:
+
+			/// Inserts or replaces an entry.
+			/// \param[in]	address	IPv4 source address.
+			/// \param[in]	source	Synchronization source ID (SSRC).
+			/// \param[in]	value	Receiver, must not be null.
+			/// \retval true if the entry is inserted or replaced.
+			/// \retval false if the receiver is null.
+			bool insert(quint32 address, quint32 source, void* value);
+
+			/// Removes an entry.
+			/// \param[in]	address	IPv4 source address.
+			/// \param[in]	source	Synchronization source ID (SSRC).
+			/// \retval true if the entry is removed.
+			/// \retval false if there is no such entry.
+			bool remove(quint32 address, quint32 source) noexcept;
+
+			/// Finds a receiver.
+			/// \param[in]	address	IPv4 source address.
+			/// \param[in]	source	Synchronization source ID (SSRC).
+			/// \return Receiver or nullptr if there is no such entry.
+			void* find(quint32 address, quint32 source) const noexcept;
+
+			/// Removes all entries.
+			void clear() noexcept;
+
+			/// Returns number of entries.
+			/// \return Number of entries.
+			int getSize() const noexcept;
+
+			/// Returns number of slots.
+			/// \return Number of slots.
+			int getCapacity() const noexcept;
+
+		private:
+
+			/// Returns home slot of a key.
+			/// \param[in]	key	Entry key.
+			/// \return Slot index.
+			quint64 home(quint64 key) const noexcept;
+
+			/// Doubles the number of slots.
+			void grow();
+
+		private:
+
+			/// Opaque type for a table slot.
+			struct Slot;
+
+			/// Table slots.
+			std::unique_ptr<Slot[]> slots_;
+
+			/// Slot index mask.
+			quint64 mask_;
+
+			/// Shift of the hash to the slot index.
+			int shift_;
+
+			/// Number of entries.
+			int size_ { 0 };
+		};
+	}
+}
+
+#endif
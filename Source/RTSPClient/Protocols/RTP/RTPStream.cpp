@@ -1,6 +1,266 @@
+/// \file RTPStream.cpp
+/// \brief Contains classes and functions definitions that provide Real-time
+/// Transport Protocol (RTP) stream implementation.
+/// \bug No known bugs.
+
 #include "RTPStream.hpp"
 
-RTPStream::RTPStream()
-{
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		namespace {
+
+			/// Size of the sequence number space.
+			/// \details Sequence numbers are 16 bits wide.
+			constexpr quint32 SEQUENCE_MOD { 1 << 16 };
+
+			/// Largest sequence number gap that is counted as loss.
+			/// \details Larger jumps forward mean a restarted sender.
+			constexpr quint16 MAX_DROPOUT { 3000 };
+
+			/// Largest sequence number step back that is counted as reorder.
+			/// \details Larger steps back mean a restarted sender.
+			constexpr quint16 MAX_MISORDER { 100 };
+		}
+
+		/// Constructor.
+		/// \details The stream becomes active with the first packet.
+		/// \param[in]	source		Synchronization source ID (SSRC).
+		/// \param[in]	clockRate	RTP clock rate, zero if unknown.
+		RTPStream::RTPStream(quint32 source, int clockRate) noexcept
+			: source_(source),
+			  clockRate_(clockRate),
+			  sharedSource_(source),
+			  sharedClockRate_(clockRate) {
+
+		}
+
+		/// Destructor.
+		/// \details Default destructor.
+		RTPStream::~RTPStream() = default;
+
+		/// Starts the stream of another source.
+		/// \details Drops all receive state, statistics of the previous
+		/// source are lost.
+		/// \param[in]	source		Synchronization source ID (SSRC).
+		/// \param[in]	clockRate	RTP clock rate, zero if unknown.
+		void RTPStream::reset(quint32 source, int clockRate) noexcept {
+			source_ = source;
+			clockRate_ = clockRate;
+			active_ = false;
+			base_ = maximum_ = 0;
+			bad_ = cycles_ = 0;
+			received_ = expectedPrior_ = receivedPrior_ = lostBefore_ = 0;
+			fractionLost_ = 0;
+			hasTransit_ = false;
+			transit_ = jitter_ = 0;
+
+			publish();
+		}
+
+		/// Updates the stream with a received packet.
+		/// \details Tracks the extended highest sequence number as RFC 3550
+		/// appendix A.1 describes. A jump of more than 3000 packets ahead or
+		/// 100 packets back is ignored, unless the next packet follows it,
+		/// which means a restarted sender. Interarrival jitter follows
+		/// appendix A.8, with arrival time converted to timestamp units.
+		/// \param[in]	sequence	RTP sequence number.
+		/// \param[in]	timestamp	RTP timestamp.
+		/// \param[in]	arrival		Arrival time in nanoseconds.
+		/// \return Update result.
+		RTPStreamStatus RTPStream::update(quint16 sequence,
+										  quint32 timestamp,
+										  qint64 arrival) noexcept {
+
+			auto status = RTPStreamStatus::Valid;
+
+			if (!active_) {
+				active_ = true;
+				start(sequence);
+			}
+			else {
+				auto delta = static_cast<quint16>(sequence - maximum_);
+
+				if (delta < MAX_DROPOUT) {
+					if (sequence < maximum_) cycles_ += SEQUENCE_MOD;
+					maximum_ = sequence;
+				}
+				else if (delta <= SEQUENCE_MOD - MAX_MISORDER) {
+					if (sequence != bad_) {
+						bad_ = (sequence + 1u) & 0xFFFFu;
+						return RTPStreamStatus::Invalid;
+					}
+
+					lostBefore_ += expected() - received_;
+					start(sequence);
+					status = RTPStreamStatus::Restarted;
+				}
+			}
+
+			++received_;
+
+			if (clockRate_ > 0) {
+				auto units = static_cast<quint32>(
+					arrival / 1000 * clockRate_ / 1000000);
+				auto transit = units - timestamp;
+
+				if (hasTransit_) {
+					auto difference = static_cast<qint32>(transit - transit_);
+					auto magnitude = static_cast<quint32>(
+						difference < 0 ? -static_cast<qint64>(difference)
+									   : difference);
+
+					jitter_ += magnitude - ((jitter_ + 8) >> 4);
+				}
+
+				transit_ = transit;
+				hasTransit_ = true;
+			}
+
+			publish();
+
+			return status;
+		}
+
+		/// Closes a report interval.
+		/// \details Computes the fraction of packets lost since the previous
+		/// call as RFC 3550 appendix A.3 describes. Duplicates do not make
+		/// the fraction negative, it is zero then.
+		/// \return Fraction of packets lost in the interval.
+		quint8 RTPStream::updateFractionLost() noexcept {
+			auto expected = this->expected();
+
+			auto expectedInterval = expected - expectedPrior_;
+			auto receivedInterval = received_ - receivedPrior_;
+			auto lostInterval = expectedInterval - receivedInterval;
+
+			expectedPrior_ = expected;
+			receivedPrior_ = received_;
+
+			fractionLost_ =
+				expectedInterval == 0 || lostInterval <= 0
+				? 0
+				: static_cast<quint8>((lostInterval << 8) / expectedInterval);
+
+			publish();
+
+			return fractionLost_;
+		}
+
+		/// Indicates whether a packet was received.
+		/// \details A stream becomes active with its first packet.
+		/// \retval true if a packet was received.
+		/// \retval false if no packet was received.
+		bool RTPStream::isActive() const noexcept {
+			return active_;
+		}
+
+		/// Returns Synchronization source ID (SSRC).
+		/// \details Must be called from the receiving thread.
+		/// \return Synchronization source ID (SSRC).
+		quint32 RTPStream::getSSRC() const noexcept {
+			return source_;
+		}
+
+		/// Returns RTP clock rate.
+		/// \details Must be called from the receiving thread.
+		/// \return RTP clock rate, zero if unknown.
+		int RTPStream::getClockRate() const noexcept {
+			return clockRate_;
+		}
+
+		/// Returns number of lost packets of the current sequence.
+		/// \details Must be called from the receiving thread. Reads the
+		/// counters directly, without the published snapshot. Late packets
+		/// and duplicates may make the number drop.
+		/// \return Number of lost packets.
+		qint64 RTPStream::getLost() const noexcept {
+			return expected() - received_;
+		}
+
+		/// Returns receiver statistics.
+		/// \details Safe to call from any thread. Reads a consistent snapshot
+		/// without locks, retrying if the receiving thread published new
+		/// statistics meanwhile.
+		/// \return Receiver statistics.
+		RTPStreamStatistics RTPStream::getStatistics() const noexcept {
+			RTPStreamStatistics statistics;
+			qint64 lostBefore;
+
+			lock_.read([&]() {
+				statistics.source_ =
+					sharedSource_.load(std::memory_order_relaxed);
+				statistics.clockRate_ =
+					sharedClockRate_.load(std::memory_order_relaxed);
+				statistics.extendedMaximum_ =
+					sharedMaximum_.load(std::memory_order_relaxed);
+				statistics.expected_ =
+					sharedExpected_.load(std::memory_order_relaxed);
+				statistics.received_ =
+					sharedReceived_.load(std::memory_order_relaxed);
+				statistics.fractionLost_ =
+					sharedFractionLost_.load(std::memory_order_relaxed);
+				statistics.jitter_ =
+					sharedJitter_.load(std::memory_order_relaxed) >> 4;
+				lostBefore = sharedLostBefore_.load(std::memory_order_relaxed);
+			});
+
+			statistics.cycles_ = statistics.extendedMaximum_ >> 16;
+			statistics.lost_ = statistics.expected_ - statistics.received_;
+			statistics.totalLost_ = lostBefore + statistics.lost_;
+
+			if (statistics.clockRate_ > 0)
+				statistics.jitterTime_ =
+					static_cast<qint64>(statistics.jitter_) * 1000000 /
+					statistics.clockRate_;
+
+			return statistics;
+		}
+
+		/// Starts a new sequence.
+		/// \details Resets sequence number tracking of RFC 3550 appendix A.1.
+		/// Timestamps of a restarted sender start over, so the transit time
+		/// is measured again.
+		/// \param[in]	sequence	First sequence number.
+		void RTPStream::start(quint16 sequence) noexcept {
+			base_ = maximum_ = sequence;
+			bad_ = SEQUENCE_MOD + 1;
+			cycles_ = 0;
+			received_ = expectedPrior_ = receivedPrior_ = 0;
+			hasTransit_ = false;
+		}
+
+		/// Returns number of expected packets.
+		/// \details Counts sequence numbers from the first to the extended
+		/// highest one.
+		/// \return Number of expected packets.
+		qint64 RTPStream::expected() const noexcept {
+			if (!active_) return 0;
+
+			return static_cast<qint64>(cycles_) + maximum_ - base_ + 1;
+		}
 
+		/// Publishes statistics to readers.
+		/// \details Writes the shared copies under the sequence lock.
+		void RTPStream::publish() noexcept {
+			lock_.write([this]() {
+				sharedSource_.store(source_, std::memory_order_relaxed);
+				sharedClockRate_.store(clockRate_, std::memory_order_relaxed);
+				sharedMaximum_.store(cycles_ + maximum_,
+									 std::memory_order_relaxed);
+				sharedExpected_.store(expected(), std::memory_order_relaxed);
+				sharedReceived_.store(received_, std::memory_order_relaxed);
+				sharedLostBefore_.store(lostBefore_,
+										std::memory_order_relaxed);
+				sharedFractionLost_.store(fractionLost_,
+										  std::memory_order_relaxed);
+				sharedJitter_.store(jitter_, std::memory_order_relaxed);
+			});
+		}
+	}
 }
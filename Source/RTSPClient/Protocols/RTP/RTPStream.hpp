@@ -1,11 +1,241 @@
+/// \file RTPStream.hpp
+/// \brief Contains classes and functions declarations that provide Real-time
+/// Transport Protocol (RTP) stream implementation.
+/// \bug No known bugs.
+
 #ifndef RTPSTREAM_HPP
 #define RTPSTREAM_HPP
 
+#include "Base/Export.hpp"
+#include "Utilities/SequenceLock.hpp"
+
+#include <QtGlobal>
+
+#include <atomic>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		/// Enumeration that defines results of RTP stream update.
+		enum class RTPStreamStatus {
+
+			/// The packet is counted.
+			Valid,
+
+			/// The packet is ignored as a large sequence number jump.
+			/// \details The next sequential packet confirms a sender restart.
+			Invalid,
+
+			/// The packet confirmed a sender restart and started a new
+			/// sequence.
+			Restarted
+		};
+
+		/// Structure that provides RTP stream receiver statistics.
+		/// \details Follows receiver report fields of RFC 3550. Counters
+		/// cover the current sequence of the source, which a sender restart
+		/// starts over.
+		struct RTPStreamStatistics final {
+
+			/// Synchronization source ID (SSRC).
+			quint32 source_ { 0 };
+
+			/// RTP clock rate, zero if unknown.
+			int clockRate_ { 0 };
+
+			/// Extended highest sequence number received.
+			/// \details Sequence number cycles in the upper 16 bits.
+			quint32 extendedMaximum_ { 0 };
+
+			/// Number of sequence number cycles.
+			quint32 cycles_ { 0 };
+
+			/// Number of expected packets.
+			qint64 expected_ { 0 };
+
+			/// Number of received packets.
+			/// \details Duplicates are counted.
+			qint64 received_ { 0 };
+
+			/// Cumulative number of lost packets.
+			/// \details Negative if duplicates outnumber lost packets.
+			qint64 lost_ { 0 };
+
+			/// Cumulative number of lost packets of all sequences.
+			/// \details Sequences before sender restarts are included.
+			qint64 totalLost_ { 0 };
+
+			/// Fraction of packets lost in the last report interval.
+			/// \details Fixed point number with eight fractional bits.
+			quint8 fractionLost_ { 0 };
+
+			/// Interarrival jitter in timestamp units.
+			quint32 jitter_ { 0 };
+
+			/// Interarrival jitter in microseconds.
+			/// \details Zero if the clock rate is unknown.
+			qint64 jitterTime_ { 0 };
+		};
+
+		/// Class that provides RTP stream receive state.
+		/// \details Keeps the state of a synchronization source as appendices
+		/// A.1, A.3 and A.8 of RFC 3550 describe. The receiving thread updates
+		/// it for every packet with a few plain stores, any thread reads
+		/// statistics without locks.
+		class RTSPCLIENT_EXPORT RTPStream final {
+		public:
+
+			/// Constructor.
+			/// \param[in]	source		Synchronization source ID (SSRC).
+			/// \param[in]	clockRate	RTP clock rate, zero if unknown.
+			explicit RTPStream(quint32 source = 0, int clockRate = 0) noexcept;
+
+			/// Destructor.
+			~RTPStream();
+
+			/// Copy constructor.
+			/// \param[in]	object	Object to copy.
+			RTPStream(const RTPStream& object) = delete;
+
+			/// Copy assignment operator.
+			/// \param[in]	object	Object to copy.
+			/// \return This object.
+			RTPStream& operator=(const RTPStream& object) = delete;
+
+		public:
+
+			/// Starts the stream of another source.
+			/// \param[in]	source		Synchronization source ID (SSRC).
+			/// \param[in]	clockRate	RTP clock rate, zero if unknown.
+			void reset(quint32 source, int clockRate) noexcept;
+
+			/// Updates the stream with a received packet.
+			/// \param[in]	sequence	RTP sequence number.
+			/// \param[in]	timestamp	RTP timestamp.
+			/// \param[in]	arrival		Arrival time in nanoseconds.
+			/// \return Update result.
+			RTPStreamStatus update(quint16 sequence,
+								   quint32 timestamp,
+								   qint64 arrival) noexcept;
+
+			/// Closes a report interval.
+			/// \return Fraction of packets lost in the interval.
+			quint8 updateFractionLost() noexcept;
+
+			/// Indicates whether a packet was received.
+			/// \retval true if a packet was received.
+			/// \retval false if no packet was received.
+			bool isActive() const noexcept;
+
+			/// Returns Synchronization source ID (SSRC).
+			/// \return Synchronization source ID (SSRC).
+			quint32 getSSRC() const noexcept;
+
+			/// Returns RTP clock rate.
+			/// \return RTP clock rate, zero if unknown.
+			int getClockRate() const noexcept;
+
+			/// Returns number of lost packets of the current sequence.
+			/// \return Number of lost packets.
+			qint64 getLost() const noexcept;
+
+			/// Returns receiver statistics.
+			/// \return Receiver statistics.
+			RTPStreamStatistics getStatistics() const noexcept;
+
+		private:
+
+			/// Starts a new sequence.
+			/// \param[in]	sequence	First sequence number.
+			void start(quint16 sequence) noexcept;
+
+			/// Returns number of expected packets.
+			/// \return Number of expected packets.
+			qint64 expected() const noexcept;
+
+			/// Publishes statistics to readers.
+			void publish() noexcept;
+
+		private:
+
+			/// Synchronization source ID (SSRC).
+			quint32 source_;
+
+			/// RTP clock rate.
+			int clockRate_;
+
+			/// Whether a packet was received.
+			bool active_ { false };
+
+			/// First sequence number.
+			quint16 base_ { 0 };
+
+			/// Highest sequence number.
+			quint16 maximum_ { 0 };
+
+			/// Sequence number that confirms a sender restart.
+			quint32 bad_ { 0 };
+
+			/// Sequence number cycles shifted by 16 bits.
+			quint32 cycles_ { 0 };
+
+			/// Number of received packets.
+			qint64 received_ { 0 };
+
+			/// Number of expected packets at the last report.
+			qint64 expectedPrior_ { 0 };
+
+			/// Number of received packets at the last report.
+			qint64 receivedPrior_ { 0 };
+
+			/// Lost packets of previous sequences.
+			qint64 lostBefore_ { 0 };
+
+			/// Fraction of packets lost in the last report interval.
+			quint8 fractionLost_ { 0 };
+
+			/// Whether the relative transit time is known.
+			bool hasTransit_ { false };
+
+			/// Relative transit time of the last packet.
+			quint32 transit_ { 0 };
+
+			/// Interarrival jitter scaled by 16.
+			quint32 jitter_ { 0 };
+
+			/// Lock of published statistics.
+			SequenceLock lock_;
+
+			/// Published synchronization source ID (SSRC).
+			std::atomic<quint32> sharedSource_ { 0 };
+
+			/// Published clock rate.
+			std::atomic<int> sharedClockRate_ { 0 };
+
+			/// Published extended highest sequence number.
+			std::atomic<quint32> sharedMaximum_ { 0 };
+
+			/// Published number of expected packets.
+			std::atomic<qint64> sharedExpected_ { 0 };
+
+			/// Published number of received packets.
+			std::atomic<qint64> sharedReceived_ { 0 };
+
+			/// Published lost packets of previous sequences.
+			std::atomic<qint64> sharedLostBefore_ { 0 };
+
+			/// Published fraction of lost packets.
+			std::atomic<quint8> sharedFractionLost_ { 0 };
 
-class RTPStream
-{
-public:
-	RTPStream();
-};
+			/// Published interarrival jitter scaled by 16.
+			std::atomic<quint32> sharedJitter_ { 0 };
+		};
+	}
+}
 
-#endif // RTPSTREAM_HPP
+#endif
@@ -0,0 +1,144 @@
+/// \file RTPTimestampUnwrapper.cpp
+/// \brief Contains classes and functions definitions that provide Real-time
+/// Transport Protocol (RTP) timestamp unwrapping.
+/// \bug No known bugs.
+
+#include "RTPTimestampUnwrapper.hpp"
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		namespace {
+
+			/// Distance from the published reference that publishes a new
+			/// one.
+			/// \details An eighth of the timestamp space, so extended
+			/// timestamps stay far from the ambiguous half of it.
+			constexpr qint64 REFERENCE_DISTANCE { qint64 { 1 } << 29 };
+
+			/// Returns the signed distance between timestamps.
+			/// \details Timestamps less than half the timestamp space apart
+			/// are taken as the nearest ones.
+			/// \param[in]	timestamp	RTP timestamp.
+			/// \param[in]	reference	Unwrapped reference timestamp.
+			/// \return Distance from the reference in timestamp units.
+			qint64 distance(quint32 timestamp, qint64 reference) noexcept {
+				return static_cast<qint32>(
+					timestamp - static_cast<quint32>(reference));
+			}
+		}
+
+		/// Default constructor.
+		/// \details The timeline starts with the first timestamp.
+		RTPTimestampUnwrapper::RTPTimestampUnwrapper() noexcept = default;
+
+		/// Destructor.
+		/// \details Default destructor.
+		RTPTimestampUnwrapper::~RTPTimestampUnwrapper() = default;
+
+		/// Drops the timeline.
+		/// \details Called when the source changes.
+		void RTPTimestampUnwrapper::reset() noexcept {
+			valid_ = false;
+			latest_ = origin_ = 0;
+
+			publish();
+		}
+
+		/// Unwraps a timestamp of a received packet.
+		/// \details Timestamps less than half the timestamp space from the
+		/// previous one are taken as the nearest ones, so reordered packets
+		/// and frames presented out of decoding order unwrap correctly. The
+		/// first timestamp starts the timeline. Readers see a new reference
+		/// only once the timeline moves an eighth of the timestamp space, a
+		/// few times a day at 90 kHz.
+		/// \param[in]	timestamp	RTP timestamp.
+		/// \return Timestamp on the timeline.
+		qint64 RTPTimestampUnwrapper::unwrap(quint32 timestamp) noexcept {
+			if (!valid_) {
+				valid_ = true;
+				latest_ = origin_ = timestamp;
+
+				publish();
+				return 0;
+			}
+
+			latest_ += distance(timestamp, latest_);
+
+			auto reference = sharedReference_.load(std::memory_order_relaxed);
+
+			if (latest_ - reference >= REFERENCE_DISTANCE ||
+				reference - latest_ >= REFERENCE_DISTANCE)
+				publish();
+
+			return latest_ - origin_;
+		}
+
+		/// Continues the timeline after a sender restart.
+		/// \details Timestamps of a restarted sender bear no relation to the
+		/// previous ones, so the first of them continues the timeline where
+		/// the last packet left it.
+		/// \param[in]	timestamp	First RTP timestamp of the restarted
+		///							sender.
+		/// \return Timestamp on the timeline.
+		qint64 RTPTimestampUnwrapper::restart(quint32 timestamp) noexcept {
+			if (!valid_) return unwrap(timestamp);
+
+			auto ticks = latest_ - origin_;
+
+			latest_ = timestamp;
+			origin_ = latest_ - ticks;
+
+			publish();
+			return ticks;
+		}
+
+		/// Indicates whether a timestamp was unwrapped.
+		/// \details Must be called from the receiving thread.
+		/// \retval true if a timestamp was unwrapped.
+		/// \retval false if no timestamp was unwrapped.
+		bool RTPTimestampUnwrapper::isValid() const noexcept {
+			return valid_;
+		}
+
+		/// Extends a timestamp to the timeline.
+		/// \details Safe to call from any thread. The timestamp is taken as
+		/// the nearest one to the published reference, which covers several
+		/// hours at 90 kHz in either direction of the received packets.
+		/// \param[in]	timestamp	RTP timestamp.
+		/// \param[out]	ticks		Timestamp on the timeline.
+		/// \retval true on success.
+		/// \retval false if no timestamp was unwrapped.
+		bool RTPTimestampUnwrapper::extend(quint32 timestamp,
+										   qint64& ticks) const noexcept {
+			bool valid;
+			qint64 reference, origin;
+
+			lock_.read([&]() {
+				valid = sharedValid_.load(std::memory_order_relaxed);
+				reference = sharedReference_.load(std::memory_order_relaxed);
+				origin = sharedOrigin_.load(std::memory_order_relaxed);
+			});
+
+			if (!valid) return false;
+
+			ticks = reference + distance(timestamp, reference) - origin;
+			return true;
+		}
+
+		/// Publishes the timeline to readers.
+		/// \details Writes the shared copies under the sequence lock.
+		void RTPTimestampUnwrapper::publish() noexcept {
+			lock_.write([this]() {
+				sharedValid_.store(valid_, std::memory_order_relaxed);
+				sharedReference_.store(latest_, std::memory_order_relaxed);
+				sharedOrigin_.store(origin_, std::memory_order_relaxed);
+			});
+		}
+	}
+}
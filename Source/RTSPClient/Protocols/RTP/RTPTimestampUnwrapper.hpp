@@ -0,0 +1,108 @@
+/// \file RTPTimestampUnwrapper.hpp
+/// \brief Contains classes and functions declarations that provide Real-time
+/// Transport Protocol (RTP) timestamp unwrapping.
+/// \bug No known bugs.
+
+#ifndef RTPTIMESTAMPUNWRAPPER_HPP
+#define RTPTIMESTAMPUNWRAPPER_HPP
+
+#include "Base/Export.hpp"
+#include "Utilities/SequenceLock.hpp"
+
+#include <QtGlobal>
+
+#include <atomic>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		/// Class that provides RTP timestamp unwrapping.
+		/// \details Extends 32-bit RTP timestamps of a source to a 64-bit
+		/// timeline that starts at the first timestamp and never wraps
+		/// around. The receiving thread unwraps timestamps of received
+		/// packets, any thread extends timestamps without locks.
+		class RTSPCLIENT_EXPORT RTPTimestampUnwrapper final {
+		public:
+
+			/// Default constructor.
+			explicit RTPTimestampUnwrapper() noexcept;
+
+			/// Destructor.
+			~RTPTimestampUnwrapper();
+
+			/// Copy constructor.
+			/// \param[in]	object	Object to copy.
+			RTPTimestampUnwrapper(const RTPTimestampUnwrapper& object) = delete;
+
+			/// Copy assignment operator.
+			/// \param[in]	object	Object to copy.
+			/// \return This object.
+			RTPTimestampUnwrapper& operator=(
+				const RTPTimestampUnwrapper& object) = delete;
+
+		public:
+
+			/// Drops the timeline.
+			void reset() noexcept;
+
+			/// Unwraps a timestamp of a received packet.
+			/// \param[in]	timestamp	RTP timestamp.
+			/// \return Timestamp on the timeline.
+			qint64 unwrap(quint32 timestamp) noexcept;
+
+			/// Continues the timeline after a sender restart.
+			/// \param[in]	timestamp	First RTP timestamp of the restarted
+			///							sender.
+			/// \return Timestamp on the timeline.
+			qint64 restart(quint32 timestamp) noexcept;
+
+			/// Indicates whether a timestamp was unwrapped.
+			/// \retval true if a timestamp was unwrapped.
+			/// \retval false if no timestamp was unwrapped.
+			bool isValid() const noexcept;
+
+			/// Extends a timestamp to the timeline.
+			/// \param[in]	timestamp	RTP timestamp.
+			/// \param[out]	ticks		Timestamp on the timeline.
+			/// \retval true on success.
+			/// \retval false if no timestamp was unwrapped.
+			bool extend(quint32 timestamp, qint64& ticks) const noexcept;
+
+		private:
+
+			/// Publishes the timeline to readers.
+			void publish() noexcept;
+
+		private:
+
+			/// Whether a timestamp was unwrapped.
+			bool valid_ { false };
+
+			/// Unwrapped timestamp of the last packet.
+			/// \details Its lower 32 bits are the RTP timestamp.
+			qint64 latest_ { 0 };
+
+			/// Unwrapped timestamp of the timeline start.
+			qint64 origin_ { 0 };
+
+			/// Lock of the published timeline.
+			SequenceLock lock_;
+
+			/// Published validity.
+			std::atomic<bool> sharedValid_ { false };
+
+			/// Published unwrapped timestamp, near the latest one.
+			std::atomic<qint64> sharedReference_ { 0 };
+
+			/// Published timeline start.
+			std::atomic<qint64> sharedOrigin_ { 0 };
+		};
+	}
+}
+
+#endif
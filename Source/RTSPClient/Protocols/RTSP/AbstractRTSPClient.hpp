@@ -72,6 +72,37 @@ namespace RTSPLib {
 			OptionNotSupported					=	551
 		};
 
+		/// Enumeration that defines RTSP methods.
+		enum class RTSPMethod {
+			Options,
+			Describe,
+			Announce,
+			Setup,
+			Play,
+			Pause,
+			Teardown,
+			GetParameter,
+			SetParameter,
+			Record
+		};
+
+		/// Number of RTSP methods.
+		constexpr int RTSP_METHOD_COUNT {
+			static_cast<int>(RTSPMethod::Record) + 1
+		};
+
+		/// Enumeration that defines RTP transport protocols.
+		enum class RTSPTransport {
+			UDP,
+			TCP
+		};
+
+		/// Enumeration that defines RTSP client backends.
+		enum class RTSPBackend {
+			Curl,
+			Native
+		};
+
 		///
 		class AbstractRTSPClient : public QObject {
 
@@ -4,6 +4,12 @@
 /// \bug No known bugs.
 
 #include "AbstractRTSPClientBase.hpp"
+#include "RTSPClientEngine.hpp"
+#include "RTSPLatencyMonitor.hpp"
+#include "RTSPSessionCache.hpp"
+
+#include <QHostAddress>
+#include <QUrl>
 
 /// Contains classes and functions that implement Real Time Streaming Protocol
 /// (RTSP) library.
@@ -43,6 +49,69 @@ namespace RTSPLib {
 
 		} globalContext_;
 
+		namespace {
+
+			/// Longest lookup answered by the libcurl DNS cache in
+			/// microseconds.
+			/// \details A cached address is found without leaving the
+			/// transfer, a lookup that waits for the resolver thread takes
+			/// longer.
+			constexpr curl_off_t CACHED_LOOKUP_TIME { 500 };
+
+			/// Returns RTSP method of a request.
+			/// \param[in]	request	Request type.
+			/// \param[out]	method	RTSP method.
+			/// \retval true on success.
+			/// \retval false for unknown requests.
+			bool requestMethod(qint64 request, RTSPMethod& method) {
+				switch (request) {
+				case CURL_RTSPREQ_OPTIONS:
+					method = RTSPMethod::Options;
+					return true;
+				case CURL_RTSPREQ_DESCRIBE:
+					method = RTSPMethod::Describe;
+					return true;
+				case CURL_RTSPREQ_ANNOUNCE:
+					method = RTSPMethod::Announce;
+					return true;
+				case CURL_RTSPREQ_SETUP:
+					method = RTSPMethod::Setup;
+					return true;
+				case CURL_RTSPREQ_PLAY:
+					method = RTSPMethod::Play;
+					return true;
+				case CURL_RTSPREQ_PAUSE:
+					method = RTSPMethod::Pause;
+					return true;
+				case CURL_RTSPREQ_TEARDOWN:
+					method = RTSPMethod::Teardown;
+					return true;
+				case CURL_RTSPREQ_GET_PARAMETER:
+					method = RTSPMethod::GetParameter;
+					return true;
+				case CURL_RTSPREQ_SET_PARAMETER:
+					method = RTSPMethod::SetParameter;
+					return true;
+				case CURL_RTSPREQ_RECORD:
+					method = RTSPMethod::Record;
+					return true;
+				default:
+					return false;
+				}
+			}
+
+			/// Returns bitmask of the RTSP method of a request.
+			/// \param[in]	request	Request type.
+			/// \return Method bitmask or 0 for unknown requests.
+			quint32 requestMask(qint64 request) {
+				RTSPMethod method;
+
+				return requestMethod(request, method)
+					   ? RTSPResponseParser::getMethodMask(method)
+					   : 0;
+			}
+		}
+
 		/// Default constructor.
 		/// \details Initializes object fields.
 		RTSPClientBase::RTSPClientBase() : private_ { } {
@@ -61,20 +130,105 @@ namespace RTSPLib {
 		/// \retval true on success.
 		/// \retval false on error.
 		bool RTSPClientBase::open(const QByteArray& url) {
+			if (private_.native_)
+				return isOpen() || private_.native_->open(url);
+
 			return isOpen() || contextOpen(url);
 		}
 
 		///
 		/// \details
 		void RTSPClientBase::close() {
+			if (private_.native_) private_.native_->close();
+
 			contextClose();
 		}
 
+		/// Drops the connection and the session, keeping settings.
+		/// \details Requests in progress fail. Settings, negotiated
+		/// authentication and, unless told otherwise, SDP data and supported
+		/// methods survive, so a lost session is restored with SETUP and PLAY
+		/// only. The next request opens a new connection.
+		/// \param[in]	keepDescription	Whether SDP data and supported
+		///								methods are kept.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool RTSPClientBase::reconnect(bool keepDescription) {
+			if (!isOpen()) return false;
+
+			if (private_.native_) private_.native_->reconnect();
+			else cancel();
+
+			private_.currentSession_ = { };
+			private_.sessionTimeout_ = -1;
+			private_.transportSSRC_ = -1;
+			private_.transportPorts_ = { 0, 0 };
+
+			if (!keepDescription) {
+				private_.sdpData_ = { };
+				private_.supportedMethods_ = 0;
+			}
+
+			private_.demuxer_.reset();
+			private_.parser_.reset();
+
+			if (private_.native_) return true;
+
+			private_.freshConnection_ = true;
+
+			return contextSetSession()				&&
+				   contextResetSequence()			&&
+				   contextResetConnection(false)	&&
+				   contextRenewConnection(true);
+		}
+
+		/// Cancels a non-blocking request in progress.
+		/// \details The completion callback is not called. The native
+		/// backend pipelines requests, so blocking requests never wait for
+		/// it and nothing is cancelled.
+		/// \retval true if the request was cancelled.
+		/// \retval false if no request was cancelled.
+		bool RTSPClientBase::cancel() {
+			if (private_.native_ || !isPending()) return false;
+
+			private_.engine_->cancel(private_.localContext_);
+			contextComplete(private_.currentRequest_, false);
+
+			return true;
+		}
+
+		/// Moves the connection to another thread.
+		/// \details Must be called from the owning thread while no request
+		/// is in progress. A libcurl connection is not bound to a thread, the
+		/// native backend moves its socket.
+		/// \param[in]	thread	Target thread.
+		/// \retval true on success.
+		/// \retval false if a request is in progress.
+		bool RTSPClientBase::detach(QThread* thread) {
+			if (!thread || isPending()) return false;
+
+			if (private_.native_) return private_.native_->detach(thread);
+
+			return true;
+		}
+
+		/// Resumes the connection on the thread it was moved to.
+		/// \details Must be called from the target thread. Further requests
+		/// run through the engine of the thread.
+		/// \param[in]	engine	Non-blocking client engine of the thread.
+		void RTSPClientBase::attach(RTSPClientEngine* engine) {
+			setEngine(engine);
+
+			if (private_.native_) private_.native_->attach();
+		}
+
 		///
 		/// \details
 		/// \retval
 		/// \retval
 		bool RTSPClientBase::isOpen() const {
+			if (private_.native_) return private_.native_->isOpen();
+
 			return contextIsOpen();
 		}
 
@@ -99,6 +253,88 @@ namespace RTSPLib {
 			return private_.currentSession_;
 		}
 
+		/// Indicates whether the server supports an RTSP method.
+		/// \details Checks methods listed in the last OPTIONS response.
+		/// \param[in]	method	RTSP method.
+		/// \retval true if the method is advertised by the server.
+		/// \retval false otherwise.
+		bool RTSPClientBase::isSupported(RTSPMethod method) const {
+			return private_.supportedMethods_ &
+				   RTSPResponseParser::getMethodMask(method);
+		}
+
+		/// Returns number of authentication challenges received.
+		/// \details Counts 401 responses of the session, including the ones
+		/// answered within the same request.
+		/// \return Number of 401 responses.
+		quint64 RTSPClientBase::getAuthChallengeCount() const {
+			return private_.authChallenges_;
+		}
+
+		/// Returns number of round-trips saved by cached authentication.
+		/// \details Counts requests that went out with credentials of the
+		/// cached scheme and were not challenged.
+		/// \return Number of requests authenticated without a challenge.
+		quint64 RTSPClientBase::getSavedRoundTrips() const {
+			return private_.savedRoundTrips_;
+		}
+
+		/// Returns timing of the last request of an RTSP method.
+		/// \details Both backends measure the same phases, see
+		/// RTSPRequestTiming.
+		/// \param[in]	method	RTSP method.
+		/// \return Request timing.
+		RTSPRequestTiming RTSPClientBase::getRequestTiming(
+			RTSPMethod method) const {
+
+			return private_.requestTimings_[static_cast<int>(method)];
+		}
+
+		/// Returns session timeout.
+		/// \details Returns timeout announced by the Session header.
+		/// \return Session timeout in seconds or -1 if it is unknown.
+		qint64 RTSPClientBase::getSessionTimeout() const {
+			return private_.sessionTimeout_;
+		}
+
+		/// Returns synchronization source announced by SETUP response.
+		/// \details Returns ssrc parameter of Transport header of the last
+		/// SETUP response. Servers may omit it.
+		/// \return Synchronization source ID (SSRC) or -1 if it is
+		/// unknown.
+		qint64 RTSPClientBase::getSSRC() const {
+			return private_.transportSSRC_;
+		}
+
+		/// Returns server ports announced by SETUP response.
+		/// \details Returns server_port parameter of Transport header of the
+		/// last SETUP response. Servers send RTCP data from and expect it on
+		/// the second port.
+		/// \return Server RTP and RTCP ports or zeros if they are unknown.
+		QPair<quint16, quint16> RTSPClientBase::getServerPorts() const {
+			return private_.transportPorts_;
+		}
+
+		/// Returns address of the RTSP server.
+		/// \details Returns peer address of the connection, so a host name of
+		/// the URL is not resolved again.
+		/// \return Server address or null address if there is no
+		/// connection.
+		QHostAddress RTSPClientBase::getServerAddress() const {
+			if (private_.native_) return private_.native_->getServerAddress();
+
+			char* address = nullptr;
+
+			if (!contextIsOpen()									||
+				curl_easy_getinfo(private_.localContext_,
+								  CURLINFO_PRIMARY_IP,
+								  &address) != CURLE_OK				||
+				!address)
+				return { };
+
+			return QHostAddress(QString::fromLatin1(address));
+		}
+
 		///
 		/// \details
 		/// \return
@@ -113,6 +349,7 @@ namespace RTSPLib {
 		/// \retval false on error.
 		void RTSPClientBase::setUserAgent(const QByteArray& userAgent) {
 			private_.userAgent_ = userAgent;
+			private_.optionsChanged_ = true;
 		}
 
 		///
@@ -128,6 +365,7 @@ namespace RTSPLib {
 		void RTSPClientBase::setTimeouts(
 			const QPair<qint64, qint64>& timeouts) {
 			private_.operationTimeouts_ = timeouts;
+			private_.optionsChanged_ = true;
 		}
 
 		///
@@ -143,85 +381,173 @@ namespace RTSPLib {
 		void RTSPClientBase::setCredentials(
 			const QPair<QByteArray, QByteArray>& credentials) {
 			private_.userCredentials_ = credentials;
+			private_.authScheme_ = CURLAUTH_ANY;
+			private_.optionsChanged_ = true;
 		}
 
-		/// Sends OPTIONS request.
-		/// \details Sends OPTIONS request through the local context.
-		/// \return RTSP status code.
-		RTSPStatusCode RTSPClientBase::OPTIONS() {
-			auto request { CURL_RTSPREQ_OPTIONS };
+		/// Returns RTP transport protocol.
+		/// \details Returns transport protocol requested by SETUP.
+		/// \return RTP transport protocol.
+		RTSPTransport RTSPClientBase::getTransport() const {
+			return private_.transport_;
+		}
 
-			if (!contextIsOpen() ||
-				!contextIsSupported(request))
-				return RTSPStatusCode::Error;
+		/// Sets RTP transport protocol used by SETUP requests.
+		/// \details With TCP transport, SETUP requests interleaved channels
+		/// and RTP data is read from the RTSP connection.
+		/// \param[in]	transport	RTP transport protocol.
+		void RTSPClientBase::setTransport(RTSPTransport transport) {
+			private_.transport_ = transport;
+			private_.optionsChanged_ = true;
+		}
 
-			if (!contextSetUrl()			||
-				!contextSetHeader()			||
-				!contextSetSession()		||
-				!contextSetTimeouts()		||
-				!contextSetCredentials()	||
-				!contextSetMiscellaneous()	||
-				!contextSetCallback(CURLOPT_HEADERFUNCTION,
-								   private_.supportedRequests_.isEmpty()
-								   ? callbackHeaderOPTIONS
-								   : callbackHeaderAll,
-								   &private_)) {
-				contextReset();
-				return RTSPStatusCode::Error;
+		/// Indicates whether fast start is enabled.
+		/// \details Returns fast start flag.
+		/// \retval true if fast start is enabled.
+		/// \retval false if fast start is disabled.
+		bool RTSPClientBase::isFastStart() const {
+			return private_.fastStart_;
+		}
+
+		/// Enables or disables fast start.
+		/// \details With fast start, requests are not checked against the
+		/// methods supported by the server until an OPTIONS response is
+		/// received, so session bring-up can skip the OPTIONS round-trip.
+		/// \param[in]	fastStart	Whether requests may be sent before
+		///							OPTIONS response is received.
+		void RTSPClientBase::setFastStart(bool fastStart) {
+			private_.fastStart_ = fastStart;
+		}
+
+		/// Returns interleaved data demultiplexer.
+		/// \details Channel ring buffers are configured and read through it.
+		/// \return Interleaved data demultiplexer.
+		RTSPInterleavedDemuxer& RTSPClientBase::getDemuxer() {
+			return private_.demuxer_;
+		}
+
+		/// Returns RTSP connection socket.
+		/// \details Returns the socket of the last used connection, so that
+		/// the caller can wait for interleaved data.
+		/// \return Socket descriptor or -1 if there is no connection.
+		qintptr RTSPClientBase::getSocket() const {
+			if (private_.native_) return private_.native_->getSocket();
+
+			curl_socket_t socket = CURL_SOCKET_BAD;
+
+			if (!contextIsOpen()									||
+				curl_easy_getinfo(private_.localContext_,
+								  CURLINFO_ACTIVESOCKET,
+								  &socket) != CURLE_OK				||
+				socket == CURL_SOCKET_BAD)
+				return -1;
+
+			return static_cast<qintptr>(socket);
+		}
+
+		/// Returns non-blocking client engine.
+		/// \details Returns the engine used by asynchronous requests.
+		/// \return Non-blocking client engine.
+		RTSPClientEngine* RTSPClientBase::getEngine() const {
+			return private_.engine_;
+		}
+
+		/// Sets non-blocking client engine.
+		/// \details Cancels a pending request of the previous engine.
+		/// \param[in]	engine	Non-blocking client engine.
+		void RTSPClientBase::setEngine(RTSPClientEngine* engine) {
+			if (private_.engine_ == engine) return;
+
+			if (isPending()) {
+				private_.engine_->cancel(private_.localContext_);
+				contextComplete(private_.currentRequest_, false);
 			}
 
-			auto status = contextPerform(request)
-						  ? private_.statusCode_
-						  : RTSPStatusCode::Error;
+			private_.engine_ = engine;
+		}
 
-			private_.statusCode_ = RTSPStatusCode::Error;
+		/// Returns protocol backend.
+		/// \details Returns the backend that sends requests.
+		/// \return Protocol backend.
+		RTSPBackend RTSPClientBase::getBackend() const {
+			return private_.native_ ? RTSPBackend::Native : RTSPBackend::Curl;
+		}
 
-			contextReset();
+		/// Sets protocol backend.
+		/// \details Closes the client, settings must be applied again after
+		/// the client is opened.
+		/// \param[in]	backend	Protocol backend.
+		void RTSPClientBase::setBackend(RTSPBackend backend) {
+			if (getBackend() == backend) return;
 
-			return status;
+			close();
+
+			if (backend == RTSPBackend::Native)
+				private_.native_.reset(new RTSPNativeClient(*this));
+			else
+				private_.native_.reset();
 		}
 
-		/// Sends DESCRIBE request.
-		/// \details Sends DESCRIBE request through the local context.
+		/// Sets handler of interleaved data delivered by the native backend.
+		/// \details The native backend reads interleaved data from the event
+		/// loop, the handler lets the caller consume channel buffers. Ignored
+		/// by the libcurl backend.
+		/// \param[in]	handler	Handler called after interleaved data is
+		///						stored in channel buffers.
+		void RTSPClientBase::setReceiveHandler(
+			const std::function<void()>& handler) {
+
+			if (private_.native_) private_.native_->setReceiveHandler(handler);
+		}
+
+		/// Returns number of requests sent before the previous response.
+		/// \details libcurl waits for every response, so only the native
+		/// backend pipelines requests.
+		/// \return Number of pipelined requests.
+		quint64 RTSPClientBase::getPipelinedCount() const {
+			return private_.native_ ? private_.native_->getPipelinedCount() : 0;
+		}
+
+		/// Indicates whether a non-blocking request is in progress.
+		/// \details Asks the engine about the local context.
+		/// \retval true if a request is in progress.
+		/// \retval false if no request is in progress.
+		bool RTSPClientBase::isPending() const {
+			if (private_.native_) return private_.native_->isPending();
+
+			return private_.engine_ &&
+				   private_.localContext_ &&
+				   private_.engine_->isPending(private_.localContext_);
+		}
+
+		/// Sends OPTIONS request.
+		/// \details Sends OPTIONS request through the local context.
 		/// \return RTSP status code.
-		RTSPStatusCode RTSPClientBase::DESCRIBE() {
-			auto request { CURL_RTSPREQ_DESCRIBE };
+		RTSPStatusCode RTSPClientBase::OPTIONS() {
+			if (private_.native_)
+				return private_.native_->perform(RTSPMethod::Options);
 
-			if (!contextIsOpen() ||
-				!contextIsSupported(request))
-				return RTSPStatusCode::Error;
+			auto request { CURL_RTSPREQ_OPTIONS };
 
-			if (!contextSetUrl()			||
-				!contextSetHeader()			||
-				!contextSetSession()		||
-				!contextSetTimeouts()		||
-				!contextSetCredentials()	||
-				!contextSetMiscellaneous()	||
-				!contextSetCallback(CURLOPT_HEADERFUNCTION,
-									callbackHeaderAll,
-									&private_)) {
-				contextReset();
+			if (isPending() || !prepareOPTIONS())
 				return RTSPStatusCode::Error;
-			}
 
-			if (private_.sdpData_.isEmpty()) {
-				if (!contextSetCallback(CURLOPT_WRITEFUNCTION,
-										callbackBodyDESCRIBE,
-										&private_)) {
-					contextReset();
-					return RTSPStatusCode::Error;
-				}
-			}
+			return contextComplete(request, contextPerform(request));
+		}
 
-			auto status = contextPerform(request)
-						  ? private_.statusCode_
-						  : RTSPStatusCode::Error;
+		/// Sends DESCRIBE request.
+		/// \details Sends DESCRIBE request through the local context.
+		/// \return RTSP status code.
+		RTSPStatusCode RTSPClientBase::DESCRIBE() {
+			if (private_.native_)
+				return private_.native_->perform(RTSPMethod::Describe);
 
-			private_.statusCode_ = RTSPStatusCode::Error;
+			auto request { CURL_RTSPREQ_DESCRIBE };
 
-			contextReset();
+			if (isPending() || !prepareDESCRIBE())
+				return RTSPStatusCode::Error;
 
-			return status;
+			return contextComplete(request, contextPerform(request));
 		}
 
 		/// Sends SETUP request.
@@ -233,223 +559,341 @@ namespace RTSPLib {
 			const QByteArray& path,
 			const QPair<quint16, quint16>& channels) {
 
-			auto request { CURL_RTSPREQ_SETUP };
-
-			if (!contextIsOpen() ||
-				!contextIsSupported(request))
-				return RTSPStatusCode::Error;
-
-			auto track = private_.connectionUrl_ + '/' + trimUrl(path);
-
-			auto prefix = QByteArray("RTP/AVP/UDP;unicast;client_port=");
+			if (private_.native_)
+				return private_.native_->perform(RTSPMethod::Setup,
+												 path,
+												 channels);
 
-			auto transport =
-				prefix +
-				QByteArray::number(channels.first) +
-				QByteArray("-") +
-				QByteArray::number(channels.second);
+			auto request { CURL_RTSPREQ_SETUP };
 
-			if (!contextSetUrl(track, transport)	||
-				!contextSetHeader()					||
-				!contextSetSession()				||
-				!contextSetTimeouts()				||
-				!contextSetCredentials()			||
-				!contextSetMiscellaneous()			||
-				!contextSetCallback(CURLOPT_HEADERFUNCTION,
-									callbackHeaderAll,
-									&private_)) {
-				contextReset();
+			if (isPending() || !prepareSETUP(path, channels))
 				return RTSPStatusCode::Error;
-			}
-
-			auto status = contextPerform(request)
-						  ? private_.statusCode_
-						  : RTSPStatusCode::Error;
 
-			private_.statusCode_ = RTSPStatusCode::Error;
-
-			contextReset();
-
-			return status;
+			return contextComplete(request, contextPerform(request));
 		}
 
 		/// Sends PLAY request.
 		/// \details Sends PLAY request through the local context.
 		/// \return RTSP status code.
 		RTSPStatusCode RTSPClientBase::PLAY() {
-			auto request { CURL_RTSPREQ_PLAY };
+			if (private_.native_)
+				return private_.native_->perform(RTSPMethod::Play);
 
-			if (!contextIsOpen()					||
-				!contextIsSupported(request)		||
-				private_.currentSession_.isEmpty())
-				return RTSPStatusCode::Error;
+			auto request { CURL_RTSPREQ_PLAY };
 
-			if (!contextSetUrl()			||
-				!contextSetHeader()			||
-				!contextSetSession()		||
-				!contextSetTimeouts()		||
-				!contextSetCredentials()	||
-				!contextSetMiscellaneous()	||
-				!contextSetCallback(CURLOPT_HEADERFUNCTION,
-									callbackHeaderAll,
-									&private_)) {
-				contextReset();
+			if (isPending() || !prepareSession(request))
 				return RTSPStatusCode::Error;
-			}
-
-			auto status = contextPerform(request)
-						  ? private_.statusCode_
-						  : RTSPStatusCode::Error;
-
-			private_.statusCode_ = RTSPStatusCode::Error;
 
-			contextReset();
-
-			return status;
+			return contextComplete(request, contextPerform(request));
 		}
 
 		/// Sends PAUSE request.
 		/// \details Sends PAUSE request through the local context.
 		/// \return RTSP status code.
 		RTSPStatusCode RTSPClientBase::PAUSE() {
-			auto request { CURL_RTSPREQ_PAUSE };
+			if (private_.native_)
+				return private_.native_->perform(RTSPMethod::Pause);
 
-			if (!contextIsOpen()					||
-				!contextIsSupported(request)		||
-				private_.currentSession_.isEmpty())
-				return RTSPStatusCode::Error;
+			auto request { CURL_RTSPREQ_PAUSE };
 
-			if (!contextSetUrl()			||
-				!contextSetHeader()			||
-				!contextSetSession()		||
-				!contextSetTimeouts()		||
-				!contextSetCredentials()	||
-				!contextSetMiscellaneous()	||
-				!contextSetCallback(CURLOPT_HEADERFUNCTION,
-									callbackHeaderAll,
-									&private_)) {
-				contextReset();
+			if (isPending() || !prepareSession(request))
 				return RTSPStatusCode::Error;
-			}
-
-			auto status = contextPerform(request)
-						  ? private_.statusCode_
-						  : RTSPStatusCode::Error;
-
-			private_.statusCode_ = RTSPStatusCode::Error;
-
-			contextReset();
 
-			return status;
+			return contextComplete(request, contextPerform(request));
 		}
 
 		/// Sends GET_PARAMETER request.
 		/// \details Sends GET_PARAMETER request through the local context.
 		/// \return RTSP status code.
 		RTSPStatusCode RTSPClientBase::GET_PARAMETER() {
+			if (private_.native_)
+				return private_.native_->perform(RTSPMethod::GetParameter);
+
 			auto request { CURL_RTSPREQ_GET_PARAMETER };
 
-			if (!contextIsOpen()					||
-				!contextIsSupported(request)		||
-				private_.currentSession_.isEmpty())
+			if (isPending() || !prepareSession(request))
 				return RTSPStatusCode::Error;
 
-			if (!contextSetUrl()			||
-				!contextSetHeader()			||
-				!contextSetSession()		||
-				!contextSetTimeouts()		||
-				!contextSetCredentials()	||
-				!contextSetMiscellaneous()	||
-				!contextSetCallback(CURLOPT_HEADERFUNCTION,
-									callbackHeaderAll,
-									&private_)) {
-				contextReset();
-				return RTSPStatusCode::Error;
-			}
-
-			auto status = contextPerform(request)
-						  ? private_.statusCode_
-						  : RTSPStatusCode::Error;
-
-			private_.statusCode_ = RTSPStatusCode::Error;
-
-			contextReset();
-
-			return status;
+			return contextComplete(request, contextPerform(request));
 		}
 
 		/// Sends TEARDOWN request.
 		/// \details Sends TEARDOWN request through the local context.
 		/// \return RTSP status code.
 		RTSPStatusCode RTSPClientBase::TEARDOWN() {
+			if (private_.native_)
+				return private_.native_->perform(RTSPMethod::Teardown);
+
 			auto request { CURL_RTSPREQ_TEARDOWN };
 
-			if (!contextIsOpen()					||
-				!contextIsSupported(request)		||
-				private_.currentSession_.isEmpty())
+			if (isPending() || !prepareTEARDOWN())
 				return RTSPStatusCode::Error;
 
-			if (!contextSetUrl()			||
-				!contextSetHeader()			||
-				!contextSetSession()		||
-				!contextSetTimeouts()		||
-				!contextSetCredentials()	||
-				!contextSetMiscellaneous()	||
-				!contextResetConnection()	||
-				!contextSetCallback(CURLOPT_HEADERFUNCTION,
-									callbackHeaderAll,
-									&private_)) {
-				contextReset();
-				return RTSPStatusCode::Error;
-			}
+			return contextComplete(request, contextPerform(request));
+		}
 
-			auto status = contextPerform(request)
-						  ? private_.statusCode_
-						  : RTSPStatusCode::Error;
+		/// Sends OPTIONS request through the non-blocking engine.
+		/// \details Returns immediately, the completion callback receives
+		/// RTSP status code.
+		/// \param[in]	completion	Completion callback.
+		/// \retval true if the request was started.
+		/// \retval false on error.
+		bool RTSPClientBase::OPTIONS(const completion_t& completion) {
+			if (private_.native_)
+				return private_.native_->submit(RTSPMethod::Options,
+												completion);
 
-			private_.statusCode_		= RTSPStatusCode::Error;
-			private_.currentSession_	= { };
+			auto request { CURL_RTSPREQ_OPTIONS };
 
-			contextResetSequence();
-			contextReset();
+			return !isPending()		&&
+				   prepareOPTIONS()	&&
+				   contextSubmit(request, completion);
+		}
 
-			return status;
+		/// Sends DESCRIBE request through the non-blocking engine.
+		/// \details Returns immediately, the completion callback receives
+		/// RTSP status code.
+		/// \param[in]	completion	Completion callback.
+		/// \retval true if the request was started.
+		/// \retval false on error.
+		bool RTSPClientBase::DESCRIBE(const completion_t& completion) {
+			if (private_.native_)
+				return private_.native_->submit(RTSPMethod::Describe,
+												completion);
+
+			auto request { CURL_RTSPREQ_DESCRIBE };
+
+			return !isPending()			&&
+				   prepareDESCRIBE()	&&
+				   contextSubmit(request, completion);
 		}
 
-		RTSPStatusCode RTSPClientBase::RECEIVE() {
-			auto request { CURL_RTSPREQ_RECEIVE };
+		/// Sends SETUP request through the non-blocking engine.
+		/// \details Returns immediately, the completion callback receives
+		/// RTSP status code.
+		/// \param[in]	path		Media track path.
+		/// \param[in]	channels	Channels for RTP and RTCP data.
+		/// \param[in]	completion	Completion callback.
+		/// \retval true if the request was started.
+		/// \retval false on error.
+		bool RTSPClientBase::SETUP(const QByteArray& path,
+								   const QPair<quint16, quint16>& channels,
+								   const completion_t& completion) {
 
-			if (!contextIsOpen()					||
-				private_.currentSession_.isEmpty())
-				return RTSPStatusCode::Error;
+			if (private_.native_)
+				return private_.native_->submit(RTSPMethod::Setup,
+												completion,
+												path,
+												channels);
 
-			if (!contextSetUrl()			||
-				!contextSetHeader()			||
-				!contextSetSession()		||
-				!contextSetTimeouts()		||
-				!contextSetCredentials()	||
-				!contextSetMiscellaneous()	/*||
-				!contextSetCallback(CURLOPT_INTERLEAVEFUNCTION,
-									callbackDataInterleaved,
-									&private_)*/) {
-				contextReset();
-				return RTSPStatusCode::Error;
-			}
+			auto request { CURL_RTSPREQ_SETUP };
 
-			while (true) {
+			return !isPending()						&&
+				   prepareSETUP(path, channels)		&&
+				   contextSubmit(request, completion);
+		}
 
-				contextPerform(request);
-			}
+		/// Sends PLAY request through the non-blocking engine.
+		/// \details Returns immediately, the completion callback receives
+		/// RTSP status code.
+		/// \param[in]	completion	Completion callback.
+		/// \retval true if the request was started.
+		/// \retval false on error.
+		bool RTSPClientBase::PLAY(const completion_t& completion) {
+			if (private_.native_)
+				return private_.native_->submit(RTSPMethod::Play,
+												completion);
+
+			auto request { CURL_RTSPREQ_PLAY };
+
+			return !isPending()				&&
+				   prepareSession(request)	&&
+				   contextSubmit(request, completion);
+		}
+
+		/// Sends PAUSE request through the non-blocking engine.
+		/// \details Returns immediately, the completion callback receives
+		/// RTSP status code.
+		/// \param[in]	completion	Completion callback.
+		/// \retval true if the request was started.
+		/// \retval false on error.
+		bool RTSPClientBase::PAUSE(const completion_t& completion) {
+			if (private_.native_)
+				return private_.native_->submit(RTSPMethod::Pause,
+												completion);
+
+			auto request { CURL_RTSPREQ_PAUSE };
+
+			return !isPending()				&&
+				   prepareSession(request)	&&
+				   contextSubmit(request, completion);
+		}
+
+		/// Sends GET_PARAMETER request through the non-blocking engine.
+		/// \details Returns immediately, the completion callback receives
+		/// RTSP status code.
+		/// \param[in]	completion	Completion callback.
+		/// \retval true if the request was started.
+		/// \retval false on error.
+		bool RTSPClientBase::GET_PARAMETER(const completion_t& completion) {
+			if (private_.native_)
+				return private_.native_->submit(RTSPMethod::GetParameter,
+												completion);
+
+			auto request { CURL_RTSPREQ_GET_PARAMETER };
+
+			return !isPending()				&&
+				   prepareSession(request)	&&
+				   contextSubmit(request, completion);
+		}
+
+		/// Sends TEARDOWN request through the non-blocking engine.
+		/// \details Returns immediately, the completion callback receives
+		/// RTSP status code.
+		/// \param[in]	completion	Completion callback.
+		/// \retval true if the request was started.
+		/// \retval false on error.
+		bool RTSPClientBase::TEARDOWN(const completion_t& completion) {
+			if (private_.native_)
+				return private_.native_->submit(RTSPMethod::Teardown,
+												completion);
+
+			auto request { CURL_RTSPREQ_TEARDOWN };
+
+			return !isPending()			&&
+				   prepareTEARDOWN()	&&
+				   contextSubmit(request, completion);
+		}
+
+		/// Prepares OPTIONS request.
+		/// \details Applies per-request options for OPTIONS request.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool RTSPClientBase::prepareOPTIONS() {
+			auto request { CURL_RTSPREQ_OPTIONS };
+
+			return contextIsOpen()				&&
+				   contextIsSupported(request)	&&
+				   contextApplyOptions()		&&
+				   contextSetSession()			&&
+				   contextSetUrl();
+		}
+
+		/// Prepares DESCRIBE request.
+		/// \details Applies per-request options for DESCRIBE request. The
+		/// response body is stored as SDP data only once.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool RTSPClientBase::prepareDESCRIBE() {
+			auto request { CURL_RTSPREQ_DESCRIBE };
+
+			if (!contextIsOpen()				||
+				!contextIsSupported(request)	||
+				!contextApplyOptions()			||
+				!contextSetSession()			||
+				!contextSetUrl())
+				return false;
+
+			private_.receiveBody_ = private_.sdpData_.isEmpty();
+
+			return true;
+		}
+
+		/// Prepares SETUP request.
+		/// \details Applies per-request options for SETUP request.
+		/// \param[in]	path		Media track path.
+		/// \param[in]	channels	Channels for RTP and RTCP data.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool RTSPClientBase::prepareSETUP(
+			const QByteArray& path,
+			const QPair<quint16, quint16>& channels) {
+
+			auto request { CURL_RTSPREQ_SETUP };
+
+			if (!contextIsOpen() ||
+				!contextIsSupported(request))
+				return false;
+
+			auto track = private_.connectionUrl_ + '/' + trimUrl(path);
+
+			auto prefix = private_.transport_ == RTSPTransport::TCP
+						  ? QByteArray("RTP/AVP/TCP;unicast;interleaved=")
+						  : QByteArray("RTP/AVP/UDP;unicast;client_port=");
+
+			auto transport =
+				prefix +
+				QByteArray::number(channels.first) +
+				QByteArray("-") +
+				QByteArray::number(channels.second);
+
+			return contextApplyOptions()			&&
+				   contextSetSession()				&&
+				   contextSetUrl(track, transport);
+		}
+
+		/// Prepares PLAY, PAUSE or GET_PARAMETER request.
+		/// \details Applies per-request options for a request that requires
+		/// an established session.
+		/// \param[in]	request	Request type.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool RTSPClientBase::prepareSession(qint64 request) {
+			return contextIsOpen()						&&
+				   contextIsSupported(request)			&&
+				   !private_.currentSession_.isEmpty()	&&
+				   contextApplyOptions()				&&
+				   contextSetSession()					&&
+				   contextSetUrl();
+		}
+
+		/// Prepares TEARDOWN request.
+		/// \details Applies per-request options for TEARDOWN request and
+		/// forbids reuse of the connection.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool RTSPClientBase::prepareTEARDOWN() {
+			auto request { CURL_RTSPREQ_TEARDOWN };
+
+			return contextIsOpen()						&&
+				   contextIsSupported(request)			&&
+				   !private_.currentSession_.isEmpty()	&&
+				   contextApplyOptions()				&&
+				   contextSetSession()					&&
+				   contextSetUrl()						&&
+				   contextResetConnection(true);
+		}
+
+		/// Receives interleaved data.
+		/// \details Reads one chunk of data available on the RTSP connection
+		/// and dispatches interleaved frames to the channel ring buffers of the
+		/// demultiplexer. Returns as soon as the chunk is processed, so the
+		/// caller can send keep-alive or TEARDOWN requests between calls.
+		/// \return RTSP status code.
+		RTSPStatusCode RTSPClientBase::RECEIVE() {
+			if (private_.native_) return private_.native_->receive();
+
+			auto request { CURL_RTSPREQ_RECEIVE };
+
+			if (isPending()										||
+				!contextIsOpen()								||
+				private_.transport_ != RTSPTransport::TCP		||
+				private_.currentSession_.isEmpty()				||
+				!contextApplyOptions()							||
+				!contextSetSession()							||
+				!contextSetUrl())
+				return RTSPStatusCode::Error;
 
-			private_.statusCode_ = RTSPStatusCode::Error;
+			auto performed = contextPerform(request);
 
-			//contextReset();
+			private_.currentRequest_ = CURL_RTSPREQ_NONE;
 
-			return RTSPStatusCode::Error;
+			return performed ? RTSPStatusCode::Ok : RTSPStatusCode::Error;
 		}
 
 		///
-		/// \details
+		/// \details Creates the local context and applies options that stay
+		/// the same for every request of the session.
 		/// \param[in]	url
 		/// \retval true on success.
 		/// \retval false on error.
@@ -461,6 +905,12 @@ namespace RTSPLib {
 			if (!private_.localContext_) return false;
 
 			private_.connectionUrl_ = trimUrl(url);
+			private_.optionsChanged_ = true;
+
+			if (!contextApplyOptions()) {
+				contextClose();
+				return false;
+			}
 
 			return true;
 		}
@@ -473,9 +923,30 @@ namespace RTSPLib {
 			private_.userAgent_			= { };
 			private_.currentSession_	= { };
 			private_.sdpData_			= { };
-			private_.supportedRequests_	= { };
+			private_.supportedMethods_	= 0;
+			private_.sessionTimeout_	= -1;
+			private_.transportSSRC_		= -1;
+			private_.transportPorts_	= { 0, 0 };
 			private_.operationTimeouts_ = { 0, 0 };
 			private_.userCredentials_	= { };
+			private_.transport_			= RTSPTransport::UDP;
+			private_.fastStart_			= false;
+			private_.currentRequest_	= CURL_RTSPREQ_NONE;
+			private_.appliedStreamUri_	= { };
+			private_.appliedSession_	= { };
+			private_.optionsChanged_	= true;
+			private_.receiveBody_		= false;
+			private_.authScheme_		= CURLAUTH_ANY;
+			private_.challenged_		= false;
+			private_.authChallenges_	= 0;
+			private_.savedRoundTrips_	= 0;
+			private_.freshConnection_	= false;
+
+			private_.demuxer_.reset();
+			private_.parser_.reset();
+
+			if (isPending())
+				private_.engine_->cancel(private_.localContext_);
 
 			if (private_.localContext_) {
 				curl_easy_cleanup(private_.localContext_);
@@ -493,13 +964,15 @@ namespace RTSPLib {
 		}
 
 		///
-		/// \details
+		/// \details Every request is assumed to be supported in fast start
+		/// mode until OPTIONS response lists supported methods.
 		/// \param[in]	request
 		/// \retval
 		/// \retval
 		bool RTSPClientBase::contextIsSupported(qint64 request) const {
-			return request == CURL_RTSPREQ_OPTIONS ||
-				   private_.supportedRequests_.contains(request);
+			return request == CURL_RTSPREQ_OPTIONS						||
+				   (private_.supportedMethods_ & requestMask(request))	||
+				   (private_.fastStart_ && !private_.supportedMethods_);
 		}
 
 		///
@@ -537,8 +1010,9 @@ namespace RTSPLib {
 									data) == CURLE_OK;
 		}
 
-		///
-		/// \details
+		/// Sets stream URI and transport of the request.
+		/// \details Stream URI is updated only when it differs from the one
+		/// used by the previous request.
 		/// \param[in]	stream
 		/// \param[in]	transport
 		/// \retval true on success.
@@ -546,22 +1020,23 @@ namespace RTSPLib {
 		bool RTSPClientBase::contextSetUrl(const QByteArray& track,
 										   const QByteArray& transport) {
 
-			return curl_easy_setopt(private_.localContext_,
-									CURLOPT_URL,
-									private_.connectionUrl_
-										.constData()) == CURLE_OK &&
+			const auto& uri = track.isEmpty()
+							  ? private_.connectionUrl_
+							  : track;
 
-				   curl_easy_setopt(private_.localContext_,
-									CURLOPT_RTSP_STREAM_URI,
-									track.isEmpty()
-									? private_.connectionUrl_.constData()
-									: track.constData()) == CURLE_OK &&
+			if (uri != private_.appliedStreamUri_) {
+				if (curl_easy_setopt(private_.localContext_,
+									 CURLOPT_RTSP_STREAM_URI,
+									 uri.constData()) != CURLE_OK)
+					return false;
 
-				   (transport.isEmpty()
-					? true
-					: curl_easy_setopt(private_.localContext_,
-									   CURLOPT_RTSP_TRANSPORT,
-									   transport.constData()) == CURLE_OK);
+				private_.appliedStreamUri_ = uri;
+			}
+
+			return transport.isEmpty() ||
+				   curl_easy_setopt(private_.localContext_,
+									CURLOPT_RTSP_TRANSPORT,
+									transport.constData()) == CURLE_OK;
 		}
 
 		///
@@ -569,23 +1044,33 @@ namespace RTSPLib {
 		/// \retval true on success.
 		/// \retval false on error.
 		bool RTSPClientBase::contextSetHeader() {
-			return private_.userAgent_.isEmpty() ||
-				   curl_easy_setopt(private_.localContext_,
+			return curl_easy_setopt(private_.localContext_,
 									CURLOPT_USERAGENT,
-									private_.userAgent_
+									private_.userAgent_.isEmpty()
+									? nullptr
+									: private_.userAgent_
 										.constData()) == CURLE_OK;
 		}
 
 		///
-		/// \details
+		/// \details Session identifier is updated only when it changes.
 		/// \retval true on success.
 		/// \retval false on error.
 		bool RTSPClientBase::contextSetSession() {
-			return private_.currentSession_.isEmpty() ||
-				   curl_easy_setopt(private_.localContext_,
-									CURLOPT_RTSP_SESSION_ID,
-									private_.currentSession_
-										.constData()) == CURLE_OK;
+			if (private_.currentSession_ == private_.appliedSession_)
+				return true;
+
+			if (curl_easy_setopt(private_.localContext_,
+								 CURLOPT_RTSP_SESSION_ID,
+								 private_.currentSession_.isEmpty()
+								 ? nullptr
+								 : private_.currentSession_
+									.constData()) != CURLE_OK)
+				return false;
+
+			private_.appliedSession_ = private_.currentSession_;
+
+			return true;
 		}
 
 		///
@@ -611,23 +1096,29 @@ namespace RTSPLib {
 		/// \retval true on success.
 		/// \retval false on error.
 		bool RTSPClientBase::contextSetCredentials() {
-			return (private_.userCredentials_.second.isEmpty())				||
+			if (private_.userCredentials_.first.isEmpty() ||
+				private_.userCredentials_.second.isEmpty())
+				return curl_easy_setopt(private_.localContext_,
+										CURLOPT_USERNAME,
+										nullptr) == CURLE_OK	&&
 
-				   (!private_.userCredentials_.first.isEmpty()			&&
+					   curl_easy_setopt(private_.localContext_,
+										CURLOPT_PASSWORD,
+										nullptr) == CURLE_OK;
 
-					curl_easy_setopt(private_.localContext_,
-									 CURLOPT_HTTPAUTH,
-									 CURLAUTH_ANY) == CURLE_OK		&&
+			return curl_easy_setopt(private_.localContext_,
+									CURLOPT_HTTPAUTH,
+									private_.authScheme_) == CURLE_OK	&&
 
-					curl_easy_setopt(private_.localContext_,
-									 CURLOPT_USERNAME,
-									 private_.userCredentials_.first
+				   curl_easy_setopt(private_.localContext_,
+									CURLOPT_USERNAME,
+									private_.userCredentials_.first
 										.constData()) == CURLE_OK	&&
 
-					curl_easy_setopt(private_.localContext_,
-									 CURLOPT_PASSWORD,
-									 private_.userCredentials_.second
-										.constData()) == CURLE_OK);
+				   curl_easy_setopt(private_.localContext_,
+									CURLOPT_PASSWORD,
+									private_.userCredentials_.second
+										.constData()) == CURLE_OK;
 		}
 
 		///
@@ -648,14 +1139,207 @@ namespace RTSPLib {
 									1L) == CURLE_OK;
 		}
 
+		/// Applies options that stay the same for every request.
+		/// \details Sets connection URL, user agent, timeouts, credentials and
+		/// callbacks once. They are applied again only after a setter changes
+		/// one of them.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool RTSPClientBase::contextApplyOptions() {
+			if (!private_.optionsChanged_) return true;
+
+			if (curl_easy_setopt(private_.localContext_,
+								 CURLOPT_URL,
+								 private_.connectionUrl_
+									.constData()) != CURLE_OK	||
+				!contextSetHeader()								||
+				!contextSetTimeouts()							||
+				!contextSetCredentials()						||
+				!contextSetMiscellaneous()						||
+				!contextSetInterleaved()						||
+				!contextSetShare()								||
+				!contextSetCallback(CURLOPT_HEADERFUNCTION,
+									callbackHeader,
+									&private_)					||
+				!contextSetCallback(CURLOPT_WRITEFUNCTION,
+									callbackBodyDESCRIBE,
+									&private_))
+				return false;
+
+			private_.optionsChanged_ = false;
+
+			return true;
+		}
+
+		/// Sets interleaved data callback for TCP transport.
+		/// \details Interleaved frames may arrive before any response, so the
+		/// callback is installed for every request.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool RTSPClientBase::contextSetInterleaved() {
+			return private_.transport_ != RTSPTransport::TCP ||
+				   contextSetCallback(CURLOPT_INTERLEAVEFUNCTION,
+									  callbackDataInterleaved,
+									  &private_);
+		}
+
+		/// Attaches the local context to the process-wide session cache.
+		/// \details Host addresses are always shared. Idle connections are
+		/// shared only without interleaved transport, because interleaved
+		/// data of a session arrives on its own connection.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool RTSPClientBase::contextSetShare() {
+			auto& cache = RTSPSessionCache::instance();
+			auto share = cache.getShare(
+				private_.transport_ != RTSPTransport::TCP);
+
+			return curl_easy_setopt(private_.localContext_,
+									CURLOPT_SHARE,
+									share) == CURLE_OK				&&
+				   curl_easy_setopt(private_.localContext_,
+									CURLOPT_DNS_CACHE_TIMEOUT,
+									static_cast<long>(
+										cache.getDnsTimeout())) == CURLE_OK;
+		}
+
+		/// Caches authentication scheme negotiated by the performed request.
+		/// \details After the first challenge the context asks libcurl for
+		/// exactly the scheme the server offered, so later requests carry
+		/// Basic credentials or the Digest response with the cached nonce and
+		/// an incremented nonce count without waiting for a 401. A stale
+		/// nonce is renewed by libcurl within the request, a rejected request
+		/// drops the cached scheme so the next one negotiates again.
+		/// \param[in]	status	RTSP status code of the request.
+		void RTSPClientBase::contextUpdateAuth(RTSPStatusCode status) {
+			auto challenged = private_.challenged_;
+			private_.challenged_ = false;
+
+			if (private_.userCredentials_.first.isEmpty()) return;
+
+			auto scheme = private_.authScheme_;
+
+			if (!challenged) {
+				if (scheme != CURLAUTH_ANY &&
+					status != RTSPStatusCode::Unauthorized)
+					++private_.savedRoundTrips_;
+				return;
+			}
+
+			if (status == RTSPStatusCode::Unauthorized)
+				scheme = CURLAUTH_ANY;
+			else {
+				long available = 0;
+
+				curl_easy_getinfo(private_.localContext_,
+								  CURLINFO_HTTPAUTH_AVAIL,
+								  &available);
+
+				if (available & CURLAUTH_DIGEST)
+					scheme = CURLAUTH_DIGEST;
+				else if (available & CURLAUTH_BASIC)
+					scheme = CURLAUTH_BASIC;
+			}
+
+			if (scheme == private_.authScheme_) return;
+
+			if (curl_easy_setopt(private_.localContext_,
+								 CURLOPT_HTTPAUTH,
+								 scheme) == CURLE_OK)
+				private_.authScheme_ = scheme;
+		}
+
+		/// Records connection reuse of the performed request in the
+		/// process-wide session cache.
+		/// \details A request that opened a connection to a host name also
+		/// looked it up. libcurl does not tell whether its DNS cache answered,
+		/// so a lookup that finished at once counts as a hit. Addresses in
+		/// the URL are not looked up and are not counted.
+		void RTSPClientBase::contextUpdateCache() {
+			auto& cache = RTSPSessionCache::instance();
+			if (!cache.isEnabled()) return;
+
+			long connects = 0;
+
+			if (curl_easy_getinfo(private_.localContext_,
+								  CURLINFO_NUM_CONNECTS,
+								  &connects) != CURLE_OK)
+				return;
+
+			cache.recordConnection(connects == 0);
+			if (connects == 0) return;
+
+			QHostAddress literal;
+
+			if (literal.setAddress(
+					QUrl::fromEncoded(private_.connectionUrl_).host()))
+				return;
+
+			curl_off_t lookup = 0;
+
+			if (curl_easy_getinfo(private_.localContext_,
+								  CURLINFO_NAMELOOKUP_TIME_T,
+								  &lookup) != CURLE_OK)
+				return;
+
+			cache.recordLookup(lookup < CACHED_LOOKUP_TIME);
+		}
+
+		/// Records timing of the performed request.
+		/// \details Reads libcurl timers, which are measured from the start
+		/// of the transfer and include authentication retries.
+		/// \param[in]	request	Request type.
+		void RTSPClientBase::contextUpdateTiming(qint64 request) {
+			RTSPMethod method;
+			if (!requestMethod(request, method)) return;
+
+			const CURLINFO timers[] {
+				CURLINFO_NAMELOOKUP_TIME_T,
+				CURLINFO_CONNECT_TIME_T,
+				CURLINFO_STARTTRANSFER_TIME_T,
+				CURLINFO_TOTAL_TIME_T
+			};
+
+			qint64 values[RTSP_LATENCY_PHASE_COUNT];
+
+			for (auto i = 0; i < RTSP_LATENCY_PHASE_COUNT; ++i) {
+				curl_off_t value = -1;
+
+				curl_easy_getinfo(private_.localContext_, timers[i], &value);
+
+				values[i] = static_cast<qint64>(value);
+			}
+
+			RTSPRequestTiming timing;
+			timing.lookup_		= values[0];
+			timing.connect_		= values[1];
+			timing.firstByte_	= values[2] > 0 ? values[2] : -1;
+			timing.total_		= values[3];
+
+			updateTiming(method, timing);
+		}
+
 		///
 		/// \details
+		/// \param[in]	forbid	Whether the connection must not be reused.
 		/// \retval true on success.
 		/// \retval false on error.
-		bool RTSPClientBase::contextResetConnection() {
+		bool RTSPClientBase::contextResetConnection(bool forbid) {
 			return curl_easy_setopt(private_.localContext_,
 									CURLOPT_FORBID_REUSE,
-									1L) == CURLE_OK;
+									forbid ? 1L : 0L) == CURLE_OK;
+		}
+
+		/// Forces the next request to open a new connection.
+		/// \details A connection that outlived its server would otherwise be
+		/// picked from the connection cache again.
+		/// \param[in]	fresh	Whether a new connection is opened.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool RTSPClientBase::contextRenewConnection(bool fresh) {
+			return curl_easy_setopt(private_.localContext_,
+									CURLOPT_FRESH_CONNECT,
+									fresh ? 1L : 0L) == CURLE_OK;
 		}
 
 		///
@@ -668,25 +1352,70 @@ namespace RTSPLib {
 									1L) == CURLE_OK;
 		}
 
-		///
-		/// \details
-		void RTSPClientBase::contextReset() {
-			curl_easy_reset(private_.localContext_);
-		}
-
 		///
 		/// \details
 		/// \param[in]	request
 		/// \retval true on success.
 		/// \retval false on error.
 		bool RTSPClientBase::contextPerform(qint64 request) {
+			private_.currentRequest_ = request;
+			private_.parser_.reset();
+
 			if (curl_easy_setopt(private_.localContext_,
 								 CURLOPT_RTSP_REQUEST,
-								 request) != CURLE_OK	||
-
-				curl_easy_perform(private_.localContext_) != CURLE_OK)
+								 request) != CURLE_OK)
 				return false;
 
+			auto result = curl_easy_perform(private_.localContext_);
+
+			contextUpdateTiming(request);
+
+			return result == CURLE_OK && contextUpdateSession();
+		}
+
+		/// Starts the prepared request through the non-blocking engine.
+		/// \details The request is completed from the event loop of the
+		/// engine thread.
+		/// \param[in]	request		Request type.
+		/// \param[in]	completion	Completion callback.
+		/// \retval true if the request was started.
+		/// \retval false on error.
+		bool RTSPClientBase::contextSubmit(qint64 request,
+										   const completion_t& completion) {
+
+			private_.currentRequest_ = request;
+			private_.parser_.reset();
+
+			auto submitted =
+				private_.engine_ &&
+
+				curl_easy_setopt(private_.localContext_,
+								 CURLOPT_RTSP_REQUEST,
+								 request) == CURLE_OK &&
+
+				private_.engine_->submit(
+					private_.localContext_,
+					[this, request, completion](CURLcode result) {
+
+					contextUpdateTiming(request);
+
+					auto status = contextComplete(
+						request,
+						result == CURLE_OK && contextUpdateSession());
+
+					if (completion) completion(status);
+				});
+
+			if (!submitted) contextComplete(request, false);
+
+			return submitted;
+		}
+
+		/// Stores session identifier returned by the server.
+		/// \details Reads session identifier if it is not known yet.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool RTSPClientBase::contextUpdateSession() {
 			if (private_.currentSession_.isEmpty()) {
 				char* session = nullptr;
 
@@ -700,6 +1429,44 @@ namespace RTSPLib {
 			return true;
 		}
 
+		/// Finishes the performed request.
+		/// \details Picks up parsed status code and restores per-request
+		/// state. Options applied to the local context are kept.
+		/// \param[in]	request		Request type.
+		/// \param[in]	performed	Whether the request was performed.
+		/// \return RTSP status code.
+		RTSPStatusCode RTSPClientBase::contextComplete(qint64 request,
+													   bool performed) {
+
+			auto status = performed
+						  ? private_.statusCode_
+						  : RTSPStatusCode::Error;
+
+			if (performed) {
+				contextUpdateAuth(status);
+				contextUpdateCache();
+			}
+
+			if (performed && private_.freshConnection_) {
+				private_.freshConnection_ = false;
+				contextRenewConnection(false);
+			}
+
+			private_.statusCode_		= RTSPStatusCode::Error;
+			private_.currentRequest_	= CURL_RTSPREQ_NONE;
+			private_.receiveBody_		= false;
+
+			if (request == CURL_RTSPREQ_TEARDOWN) {
+				private_.currentSession_ = { };
+				private_.sessionTimeout_ = -1;
+				contextSetSession();
+				contextResetConnection(false);
+				contextResetSequence();
+			}
+
+			return status;
+		}
+
 		///
 		/// \details
 		/// \param[in]	url
@@ -786,99 +1553,70 @@ namespace RTSPLib {
 			}
 		}
 
+		/// Stores timing of a finished request.
+		/// \details Keeps the timing of the last request of the method and
+		/// records it in the process-wide latency monitor.
+		/// \param[in]	method	RTSP method.
+		/// \param[in]	timing	Request timing.
+		void RTSPClientBase::updateTiming(RTSPMethod method,
+										  const RTSPRequestTiming& timing) {
+			private_.requestTimings_[static_cast<int>(method)] = timing;
+
+			RTSPLatencyMonitor::instance().record(method, timing);
+		}
+
 		/// Performs an action when receiving RTSP header data.
-		/// \details
+		/// \details Feeds the response parser and picks up status code,
+		/// session timeout, synchronization source of SETUP response and
+		/// methods listed by OPTIONS response.
 		/// \param[in]	data	Data pointer.
 		/// \param[in]	n		Number of buffers.
 		/// \param[in]	size	Data size.
 		/// \param[in]	user	User-defined data.
 		/// \return Actual read size.
-		size_t RTSPClientBase::callbackHeaderAll(char* data,
-												 size_t n,
-												 size_t size,
-												 void* user) {
+		size_t RTSPClientBase::callbackHeader(char* data,
+											  size_t n,
+											  size_t size,
+											  void* user) {
 
 			auto read = n * size;
 			auto object = static_cast<RTSPClientBasePrivate*>(user);
 
 			if (data && (read > 0) && object) {
-				auto header = QByteArray::fromRawData(data, read);
-				auto lines = header.split('\n');
-
-				auto line = std::find_if(lines.cbegin(),
-										 lines.cend(),
-										 [&](const QByteArray& a) {
-					return a.startsWith("RTSP/");
-				});
+				auto& parser = object->parser_;
 
-				if (line != lines.end()) {
-					auto tokens = line->split(' ');
-					auto token = tokens.size() >= 3 ? tokens[1] : "";
+				parser.feed(data, read);
 
+				if (parser.hasStatus())
 					object->statusCode_ = validateStatus(
-						static_cast<RTSPStatusCode>(token.toInt()));
-				}
-			}
-
-			return read;
-		}
-
-		/// Performs an action when receiving RTSP OPTIONS header data.
-		/// \details
-		/// \param[in]	data	Data pointer.
-		/// \param[in]	n		Number of buffers.
-		/// \param[in]	size	Data size.
-		/// \param[in]	user	User-defined data.
-		/// \return Actual read size.
-		size_t RTSPClientBase::callbackHeaderOPTIONS(char* data,
-													 size_t n,
-													 size_t size,
-													 void* user) {
+						parser.getStatusCode());
 
-			auto read = n * size;
-			auto object = static_cast<RTSPClientBasePrivate*>(user);
+				if (parser.isComplete()) {
+					if (object->statusCode_ == RTSPStatusCode::Unauthorized) {
+						object->challenged_ = true;
+						++object->authChallenges_;
+					}
 
-			if (data && (read > 0) && object) {
-				auto header = QByteArray::fromRawData(data, read);
-				auto token = QByteArray("Public:");
-				auto lines = header.split('\n');
-
-				auto line = std::find_if(lines.cbegin(),
-										 lines.cend(),
-										 [&](const QByteArray& a) {
-					return a.startsWith(token);
-				});
+					if (parser.getSessionTimeout() > 0)
+						object->sessionTimeout_ = parser.getSessionTimeout();
 
-				if (line != lines.end()) {
-					auto options = line->mid(token.size()).split(',');
-					object->supportedRequests_.clear();
-
-					static const QMap<QString, qint64> map {
-						{ "OPTIONS",		CURL_RTSPREQ_OPTIONS		},
-						{ "DESCRIBE",		CURL_RTSPREQ_DESCRIBE		},
-						{ "ANNOUNCE",		CURL_RTSPREQ_ANNOUNCE		},
-						{ "SETUP",			CURL_RTSPREQ_SETUP			},
-						{ "PLAY",			CURL_RTSPREQ_PLAY			},
-						{ "PAUSE",			CURL_RTSPREQ_PAUSE			},
-						{ "TEARDOWN",		CURL_RTSPREQ_TEARDOWN		},
-						{ "GET_PARAMETER",	CURL_RTSPREQ_GET_PARAMETER	},
-						{ "SET_PARAMETER",	CURL_RTSPREQ_SET_PARAMETER	},
-						{ "RECORD",			CURL_RTSPREQ_RECORD			}
-					};
-
-					for (const auto& option : options) {
-						auto iterator = map.find(option.trimmed());
-						if (iterator != map.cend())
-							object->supportedRequests_.append(iterator.value());
+					if (object->currentRequest_ == CURL_RTSPREQ_SETUP) {
+						object->transportSSRC_ = parser.getSSRC();
+						object->transportPorts_ = parser.getServerPorts();
 					}
+
+					if (object->currentRequest_ == CURL_RTSPREQ_OPTIONS &&
+						parser.getMethods())
+						object->supportedMethods_ = parser.getMethods();
 				}
 			}
 
-			return callbackHeaderAll(data, n, size, user);
+			return read;
 		}
 
 		/// Performs an action when receiving SDP data.
-		/// \details
+		/// \details Appends DESCRIBE response body to SDP data, bodies of
+		/// other responses are discarded.
 		/// \param[in]	data	Data pointer.
 		/// \param[in]	n		Number of buffers.
 		/// \param[in]	size	Data size.
@@ -892,15 +1630,16 @@ namespace RTSPLib {
 			auto read = n * size;
 			auto object = static_cast<RTSPClientBasePrivate*>(user);
 
-			if (data && (read > 0) && object) {
-				object->sdpData_ = QByteArray(data, read);
+			if (data && (read > 0) && object && object->receiveBody_) {
+				object->sdpData_.append(data, static_cast<int>(read));
 			}
 
 			return read;
 		}
 
 		/// Performs an action when receiving RTSP interleaved data.
-		/// \details
+		/// \details Passes interleaved data to the demultiplexer, which copies
+		/// payloads into channel ring buffers.
 		/// \param[in]	data	Data pointer.
 		/// \param[in]	n		Number of buffers.
 		/// \param[in]	size	Data size.
@@ -912,13 +1651,10 @@ namespace RTSPLib {
 													   void* user) {
 
 			auto read = n * size;
-			auto object = nullptr;
-
-			qDebug() << read;
-
-			if (data && (read > 0) && object) {
+			auto object = static_cast<RTSPClientBasePrivate*>(user);
 
-			}
+			if (data && (read > 0) && object)
+				object->demuxer_.feed(data, read);
 
 			return read;
 		}
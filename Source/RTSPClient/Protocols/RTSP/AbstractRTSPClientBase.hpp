@@ -7,6 +7,14 @@
 #define ABSTRACTRTSPCLIENTBASE_HPP
 
 #include "AbstractRTSPClient.hpp"
+#include "RTSPInterleavedDemuxer.hpp"
+#include "RTSPNativeClient.hpp"
+#include "RTSPRequestTiming.hpp"
+#include "RTSPResponseParser.hpp"
+#include "Base/Export.hpp"
+
+#include <functional>
+#include <memory>
 
 #include <curl.h>
 
@@ -18,9 +26,19 @@ namespace RTSPLib {
 	/// Protocol (RTSP) client library.
 	namespace RTSPClient {
 
+		class RTSPClientEngine;
+
 		/// Class that provides Real Time Streaming Protocol (RTSP) base client
 		/// implementation.
-		class RTSPClientBase {
+		class RTSPCLIENT_EXPORT RTSPClientBase {
+
+			friend class RTSPNativeClient;
+
+		public:
+
+			/// Completion callback type.
+			using completion_t = std::function<void(RTSPStatusCode)>;
+
 		private:
 
 			///
@@ -36,12 +54,12 @@ namespace RTSPLib {
 
 			/// Move constructor.
 			/// \param[in]	object	Object to move.
-			RTSPClientBase(RTSPClientBase&& object) = default;
+			RTSPClientBase(RTSPClientBase&& object) = delete;
 
-			/// Move assignment operator,
+			/// Move assignment operator.
 			/// \param[in]	object	Object to move.
 			/// \return This object.
-			RTSPClientBase& operator=(RTSPClientBase&& object) = default;
+			RTSPClientBase& operator=(RTSPClientBase&& object) = delete;
 
 		public:
 
@@ -54,6 +72,28 @@ namespace RTSPLib {
 			///
 			void close();
 
+			/// Drops the connection and the session, keeping settings.
+			/// \param[in]	keepDescription	Whether SDP data and supported
+			///								methods are kept.
+			/// \retval true on success.
+			/// \retval false on error.
+			bool reconnect(bool keepDescription = true);
+
+			/// Cancels a non-blocking request in progress.
+			/// \retval true if the request was cancelled.
+			/// \retval false if no request was cancelled.
+			bool cancel();
+
+			/// Moves the connection to another thread.
+			/// \param[in]	thread	Target thread.
+			/// \retval true on success.
+			/// \retval false if a request is in progress.
+			bool detach(QThread* thread);
+
+			/// Resumes the connection on the thread it was moved to.
+			/// \param[in]	engine	Non-blocking client engine of the thread.
+			void attach(RTSPClientEngine* engine);
+
 			///
 			/// \retval
 			/// \retval
@@ -71,6 +111,43 @@ namespace RTSPLib {
 			/// \return
 			QByteArray getSession() const;
 
+			/// Indicates whether the server supports an RTSP method.
+			/// \param[in]	method	RTSP method.
+			/// \retval true if the method is advertised by the server.
+			/// \retval false otherwise.
+			bool isSupported(RTSPMethod method) const;
+
+			/// Returns number of authentication challenges received.
+			/// \return Number of 401 responses.
+			quint64 getAuthChallengeCount() const;
+
+			/// Returns number of round-trips saved by cached authentication.
+			/// \return Number of requests authenticated without a challenge.
+			quint64 getSavedRoundTrips() const;
+
+			/// Returns timing of the last request of an RTSP method.
+			/// \param[in]	method	RTSP method.
+			/// \return Request timing.
+			RTSPRequestTiming getRequestTiming(RTSPMethod method) const;
+
+			/// Returns session timeout.
+			/// \return Session timeout in seconds or -1 if it is unknown.
+			qint64 getSessionTimeout() const;
+
+			/// Returns synchronization source announced by SETUP response.
+			/// \return Synchronization source ID (SSRC) or -1 if it is
+			/// unknown.
+			qint64 getSSRC() const;
+
+			/// Returns server ports announced by SETUP response.
+			/// \return Server RTP and RTCP ports or zeros if they are unknown.
+			QPair<quint16, quint16> getServerPorts() const;
+
+			/// Returns address of the RTSP server.
+			/// \return Server address or null address if there is no
+			/// connection.
+			QHostAddress getServerAddress() const;
+
 			///
 			/// \return
 			QByteArray getUserAgent() const;
@@ -97,6 +174,63 @@ namespace RTSPLib {
 				const QPair<QByteArray, QByteArray>& credentials
 			);
 
+			/// Returns RTP transport protocol.
+			/// \return RTP transport protocol.
+			RTSPTransport getTransport() const;
+
+			/// Sets RTP transport protocol used by SETUP requests.
+			/// \param[in]	transport	RTP transport protocol.
+			void setTransport(RTSPTransport transport);
+
+			/// Indicates whether fast start is enabled.
+			/// \retval true if fast start is enabled.
+			/// \retval false if fast start is disabled.
+			bool isFastStart() const;
+
+			/// Enables or disables fast start.
+			/// \param[in]	fastStart	Whether requests may be sent before
+			///							OPTIONS response is received.
+			void setFastStart(bool fastStart);
+
+			/// Returns interleaved data demultiplexer.
+			/// \return Interleaved data demultiplexer.
+			RTSPInterleavedDemuxer& getDemuxer();
+
+			/// Returns RTSP connection socket.
+			/// \return Socket descriptor or -1 if there is no connection.
+			qintptr getSocket() const;
+
+			/// Returns non-blocking client engine.
+			/// \return Non-blocking client engine.
+			RTSPClientEngine* getEngine() const;
+
+			/// Sets non-blocking client engine.
+			/// \param[in]	engine	Non-blocking client engine.
+			void setEngine(RTSPClientEngine* engine);
+
+			/// Returns protocol backend.
+			/// \return Protocol backend.
+			RTSPBackend getBackend() const;
+
+			/// Sets protocol backend.
+			/// \param[in]	backend	Protocol backend.
+			void setBackend(RTSPBackend backend);
+
+			/// Sets handler of interleaved data delivered by the native
+			/// backend.
+			/// \param[in]	handler	Handler called after interleaved data is
+			///						stored in channel buffers.
+			void setReceiveHandler(const std::function<void()>& handler);
+
+			/// Returns number of requests sent before the previous response.
+			/// \return Number of pipelined requests.
+			quint64 getPipelinedCount() const;
+
+			/// Indicates whether a non-blocking request is in progress.
+			/// \retval true if a request is in progress.
+			/// \retval false if no request is in progress.
+			bool isPending() const;
+
 			/// Sends OPTIONS request.
 			/// \return RTSP status code.
 			RTSPStatusCode OPTIONS();
@@ -128,10 +262,87 @@ namespace RTSPLib {
 			/// \return RTSP status code.
 			RTSPStatusCode TEARDOWN();
 
-			///
-			/// \return
+			/// Receives interleaved data.
+			/// \return RTSP status code.
 			RTSPStatusCode RECEIVE();
 
+			/// Sends OPTIONS request through the non-blocking engine.
+			/// \param[in]	completion	Completion callback.
+			/// \retval true if the request was started.
+			/// \retval false on error.
+			bool OPTIONS(const completion_t& completion);
+
+			/// Sends DESCRIBE request through the non-blocking engine.
+			/// \param[in]	completion	Completion callback.
+			/// \retval true if the request was started.
+			/// \retval false on error.
+			bool DESCRIBE(const completion_t& completion);
+
+			/// Sends SETUP request through the non-blocking engine.
+			/// \param[in]	path		Media track path.
+			/// \param[in]	channels	Channels for RTP and RTCP data.
+			/// \param[in]	completion	Completion callback.
+			/// \retval true if the request was started.
+			/// \retval false on error.
+			bool SETUP(const QByteArray& path,
+					   const QPair<quint16, quint16>& channels,
+					   const completion_t& completion);
+
+			/// Sends PLAY request through the non-blocking engine.
+			/// \param[in]	completion	Completion callback.
+			/// \retval true if the request was started.
+			/// \retval false on error.
+			bool PLAY(const completion_t& completion);
+
+			/// Sends PAUSE request through the non-blocking engine.
+			/// \param[in]	completion	Completion callback.
+			/// \retval true if the request was started.
+			/// \retval false on error.
+			bool PAUSE(const completion_t& completion);
+
+			/// Sends GET_PARAMETER request through the non-blocking engine.
+			/// \param[in]	completion	Completion callback.
+			/// \retval true if the request was started.
+			/// \retval false on error.
+			bool GET_PARAMETER(const completion_t& completion);
+
+			/// Sends TEARDOWN request through the non-blocking engine.
+			/// \param[in]	completion	Completion callback.
+			/// \retval true if the request was started.
+			/// \retval false on error.
+			bool TEARDOWN(const completion_t& completion);
+
+		private:
+
+			/// Prepares OPTIONS request.
+			/// \retval true on success.
+			/// \retval false on error.
+			bool prepareOPTIONS();
+
+			/// Prepares DESCRIBE request.
+			/// \retval true on success.
+			/// \retval false on error.
+			bool prepareDESCRIBE();
+
+			/// Prepares SETUP request.
+			/// \param[in]	path		Media track path.
+			/// \param[in]	channels	Channels for RTP and RTCP data.
+			/// \retval true on success.
+			/// \retval false on error.
+			bool prepareSETUP(const QByteArray& path,
+							  const QPair<quint16, quint16>& channels);
+
+			/// Prepares PLAY, PAUSE or GET_PARAMETER request.
+			/// \param[in]	request	Request type.
+			/// \retval true on success.
+			/// \retval false on error.
+			bool prepareSession(qint64 request);
+
+			/// Prepares TEARDOWN request.
+			/// \retval true on success.
+			/// \retval false on error.
+			bool prepareTEARDOWN();
+
 		private:
 
 			///
@@ -197,18 +408,50 @@ namespace RTSPLib {
 			/// \retval false on error.
 			bool contextSetMiscellaneous();
 
-			///
+			/// Sets interleaved data callback for TCP transport.
 			/// \retval true on success.
 			/// \retval false on error.
-			bool contextResetConnection();
+			bool contextSetInterleaved();
+
+			/// Attaches the local context to the process-wide session cache.
+			/// \retval true on success.
+			/// \retval false on error.
+			bool contextSetShare();
+
+			/// Caches authentication scheme negotiated by the performed
+			/// request.
+			/// \param[in]	status	RTSP status code of the request.
+			void contextUpdateAuth(RTSPStatusCode status);
+
+			/// Records connection reuse of the performed request in the
+			/// process-wide session cache.
+			void contextUpdateCache();
+
+			/// Records timing of the performed request.
+			/// \param[in]	request	Request type.
+			void contextUpdateTiming(qint64 request);
+
+			/// Applies options that stay the same for every request.
+			/// \retval true on success.
+			/// \retval false on error.
+			bool contextApplyOptions();
 
 			///
+			/// \param[in]	forbid	Whether the connection must not be reused.
 			/// \retval true on success.
 			/// \retval false on error.
-			bool contextResetSequence();
+			bool contextResetConnection(bool forbid);
+
+			/// Forces the next request to open a new connection.
+			/// \param[in]	fresh	Whether a new connection is opened.
+			/// \retval true on success.
+			/// \retval false on error.
+			bool contextRenewConnection(bool fresh);
 
 			///
-			void contextReset();
+			/// \retval true on success.
+			/// \retval false on error.
+			bool contextResetSequence();
 
 			///
 			/// \param[in]	request
@@ -216,6 +459,24 @@ namespace RTSPLib {
 			/// \retval false on error.
 			bool contextPerform(qint64 request);
 
+			/// Starts the prepared request through the non-blocking engine.
+			/// \param[in]	request		Request type.
+			/// \param[in]	completion	Completion callback.
+			/// \retval true if the request was started.
+			/// \retval false on error.
+			bool contextSubmit(qint64 request, const completion_t& completion);
+
+			/// Stores session identifier returned by the server.
+			/// \retval true on success.
+			/// \retval false on error.
+			bool contextUpdateSession();
+
+			/// Finishes the performed request.
+			/// \param[in]	request		Request type.
+			/// \param[in]	performed	Whether the request was performed.
+			/// \return RTSP status code.
+			RTSPStatusCode contextComplete(qint64 request, bool performed);
+
 		private:
 
 			///
@@ -228,27 +489,22 @@ namespace RTSPLib {
 			/// \return
 			static RTSPStatusCode validateStatus(RTSPStatusCode status);
 
-			/// Performs an action when receiving RTSP header data.
-			/// \param[in]	data	Data pointer.
-			/// \param[in]	n		Number of buffers.
-			/// \param[in]	size	Data size.
-			/// \param[in]	user	User-defined data.
-			/// \return Actual read size.
-			static size_t callbackHeaderAll(char* data,
-											size_t n,
-											size_t size,
-											void* user);
+			/// Stores timing of a finished request.
+			/// \param[in]	method	RTSP method.
+			/// \param[in]	timing	Request timing.
+			void updateTiming(RTSPMethod method,
+							  const RTSPRequestTiming& timing);
 
-			/// Performs an action when receiving RTSP OPTIONS header data.
+			/// Performs an action when receiving RTSP header data.
 			/// \param[in]	data	Data pointer.
 			/// \param[in]	n		Number of buffers.
 			/// \param[in]	size	Data size.
 			/// \param[in]	user	User-defined data.
 			/// \return Actual read size.
-			static size_t callbackHeaderOPTIONS(char* data,
-												size_t n,
-												size_t size,
-												void* user);
+			static size_t callbackHeader(char* data,
+										 size_t n,
+										 size_t size,
+										 void* user);
 
 			/// Performs an action when receiving SDP data.
 			/// \param[in]	data	Data pointer.
@@ -280,6 +536,9 @@ namespace RTSPLib {
 				/// Local libcurl context.
 				CURL* localContext_ { nullptr };
 
+				/// Non-blocking client engine.
+				RTSPClientEngine* engine_ { nullptr };
+
 				/// RTSP status code.
 				RTSPStatusCode statusCode_ { RTSPStatusCode::Error };
 
@@ -295,8 +554,20 @@ namespace RTSPLib {
 				/// SDP data.
 				QByteArray sdpData_ { };
 
-				/// Supported RTSP requests.
-				QVector<qint64> supportedRequests_ { };
+				/// Bitmask of supported RTSP methods.
+				quint32 supportedMethods_ { 0 };
+
+				/// Session timeout in seconds.
+				qint64 sessionTimeout_ { -1 };
+
+				/// Synchronization source of the last SETUP response.
+				qint64 transportSSRC_ { -1 };
+
+				/// Server ports of the last SETUP response.
+				QPair<quint16, quint16> transportPorts_ { 0, 0 };
+
+				/// Response parser.
+				RTSPResponseParser parser_ { };
 
 				/// Operation timeouts.
 				QPair<qint64, qint64> operationTimeouts_ { 0, 0 };
@@ -304,6 +575,51 @@ namespace RTSPLib {
 				/// User credentials.
 				QPair<QByteArray, QByteArray> userCredentials_ { };
 
+				/// RTP transport protocol.
+				RTSPTransport transport_ { RTSPTransport::UDP };
+
+				/// Interleaved data demultiplexer.
+				RTSPInterleavedDemuxer demuxer_ { };
+
+				/// Whether requests may be sent before OPTIONS response.
+				bool fastStart_ { false };
+
+				/// Request in progress.
+				qint64 currentRequest_ { CURL_RTSPREQ_NONE };
+
+				/// Stream URI applied to the local context.
+				QByteArray appliedStreamUri_ { };
+
+				/// Session identifier applied to the local context.
+				QByteArray appliedSession_ { };
+
+				/// Whether session-wide options must be applied again.
+				bool optionsChanged_ { true };
+
+				/// Whether response body is stored as SDP data.
+				bool receiveBody_ { false };
+
+				/// Authentication scheme negotiated with the server.
+				unsigned long authScheme_ { CURLAUTH_ANY };
+
+				/// Whether the current request was challenged.
+				bool challenged_ { false };
+
+				/// Number of authentication challenges received.
+				quint64 authChallenges_ { 0 };
+
+				/// Number of requests authenticated without a challenge.
+				quint64 savedRoundTrips_ { 0 };
+
+				/// Timing of the last request of every RTSP method.
+				RTSPRequestTiming requestTimings_[RTSP_METHOD_COUNT];
+
+				/// Whether the next request opens a new connection.
+				bool freshConnection_ { false };
+
+				/// Native protocol backend.
+				std::unique_ptr<RTSPNativeClient> native_ { };
+
 			} private_;
 		};
 	}
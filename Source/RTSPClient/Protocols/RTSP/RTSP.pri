@@ -5,7 +5,22 @@
 HEADERS			+=															\
 						$$PWD/AbstractRTSPClient.hpp						\
 						$$PWD/AbstractRTSPClientBase.hpp					\
+						$$PWD/RTSPClientEngine.hpp							\
+						$$PWD/RTSPInterleavedDemuxer.hpp					\
+						$$PWD/RTSPKeepAliveScheduler.hpp					\
+						$$PWD/RTSPLatencyMonitor.hpp						\
+						$$PWD/RTSPNativeClient.hpp							\
+						$$PWD/RTSPRequestTiming.hpp							\
+						$$PWD/RTSPResponseParser.hpp						\
+						$$PWD/RTSPSessionCache.hpp							\
 
 SOURCES			+=															\
 						$$PWD/AbstractRTSPClient.cpp						\
 						$$PWD/AbstractRTSPClientBase.cpp					\
+						$$PWD/RTSPClientEngine.cpp							\
+						$$PWD/RTSPInterleavedDemuxer.cpp					\
+						$$PWD/RTSPKeepAliveScheduler.cpp					\
+						$$PWD/RTSPLatencyMonitor.cpp						\
+						$$PWD/RTSPNativeClient.cpp							\
+						$$PWD/RTSPResponseParser.cpp						\
+						$$PWD/RTSPSessionCache.cpp							\
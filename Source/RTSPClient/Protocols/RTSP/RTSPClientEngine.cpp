@@ -0,0 +1,341 @@
+/// \file RTSPClientEngine.cpp
+/// \brief Contains classes and functions definitions that provide Real Time
+/// Streaming Protocol (RTSP) non-blocking client engine.
+/// \bug No known bugs.
+
+#include "RTSPClientEngine.hpp"
+
+#include <QSocketNotifier>
+#include <QThreadStorage>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		/// Structure that provides private storage.
+		/// \details Maintains private data.
+		struct RTSPClientEngine::RTSPClientEnginePrivate final {
+
+			/// Structure that holds socket notifiers.
+			struct Notifiers final {
+
+				/// Socket read notifier.
+				QSocketNotifier* read_ { nullptr };
+
+				/// Socket write notifier.
+				QSocketNotifier* write_ { nullptr };
+			};
+
+			/// Global libcurl multi context.
+			CURLM* multiContext_ { nullptr };
+
+			/// Timer that drives libcurl timeouts.
+			QTimer timer_;
+
+			/// Socket notifiers by socket descriptor.
+			QHash<curl_socket_t, Notifiers> notifiers_;
+
+			/// Completion callbacks by local libcurl context.
+			QHash<CURL*, completion_t> completions_;
+		};
+
+		/// Default constructor.
+		/// \details Initializes libcurl multi context and its callbacks.
+		/// \param[in]	parent	Parent object.
+		RTSPClientEngine::RTSPClientEngine(QObject* parent)
+			: QObject(parent),
+			  private_(new RTSPClientEnginePrivate) {
+
+			private_->timer_.setSingleShot(true);
+
+			connect(
+				&private_->timer_,
+				SIGNAL(timeout()),
+				SLOT(onTimeout())
+			);
+
+			private_->multiContext_ = curl_multi_init();
+			if (!private_->multiContext_) return;
+
+			curl_multi_setopt(private_->multiContext_,
+							  CURLMOPT_SOCKETFUNCTION,
+							  callbackSocket);
+
+			curl_multi_setopt(private_->multiContext_,
+							  CURLMOPT_SOCKETDATA,
+							  this);
+
+			curl_multi_setopt(private_->multiContext_,
+							  CURLMOPT_TIMERFUNCTION,
+							  callbackTimer);
+
+			curl_multi_setopt(private_->multiContext_,
+							  CURLMOPT_TIMERDATA,
+							  this);
+		}
+
+		/// Destructor.
+		/// \details Detaches pending transfers without calling their
+		/// completion callbacks and cleans resources.
+		RTSPClientEngine::~RTSPClientEngine() {
+			private_->timer_.stop();
+
+			if (!private_->multiContext_) return;
+
+			for (auto it = private_->completions_.begin();
+				 it != private_->completions_.end(); ++it)
+				curl_multi_remove_handle(private_->multiContext_, it.key());
+
+			private_->completions_.clear();
+
+			curl_multi_cleanup(private_->multiContext_);
+			private_->multiContext_ = nullptr;
+
+			for (auto it = private_->notifiers_.begin();
+				 it != private_->notifiers_.end(); ++it) {
+				delete it.value().read_;
+				delete it.value().write_;
+			}
+		}
+
+		/// Returns engine shared by the calling thread.
+		/// \details Every thread gets its own engine, so all clients of a
+		/// controller thread share one multi context and its event loop.
+		/// \return Shared engine.
+		RTSPClientEngine& RTSPClientEngine::shared() {
+			static QThreadStorage<RTSPClientEngine*> storage;
+
+			if (!storage.hasLocalData())
+				storage.setLocalData(new RTSPClientEngine);
+
+			return *storage.localData();
+		}
+
+		/// Indicates whether the engine is valid.
+		/// \details Checks if libcurl multi context is initialized.
+		/// \retval true if the engine is valid.
+		/// \retval false if the engine is not valid.
+		bool RTSPClientEngine::isValid() const {
+			return private_->multiContext_ != nullptr;
+		}
+
+		/// Starts a transfer on the local libcurl context.
+		/// \details Adds the local context to the multi context. The
+		/// completion callback is called from the event loop once the
+		/// transfer finishes, it may submit the next request right away.
+		/// \param[in]	context		Local libcurl context.
+		/// \param[in]	completion	Completion callback.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool RTSPClientEngine::submit(CURL* context,
+									  const completion_t& completion) {
+
+			if (!isValid() || !context ||
+				private_->completions_.contains(context))
+				return false;
+
+			private_->completions_.insert(context, completion);
+
+			if (curl_multi_add_handle(private_->multiContext_,
+									  context) != CURLM_OK) {
+				private_->completions_.remove(context);
+				return false;
+			}
+
+			return true;
+		}
+
+		/// Cancels a transfer on the local libcurl context.
+		/// \details Removes the local context from the multi context without
+		/// calling its completion callback.
+		/// \param[in]	context	Local libcurl context.
+		/// \retval true if the transfer was cancelled.
+		/// \retval false if the transfer was not found.
+		bool RTSPClientEngine::cancel(CURL* context) {
+			if (!isValid() || !private_->completions_.remove(context))
+				return false;
+
+			curl_multi_remove_handle(private_->multiContext_, context);
+
+			return true;
+		}
+
+		/// Indicates whether a transfer is in progress.
+		/// \details Checks if the local context has a pending completion.
+		/// \param[in]	context	Local libcurl context.
+		/// \retval true if the transfer is in progress.
+		/// \retval false if the transfer is not in progress.
+		bool RTSPClientEngine::isPending(CURL* context) const {
+			return private_->completions_.contains(context);
+		}
+
+		/// Returns number of transfers in progress.
+		/// \details Returns number of pending completions.
+		/// \return Number of transfers in progress.
+		int RTSPClientEngine::getPendingCount() const {
+			return private_->completions_.size();
+		}
+
+		/// Performs an action when a socket becomes readable.
+		/// \details Passes read readiness to libcurl.
+		/// \param[in]	socket	Socket descriptor.
+		void RTSPClientEngine::onSocketRead(int socket) {
+			socketAction(socket, CURL_CSELECT_IN);
+		}
+
+		/// Performs an action when a socket becomes writable.
+		/// \details Passes write readiness to libcurl.
+		/// \param[in]	socket	Socket descriptor.
+		void RTSPClientEngine::onSocketWrite(int socket) {
+			socketAction(socket, CURL_CSELECT_OUT);
+		}
+
+		/// Performs an action when the libcurl timeout expires.
+		/// \details Passes timeout expiration to libcurl.
+		void RTSPClientEngine::onTimeout() {
+			socketAction(CURL_SOCKET_TIMEOUT, 0);
+		}
+
+		/// Notifies libcurl about socket activity.
+		/// \details Performs multi socket action and dispatches completed
+		/// transfers.
+		/// \param[in]	socket	Socket descriptor or CURL_SOCKET_TIMEOUT.
+		/// \param[in]	events	Socket events bitmask.
+		void RTSPClientEngine::socketAction(curl_socket_t socket, int events) {
+			if (!isValid()) return;
+
+			auto running = 0;
+
+			curl_multi_socket_action(private_->multiContext_,
+									 socket,
+									 events,
+									 &running);
+
+			processMessages();
+
+			if (private_->completions_.isEmpty())
+				private_->timer_.stop();
+		}
+
+		/// Dispatches completed transfers to their callbacks.
+		/// \details Removes finished local contexts from the multi context
+		/// before calling completion callbacks, so that callbacks can reuse
+		/// the same local context for the next request.
+		void RTSPClientEngine::processMessages() {
+			auto pending = 0;
+
+			while (auto message = curl_multi_info_read(
+					   private_->multiContext_, &pending)) {
+
+				if (message->msg != CURLMSG_DONE) continue;
+
+				auto context = message->easy_handle;
+				auto result = message->data.result;
+
+				curl_multi_remove_handle(private_->multiContext_, context);
+
+				auto completion = private_->completions_.take(context);
+				if (completion) completion(result);
+			}
+		}
+
+		/// Performs an action when libcurl updates socket interest.
+		/// \details Creates, updates or removes socket notifiers.
+		/// \param[in]	context	Local libcurl context.
+		/// \param[in]	socket	Socket descriptor.
+		/// \param[in]	what	Socket interest.
+		/// \param[in]	user	User-defined data.
+		/// \param[in]	data	Socket-specific data.
+		/// \return Zero.
+		int RTSPClientEngine::callbackSocket(CURL* context,
+											 curl_socket_t socket,
+											 int what,
+											 void* user,
+											 void* data) {
+
+			Q_UNUSED(context)
+			Q_UNUSED(data)
+
+			auto object = static_cast<RTSPClientEngine*>(user);
+			if (!object) return 0;
+
+			auto& notifiers = object->private_->notifiers_;
+
+			if (what == CURL_POLL_REMOVE) {
+				auto iterator = notifiers.find(socket);
+				if (iterator == notifiers.end()) return 0;
+
+				iterator.value().read_->setEnabled(false);
+				iterator.value().read_->deleteLater();
+				iterator.value().write_->setEnabled(false);
+				iterator.value().write_->deleteLater();
+
+				notifiers.erase(iterator);
+				return 0;
+			}
+
+			auto iterator = notifiers.find(socket);
+
+			if (iterator == notifiers.end()) {
+				RTSPClientEnginePrivate::Notifiers created;
+
+				created.read_ = new QSocketNotifier(
+					socket, QSocketNotifier::Read, object);
+
+				created.write_ = new QSocketNotifier(
+					socket, QSocketNotifier::Write, object);
+
+				connect(
+					created.read_,
+					SIGNAL(activated(int)),
+					object,
+					SLOT(onSocketRead(int))
+				);
+
+				connect(
+					created.write_,
+					SIGNAL(activated(int)),
+					object,
+					SLOT(onSocketWrite(int))
+				);
+
+				iterator = notifiers.insert(socket, created);
+			}
+
+			iterator.value().read_->setEnabled(
+				what == CURL_POLL_IN || what == CURL_POLL_INOUT);
+
+			iterator.value().write_->setEnabled(
+				what == CURL_POLL_OUT || what == CURL_POLL_INOUT);
+
+			return 0;
+		}
+
+		/// Performs an action when libcurl updates its timeout.
+		/// \details Restarts or stops the engine timer.
+		/// \param[in]	context	Global libcurl context.
+		/// \param[in]	timeout	Timeout in milliseconds.
+		/// \param[in]	user	User-defined data.
+		/// \return Zero.
+		int RTSPClientEngine::callbackTimer(CURLM* context,
+											long timeout,
+											void* user) {
+
+			Q_UNUSED(context)
+
+			auto object = static_cast<RTSPClientEngine*>(user);
+			if (!object) return 0;
+
+			if (timeout < 0)
+				object->private_->timer_.stop();
+			else
+				object->private_->timer_.start(static_cast<int>(timeout));
+
+			return 0;
+		}
+	}
+}
@@ -0,0 +1,140 @@
+/// \file RTSPClientEngine.hpp
+/// \brief Contains classes and functions declarations that provide Real Time
+/// Streaming Protocol (RTSP) non-blocking client engine.
+/// \bug No known bugs.
+
+#ifndef RTSPCLIENTENGINE_HPP
+#define RTSPCLIENTENGINE_HPP
+
+#include "Base/Export.hpp"
+
+#include <QtCore>
+
+#include <functional>
+
+#include <curl.h>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		/// Class that provides non-blocking RTSP client engine.
+		/// \details Drives many libcurl contexts at once through the
+		/// libcurl multi socket interface. Socket readiness and timeouts are
+		/// delivered by the Qt event loop of the thread that owns the engine,
+		/// so a single thread can keep thousands of requests in flight.
+		class RTSPCLIENT_EXPORT RTSPClientEngine final : public QObject {
+
+			Q_OBJECT
+
+		public:
+
+			/// Completion callback type.
+			using completion_t = std::function<void(CURLcode)>;
+
+		public:
+
+			/// Default constructor.
+			/// \param[in]	parent	Parent object.
+			explicit RTSPClientEngine(QObject* parent = nullptr);
+
+			/// Destructor.
+			~RTSPClientEngine() override;
+
+		public:
+
+			/// Returns engine shared by the calling thread.
+			/// \return Shared engine.
+			static RTSPClientEngine& shared();
+
+			/// Indicates whether the engine is valid.
+			/// \retval true if the engine is valid.
+			/// \retval false if the engine is not valid.
+			bool isValid() const;
+
+			/// Starts a transfer on the local libcurl context.
+			/// \param[in]	context		Local libcurl context.
+			/// \param[in]	completion	Completion callback.
+			/// \retval true on success.
+			/// \retval false on error.
+			bool submit(CURL* context, const completion_t& completion);
+
+			/// Cancels a transfer on the local libcurl context.
+			/// \param[in]	context	Local libcurl context.
+			/// \retval true if the transfer was cancelled.
+			/// \retval false if the transfer was not found.
+			bool cancel(CURL* context);
+
+			/// Indicates whether a transfer is in progress.
+			/// \param[in]	context	Local libcurl context.
+			/// \retval true if the transfer is in progress.
+			/// \retval false if the transfer is not in progress.
+			bool isPending(CURL* context) const;
+
+			/// Returns number of transfers in progress.
+			/// \return Number of transfers in progress.
+			int getPendingCount() const;
+
+		private slots:
+
+			/// Performs an action when a socket becomes readable.
+			/// \param[in]	socket	Socket descriptor.
+			void onSocketRead(int socket);
+
+			/// Performs an action when a socket becomes writable.
+			/// \param[in]	socket	Socket descriptor.
+			void onSocketWrite(int socket);
+
+			/// Performs an action when the libcurl timeout expires.
+			void onTimeout();
+
+		private:
+
+			/// Notifies libcurl about socket activity.
+			/// \param[in]	socket	Socket descriptor or CURL_SOCKET_TIMEOUT.
+			/// \param[in]	events	Socket events bitmask.
+			void socketAction(curl_socket_t socket, int events);
+
+			/// Dispatches completed transfers to their callbacks.
+			void processMessages();
+
+		private:
+
+			/// Performs an action when libcurl updates socket interest.
+			/// \param[in]	context	Local libcurl context.
+			/// \param[in]	socket	Socket descriptor.
+			/// \param[in]	what	Socket interest.
+			/// \param[in]	user	User-defined data.
+			/// \param[in]	data	Socket-specific data.
+			/// \return Zero.
+			static int callbackSocket(CURL* context,
+									  curl_socket_t socket,
+									  int what,
+									  void* user,
+									  void* data);
+
+			/// Performs an action when libcurl updates its timeout.
+			/// \param[in]	context	Global libcurl context.
+			/// \param[in]	timeout	Timeout in milliseconds.
+			/// \param[in]	user	User-defined data.
+			/// \return Zero.
+			static int callbackTimer(CURLM* context,
+									 long timeout,
+									 void* user);
+
+		private:
+
+			/// Opaque type for private data.
+			struct RTSPClientEnginePrivate;
+
+			/// Private data.
+			const QScopedPointer<RTSPClientEnginePrivate> private_;
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,167 @@
+/// \file RTSPInterleavedDemuxer.cpp
+/// \brief Contains classes and functions definitions that provide Real Time
+/// Streaming Protocol (RTSP) interleaved data demultiplexer.
+/// \bug No known bugs.
+
+#include "RTSPInterleavedDemuxer.hpp"
+
+#include <cstring>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		namespace {
+
+			/// Interleaved frame magic byte.
+			/// \details Starts every interleaved frame.
+			constexpr char INTERLEAVED_MAGIC { '$' };
+		}
+
+		/// Default constructor.
+		/// \details Allocates channel table.
+		RTSPInterleavedDemuxer::RTSPInterleavedDemuxer()
+			: buffers_(new std::unique_ptr<PacketRingBuffer>[CHANNEL_COUNT]) {
+		}
+
+		/// Destructor.
+		/// \details Defaulted default destructor.
+		RTSPInterleavedDemuxer::~RTSPInterleavedDemuxer() = default;
+
+		/// Creates or removes the ring buffer of a channel.
+		/// \details Must not be called while data is fed.
+		/// \param[in]	channel		Interleaved channel.
+		/// \param[in]	capacity	Buffer capacity, zero removes it.
+		void RTSPInterleavedDemuxer::setChannelBuffer(quint8 channel,
+													  int capacity) {
+
+			if (capacity > 0)
+				buffers_[channel].reset(new PacketRingBuffer(capacity));
+			else
+				buffers_[channel].reset();
+		}
+
+		/// Returns the ring buffer of a channel.
+		/// \details The consumer reads delivered payloads from it.
+		/// \param[in]	channel	Interleaved channel.
+		/// \return Ring buffer or nullptr if the channel is not used.
+		PacketRingBuffer* RTSPInterleavedDemuxer::getChannelBuffer(
+			quint8 channel) const noexcept {
+
+			return buffers_[channel].get();
+		}
+
+		/// Processes interleaved data.
+		/// \details Walks the framing state machine byte by byte for headers
+		/// and copies payload ranges in one go.
+		/// \param[in]	data	Data pointer.
+		/// \param[in]	size	Data size.
+		/// \return Processed data size.
+		size_t RTSPInterleavedDemuxer::feed(const char* data,
+											size_t size) noexcept {
+
+			if (!data) return 0;
+
+			auto current = data;
+			auto end = data + size;
+
+			while (current < end) {
+				switch (state_) {
+				case State::Magic:
+					if (*current++ == INTERLEAVED_MAGIC)
+						state_ = State::Channel;
+					break;
+
+				case State::Channel:
+					channel_ = static_cast<quint8>(*current++);
+					state_ = State::LengthHigh;
+					break;
+
+				case State::LengthHigh:
+					length_ = static_cast<quint16>(
+						static_cast<quint8>(*current++) << 8);
+					state_ = State::LengthLow;
+					break;
+
+				case State::LengthLow: {
+					length_ |= static_cast<quint8>(*current++);
+					received_ = 0;
+
+					if (length_ == 0) {
+						state_ = State::Magic;
+						break;
+					}
+
+					auto buffer = buffers_[channel_].get();
+					target_ = buffer ? buffer->reserve(length_) : nullptr;
+					state_ = State::Payload;
+					break;
+				}
+
+				case State::Payload: {
+					auto chunk = qMin<size_t>(
+						static_cast<size_t>(end - current),
+						static_cast<size_t>(length_ - received_));
+
+					if (target_) std::memcpy(target_ + received_, current, chunk);
+
+					current += chunk;
+					received_ = static_cast<quint16>(received_ + chunk);
+
+					if (received_ == length_) {
+						if (target_) {
+							buffers_[channel_]->commit();
+							++frames_;
+						}
+						else ++dropped_;
+
+						target_ = nullptr;
+						state_ = State::Magic;
+					}
+					break;
+				}
+				}
+			}
+
+			return size;
+		}
+
+		/// Indicates whether a frame is partially processed.
+		/// \details Checks the framing state.
+		/// \retval true if the demultiplexer is inside a frame.
+		/// \retval false if the demultiplexer expects a new frame.
+		bool RTSPInterleavedDemuxer::isInsideFrame() const noexcept {
+			return state_ != State::Magic;
+		}
+
+		/// Resets framing state and clears ring buffers.
+		/// \details Drops a partially received frame.
+		void RTSPInterleavedDemuxer::reset() noexcept {
+			state_ = State::Magic;
+			length_ = 0;
+			received_ = 0;
+			target_ = nullptr;
+
+			for (auto i = 0; i < CHANNEL_COUNT; ++i)
+				if (buffers_[i]) buffers_[i]->clear();
+		}
+
+		/// Returns number of delivered frames.
+		/// \details Counts frames committed to ring buffers.
+		/// \return Number of delivered frames.
+		quint64 RTSPInterleavedDemuxer::getFrameCount() const noexcept {
+			return frames_;
+		}
+
+		/// Returns number of frames without a buffer or room.
+		/// \details Counts frames skipped by the demultiplexer.
+		/// \return Number of dropped frames.
+		quint64 RTSPInterleavedDemuxer::getDroppedCount() const noexcept {
+			return dropped_;
+		}
+	}
+}
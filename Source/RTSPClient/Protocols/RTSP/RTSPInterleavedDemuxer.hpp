@@ -0,0 +1,123 @@
+/// \file RTSPInterleavedDemuxer.hpp
+/// \brief Contains classes and functions declarations that provide Real Time
+/// Streaming Protocol (RTSP) interleaved data demultiplexer.
+/// \bug No known bugs.
+
+#ifndef RTSPINTERLEAVEDDEMUXER_HPP
+#define RTSPINTERLEAVEDDEMUXER_HPP
+
+#include "Base/Export.hpp"
+#include "Utilities/PacketRingBuffer.hpp"
+
+#include <QtGlobal>
+
+#include <memory>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		/// Class that provides RTSP interleaved data demultiplexer.
+		/// \details Splits the '$', channel, length framing of RTP over RTSP
+		/// (RFC 2326, section 10.12) and copies every payload straight into
+		/// the ring buffer of its channel. Frames may be split across any
+		/// number of input chunks.
+		class RTSPCLIENT_EXPORT RTSPInterleavedDemuxer final {
+		public:
+
+			/// Default constructor.
+			explicit RTSPInterleavedDemuxer();
+
+			/// Destructor.
+			~RTSPInterleavedDemuxer();
+
+			/// Move constructor.
+			/// \param[in]	object	Object to move.
+			RTSPInterleavedDemuxer(RTSPInterleavedDemuxer&& object) = default;
+
+			/// Move assignment operator.
+			/// \param[in]	object	Object to move.
+			/// \return This object.
+			RTSPInterleavedDemuxer& operator=(
+				RTSPInterleavedDemuxer&& object) = default;
+
+		public:
+
+			/// Creates or removes the ring buffer of a channel.
+			/// \param[in]	channel		Interleaved channel.
+			/// \param[in]	capacity	Buffer capacity, zero removes it.
+			void setChannelBuffer(quint8 channel, int capacity);
+
+			/// Returns the ring buffer of a channel.
+			/// \param[in]	channel	Interleaved channel.
+			/// \return Ring buffer or nullptr if the channel is not used.
+			PacketRingBuffer* getChannelBuffer(quint8 channel) const noexcept;
+
+			/// Processes interleaved data.
+			/// \param[in]	data	Data pointer.
+			/// \param[in]	size	Data size.
+			/// \return Processed data size.
+			size_t feed(const char* data, size_t size) noexcept;
+
+			/// Indicates whether a frame is partially processed.
+			/// \retval true if the demultiplexer is inside a frame.
+			/// \retval false if the demultiplexer expects a new frame.
+			bool isInsideFrame() const noexcept;
+
+			/// Resets framing state and clears ring buffers.
+			void reset() noexcept;
+
+			/// Returns number of delivered frames.
+			/// \return Number of delivered frames.
+			quint64 getFrameCount() const noexcept;
+
+			/// Returns number of frames without a buffer or room.
+			/// \return Number of dropped frames.
+			quint64 getDroppedCount() const noexcept;
+
+		private:
+
+			/// Enumeration that defines framing states.
+			enum class State {
+				Magic,
+				Channel,
+				LengthHigh,
+				LengthLow,
+				Payload
+			};
+
+			/// Number of interleaved channels.
+			static const int CHANNEL_COUNT = 256;
+
+			/// Framing state.
+			State state_ { State::Magic };
+
+			/// Current frame channel.
+			quint8 channel_ { 0 };
+
+			/// Current frame length.
+			quint16 length_ { 0 };
+
+			/// Received size of the current frame.
+			quint16 received_ { 0 };
+
+			/// Reserved space of the current frame.
+			char* target_ { nullptr };
+
+			/// Number of delivered frames.
+			quint64 frames_ { 0 };
+
+			/// Number of dropped frames.
+			quint64 dropped_ { 0 };
+
+			/// Ring buffers by channel.
+			std::unique_ptr<std::unique_ptr<PacketRingBuffer>[]> buffers_;
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,391 @@
+/// \file RTSPKeepAliveScheduler.cpp
+/// \brief Contains classes and functions definitions that provide Real Time
+/// Streaming Protocol (RTSP) keep-alive scheduler.
+/// \bug No known bugs.
+
+#include "RTSPKeepAliveScheduler.hpp"
+
+#include <QElapsedTimer>
+#include <QThreadStorage>
+#include <QTimer>
+
+#include <random>
+#include <vector>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		namespace {
+
+			/// Number of bits of a wheel slot index.
+			/// \details Every level has 64 slots.
+			constexpr int LEVEL_BITS { 6 };
+
+			/// Number of slots of a wheel level.
+			/// \details Derived from the slot index size.
+			constexpr int SLOT_COUNT { 1 << LEVEL_BITS };
+
+			/// Wheel slot index mask.
+			/// \details Derived from the slot index size.
+			constexpr quint64 SLOT_MASK { SLOT_COUNT - 1 };
+
+			/// Number of wheel levels.
+			/// \details Four levels of 100 ms ticks cover more than 19 days.
+			constexpr int LEVEL_COUNT { 4 };
+
+			/// Maximum delay in ticks.
+			/// \details Longer delays are clamped.
+			constexpr quint64 MAXIMUM_TICKS {
+				(quint64(1) << (LEVEL_BITS * LEVEL_COUNT)) - 1
+			};
+
+			/// Index of no entry.
+			/// \details Terminates slot lists.
+			constexpr quint32 NO_ENTRY { 0xFFFFFFFF };
+
+			/// Default session timeout in seconds.
+			/// \details Defined by RFC 2326, section 12.37.
+			constexpr qint64 DEFAULT_SESSION_TIMEOUT { 60 };
+
+			/// Keep-alive jitter divisor.
+			/// \details Keep-alive is due at a random point of the last
+			/// quarter before half of the session timeout.
+			constexpr qint64 JITTER_DIVISOR { 4 };
+		}
+
+		/// Structure that provides private storage.
+		/// \details Maintains private data.
+		struct RTSPKeepAliveScheduler::RTSPKeepAliveSchedulerPrivate final {
+
+			/// Structure that describes a deadline.
+			struct Entry final {
+
+				/// Callback.
+				callback_t callback_;
+
+				/// Deadline in ticks.
+				quint64 deadline_ { 0 };
+
+				/// Generation that tells reused entries apart.
+				quint32 generation_ { 1 };
+
+				/// Previous entry of the slot.
+				quint32 previous_ { NO_ENTRY };
+
+				/// Next entry of the slot.
+				quint32 next_ { NO_ENTRY };
+
+				/// Wheel level or -1 if the entry is free.
+				int level_ { -1 };
+
+				/// Wheel slot.
+				int slot_ { 0 };
+			};
+
+			/// Tick timer.
+			QTimer timer_;
+
+			/// Scheduler clock.
+			QElapsedTimer clock_;
+
+			/// Tick length in milliseconds.
+			int resolution_ { 100 };
+
+			/// Current tick.
+			quint64 now_ { 0 };
+
+			/// Deadline entries.
+			std::vector<Entry> entries_;
+
+			/// Indexes of free entries.
+			std::vector<quint32> free_;
+
+			/// First entries of wheel slots.
+			quint32 heads_[LEVEL_COUNT][SLOT_COUNT];
+
+			/// Number of scheduled deadlines.
+			int count_ { 0 };
+
+			/// Jitter generator.
+			std::mt19937 random_ { std::random_device()() };
+		};
+
+		/// Constructor.
+		/// \details Starts the scheduler clock, the tick timer runs only while
+		/// deadlines are scheduled.
+		/// \param[in]	resolution	Tick length in milliseconds.
+		/// \param[in]	parent		Parent object.
+		RTSPKeepAliveScheduler::RTSPKeepAliveScheduler(int resolution,
+													   QObject* parent)
+			: QObject(parent),
+			  private_(new RTSPKeepAliveSchedulerPrivate) {
+
+			private_->resolution_ = qMax(resolution, 1);
+			private_->clock_.start();
+			private_->timer_.setTimerType(Qt::CoarseTimer);
+
+			for (auto& level : private_->heads_)
+				for (auto& head : level)
+					head = NO_ENTRY;
+
+			connect(
+				&private_->timer_,
+				SIGNAL(timeout()),
+				SLOT(onTick())
+			);
+		}
+
+		/// Destructor.
+		/// \details Drops scheduled deadlines without calling them.
+		RTSPKeepAliveScheduler::~RTSPKeepAliveScheduler() = default;
+
+		/// Returns scheduler shared by the calling thread.
+		/// \details Every thread gets its own scheduler, so callbacks run on
+		/// the thread that scheduled them.
+		/// \return Shared scheduler.
+		RTSPKeepAliveScheduler& RTSPKeepAliveScheduler::shared() {
+			static QThreadStorage<RTSPKeepAliveScheduler*> storage;
+
+			if (!storage.hasLocalData())
+				storage.setLocalData(new RTSPKeepAliveScheduler);
+
+			return *storage.localData();
+		}
+
+		/// Schedules a callback.
+		/// \details The callback runs once, no earlier than the delay and no
+		/// later than one tick after it. The deadline is rounded up to the
+		/// tick boundary of the scheduler clock.
+		/// \param[in]	delay		Delay in milliseconds.
+		/// \param[in]	callback	Callback.
+		/// \return Deadline handle.
+		RTSPKeepAliveScheduler::handle_t RTSPKeepAliveScheduler::schedule(
+			qint64 delay,
+			const callback_t& callback) {
+
+			auto& p = *private_;
+
+			if (p.count_ == 0) {
+				p.now_ = static_cast<quint64>(
+					p.clock_.elapsed() / p.resolution_);
+				p.timer_.start(p.resolution_);
+			}
+
+			auto deadline = static_cast<quint64>(
+				(p.clock_.elapsed() + qMax<qint64>(delay, 0) +
+				 p.resolution_ - 1) / p.resolution_);
+
+			deadline = qBound(p.now_ + 1, deadline, p.now_ + MAXIMUM_TICKS);
+
+			quint32 index;
+
+			if (!p.free_.empty()) {
+				index = p.free_.back();
+				p.free_.pop_back();
+			}
+			else {
+				index = static_cast<quint32>(p.entries_.size());
+				p.entries_.emplace_back();
+			}
+
+			auto& entry = p.entries_[index];
+			entry.callback_ = callback;
+			entry.deadline_ = deadline;
+
+			link(index);
+			++p.count_;
+
+			return (static_cast<handle_t>(entry.generation_) << 32) |
+				   (static_cast<handle_t>(index) + 1);
+		}
+
+		/// Schedules a keep-alive callback for a session.
+		/// \details The delay is half of the session timeout minus a random
+		/// jitter of up to a quarter of it.
+		/// \param[in]	sessionTimeout	Session timeout in seconds or -1 if it
+		///								is unknown.
+		/// \param[in]	callback		Callback.
+		/// \return Deadline handle.
+		RTSPKeepAliveScheduler::handle_t
+		RTSPKeepAliveScheduler::scheduleKeepAlive(qint64 sessionTimeout,
+												  const callback_t& callback) {
+
+			auto timeout = sessionTimeout > 0
+						   ? sessionTimeout
+						   : DEFAULT_SESSION_TIMEOUT;
+
+			auto interval = timeout * 1000 / 2;
+
+			std::uniform_int_distribution<qint64> jitter(
+				0, interval / JITTER_DIVISOR);
+
+			return schedule(interval - jitter(private_->random_), callback);
+		}
+
+		/// Cancels a deadline.
+		/// \details Stale handles of fired or cancelled deadlines are
+		/// rejected.
+		/// \param[in]	handle	Deadline handle.
+		/// \retval true if the deadline was cancelled.
+		/// \retval false if the deadline was not found.
+		bool RTSPKeepAliveScheduler::cancel(handle_t handle) {
+			auto& p = *private_;
+
+			auto index = static_cast<quint32>(handle & 0xFFFFFFFF) - 1;
+			auto generation = static_cast<quint32>(handle >> 32);
+
+			if (handle == 0 || index >= p.entries_.size()) return false;
+
+			auto& entry = p.entries_[index];
+
+			if (entry.level_ < 0 || entry.generation_ != generation)
+				return false;
+
+			unlink(index);
+
+			entry.callback_ = nullptr;
+			++entry.generation_;
+			p.free_.push_back(index);
+
+			if (--p.count_ == 0) p.timer_.stop();
+
+			return true;
+		}
+
+		/// Returns number of scheduled deadlines.
+		/// \details Returns deadline counter.
+		/// \return Number of scheduled deadlines.
+		int RTSPKeepAliveScheduler::getCount() const {
+			return private_->count_;
+		}
+
+		/// Returns tick length.
+		/// \details Returns scheduler resolution.
+		/// \return Tick length in milliseconds.
+		int RTSPKeepAliveScheduler::getResolution() const {
+			return private_->resolution_;
+		}
+
+		/// Performs an action when the tick timer expires.
+		/// \details Catches up with the scheduler clock, so late timer events
+		/// do not delay deadlines.
+		void RTSPKeepAliveScheduler::onTick() {
+			auto& p = *private_;
+
+			auto target = static_cast<quint64>(
+				p.clock_.elapsed() / p.resolution_);
+
+			while (p.count_ > 0 && p.now_ < target) advance();
+
+			if (p.count_ == 0) p.timer_.stop();
+		}
+
+		/// Links an entry into the wheel slot of its deadline.
+		/// \details Level is chosen by the distance to the deadline, slot by
+		/// the deadline bits of that level.
+		/// \param[in]	index	Entry index.
+		void RTSPKeepAliveScheduler::link(quint32 index) {
+			auto& p = *private_;
+			auto& entry = p.entries_[index];
+
+			auto delta = entry.deadline_ - p.now_;
+			auto level = 0;
+
+			while (level + 1 < LEVEL_COUNT &&
+				   delta >> (LEVEL_BITS * (level + 1)))
+				++level;
+
+			auto slot = static_cast<int>(
+				(entry.deadline_ >> (LEVEL_BITS * level)) & SLOT_MASK);
+
+			auto& head = p.heads_[level][slot];
+
+			entry.level_ = level;
+			entry.slot_ = slot;
+			entry.previous_ = NO_ENTRY;
+			entry.next_ = head;
+
+			if (head != NO_ENTRY) p.entries_[head].previous_ = index;
+
+			head = index;
+		}
+
+		/// Unlinks an entry from its wheel slot.
+		/// \details Marks the entry free.
+		/// \param[in]	index	Entry index.
+		void RTSPKeepAliveScheduler::unlink(quint32 index) {
+			auto& p = *private_;
+			auto& entry = p.entries_[index];
+
+			if (entry.previous_ != NO_ENTRY)
+				p.entries_[entry.previous_].next_ = entry.next_;
+			else
+				p.heads_[entry.level_][entry.slot_] = entry.next_;
+
+			if (entry.next_ != NO_ENTRY)
+				p.entries_[entry.next_].previous_ = entry.previous_;
+
+			entry.previous_ = NO_ENTRY;
+			entry.next_ = NO_ENTRY;
+			entry.level_ = -1;
+		}
+
+		/// Moves entries of an upper level slot to lower levels.
+		/// \details Entries of the slot are due within the range of the
+		/// lower level.
+		/// \param[in]	level	Wheel level.
+		/// \param[in]	slot	Wheel slot.
+		void RTSPKeepAliveScheduler::cascade(int level, int slot) {
+			auto& p = *private_;
+
+			auto index = p.heads_[level][slot];
+			p.heads_[level][slot] = NO_ENTRY;
+
+			while (index != NO_ENTRY) {
+				auto next = p.entries_[index].next_;
+				link(index);
+				index = next;
+			}
+		}
+
+		/// Advances the wheel by one tick and runs expired callbacks.
+		/// \details Callbacks may schedule and cancel deadlines.
+		void RTSPKeepAliveScheduler::advance() {
+			auto& p = *private_;
+
+			++p.now_;
+
+			auto top = 0;
+
+			while (top + 1 < LEVEL_COUNT &&
+				   !(p.now_ & ((quint64(1) << (LEVEL_BITS * (top + 1))) - 1)))
+				++top;
+
+			for (auto level = top; level > 0; --level)
+				cascade(level, static_cast<int>(
+					(p.now_ >> (LEVEL_BITS * level)) & SLOT_MASK));
+
+			auto& head = p.heads_[0][p.now_ & SLOT_MASK];
+
+			while (head != NO_ENTRY) {
+				auto index = head;
+				auto& entry = p.entries_[index];
+
+				unlink(index);
+
+				auto callback = std::move(entry.callback_);
+				entry.callback_ = nullptr;
+				++entry.generation_;
+				p.free_.push_back(index);
+				--p.count_;
+
+				if (callback) callback();
+			}
+		}
+	}
+}
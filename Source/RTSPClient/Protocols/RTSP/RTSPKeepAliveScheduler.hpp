@@ -0,0 +1,120 @@
+/// \file RTSPKeepAliveScheduler.hpp
+/// \brief Contains classes and functions declarations that provide Real Time
+/// Streaming Protocol (RTSP) keep-alive scheduler.
+/// \bug No known bugs.
+
+#ifndef RTSPKEEPALIVESCHEDULER_HPP
+#define RTSPKEEPALIVESCHEDULER_HPP
+
+#include "Base/Export.hpp"
+
+#include <QtCore>
+
+#include <functional>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		/// Class that provides RTSP keep-alive scheduler.
+		/// \details Keeps deadlines of many sessions in a hierarchical timing
+		/// wheel driven by a single Qt timer of the owning thread. Inserting
+		/// and cancelling a deadline take constant time, keep-alive deadlines
+		/// are jittered so that sessions opened together do not send their
+		/// requests in bursts.
+		class RTSPCLIENT_EXPORT RTSPKeepAliveScheduler final : public QObject {
+
+			Q_OBJECT
+
+		public:
+
+			/// Callback type.
+			using callback_t = std::function<void()>;
+
+			/// Deadline handle type, zero is never a valid handle.
+			using handle_t = quint64;
+
+		public:
+
+			/// Constructor.
+			/// \param[in]	resolution	Tick length in milliseconds.
+			/// \param[in]	parent		Parent object.
+			explicit RTSPKeepAliveScheduler(int resolution = 100,
+											QObject* parent = nullptr);
+
+			/// Destructor.
+			~RTSPKeepAliveScheduler() override;
+
+		public:
+
+			/// Returns scheduler shared by the calling thread.
+			/// \return Shared scheduler.
+			static RTSPKeepAliveScheduler& shared();
+
+			/// Schedules a callback.
+			/// \param[in]	delay		Delay in milliseconds.
+			/// \param[in]	callback	Callback.
+			/// \return Deadline handle.
+			handle_t schedule(qint64 delay, const callback_t& callback);
+
+			/// Schedules a keep-alive callback for a session.
+			/// \param[in]	sessionTimeout	Session timeout in seconds or -1 if
+			///								it is unknown.
+			/// \param[in]	callback		Callback.
+			/// \return Deadline handle.
+			handle_t scheduleKeepAlive(qint64 sessionTimeout,
+									   const callback_t& callback);
+
+			/// Cancels a deadline.
+			/// \param[in]	handle	Deadline handle.
+			/// \retval true if the deadline was cancelled.
+			/// \retval false if the deadline was not found.
+			bool cancel(handle_t handle);
+
+			/// Returns number of scheduled deadlines.
+			/// \return Number of scheduled deadlines.
+			int getCount() const;
+
+			/// Returns tick length.
+			/// \return Tick length in milliseconds.
+			int getResolution() const;
+
+		private slots:
+
+			/// Performs an action when the tick timer expires.
+			void onTick();
+
+		private:
+
+			/// Links an entry into the wheel slot of its deadline.
+			/// \param[in]	index	Entry index.
+			void link(quint32 index);
+
+			/// Unlinks an entry from its wheel slot.
+			/// \param[in]	index	Entry index.
+			void unlink(quint32 index);
+
+			/// Moves entries of an upper level slot to lower levels.
+			/// \param[in]	level	Wheel level.
+			/// \param[in]	slot	Wheel slot.
+			void cascade(int level, int slot);
+
+			/// Advances the wheel by one tick and runs expired callbacks.
+			void advance();
+
+		private:
+
+			/// Opaque type for private data.
+			struct RTSPKeepAliveSchedulerPrivate;
+
+			/// Private data.
+			const QScopedPointer<RTSPKeepAliveSchedulerPrivate> private_;
+		};
+	}
+}
+
+#endif
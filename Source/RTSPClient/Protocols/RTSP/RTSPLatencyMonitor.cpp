@@ -0,0 +1,145 @@
+/// \file RTSPLatencyMonitor.cpp
+/// \brief Contains classes and functions definitions that provide Real Time
+/// Streaming Protocol (RTSP) process-wide request latency monitor.
+/// \bug No known bugs.
+
+#include "RTSPLatencyMonitor.hpp"
+#include "Utilities/LatencyHistogram.hpp"
+
+#include <atomic>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		/// Structure that provides private storage.
+		/// \details Maintains private data.
+		struct RTSPLatencyMonitor::RTSPLatencyMonitorPrivate final {
+
+			/// Returns histogram of a request phase.
+			/// \param[in]	method	RTSP method.
+			/// \param[in]	phase	Request phase.
+			/// \return Latency histogram.
+			LatencyHistogram& histogram(RTSPMethod method,
+										RTSPLatencyPhase phase) {
+				return histograms_[static_cast<int>(method)]
+								  [static_cast<int>(phase)];
+			}
+
+			/// Whether the monitor is enabled.
+			std::atomic<bool> enabled_ { true };
+
+			/// Latency histograms indexed by method and phase.
+			LatencyHistogram histograms_[RTSP_METHOD_COUNT]
+										[RTSP_LATENCY_PHASE_COUNT];
+		};
+
+		/// Returns process-wide latency monitor.
+		/// \details Created on first use.
+		/// \return Latency monitor.
+		RTSPLatencyMonitor& RTSPLatencyMonitor::instance() {
+			static RTSPLatencyMonitor monitor;
+			return monitor;
+		}
+
+		/// Default constructor.
+		/// \details Creates empty histograms.
+		RTSPLatencyMonitor::RTSPLatencyMonitor()
+			: private_(new RTSPLatencyMonitorPrivate) {
+
+		}
+
+		/// Destructor.
+		/// \details Releases histograms.
+		RTSPLatencyMonitor::~RTSPLatencyMonitor() = default;
+
+		/// Indicates whether the monitor is enabled.
+		/// \details Returns enabled flag.
+		/// \retval true if the monitor is enabled.
+		/// \retval false if the monitor is disabled.
+		bool RTSPLatencyMonitor::isEnabled() const {
+			return private_->enabled_.load(std::memory_order_relaxed);
+		}
+
+		/// Enables or disables the monitor.
+		/// \details Clients keep the timing of their last request either
+		/// way, only the histograms stop being filled.
+		/// \param[in]	enabled	Whether the monitor is enabled.
+		void RTSPLatencyMonitor::setEnabled(bool enabled) {
+			private_->enabled_.store(enabled, std::memory_order_relaxed);
+		}
+
+		/// Records timing of a finished request.
+		/// \details Phases that are not reached are skipped. Safe to call
+		/// from any thread.
+		/// \param[in]	method	RTSP method.
+		/// \param[in]	timing	Request timing.
+		void RTSPLatencyMonitor::record(RTSPMethod method,
+										const RTSPRequestTiming& timing) {
+			if (!isEnabled()) return;
+
+			auto& p = *private_;
+
+			p.histogram(method, RTSPLatencyPhase::Lookup)
+				.record(timing.lookup_);
+
+			p.histogram(method, RTSPLatencyPhase::Connect)
+				.record(timing.connect_);
+
+			p.histogram(method, RTSPLatencyPhase::FirstByte)
+				.record(timing.firstByte_);
+
+			p.histogram(method, RTSPLatencyPhase::Total)
+				.record(timing.total_);
+		}
+
+		/// Returns latency distribution of a request phase.
+		/// \details Safe to call from any thread while requests are being
+		/// recorded.
+		/// \param[in]	method	RTSP method.
+		/// \param[in]	phase	Request phase.
+		/// \return Latency summary.
+		RTSPLatencySummary RTSPLatencyMonitor::getSummary(
+			RTSPMethod method,
+			RTSPLatencyPhase phase) const {
+
+			const auto& histogram = getHistogram(method, phase);
+
+			RTSPLatencySummary summary;
+			summary.count_		= histogram.getCount();
+			summary.minimum_	= histogram.getMinimum();
+			summary.mean_		= histogram.getMean();
+			summary.p50_		= histogram.getPercentile(50);
+			summary.p90_		= histogram.getPercentile(90);
+			summary.p99_		= histogram.getPercentile(99);
+			summary.p999_		= histogram.getPercentile(99.9);
+			summary.maximum_	= histogram.getMaximum();
+
+			return summary;
+		}
+
+		/// Returns latency histogram of a request phase.
+		/// \details The histogram lives as long as the monitor.
+		/// \param[in]	method	RTSP method.
+		/// \param[in]	phase	Request phase.
+		/// \return Latency histogram.
+		const LatencyHistogram& RTSPLatencyMonitor::getHistogram(
+			RTSPMethod method,
+			RTSPLatencyPhase phase) const {
+
+			return private_->histogram(method, phase);
+		}
+
+		/// Removes all recorded timings.
+		/// \details Must not be called while requests are being recorded.
+		void RTSPLatencyMonitor::reset() {
+			for (auto& method : private_->histograms_)
+				for (auto& histogram : method)
+					histogram.reset();
+		}
+	}
+}
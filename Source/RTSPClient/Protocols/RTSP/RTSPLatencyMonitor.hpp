@@ -0,0 +1,102 @@
+/// \file RTSPLatencyMonitor.hpp
+/// \brief Contains classes and functions declarations that provide Real Time
+/// Streaming Protocol (RTSP) process-wide request latency monitor.
+/// \bug No known bugs.
+
+#ifndef RTSPLATENCYMONITOR_HPP
+#define RTSPLATENCYMONITOR_HPP
+
+#include "AbstractRTSPClient.hpp"
+#include "RTSPRequestTiming.hpp"
+#include "Base/Export.hpp"
+
+#include <QtCore>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		class LatencyHistogram;
+
+		/// Class that provides process-wide RTSP request latency monitor.
+		/// \details Keeps a latency histogram for every RTSP method and
+		/// request phase, filled by all clients of the process regardless of
+		/// the backend. Recording takes a few relaxed atomic operations and
+		/// no locks, so the monitor is enabled by default.
+		class RTSPCLIENT_EXPORT RTSPLatencyMonitor final {
+		public:
+
+			/// Returns process-wide latency monitor.
+			/// \return Latency monitor.
+			static RTSPLatencyMonitor& instance();
+
+		public:
+
+			/// Destructor.
+			~RTSPLatencyMonitor();
+
+			/// Copy constructor.
+			/// \param[in]	object	Object to copy.
+			RTSPLatencyMonitor(const RTSPLatencyMonitor& object) = delete;
+
+			/// Copy assignment operator.
+			/// \param[in]	object	Object to copy.
+			/// \return This object.
+			RTSPLatencyMonitor& operator=(
+				const RTSPLatencyMonitor& object) = delete;
+
+		public:
+
+			/// Indicates whether the monitor is enabled.
+			/// \retval true if the monitor is enabled.
+			/// \retval false if the monitor is disabled.
+			bool isEnabled() const;
+
+			/// Enables or disables the monitor.
+			/// \param[in]	enabled	Whether the monitor is enabled.
+			void setEnabled(bool enabled);
+
+			/// Records timing of a finished request.
+			/// \param[in]	method	RTSP method.
+			/// \param[in]	timing	Request timing.
+			void record(RTSPMethod method, const RTSPRequestTiming& timing);
+
+			/// Returns latency distribution of a request phase.
+			/// \param[in]	method	RTSP method.
+			/// \param[in]	phase	Request phase.
+			/// \return Latency summary.
+			RTSPLatencySummary getSummary(RTSPMethod method,
+										  RTSPLatencyPhase phase) const;
+
+			/// Returns latency histogram of a request phase.
+			/// \param[in]	method	RTSP method.
+			/// \param[in]	phase	Request phase.
+			/// \return Latency histogram.
+			const LatencyHistogram& getHistogram(
+				RTSPMethod method,
+				RTSPLatencyPhase phase) const;
+
+			/// Removes all recorded timings.
+			void reset();
+
+		private:
+
+			/// Default constructor.
+			explicit RTSPLatencyMonitor();
+
+		private:
+
+			/// Opaque type for private data.
+			struct RTSPLatencyMonitorPrivate;
+
+			/// Private data.
+			const QScopedPointer<RTSPLatencyMonitorPrivate> private_;
+		};
+	}
+}
+
+#endif
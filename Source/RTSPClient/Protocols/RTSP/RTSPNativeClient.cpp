@@ -0,0 +1,1206 @@
+/// \file RTSPNativeClient.cpp
+/// \brief Contains classes and functions definitions that provide Real Time
+/// Streaming Protocol (RTSP) native client backend.
+/// \bug No known bugs.
+
+#include "RTSPNativeClient.hpp"
+#include "AbstractRTSPClientBase.hpp"
+#include "RTSPKeepAliveScheduler.hpp"
+#include "RTSPSessionCache.hpp"
+
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QHostAddress>
+#include <QQueue>
+#include <QRandomGenerator>
+#include <QTcpSocket>
+#include <QUrl>
+#include <QVector>
+
+#include <algorithm>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		namespace {
+
+			/// Default RTSP port.
+			/// \details Defined by RFC 2326, section 3.2.
+			constexpr int DEFAULT_PORT { 554 };
+
+			/// Interleaved frame header size.
+			/// \details Magic byte, channel and 16-bit length.
+			constexpr int INTERLEAVED_HEADER_SIZE { 4 };
+
+			/// RTSP method names.
+			/// \details Indexed by RTSPMethod values.
+			const char* const METHOD_NAMES[] {
+				"OPTIONS",
+				"DESCRIBE",
+				"ANNOUNCE",
+				"SETUP",
+				"PLAY",
+				"PAUSE",
+				"TEARDOWN",
+				"GET_PARAMETER",
+				"SET_PARAMETER",
+				"RECORD"
+			};
+
+			/// Returns name of an RTSP method.
+			/// \param[in]	method	RTSP method.
+			/// \return Method name.
+			const char* methodName(RTSPMethod method) {
+				return METHOD_NAMES[static_cast<int>(method)];
+			}
+
+			/// Indicates whether a method requires an established session.
+			/// \param[in]	method	RTSP method.
+			/// \retval true if the method requires a session.
+			/// \retval false otherwise.
+			bool needsSession(RTSPMethod method) {
+				switch (method) {
+				case RTSPMethod::Play:
+				case RTSPMethod::Pause:
+				case RTSPMethod::Teardown:
+				case RTSPMethod::GetParameter:
+				case RTSPMethod::SetParameter:
+				case RTSPMethod::Record:
+					return true;
+				default:
+					return false;
+				}
+			}
+
+			/// Returns MD5 digest in hexadecimal form.
+			/// \param[in]	data	Data to hash.
+			/// \return Hexadecimal digest.
+			QByteArray md5(const QByteArray& data) {
+				return QCryptographicHash::hash(
+					data, QCryptographicHash::Md5).toHex();
+			}
+
+			/// Returns parameter of an authentication challenge.
+			/// \param[in]	challenge	WWW-Authenticate header value.
+			/// \param[in]	name		Parameter name.
+			/// \return Parameter value without quotes.
+			QByteArray challengeParameter(const QByteArray& challenge,
+										  const QByteArray& name) {
+
+				auto lower = challenge.toLower();
+				auto key = name.toLower() + '=';
+
+				for (auto index = lower.indexOf(key);
+					 index >= 0;
+					 index = lower.indexOf(key, index + 1)) {
+
+					if (index > 0 &&
+						lower[index - 1] != ' ' &&
+						lower[index - 1] != ',')
+						continue;
+
+					auto begin = index + key.size();
+
+					if (begin < challenge.size() && challenge[begin] == '"') {
+						auto end = challenge.indexOf('"', begin + 1);
+						if (end < 0) end = challenge.size();
+
+						return challenge.mid(begin + 1, end - begin - 1);
+					}
+
+					auto end = challenge.indexOf(',', begin);
+					if (end < 0) end = challenge.size();
+
+					return challenge.mid(begin, end - begin).trimmed();
+				}
+
+				return { };
+			}
+		}
+
+		/// Structure that describes a request.
+		/// \details Holds everything needed to send the request again.
+		struct RTSPNativeClient::Request final {
+
+			/// RTSP method.
+			RTSPMethod method_ { RTSPMethod::Options };
+
+			/// Request URI.
+			QByteArray uri_;
+
+			/// Transport header value of SETUP request.
+			QByteArray transport_;
+
+			/// Completion callback.
+			completion_t completion_;
+
+			/// Whether the request was repeated with credentials.
+			bool retried_ { false };
+
+			/// Whether the request carried credentials.
+			bool authorized_ { false };
+
+			/// Submission time in microseconds of the client clock.
+			qint64 started_ { -1 };
+
+			/// Time in microseconds of the client clock when the request
+			/// fails, or -1 if it waits without limit.
+			qint64 deadline_ { -1 };
+
+			/// Time in microseconds of the client clock when the response
+			/// started to arrive.
+			qint64 firstByte_ { -1 };
+		};
+
+		/// Structure that provides private storage.
+		/// \details Maintains private data.
+		struct RTSPNativeClient::RTSPNativeClientPrivate final {
+
+			/// Enumeration that defines input states.
+			enum class Input {
+				Message,
+				Body,
+				Interleaved
+			};
+
+			/// Constructor.
+			/// \param[in]	owner	Client that owns the backend.
+			explicit RTSPNativeClientPrivate(RTSPClientBase& owner)
+				: owner_(owner) { }
+
+			/// Client that owns the backend.
+			RTSPClientBase& owner_;
+
+			/// RTSP connection.
+			QTcpSocket socket_;
+
+			/// Keep-alive deadline.
+			RTSPKeepAliveScheduler::handle_t keepAlive_ { 0 };
+
+			/// Deadline of the earliest request in progress.
+			RTSPKeepAliveScheduler::handle_t timeout_ { 0 };
+
+			/// Server host.
+			QString host_;
+
+			/// Server port.
+			quint16 port_ { DEFAULT_PORT };
+
+			/// Whether the connection used a cached host address.
+			bool cached_ { false };
+
+			/// Clock of request timing.
+			QElapsedTimer clock_;
+
+			/// Time in microseconds when the host name was resolved.
+			qint64 lookedUp_ { -1 };
+
+			/// Time in microseconds when the connection was established.
+			qint64 connected_ { -1 };
+
+			/// Request URL without user information.
+			QByteArray requestUrl_;
+
+			/// Whether the client is open.
+			bool open_ { false };
+
+			/// Last sequence number.
+			qint64 sequence_ { 0 };
+
+			/// Requests waiting to be sent.
+			QQueue<Request> waiting_;
+
+			/// Requests waiting for responses.
+			QQueue<Request> sent_;
+
+			/// Finished requests waiting for completion callbacks.
+			QVector<QPair<completion_t, RTSPStatusCode>> finished_;
+
+			/// Response parser.
+			RTSPResponseParser parser_;
+
+			/// Received data.
+			QByteArray input_;
+
+			/// Request data.
+			QByteArray output_;
+
+			/// Response body.
+			QByteArray body_;
+
+			/// Input state.
+			Input state_ { Input::Message };
+
+			/// Whether input is at a message boundary.
+			bool boundary_ { true };
+
+			/// Remaining response body size.
+			qint64 bodyRemaining_ { 0 };
+
+			/// Remaining interleaved frame size.
+			int interleavedRemaining_ { 0 };
+
+			/// Authentication scheme.
+			QByteArray scheme_;
+
+			/// Digest realm.
+			QByteArray realm_;
+
+			/// Digest nonce.
+			QByteArray nonce_;
+
+			/// Digest opaque value.
+			QByteArray opaque_;
+
+			/// Whether Digest quality of protection is used.
+			bool qop_ { false };
+
+			/// Digest nonce count.
+			quint32 nonceCount_ { 0 };
+
+			/// Number of requests sent before the previous response.
+			quint64 pipelined_ { 0 };
+
+			/// Handler of delivered interleaved data.
+			std::function<void()> receiveHandler_;
+
+			/// Returns current time of the client clock.
+			/// \return Time in microseconds.
+			qint64 now() const { return clock_.nsecsElapsed() / 1000; }
+		};
+
+		/// Constructor.
+		/// \details Connects socket signals and starts the clock of request
+		/// timing.
+		/// \param[in]	owner	Client that owns the backend.
+		/// \param[in]	parent	Parent object.
+		RTSPNativeClient::RTSPNativeClient(RTSPClientBase& owner,
+										   QObject* parent)
+			: QObject(parent),
+			  private_(new RTSPNativeClientPrivate(owner)) {
+
+			private_->socket_.setParent(this);
+			private_->clock_.start();
+
+			connect(
+				&private_->socket_,
+				SIGNAL(connected()),
+				SLOT(onConnected())
+			);
+
+			connect(
+				&private_->socket_,
+				SIGNAL(readyRead()),
+				SLOT(onReadyRead())
+			);
+
+			connect(
+				&private_->socket_,
+				SIGNAL(disconnected()),
+				SLOT(onDisconnected())
+			);
+
+			connect(
+				&private_->socket_,
+				SIGNAL(error(QAbstractSocket::SocketError)),
+				SLOT(onDisconnected())
+			);
+
+			connect(
+				&private_->socket_,
+				&QAbstractSocket::stateChanged,
+				this,
+				[this](QAbstractSocket::SocketState state) {
+					if (state == QAbstractSocket::ConnectingState &&
+						private_->lookedUp_ < 0)
+						private_->lookedUp_ = private_->now();
+				}
+			);
+		}
+
+		/// Destructor.
+		/// \details Closes the client.
+		RTSPNativeClient::~RTSPNativeClient() {
+			close();
+		}
+
+		/// Opens the client.
+		/// \details Parses the URL. The connection is established by the
+		/// first request. Credentials embedded in the URL are used when the
+		/// owner has none.
+		/// \param[in]	url	RTSP connection URL.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool RTSPNativeClient::open(const QByteArray& url) {
+			close();
+
+			auto& base = private_->owner_.private_;
+			auto parsed = QUrl::fromEncoded(url);
+
+			if (!parsed.isValid() || parsed.host().isEmpty()) return false;
+
+			private_->host_ = parsed.host();
+			private_->port_ = static_cast<quint16>(parsed.port(DEFAULT_PORT));
+			private_->requestUrl_ = RTSPClientBase::trimUrl(
+				parsed.toEncoded(QUrl::RemoveUserInfo));
+
+			base.connectionUrl_ = RTSPClientBase::trimUrl(url);
+
+			if (base.userCredentials_.first.isEmpty() &&
+				!parsed.userName().isEmpty())
+				base.userCredentials_ = {
+					parsed.userName().toUtf8(),
+					parsed.password().toUtf8()
+				};
+
+			private_->open_ = true;
+
+			return true;
+		}
+
+		/// Closes the client.
+		/// \details Drops the connection and fails requests in progress.
+		void RTSPNativeClient::close() {
+			private_->open_ = false;
+			cancelKeepAlive();
+			private_->socket_.abort();
+
+			fail();
+
+			private_->sequence_ = 0;
+			private_->scheme_.clear();
+			private_->realm_.clear();
+			private_->nonce_.clear();
+			private_->opaque_.clear();
+			private_->qop_ = false;
+			private_->nonceCount_ = 0;
+		}
+
+		/// Drops the connection, keeping authentication state.
+		/// \details Fails requests in progress. The next request connects
+		/// again and starts a new CSeq sequence.
+		void RTSPNativeClient::reconnect() {
+			cancelKeepAlive();
+			private_->socket_.abort();
+
+			fail();
+
+			private_->sequence_ = 0;
+		}
+
+		/// Moves the client to another thread.
+		/// \details Must be called from the owning thread. The connection
+		/// moves with the client, keep-alive is stopped until attach() is
+		/// called from the target thread.
+		/// \param[in]	thread	Target thread.
+		/// \retval true on success.
+		/// \retval false if a request is in progress.
+		bool RTSPNativeClient::detach(QThread* thread) {
+			if (!thread || isPending()) return false;
+
+			cancelKeepAlive();
+			cancelTimeout();
+			moveToThread(thread);
+
+			return true;
+		}
+
+		/// Resumes the client on the thread it was moved to.
+		/// \details Schedules keep-alive on the timing wheel of the thread.
+		void RTSPNativeClient::attach() {
+			scheduleKeepAlive();
+		}
+
+		/// Indicates whether the client is open.
+		/// \details Returns open flag.
+		/// \retval true if the client is open.
+		/// \retval false if the client is closed.
+		bool RTSPNativeClient::isOpen() const {
+			return private_->open_;
+		}
+
+		/// Returns RTSP connection socket.
+		/// \details Returns descriptor of the native connection.
+		/// \return Socket descriptor or -1 if there is no connection.
+		qintptr RTSPNativeClient::getSocket() const {
+			return private_->socket_.socketDescriptor();
+		}
+
+		/// Returns address of the RTSP server.
+		/// \details Returns peer address of the native connection.
+		/// \return Server address or null address if there is no
+		/// connection.
+		QHostAddress RTSPNativeClient::getServerAddress() const {
+			return private_->socket_.peerAddress();
+		}
+
+		/// Indicates whether a request is in progress.
+		/// \details Checks request queues.
+		/// \retval true if a request is in progress.
+		/// \retval false if no request is in progress.
+		bool RTSPNativeClient::isPending() const {
+			return !private_->waiting_.isEmpty() ||
+				   !private_->sent_.isEmpty();
+		}
+
+		/// Returns number of requests sent before the previous response.
+		/// \details Counts requests that saved a round-trip.
+		/// \return Number of pipelined requests.
+		quint64 RTSPNativeClient::getPipelinedCount() const {
+			return private_->pipelined_;
+		}
+
+		/// Sets handler of delivered interleaved data.
+		/// \details The handler is called after every chunk of the connection
+		/// that carried interleaved frames.
+		/// \param[in]	handler	Handler called after interleaved data is
+		///						stored in channel buffers.
+		void RTSPNativeClient::setReceiveHandler(
+			const std::function<void()>& handler) {
+
+			private_->receiveHandler_ = handler;
+		}
+
+		/// Sends a request and waits for the response.
+		/// \details Waits on the connection without running the event loop.
+		/// Operation timeout of the owner limits the wait, on timeout the
+		/// connection is dropped.
+		/// \param[in]	method		RTSP method.
+		/// \param[in]	path		Media track path.
+		/// \param[in]	channels	Channels for RTP and RTCP data.
+		/// \return RTSP status code.
+		RTSPStatusCode RTSPNativeClient::perform(
+			RTSPMethod method,
+			const QByteArray& path,
+			const QPair<quint16, quint16>& channels) {
+
+			auto done = false;
+			auto status = RTSPStatusCode::Error;
+
+			auto submitted = submit(
+				method,
+				[&done, &status](RTSPStatusCode result) {
+					done = true;
+					status = result;
+				},
+				path,
+				channels);
+
+			if (!submitted) return RTSPStatusCode::Error;
+
+			auto timeouts = private_->owner_.private_.operationTimeouts_;
+			auto& socket = private_->socket_;
+
+			QElapsedTimer timer;
+			timer.start();
+
+			while (!done) {
+				auto limit = -1;
+
+				if (timeouts.second > 0) {
+					auto remaining = timeouts.second - timer.elapsed();
+					if (remaining <= 0) break;
+					limit = static_cast<int>(remaining);
+				}
+
+				if (socket.state() == QAbstractSocket::UnconnectedState)
+					break;
+
+				if (socket.state() != QAbstractSocket::ConnectedState) {
+					if (timeouts.first > 0)
+						limit = limit < 0
+								? static_cast<int>(timeouts.first)
+								: qMin(limit, static_cast<int>(timeouts.first));
+
+					if (!socket.waitForConnected(limit)) break;
+				}
+				else if (!socket.waitForReadyRead(limit)) break;
+			}
+
+			if (!done) {
+				socket.abort();
+				fail();
+			}
+
+			return status;
+		}
+
+		/// Sends a request without waiting for the response.
+		/// \details The request is queued and written as soon as the
+		/// connection allows it, without waiting for responses to earlier
+		/// requests. Requests that need a session wait only for the first
+		/// SETUP response. Operation timeout of the owner limits the time
+		/// to the response, on timeout the connection is dropped and the
+		/// requests in progress fail.
+		/// \param[in]	method		RTSP method.
+		/// \param[in]	completion	Completion callback.
+		/// \param[in]	path		Media track path.
+		/// \param[in]	channels	Channels for RTP and RTCP data.
+		/// \retval true if the request was started.
+		/// \retval false on error.
+		bool RTSPNativeClient::submit(RTSPMethod method,
+									  const completion_t& completion,
+									  const QByteArray& path,
+									  const QPair<quint16, quint16>& channels) {
+
+			auto& base = private_->owner_.private_;
+
+			if (!private_->open_) return false;
+
+			auto supported =
+				method == RTSPMethod::Options ||
+				(base.supportedMethods_ &
+				 RTSPResponseParser::getMethodMask(method)) ||
+				(base.fastStart_ && !base.supportedMethods_);
+
+			if (!supported) return false;
+
+			auto setup = [](const Request& request) {
+				return request.method_ == RTSPMethod::Setup;
+			};
+
+			if (needsSession(method) &&
+				base.currentSession_.isEmpty() &&
+				std::none_of(private_->sent_.cbegin(),
+							 private_->sent_.cend(), setup) &&
+				std::none_of(private_->waiting_.cbegin(),
+							 private_->waiting_.cend(), setup))
+				return false;
+
+			Request request;
+			request.method_ = method;
+			request.completion_ = completion;
+			request.uri_ = private_->requestUrl_;
+			request.started_ = private_->now();
+
+			if (base.operationTimeouts_.second > 0)
+				request.deadline_ = request.started_ +
+									base.operationTimeouts_.second * 1000;
+
+			if (method == RTSPMethod::Setup) {
+				request.uri_ += '/' + RTSPClientBase::trimUrl(path);
+
+				request.transport_ =
+					(base.transport_ == RTSPTransport::TCP
+					 ? QByteArray("RTP/AVP/TCP;unicast;interleaved=")
+					 : QByteArray("RTP/AVP/UDP;unicast;client_port=")) +
+					QByteArray::number(channels.first) +
+					QByteArray("-") +
+					QByteArray::number(channels.second);
+			}
+
+			private_->waiting_.enqueue(request);
+
+			if (!private_->timeout_) scheduleTimeout();
+
+			flush();
+
+			return true;
+		}
+
+		/// Processes data available on the connection.
+		/// \details Data is normally processed from the event loop, this
+		/// function lets the caller poll the connection.
+		/// \return RTSP status code.
+		RTSPStatusCode RTSPNativeClient::receive() {
+			if (!private_->open_ ||
+				private_->socket_.state() != QAbstractSocket::ConnectedState)
+				return RTSPStatusCode::Error;
+
+			onReadyRead();
+
+			return RTSPStatusCode::Ok;
+		}
+
+		/// Performs an action when the connection is established.
+		/// \details Stores the resolved host address in the session cache
+		/// and sends queued requests.
+		void RTSPNativeClient::onConnected() {
+			private_->connected_ = private_->now();
+
+			if (!private_->cached_)
+				RTSPSessionCache::instance().store(
+					private_->host_.toUtf8(),
+					private_->port_,
+					private_->socket_.peerAddress().toString().toUtf8());
+
+			flush();
+		}
+
+		/// Performs an action when the connection has data.
+		/// \details Appends available data to the input buffer and processes
+		/// it.
+		void RTSPNativeClient::onReadyRead() {
+			auto& socket = private_->socket_;
+			auto& input = private_->input_;
+
+			auto available = socket.bytesAvailable();
+			if (available <= 0) return;
+
+			auto offset = input.size();
+			input.resize(offset + static_cast<int>(available));
+
+			auto read = socket.read(input.data() + offset, available);
+			input.resize(offset + static_cast<int>(qMax<qint64>(read, 0)));
+
+			process();
+		}
+
+		/// Performs an action when the connection is lost.
+		/// \details Fails requests in progress. The next request connects
+		/// again, the session stays valid on the server until it times out.
+		void RTSPNativeClient::onDisconnected() {
+			cancelKeepAlive();
+
+			fail();
+		}
+
+		/// Performs an action when keep-alive is due.
+		/// \details Sends GET_PARAMETER, or OPTIONS if the server does not
+		/// support it, unless other requests keep the session alive.
+		void RTSPNativeClient::onKeepAlive() {
+			auto& base = private_->owner_.private_;
+
+			private_->keepAlive_ = 0;
+
+			if (base.currentSession_.isEmpty()) return;
+
+			if (isPending()) {
+				scheduleKeepAlive();
+				return;
+			}
+
+			auto method =
+				base.supportedMethods_ &
+				RTSPResponseParser::getMethodMask(RTSPMethod::GetParameter)
+				? RTSPMethod::GetParameter
+				: RTSPMethod::Options;
+
+			submit(method, nullptr);
+		}
+
+		/// Performs an action when a request deadline is due.
+		/// \details Drops the connection and fails requests in progress if
+		/// one of them timed out, as perform() does, otherwise schedules
+		/// the next deadline.
+		void RTSPNativeClient::onTimeout() {
+			auto& p = *private_;
+			auto now = p.now();
+
+			p.timeout_ = 0;
+
+			auto expired = [now](const Request& request) {
+				return request.deadline_ >= 0 && request.deadline_ <= now;
+			};
+
+			if (std::none_of(p.sent_.cbegin(), p.sent_.cend(), expired) &&
+				std::none_of(p.waiting_.cbegin(), p.waiting_.cend(),
+							 expired)) {
+				scheduleTimeout();
+				return;
+			}
+
+			p.socket_.abort();
+
+			fail();
+		}
+
+		/// Sends requests that are allowed to go out.
+		/// \details Connects on demand. A request that needs a session is
+		/// held while the first SETUP response is outstanding, and so is
+		/// the next SETUP, so that it joins the same session.
+		void RTSPNativeClient::flush() {
+			auto& base = private_->owner_.private_;
+			auto& socket = private_->socket_;
+
+			if (private_->waiting_.isEmpty()) return;
+
+			if (socket.state() == QAbstractSocket::UnconnectedState) {
+				connectToHost();
+				return;
+			}
+
+			if (socket.state() != QAbstractSocket::ConnectedState) return;
+
+			auto setupSent = std::any_of(
+				private_->sent_.cbegin(),
+				private_->sent_.cend(),
+				[](const Request& request) {
+					return request.method_ == RTSPMethod::Setup;
+				});
+
+			while (!private_->waiting_.isEmpty()) {
+				auto method = private_->waiting_.head().method_;
+
+				if ((needsSession(method) || method == RTSPMethod::Setup)	&&
+					base.currentSession_.isEmpty()							&&
+					setupSent)
+					break;
+
+				auto request = private_->waiting_.dequeue();
+				send(request);
+
+				setupSent = setupSent || method == RTSPMethod::Setup;
+			}
+		}
+
+		/// Starts connecting to the server.
+		/// \details Uses a host address cached by any client of the process,
+		/// so only the first connection to a host waits for the resolver.
+		/// An address in the URL needs no lookup and skips the cache. The
+		/// native backend does not share connections between clients.
+		void RTSPNativeClient::connectToHost() {
+			auto& cache = RTSPSessionCache::instance();
+			auto& p = *private_;
+
+			QByteArray address;
+			QHostAddress literal;
+
+			p.cached_ = cache.isEnabled() && !literal.setAddress(p.host_) &&
+						cache.lookup(p.host_.toUtf8(), p.port_, address);
+
+			cache.recordConnection(false);
+
+			p.connected_ = -1;
+			p.lookedUp_ = p.cached_ ? p.now() : -1;
+
+			if (p.cached_)
+				p.socket_.connectToHost(
+					QHostAddress(QString::fromUtf8(address)), p.port_);
+			else
+				p.socket_.connectToHost(p.host_, p.port_);
+		}
+
+		/// Writes a request to the connection.
+		/// \details Builds the request in a reused buffer. Authorization is
+		/// added once the server challenged the client.
+		/// \param[in]	request	Request.
+		void RTSPNativeClient::send(Request& request) {
+			auto& base = private_->owner_.private_;
+			auto& output = private_->output_;
+
+			output.resize(0);
+			output += methodName(request.method_);
+			output += ' ';
+			output += request.uri_;
+			output += " RTSP/1.0\r\nCSeq: ";
+			output += QByteArray::number(++private_->sequence_);
+			output += "\r\n";
+
+			if (!base.userAgent_.isEmpty()) {
+				output += "User-Agent: ";
+				output += base.userAgent_;
+				output += "\r\n";
+			}
+
+			if (!base.currentSession_.isEmpty()) {
+				output += "Session: ";
+				output += base.currentSession_;
+				output += "\r\n";
+			}
+
+			request.authorized_ = !private_->scheme_.isEmpty();
+			request.firstByte_ = -1;
+
+			if (request.authorized_) {
+				output += "Authorization: ";
+				output += authorization(request);
+				output += "\r\n";
+			}
+
+			if (request.method_ == RTSPMethod::Setup) {
+				output += "Transport: ";
+				output += request.transport_;
+				output += "\r\n";
+			}
+
+			if (request.method_ == RTSPMethod::Describe)
+				output += "Accept: application/sdp\r\n";
+
+			output += "\r\n";
+
+			private_->socket_.write(output);
+
+			if (!private_->sent_.isEmpty()) ++private_->pipelined_;
+
+			private_->sent_.enqueue(request);
+
+			scheduleKeepAlive();
+		}
+
+		/// Splits received data into responses and interleaved frames.
+		/// \details Interleaved frames start with '$' at a message boundary
+		/// and go straight to the demultiplexer of the owner. Completion
+		/// callbacks run after the input is consumed, so they may send new
+		/// requests or close the client.
+		void RTSPNativeClient::process() {
+			auto& base = private_->owner_.private_;
+			auto& p = *private_;
+
+			auto data = p.input_.constData();
+			auto size = p.input_.size();
+			auto position = 0;
+			auto delivered = false;
+
+			while (position < size) {
+				auto available = size - position;
+
+				if (p.state_ == RTSPNativeClientPrivate::Input::Message) {
+					if (p.boundary_ && data[position] == '$') {
+						if (available < INTERLEAVED_HEADER_SIZE) break;
+
+						p.interleavedRemaining_ =
+							INTERLEAVED_HEADER_SIZE +
+							(static_cast<quint8>(data[position + 2]) << 8 |
+							 static_cast<quint8>(data[position + 3]));
+
+						p.state_ = RTSPNativeClientPrivate::Input::Interleaved;
+						continue;
+					}
+
+					if (p.boundary_ &&
+						!p.sent_.isEmpty() &&
+						p.sent_.head().firstByte_ < 0)
+						p.sent_.head().firstByte_ = p.now();
+
+					p.boundary_ = false;
+					position += static_cast<int>(p.parser_.feed(
+						data + position, static_cast<size_t>(available)));
+
+					if (!p.parser_.isComplete()) continue;
+
+					p.body_.resize(0);
+					p.bodyRemaining_ = p.parser_.getContentLength();
+
+					if (p.bodyRemaining_ > 0)
+						p.state_ = RTSPNativeClientPrivate::Input::Body;
+					else complete();
+				}
+				else if (p.state_ == RTSPNativeClientPrivate::Input::Body) {
+					auto chunk = static_cast<int>(
+						qMin<qint64>(p.bodyRemaining_, available));
+
+					p.body_.append(data + position, chunk);
+					position += chunk;
+					p.bodyRemaining_ -= chunk;
+
+					if (p.bodyRemaining_ == 0) complete();
+				}
+				else {
+					auto chunk = qMin(p.interleavedRemaining_, available);
+
+					base.demuxer_.feed(data + position,
+									   static_cast<size_t>(chunk));
+
+					position += chunk;
+					p.interleavedRemaining_ -= chunk;
+					delivered = true;
+
+					if (p.interleavedRemaining_ == 0) {
+						p.state_ = RTSPNativeClientPrivate::Input::Message;
+						p.boundary_ = true;
+					}
+				}
+			}
+
+			p.input_.remove(0, position);
+
+			flush();
+
+			auto finished = std::move(p.finished_);
+			p.finished_.clear();
+
+			for (const auto& result : finished)
+				if (result.first) result.first(result.second);
+
+			if (delivered && p.receiveHandler_) p.receiveHandler_();
+		}
+
+		/// Finishes the oldest request with the received response.
+		/// \details Answers an authentication challenge by sending the
+		/// request again, otherwise updates session state of the owner.
+		void RTSPNativeClient::complete() {
+			auto& base = private_->owner_.private_;
+			auto& parser = private_->parser_;
+
+			private_->state_ = RTSPNativeClientPrivate::Input::Message;
+			private_->boundary_ = true;
+
+			if (private_->sent_.isEmpty()) return;
+
+			auto request = private_->sent_.dequeue();
+			auto status = RTSPClientBase::validateStatus(
+				parser.getStatusCode());
+
+			if (status == RTSPStatusCode::Unauthorized) {
+				++base.authChallenges_;
+
+				if (!request.retried_ &&
+					authenticate(parser.getAuthenticate())) {
+					request.retried_ = true;
+					send(request);
+					return;
+				}
+			}
+			else if (request.authorized_ && !request.retried_)
+				++base.savedRoundTrips_;
+
+			auto session = parser.getSession();
+
+			if (!session.isEmpty()) {
+				base.currentSession_ = session;
+				base.sessionTimeout_ = parser.getSessionTimeout();
+			}
+
+			if (request.method_ == RTSPMethod::Setup) {
+				base.transportSSRC_ = parser.getSSRC();
+				base.transportPorts_ = parser.getServerPorts();
+			}
+
+			if (status == RTSPStatusCode::Ok) {
+				if (request.method_ == RTSPMethod::Options &&
+					parser.getMethods())
+					base.supportedMethods_ = parser.getMethods();
+
+				if (request.method_ == RTSPMethod::Describe &&
+					base.sdpData_.isEmpty())
+					base.sdpData_ = private_->body_;
+			}
+
+			if (request.method_ == RTSPMethod::Teardown) {
+				base.currentSession_.clear();
+				base.sessionTimeout_ = -1;
+				cancelKeepAlive();
+			}
+
+			updateTiming(request);
+			scheduleTimeout();
+
+			private_->finished_.append({ request.completion_, status });
+		}
+
+		/// Fails all requests.
+		/// \details Resets input state and calls completion callbacks with
+		/// error status.
+		void RTSPNativeClient::fail() {
+			auto& p = *private_;
+
+			for (const auto& request : p.sent_) {
+				updateTiming(request);
+				p.finished_.append({ request.completion_,
+									 RTSPStatusCode::Error });
+			}
+
+			for (const auto& request : p.waiting_) {
+				updateTiming(request);
+				p.finished_.append({ request.completion_,
+									 RTSPStatusCode::Error });
+			}
+
+			p.sent_.clear();
+			p.waiting_.clear();
+			p.input_.clear();
+
+			cancelTimeout();
+
+			p.parser_.reset();
+			p.state_ = RTSPNativeClientPrivate::Input::Message;
+			p.boundary_ = true;
+
+			auto finished = std::move(p.finished_);
+			p.finished_.clear();
+
+			for (const auto& result : finished)
+				if (result.first) result.first(result.second);
+		}
+
+		/// Stores timing of a finished request in the owner.
+		/// \details Phases are measured from the submission of the request,
+		/// like libcurl timers. Lookup and connect times are zero if the
+		/// connection was established before the request, and cover only
+		/// the part of the handshake after submission if it was in
+		/// progress. An answered authentication challenge is included.
+		/// \param[in]	request	Request.
+		void RTSPNativeClient::updateTiming(const Request& request) {
+			auto& p = *private_;
+			auto started = request.started_;
+
+			if (started < 0) return;
+
+			auto since = [started](qint64 time) {
+				return time < 0 ? time : qMax<qint64>(time - started, 0);
+			};
+
+			RTSPRequestTiming timing;
+
+			if (p.connected_ >= 0 && p.connected_ <= started) {
+				timing.lookup_ = 0;
+				timing.connect_ = 0;
+			}
+			else {
+				timing.lookup_ = since(p.lookedUp_);
+				timing.connect_ = since(p.connected_);
+			}
+
+			timing.firstByte_ = since(request.firstByte_);
+			timing.total_ = since(p.now());
+
+			p.owner_.updateTiming(request.method_, timing);
+		}
+
+		/// Builds Authorization header value.
+		/// \details Implements Basic and Digest (RFC 2617) schemes. The client
+		/// nonce of Digest is taken from the system random generator, so it
+		/// can not be predicted from the server nonce.
+		/// \param[in]	request	Request.
+		/// \return Authorization header value.
+		QByteArray RTSPNativeClient::authorization(const Request& request) {
+			auto& credentials = private_->owner_.private_.userCredentials_;
+			auto& p = *private_;
+
+			if (p.scheme_ == "Basic")
+				return "Basic " +
+					   (credentials.first + ':' + credentials.second)
+						.toBase64();
+
+			auto ha1 = md5(credentials.first + ':' +
+						   p.realm_ + ':' +
+						   credentials.second);
+
+			auto ha2 = md5(QByteArray(methodName(request.method_)) + ':' +
+						   request.uri_);
+
+			auto value =
+				"Digest username=\"" + credentials.first +
+				"\", realm=\"" + p.realm_ +
+				"\", nonce=\"" + p.nonce_ +
+				"\", uri=\"" + request.uri_ + "\"";
+
+			if (p.qop_) {
+				auto count = QByteArray::number(++p.nonceCount_, 16)
+							 .rightJustified(8, '0');
+
+				quint32 random[4];
+				QRandomGenerator::system()->fillRange(random);
+
+				auto cnonce = QByteArray(
+					reinterpret_cast<const char*>(random),
+					static_cast<int>(sizeof(random))).toHex();
+
+				value += ", qop=auth, nc=" + count +
+						 ", cnonce=\"" + cnonce +
+						 "\", response=\"" +
+						 md5(ha1 + ':' + p.nonce_ + ':' + count + ':' +
+							 cnonce + ":auth:" + ha2) + "\"";
+			}
+			else value += ", response=\"" +
+						  md5(ha1 + ':' + p.nonce_ + ':' + ha2) + "\"";
+
+			if (!p.opaque_.isEmpty())
+				value += ", opaque=\"" + p.opaque_ + "\"";
+
+			return value;
+		}
+
+		/// Stores authentication challenge.
+		/// \details Later requests carry credentials without waiting for a
+		/// challenge.
+		/// \param[in]	challenge	WWW-Authenticate header value.
+		/// \retval true if the challenge can be answered.
+		/// \retval false otherwise.
+		bool RTSPNativeClient::authenticate(const QByteArray& challenge) {
+			auto& credentials = private_->owner_.private_.userCredentials_;
+			auto& p = *private_;
+
+			if (credentials.first.isEmpty()) return false;
+
+			auto scheme = challenge.left(challenge.indexOf(' ')).toLower();
+
+			if (scheme == "digest") {
+				p.scheme_ = "Digest";
+				p.realm_ = challengeParameter(challenge, "realm");
+				p.nonce_ = challengeParameter(challenge, "nonce");
+				p.opaque_ = challengeParameter(challenge, "opaque");
+				p.qop_ = challengeParameter(challenge, "qop")
+						 .split(',').contains("auth");
+				p.nonceCount_ = 0;
+
+				return !p.nonce_.isEmpty();
+			}
+
+			if (scheme == "basic") {
+				p.scheme_ = "Basic";
+				return true;
+			}
+
+			return false;
+		}
+
+		/// Restarts keep-alive deadline.
+		/// \details Keep-alive is due at a jittered half of the session
+		/// timeout after the last request. Deadlines of all sessions of the
+		/// thread share one timing wheel.
+		void RTSPNativeClient::scheduleKeepAlive() {
+			auto& base = private_->owner_.private_;
+
+			cancelKeepAlive();
+
+			if (base.currentSession_.isEmpty()) return;
+
+			private_->keepAlive_ =
+				RTSPKeepAliveScheduler::shared().scheduleKeepAlive(
+					base.sessionTimeout_,
+					[this]() { onKeepAlive(); });
+		}
+
+		/// Cancels keep-alive deadline.
+		/// \details Does nothing if no deadline is scheduled.
+		void RTSPNativeClient::cancelKeepAlive() {
+			if (!private_->keepAlive_) return;
+
+			RTSPKeepAliveScheduler::shared().cancel(private_->keepAlive_);
+			private_->keepAlive_ = 0;
+		}
+
+		/// Restarts request deadline.
+		/// \details Schedules the earliest deadline of the requests in
+		/// progress on the timing wheel of the thread, which is precise to
+		/// its tick.
+		void RTSPNativeClient::scheduleTimeout() {
+			auto& p = *private_;
+
+			cancelTimeout();
+
+			auto deadline = qint64(-1);
+
+			auto earliest = [&deadline](const Request& request) {
+				if (request.deadline_ >= 0 &&
+					(deadline < 0 || request.deadline_ < deadline))
+					deadline = request.deadline_;
+			};
+
+			std::for_each(p.sent_.cbegin(), p.sent_.cend(), earliest);
+			std::for_each(p.waiting_.cbegin(), p.waiting_.cend(), earliest);
+
+			if (deadline < 0) return;
+
+			p.timeout_ = RTSPKeepAliveScheduler::shared().schedule(
+				qMax<qint64>((deadline - p.now() + 999) / 1000, 0),
+				[this]() { onTimeout(); });
+		}
+
+		/// Cancels request deadline.
+		/// \details Does nothing if no deadline is scheduled.
+		void RTSPNativeClient::cancelTimeout() {
+			if (!private_->timeout_) return;
+
+			RTSPKeepAliveScheduler::shared().cancel(private_->timeout_);
+			private_->timeout_ = 0;
+		}
+	}
+}
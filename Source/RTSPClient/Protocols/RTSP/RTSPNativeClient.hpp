@@ -0,0 +1,207 @@
+/// \file RTSPNativeClient.hpp
+/// \brief Contains classes and functions declarations that provide Real Time
+/// Streaming Protocol (RTSP) native client backend.
+/// \bug No known bugs.
+
+#ifndef RTSPNATIVECLIENT_HPP
+#define RTSPNATIVECLIENT_HPP
+
+#include "AbstractRTSPClient.hpp"
+#include "Base/Export.hpp"
+
+#include <QHostAddress>
+
+#include <functional>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		class RTSPClientBase;
+
+		/// Class that provides RTSP native client backend.
+		/// \details Implements RTSP/1.0 over a non-blocking TCP socket driven
+		/// by the Qt event loop. Requests are pipelined on one connection,
+		/// responses and interleaved data are split from the same stream.
+		/// Settings and session state are kept by the owning RTSPClientBase.
+		class RTSPCLIENT_EXPORT RTSPNativeClient : public QObject {
+
+			Q_OBJECT
+
+		public:
+
+			/// Completion callback type.
+			using completion_t = std::function<void(RTSPStatusCode)>;
+
+		public:
+
+			/// Constructor.
+			/// \param[in]	owner	Client that owns the backend.
+			/// \param[in]	parent	Parent object.
+			explicit RTSPNativeClient(RTSPClientBase& owner,
+									  QObject* parent = nullptr);
+
+			/// Destructor.
+			~RTSPNativeClient() override;
+
+		public:
+
+			/// Opens the client.
+			/// \param[in]	url	RTSP connection URL.
+			/// \retval true on success.
+			/// \retval false on error.
+			bool open(const QByteArray& url);
+
+			/// Closes the client.
+			void close();
+
+			/// Drops the connection, keeping authentication state.
+			void reconnect();
+
+			/// Moves the client to another thread.
+			/// \param[in]	thread	Target thread.
+			/// \retval true on success.
+			/// \retval false if a request is in progress.
+			bool detach(QThread* thread);
+
+			/// Resumes the client on the thread it was moved to.
+			void attach();
+
+			/// Indicates whether the client is open.
+			/// \retval true if the client is open.
+			/// \retval false if the client is closed.
+			bool isOpen() const;
+
+			/// Returns RTSP connection socket.
+			/// \return Socket descriptor or -1 if there is no connection.
+			qintptr getSocket() const;
+
+			/// Returns address of the RTSP server.
+			/// \return Server address or null address if there is no
+			/// connection.
+			QHostAddress getServerAddress() const;
+
+			/// Indicates whether a request is in progress.
+			/// \retval true if a request is in progress.
+			/// \retval false if no request is in progress.
+			bool isPending() const;
+
+			/// Returns number of requests sent before the previous response.
+			/// \return Number of pipelined requests.
+			quint64 getPipelinedCount() const;
+
+			/// Sets handler of delivered interleaved data.
+			/// \param[in]	handler	Handler called after interleaved data is
+			///						stored in channel buffers.
+			void setReceiveHandler(const std::function<void()>& handler);
+
+			/// Sends a request and waits for the response.
+			/// \param[in]	method		RTSP method.
+			/// \param[in]	path		Media track path.
+			/// \param[in]	channels	Channels for RTP and RTCP data.
+			/// \return RTSP status code.
+			RTSPStatusCode perform(
+				RTSPMethod method,
+				const QByteArray& path = { },
+				const QPair<quint16, quint16>& channels = { 0, 0 });
+
+			/// Sends a request without waiting for the response.
+			/// \param[in]	method		RTSP method.
+			/// \param[in]	completion	Completion callback.
+			/// \param[in]	path		Media track path.
+			/// \param[in]	channels	Channels for RTP and RTCP data.
+			/// \retval true if the request was started.
+			/// \retval false on error.
+			bool submit(RTSPMethod method,
+						const completion_t& completion,
+						const QByteArray& path = { },
+						const QPair<quint16, quint16>& channels = { 0, 0 });
+
+			/// Processes data available on the connection.
+			/// \return RTSP status code.
+			RTSPStatusCode receive();
+
+		private slots:
+
+			/// Performs an action when the connection is established.
+			void onConnected();
+
+			/// Performs an action when the connection has data.
+			void onReadyRead();
+
+			/// Performs an action when the connection is lost.
+			void onDisconnected();
+
+		private:
+
+			/// Structure that describes a request.
+			struct Request;
+
+			/// Starts connecting to the server.
+			void connectToHost();
+
+			/// Sends requests that are allowed to go out.
+			void flush();
+
+			/// Writes a request to the connection.
+			/// \param[in]	request	Request.
+			void send(Request& request);
+
+			/// Splits received data into responses and interleaved frames.
+			void process();
+
+			/// Finishes the oldest request with the received response.
+			void complete();
+
+			/// Fails all requests.
+			void fail();
+
+			/// Stores timing of a finished request in the owner.
+			/// \param[in]	request	Request.
+			void updateTiming(const Request& request);
+
+			/// Builds Authorization header value.
+			/// \param[in]	request	Request.
+			/// \return Authorization header value.
+			QByteArray authorization(const Request& request);
+
+			/// Stores authentication challenge.
+			/// \param[in]	challenge	WWW-Authenticate header value.
+			/// \retval true if the challenge can be answered.
+			/// \retval false otherwise.
+			bool authenticate(const QByteArray& challenge);
+
+			/// Performs an action when keep-alive is due.
+			void onKeepAlive();
+
+			/// Performs an action when a request deadline is due.
+			void onTimeout();
+
+			/// Restarts keep-alive deadline.
+			void scheduleKeepAlive();
+
+			/// Cancels keep-alive deadline.
+			void cancelKeepAlive();
+
+			/// Restarts request deadline.
+			void scheduleTimeout();
+
+			/// Cancels request deadline.
+			void cancelTimeout();
+
+		private:
+
+			/// Opaque type for private data.
+			struct RTSPNativeClientPrivate;
+
+			/// Private data.
+			const QScopedPointer<RTSPNativeClientPrivate> private_;
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,84 @@
+/// \file RTSPRequestTiming.hpp
+/// \brief Contains classes and functions declarations that provide Real Time
+/// Streaming Protocol (RTSP) request timing.
+/// \bug No known bugs.
+
+#ifndef RTSPREQUESTTIMING_HPP
+#define RTSPREQUESTTIMING_HPP
+
+#include <QtGlobal>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		/// Enumeration that defines phases of an RTSP request.
+		enum class RTSPLatencyPhase {
+			Lookup,
+			Connect,
+			FirstByte,
+			Total
+		};
+
+		/// Number of phases of an RTSP request.
+		constexpr int RTSP_LATENCY_PHASE_COUNT {
+			static_cast<int>(RTSPLatencyPhase::Total) + 1
+		};
+
+		/// Structure that describes timing of an RTSP request.
+		/// \details Times are measured in microseconds from the start of the
+		/// request, like libcurl timers. Lookup and connect times are zero
+		/// when the request reused a connection. A negative value means the
+		/// phase is not reached.
+		struct RTSPRequestTiming final {
+
+			/// Time when the host name is resolved.
+			qint64 lookup_ { -1 };
+
+			/// Time when the connection is established.
+			qint64 connect_ { -1 };
+
+			/// Time when the first byte of the response is received.
+			qint64 firstByte_ { -1 };
+
+			/// Time when the request is finished.
+			qint64 total_ { -1 };
+		};
+
+		/// Structure that describes latency distribution of a request phase.
+		/// \details Values are measured in microseconds. Percentiles are
+		/// rounded up to the histogram bucket.
+		struct RTSPLatencySummary final {
+
+			/// Number of recorded requests.
+			quint64 count_ { 0 };
+
+			/// Lowest latency.
+			qint64 minimum_ { 0 };
+
+			/// Mean latency.
+			double mean_ { 0 };
+
+			/// Median latency.
+			qint64 p50_ { 0 };
+
+			/// 90th percentile of latency.
+			qint64 p90_ { 0 };
+
+			/// 99th percentile of latency.
+			qint64 p99_ { 0 };
+
+			/// 99.9th percentile of latency.
+			qint64 p999_ { 0 };
+
+			/// Highest latency.
+			qint64 maximum_ { 0 };
+		};
+	}
+}
+
+#endif
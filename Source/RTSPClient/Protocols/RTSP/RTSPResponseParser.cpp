@@ -0,0 +1,610 @@
+/// \file RTSPResponseParser.cpp
+/// \brief Contains classes and functions definitions that provide Real Time
+/// Streaming Protocol (RTSP) response parser.
+/// \bug No known bugs.
+
+#include "RTSPResponseParser.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		namespace {
+
+			/// Default session timeout in seconds.
+			/// \details Defined by RFC 2326, section 12.37.
+			constexpr qint64 DEFAULT_SESSION_TIMEOUT { 60 };
+
+			/// Maximum number of digits of a decimal number.
+			/// \details Any number of eighteen digits fits a signed 64-bit
+			/// integer, longer ones are rejected.
+			constexpr int MAX_DIGITS { 18 };
+
+			/// Structure that describes an RTSP method name.
+			struct MethodName final {
+
+				/// Method name.
+				const char* name_;
+
+				/// RTSP method.
+				RTSPMethod method_;
+			};
+
+			/// RTSP method names.
+			/// \details Names listed by the Public header.
+			const MethodName METHOD_NAMES[] {
+				{ "OPTIONS",		RTSPMethod::Options			},
+				{ "DESCRIBE",		RTSPMethod::Describe		},
+				{ "ANNOUNCE",		RTSPMethod::Announce		},
+				{ "SETUP",			RTSPMethod::Setup			},
+				{ "PLAY",			RTSPMethod::Play			},
+				{ "PAUSE",			RTSPMethod::Pause			},
+				{ "TEARDOWN",		RTSPMethod::Teardown		},
+				{ "GET_PARAMETER",	RTSPMethod::GetParameter	},
+				{ "SET_PARAMETER",	RTSPMethod::SetParameter	},
+				{ "RECORD",			RTSPMethod::Record			}
+			};
+
+			/// Converts a character to lower case.
+			/// \param[in]	c	Character.
+			/// \return Lower case character.
+			inline char lower(char c) {
+				return c >= 'A' && c <= 'Z' ? static_cast<char>(c + 32) : c;
+			}
+
+			/// Skips leading whitespace.
+			/// \param[in]	begin	Range begin.
+			/// \param[in]	end		Range end.
+			/// \return First non-whitespace position.
+			inline const char* trimLeft(const char* begin, const char* end) {
+				while (begin < end && (*begin == ' ' || *begin == '\t'))
+					++begin;
+
+				return begin;
+			}
+
+			/// Skips trailing whitespace.
+			/// \param[in]	begin	Range begin.
+			/// \param[in]	end		Range end.
+			/// \return Position after the last non-whitespace character.
+			inline const char* trimRight(const char* begin, const char* end) {
+				while (end > begin && (end[-1] == ' ' || end[-1] == '\t'))
+					--end;
+
+				return end;
+			}
+
+			/// Compares a range with a name ignoring case.
+			/// \param[in]	begin	Range begin.
+			/// \param[in]	end		Range end.
+			/// \param[in]	name	Null-terminated name.
+			/// \retval true if the range equals the name.
+			/// \retval false otherwise.
+			bool equals(const char* begin, const char* end, const char* name) {
+				for (; begin < end && *name; ++begin, ++name)
+					if (lower(*begin) != lower(*name)) return false;
+
+				return begin == end && !*name;
+			}
+
+			/// Checks whether a range starts with a prefix ignoring case.
+			/// \param[in]	begin	Range begin.
+			/// \param[in]	end		Range end.
+			/// \param[in]	prefix	Null-terminated prefix.
+			/// \return Position after the prefix or nullptr.
+			const char* skipPrefix(const char* begin,
+								   const char* end,
+								   const char* prefix) {
+
+				for (; *prefix; ++begin, ++prefix)
+					if (begin >= end || lower(*begin) != lower(*prefix))
+						return nullptr;
+
+				return begin;
+			}
+
+			/// Parses a decimal number.
+			/// \param[in]	begin	Range begin.
+			/// \param[in]	end		Range end.
+			/// \param[out]	value	Parsed value or -1 if there are no digits
+			/// or too many of them.
+			/// \return Position after the number.
+			const char* parseNumber(const char* begin,
+									const char* end,
+									qint64* value) {
+
+				qint64 result = -1;
+				auto digits = 0;
+
+				for (; begin < end && *begin >= '0' && *begin <= '9'; ++begin)
+					if (++digits <= MAX_DIGITS)
+						result = (result < 0 ? 0 : result * 10) +
+								 (*begin - '0');
+
+				*value = digits <= MAX_DIGITS ? result : -1;
+
+				return begin;
+			}
+
+			/// Parses a hexadecimal number of up to eight digits.
+			/// \param[in]	begin	Range begin.
+			/// \param[in]	end		Range end.
+			/// \param[out]	value	Parsed value or -1 if there are no digits.
+			void parseHex(const char* begin, const char* end, qint64* value) {
+				qint64 result = -1;
+
+				for (auto digits = 0; begin < end && digits < 8;
+					 ++begin, ++digits) {
+
+					auto c = lower(*begin);
+					int digit;
+
+					if (c >= '0' && c <= '9') digit = c - '0';
+					else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+					else break;
+
+					result = (result < 0 ? 0 : result * 16) + digit;
+				}
+
+				*value = result;
+			}
+
+			/// Parses a range of two numbers separated by a dash.
+			/// \param[in]	begin	Range begin.
+			/// \param[in]	end		Range end.
+			/// \param[out]	value	Parsed numbers.
+			void parsePair(const char* begin,
+						   const char* end,
+						   QPair<quint16, quint16>* value) {
+
+				qint64 first, second;
+
+				begin = parseNumber(begin, end, &first);
+				if (first < 0) return;
+
+				second = first + 1;
+
+				if (begin < end && *begin == '-')
+					parseNumber(begin + 1, end, &second);
+
+				value->first = static_cast<quint16>(first);
+				value->second = static_cast<quint16>(
+					second < 0 ? first + 1 : second);
+			}
+
+			/// Returns the end of the next list element.
+			/// \param[in]	begin		Range begin.
+			/// \param[in]	end			Range end.
+			/// \param[in]	separator	Element separator.
+			/// \return Element end.
+			inline const char* nextElement(const char* begin,
+										   const char* end,
+										   char separator) {
+
+				return std::find(begin, end, separator);
+			}
+		}
+
+		/// Header value capacity.
+		/// \details Defined here, since the value is bound to references.
+		const int RTSPResponseParser::VALUE_CAPACITY;
+
+		/// Line buffer capacity.
+		/// \details Defined here, since the value is bound to references.
+		const int RTSPResponseParser::LINE_CAPACITY;
+
+		/// Processes response data.
+		/// \details Consumes data up to the end of the headers. Complete lines
+		/// inside the data are parsed in place, only a line split between
+		/// calls is copied to the line buffer. Feeding data after the headers
+		/// are complete starts a new response, so the caller has to consume
+		/// the response body first.
+		/// \param[in]	data	Data pointer.
+		/// \param[in]	size	Data size.
+		/// \return Processed data size.
+		size_t RTSPResponseParser::feed(const char* data,
+										size_t size) noexcept {
+
+			if (!data) return 0;
+
+			auto current = data;
+			auto end = data + size;
+
+			while (current < end) {
+				if (state_ == State::Complete) reset();
+
+				auto newline = static_cast<const char*>(std::memchr(
+					current, '\n', static_cast<size_t>(end - current)));
+
+				auto lineEnd = newline ? newline : end;
+				auto length = static_cast<int>(lineEnd - current);
+
+				if (!newline || lineSize_ > 0) {
+					auto copied = qMin(length, LINE_CAPACITY - lineSize_);
+					std::memcpy(line_ + lineSize_, current,
+								static_cast<size_t>(copied));
+					lineSize_ += copied;
+				}
+
+				if (!newline) {
+					current = end;
+					break;
+				}
+
+				if (lineSize_ > 0) {
+					processLine(line_, lineSize_);
+					lineSize_ = 0;
+				}
+				else processLine(current, length);
+
+				current = newline + 1;
+
+				if (state_ == State::Complete) break;
+			}
+
+			return static_cast<size_t>(current - data);
+		}
+
+		/// Resets the parser for the next response.
+		/// \details Clears parsed values and partial line.
+		void RTSPResponseParser::reset() noexcept {
+			state_ = State::Status;
+			lineSize_ = 0;
+			statusCode_ = 0;
+			sequence_ = -1;
+			session_.size_ = 0;
+			sessionTimeout_ = -1;
+			transport_.size_ = 0;
+			interleaved_ = { 0, 0 };
+			serverPorts_ = { 0, 0 };
+			ssrc_ = -1;
+			rtpInfo_.size_ = 0;
+			rtpInfoSequence_ = -1;
+			rtpInfoTime_ = -1;
+			contentBase_.size_ = 0;
+			contentLength_ = 0;
+			methods_ = 0;
+			authenticate_.size_ = 0;
+		}
+
+		/// Indicates whether the status line is received.
+		/// \details Checks the parsing state.
+		/// \retval true if the status line is received.
+		/// \retval false otherwise.
+		bool RTSPResponseParser::hasStatus() const noexcept {
+			return state_ != State::Status;
+		}
+
+		/// Indicates whether all headers are received.
+		/// \details Checks the parsing state.
+		/// \retval true if all headers are received.
+		/// \retval false otherwise.
+		bool RTSPResponseParser::isComplete() const noexcept {
+			return state_ == State::Complete;
+		}
+
+		/// Returns status code.
+		/// \details Returns code from the status line.
+		/// \return Status code.
+		RTSPStatusCode RTSPResponseParser::getStatusCode() const noexcept {
+			return static_cast<RTSPStatusCode>(statusCode_);
+		}
+
+		/// Returns sequence number.
+		/// \details Returns CSeq header value.
+		/// \return Sequence number or -1 if it is not received.
+		qint64 RTSPResponseParser::getCSeq() const noexcept {
+			return sequence_;
+		}
+
+		/// Returns session identifier.
+		/// \details Returns Session header value without parameters.
+		/// \return Session identifier.
+		QByteArray RTSPResponseParser::getSession() const {
+			return QByteArray(session_.data_, session_.size_);
+		}
+
+		/// Returns session timeout.
+		/// \details Returns timeout parameter of Session header or the
+		/// default timeout.
+		/// \return Session timeout in seconds or -1 if there is no
+		/// session.
+		qint64 RTSPResponseParser::getSessionTimeout() const noexcept {
+			return sessionTimeout_;
+		}
+
+		/// Returns transport header value.
+		/// \details Returns the whole Transport header value.
+		/// \return Transport header value.
+		QByteArray RTSPResponseParser::getTransport() const {
+			return QByteArray(transport_.data_, transport_.size_);
+		}
+
+		/// Returns interleaved channels from transport header.
+		/// \details Returns interleaved parameter of Transport header.
+		/// \return Interleaved channels.
+		QPair<quint16, quint16>
+		RTSPResponseParser::getInterleaved() const noexcept {
+			return interleaved_;
+		}
+
+		/// Returns server ports from transport header.
+		/// \details Returns server_port parameter of Transport header.
+		/// \return Server ports.
+		QPair<quint16, quint16>
+		RTSPResponseParser::getServerPorts() const noexcept {
+			return serverPorts_;
+		}
+
+		/// Returns synchronization source from transport header.
+		/// \details Returns ssrc parameter of Transport header, which the
+		/// server sends as eight hexadecimal digits.
+		/// \return Synchronization source ID (SSRC) or -1 if it is not
+		/// received.
+		qint64 RTSPResponseParser::getSSRC() const noexcept {
+			return ssrc_;
+		}
+
+		/// Returns RTP-Info header value.
+		/// \details Returns the whole RTP-Info header value.
+		/// \return RTP-Info header value.
+		QByteArray RTSPResponseParser::getRTPInfo() const {
+			return QByteArray(rtpInfo_.data_, rtpInfo_.size_);
+		}
+
+		/// Returns sequence number of the first RTP-Info entry.
+		/// \details Returns seq parameter of the first stream.
+		/// \return Sequence number or -1 if it is not received.
+		qint64 RTSPResponseParser::getRTPInfoSequence() const noexcept {
+			return rtpInfoSequence_;
+		}
+
+		/// Returns RTP time of the first RTP-Info entry.
+		/// \details Returns rtptime parameter of the first stream.
+		/// \return RTP time or -1 if it is not received.
+		qint64 RTSPResponseParser::getRTPInfoTime() const noexcept {
+			return rtpInfoTime_;
+		}
+
+		/// Returns content base.
+		/// \details Returns Content-Base header value.
+		/// \return Content base.
+		QByteArray RTSPResponseParser::getContentBase() const {
+			return QByteArray(contentBase_.data_, contentBase_.size_);
+		}
+
+		/// Returns content length.
+		/// \details Returns Content-Length header value.
+		/// \return Content length.
+		qint64 RTSPResponseParser::getContentLength() const noexcept {
+			return contentLength_;
+		}
+
+		/// Returns supported methods.
+		/// \details Returns methods listed by Public header.
+		/// \return Bitmask of supported methods.
+		quint32 RTSPResponseParser::getMethods() const noexcept {
+			return methods_;
+		}
+
+		/// Returns authentication challenge.
+		/// \details Digest challenge is preferred when a server offers
+		/// several schemes.
+		/// \return WWW-Authenticate header value.
+		QByteArray RTSPResponseParser::getAuthenticate() const {
+			return QByteArray(authenticate_.data_, authenticate_.size_);
+		}
+
+		/// Returns bitmask of an RTSP method.
+		/// \details Every method occupies one bit.
+		/// \param[in]	method	RTSP method.
+		/// \return Method bitmask.
+		quint32 RTSPResponseParser::getMethodMask(RTSPMethod method) noexcept {
+			return quint32(1) << static_cast<int>(method);
+		}
+
+		/// Processes a complete line.
+		/// \details Dispatches the line according to the parsing state.
+		/// \param[in]	line	Line pointer.
+		/// \param[in]	size	Line size.
+		void RTSPResponseParser::processLine(const char* line,
+											 int size) noexcept {
+
+			auto end = line + size;
+			if (end > line && end[-1] == '\r') --end;
+
+			switch (state_) {
+			case State::Status:
+				if (skipPrefix(line, end, "RTSP/")) {
+					processStatus(line, end);
+					state_ = State::Headers;
+				}
+				break;
+
+			case State::Headers:
+				if (line == end) state_ = State::Complete;
+				else if (*line != ' ' && *line != '\t')
+					processHeader(line, end);
+				break;
+
+			case State::Complete:
+				break;
+			}
+		}
+
+		/// Processes status line.
+		/// \details Parses status code after the protocol version.
+		/// \param[in]	line	Line pointer.
+		/// \param[in]	end		Line end.
+		void RTSPResponseParser::processStatus(const char* line,
+											   const char* end) noexcept {
+
+			qint64 code;
+
+			auto current = trimLeft(std::find(line, end, ' '), end);
+			parseNumber(current, end, &code);
+
+			statusCode_ = code > 0 && code < 1000 ? static_cast<int>(code) : 0;
+		}
+
+		/// Processes header line.
+		/// \details Splits the header into name and value and parses values
+		/// of known headers.
+		/// \param[in]	line	Line pointer.
+		/// \param[in]	end		Line end.
+		void RTSPResponseParser::processHeader(const char* line,
+											   const char* end) noexcept {
+
+			auto colon = std::find(line, end, ':');
+			if (colon == end) return;
+
+			auto nameEnd = trimRight(line, colon);
+			auto value = trimLeft(colon + 1, end);
+			auto valueEnd = trimRight(value, end);
+
+			if (equals(line, nameEnd, "CSeq"))
+				parseNumber(value, valueEnd, &sequence_);
+			else if (equals(line, nameEnd, "Session"))
+				processSession(value, valueEnd);
+			else if (equals(line, nameEnd, "Transport"))
+				processTransport(value, valueEnd);
+			else if (equals(line, nameEnd, "RTP-Info"))
+				processRTPInfo(value, valueEnd);
+			else if (equals(line, nameEnd, "Content-Base"))
+				assign(contentBase_, value, valueEnd);
+			else if (equals(line, nameEnd, "Content-Length")) {
+				parseNumber(value, valueEnd, &contentLength_);
+				contentLength_ = qMax<qint64>(contentLength_, 0);
+			}
+			else if (equals(line, nameEnd, "Public"))
+				processPublic(value, valueEnd);
+			else if (equals(line, nameEnd, "WWW-Authenticate")) {
+				if (!authenticate_.size_ ||
+					skipPrefix(value, valueEnd, "Digest"))
+					assign(authenticate_, value, valueEnd);
+			}
+		}
+
+		/// Processes Session header value.
+		/// \details Stores session identifier and parses timeout parameter.
+		/// \param[in]	value	Value pointer.
+		/// \param[in]	end		Value end.
+		void RTSPResponseParser::processSession(const char* value,
+												const char* end) noexcept {
+
+			auto current = nextElement(value, end, ';');
+
+			assign(session_, value, trimRight(value, current));
+			sessionTimeout_ = DEFAULT_SESSION_TIMEOUT;
+
+			while (current < end) {
+				auto parameter = trimLeft(current + 1, end);
+				current = nextElement(parameter, end, ';');
+
+				auto timeout = skipPrefix(parameter, current, "timeout=");
+				if (!timeout) continue;
+
+				qint64 seconds;
+				parseNumber(timeout, current, &seconds);
+				if (seconds > 0) sessionTimeout_ = seconds;
+			}
+		}
+
+		/// Processes Transport header value.
+		/// \details Stores the value and parses interleaved channels, server
+		/// ports and synchronization source.
+		/// \param[in]	value	Value pointer.
+		/// \param[in]	end		Value end.
+		void RTSPResponseParser::processTransport(const char* value,
+												  const char* end) noexcept {
+
+			assign(transport_, value, end);
+
+			auto current = nextElement(value, end, ';');
+
+			while (current < end) {
+				auto parameter = trimLeft(current + 1, end);
+				current = nextElement(parameter, end, ';');
+
+				if (auto channels =
+						skipPrefix(parameter, current, "interleaved="))
+					parsePair(channels, current, &interleaved_);
+				else if (auto ports =
+						skipPrefix(parameter, current, "server_port="))
+					parsePair(ports, current, &serverPorts_);
+				else if (auto source = skipPrefix(parameter, current, "ssrc="))
+					parseHex(source, current, &ssrc_);
+			}
+		}
+
+		/// Processes RTP-Info header value.
+		/// \details Stores the value and parses sequence number and RTP time
+		/// of the first stream.
+		/// \param[in]	value	Value pointer.
+		/// \param[in]	end		Value end.
+		void RTSPResponseParser::processRTPInfo(const char* value,
+												const char* end) noexcept {
+
+			assign(rtpInfo_, value, end);
+
+			auto first = nextElement(value, end, ',');
+			auto current = nextElement(value, first, ';');
+
+			while (current < first) {
+				auto parameter = trimLeft(current + 1, first);
+				current = nextElement(parameter, first, ';');
+
+				if (auto sequence = skipPrefix(parameter, current, "seq="))
+					parseNumber(sequence, current, &rtpInfoSequence_);
+				else if (auto time = skipPrefix(parameter, current, "rtptime="))
+					parseNumber(time, current, &rtpInfoTime_);
+			}
+		}
+
+		/// Processes Public header value.
+		/// \details Adds listed methods to the bitmask of supported methods.
+		/// \param[in]	value	Value pointer.
+		/// \param[in]	end		Value end.
+		void RTSPResponseParser::processPublic(const char* value,
+											   const char* end) noexcept {
+
+			auto current = value;
+
+			while (current < end) {
+				auto next = nextElement(current, end, ',');
+				auto name = trimLeft(current, next);
+				auto nameEnd = trimRight(name, next);
+
+				for (const auto& method : METHOD_NAMES) {
+					if (equals(name, nameEnd, method.name_)) {
+						methods_ |= getMethodMask(method.method_);
+						break;
+					}
+				}
+
+				current = next < end ? next + 1 : end;
+			}
+		}
+
+		/// Stores header value.
+		/// \details Copies the value to fixed-size storage, longer values are
+		/// truncated.
+		/// \param[out]	target	Value storage.
+		/// \param[in]	value	Value pointer.
+		/// \param[in]	end		Value end.
+		void RTSPResponseParser::assign(Value& target,
+										const char* value,
+										const char* end) noexcept {
+
+			target.size_ = qMin(static_cast<int>(end - value), VALUE_CAPACITY);
+			std::memcpy(target.data_, value, static_cast<size_t>(target.size_));
+		}
+	}
+}
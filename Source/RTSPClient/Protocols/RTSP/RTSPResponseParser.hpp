@@ -0,0 +1,250 @@
+/// \file RTSPResponseParser.hpp
+/// \brief Contains classes and functions declarations that provide Real Time
+/// Streaming Protocol (RTSP) response parser.
+/// \bug No known bugs.
+
+#ifndef RTSPRESPONSEPARSER_HPP
+#define RTSPRESPONSEPARSER_HPP
+
+#include "AbstractRTSPClient.hpp"
+#include "Base/Export.hpp"
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		/// Class that provides RTSP response parser.
+		/// \details Parses status line and headers of RTSP responses fed in
+		/// chunks of any size, either header by header from the curl header
+		/// callback or straight from a socket. Parsing does not allocate
+		/// memory: values are kept in fixed-size fields of the parser.
+		class RTSPCLIENT_EXPORT RTSPResponseParser final {
+		public:
+
+			/// Default constructor.
+			explicit RTSPResponseParser() = default;
+
+		public:
+
+			/// Processes response data.
+			/// \param[in]	data	Data pointer.
+			/// \param[in]	size	Data size.
+			/// \return Processed data size.
+			size_t feed(const char* data, size_t size) noexcept;
+
+			/// Resets the parser for the next response.
+			void reset() noexcept;
+
+			/// Indicates whether the status line is received.
+			/// \retval true if the status line is received.
+			/// \retval false otherwise.
+			bool hasStatus() const noexcept;
+
+			/// Indicates whether all headers are received.
+			/// \retval true if all headers are received.
+			/// \retval false otherwise.
+			bool isComplete() const noexcept;
+
+			/// Returns status code.
+			/// \return Status code.
+			RTSPStatusCode getStatusCode() const noexcept;
+
+			/// Returns sequence number.
+			/// \return Sequence number or -1 if it is not received.
+			qint64 getCSeq() const noexcept;
+
+			/// Returns session identifier.
+			/// \return Session identifier.
+			QByteArray getSession() const;
+
+			/// Returns session timeout.
+			/// \return Session timeout in seconds or -1 if there is no
+			/// session.
+			qint64 getSessionTimeout() const noexcept;
+
+			/// Returns transport header value.
+			/// \return Transport header value.
+			QByteArray getTransport() const;
+
+			/// Returns interleaved channels from transport header.
+			/// \return Interleaved channels.
+			QPair<quint16, quint16> getInterleaved() const noexcept;
+
+			/// Returns server ports from transport header.
+			/// \return Server ports.
+			QPair<quint16, quint16> getServerPorts() const noexcept;
+
+			/// Returns synchronization source from transport header.
+			/// \return Synchronization source ID (SSRC) or -1 if it is not
+			/// received.
+			qint64 getSSRC() const noexcept;
+
+			/// Returns RTP-Info header value.
+			/// \return RTP-Info header value.
+			QByteArray getRTPInfo() const;
+
+			/// Returns sequence number of the first RTP-Info entry.
+			/// \return Sequence number or -1 if it is not received.
+			qint64 getRTPInfoSequence() const noexcept;
+
+			/// Returns RTP time of the first RTP-Info entry.
+			/// \return RTP time or -1 if it is not received.
+			qint64 getRTPInfoTime() const noexcept;
+
+			/// Returns content base.
+			/// \return Content base.
+			QByteArray getContentBase() const;
+
+			/// Returns content length.
+			/// \return Content length.
+			qint64 getContentLength() const noexcept;
+
+			/// Returns supported methods.
+			/// \return Bitmask of supported methods.
+			quint32 getMethods() const noexcept;
+
+			/// Returns authentication challenge.
+			/// \return WWW-Authenticate header value.
+			QByteArray getAuthenticate() const;
+
+			/// Returns bitmask of an RTSP method.
+			/// \param[in]	method	RTSP method.
+			/// \return Method bitmask.
+			static quint32 getMethodMask(RTSPMethod method) noexcept;
+
+		private:
+
+			/// Processes a complete line.
+			/// \param[in]	line	Line pointer.
+			/// \param[in]	size	Line size.
+			void processLine(const char* line, int size) noexcept;
+
+			/// Processes status line.
+			/// \param[in]	line	Line pointer.
+			/// \param[in]	end		Line end.
+			void processStatus(const char* line, const char* end) noexcept;
+
+			/// Processes header line.
+			/// \param[in]	line	Line pointer.
+			/// \param[in]	end		Line end.
+			void processHeader(const char* line, const char* end) noexcept;
+
+			/// Processes Session header value.
+			/// \param[in]	value	Value pointer.
+			/// \param[in]	end		Value end.
+			void processSession(const char* value, const char* end) noexcept;
+
+			/// Processes Transport header value.
+			/// \param[in]	value	Value pointer.
+			/// \param[in]	end		Value end.
+			void processTransport(const char* value,
+								  const char* end) noexcept;
+
+			/// Processes RTP-Info header value.
+			/// \param[in]	value	Value pointer.
+			/// \param[in]	end		Value end.
+			void processRTPInfo(const char* value, const char* end) noexcept;
+
+			/// Processes Public header value.
+			/// \param[in]	value	Value pointer.
+			/// \param[in]	end		Value end.
+			void processPublic(const char* value, const char* end) noexcept;
+
+		private:
+
+			/// Header value capacity.
+			static const int VALUE_CAPACITY = 512;
+
+			/// Structure that provides header value storage.
+			/// \details Fixed-size storage, longer values are truncated.
+			struct Value final {
+
+				/// Value data.
+				char data_[VALUE_CAPACITY];
+
+				/// Value size.
+				int size_ { 0 };
+			};
+
+			/// Stores header value.
+			/// \param[out]	target	Value storage.
+			/// \param[in]	value	Value pointer.
+			/// \param[in]	end		Value end.
+			static void assign(Value& target,
+							   const char* value,
+							   const char* end) noexcept;
+
+		private:
+
+			/// Enumeration that defines parsing states.
+			enum class State {
+				Status,
+				Headers,
+				Complete
+			};
+
+			/// Line buffer capacity.
+			static const int LINE_CAPACITY = 2048;
+
+			/// Parsing state.
+			State state_ { State::Status };
+
+			/// Partial line.
+			char line_[LINE_CAPACITY];
+
+			/// Partial line size.
+			int lineSize_ { 0 };
+
+			/// Status code.
+			int statusCode_ { 0 };
+
+			/// Sequence number.
+			qint64 sequence_ { -1 };
+
+			/// Session identifier.
+			Value session_;
+
+			/// Session timeout in seconds.
+			qint64 sessionTimeout_ { -1 };
+
+			/// Transport header value.
+			Value transport_;
+
+			/// Interleaved channels.
+			QPair<quint16, quint16> interleaved_ { 0, 0 };
+
+			/// Server ports.
+			QPair<quint16, quint16> serverPorts_ { 0, 0 };
+
+			/// Synchronization source ID (SSRC).
+			qint64 ssrc_ { -1 };
+
+			/// RTP-Info header value.
+			Value rtpInfo_;
+
+			/// Sequence number of the first RTP-Info entry.
+			qint64 rtpInfoSequence_ { -1 };
+
+			/// RTP time of the first RTP-Info entry.
+			qint64 rtpInfoTime_ { -1 };
+
+			/// Content base.
+			Value contentBase_;
+
+			/// Content length.
+			qint64 contentLength_ { 0 };
+
+			/// Bitmask of supported methods.
+			quint32 methods_ { 0 };
+
+			/// Authentication challenge.
+			Value authenticate_;
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,302 @@
+/// \file RTSPSessionCache.cpp
+/// \brief Contains classes and functions definitions that provide Real Time
+/// Streaming Protocol (RTSP) process-wide session cache.
+/// \bug No known bugs.
+
+#include "RTSPSessionCache.hpp"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <atomic>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		namespace {
+
+			/// Default lifetime of cached host addresses in seconds.
+			/// \details Matches libcurl default DNS cache timeout.
+			constexpr qint64 DEFAULT_DNS_TIMEOUT { 60 };
+
+			/// Returns address table key.
+			/// \param[in]	host	Host name.
+			/// \param[in]	port	Port.
+			/// \return Address table key.
+			QByteArray addressKey(const QByteArray& host, quint16 port) {
+				return host.toLower() + ':' + QByteArray::number(port);
+			}
+		}
+
+		/// Structure that provides private storage.
+		/// \details Maintains private data.
+		struct RTSPSessionCache::RTSPSessionCachePrivate final {
+
+			/// Structure that describes a cached address.
+			struct Entry final {
+
+				/// Resolved address.
+				QByteArray address_;
+
+				/// Expiration time in milliseconds of the cache clock.
+				qint64 expires_ { 0 };
+			};
+
+			/// Share handle for host addresses.
+			CURLSH* dnsShare_ { nullptr };
+
+			/// Share handle for host addresses and idle connections.
+			CURLSH* connectionShare_ { nullptr };
+
+			/// Locks of shared data types.
+			QMutex locks_[CURL_LOCK_DATA_LAST];
+
+			/// Lock of the address table.
+			mutable QMutex mutex_;
+
+			/// Cached addresses by host and port.
+			QHash<QByteArray, Entry> addresses_;
+
+			/// Cache clock.
+			QElapsedTimer clock_;
+
+			/// Whether the cache is enabled.
+			std::atomic<bool> enabled_ { true };
+
+			/// Lifetime of cached addresses in seconds.
+			std::atomic<qint64> dnsTimeout_ { DEFAULT_DNS_TIMEOUT };
+
+			/// Number of host lookups answered by the cache.
+			std::atomic<quint64> dnsHits_ { 0 };
+
+			/// Number of host lookups that went to the resolver.
+			std::atomic<quint64> dnsMisses_ { 0 };
+
+			/// Number of requests sent over a reused connection.
+			std::atomic<quint64> connectionHits_ { 0 };
+
+			/// Number of requests that opened a new connection.
+			std::atomic<quint64> connectionMisses_ { 0 };
+		};
+
+		/// Returns process-wide session cache.
+		/// \details Created on first use, after libcurl global context.
+		/// \return Session cache.
+		RTSPSessionCache& RTSPSessionCache::instance() {
+			static RTSPSessionCache cache;
+			return cache;
+		}
+
+		/// Default constructor.
+		/// \details Creates libcurl share handles. Contexts that carry
+		/// interleaved data must not lend their connection to other clients,
+		/// so they only share host addresses.
+		RTSPSessionCache::RTSPSessionCache()
+			: private_(new RTSPSessionCachePrivate) {
+
+			private_->clock_.start();
+
+			private_->dnsShare_ = curl_share_init();
+			private_->connectionShare_ = curl_share_init();
+
+			for (auto share : { private_->dnsShare_,
+								private_->connectionShare_ }) {
+				if (!share) continue;
+
+				curl_share_setopt(share, CURLSHOPT_LOCKFUNC, callbackLock);
+				curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, callbackUnlock);
+				curl_share_setopt(share, CURLSHOPT_USERDATA, private_.data());
+				curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+			}
+
+			if (private_->connectionShare_)
+				curl_share_setopt(private_->connectionShare_,
+								  CURLSHOPT_SHARE,
+								  CURL_LOCK_DATA_CONNECT);
+		}
+
+		/// Destructor.
+		/// \details Destroys libcurl share handles.
+		RTSPSessionCache::~RTSPSessionCache() {
+			if (private_->dnsShare_)
+				curl_share_cleanup(private_->dnsShare_);
+
+			if (private_->connectionShare_)
+				curl_share_cleanup(private_->connectionShare_);
+		}
+
+		/// Indicates whether the cache is enabled.
+		/// \details Returns enabled flag.
+		/// \retval true if the cache is enabled.
+		/// \retval false if the cache is disabled.
+		bool RTSPSessionCache::isEnabled() const {
+			return private_->enabled_;
+		}
+
+		/// Enables or disables the cache for contexts opened later.
+		/// \details Contexts already attached keep sharing until they are
+		/// closed.
+		/// \param[in]	enabled	Whether the cache is enabled.
+		void RTSPSessionCache::setEnabled(bool enabled) {
+			private_->enabled_ = enabled;
+		}
+
+		/// Returns lifetime of cached host addresses.
+		/// \details Returns DNS timeout.
+		/// \return Lifetime in seconds.
+		qint64 RTSPSessionCache::getDnsTimeout() const {
+			return private_->dnsTimeout_;
+		}
+
+		/// Sets lifetime of cached host addresses.
+		/// \details Applies to libcurl contexts opened later and to the
+		/// native address table.
+		/// \param[in]	timeout	Lifetime in seconds.
+		void RTSPSessionCache::setDnsTimeout(qint64 timeout) {
+			private_->dnsTimeout_ = qMax<qint64>(timeout, 0);
+		}
+
+		/// Returns libcurl share handle.
+		/// \details Connection sharing hands idle connections of one client
+		/// to another, which is only safe when RTP is not interleaved.
+		/// \param[in]	connections	Whether idle connections are shared.
+		/// \return Share handle or nullptr if the cache is disabled.
+		CURLSH* RTSPSessionCache::getShare(bool connections) const {
+			if (!private_->enabled_) return nullptr;
+
+			return connections
+				   ? private_->connectionShare_
+				   : private_->dnsShare_;
+		}
+
+		/// Looks up a cached host address.
+		/// \details Counts a hit if a fresh address is cached, a miss
+		/// otherwise.
+		/// \param[in]	host	Host name.
+		/// \param[in]	port	Port.
+		/// \param[out]	address	Cached address.
+		/// \retval true on cache hit.
+		/// \retval false on cache miss.
+		bool RTSPSessionCache::lookup(const QByteArray& host,
+									  quint16 port,
+									  QByteArray& address) {
+
+			{
+				QMutexLocker locker(&private_->mutex_);
+
+				auto entry = private_->addresses_.constFind(
+					addressKey(host, port));
+
+				if (private_->enabled_										&&
+					entry != private_->addresses_.constEnd()				&&
+					entry->expires_ > private_->clock_.elapsed()) {
+					address = entry->address_;
+					++private_->dnsHits_;
+					return true;
+				}
+			}
+
+			++private_->dnsMisses_;
+
+			return false;
+		}
+
+		/// Stores a resolved host address.
+		/// \details The address expires after the DNS timeout.
+		/// \param[in]	host	Host name.
+		/// \param[in]	port	Port.
+		/// \param[in]	address	Resolved address.
+		void RTSPSessionCache::store(const QByteArray& host,
+									 quint16 port,
+									 const QByteArray& address) {
+
+			if (!private_->enabled_ || address.isEmpty()) return;
+
+			QMutexLocker locker(&private_->mutex_);
+
+			auto& entry = private_->addresses_[addressKey(host, port)];
+			entry.address_ = address;
+			entry.expires_ =
+				private_->clock_.elapsed() + private_->dnsTimeout_ * 1000;
+		}
+
+		/// Records a host lookup answered by a cache or the resolver.
+		/// \details Counts lookups of libcurl, whose DNS cache is not seen
+		/// by the address table.
+		/// \param[in]	cached	Whether a cache answered the lookup.
+		void RTSPSessionCache::recordLookup(bool cached) {
+			if (cached) ++private_->dnsHits_;
+			else ++private_->dnsMisses_;
+		}
+
+		/// Records a request that used a reused or a new connection.
+		/// \details Updates connection counters.
+		/// \param[in]	reused	Whether the connection was reused.
+		void RTSPSessionCache::recordConnection(bool reused) {
+			if (reused) ++private_->connectionHits_;
+			else ++private_->connectionMisses_;
+		}
+
+		/// Returns cache statistics.
+		/// \details Counters are read without a common lock.
+		/// \return Cache statistics.
+		RTSPSessionCacheStatistics RTSPSessionCache::getStatistics() const {
+			RTSPSessionCacheStatistics statistics;
+
+			statistics.dnsHits_ = private_->dnsHits_;
+			statistics.dnsMisses_ = private_->dnsMisses_;
+			statistics.connectionHits_ = private_->connectionHits_;
+			statistics.connectionMisses_ = private_->connectionMisses_;
+
+			return statistics;
+		}
+
+		/// Resets cache statistics.
+		/// \details Cached data is kept.
+		void RTSPSessionCache::resetStatistics() {
+			private_->dnsHits_ = 0;
+			private_->dnsMisses_ = 0;
+			private_->connectionHits_ = 0;
+			private_->connectionMisses_ = 0;
+		}
+
+		/// Locks shared data.
+		/// \details Every shared data type has its own lock.
+		/// \param[in]	context	Local libcurl context.
+		/// \param[in]	data	Shared data type.
+		/// \param[in]	access	Access type.
+		/// \param[in]	user	User-defined data.
+		void RTSPSessionCache::callbackLock(CURL* context,
+											curl_lock_data data,
+											curl_lock_access access,
+											void* user) {
+			Q_UNUSED(context)
+			Q_UNUSED(access)
+
+			auto cache = static_cast<RTSPSessionCachePrivate*>(user);
+			if (cache && data < CURL_LOCK_DATA_LAST) cache->locks_[data].lock();
+		}
+
+		/// Unlocks shared data.
+		/// \details Releases the lock of the shared data type.
+		/// \param[in]	context	Local libcurl context.
+		/// \param[in]	data	Shared data type.
+		/// \param[in]	user	User-defined data.
+		void RTSPSessionCache::callbackUnlock(CURL* context,
+											  curl_lock_data data,
+											  void* user) {
+			Q_UNUSED(context)
+
+			auto cache = static_cast<RTSPSessionCachePrivate*>(user);
+			if (cache && data < CURL_LOCK_DATA_LAST)
+				cache->locks_[data].unlock();
+		}
+	}
+}
@@ -0,0 +1,160 @@
+/// \file RTSPSessionCache.hpp
+/// \brief Contains classes and functions declarations that provide Real Time
+/// Streaming Protocol (RTSP) process-wide session cache.
+/// \bug No known bugs.
+
+#ifndef RTSPSESSIONCACHE_HPP
+#define RTSPSESSIONCACHE_HPP
+
+#include "Base/Export.hpp"
+
+#include <QtCore>
+
+#include <curl.h>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		/// Structure that describes session cache statistics.
+		struct RTSPSessionCacheStatistics final {
+
+			/// Number of host lookups answered by the cache.
+			quint64 dnsHits_ { 0 };
+
+			/// Number of host lookups that went to the resolver.
+			quint64 dnsMisses_ { 0 };
+
+			/// Number of requests sent over a reused connection.
+			quint64 connectionHits_ { 0 };
+
+			/// Number of requests that opened a new connection.
+			quint64 connectionMisses_ { 0 };
+		};
+
+		/// Class that provides process-wide RTSP session cache.
+		/// \details Shares resolved host addresses and idle connections
+		/// between all clients, so streams to the same host skip redundant
+		/// lookups and TCP handshakes. The libcurl backend attaches its
+		/// contexts to libcurl share handles, the native backend uses the
+		/// address table directly.
+		class RTSPCLIENT_EXPORT RTSPSessionCache final {
+		public:
+
+			/// Returns process-wide session cache.
+			/// \return Session cache.
+			static RTSPSessionCache& instance();
+
+		public:
+
+			/// Destructor.
+			~RTSPSessionCache();
+
+			/// Copy constructor.
+			/// \param[in]	object	Object to copy.
+			RTSPSessionCache(const RTSPSessionCache& object) = delete;
+
+			/// Copy assignment operator.
+			/// \param[in]	object	Object to copy.
+			/// \return This object.
+			RTSPSessionCache& operator=(
+				const RTSPSessionCache& object) = delete;
+
+		public:
+
+			/// Indicates whether the cache is enabled.
+			/// \retval true if the cache is enabled.
+			/// \retval false if the cache is disabled.
+			bool isEnabled() const;
+
+			/// Enables or disables the cache for contexts opened later.
+			/// \param[in]	enabled	Whether the cache is enabled.
+			void setEnabled(bool enabled);
+
+			/// Returns lifetime of cached host addresses.
+			/// \return Lifetime in seconds.
+			qint64 getDnsTimeout() const;
+
+			/// Sets lifetime of cached host addresses.
+			/// \param[in]	timeout	Lifetime in seconds.
+			void setDnsTimeout(qint64 timeout);
+
+			/// Returns libcurl share handle.
+			/// \param[in]	connections	Whether idle connections are shared.
+			/// \return Share handle or nullptr if the cache is disabled.
+			CURLSH* getShare(bool connections) const;
+
+			/// Looks up a cached host address.
+			/// \param[in]	host	Host name.
+			/// \param[in]	port	Port.
+			/// \param[out]	address	Cached address.
+			/// \retval true on cache hit.
+			/// \retval false on cache miss.
+			bool lookup(const QByteArray& host,
+						quint16 port,
+						QByteArray& address);
+
+			/// Stores a resolved host address.
+			/// \param[in]	host	Host name.
+			/// \param[in]	port	Port.
+			/// \param[in]	address	Resolved address.
+			void store(const QByteArray& host,
+					   quint16 port,
+					   const QByteArray& address);
+
+			/// Records a host lookup answered by a cache or the resolver.
+			/// \param[in]	cached	Whether a cache answered the lookup.
+			void recordLookup(bool cached);
+
+			/// Records a request that used a reused or a new connection.
+			/// \param[in]	reused	Whether the connection was reused.
+			void recordConnection(bool reused);
+
+			/// Returns cache statistics.
+			/// \return Cache statistics.
+			RTSPSessionCacheStatistics getStatistics() const;
+
+			/// Resets cache statistics.
+			void resetStatistics();
+
+		private:
+
+			/// Default constructor.
+			explicit RTSPSessionCache();
+
+		private:
+
+			/// Locks shared data.
+			/// \param[in]	context	Local libcurl context.
+			/// \param[in]	data	Shared data type.
+			/// \param[in]	access	Access type.
+			/// \param[in]	user	User-defined data.
+			static void callbackLock(CURL* context,
+									 curl_lock_data data,
+									 curl_lock_access access,
+									 void* user);
+
+			/// Unlocks shared data.
+			/// \param[in]	context	Local libcurl context.
+			/// \param[in]	data	Shared data type.
+			/// \param[in]	user	User-defined data.
+			static void callbackUnlock(CURL* context,
+									   curl_lock_data data,
+									   void* user);
+
+		private:
+
+			/// Opaque type for private data.
+			struct RTSPSessionCachePrivate;
+
+			/// Private data.
+			const QScopedPointer<RTSPSessionCachePrivate> private_;
+		};
+	}
+}
+
+#endif
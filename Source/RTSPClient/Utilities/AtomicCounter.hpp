@@ -0,0 +1,33 @@
+/// \file AtomicCounter.hpp
+/// \brief Contains classes and functions declarations that provide counters
+/// written by a single thread.
+/// \bug No known bugs.
+
+#ifndef ATOMICCOUNTER_HPP
+#define ATOMICCOUNTER_HPP
+
+#include <atomic>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		/// Increments a counter written by a single thread.
+		/// \details Loads and stores the counter with relaxed order instead
+		/// of a locked read-modify-write, so readers of other threads may see
+		/// a stale value but never a torn one.
+		/// \param[in]	counter	Counter.
+		/// \param[in]	value	Increment.
+		template <typename T>
+		inline void increment(std::atomic<T>& counter, T value = 1) noexcept {
+			counter.store(counter.load(std::memory_order_relaxed) + value,
+						  std::memory_order_relaxed);
+		}
+	}
+}
+
+#endif
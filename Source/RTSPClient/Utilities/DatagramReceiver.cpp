@@ -0,0 +1,326 @@
+/// \file DatagramReceiver.cpp
+/// \brief Contains classes and functions definitions that provide batched
+/// datagram receiver implementation.
+/// \bug No known bugs.
+
+#include "DatagramReceiver.hpp"
+
+#include <QThreadStorage>
+
+#include <memory>
+
+#ifdef Q_OS_LINUX
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		namespace {
+
+			/// Maximum number of datagrams per receive.
+			/// \details Enough for a burst of a high bitrate stream, larger
+			/// batches rarely fill up.
+			constexpr int BATCH_SIZE { 32 };
+
+			/// Receive buffer size of a datagram.
+			/// \details Fits the largest UDP datagram, so nothing is
+			/// truncated. Buffers are shared by all receivers of a thread.
+			constexpr int DATAGRAM_SIZE { 0x10000 };
+
+			/// Socket receive buffer size.
+			/// \details Absorbs key frame bursts between event loop turns,
+			/// the kernel may cap it.
+			constexpr int SOCKET_BUFFER_SIZE { 2 * 1024 * 1024 };
+		}
+
+		/// Structure that provides receive buffers of a thread.
+		/// \details Message headers are pointed at their buffers and sender
+		/// addresses once, so a receive only passes them to the kernel.
+		struct DatagramReceiver::Batch final {
+
+			/// Constructor.
+			/// \details Allocates buffers once.
+			Batch()
+				: buffer_(new char[BATCH_SIZE * DATAGRAM_SIZE]) {
+
+#ifdef Q_OS_LINUX
+				std::memset(messages_, 0, sizeof(messages_));
+
+				for (auto i = 0; i < BATCH_SIZE; ++i) {
+					vectors_[i].iov_base = buffer_.get() + i * DATAGRAM_SIZE;
+					vectors_[i].iov_len = DATAGRAM_SIZE;
+					messages_[i].msg_hdr.msg_iov = &vectors_[i];
+					messages_[i].msg_hdr.msg_iovlen = 1;
+					messages_[i].msg_hdr.msg_name = &addresses_[i];
+					messages_[i].msg_hdr.msg_namelen = sizeof(addresses_[i]);
+				}
+#endif
+			}
+
+			/// Datagram buffers.
+			std::unique_ptr<char[]> buffer_;
+
+			/// Received datagram sizes.
+			int sizes_[BATCH_SIZE] { };
+
+			/// Received datagram IPv4 sender addresses.
+			quint32 senders_[BATCH_SIZE] { };
+
+#ifdef Q_OS_LINUX
+			/// Buffer descriptors.
+			iovec vectors_[BATCH_SIZE];
+
+			/// Sender addresses.
+			sockaddr_in addresses_[BATCH_SIZE];
+
+			/// Message headers.
+			mmsghdr messages_[BATCH_SIZE];
+#endif
+		};
+
+		/// Default constructor.
+		/// \details The socket is opened by open().
+		DatagramReceiver::DatagramReceiver() noexcept = default;
+
+		/// Destructor.
+		/// \details Closes the socket.
+		DatagramReceiver::~DatagramReceiver() {
+			close();
+		}
+
+		/// Indicates whether batched receive is supported.
+		/// \details Supported on Linux only.
+		/// \retval true if batched receive is supported.
+		/// \retval false if batched receive is not supported.
+		bool DatagramReceiver::isSupported() noexcept {
+#ifdef Q_OS_LINUX
+			return true;
+#else
+			return false;
+#endif
+		}
+
+		/// Returns maximum number of datagrams per receive.
+		/// \details A receive that returns fewer datagrams drained the
+		/// socket.
+		/// \return Batch size.
+		int DatagramReceiver::getBatchSize() noexcept {
+			return BATCH_SIZE;
+		}
+
+		/// Opens the socket.
+		/// \details Binds a non-blocking IPv4 UDP socket to the port on any
+		/// address and enlarges its receive buffer.
+		/// \param[in]	port	Local port.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool DatagramReceiver::open(quint16 port) noexcept {
+			close();
+
+#ifdef Q_OS_LINUX
+			auto descriptor = ::socket(AF_INET,
+									   SOCK_DGRAM | SOCK_NONBLOCK |
+									   SOCK_CLOEXEC,
+									   0);
+
+			if (descriptor < 0) return false;
+
+			sockaddr_in address;
+			std::memset(&address, 0, sizeof(address));
+			address.sin_family = AF_INET;
+			address.sin_addr.s_addr = htonl(INADDR_ANY);
+			address.sin_port = htons(port);
+
+			auto size = SOCKET_BUFFER_SIZE;
+			::setsockopt(descriptor, SOL_SOCKET, SO_RCVBUF,
+						 &size, sizeof(size));
+
+			if (::bind(descriptor,
+					   reinterpret_cast<const sockaddr*>(&address),
+					   sizeof(address)) != 0) {
+				::close(descriptor);
+				return false;
+			}
+
+			descriptor_ = descriptor;
+
+			return true;
+#else
+			Q_UNUSED(port)
+
+			return false;
+#endif
+		}
+
+		/// Closes the socket.
+		/// \details Does nothing if the socket is closed.
+		void DatagramReceiver::close() noexcept {
+#ifdef Q_OS_LINUX
+			if (descriptor_ >= 0) ::close(descriptor_);
+#endif
+			descriptor_ = -1;
+			batch_ = nullptr;
+		}
+
+		/// Indicates whether the socket is open.
+		/// \details Checks the socket descriptor.
+		/// \retval true if the socket is open.
+		/// \retval false if the socket is closed.
+		bool DatagramReceiver::isOpen() const noexcept {
+			return descriptor_ >= 0;
+		}
+
+		/// Returns local port.
+		/// \details Tells the port the system picked when the socket was
+		/// opened on port zero.
+		/// \return Local port or zero if the socket is closed.
+		quint16 DatagramReceiver::getPort() const noexcept {
+#ifdef Q_OS_LINUX
+			sockaddr_in address;
+			socklen_t size = sizeof(address);
+
+			if (descriptor_ < 0 ||
+				::getsockname(descriptor_,
+							  reinterpret_cast<sockaddr*>(&address),
+							  &size) != 0)
+				return 0;
+
+			return ntohs(address.sin_port);
+#else
+			return 0;
+#endif
+		}
+
+		/// Returns socket descriptor.
+		/// \details Lets the caller watch the socket for incoming data.
+		/// \return Socket descriptor or -1 if the socket is closed.
+		qintptr DatagramReceiver::getDescriptor() const noexcept {
+			return descriptor_;
+		}
+
+		/// Receives pending datagrams.
+		/// \details Reads up to a batch of datagrams with one recvmmsg()
+		/// call into the buffers of the calling thread, which are allocated
+		/// by the first receive of the thread. Does not block.
+		/// \return Number of received datagrams, zero if there are none, or
+		/// -1 on error.
+		int DatagramReceiver::receive() noexcept {
+#ifdef Q_OS_LINUX
+			static QThreadStorage<Batch*> storage;
+
+			if (descriptor_ < 0) return -1;
+
+			if (!storage.hasLocalData()) storage.setLocalData(new Batch);
+
+			batch_ = storage.localData();
+
+			int count;
+
+			do {
+				count = ::recvmmsg(descriptor_, batch_->messages_, BATCH_SIZE,
+								   MSG_DONTWAIT, nullptr);
+			}
+			while (count < 0 && errno == EINTR);
+
+			if (count < 0)
+				return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+
+			for (auto i = 0; i < count; ++i) {
+				auto& message = batch_->messages_[i];
+
+				batch_->sizes_[i] = static_cast<int>(message.msg_len);
+				batch_->senders_[i] =
+					message.msg_hdr.msg_namelen == sizeof(sockaddr_in)
+					? ntohl(batch_->addresses_[i].sin_addr.s_addr)
+					: 0;
+
+				message.msg_hdr.msg_namelen = sizeof(sockaddr_in);
+			}
+
+			return count;
+#else
+			return -1;
+#endif
+		}
+
+		/// Returns received datagram data.
+		/// \details Valid until the next receive on the same thread.
+		/// \param[in]	index	Datagram index.
+		/// \return Datagram data.
+		const char* DatagramReceiver::getData(int index) const noexcept {
+			return batch_->buffer_.get() + index * DATAGRAM_SIZE;
+		}
+
+		/// Returns received datagram size.
+		/// \details Valid until the next receive on the same thread.
+		/// \param[in]	index	Datagram index.
+		/// \return Datagram size.
+		int DatagramReceiver::getSize(int index) const noexcept {
+			return batch_->sizes_[index];
+		}
+
+		/// Returns received datagram sender address.
+		/// \details Valid until the next receive on the same thread.
+		/// \param[in]	index	Datagram index.
+		/// \return IPv4 address in host byte order.
+		quint32 DatagramReceiver::getAddress(int index) const noexcept {
+			return batch_->senders_[index];
+		}
+
+		/// Sends a datagram.
+		/// \details Sends from the receiving socket, so replies of the peer
+		/// come back to it. Does not block, a datagram that does not fit
+		/// the send buffer is dropped.
+		/// \param[in]	address	IPv4 address in host byte order.
+		/// \param[in]	port	Port.
+		/// \param[in]	data	Datagram data.
+		/// \param[in]	size	Datagram size.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool DatagramReceiver::send(quint32 address,
+									quint16 port,
+									const char* data,
+									int size) noexcept {
+#ifdef Q_OS_LINUX
+			if (descriptor_ < 0 || !data || size < 0) return false;
+
+			sockaddr_in target;
+			std::memset(&target, 0, sizeof(target));
+
+			target.sin_family = AF_INET;
+			target.sin_port = htons(port);
+			target.sin_addr.s_addr = htonl(address);
+
+			ssize_t sent;
+
+			do {
+				sent = ::sendto(descriptor_, data, static_cast<size_t>(size),
+								MSG_DONTWAIT,
+								reinterpret_cast<sockaddr*>(&target),
+								sizeof(target));
+			}
+			while (sent < 0 && errno == EINTR);
+
+			return sent == size;
+#else
+			Q_UNUSED(address)
+			Q_UNUSED(port)
+			Q_UNUSED(data)
+			Q_UNUSED(size)
+
+			return false;
+#endif
+		}
+	}
+}
@@ -0,0 +1,124 @@
+/// \file DatagramReceiver.hpp
+/// \brief Contains classes and functions declarations that provide batched
+/// datagram receiver implementation.
+/// \bug No known bugs.
+
+#ifndef DATAGRAMRECEIVER_HPP
+#define DATAGRAMRECEIVER_HPP
+
+#include "Base/Export.hpp"
+
+#include <QtGlobal>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		/// Class that provides batched datagram receiver.
+		/// \details Owns a non-blocking UDP socket and reads up to a batch of
+		/// datagrams per system call into buffers shared by all receivers
+		/// of the calling thread. Received datagrams stay valid until the
+		/// next receive on the same thread. Only Linux is supported, where
+		/// recvmmsg() is available, elsewhere the socket does not open.
+		class RTSPCLIENT_EXPORT DatagramReceiver final {
+		public:
+
+			/// Default constructor.
+			explicit DatagramReceiver() noexcept;
+
+			/// Destructor.
+			~DatagramReceiver();
+
+			/// Copy constructor.
+			/// \param[in]	object	Object to copy.
+			DatagramReceiver(const DatagramReceiver& object) = delete;
+
+			/// Copy assignment operator.
+			/// \param[in]	object	Object to copy.
+			/// \return This object.
+			DatagramReceiver& operator=(
+				const DatagramReceiver& object) = delete;
+
+		public:
+
+			/// Indicates whether batched receive is supported.
+			/// \retval true if batched receive is supported.
+			/// \retval false if batched receive is not supported.
+			static bool isSupported() noexcept;
+
+			/// Returns maximum number of datagrams per receive.
+			/// \return Batch size.
+			static int getBatchSize() noexcept;
+
+			/// Opens the socket.
+			/// \param[in]	port	Local port.
+			/// \retval true on success.
+			/// \retval false on error.
+			bool open(quint16 port) noexcept;
+
+			/// Closes the socket.
+			void close() noexcept;
+
+			/// Indicates whether the socket is open.
+			/// \retval true if the socket is open.
+			/// \retval false if the socket is closed.
+			bool isOpen() const noexcept;
+
+			/// Returns local port.
+			/// \return Local port or zero if the socket is closed.
+			quint16 getPort() const noexcept;
+
+			/// Returns socket descriptor.
+			/// \return Socket descriptor or -1 if the socket is closed.
+			qintptr getDescriptor() const noexcept;
+
+			/// Receives pending datagrams.
+			/// \return Number of received datagrams or -1 on error.
+			int receive() noexcept;
+
+			/// Returns received datagram data.
+			/// \param[in]	index	Datagram index.
+			/// \return Datagram data.
+			const char* getData(int index) const noexcept;
+
+			/// Returns received datagram size.
+			/// \param[in]	index	Datagram index.
+			/// \return Datagram size.
+			int getSize(int index) const noexcept;
+
+			/// Returns received datagram sender address.
+			/// \param[in]	index	Datagram index.
+			/// \return IPv4 address in host byte order.
+			quint32 getAddress(int index) const noexcept;
+
+			/// Sends a datagram.
+			/// \param[in]	address	IPv4 address in host byte order.
+			/// \param[in]	port	Port.
+			/// \param[in]	data	Datagram data.
+			/// \param[in]	size	Datagram size.
+			/// \retval true on success.
+			/// \retval false on error.
+			bool send(quint32 address,
+					  quint16 port,
+					  const char* data,
+					  int size) noexcept;
+
+		private:
+
+			/// Opaque type for receive buffers of a thread.
+			struct Batch;
+
+			/// Socket descriptor.
+			int descriptor_ { -1 };
+
+			/// Buffers of the last receive.
+			Batch* batch_ { nullptr };
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,194 @@
+/// \file LatencyHistogram.cpp
+/// \brief Contains classes and functions definitions that provide latency
+/// histogram implementation.
+/// \bug No known bugs.
+
+#include "LatencyHistogram.hpp"
+
+#include <QtAlgorithms>
+
+#include <cmath>
+#include <limits>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		namespace {
+
+			/// Number of bits that select a bucket within a power of two.
+			/// \details 32 buckets per power of two.
+			constexpr int SUB_BUCKET_BITS { 5 };
+
+			/// Number of buckets within a power of two.
+			/// \details Derived from the sub-bucket index size.
+			constexpr quint64 SUB_BUCKET_COUNT {
+				quint64(1) << SUB_BUCKET_BITS
+			};
+
+			/// Values below this limit have a bucket each.
+			/// \details The first two powers of two of sub-buckets.
+			constexpr quint64 EXACT_LIMIT { SUB_BUCKET_COUNT * 2 };
+
+			/// Exponent of the exact limit.
+			/// \details Exponent of the first log-linear power of two.
+			constexpr int EXACT_EXPONENT { SUB_BUCKET_BITS + 1 };
+
+			/// Returns exponent of the highest set bit.
+			/// \param[in]	value	Non-zero value.
+			/// \return Exponent.
+			int exponent(quint64 value) noexcept {
+				return 63 - static_cast<int>(qCountLeadingZeroBits(value));
+			}
+		}
+
+		/// Default constructor.
+		/// \details Clears bucket counters.
+		LatencyHistogram::LatencyHistogram() {
+			reset();
+		}
+
+		/// Destructor.
+		/// \details Releases nothing.
+		LatencyHistogram::~LatencyHistogram() = default;
+
+		/// Records a value.
+		/// \details Takes a few relaxed atomic operations, so it is cheap
+		/// enough for every request. Values beyond the range fall into the
+		/// last bucket.
+		/// \param[in]	value	Value, negative values are ignored.
+		void LatencyHistogram::record(qint64 value) noexcept {
+			if (value < 0) return;
+
+			auto magnitude = static_cast<quint64>(value);
+			int index;
+
+			if (magnitude < EXACT_LIMIT) index = static_cast<int>(magnitude);
+			else {
+				auto power = exponent(magnitude);
+				auto sub = (magnitude >> (power - SUB_BUCKET_BITS)) -
+						   SUB_BUCKET_COUNT;
+
+				index = static_cast<int>(
+					EXACT_LIMIT +
+					static_cast<quint64>(power - EXACT_EXPONENT) *
+					SUB_BUCKET_COUNT + sub);
+			}
+
+			index = qMin(index, BUCKET_COUNT - 1);
+
+			buckets_[index].fetch_add(1, std::memory_order_relaxed);
+			count_.fetch_add(1, std::memory_order_relaxed);
+			sum_.fetch_add(magnitude, std::memory_order_relaxed);
+
+			auto minimum = minimum_.load(std::memory_order_relaxed);
+
+			while (value < minimum &&
+				   !minimum_.compare_exchange_weak(
+					   minimum, value, std::memory_order_relaxed));
+
+			auto maximum = maximum_.load(std::memory_order_relaxed);
+
+			while (value > maximum &&
+				   !maximum_.compare_exchange_weak(
+					   maximum, value, std::memory_order_relaxed));
+		}
+
+		/// Returns number of recorded values.
+		/// \details Returns value counter.
+		/// \return Number of recorded values.
+		quint64 LatencyHistogram::getCount() const noexcept {
+			return count_.load(std::memory_order_relaxed);
+		}
+
+		/// Returns the lowest recorded value.
+		/// \details Exact, not rounded to a bucket.
+		/// \return Lowest value or zero if nothing was recorded.
+		qint64 LatencyHistogram::getMinimum() const noexcept {
+			if (getCount() == 0) return 0;
+
+			return minimum_.load(std::memory_order_relaxed);
+		}
+
+		/// Returns the highest recorded value.
+		/// \details Exact, not rounded to a bucket.
+		/// \return Highest value or zero if nothing was recorded.
+		qint64 LatencyHistogram::getMaximum() const noexcept {
+			return maximum_.load(std::memory_order_relaxed);
+		}
+
+		/// Returns mean of recorded values.
+		/// \details Exact, not rounded to buckets.
+		/// \return Mean value or zero if nothing was recorded.
+		double LatencyHistogram::getMean() const noexcept {
+			auto count = getCount();
+			if (count == 0) return 0;
+
+			return static_cast<double>(sum_.load(std::memory_order_relaxed)) /
+				   count;
+		}
+
+		/// Returns value at a percentile.
+		/// \details Walks bucket counters, so values recorded meanwhile may
+		/// or may not be taken into account. The result never exceeds the
+		/// highest recorded value.
+		/// \param[in]	percentile	Percentile from 0 to 100.
+		/// \return Upper bound of the bucket that holds the percentile,
+		/// or zero if nothing was recorded.
+		qint64 LatencyHistogram::getPercentile(double percentile)
+			const noexcept {
+
+			quint64 total = 0;
+
+			for (const auto& bucket : buckets_)
+				total += bucket.load(std::memory_order_relaxed);
+
+			if (total == 0) return 0;
+
+			auto rank = static_cast<quint64>(
+				std::ceil(qBound(0.0, percentile, 100.0) / 100.0 * total));
+
+			rank = qMax<quint64>(rank, 1);
+
+			quint64 seen = 0;
+			auto index = 0;
+
+			for (; index < BUCKET_COUNT - 1; ++index) {
+				seen += buckets_[index].load(std::memory_order_relaxed);
+				if (seen >= rank) break;
+			}
+
+			quint64 bound;
+
+			if (index < static_cast<int>(EXACT_LIMIT))
+				bound = static_cast<quint64>(index);
+			else {
+				auto offset = static_cast<quint64>(index) - EXACT_LIMIT;
+				auto power = EXACT_EXPONENT +
+							 static_cast<int>(offset / SUB_BUCKET_COUNT);
+				auto sub = offset % SUB_BUCKET_COUNT + SUB_BUCKET_COUNT;
+
+				bound = ((sub + 1) << (power - SUB_BUCKET_BITS)) - 1;
+			}
+
+			return qMin(static_cast<qint64>(bound), getMaximum());
+		}
+
+		/// Removes all recorded values.
+		/// \details Must not be called concurrently with record().
+		void LatencyHistogram::reset() noexcept {
+			for (auto& bucket : buckets_)
+				bucket.store(0, std::memory_order_relaxed);
+
+			count_.store(0, std::memory_order_relaxed);
+			sum_.store(0, std::memory_order_relaxed);
+			minimum_.store(std::numeric_limits<qint64>::max(),
+						   std::memory_order_relaxed);
+			maximum_.store(0, std::memory_order_relaxed);
+		}
+	}
+}
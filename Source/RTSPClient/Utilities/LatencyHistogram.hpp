@@ -0,0 +1,103 @@
+/// \file LatencyHistogram.hpp
+/// \brief Contains classes and functions declarations that provide latency
+/// histogram implementation.
+/// \bug No known bugs.
+
+#ifndef LATENCYHISTOGRAM_HPP
+#define LATENCYHISTOGRAM_HPP
+
+#include "Base/Export.hpp"
+
+#include <QtGlobal>
+
+#include <atomic>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		/// Class that provides latency histogram implementation.
+		/// \details Counts values in log-linear buckets like HDR histograms:
+		/// values below 64 are exact, larger values fall into 32 buckets per
+		/// power of two, which bounds the relative error of percentiles by
+		/// about 3%. Values up to 2^36 are distinguished. Any number of
+		/// threads may record and read without locks.
+		class RTSPCLIENT_EXPORT LatencyHistogram final {
+		public:
+
+			/// Default constructor.
+			explicit LatencyHistogram();
+
+			/// Destructor.
+			~LatencyHistogram();
+
+			/// Copy constructor.
+			/// \param[in]	object	Object to copy.
+			LatencyHistogram(const LatencyHistogram& object) = delete;
+
+			/// Copy assignment operator.
+			/// \param[in]	object	Object to copy.
+			/// \return This object.
+			LatencyHistogram& operator=(
+				const LatencyHistogram& object) = delete;
+
+		public:
+
+			/// Records a value.
+			/// \param[in]	value	Value, negative values are ignored.
+			void record(qint64 value) noexcept;
+
+			/// Returns number of recorded values.
+			/// \return Number of recorded values.
+			quint64 getCount() const noexcept;
+
+			/// Returns the lowest recorded value.
+			/// \return Lowest value or zero if nothing was recorded.
+			qint64 getMinimum() const noexcept;
+
+			/// Returns the highest recorded value.
+			/// \return Highest value or zero if nothing was recorded.
+			qint64 getMaximum() const noexcept;
+
+			/// Returns mean of recorded values.
+			/// \return Mean value or zero if nothing was recorded.
+			double getMean() const noexcept;
+
+			/// Returns value at a percentile.
+			/// \param[in]	percentile	Percentile from 0 to 100.
+			/// \return Upper bound of the bucket that holds the percentile,
+			/// or zero if nothing was recorded.
+			qint64 getPercentile(double percentile) const noexcept;
+
+			/// Removes all recorded values.
+			/// \details Must not be called concurrently with record().
+			void reset() noexcept;
+
+		private:
+
+			/// Number of buckets.
+			static constexpr int BUCKET_COUNT { 1024 };
+
+			/// Bucket counters.
+			std::atomic<quint32> buckets_[BUCKET_COUNT];
+
+			/// Number of recorded values.
+			std::atomic<quint64> count_ { 0 };
+
+			/// Sum of recorded values.
+			std::atomic<quint64> sum_ { 0 };
+
+			/// Lowest recorded value.
+			std::atomic<qint64> minimum_;
+
+			/// Highest recorded value.
+			std::atomic<qint64> maximum_ { 0 };
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,478 @@
+/// \file PacketBufferPool.cpp
+/// \brief Contains classes and functions definitions that provide packet
+/// buffer pool implementation.
+/// \bug No known bugs.
+
+#include "PacketBufferPool.hpp"
+#include "AtomicCounter.hpp"
+
+#include <QMutex>
+#include <QThread>
+#include <QThreadStorage>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		namespace {
+
+			/// Capacity of a pooled buffer.
+			/// \details Fits a datagram of an Ethernet link, RTP senders
+			/// keep packets below the path MTU.
+			constexpr int BUFFER_CAPACITY { 2048 };
+
+			/// Number of buffers in a slab.
+			/// \details A pool grows by a slab at a time, so it reaches its
+			/// working set after a few heap allocations.
+			constexpr int SLAB_SIZE { 64 };
+		}
+
+		/// Structure that describes a buffer.
+		/// \details Pooled buffers keep their data inline, larger buffers
+		/// point to a heap block and have no pool.
+		struct PacketBufferPool::Block final {
+
+			/// Inline data of a pooled buffer.
+			char storage_[BUFFER_CAPACITY];
+
+			/// Number of references.
+			std::atomic<int> references_ { 0 };
+
+			/// Owning pool, nullptr for a heap buffer.
+			PacketBufferPoolPrivate* pool_ { nullptr };
+
+			/// Next buffer of a free list.
+			Block* next_ { nullptr };
+
+			/// Buffer data.
+			char* data_ { storage_ };
+
+			/// Buffer size.
+			int size_ { 0 };
+
+			/// Buffer capacity.
+			int capacity_ { BUFFER_CAPACITY };
+		};
+
+		/// Structure that provides private storage.
+		/// \details Maintains private data. Every buffer in use holds a
+		/// reference, so the data outlives the pool and the thread.
+		struct PacketBufferPool::PacketBufferPoolPrivate final {
+
+			/// Number of references.
+			/// \details The pool and every buffer in use hold one.
+			std::atomic<int> references_ { 1 };
+
+			/// Whether the pool exists.
+			/// \details Cleared by the owning thread when it finishes.
+			std::atomic<bool> alive_ { true };
+
+			/// Owning thread.
+			Qt::HANDLE owner_ { QThread::currentThreadId() };
+
+			/// Free buffers.
+			/// \details Used by the owning thread only.
+			Block* free_ { nullptr };
+
+			/// Buffers released by other threads.
+			/// \details Lock-free stack, the owning thread takes all of
+			/// them at once, so popping is free of the ABA problem.
+			std::atomic<Block*> returned_ { nullptr };
+
+			/// Allocated slabs.
+			std::vector<std::unique_ptr<Block[]>> slabs_;
+
+			/// Number of allocated buffers.
+			/// \details Written by the owning thread only, as are the rest
+			/// of the counters.
+			std::atomic<quint64> allocations_ { 0 };
+
+			/// Number of buffers taken from free lists.
+			std::atomic<quint64> hits_ { 0 };
+
+			/// Number of buffers in use.
+			std::atomic<int> used_ { 0 };
+
+			/// Highest number of buffers in use.
+			std::atomic<int> highWater_ { 0 };
+
+			/// Number of pooled buffers.
+			std::atomic<int> capacity_ { 0 };
+		};
+
+		namespace {
+
+			/// Structure that describes all pools of the process.
+			/// \details Lets statistics be summed, the lock is taken when a
+			/// thread creates or destroys its pool and on statistics reads.
+			struct Registry final {
+
+				/// Registry lock.
+				QMutex mutex_;
+
+				/// Pools of the process.
+				std::vector<const PacketBufferPool*> pools_;
+			};
+
+			/// Returns registry of all pools.
+			/// \details Never destroyed, so pools of threads that finish
+			/// after the process exit starts can still leave it.
+			/// \return Pool registry.
+			Registry& registry() {
+				static auto instance = new Registry;
+
+				return *instance;
+			}
+		}
+
+		/// Default constructor.
+		/// \details Creates an empty pool owned by the calling thread and
+		/// registers it. Slabs are allocated on demand.
+		PacketBufferPool::PacketBufferPool()
+			: private_(new PacketBufferPoolPrivate) {
+
+			auto& instance = registry();
+			QMutexLocker locker(&instance.mutex_);
+			instance.pools_.push_back(this);
+		}
+
+		/// Destructor.
+		/// \details Unregisters the pool. Its memory is released when the
+		/// last buffer in use returns.
+		PacketBufferPool::~PacketBufferPool() {
+			auto& instance = registry();
+
+			{
+				QMutexLocker locker(&instance.mutex_);
+				instance.pools_.erase(std::remove(instance.pools_.begin(),
+												  instance.pools_.end(),
+												  this),
+									  instance.pools_.end());
+			}
+
+			private_->alive_.store(false, std::memory_order_release);
+
+			if (private_->references_.fetch_sub(
+					1, std::memory_order_acq_rel) == 1)
+				delete private_;
+		}
+
+		/// Returns pool of the calling thread.
+		/// \details Every thread gets its own pool, so allocation takes no
+		/// locks.
+		/// \return Packet buffer pool.
+		PacketBufferPool& PacketBufferPool::shared() {
+			static QThreadStorage<PacketBufferPool*> storage;
+
+			if (!storage.hasLocalData())
+				storage.setLocalData(new PacketBufferPool);
+
+			return *storage.localData();
+		}
+
+		/// Returns capacity of a pooled buffer.
+		/// \details Larger buffers are not pooled.
+		/// \return Buffer capacity in bytes.
+		int PacketBufferPool::getBufferCapacity() noexcept {
+			return BUFFER_CAPACITY;
+		}
+
+		/// Returns statistics of all pools of the process.
+		/// \details Sums statistics of the pools of running threads. The
+		/// high-water mark is the sum of those of the pools, an upper bound
+		/// of the process-wide one.
+		/// \return Packet buffer pool statistics.
+		PacketBufferStatistics PacketBufferPool::getTotalStatistics() {
+			PacketBufferStatistics total;
+
+			auto& instance = registry();
+			QMutexLocker locker(&instance.mutex_);
+
+			for (auto pool : instance.pools_) {
+				auto statistics = pool->getStatistics();
+
+				total.allocations_ += statistics.allocations_;
+				total.hits_ += statistics.hits_;
+				total.used_ += statistics.used_;
+				total.highWater_ += statistics.highWater_;
+				total.capacity_ += statistics.capacity_;
+			}
+
+			if (total.allocations_ > 0)
+				total.hitRate_ = static_cast<double>(total.hits_) /
+								 total.allocations_;
+
+			return total;
+		}
+
+		/// Allocates a buffer.
+		/// \details Must be called from the owning thread. Takes a buffer
+		/// from the free list, then from buffers released by other threads,
+		/// and allocates a new slab only if both are empty. A buffer larger
+		/// than the pooled capacity is allocated on the heap.
+		/// \param[in]	size	Buffer size, negative size is taken as zero.
+		/// \return Packet buffer.
+		PacketBuffer PacketBufferPool::allocate(int size) {
+			auto& p = *private_;
+
+			size = qMax(size, 0);
+
+			increment(p.allocations_);
+
+			if (size > BUFFER_CAPACITY) {
+				auto block = new Block;
+				block->data_ = new char[size];
+				block->capacity_ = size;
+				block->size_ = size;
+				block->references_.store(1, std::memory_order_relaxed);
+
+				return PacketBuffer(block);
+			}
+
+			if (!p.free_) {
+				p.free_ = p.returned_.exchange(nullptr,
+											   std::memory_order_acquire);
+
+				auto returned = 0;
+				for (auto block = p.free_; block; block = block->next_)
+					++returned;
+
+				increment(p.used_, -returned);
+			}
+
+			if (p.free_) increment(p.hits_);
+			else {
+				std::unique_ptr<Block[]> slab(new Block[SLAB_SIZE]);
+
+				for (auto i = 0; i < SLAB_SIZE; ++i) {
+					slab[i].pool_ = private_;
+					slab[i].next_ = i + 1 < SLAB_SIZE ? &slab[i + 1] : nullptr;
+				}
+
+				p.free_ = &slab[0];
+				p.slabs_.push_back(std::move(slab));
+
+				increment(p.capacity_, SLAB_SIZE);
+			}
+
+			auto block = p.free_;
+			p.free_ = block->next_;
+
+			block->next_ = nullptr;
+			block->size_ = size;
+			block->references_.store(1, std::memory_order_relaxed);
+
+			p.references_.fetch_add(1, std::memory_order_relaxed);
+
+			increment(p.used_);
+
+			auto used = p.used_.load(std::memory_order_relaxed);
+			if (used > p.highWater_.load(std::memory_order_relaxed))
+				p.highWater_.store(used, std::memory_order_relaxed);
+
+			return PacketBuffer(block);
+		}
+
+		/// Returns pool statistics.
+		/// \details Safe to call from any thread. Counters are read one by
+		/// one, so they may belong to adjacent allocations.
+		/// \return Packet buffer pool statistics.
+		PacketBufferStatistics PacketBufferPool::getStatistics() const {
+			const auto& p = *private_;
+
+			PacketBufferStatistics statistics;
+
+			statistics.allocations_ =
+				p.allocations_.load(std::memory_order_relaxed);
+			statistics.hits_ = p.hits_.load(std::memory_order_relaxed);
+			statistics.used_ = p.used_.load(std::memory_order_relaxed);
+			statistics.highWater_ =
+				p.highWater_.load(std::memory_order_relaxed);
+			statistics.capacity_ =
+				p.capacity_.load(std::memory_order_relaxed);
+
+			if (statistics.allocations_ > 0)
+				statistics.hitRate_ =
+					static_cast<double>(statistics.hits_) /
+					statistics.allocations_;
+
+			return statistics;
+		}
+
+		/// Returns a buffer to its pool.
+		/// \details The owning thread puts the buffer on the free list,
+		/// other threads and threads of a destroyed pool push it to the
+		/// returned buffers. Releases the pool memory with the last buffer
+		/// of a destroyed pool.
+		/// \param[in]	block	Buffer.
+		void PacketBufferPool::recycle(Block* block) {
+			auto pool = block->pool_;
+
+			if (!pool) {
+				delete[] block->data_;
+				delete block;
+				return;
+			}
+
+			if (pool->owner_ == QThread::currentThreadId() &&
+				pool->alive_.load(std::memory_order_acquire)) {
+				block->next_ = pool->free_;
+				pool->free_ = block;
+
+				increment(pool->used_, -1);
+			}
+			else {
+				auto head = pool->returned_.load(std::memory_order_relaxed);
+
+				do block->next_ = head;
+				while (!pool->returned_.compare_exchange_weak(
+					head, block,
+					std::memory_order_release,
+					std::memory_order_relaxed));
+			}
+
+			if (pool->references_.fetch_sub(1, std::memory_order_acq_rel) ==
+				1)
+				delete pool;
+		}
+
+		/// Constructor.
+		/// \details Takes the reference of a newly allocated buffer.
+		/// \param[in]	block	Allocated buffer.
+		PacketBuffer::PacketBuffer(PacketBufferPool::Block* block) noexcept
+			: block_(block) {
+
+		}
+
+		/// Destructor.
+		/// \details Releases the buffer.
+		PacketBuffer::~PacketBuffer() {
+			clear();
+		}
+
+		/// Copy constructor.
+		/// \details Shares the buffer.
+		/// \param[in]	object	Object to copy.
+		PacketBuffer::PacketBuffer(const PacketBuffer& object) noexcept
+			: block_(object.block_) {
+
+			if (block_)
+				block_->references_.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		/// Move constructor.
+		/// \details Takes the buffer and leaves the object null.
+		/// \param[in]	object	Object to move.
+		PacketBuffer::PacketBuffer(PacketBuffer&& object) noexcept
+			: block_(object.block_) {
+
+			object.block_ = nullptr;
+		}
+
+		/// Copy assignment operator.
+		/// \details Shares the buffer and releases the previous one.
+		/// \param[in]	object	Object to copy.
+		/// \return This object.
+		PacketBuffer& PacketBuffer::operator=(
+			const PacketBuffer& object) noexcept {
+
+			if (object.block_)
+				object.block_->references_.fetch_add(
+					1, std::memory_order_relaxed);
+
+			clear();
+			block_ = object.block_;
+
+			return *this;
+		}
+
+		/// Move assignment operator.
+		/// \details Takes the buffer and releases the previous one.
+		/// \param[in]	object	Object to move.
+		/// \return This object.
+		PacketBuffer& PacketBuffer::operator=(PacketBuffer&& object) noexcept {
+			if (this != &object) {
+				clear();
+				block_ = object.block_;
+				object.block_ = nullptr;
+			}
+
+			return *this;
+		}
+
+		/// Indicates whether the buffer is null.
+		/// \details A default constructed, moved or cleared buffer is null.
+		/// \retval true if the buffer is null.
+		/// \retval false if the buffer is not null.
+		bool PacketBuffer::isNull() const noexcept {
+			return block_ == nullptr;
+		}
+
+		/// Indicates whether the buffer is shared by several copies.
+		/// \details A shared buffer must not be modified.
+		/// \retval true if the buffer is shared.
+		/// \retval false if the buffer is not shared.
+		bool PacketBuffer::isShared() const noexcept {
+			return block_ &&
+				   block_->references_.load(std::memory_order_acquire) > 1;
+		}
+
+		/// Returns buffer data.
+		/// \details Returns nullptr for a null buffer.
+		/// \return Buffer data.
+		char* PacketBuffer::getData() noexcept {
+			return block_ ? block_->data_ : nullptr;
+		}
+
+		/// Returns buffer data.
+		/// \details Returns nullptr for a null buffer.
+		/// \return Buffer data.
+		const char* PacketBuffer::getData() const noexcept {
+			return block_ ? block_->data_ : nullptr;
+		}
+
+		/// Returns buffer size.
+		/// \details Returns zero for a null buffer.
+		/// \return Buffer size.
+		int PacketBuffer::getSize() const noexcept {
+			return block_ ? block_->size_ : 0;
+		}
+
+		/// Sets buffer size.
+		/// \details Shrinks the buffer after a short read, the size is
+		/// bounded by the capacity. Does nothing for a null buffer.
+		/// \param[in]	size	Buffer size, up to the capacity.
+		void PacketBuffer::setSize(int size) noexcept {
+			if (block_) block_->size_ = qBound(0, size, block_->capacity_);
+		}
+
+		/// Returns buffer capacity.
+		/// \details Returns zero for a null buffer.
+		/// \return Buffer capacity.
+		int PacketBuffer::getCapacity() const noexcept {
+			return block_ ? block_->capacity_ : 0;
+		}
+
+		/// Releases the buffer.
+		/// \details The last reference returns the buffer to its pool. The
+		/// object becomes null.
+		void PacketBuffer::clear() noexcept {
+			if (!block_) return;
+
+			if (block_->references_.fetch_sub(1, std::memory_order_acq_rel) ==
+				1)
+				PacketBufferPool::recycle(block_);
+
+			block_ = nullptr;
+		}
+	}
+}
@@ -0,0 +1,206 @@
+/// \file PacketBufferPool.hpp
+/// \brief Contains classes and functions declarations that provide packet
+/// buffer pool implementation.
+/// \bug No known bugs.
+
+#ifndef PACKETBUFFERPOOL_HPP
+#define PACKETBUFFERPOOL_HPP
+
+#include "Base/Export.hpp"
+
+#include <QtGlobal>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		class PacketBuffer;
+
+		/// Structure that provides packet buffer pool statistics.
+		/// \details Counters cover the whole life of the pool.
+		struct PacketBufferStatistics final {
+
+			/// Number of allocated buffers.
+			quint64 allocations_ { 0 };
+
+			/// Number of buffers taken from free lists.
+			/// \details Other allocations call the heap allocator.
+			quint64 hits_ { 0 };
+
+			/// Ratio of hits to allocations.
+			double hitRate_ { 0 };
+
+			/// Number of buffers in use.
+			/// \details Buffers released by other threads are counted
+			/// until their pool takes them back.
+			int used_ { 0 };
+
+			/// Highest number of buffers in use.
+			int highWater_ { 0 };
+
+			/// Number of pooled buffers, in use or free.
+			int capacity_ { 0 };
+		};
+
+		/// Class that provides pool of packet buffers.
+		/// \details Every thread has a pool of fixed-size buffers that fit a
+		/// datagram of an Ethernet link. Buffers are allocated in slabs and
+		/// recycled through a free list of the pool, so the owning thread
+		/// allocates and releases them without locks. A buffer released by
+		/// another thread goes to a lock-free list of its pool, which the
+		/// pool takes back when its free list runs out. Larger buffers are
+		/// allocated on the heap.
+		class RTSPCLIENT_EXPORT PacketBufferPool final {
+
+			friend class PacketBuffer;
+
+		public:
+
+			/// Returns pool of the calling thread.
+			/// \return Packet buffer pool.
+			static PacketBufferPool& shared();
+
+			/// Returns capacity of a pooled buffer.
+			/// \return Buffer capacity in bytes.
+			static int getBufferCapacity() noexcept;
+
+			/// Returns statistics of all pools of the process.
+			/// \return Packet buffer pool statistics.
+			static PacketBufferStatistics getTotalStatistics();
+
+		public:
+
+			/// Destructor.
+			~PacketBufferPool();
+
+			/// Copy constructor.
+			/// \param[in]	object	Object to copy.
+			PacketBufferPool(const PacketBufferPool& object) = delete;
+
+			/// Copy assignment operator.
+			/// \param[in]	object	Object to copy.
+			/// \return This object.
+			PacketBufferPool& operator=(
+				const PacketBufferPool& object) = delete;
+
+		public:
+
+			/// Allocates a buffer.
+			/// \param[in]	size	Buffer size.
+			/// \return Packet buffer.
+			PacketBuffer allocate(int size);
+
+			/// Returns pool statistics.
+			/// \return Packet buffer pool statistics.
+			PacketBufferStatistics getStatistics() const;
+
+		private:
+
+			/// Default constructor.
+			explicit PacketBufferPool();
+
+			/// Opaque type for a buffer.
+			struct Block;
+
+			/// Returns a buffer to its pool.
+			/// \param[in]	block	Buffer.
+			static void recycle(Block* block);
+
+		private:
+
+			/// Opaque type for private data.
+			struct PacketBufferPoolPrivate;
+
+			/// Private data.
+			/// \details Outlives the pool while its buffers are in use.
+			PacketBufferPoolPrivate* const private_;
+		};
+
+		/// Class that provides reference-counted packet buffer.
+		/// \details Copies share the buffer, which returns to its pool when
+		/// the last copy is destroyed. Copies may be destroyed by any thread.
+		class RTSPCLIENT_EXPORT PacketBuffer final {
+
+			friend class PacketBufferPool;
+
+		public:
+
+			/// Default constructor.
+			/// \details Creates a null buffer.
+			PacketBuffer() noexcept = default;
+
+			/// Destructor.
+			~PacketBuffer();
+
+			/// Copy constructor.
+			/// \param[in]	object	Object to copy.
+			PacketBuffer(const PacketBuffer& object) noexcept;
+
+			/// Move constructor.
+			/// \param[in]	object	Object to move.
+			PacketBuffer(PacketBuffer&& object) noexcept;
+
+			/// Copy assignment operator.
+			/// \param[in]	object	Object to copy.
+			/// \return This object.
+			PacketBuffer& operator=(const PacketBuffer& object) noexcept;
+
+			/// Move assignment operator.
+			/// \param[in]	object	Object to move.
+			/// \return This object.
+			PacketBuffer& operator=(PacketBuffer&& object) noexcept;
+
+		public:
+
+			/// Indicates whether the buffer is null.
+			/// \retval true if the buffer is null.
+			/// \retval false if the buffer is not null.
+			bool isNull() const noexcept;
+
+			/// Indicates whether the buffer is shared by several copies.
+			/// \retval true if the buffer is shared.
+			/// \retval false if the buffer is not shared.
+			bool isShared() const noexcept;
+
+			/// Returns buffer data.
+			/// \return Buffer data.
+			char* getData() noexcept;
+
+			/// Returns buffer data.
+			/// \return Buffer data.
+			const char* getData() const noexcept;
+
+			/// Returns buffer size.
+			/// \return Buffer size.
+			int getSize() const noexcept;
+
+			/// Sets buffer size.
+			/// \param[in]	size	Buffer size, up to the capacity.
+			void setSize(int size) noexcept;
+
+			/// Returns buffer capacity.
+			/// \return Buffer capacity.
+			int getCapacity() const noexcept;
+
+			/// Releases the buffer.
+			void clear() noexcept;
+
+		private:
+
+			/// Constructor.
+			/// \param[in]	block	Allocated buffer.
+			explicit PacketBuffer(PacketBufferPool::Block* block) noexcept;
+
+		private:
+
+			/// Shared buffer.
+			PacketBufferPool::Block* block_ { nullptr };
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,198 @@
+/// \file PacketRingBuffer.cpp
+/// \brief Contains classes and functions definitions that provide packet ring
+/// buffer implementation.
+/// \bug No known bugs.
+
+#include "PacketRingBuffer.hpp"
+
+#include <cstring>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		namespace {
+
+			/// Packet header size.
+			/// \details Every packet is prefixed with its size.
+			constexpr quint32 PACKET_HEADER_SIZE { 4 };
+
+			/// Header value that marks unused space at the buffer end.
+			/// \details The reader skips to the buffer start.
+			constexpr quint32 PACKET_WRAP_MARKER { 0xFFFFFFFF };
+
+			/// Minimum buffer capacity.
+			/// \details Large enough for a single maximum interleaved packet.
+			constexpr quint32 MINIMUM_CAPACITY { 0x10000 + PACKET_HEADER_SIZE };
+
+			/// Returns packet footprint in the buffer.
+			/// \param[in]	size	Packet size.
+			/// \return Aligned packet size with header.
+			constexpr quint32 footprint(quint32 size) {
+				return PACKET_HEADER_SIZE + ((size + 3) & ~quint32(3));
+			}
+
+			/// Returns buffer capacity rounded up to a power of two.
+			/// \param[in]	capacity	Requested capacity.
+			/// \return Buffer capacity.
+			quint32 roundCapacity(int capacity) {
+				auto requested = static_cast<quint32>(qMax(capacity, 0));
+				auto rounded = quint32(1);
+
+				while (rounded < requested || rounded < MINIMUM_CAPACITY)
+					rounded <<= 1;
+
+				return rounded;
+			}
+		}
+
+		/// Constructor.
+		/// \details Allocates buffer memory once.
+		/// \param[in]	capacity	Buffer capacity in bytes.
+		PacketRingBuffer::PacketRingBuffer(int capacity)
+			: capacity_(roundCapacity(capacity)) {
+
+			buffer_.reset(new char[capacity_]);
+		}
+
+		/// Destructor.
+		/// \details Defaulted default destructor.
+		PacketRingBuffer::~PacketRingBuffer() = default;
+
+		/// Reserves contiguous space for the next packet.
+		/// \details Called by the producer. If the packet does not fit before
+		/// the buffer end, the remaining space is skipped.
+		/// \param[in]	size	Packet size.
+		/// \return Pointer to packet data or nullptr if there is no room.
+		char* PacketRingBuffer::reserve(int size) noexcept {
+			if (size < 0) return nullptr;
+
+			auto need = footprint(static_cast<quint32>(size));
+			auto head = head_.load(std::memory_order_relaxed);
+			auto tail = tail_.load(std::memory_order_acquire);
+			auto available = capacity_ - (head - tail);
+			auto offset = head & (capacity_ - 1);
+			auto contiguous = capacity_ - offset;
+
+			skipped_ = contiguous < need ? contiguous : 0;
+
+			if (need > capacity_ || available < skipped_ + need) {
+				reserved_ = 0;
+				skipped_ = 0;
+				dropped_.fetch_add(1, std::memory_order_relaxed);
+				return nullptr;
+			}
+
+			reserved_ = static_cast<quint32>(size);
+
+			return buffer_.get() +
+				   ((head + skipped_) & (capacity_ - 1)) +
+				   PACKET_HEADER_SIZE;
+		}
+
+		/// Publishes the packet reserved last.
+		/// \details Called by the producer after the packet data is written.
+		void PacketRingBuffer::commit() noexcept {
+			auto head = head_.load(std::memory_order_relaxed);
+
+			if (skipped_ > 0) {
+				std::memcpy(buffer_.get() + (head & (capacity_ - 1)),
+							&PACKET_WRAP_MARKER,
+							PACKET_HEADER_SIZE);
+			}
+
+			std::memcpy(buffer_.get() + ((head + skipped_) & (capacity_ - 1)),
+						&reserved_,
+						PACKET_HEADER_SIZE);
+
+			head_.store(head + skipped_ + footprint(reserved_),
+						std::memory_order_release);
+
+			reserved_ = 0;
+			skipped_ = 0;
+		}
+
+		/// Returns the oldest packet.
+		/// \details Called by the consumer. The returned data stays valid
+		/// until release() is called.
+		/// \param[out]	data	Packet data.
+		/// \param[out]	size	Packet size.
+		/// \retval true if a packet is available.
+		/// \retval false if the buffer is empty.
+		bool PacketRingBuffer::peek(const char** data, int* size) noexcept {
+			auto tail = tail_.load(std::memory_order_relaxed);
+			auto head = head_.load(std::memory_order_acquire);
+
+			while (tail != head) {
+				auto offset = tail & (capacity_ - 1);
+				quint32 header;
+
+				std::memcpy(&header, buffer_.get() + offset, PACKET_HEADER_SIZE);
+
+				if (header == PACKET_WRAP_MARKER) {
+					tail += capacity_ - offset;
+					tail_.store(tail, std::memory_order_release);
+					continue;
+				}
+
+				if (data) *data = buffer_.get() + offset + PACKET_HEADER_SIZE;
+				if (size) *size = static_cast<int>(header);
+
+				return true;
+			}
+
+			return false;
+		}
+
+		/// Removes the oldest packet.
+		/// \details Called by the consumer after peek() succeeded.
+		void PacketRingBuffer::release() noexcept {
+			if (!peek(nullptr, nullptr)) return;
+
+			auto tail = tail_.load(std::memory_order_relaxed);
+			quint32 header;
+
+			std::memcpy(&header,
+						buffer_.get() + (tail & (capacity_ - 1)),
+						PACKET_HEADER_SIZE);
+
+			tail_.store(tail + footprint(header), std::memory_order_release);
+		}
+
+		/// Removes all packets.
+		/// \details Must not be called concurrently with other methods.
+		void PacketRingBuffer::clear() noexcept {
+			head_.store(0, std::memory_order_relaxed);
+			tail_.store(0, std::memory_order_relaxed);
+			reserved_ = 0;
+			skipped_ = 0;
+		}
+
+		/// Indicates whether the buffer is empty.
+		/// \details Compares read and write positions.
+		/// \retval true if the buffer is empty.
+		/// \retval false if the buffer is not empty.
+		bool PacketRingBuffer::isEmpty() const noexcept {
+			return head_.load(std::memory_order_acquire) ==
+				   tail_.load(std::memory_order_acquire);
+		}
+
+		/// Returns buffer capacity.
+		/// \details Returns capacity rounded up to a power of two.
+		/// \return Buffer capacity in bytes.
+		int PacketRingBuffer::getCapacity() const noexcept {
+			return static_cast<int>(capacity_);
+		}
+
+		/// Returns number of packets dropped because of overflow.
+		/// \details Counts failed reservations.
+		/// \return Number of dropped packets.
+		quint64 PacketRingBuffer::getDroppedCount() const noexcept {
+			return dropped_.load(std::memory_order_relaxed);
+		}
+	}
+}
@@ -0,0 +1,111 @@
+/// \file PacketRingBuffer.hpp
+/// \brief Contains classes and functions declarations that provide packet ring
+/// buffer implementation.
+/// \bug No known bugs.
+
+#ifndef PACKETRINGBUFFER_HPP
+#define PACKETRINGBUFFER_HPP
+
+#include "Base/Export.hpp"
+
+#include <QtGlobal>
+
+#include <atomic>
+#include <memory>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		/// Class that provides packet ring buffer implementation.
+		/// \details Stores variable-size packets in one preallocated memory
+		/// block. Every packet occupies a contiguous region, so it can be
+		/// written and read in place. One producer thread and one consumer
+		/// thread may use the buffer without locks.
+		class RTSPCLIENT_EXPORT PacketRingBuffer final {
+		public:
+
+			/// Constructor.
+			/// \param[in]	capacity	Buffer capacity in bytes.
+			explicit PacketRingBuffer(int capacity);
+
+			/// Destructor.
+			~PacketRingBuffer();
+
+			/// Copy constructor.
+			/// \param[in]	object	Object to copy.
+			PacketRingBuffer(const PacketRingBuffer& object) = delete;
+
+			/// Copy assignment operator.
+			/// \param[in]	object	Object to copy.
+			/// \return This object.
+			PacketRingBuffer& operator=(const PacketRingBuffer& object) = delete;
+
+		public:
+
+			/// Reserves contiguous space for the next packet.
+			/// \param[in]	size	Packet size.
+			/// \return Pointer to packet data or nullptr if there is no room.
+			char* reserve(int size) noexcept;
+
+			/// Publishes the packet reserved last.
+			void commit() noexcept;
+
+			/// Returns the oldest packet.
+			/// \param[out]	data	Packet data.
+			/// \param[out]	size	Packet size.
+			/// \retval true if a packet is available.
+			/// \retval false if the buffer is empty.
+			bool peek(const char** data, int* size) noexcept;
+
+			/// Removes the oldest packet.
+			void release() noexcept;
+
+			/// Removes all packets.
+			/// \details Must not be called concurrently with other methods.
+			void clear() noexcept;
+
+			/// Indicates whether the buffer is empty.
+			/// \retval true if the buffer is empty.
+			/// \retval false if the buffer is not empty.
+			bool isEmpty() const noexcept;
+
+			/// Returns buffer capacity.
+			/// \return Buffer capacity in bytes.
+			int getCapacity() const noexcept;
+
+			/// Returns number of packets dropped because of overflow.
+			/// \return Number of dropped packets.
+			quint64 getDroppedCount() const noexcept;
+
+		private:
+
+			/// Buffer memory.
+			std::unique_ptr<char[]> buffer_;
+
+			/// Buffer capacity, power of two.
+			const quint32 capacity_;
+
+			/// Write position.
+			std::atomic<quint32> head_ { 0 };
+
+			/// Read position.
+			std::atomic<quint32> tail_ { 0 };
+
+			/// Size of the reserved packet.
+			quint32 reserved_ { 0 };
+
+			/// Unused space skipped before the reserved packet.
+			quint32 skipped_ { 0 };
+
+			/// Number of dropped packets.
+			std::atomic<quint64> dropped_ { 0 };
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,89 @@
+/// \file SequenceLock.hpp
+/// \brief Contains classes and functions declarations that provide sequence
+/// lock implementation.
+/// \bug No known bugs.
+
+#ifndef SEQUENCELOCK_HPP
+#define SEQUENCELOCK_HPP
+
+#include <QtGlobal>
+
+#include <atomic>
+
+/// Contains classes and functions that implement Real Time Streaming Protocol
+/// (RTSP) library.
+namespace RTSPLib {
+
+	/// Contains classes and functions that implement Real Time Streaming
+	/// Protocol (RTSP) client library.
+	namespace RTSPClient {
+
+		/// Class that provides sequence lock implementation.
+		/// \details Lets one writer thread publish a group of atomic values
+		/// that readers of any thread take as a consistent snapshot without
+		/// locks. The writer stores the values between two increments of a
+		/// version, a reader retries while the version is odd or changed
+		/// under it. Values are stored and loaded with relaxed order, which
+		/// takes only plain moves on common processors.
+		class SequenceLock final {
+		public:
+
+			/// Default constructor.
+			explicit SequenceLock() noexcept = default;
+
+			/// Copy constructor.
+			/// \param[in]	object	Object to copy.
+			SequenceLock(const SequenceLock& object) = delete;
+
+			/// Copy assignment operator.
+			/// \param[in]	object	Object to copy.
+			/// \return This object.
+			SequenceLock& operator=(const SequenceLock& object) = delete;
+
+		public:
+
+			/// Publishes values to readers.
+			/// \details Must be called from the writer thread only.
+			/// \param[in]	writer	Function that stores the values.
+			template <typename Writer>
+			void write(Writer writer) noexcept {
+				auto version = version_.load(std::memory_order_relaxed);
+				version_.store(version + 1, std::memory_order_relaxed);
+
+				std::atomic_thread_fence(std::memory_order_release);
+
+				writer();
+
+				version_.store(version + 2, std::memory_order_release);
+			}
+
+			/// Reads a consistent snapshot of values.
+			/// \details Safe to call from any thread. The reader may run
+			/// several times, so it must only load the values.
+			/// \param[in]	reader	Function that loads the values.
+			template <typename Reader>
+			void read(Reader reader) const noexcept {
+				quint32 before, after;
+
+				do {
+					before = version_.load(std::memory_order_acquire);
+
+					reader();
+
+					std::atomic_thread_fence(std::memory_order_acquire);
+
+					after = version_.load(std::memory_order_relaxed);
+				}
+				while ((before & 1) != 0 || before != after);
+			}
+
+		private:
+
+			/// Version of the values.
+			/// \details Odd while values are being published.
+			std::atomic<quint32> version_ { 0 };
+		};
+	}
+}
+
+#endif
@@ -3,5 +3,15 @@
 #------------------------------------------------------------------------------#
 
 HEADERS			+=															\
+						$$PWD/AtomicCounter.hpp								\
+						$$PWD/DatagramReceiver.hpp							\
+						$$PWD/LatencyHistogram.hpp							\
+						$$PWD/PacketBufferPool.hpp							\
+						$$PWD/PacketRingBuffer.hpp							\
+						$$PWD/SequenceLock.hpp								\
 
 SOURCES			+=															\
+						$$PWD/DatagramReceiver.cpp							\
+						$$PWD/LatencyHistogram.cpp							\
+						$$PWD/PacketBufferPool.cpp							\
+						$$PWD/PacketRingBuffer.cpp							\